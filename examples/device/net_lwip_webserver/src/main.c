@@ -118,6 +118,24 @@ static err_t linkoutput_fn(struct netif *netif, struct pbuf *p) {
     if (!tud_ready())
       return ERR_USE;
 
+#if CFG_TUD_NCM
+    /* hand the pbuf chain to the driver, it stays referenced until tud_network_xmit_done_cb() */
+    tud_network_seg_t seg[4];
+    if (pbuf_clen(p) <= TU_ARRAY_SIZE(seg)) {
+      uint8_t count = 0;
+      for (struct pbuf *q = p; q != NULL; q = q->next) {
+        seg[count].buf = q->payload;
+        seg[count].len = q->len;
+        count++;
+      }
+
+      pbuf_ref(p);
+      if (tud_network_xmit_sg(p, seg, count)) {
+        return ERR_OK;
+      }
+      pbuf_free(p);
+    } else
+#endif
     /* if the network driver can accept another packet, we make it happen */
     if (tud_network_can_xmit(p->tot_len)) {
       tud_network_xmit(p, 0 /* unused for this example */);
@@ -231,6 +249,13 @@ uint16_t tud_network_xmit_cb(uint8_t *dst, void *ref, uint16_t arg) {
   return pbuf_copy_partial(p, dst, p->tot_len, 0);
 }
 
+#if CFG_TUD_NCM
+void tud_network_xmit_done_cb(void *ref) {
+  /* the driver is done with the pbuf passed to tud_network_xmit_sg() */
+  pbuf_free((struct pbuf *) ref);
+}
+#endif
+
 static void led_blinking_task(void) {
   static uint32_t start_ms = 0;
   static bool led_state = false;
@@ -138,6 +138,12 @@ extern "C" {
   #define CFG_TUD_NCM_IN_NTB_N 1
 #endif
 
+// Send large datagrams straight from lwIP pbufs instead of copying them into the NTB.
+// Only enable if pbuf memory is reachable (and cache coherent) for the USB controller's DMA.
+#ifndef CFG_TUD_NCM_XMIT_ZEROCOPY
+  #define CFG_TUD_NCM_XMIT_ZEROCOPY 0
+#endif
+
 //--------------------------------------------------------------------
 // DEVICE CONFIGURATION
 //--------------------------------------------------------------------
@@ -223,7 +223,7 @@ DRESULT disk_read(BYTE  pdrv,     /* Physical drive nmuber to identify the drive
   const uint8_t lun      = 0;
 
   _disk_busy[pdrv] = true;
-  tuh_msc_read10(dev_addr, lun, buff, sector, (uint16_t)count, disk_io_complete, 0);
+  tuh_msc_read(dev_addr, lun, buff, sector, count, disk_io_complete, 0);
   wait_for_disk_io(pdrv);
 
   return RES_OK;
@@ -240,7 +240,7 @@ DRESULT disk_write(BYTE        pdrv,   /* Physical drive nmuber to identify the
   const uint8_t lun      = 0;
 
   _disk_busy[pdrv] = true;
-  tuh_msc_write10(dev_addr, lun, buff, sector, (uint16_t)count, disk_io_complete, 0);
+  tuh_msc_write(dev_addr, lun, buff, sector, count, disk_io_complete, 0);
   wait_for_disk_io(pdrv);
 
   return RES_OK;
@@ -126,6 +126,7 @@ target_sources(tinyusb_host_base INTERFACE
 		${TOP}/src/class/midi/midi_host.c
 		${TOP}/src/class/midi/midi2_host.c
 		${TOP}/src/class/msc/msc_host.c
+		${TOP}/src/class/net/ncm_host.c
 		)
 
 # Sometimes have to do host specific actions in mostly common functions
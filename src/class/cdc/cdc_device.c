@@ -98,6 +98,13 @@ TU_ATTR_WEAK void tud_cdc_send_break_cb(uint8_t itf, uint16_t duration_ms) {
 //--------------------------------------------------------------------+
 static cdcd_interface_t _cdcd_itf[CFG_TUD_CDC];
 
+// TX latency timer driven by SOF
+static struct {
+  bool sof_en;
+  volatile bool flush_queued;
+  usbd_sof_tick_t sof_tick;
+} _cdcd_latency;
+
 TU_ATTR_ALWAYS_INLINE static inline uint8_t find_cdc_itf(uint8_t ep_addr) {
   for (uint8_t idx = 0; idx < CFG_TUD_CDC; idx++) {
     const cdcd_interface_t *p_cdc = &_cdcd_itf[idx];
@@ -109,6 +116,29 @@ TU_ATTR_ALWAYS_INLINE static inline uint8_t find_cdc_itf(uint8_t ep_addr) {
   return TUSB_INDEX_INVALID_8;
 }
 
+// SOF is only needed while an opened TX stream has latency timer enabled
+static void latency_sof_update(uint8_t rhport) {
+  bool en = false;
+  for (uint8_t i = 0; i < CFG_TUD_CDC; i++) {
+    const tu_edpt_stream_t *stream_tx = &_cdcd_itf[i].tx_stream;
+    en = en || (tu_edpt_stream_is_opened(stream_tx) && stream_tx->latency_ms > 0);
+  }
+
+  if (en != _cdcd_latency.sof_en) {
+    _cdcd_latency.sof_en     = en;
+    _cdcd_latency.sof_tick.synced = false;
+    usbd_sof_enable(rhport, SOF_CONSUMER_CDC, en);
+  }
+}
+
+static void latency_flush(void *param) {
+  (void) param;
+  _cdcd_latency.flush_queued = false;
+  for (uint8_t i = 0; i < CFG_TUD_CDC; i++) {
+    tu_edpt_stream_write_latency_flush(&_cdcd_itf[i].tx_stream);
+  }
+}
+
 //--------------------------------------------------------------------+
 // APPLICATION API
 //--------------------------------------------------------------------+
@@ -190,6 +220,18 @@ void tud_cdc_n_read_flush(uint8_t itf) {
   tu_edpt_stream_read_xfer(&p_cdc->rx_stream);
 }
 
+uint32_t tud_cdc_n_read_reserve(uint8_t itf, tu_fifo_buffer_info_t *info, uint32_t bufsize) {
+  TU_VERIFY(itf < CFG_TUD_CDC, 0);
+  cdcd_interface_t *p_cdc = &_cdcd_itf[itf];
+  return tu_edpt_stream_read_reserve(&p_cdc->rx_stream, info, bufsize);
+}
+
+uint32_t tud_cdc_n_read_commit(uint8_t itf, uint32_t count) {
+  TU_VERIFY(itf < CFG_TUD_CDC, 0);
+  cdcd_interface_t *p_cdc = &_cdcd_itf[itf];
+  return tu_edpt_stream_read_commit(&p_cdc->rx_stream, count);
+}
+
 //--------------------------------------------------------------------+
 // WRITE API
 //--------------------------------------------------------------------+
@@ -218,6 +260,31 @@ bool tud_cdc_n_write_clear(uint8_t itf) {
   return true;
 }
 
+uint32_t tud_cdc_n_write_reserve(uint8_t itf, tu_fifo_buffer_info_t *info, uint32_t bufsize) {
+  TU_VERIFY(itf < CFG_TUD_CDC, 0);
+  cdcd_interface_t *p_cdc = &_cdcd_itf[itf];
+  return tu_edpt_stream_write_reserve(&p_cdc->tx_stream, info, bufsize);
+}
+
+uint32_t tud_cdc_n_write_commit(uint8_t itf, uint32_t count) {
+  TU_VERIFY(itf < CFG_TUD_CDC, 0);
+  cdcd_interface_t *p_cdc = &_cdcd_itf[itf];
+  return tu_edpt_stream_write_commit(&p_cdc->tx_stream, count);
+}
+
+bool tud_cdc_n_set_tx_latency(uint8_t itf, uint8_t latency_ms) {
+  TU_VERIFY(itf < CFG_TUD_CDC);
+  cdcd_interface_t *p_cdc = &_cdcd_itf[itf];
+  tu_edpt_stream_write_set_latency(&p_cdc->tx_stream, latency_ms);
+  latency_sof_update(p_cdc->rhport);
+  return true;
+}
+
+uint8_t tud_cdc_n_get_tx_latency(uint8_t itf) {
+  TU_VERIFY(itf < CFG_TUD_CDC, 0);
+  return _cdcd_itf[itf].tx_stream.latency_ms;
+}
+
 //--------------------------------------------------------------------+
 // USBD Driver API
 //--------------------------------------------------------------------+
@@ -248,7 +315,10 @@ void cdcd_init(void) {
     // Default: is overwritable
     tu_edpt_stream_init(&p_cdc->tx_stream, false, true, CFG_TUD_CDC_TX_OVERWRITABLE_IF_NOT_CONNECTED, p_cdc->tx_ff_buf,
                         CFG_TUD_CDC_TX_BUFSIZE, epin_buf);
+    tu_edpt_stream_write_set_latency(&p_cdc->tx_stream, CFG_TUD_CDC_TX_LATENCY_MS);
   }
+
+  tu_memclr(&_cdcd_latency, sizeof(_cdcd_latency));
 }
 
 bool cdcd_deinit(void) {
@@ -271,6 +341,9 @@ void cdcd_reset(uint8_t rhport) {
     tu_edpt_stream_close(&p_cdc->rx_stream);
     tu_edpt_stream_close(&p_cdc->tx_stream);
   }
+
+  // SOF consumers are cleared by usbd
+  _cdcd_latency.sof_en = false;
 }
 
 uint16_t cdcd_open(uint8_t rhport, const tusb_desc_interface_t* itf_desc, uint16_t max_len) {
@@ -328,6 +401,7 @@ uint16_t cdcd_open(uint8_t rhport, const tusb_desc_interface_t* itf_desc, uint16
   #else
           tu_edpt_stream_clear(stream_tx);
   #endif
+          latency_sof_update(rhport);
         } else {
           tu_edpt_stream_t *stream_rx = &p_cdc->rx_stream;
   #if CFG_TUD_CDC_RX_NEED_ZLP
@@ -453,7 +527,12 @@ bool cdcd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_
     tu_edpt_stream_read_xfer_complete(stream_rx, xferred_bytes);
 
     // Check for wanted char and invoke wanted callback
-    if (((signed char)p_cdc->wanted_char) != -1) {
+    if (((signed char)p_cdc->wanted_char) != -1 && stream_rx->ep_buf != NULL) {
+      // received data is still in ep_buf, including the part not yet moved to fifo
+      if (memchr(stream_rx->ep_buf, p_cdc->wanted_char, xferred_bytes) != NULL) {
+        tud_cdc_rx_wanted_cb(itf, p_cdc->wanted_char);
+      }
+    } else if (((signed char)p_cdc->wanted_char) != -1) {
       tu_fifo_buffer_info_t buf_info;
       tu_fifo_get_read_info(&stream_rx->ff, &buf_info);
 
@@ -512,4 +591,26 @@ bool cdcd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_
   return true;
 }
 
+void cdcd_sof_isr(uint8_t rhport, uint32_t frame_count) {
+  (void) rhport;
+  if (!_cdcd_latency.sof_en) {
+    return;
+  }
+
+  const uint16_t elapsed_ms = usbd_sof_elapsed_ms(&_cdcd_latency.sof_tick, frame_count);
+  if (elapsed_ms == 0) {
+    return;
+  }
+
+  bool expired = false;
+  for (uint8_t i = 0; i < CFG_TUD_CDC; i++) {
+    expired = tu_edpt_stream_write_latency_tick(&_cdcd_itf[i].tx_stream, elapsed_ms) || expired;
+  }
+
+  if (expired && !_cdcd_latency.flush_queued) {
+    _cdcd_latency.flush_queued = true;
+    usbd_defer_func(latency_flush, NULL, true);
+  }
+}
+
 #endif
@@ -25,6 +25,9 @@
   #define CFG_TUD_CDC_TX_BUFSIZE TUD_EPSIZE_BULK_MAX
 #endif
 
+// RX FIFO size. Endpoint keeps receiving into its buffer while the FIFO is nearly full, bytes that do not fit are moved
+// to FIFO as application reads. This receive-ahead is not available with CFG_TUD_EDPT_DEDICATED_HWFIFO, where DCD
+// writes into the FIFO directly: endpoint is only armed once FIFO has a full packet of free space.
 #ifndef CFG_TUD_CDC_RX_BUFSIZE
   #define CFG_TUD_CDC_RX_BUFSIZE TUD_EPSIZE_BULK_MAX
 #endif
@@ -66,6 +69,13 @@
   #define CFG_TUD_CDC_TX_OVERWRITABLE_IF_NOT_CONNECTED 1
 #endif
 
+// TX latency timer in ms, 0 to disable. Data less than a packet is sent once it has waited this long in TX FIFO,
+// so application can write small chunks without calling tud_cdc_write_flush() and still get them batched into full
+// packets. Can be changed at runtime with tud_cdc_n_set_tx_latency(), SOF interrupt is used while enabled.
+#ifndef CFG_TUD_CDC_TX_LATENCY_MS
+  #define CFG_TUD_CDC_TX_LATENCY_MS 0
+#endif
+
 // Backward compatible: tud_cdc_configure_t and tud_cdc_configure() are no longer used.
 // Configuration is now done via compile-time macros above.
 typedef struct {
@@ -115,6 +125,13 @@ void tud_cdc_n_read_flush(uint8_t itf);
 // Get a byte from FIFO without removing it
 bool tud_cdc_n_peek(uint8_t itf, uint8_t* ui8);
 
+// Zero-copy read: get up to bufsize received bytes in place as linear + wrapped span of RX FIFO, return total bytes.
+// Data is not removed until tud_cdc_n_read_commit() is called
+uint32_t tud_cdc_n_read_reserve(uint8_t itf, tu_fifo_buffer_info_t* info, uint32_t bufsize);
+
+// Remove count bytes consumed via tud_cdc_n_read_reserve() from RX FIFO, return number of removed bytes
+uint32_t tud_cdc_n_read_commit(uint8_t itf, uint32_t count);
+
 // Write bytes to TX FIFO, data may remain in the FIFO for a while
 uint32_t tud_cdc_n_write(uint8_t itf, void const* buffer, uint32_t bufsize);
 
@@ -137,6 +154,19 @@ uint32_t tud_cdc_n_write_available(uint8_t itf);
 // Clear the TX FIFO
 bool tud_cdc_n_write_clear(uint8_t itf);
 
+// Zero-copy write: get up to bufsize free bytes of TX FIFO as linear + wrapped span to fill in place, return total
+// bytes. Data is not sent until tud_cdc_n_write_commit() is called
+uint32_t tud_cdc_n_write_reserve(uint8_t itf, tu_fifo_buffer_info_t* info, uint32_t bufsize);
+
+// Publish count bytes filled via tud_cdc_n_write_reserve(), same as tud_cdc_n_write() without the copy
+uint32_t tud_cdc_n_write_commit(uint8_t itf, uint32_t count);
+
+// Set TX latency timer in ms (0 to disable), see CFG_TUD_CDC_TX_LATENCY_MS
+bool tud_cdc_n_set_tx_latency(uint8_t itf, uint8_t latency_ms);
+
+// Get TX latency timer in ms
+uint8_t tud_cdc_n_get_tx_latency(uint8_t itf);
+
 #if CFG_TUD_CDC_NOTIFY
 bool tud_cdc_n_notify_msg(uint8_t itf, cdc_notify_msg_t *msg);
 
@@ -223,6 +253,14 @@ TU_ATTR_ALWAYS_INLINE static inline bool tud_cdc_peek(uint8_t* ui8) {
   return tud_cdc_n_peek(0, ui8);
 }
 
+TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_read_reserve(tu_fifo_buffer_info_t* info, uint32_t bufsize) {
+  return tud_cdc_n_read_reserve(0, info, bufsize);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_read_commit(uint32_t count) {
+  return tud_cdc_n_read_commit(0, count);
+}
+
 TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_write_char(char ch) {
   return tud_cdc_n_write_char(0, ch);
 }
@@ -247,6 +285,22 @@ TU_ATTR_ALWAYS_INLINE static inline bool tud_cdc_write_clear(void) {
   return tud_cdc_n_write_clear(0);
 }
 
+TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_write_reserve(tu_fifo_buffer_info_t* info, uint32_t bufsize) {
+  return tud_cdc_n_write_reserve(0, info, bufsize);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_write_commit(uint32_t count) {
+  return tud_cdc_n_write_commit(0, count);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool tud_cdc_set_tx_latency(uint8_t latency_ms) {
+  return tud_cdc_n_set_tx_latency(0, latency_ms);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t tud_cdc_get_tx_latency(void) {
+  return tud_cdc_n_get_tx_latency(0);
+}
+
 //--------------------------------------------------------------------+
 // Application Callback API
 //--------------------------------------------------------------------+
@@ -284,6 +338,7 @@ void     cdcd_reset           (uint8_t rhport);
 uint16_t cdcd_open            (uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint16_t max_len);
 bool     cdcd_control_xfer_cb (uint8_t rhport, uint8_t stage, tusb_control_request_t const * request);
 bool     cdcd_xfer_cb         (uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+void     cdcd_sof_isr         (uint8_t rhport, uint32_t frame_count);
 
 #ifdef __cplusplus
  }
@@ -39,6 +39,11 @@ typedef struct {
 
   uint16_t epin_size;
   uint16_t epout_size;
+
+#if CFG_TUH_HID_FIELD_MAX
+  uint16_t field_count;
+  tuh_hid_field_t fields[CFG_TUH_HID_FIELD_MAX];
+#endif
 } hidh_interface_t;
 
 typedef struct {
@@ -145,6 +150,19 @@ bool tuh_hid_mounted(uint8_t daddr, uint8_t idx) {
   return p_hid->mounted;
 }
 
+const tuh_hid_field_t* tuh_hid_itf_get_fields(uint8_t daddr, uint8_t idx, uint16_t* count) {
+  *count = 0;
+#if CFG_TUH_HID_FIELD_MAX
+  hidh_interface_t* p_hid = get_hid_itf(daddr, idx);
+  TU_VERIFY(p_hid && p_hid->field_count, NULL);
+  *count = p_hid->field_count;
+  return p_hid->fields;
+#else
+  (void) daddr; (void) idx;
+  return NULL;
+#endif
+}
+
 bool tuh_hid_itf_get_info(uint8_t daddr, uint8_t idx, tuh_itf_info_t* info) {
   hidh_interface_t* p_hid = get_hid_itf(daddr, idx);
   TU_VERIFY(p_hid && info);
@@ -618,13 +636,13 @@ static void process_set_config(tuh_xfer_t* xfer) {
         config_driver_mount_complete(daddr, idx, NULL, 0);
       } else {
         tuh_descriptor_get_hid_report(daddr, itf_num, p_hid->report_desc_type, 0,
-                                      usbh_get_enum_buf(), p_hid->report_desc_len,
+                                      usbh_get_enum_buf(daddr), p_hid->report_desc_len,
                                       process_set_config, CONFIG_COMPLETE);
       }
       break;
 
     case CONFIG_COMPLETE: {
-      const uint8_t *desc_report = usbh_get_enum_buf();
+      const uint8_t *desc_report = usbh_get_enum_buf(daddr);
       const uint16_t desc_len    = tu_le16toh(xfer->setup->wLength);
 
       config_driver_mount_complete(daddr, idx, desc_report, desc_len);
@@ -641,6 +659,12 @@ static void config_driver_mount_complete(uint8_t daddr, uint8_t idx, uint8_t con
   TU_VERIFY(p_hid,);
   p_hid->mounted = true;
 
+#if CFG_TUH_HID_FIELD_MAX
+  // compile fields while report descriptor is still in enumeration buffer
+  p_hid->field_count = (desc_report != NULL) ?
+                       tuh_hid_parse_report_fields(p_hid->fields, CFG_TUH_HID_FIELD_MAX, desc_report, desc_len) : 0;
+#endif
+
   // enumeration is complete
   tuh_hid_mount_cb(daddr, idx, desc_report, desc_len);
 
@@ -793,4 +817,352 @@ uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t* report_info_arr,
   return report_num;
 }
 
+//--------------------------------------------------------------------+
+// Report Field Parser
+//--------------------------------------------------------------------+
+enum {
+  HIDH_PARSER_STACK_DEPTH = 4,  // max nested Push items
+  HIDH_PARSER_USAGE_MAX   = 16, // max Usage items (or usage ranges) per main item
+  HIDH_PARSER_REPORT_MAX  = 16, // max number of (report ID, report type) for tracking bit offset
+};
+
+typedef struct {
+  int32_t  logical_min;
+  uint32_t logical_max;      // raw value, its signedness depends on logical_min
+  uint32_t report_size;
+  uint32_t report_count;
+  uint16_t usage_page;
+  uint8_t  logical_max_size;
+  uint8_t  report_id;
+} hidh_parser_global_t;
+
+// usage page in high 16 bits, usage ID in low 16 bits
+typedef struct {
+  uint32_t min;
+  uint32_t max;
+} hidh_parser_usage_t;
+
+typedef struct {
+  uint8_t  report_id;
+  uint8_t  report_type;
+  uint16_t bit_offset;
+} hidh_parser_report_t;
+
+// item data is little endian
+static uint32_t parser_item_data(uint8_t const* data, uint8_t size) {
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < size; i++) {
+    value |= ((uint32_t) data[i]) << (8 * i);
+  }
+  return value;
+}
+
+static int32_t parser_sign_extend(uint32_t value, uint8_t bits) {
+  if (bits > 0 && bits < 32 && (value & (((uint32_t) 1) << (bits - 1)))) {
+    value |= ~((((uint32_t) 1) << bits) - 1);
+  }
+  return (int32_t) value;
+}
+
+// Usage item of 4 bytes is an extended usage that includes its own usage page
+static uint32_t parser_usage(uint32_t data, uint8_t size, uint16_t usage_page) {
+  return (size == 4) ? data : ((((uint32_t) usage_page) << 16) | (data & 0xffffu));
+}
+
+static hidh_parser_report_t* parser_get_report(hidh_parser_report_t* reports, uint8_t* count, uint8_t report_id,
+                                               uint8_t report_type) {
+  for (uint8_t i = 0; i < *count; i++) {
+    if (reports[i].report_id == report_id && reports[i].report_type == report_type) {
+      return &reports[i];
+    }
+  }
+
+  TU_VERIFY(*count < HIDH_PARSER_REPORT_MAX, NULL);
+  hidh_parser_report_t* report = &reports[(*count)++];
+  report->report_id   = report_id;
+  report->report_type = report_type;
+  report->bit_offset  = 0;
+  return report;
+}
+
+// Split a main item into fields, return number of added fields
+static uint16_t parser_add_fields(tuh_hid_field_t* fields, uint16_t max_fields, hidh_parser_global_t const* global,
+                                  hidh_parser_usage_t const* usages, uint8_t usage_count, uint8_t report_type,
+                                  uint8_t flags, uint16_t bit_offset) {
+  uint32_t const report_size  = global->report_size;
+  uint32_t const report_count = global->report_count;
+
+  // padding and elements that could not be extracted anyway
+  if ((flags & HID_CONSTANT) || report_size == 0 || report_size > 32 || report_count == 0 || max_fields == 0) {
+    return 0;
+  }
+
+  tuh_hid_field_t field = {
+    .report_id   = global->report_id,
+    .report_type = report_type,
+    .flags       = flags,
+    .bit_size    = (uint8_t) report_size,
+    .bit_offset  = bit_offset,
+    .count       = (uint16_t) report_count,
+    .usage_page  = global->usage_page,
+    .usage_min   = 0,
+    .usage_max   = 0,
+    .logical_min = global->logical_min,
+    .logical_max = (global->logical_min < 0) ?
+                   parser_sign_extend(global->logical_max, (uint8_t) (8 * global->logical_max_size)) :
+                   (int32_t) global->logical_max
+  };
+
+  if (usage_count == 0) {
+    fields[0] = field;
+    return 1;
+  }
+
+  if (!(flags & HID_VARIABLE)) {
+    // array: each element holds an index into usage list, which maps to usage only if the list is one range
+    field.usage_page = (uint16_t) (usages[0].min >> 16);
+    field.usage_min  = (uint16_t) usages[0].min;
+    field.usage_max  = (uint16_t) usages[usage_count - 1].max;
+    for (uint8_t i = 0; i < usage_count; i++) {
+      if (usages[i].max < usages[i].min || (i > 0 && usages[i].min != usages[i - 1].max + 1)) {
+        field.usage_discrete = true;
+      }
+    }
+    fields[0] = field;
+    return 1;
+  }
+
+  // variable: usages are assigned to elements in order, the last usage applies to all remaining elements
+  uint16_t added = 0;
+  uint32_t remaining = report_count;
+  for (uint8_t i = 0; i < usage_count && remaining > 0 && added < max_fields; i++) {
+    hidh_parser_usage_t const* usage = &usages[i];
+    uint32_t n = (usage->max >= usage->min) ? (usage->max - usage->min + 1) : 1;
+    if (i == usage_count - 1 || n > remaining) {
+      n = remaining;
+    }
+
+    tuh_hid_field_t* f = &fields[added++];
+    *f = field;
+    f->bit_offset = (uint16_t) (bit_offset + (report_count - remaining) * report_size);
+    f->count      = (uint16_t) n;
+    f->usage_page = (uint16_t) (usage->min >> 16);
+    f->usage_min  = (uint16_t) usage->min;
+    f->usage_max  = (uint16_t) tu_min32(tu_max32(usage->max, usage->min), usage->min + n - 1);
+
+    remaining -= n;
+  }
+
+  return added;
+}
+
+uint16_t tuh_hid_parse_report_fields(tuh_hid_field_t* fields, uint16_t max_fields, uint8_t const* desc_report,
+                                     uint16_t desc_len) {
+  hidh_parser_global_t global;
+  hidh_parser_global_t global_stack[HIDH_PARSER_STACK_DEPTH];
+  uint8_t stack_depth = 0;
+
+  hidh_parser_usage_t usages[HIDH_PARSER_USAGE_MAX];
+  uint8_t usage_count = 0;
+  uint32_t usage_min = 0; // pending Usage Minimum, completed by Usage Maximum
+
+  hidh_parser_report_t reports[HIDH_PARSER_REPORT_MAX];
+  uint8_t report_count = 0;
+
+  uint16_t field_count = 0;
+
+  tu_memclr(&global, sizeof(global));
+
+  while (desc_len && field_count < max_fields) {
+    // Report Item 6.2.2.2 USB HID 1.11
+    uint8_t const header = *desc_report++;
+    desc_len--;
+
+    uint8_t const tag  = header >> 4;
+    uint8_t const type = (header >> 2) & 0x03;
+    uint8_t size = header & 0x03;
+    if (size == 3) {
+      size = 4; // HID 1.11 6.2.2.2 3 is 4 bytes
+    }
+
+    // long item 6.2.2.3: bDataSize, bLongItemTag followed by data. No long item tags are defined, skip it.
+    // Its length can be up to 257 bytes, which does not fit into size
+    if (header == 0xFE) {
+      TU_VERIFY(desc_len >= 2, field_count);
+      uint16_t const long_size = (uint16_t) (2 + desc_report[0]);
+      TU_VERIFY(long_size <= desc_len, field_count);
+      desc_report += long_size;
+      desc_len = (uint16_t) (desc_len - long_size);
+      continue;
+    }
+
+    TU_VERIFY(size <= desc_len, field_count);
+    uint32_t const data = parser_item_data(desc_report, size);
+
+    switch (type) {
+      case RI_TYPE_MAIN:
+        if (tag == RI_MAIN_INPUT || tag == RI_MAIN_OUTPUT || tag == RI_MAIN_FEATURE) {
+          uint8_t const report_type = (tag == RI_MAIN_INPUT)  ? HID_REPORT_TYPE_INPUT :
+                                      (tag == RI_MAIN_OUTPUT) ? HID_REPORT_TYPE_OUTPUT : HID_REPORT_TYPE_FEATURE;
+          hidh_parser_report_t* report = parser_get_report(reports, &report_count, global.report_id, report_type);
+          TU_VERIFY(report, field_count);
+
+          field_count += parser_add_fields(&fields[field_count], (uint16_t) (max_fields - field_count), &global,
+                                           usages, usage_count, report_type, (uint8_t) data, report->bit_offset);
+          report->bit_offset = (uint16_t) (report->bit_offset + global.report_size * global.report_count);
+        }
+
+        // local items only apply to the next main item
+        usage_count = 0;
+        usage_min   = 0;
+        break;
+
+      case RI_TYPE_GLOBAL:
+        switch (tag) {
+          case RI_GLOBAL_USAGE_PAGE:
+            global.usage_page = (uint16_t) data;
+            break;
+
+          case RI_GLOBAL_LOGICAL_MIN:
+            global.logical_min = parser_sign_extend(data, (uint8_t) (8 * size));
+            break;
+
+          case RI_GLOBAL_LOGICAL_MAX:
+            global.logical_max      = data;
+            global.logical_max_size = size;
+            break;
+
+          case RI_GLOBAL_REPORT_ID:
+            global.report_id = (uint8_t) data;
+            break;
+
+          case RI_GLOBAL_REPORT_SIZE:
+            global.report_size = data;
+            break;
+
+          case RI_GLOBAL_REPORT_COUNT:
+            global.report_count = data;
+            break;
+
+          case RI_GLOBAL_PUSH:
+            TU_VERIFY(stack_depth < HIDH_PARSER_STACK_DEPTH, field_count);
+            global_stack[stack_depth++] = global;
+            break;
+
+          case RI_GLOBAL_POP:
+            TU_VERIFY(stack_depth > 0, field_count);
+            global = global_stack[--stack_depth];
+            break;
+
+          default: break;
+        }
+        break;
+
+      case RI_TYPE_LOCAL:
+        switch (tag) {
+          case RI_LOCAL_USAGE:
+            if (usage_count < HIDH_PARSER_USAGE_MAX) {
+              usages[usage_count].min = usages[usage_count].max = parser_usage(data, size, global.usage_page);
+              usage_count++;
+            }
+            break;
+
+          case RI_LOCAL_USAGE_MIN:
+            usage_min = parser_usage(data, size, global.usage_page);
+            break;
+
+          case RI_LOCAL_USAGE_MAX:
+            if (usage_count < HIDH_PARSER_USAGE_MAX) {
+              usages[usage_count].min = usage_min;
+              usages[usage_count].max = parser_usage(data, size, global.usage_page);
+              usage_count++;
+            }
+            break;
+
+          default: break;
+        }
+        break;
+
+      default: break;
+    }
+
+    desc_report += size;
+    desc_len -= size;
+  }
+
+  for (uint16_t i = 0; i < field_count; i++) {
+    TU_LOG_DRV("%u: id = %u, type = %u, offset = %u, size = %u, count = %u, usage = %04X:%04X-%04X\r\n", i,
+               fields[i].report_id, fields[i].report_type, fields[i].bit_offset, fields[i].bit_size, fields[i].count,
+               fields[i].usage_page, fields[i].usage_min, fields[i].usage_max);
+  }
+
+  return field_count;
+}
+
+tuh_hid_field_t const* tuh_hid_field_find(tuh_hid_field_t const* fields, uint16_t count, uint8_t report_type,
+                                          uint16_t usage_page, uint16_t usage) {
+  for (uint16_t i = 0; i < count; i++) {
+    tuh_hid_field_t const* f = &fields[i];
+    if (f->report_type == report_type && f->usage_page == usage_page && !f->usage_discrete &&
+        f->usage_min <= usage && usage <= f->usage_max) {
+      return f;
+    }
+  }
+  return NULL;
+}
+
+bool tuh_hid_field_get_value(tuh_hid_field_t const* field, uint16_t index, uint8_t const* report, uint16_t len,
+                             int32_t* value) {
+  TU_VERIFY(field && report && value && index < field->count);
+
+  // report ID is the 1st byte of report
+  if (field->report_id) {
+    TU_VERIFY(len > 0 && report[0] == field->report_id);
+    report++;
+    len--;
+  }
+
+  uint8_t const bit_size = field->bit_size;
+  uint32_t const bit = field->bit_offset + (uint32_t) index * bit_size;
+  uint8_t const shift = (uint8_t) (bit & 7);
+  uint8_t const nbytes = (uint8_t) ((shift + bit_size + 7) / 8); // up to 5 bytes for unaligned 32-bit element
+  TU_VERIFY((bit / 8) + nbytes <= len);
+
+  uint8_t const* p = report + bit / 8;
+  uint32_t raw = parser_item_data(p, tu_min8(nbytes, 4)) >> shift;
+  if (nbytes > 4) {
+    raw |= ((uint32_t) p[4]) << (32 - shift);
+  }
+
+  if (bit_size < 32) {
+    raw &= (((uint32_t) 1) << bit_size) - 1;
+  }
+  *value = (field->logical_min < 0) ? parser_sign_extend(raw, bit_size) : (int32_t) raw;
+
+  return true;
+}
+
+bool tuh_hid_field_get_usage_value(tuh_hid_field_t const* field, uint16_t usage, uint8_t const* report, uint16_t len,
+                                   int32_t* value) {
+  TU_VERIFY(field && !field->usage_discrete && field->usage_min <= usage && usage <= field->usage_max);
+
+  if (field->flags & HID_VARIABLE) {
+    return tuh_hid_field_get_value(field, (uint16_t) (usage - field->usage_min), report, len, value);
+  }
+
+  // array: usage is present if any element holds its index
+  int32_t const target = field->logical_min + (int32_t) (usage - field->usage_min);
+  for (uint16_t i = 0; i < field->count; i++) {
+    int32_t element;
+    TU_VERIFY(tuh_hid_field_get_value(field, i, report, len, &element));
+    if (element == target) {
+      *value = 1;
+      return true;
+    }
+  }
+
+  *value = 0;
+  return true;
+}
+
 #endif
@@ -30,6 +30,12 @@ extern "C" {
   #define CFG_TUH_HID_SET_PROTOCOL_ON_ENUM 1
 #endif
 
+// Max number of report fields compiled from report descriptor when interface is mounted, see tuh_hid_itf_get_fields().
+// 0 to disable the per-interface field table
+#ifndef CFG_TUH_HID_FIELD_MAX
+  #define CFG_TUH_HID_FIELD_MAX 0
+#endif
+
 //--------------------------------------------------------------------+
 // Interface API
 //--------------------------------------------------------------------+
@@ -43,6 +49,27 @@ typedef struct {
   //  uint8_t out_len;     // length of OUT report
 } tuh_hid_report_info_t;
 
+// Report field compiled from an Input, Output or Feature main item of report descriptor.
+// A variable item is split into one field per usage (or usage range), an array item is a single field whose elements
+// hold usage indexes within [usage_min, usage_max]. Only an array with usages forming one contiguous range can be
+// looked up by usage. An array with a discrete usage list e.g Usage(A), Usage(C) is marked with usage_discrete: it is
+// skipped by tuh_hid_field_find(), tuh_hid_field_get_usage_value() fails on it, and its elements are only available as
+// raw indexes with tuh_hid_field_get_value().
+typedef struct {
+  uint8_t  report_id;    // 0 if device does not use report ID
+  uint8_t  report_type;  // hid_report_type_t
+  uint8_t  flags;        // main item data e.g HID_VARIABLE, HID_RELATIVE
+  uint8_t  bit_size;     // size of each element in bits, up to 32
+  uint16_t bit_offset;   // offset of first element in report, report ID byte is not counted
+  uint16_t count;        // number of elements
+  uint16_t usage_page;
+  uint16_t usage_min;    // variable: usage of first element, array: usage of element value logical_min
+  uint16_t usage_max;    // variable: usage of last element, array: usage of element value logical_max
+  bool     usage_discrete; // array: usages are not one contiguous range, usage_min/max only bound them
+  int32_t  logical_min;  // elements are sign-extended if logical_min < 0
+  int32_t  logical_max;
+} tuh_hid_field_t;
+
 // Get the total number of mounted HID interfaces of a device
 uint8_t tuh_hid_itf_get_count(uint8_t dev_addr);
 
@@ -66,10 +93,33 @@ uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t idx);
 bool tuh_hid_mounted(uint8_t dev_addr, uint8_t idx);
 
 // Parse report descriptor into array of report_info struct and return number of reports.
-// For complicated report, application should write its own parser.
+// For complicated report, use tuh_hid_parse_report_fields() or write application own parser.
 TU_ATTR_UNUSED uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t *reports_info_arr, uint8_t arr_count,
                                                        const uint8_t *desc_report, uint16_t desc_len);
 
+// Compile report descriptor into array of fields and return number of fields. Constant (padding) items and elements
+// larger than 32 bits only advance the bit offset. No memory is allocated, parsing stops when fields array is full.
+uint16_t tuh_hid_parse_report_fields(tuh_hid_field_t *fields, uint16_t max_fields, const uint8_t *desc_report,
+                                     uint16_t desc_len);
+
+// Get fields compiled from report descriptor when interface is mounted (requires CFG_TUH_HID_FIELD_MAX > 0).
+// Return NULL if not available e.g report descriptor is larger than CFG_TUH_ENUMERATION_BUFSIZE
+const tuh_hid_field_t *tuh_hid_itf_get_fields(uint8_t dev_addr, uint8_t idx, uint16_t *count);
+
+// Find field of report_type that contains usage_page:usage, return NULL if not found.
+// This is meant to be done once e.g in mount callback, then use the field with tuh_hid_field_get_*() for each report
+const tuh_hid_field_t *tuh_hid_field_find(const tuh_hid_field_t *fields, uint16_t count, uint8_t report_type,
+                                          uint16_t usage_page, uint16_t usage);
+
+// Get value of element at index from report as received by tuh_hid_report_received_cb() (report ID included if used).
+// Return false if report ID does not match or report is too short.
+bool tuh_hid_field_get_value(const tuh_hid_field_t *field, uint16_t index, const uint8_t *report, uint16_t len,
+                             int32_t *value);
+
+// Get value of usage from report. For array field, value is 1 if usage is present in report and 0 otherwise
+bool tuh_hid_field_get_usage_value(const tuh_hid_field_t *field, uint16_t usage, const uint8_t *report, uint16_t len,
+                                   int32_t *value);
+
 //--------------------------------------------------------------------+
 // Control Endpoint API
 //--------------------------------------------------------------------+
@@ -39,7 +39,8 @@ typedef enum
 {
   MSC_PROTOCOL_CBI              = 0 ,  ///< Control/Bulk/Interrupt protocol (with command completion interrupt)
   MSC_PROTOCOL_CBI_NO_INTERRUPT = 1 ,  ///< Control/Bulk/Interrupt protocol (without command completion interrupt)
-  MSC_PROTOCOL_BOT              = 0x50 ///< Bulk-Only Transport
+  MSC_PROTOCOL_BOT              = 0x50, ///< Bulk-Only Transport
+  MSC_PROTOCOL_UAS              = 0x62  ///< USB Attached SCSI
 }msc_protocol_type_t;
 
 /// MassStorage Class-Specific Control Request
@@ -84,6 +85,104 @@ typedef struct TU_ATTR_PACKED
 
 TU_VERIFY_STATIC(sizeof(msc_csw_t) == 13, "size is not correct");
 
+//--------------------------------------------------------------------+
+// USB Attached SCSI (UAS)
+// NOTE: multiple-byte fields of Information Unit (IU) are in Big Endian
+//--------------------------------------------------------------------+
+
+/// UAS class-specific descriptor type
+enum {
+  MSC_UAS_DESC_PIPE_USAGE = 0x24 ///< Pipe Usage descriptor, follows each endpoint of UAS interface
+};
+
+/// UAS Pipe ID
+typedef enum {
+  MSC_UAS_PIPE_COMMAND  = 1,
+  MSC_UAS_PIPE_STATUS   = 2,
+  MSC_UAS_PIPE_DATA_IN  = 3,
+  MSC_UAS_PIPE_DATA_OUT = 4,
+} msc_uas_pipe_id_t;
+
+/// UAS Information Unit ID
+typedef enum {
+  MSC_UAS_IU_COMMAND     = 0x01,
+  MSC_UAS_IU_SENSE       = 0x03,
+  MSC_UAS_IU_RESPONSE    = 0x04,
+  MSC_UAS_IU_TASK_MGMT   = 0x05,
+  MSC_UAS_IU_READ_READY  = 0x06,
+  MSC_UAS_IU_WRITE_READY = 0x07,
+} msc_uas_iu_id_t;
+
+/// UAS Response IU response code
+typedef enum {
+  MSC_UAS_RESPONSE_TMF_COMPLETE      = 0x00,
+  MSC_UAS_RESPONSE_INVALID_IU        = 0x02,
+  MSC_UAS_RESPONSE_TMF_NOT_SUPPORTED = 0x04,
+  MSC_UAS_RESPONSE_TMF_FAILED        = 0x05,
+  MSC_UAS_RESPONSE_TMF_SUCCEEDED     = 0x08,
+  MSC_UAS_RESPONSE_INCORRECT_LUN     = 0x09,
+  MSC_UAS_RESPONSE_OVERLAPPED_TAG    = 0x0A,
+} msc_uas_response_code_t;
+
+/// UAS Pipe Usage descriptor
+typedef struct TU_ATTR_PACKED {
+  uint8_t bLength;
+  uint8_t bDescriptorType; ///< \ref MSC_UAS_DESC_PIPE_USAGE
+  uint8_t bPipeID;         ///< \ref msc_uas_pipe_id_t
+  uint8_t reserved;
+} msc_uas_desc_pipe_usage_t;
+
+TU_VERIFY_STATIC(sizeof(msc_uas_desc_pipe_usage_t) == 4, "size is not correct");
+
+/// UAS Command IU, sent on command pipe
+typedef struct TU_ATTR_PACKED {
+  uint8_t  iu_id;       ///< \ref MSC_UAS_IU_COMMAND
+  uint8_t  reserved;
+  uint16_t tag;         ///< Identify the command in other IUs and stream ID (if streams are used)
+  uint8_t  attribute;   ///< Task priority (bit 6..3) and task attribute (bit 2..0), 0 is SIMPLE
+  uint8_t  reserved2;
+  uint8_t  add_cdb_len; ///< Additional CDB length in 4-byte unit, 0 for CDB up to 16 bytes
+  uint8_t  reserved3;
+  uint8_t  lun[8];      ///< SAM LUN, single level LUN is in byte 1
+  uint8_t  cdb[16];
+} msc_uas_command_iu_t;
+
+TU_VERIFY_STATIC(sizeof(msc_uas_command_iu_t) == 32, "size is not correct");
+
+/// UAS Read Ready/Write Ready IU, sent on status pipe when device is ready for data of a command
+typedef struct TU_ATTR_PACKED {
+  uint8_t  iu_id; ///< \ref MSC_UAS_IU_READ_READY or \ref MSC_UAS_IU_WRITE_READY
+  uint8_t  reserved;
+  uint16_t tag;
+} msc_uas_ready_iu_t;
+
+TU_VERIFY_STATIC(sizeof(msc_uas_ready_iu_t) == 4, "size is not correct");
+
+/// UAS Sense IU, sent on status pipe to complete a command
+typedef struct TU_ATTR_PACKED {
+  uint8_t  iu_id; ///< \ref MSC_UAS_IU_SENSE
+  uint8_t  reserved;
+  uint16_t tag;
+  uint16_t status_qualifier;
+  uint8_t  status;    ///< SCSI status, 0 is GOOD
+  uint8_t  reserved2[7];
+  uint16_t sense_len; ///< Length of sense data
+  uint8_t  sense[96];
+} msc_uas_sense_iu_t;
+
+TU_VERIFY_STATIC(sizeof(msc_uas_sense_iu_t) == 112, "size is not correct");
+
+/// UAS Response IU, sent on status pipe for task management or invalid IU
+typedef struct TU_ATTR_PACKED {
+  uint8_t  iu_id; ///< \ref MSC_UAS_IU_RESPONSE
+  uint8_t  reserved;
+  uint16_t tag;
+  uint8_t  add_response_info[3];
+  uint8_t  response_code;
+} msc_uas_response_iu_t;
+
+TU_VERIFY_STATIC(sizeof(msc_uas_response_iu_t) == 8, "size is not correct");
+
 //--------------------------------------------------------------------+
 // SCSI Constant
 //--------------------------------------------------------------------+
@@ -101,8 +200,18 @@ typedef enum {
   SCSI_CMD_READ_FORMAT_CAPACITY         = 0x23, ///< The command allows the Host to request a list of the possible format capacities for an installed writable media. This command also has the capability to report the writable capacity for a media when it is installed
   SCSI_CMD_READ_10                      = 0x28, ///< The READ (10) command requests that the device server read the specified logical block(s) and transfer them to the data-in buffer.
   SCSI_CMD_WRITE_10                     = 0x2A, ///< The WRITE (10) command requests that the device server transfer the specified logical block(s) from the data-out buffer and write them.
+  SCSI_CMD_SYNCHRONIZE_CACHE_10         = 0x35, ///< The SYNCHRONIZE CACHE (10) command requests that the device server write cached logical blocks to the medium.
+  SCSI_CMD_READ_16                      = 0x88, ///< The READ (16) command is READ (10) with 64-bit LBA and 32-bit transfer length.
+  SCSI_CMD_WRITE_16                     = 0x8A, ///< The WRITE (16) command is WRITE (10) with 64-bit LBA and 32-bit transfer length.
+  SCSI_CMD_SERVICE_ACTION_IN_16         = 0x9E, ///< Service Action In (16), READ CAPACITY (16) is one of its service actions
+  SCSI_CMD_REPORT_LUNS                  = 0xA0, ///< The REPORT LUNS command requests the logical unit inventory of the device, UAS has no Get Max LUN request
 }scsi_cmd_type_t;
 
+/// SCSI Service Action In (16) service actions
+enum {
+  SCSI_SERVICE_ACTION_READ_CAPACITY_16 = 0x10, ///< Read Capacity 16: used when capacity exceeds 32-bit LBA
+};
+
 /// SCSI Sense Key
 typedef enum {
   SCSI_SENSE_NONE            = 0x00, ///< no specific Sense Key. This would be the case for a successful command
@@ -375,6 +484,69 @@ typedef struct TU_ATTR_PACKED
 TU_VERIFY_STATIC(sizeof(scsi_read10_t) == 10, "size is not correct");
 TU_VERIFY_STATIC(sizeof(scsi_write10_t) == 10, "size is not correct");
 
+/// SCSI Read Capacity 16 Command
+typedef struct TU_ATTR_PACKED
+{
+  uint8_t  cmd_code       ; ///< SCSI OpCode for \ref SCSI_CMD_SERVICE_ACTION_IN_16
+  uint8_t  service_action ; ///< \ref SCSI_SERVICE_ACTION_READ_CAPACITY_16
+  uint64_t lba            ; ///< Obsolete, shall be zero
+  uint32_t alloc_length   ; ///< Size of response buffer
+  uint8_t  reserved       ;
+  uint8_t  control        ;
+} scsi_read_capacity16_t;
+
+TU_VERIFY_STATIC(sizeof(scsi_read_capacity16_t) == 16, "size is not correct");
+
+/// SCSI Read Capacity 16 Response Data
+typedef struct TU_ATTR_PACKED
+{
+  uint64_t last_lba      ; ///< The last Logical Block Address of the device
+  uint32_t block_size    ; ///< Block size in bytes
+  uint8_t  protection    ;
+  uint8_t  lbppbe        ; ///< Logical blocks per physical block exponent
+  uint16_t lowest_lba    ; ///< Lowest aligned LBA and provisioning bits
+  uint8_t  reserved[16]  ;
+} scsi_read_capacity16_resp_t;
+
+TU_VERIFY_STATIC(sizeof(scsi_read_capacity16_resp_t) == 32, "size is not correct");
+
+/// SCSI Report LUNs Command
+typedef struct TU_ATTR_PACKED
+{
+  uint8_t  cmd_code      ; ///< SCSI OpCode for \ref SCSI_CMD_REPORT_LUNS
+  uint8_t  reserved      ;
+  uint8_t  select_report ; ///< 0: all logical units with their addressing
+  uint8_t  reserved2[3]  ;
+  uint32_t alloc_length  ; ///< Size of response buffer, at least 16
+  uint8_t  reserved3     ;
+  uint8_t  control       ;
+} scsi_report_luns_t;
+
+TU_VERIFY_STATIC(sizeof(scsi_report_luns_t) == 12, "size is not correct");
+
+/// SCSI Report LUNs Response Data header, followed by 8-byte LUN entries
+typedef struct TU_ATTR_PACKED
+{
+  uint32_t list_length ; ///< Length of LUN list in bytes, 8 per LUN
+  uint32_t reserved    ;
+} scsi_report_luns_resp_t;
+
+TU_VERIFY_STATIC(sizeof(scsi_report_luns_resp_t) == 8, "size is not correct");
+
+/// SCSI Read 16 Command
+typedef struct TU_ATTR_PACKED
+{
+  uint8_t  cmd_code    ; ///< SCSI OpCode
+  uint8_t  reserved    ;
+  uint64_t lba         ; ///< The first Logical Block Address (LBA) accessed by this command
+  uint32_t block_count ; ///< Number of Blocks used by this command
+  uint8_t  reserved2   ;
+  uint8_t  control     ;
+} scsi_read16_t, scsi_write16_t;
+
+TU_VERIFY_STATIC(sizeof(scsi_read16_t) == 16, "size is not correct");
+TU_VERIFY_STATIC(sizeof(scsi_write16_t) == 16, "size is not correct");
+
 #ifdef __cplusplus
  }
 #endif
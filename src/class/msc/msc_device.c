@@ -9,7 +9,6 @@
 
 #if (CFG_TUD_ENABLED && CFG_TUD_MSC)
 
-#include "device/dcd.h"         // for faking dcd_event_xfer_complete
 #include "device/usbd.h"
 #include "device/usbd_pvt.h"
 
@@ -44,6 +43,24 @@ enum {
   MSC_STAGE_NEED_RESET,
 };
 
+#define MSC_RW_BUF_COUNT (CFG_TUD_MSC_PINGPONG ? 2 : 1)
+
+#if CFG_TUD_MSC_UAS
+// UAS command in data stage
+enum {
+  MSC_UAS_DATA_IDLE = 0,  // Read/Write Ready IU is not sent yet
+  MSC_UAS_DATA_READY,     // Read/Write Ready IU is sent, host is transferring data
+  MSC_UAS_DATA_TERMINATE, // command failed: end data-in with zero-length packet or discard the rest of data-out
+};
+
+// IUs waiting for status pipe, in order of priority
+enum {
+  MSC_UAS_STATUS_READY    = TU_BIT(0),
+  MSC_UAS_STATUS_RESPONSE = TU_BIT(1),
+  MSC_UAS_STATUS_SENSE    = TU_BIT(2),
+};
+#endif
+
 typedef struct {
   TU_ATTR_ALIGNED(4) msc_cbw_t cbw; // 31 bytes
   uint8_t  rhport;
@@ -65,12 +82,53 @@ typedef struct {
   uint8_t add_sense_qualifier;
 
   bool pending_io; // pending async IO
+
+  // READ10/WRITE10 data buffers, with ping-pong USB transfers one while application reads/writes the other
+  uint32_t io_len;                      // READ10: bytes read by application, WRITE10: bytes received from host
+  uint16_t buf_len[MSC_RW_BUF_COUNT];   // valid bytes in each buffer
+  uint8_t  usb_idx;                     // buffer of USB transfer
+  uint8_t  io_idx;                      // buffer of application read/write
+  bool     usb_busy;
+  bool     io_retry;                    // application is busy, retry is deferred
+  bool     io_failed;                   // application failed while USB transfer is in progress
+
+#if CFG_TUD_MSC_UAS
+  // USB Attached SCSI as alternate setting 1, ep_in/ep_out are data endpoints of current setting
+  uint8_t  alt;
+  uint8_t  bot_ep_in;
+  uint8_t  bot_ep_out;
+  uint8_t  uas_ep_in;
+  uint8_t  uas_ep_out;
+  uint8_t  ep_cmd;
+  uint8_t  ep_status;
+  uint16_t uas_in_mps;
+
+  uint8_t  uas_data;        // data stage of current command
+  uint8_t  status_pending;  // IUs waiting for status pipe
+  uint8_t  status_iu_id;    // IU on status pipe
+  bool     status_busy;
+  bool     cmd_armed;       // command pipe is receiving
+  uint8_t  resp_code;
+  uint16_t resp_tag;
+
+  // received commands waiting for execution
+  uint8_t  cmd_rd;
+  uint8_t  cmd_count;
+  msc_uas_command_iu_t cmd_queue[CFG_TUD_MSC_UAS_CMD_QUEUE_SIZE];
+#endif
 }mscd_interface_t;
 
 static mscd_interface_t _mscd_itf;
 
 CFG_TUD_MEM_SECTION static struct {
   TUD_EPBUF_DEF(buf, CFG_TUD_MSC_EP_BUFSIZE);
+#if CFG_TUD_MSC_PINGPONG
+  TUD_EPBUF_DEF(buf2, CFG_TUD_MSC_EP_BUFSIZE);
+#endif
+#if CFG_TUD_MSC_UAS
+  TUD_EPBUF_TYPE_DEF(msc_uas_command_iu_t, cmd_iu);
+  TUD_EPBUF_TYPE_DEF(msc_uas_sense_iu_t, status_iu); // any IU on status pipe
+#endif
 } _mscd_epbuf;
 
 TU_VERIFY_STATIC(CFG_TUD_MSC_EP_BUFSIZE >= 64, "CFG_TUD_MSC_EP_BUFSIZE must be at least 64");
@@ -81,15 +139,72 @@ TU_VERIFY_STATIC(CFG_TUD_MSC_EP_BUFSIZE >= 64, "CFG_TUD_MSC_EP_BUFSIZE must be a
 static int32_t proc_builtin_scsi(uint8_t lun, uint8_t const scsi_cmd[16], uint8_t* buffer, uint32_t bufsize);
 static void proc_read10_cmd(mscd_interface_t* p_msc);
 static void proc_read_io_data(mscd_interface_t* p_msc, int32_t nbytes);
+static void proc_read10_host_done(mscd_interface_t* p_msc, uint32_t xferred_bytes);
 static void proc_write10_cmd(mscd_interface_t* p_msc);
 static void proc_write10_host_data(mscd_interface_t* p_msc, uint32_t xferred_bytes);
-static void proc_write_io_data(mscd_interface_t* p_msc, uint32_t xferred_bytes, int32_t nbytes);
+static void proc_write10_io(mscd_interface_t* p_msc);
+static void proc_write_io_data(mscd_interface_t* p_msc, int32_t nbytes);
 static bool proc_stage_status(mscd_interface_t* p_msc);
+static void proc_cbw(mscd_interface_t* p_msc);
+static void proc_bot_reset(mscd_interface_t* p_msc);
+
+#if CFG_TUD_MSC_UAS
+static bool uas_data_xfer_begin(mscd_interface_t* p_msc);
+static void uas_fail_data(mscd_interface_t* p_msc);
+static bool uas_stage_status(mscd_interface_t* p_msc);
+#endif
 
 TU_ATTR_ALWAYS_INLINE static inline bool is_data_in(uint8_t dir) {
   return tu_bit_test(dir, 7);
 }
 
+TU_ATTR_ALWAYS_INLINE static inline bool is_uas(mscd_interface_t const* p_msc) {
+#if CFG_TUD_MSC_UAS
+  return p_msc->alt != 0;
+#else
+  (void) p_msc;
+  return false;
+#endif
+}
+
+// Queue transfer of data stage, UAS host is told to start the transfer with Read/Write Ready IU first
+static bool data_xfer(mscd_interface_t* p_msc, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes) {
+#if CFG_TUD_MSC_UAS
+  TU_ASSERT(uas_data_xfer_begin(p_msc));
+#endif
+  return usbd_edpt_xfer(p_msc->rhport, ep_addr, buffer, total_bytes, false);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t* rw_buf(uint8_t idx) {
+#if CFG_TUD_MSC_PINGPONG
+  return idx ? _mscd_epbuf.buf2 : _mscd_epbuf.buf;
+#else
+  (void) idx;
+  return _mscd_epbuf.buf;
+#endif
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t rw_buf_next(uint8_t idx) {
+  return (uint8_t) ((idx + 1u) % MSC_RW_BUF_COUNT);
+}
+
+// Invoke complete callback once status is sent
+static void proc_cmd_complete(msc_cbw_t const* p_cbw) {
+  switch (p_cbw->command[0]) {
+    case SCSI_CMD_READ_10:
+      tud_msc_read10_complete_cb(p_cbw->lun);
+      break;
+
+    case SCSI_CMD_WRITE_10:
+      tud_msc_write10_complete_cb(p_cbw->lun);
+      break;
+
+    default:
+      tud_msc_scsi_complete_cb(p_cbw->lun, p_cbw->command);
+      break;
+  }
+}
+
 TU_ATTR_ALWAYS_INLINE static inline bool send_csw(mscd_interface_t* p_msc) {
   // Data residue is always = host expect - actual transferred
   uint8_t rhport = p_msc->rhport;
@@ -119,6 +234,13 @@ static void fail_scsi_op(mscd_interface_t* p_msc, uint8_t status) {
     (void) tud_msc_set_sense(p_cbw->lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);
   }
 
+#if CFG_TUD_MSC_UAS
+  if (is_uas(p_msc)) {
+    uas_fail_data(p_msc); // UAS does not stall data pipes
+    return;
+  }
+#endif
+
   // If there is data stage and not yet complete, stall it
   if (p_cbw->total_bytes && p_csw->data_residue) {
     if (is_data_in(p_cbw->dir)) {
@@ -185,6 +307,12 @@ static bool proc_stage_status(mscd_interface_t *p_msc) {
   uint8_t rhport = p_msc->rhport;
   msc_cbw_t const *p_cbw = &p_msc->cbw;
 
+#if CFG_TUD_MSC_UAS
+  if (is_uas(p_msc)) {
+    return uas_stage_status(p_msc);
+  }
+#endif
+
   // skip status if epin is currently stalled, will do it when received Clear Stall request
   if (!usbd_edpt_stalled(rhport, p_msc->ep_in)) {
     if ((p_cbw->total_bytes > p_msc->xferred_len) && is_data_in(p_cbw->dir)) {
@@ -281,6 +409,284 @@ TU_ATTR_UNUSED tu_static tu_lookup_table_t const _msc_scsi_cmd_table = {
 
 #endif
 
+//--------------------------------------------------------------------+
+// Block Cache
+// Lines of CFG_TUD_MSC_CACHE_LINE_SIZE bytes between READ10/WRITE10 processing and application callbacks. Dirty lines
+// are written back when evicted (LRU), on flush request or once idle for CFG_TUD_MSC_CACHE_FLUSH_MS (counted with SOF).
+//--------------------------------------------------------------------+
+#if CFG_TUD_MSC_CACHE
+
+typedef struct {
+  uint32_t lba;        // first block of line
+  uint32_t stamp;      // last access, for LRU eviction
+  uint16_t block_size;
+  uint16_t blocks;     // number of valid blocks (last line of disk can be shorter), 0 if line is not used
+  uint8_t  lun;
+  bool     dirty;
+} mscd_cache_line_t;
+
+static struct {
+  mscd_cache_line_t line[CFG_TUD_MSC_CACHE];
+  uint32_t stamp;
+  uint32_t seq_lba; // next block of sequential read
+  uint8_t  seq_lun;
+
+  // idle write back, idle_ms is counted in SOF isr
+  volatile uint32_t idle_ms;
+  volatile bool flush_queued;
+  bool     sof_en;
+  usbd_sof_tick_t sof_tick;
+} _mscd_cache;
+
+TU_ATTR_ALIGNED(4) static uint8_t _mscd_cache_buf[CFG_TUD_MSC_CACHE][CFG_TUD_MSC_CACHE_LINE_SIZE];
+
+TU_ATTR_ALWAYS_INLINE static inline uint32_t cache_line_bytes(mscd_cache_line_t const* line) {
+  return (uint32_t) line->blocks * line->block_size;
+}
+
+// number of blocks per line, 0 if block size cannot be cached
+static uint16_t cache_line_blocks(uint16_t block_size) {
+  if (block_size == 0 || block_size > CFG_TUD_MSC_CACHE_LINE_SIZE || (CFG_TUD_MSC_CACHE_LINE_SIZE % block_size) != 0) {
+    return 0;
+  }
+  return (uint16_t) (CFG_TUD_MSC_CACHE_LINE_SIZE / block_size);
+}
+
+static int8_t cache_find(uint8_t lun, uint32_t line_lba, uint16_t block_size) {
+  for (uint8_t i = 0; i < CFG_TUD_MSC_CACHE; i++) {
+    mscd_cache_line_t const* line = &_mscd_cache.line[i];
+    if (line->blocks > 0 && line->lun == lun && line->lba == line_lba && line->block_size == block_size) {
+      return (int8_t) i;
+    }
+  }
+  return -1;
+}
+
+// Read/write whole line with application callbacks, return number of bytes or TUD_MSC_RET_BUSY/TUD_MSC_RET_ERROR.
+// Line is transferred again from its start if application is busy.
+static int32_t cache_line_io(uint8_t idx, bool is_write) {
+  mscd_cache_line_t const* line = &_mscd_cache.line[idx];
+  uint8_t* buf = _mscd_cache_buf[idx];
+  uint32_t const total = cache_line_bytes(line);
+  uint32_t done = 0;
+
+  while (done < total) {
+    uint32_t const lba = line->lba + done / line->block_size;
+    uint32_t const offset = done % line->block_size;
+    int32_t const nbytes = is_write ? tud_msc_write10_cb(line->lun, lba, offset, buf + done, total - done)
+                                    : tud_msc_read10_cb(line->lun, lba, offset, buf + done, total - done);
+    if (nbytes == TUD_MSC_RET_BUSY) {
+      return TUD_MSC_RET_BUSY;
+    }
+    if (nbytes < 0) {
+      TU_LOG_DRV("  Cache line %s failed\r\n", is_write ? "write" : "read");
+      return TUD_MSC_RET_ERROR; // including TUD_MSC_RET_ASYNC which is not supported with cache
+    }
+    done += tu_min32((uint32_t) nbytes, total - done);
+  }
+
+  return (int32_t) total;
+}
+
+static int32_t cache_line_flush(uint8_t idx) {
+  mscd_cache_line_t* line = &_mscd_cache.line[idx];
+  if (!line->dirty) {
+    return 1;
+  }
+
+  int32_t const ret = cache_line_io(idx, true);
+  if (ret != TUD_MSC_RET_BUSY) {
+    line->dirty = false;
+    if (ret < 0) {
+      line->blocks = 0; // data is lost, drop the line
+    }
+  }
+  return ret;
+}
+
+// write back all dirty lines: return positive if all succeeded, TUD_MSC_RET_BUSY or TUD_MSC_RET_ERROR otherwise
+static int32_t cache_flush_all(void) {
+  int32_t ret = 1;
+  for (uint8_t i = 0; i < CFG_TUD_MSC_CACHE; i++) {
+    int32_t const line_ret = cache_line_flush(i);
+    if (line_ret <= 0 && ret != TUD_MSC_RET_ERROR) {
+      ret = line_ret;
+    }
+  }
+  return ret;
+}
+
+// Flush for SCSI command, set sense and return false if failed
+static bool cache_flush_scsi(uint8_t lun) {
+  int32_t const ret = cache_flush_all();
+  if (ret == TUD_MSC_RET_BUSY) {
+    (void) tud_msc_set_sense(lun, SCSI_SENSE_NOT_READY, 0x04, 0x01); // in process of becoming ready
+  } else if (ret < 0) {
+    (void) tud_msc_set_sense(lun, SCSI_SENSE_MEDIUM_ERROR, 0x0C, 0x00); // write error
+  } else {
+    return true;
+  }
+  return false;
+}
+
+// Get line of line_lba, evict least recently used one if not cached. Line is loaded from medium unless the first
+// overwrite_bytes of it are going to be written. Allow to evict dirty line only if allow_flush is true.
+// Return line index or TUD_MSC_RET_BUSY/TUD_MSC_RET_ERROR
+static int32_t cache_line_get(uint8_t lun, uint32_t line_lba, uint16_t block_size, uint32_t overwrite_bytes,
+                              bool allow_flush) {
+  int8_t idx = cache_find(lun, line_lba, block_size);
+
+  if (idx < 0) {
+    // free line first, then least recently used
+    for (uint8_t i = 0; i < CFG_TUD_MSC_CACHE; i++) {
+      mscd_cache_line_t const* line = &_mscd_cache.line[i];
+      if (line->blocks == 0) {
+        idx = (int8_t) i;
+        break;
+      }
+      if ((allow_flush || !line->dirty) && (idx < 0 || line->stamp < _mscd_cache.line[idx].stamp)) {
+        idx = (int8_t) i;
+      }
+    }
+    TU_VERIFY(idx >= 0, TUD_MSC_RET_BUSY);
+
+    int32_t const flush_ret = cache_line_flush((uint8_t) idx);
+    TU_VERIFY(flush_ret > 0, flush_ret);
+
+    uint32_t block_count = 0;
+    uint16_t capacity_block_size = 0;
+    tud_msc_capacity_cb(lun, &block_count, &capacity_block_size);
+    TU_VERIFY(line_lba < block_count, TUD_MSC_RET_ERROR);
+
+    mscd_cache_line_t* line = &_mscd_cache.line[idx];
+    line->lba        = line_lba;
+    line->lun        = lun;
+    line->block_size = block_size;
+    line->blocks     = (uint16_t) tu_min32(cache_line_blocks(block_size), block_count - line_lba);
+    line->dirty      = false;
+
+    if (overwrite_bytes < cache_line_bytes(line)) {
+      int32_t const read_ret = cache_line_io((uint8_t) idx, false);
+      if (read_ret <= 0) {
+        line->blocks = 0;
+        return read_ret;
+      }
+    }
+  }
+
+  _mscd_cache.line[idx].stamp = ++_mscd_cache.stamp;
+  return idx;
+}
+
+// Deferred write back, queued by SOF after idle timeout or by bus reset
+static void cache_idle_flush(void* param) {
+  (void) param;
+  _mscd_cache.flush_queued = false;
+  _mscd_cache.idle_ms = 0;
+
+  // stop counting once there is nothing left to write back, otherwise retry after another timeout
+  bool const done = (cache_flush_all() > 0);
+  if (done == _mscd_cache.sof_en) {
+    _mscd_cache.sof_en = !done;
+    _mscd_cache.sof_tick.synced = false;
+    usbd_sof_enable(_mscd_itf.rhport, SOF_CONSUMER_MSC, !done);
+  }
+}
+
+// Locate byte position of request in its line: return line lba and set offset within line
+static uint32_t cache_locate(uint32_t lba, uint32_t pos, uint16_t block_size, uint16_t line_blocks,
+                             uint32_t* line_offset) {
+  uint32_t const cur_lba = lba + pos / block_size;
+  uint32_t const line_lba = cur_lba - (cur_lba % line_blocks);
+  *line_offset = (cur_lba - line_lba) * block_size + (pos % block_size);
+  return line_lba;
+}
+
+static int32_t cache_read(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize,
+                          uint16_t block_size) {
+  uint16_t const line_blocks = cache_line_blocks(block_size);
+  if (line_blocks == 0) {
+    return tud_msc_read10_cb(lun, lba, offset, buffer, bufsize);
+  }
+
+  _mscd_cache.idle_ms = 0;
+  bool const sequential = (offset == 0 && lun == _mscd_cache.seq_lun && lba == _mscd_cache.seq_lba);
+  uint32_t done = 0;
+
+  while (done < bufsize) {
+    uint32_t line_offset;
+    uint32_t const line_lba = cache_locate(lba, offset + done, block_size, line_blocks, &line_offset);
+    bool const miss = cache_find(lun, line_lba, block_size) < 0;
+
+    int32_t const idx = cache_line_get(lun, line_lba, block_size, 0, true);
+    if (idx < 0) {
+      return done ? (int32_t) done : idx;
+    }
+
+    mscd_cache_line_t const* line = &_mscd_cache.line[idx];
+    if (line_offset >= cache_line_bytes(line)) {
+      return done ? (int32_t) done : TUD_MSC_RET_ERROR; // beyond end of disk
+    }
+
+    uint32_t const nbytes = tu_min32(bufsize - done, cache_line_bytes(line) - line_offset);
+    memcpy(buffer + done, _mscd_cache_buf[idx] + line_offset, nbytes);
+    done += nbytes;
+
+    // read ahead next line of sequential read, without evicting dirty lines
+    if (CFG_TUD_MSC_CACHE > 1 && miss && sequential) {
+      (void) cache_line_get(lun, line_lba + line_blocks, block_size, 0, false);
+    }
+  }
+
+  _mscd_cache.seq_lun = lun;
+  _mscd_cache.seq_lba = lba + (offset + done) / block_size;
+  return (int32_t) done;
+}
+
+// remaining is number of bytes left in WRITE10 command including this buffer
+static int32_t cache_write(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t const* buffer, uint32_t bufsize,
+                           uint16_t block_size, uint32_t remaining) {
+  uint16_t const line_blocks = cache_line_blocks(block_size);
+  if (line_blocks == 0) {
+    return tud_msc_write10_cb(lun, lba, offset, (uint8_t*) (uintptr_t) buffer, bufsize);
+  }
+
+  _mscd_cache.idle_ms = 0;
+  uint32_t done = 0;
+
+  while (done < bufsize) {
+    uint32_t line_offset;
+    uint32_t const line_lba = cache_locate(lba, offset + done, block_size, line_blocks, &line_offset);
+
+    // skip loading line if it is going to be overwritten entirely
+    uint32_t const overwrite_bytes = (line_offset == 0) ? (remaining - done) : 0;
+    int32_t const idx = cache_line_get(lun, line_lba, block_size, overwrite_bytes, true);
+    if (idx < 0) {
+      return done ? (int32_t) done : idx;
+    }
+
+    mscd_cache_line_t* line = &_mscd_cache.line[idx];
+    if (line_offset >= cache_line_bytes(line)) {
+      return done ? (int32_t) done : TUD_MSC_RET_ERROR; // beyond end of disk
+    }
+
+    uint32_t const nbytes = tu_min32(bufsize - done, cache_line_bytes(line) - line_offset);
+    memcpy(_mscd_cache_buf[idx] + line_offset, buffer + done, nbytes);
+    line->dirty = true;
+    done += nbytes;
+  }
+
+  if (!_mscd_cache.sof_en) {
+    _mscd_cache.sof_en = true;
+    _mscd_cache.sof_tick.synced = false;
+    usbd_sof_enable(_mscd_itf.rhport, SOF_CONSUMER_MSC, true);
+  }
+
+  return (int32_t) done;
+}
+
+#endif
+
 //--------------------------------------------------------------------+
 // APPLICATION API
 //--------------------------------------------------------------------+
@@ -310,7 +716,7 @@ static void proc_async_io_done(void *bytes_io) {
       break;
 
     case SCSI_CMD_WRITE_10:
-      proc_write_io_data(p_msc, (uint32_t) nbytes, nbytes);
+      proc_write_io_data(p_msc, nbytes);
       break;
 
     default: break; // nothing to do
@@ -322,6 +728,54 @@ static void proc_async_io_done(void *bytes_io) {
   }
 }
 
+// Application returned TUD_MSC_RET_BUSY: invoke read/write callback again
+static void proc_io_retry(void* param) {
+  (void) param;
+  mscd_interface_t* p_msc = &_mscd_itf;
+  TU_VERIFY(p_msc->io_retry, ); // cleared by bus reset
+  p_msc->io_retry = false;
+  TU_VERIFY(p_msc->stage == MSC_STAGE_DATA, );
+
+  switch (p_msc->cbw.command[0]) {
+    case SCSI_CMD_READ_10:
+      proc_read10_cmd(p_msc);
+      break;
+
+    case SCSI_CMD_WRITE_10:
+      proc_write10_io(p_msc);
+      break;
+
+    default: break; // nothing to do
+  }
+
+  if (p_msc->stage == MSC_STAGE_STATUS) {
+    proc_stage_status(p_msc);
+  }
+}
+
+bool tud_msc_cache_flush(void) {
+#if CFG_TUD_MSC_CACHE
+  return cache_flush_all() > 0;
+#else
+  return true;
+#endif
+}
+
+void tud_msc_cache_discard(uint8_t lun) {
+#if CFG_TUD_MSC_CACHE
+  for (uint8_t i = 0; i < CFG_TUD_MSC_CACHE; i++) {
+    mscd_cache_line_t* line = &_mscd_cache.line[i];
+    if (line->lun == lun) {
+      line->blocks = 0;
+      line->dirty  = false;
+    }
+  }
+  _mscd_cache.seq_lba = UINT32_MAX;
+#else
+  (void) lun;
+#endif
+}
+
 bool tud_msc_async_io_done(int32_t bytes_io, bool in_isr) {
   // Precheck to avoid queueing multiple RW done callback
   TU_VERIFY(_mscd_itf.pending_io);
@@ -332,12 +786,354 @@ bool tud_msc_async_io_done(int32_t bytes_io, bool in_isr) {
   return true;
 }
 
+//--------------------------------------------------------------------+
+// USB Attached SCSI (UAS)
+// Command IUs are queued as they arrive and executed one at a time in order by the same state machine as Bulk-Only
+// with a CBW made up from each of them. Read/Write Ready IU is sent on status pipe before data stage and Sense IU
+// completes the command. Command pipe is not re-armed while the queue is full.
+//--------------------------------------------------------------------+
+#if CFG_TUD_MSC_UAS
+
+// Data length host expects: READ10/WRITE10 from capacity, others from allocation (parameter list) length of CDB
+static uint32_t uas_cmd_data_len(uint8_t lun, uint8_t const cdb[16]) {
+  switch (cdb[0]) {
+    case SCSI_CMD_READ_10:
+    case SCSI_CMD_WRITE_10: {
+      uint32_t block_count = 0;
+      uint16_t block_size = 0;
+      tud_msc_capacity_cb(lun, &block_count, &block_size);
+      if (block_size == 0) {
+        set_sense_medium_not_present(lun);
+      }
+      uint16_t const count = tu_ntohs(tu_unaligned_read16(cdb + offsetof(scsi_write10_t, block_count)));
+      return (uint32_t) count * block_size;
+    }
+
+    case SCSI_CMD_TEST_UNIT_READY:
+    case SCSI_CMD_START_STOP_UNIT:
+    case SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL:
+    case SCSI_CMD_SYNCHRONIZE_CACHE_10:
+      return 0;
+
+    case SCSI_CMD_READ_CAPACITY_10:
+      return sizeof(scsi_read_capacity10_resp_t);
+
+    case SCSI_CMD_INQUIRY:
+      return tu_ntohs(tu_unaligned_read16(cdb + 3));
+
+    default: break;
+  }
+
+  // standard position by command group
+  switch (cdb[0] >> 5) {
+    case 0: return cdb[4];                                   // 6-byte
+    case 1:
+    case 2: return tu_ntohs(tu_unaligned_read16(cdb + 7));  // 10-byte
+    case 4: return tu_ntohl(tu_unaligned_read32(cdb + 10)); // 16-byte
+    case 5: return tu_ntohl(tu_unaligned_read32(cdb + 6));  // 12-byte
+    default: return 0;
+  }
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool uas_cmd_is_data_out(uint8_t const cdb[16]) {
+  return cdb[0] == SCSI_CMD_WRITE_10 || cdb[0] == SCSI_CMD_MODE_SELECT_6;
+}
+
+static bool uas_cmd_arm(mscd_interface_t* p_msc) {
+  if (p_msc->cmd_armed || p_msc->cmd_count >= CFG_TUD_MSC_UAS_CMD_QUEUE_SIZE) {
+    return true;
+  }
+  p_msc->cmd_armed = true;
+  return usbd_edpt_xfer(p_msc->rhport, p_msc->ep_cmd, (uint8_t*) &_mscd_epbuf.cmd_iu, sizeof(msc_uas_command_iu_t),
+                        false);
+}
+
+// Send next pending IU if status pipe is idle
+static bool uas_status_send(mscd_interface_t* p_msc) {
+  if (p_msc->status_busy || p_msc->status_pending == 0) {
+    return true;
+  }
+
+  msc_uas_sense_iu_t* iu = &_mscd_epbuf.status_iu;
+  uint16_t len;
+  tu_memclr(iu, offsetof(msc_uas_sense_iu_t, sense));
+
+  if (p_msc->status_pending & MSC_UAS_STATUS_READY) {
+    p_msc->status_pending &= (uint8_t) ~MSC_UAS_STATUS_READY;
+    iu->iu_id = is_data_in(p_msc->cbw.dir) ? MSC_UAS_IU_READ_READY : MSC_UAS_IU_WRITE_READY;
+    iu->tag   = tu_htons((uint16_t) p_msc->cbw.tag);
+    len = sizeof(msc_uas_ready_iu_t);
+  } else if (p_msc->status_pending & MSC_UAS_STATUS_RESPONSE) {
+    p_msc->status_pending &= (uint8_t) ~MSC_UAS_STATUS_RESPONSE;
+    msc_uas_response_iu_t* resp = (msc_uas_response_iu_t*) iu;
+    resp->iu_id         = MSC_UAS_IU_RESPONSE;
+    resp->tag           = tu_htons(p_msc->resp_tag);
+    resp->response_code = p_msc->resp_code;
+    len = sizeof(msc_uas_response_iu_t);
+  } else {
+    p_msc->status_pending &= (uint8_t) ~MSC_UAS_STATUS_SENSE;
+    iu->iu_id = MSC_UAS_IU_SENSE;
+    iu->tag   = tu_htons((uint16_t) p_msc->cbw.tag);
+
+    // failed: CHECK CONDITION with sense data, which is then cleared since host does not need REQUEST SENSE
+    if (p_msc->csw.status != MSC_CSW_STATUS_PASSED) {
+      scsi_sense_fixed_resp_t sense = {
+        .response_code       = 0x70, // current, fixed format
+        .valid               = 1,
+        .sense_key           = (uint8_t) (p_msc->sense_key & 0x0F),
+        .add_sense_len       = sizeof(scsi_sense_fixed_resp_t) - 8,
+        .add_sense_code      = p_msc->add_sense_code,
+        .add_sense_qualifier = p_msc->add_sense_qualifier
+      };
+      iu->status    = 0x02;
+      iu->sense_len = tu_htons(sizeof(sense));
+      memcpy(iu->sense, &sense, sizeof(sense));
+      (void) tud_msc_set_sense(p_msc->cbw.lun, 0, 0, 0);
+    }
+    len = (uint16_t) (offsetof(msc_uas_sense_iu_t, sense) + tu_ntohs(iu->sense_len));
+  }
+
+  p_msc->status_iu_id = iu->iu_id;
+  p_msc->status_busy  = true;
+  return usbd_edpt_xfer(p_msc->rhport, p_msc->ep_status, (uint8_t*) iu, len, false);
+}
+
+static void uas_respond(mscd_interface_t* p_msc, uint16_t tag, uint8_t code) {
+  TU_LOG_DRV("  UAS Response tag = %u, code = %u\r\n", tag, code);
+  p_msc->resp_tag  = tag;
+  p_msc->resp_code = code;
+  p_msc->status_pending |= MSC_UAS_STATUS_RESPONSE;
+  TU_ASSERT(uas_status_send(p_msc), );
+}
+
+static bool uas_tag_in_use(mscd_interface_t const* p_msc, uint16_t tag) {
+  if (p_msc->stage != MSC_STAGE_CMD && p_msc->cbw.tag == tag) {
+    return true;
+  }
+  for (uint8_t i = 0; i < p_msc->cmd_count; i++) {
+    uint8_t const idx = (uint8_t) ((p_msc->cmd_rd + i) % CFG_TUD_MSC_UAS_CMD_QUEUE_SIZE);
+    if (tu_ntohs(p_msc->cmd_queue[idx].tag) == tag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Execute next queued command if idle
+static void uas_cmd_next(mscd_interface_t* p_msc) {
+  if (p_msc->stage != MSC_STAGE_CMD || p_msc->cmd_count == 0) {
+    return;
+  }
+
+  msc_uas_command_iu_t const* iu = &p_msc->cmd_queue[p_msc->cmd_rd];
+  msc_cbw_t* p_cbw = &p_msc->cbw;
+  tu_memclr(p_cbw, sizeof(msc_cbw_t));
+  p_cbw->signature   = MSC_CBW_SIGNATURE;
+  p_cbw->tag         = tu_ntohs(iu->tag);
+  p_cbw->lun         = iu->lun[1];
+  p_cbw->cmd_len     = sizeof(iu->cdb);
+  p_cbw->dir         = uas_cmd_is_data_out(iu->cdb) ? 0 : TUSB_DIR_IN_MASK;
+  memcpy(p_cbw->command, iu->cdb, sizeof(iu->cdb));
+  p_cbw->total_bytes = uas_cmd_data_len(p_cbw->lun, iu->cdb);
+
+  p_msc->cmd_rd = (uint8_t) ((p_msc->cmd_rd + 1) % CFG_TUD_MSC_UAS_CMD_QUEUE_SIZE);
+  p_msc->cmd_count--;
+  TU_ASSERT(uas_cmd_arm(p_msc), ); // a slot is freed
+
+  p_msc->uas_data = MSC_UAS_DATA_IDLE;
+  proc_cbw(p_msc);
+
+  if (p_msc->stage == MSC_STAGE_STATUS) {
+    proc_stage_status(p_msc);
+  }
+}
+
+static void uas_cmd_received(mscd_interface_t* p_msc, uint32_t xferred_bytes) {
+  msc_uas_command_iu_t const* iu = &_mscd_epbuf.cmd_iu;
+  uint16_t const tag = tu_ntohs(iu->tag);
+  p_msc->cmd_armed = false;
+
+  if (xferred_bytes < sizeof(msc_uas_ready_iu_t)) {
+    // too short to even respond to
+  } else if (iu->iu_id == MSC_UAS_IU_TASK_MGMT) {
+    uas_respond(p_msc, tag, MSC_UAS_RESPONSE_TMF_NOT_SUPPORTED);
+  } else if (iu->iu_id != MSC_UAS_IU_COMMAND || xferred_bytes != sizeof(msc_uas_command_iu_t) || iu->add_cdb_len) {
+    uas_respond(p_msc, tag, MSC_UAS_RESPONSE_INVALID_IU);
+  } else if (uas_tag_in_use(p_msc, tag)) {
+    uas_respond(p_msc, tag, MSC_UAS_RESPONSE_OVERLAPPED_TAG);
+  } else {
+    uint8_t const idx = (uint8_t) ((p_msc->cmd_rd + p_msc->cmd_count) % CFG_TUD_MSC_UAS_CMD_QUEUE_SIZE);
+    p_msc->cmd_queue[idx] = *iu;
+    p_msc->cmd_count++;
+  }
+
+  TU_ASSERT(uas_cmd_arm(p_msc), );
+  uas_cmd_next(p_msc);
+}
+
+static void uas_status_sent(mscd_interface_t* p_msc) {
+  p_msc->status_busy = false;
+
+  if (p_msc->status_iu_id == MSC_UAS_IU_SENSE) {
+    TU_LOG_DRV("  SCSI Status [Lun%u] = %u\r\n", p_msc->cbw.lun, p_msc->csw.status);
+    proc_cmd_complete(&p_msc->cbw);
+    p_msc->stage = MSC_STAGE_CMD;
+  }
+
+  TU_ASSERT(uas_status_send(p_msc), );
+  uas_cmd_next(p_msc);
+}
+
+// Tell host to start data stage with Read/Write Ready IU, once per command
+static bool uas_data_xfer_begin(mscd_interface_t* p_msc) {
+  if (!is_uas(p_msc) || p_msc->uas_data != MSC_UAS_DATA_IDLE) {
+    return true;
+  }
+  p_msc->uas_data = MSC_UAS_DATA_READY;
+  p_msc->status_pending |= MSC_UAS_STATUS_READY;
+  return uas_status_send(p_msc);
+}
+
+// discard data-out of failed WRITE10 that host is still sending
+static bool uas_discard_xfer(mscd_interface_t* p_msc) {
+  uint16_t const len = (uint16_t) tu_min32(CFG_TUD_MSC_EP_BUFSIZE, p_msc->cbw.total_bytes - p_msc->io_len);
+  return usbd_edpt_xfer(p_msc->rhport, p_msc->ep_out, _mscd_epbuf.buf, len, false);
+}
+
+// Command failed. Data pipes are not stalled, host is still sending data-out announced by Write Ready IU.
+// Only WRITE10 can fail in the middle of data-out, others have all data received before being processed.
+static void uas_fail_data(mscd_interface_t* p_msc) {
+  msc_cbw_t const* p_cbw = &p_msc->cbw;
+  if (p_msc->uas_data == MSC_UAS_DATA_READY && SCSI_CMD_WRITE_10 == p_cbw->command[0] &&
+      p_msc->io_len < p_cbw->total_bytes) {
+    p_msc->uas_data = MSC_UAS_DATA_TERMINATE;
+    p_msc->stage    = MSC_STAGE_DATA;
+    TU_ASSERT(uas_discard_xfer(p_msc), );
+  }
+}
+
+static void uas_terminate_data(mscd_interface_t* p_msc, uint8_t ep_addr, uint32_t xferred_bytes) {
+  if (ep_addr == p_msc->ep_out) {
+    p_msc->io_len += xferred_bytes;
+    if (xferred_bytes > 0 && p_msc->io_len < p_msc->cbw.total_bytes) {
+      TU_ASSERT(uas_discard_xfer(p_msc), );
+      return;
+    }
+  }
+  p_msc->uas_data = MSC_UAS_DATA_IDLE;
+  p_msc->stage    = MSC_STAGE_STATUS;
+}
+
+static bool uas_stage_status(mscd_interface_t* p_msc) {
+  msc_cbw_t const* p_cbw = &p_msc->cbw;
+
+  // Data-in is shorter than host expects: end its transfer with zero-length packet if last packet is full-sized
+  if (p_msc->uas_data == MSC_UAS_DATA_READY && is_data_in(p_cbw->dir) && p_msc->xferred_len < p_cbw->total_bytes &&
+      (p_msc->xferred_len % p_msc->uas_in_mps) == 0) {
+    p_msc->uas_data = MSC_UAS_DATA_TERMINATE;
+    p_msc->stage    = MSC_STAGE_DATA;
+    return usbd_edpt_xfer(p_msc->rhport, p_msc->ep_in, NULL, 0, false);
+  }
+
+  p_msc->stage = MSC_STAGE_STATUS_SENT;
+  p_msc->status_pending |= MSC_UAS_STATUS_SENSE;
+  return uas_status_send(p_msc);
+}
+
+// Open pipes of UAS alternate setting following Bulk-Only one, return its length or 0 if there is none.
+// Data pipes can share endpoints with Bulk-Only, each endpoint is opened only once.
+static uint16_t uas_open(mscd_interface_t* p_msc, uint8_t const* p_desc, uint16_t max_len) {
+  uint8_t const* desc_start = p_desc;
+  uint8_t const* desc_end = p_desc + max_len;
+  TU_VERIFY(max_len >= sizeof(tusb_desc_interface_t) && tu_desc_type(p_desc) == TUSB_DESC_INTERFACE, 0);
+
+  tusb_desc_interface_t const* desc_itf = (tusb_desc_interface_t const*) p_desc;
+  TU_VERIFY(desc_itf->bInterfaceNumber == p_msc->itf_num && desc_itf->bAlternateSetting == 1 &&
+            desc_itf->bInterfaceProtocol == MSC_PROTOCOL_UAS, 0);
+
+  tusb_desc_endpoint_t const* desc_ep = NULL;
+  p_desc = tu_desc_next(p_desc);
+  while (tu_desc_in_bounds(p_desc, desc_end)) {
+    uint8_t const desc_type = tu_desc_type(p_desc);
+    if (desc_type == TUSB_DESC_INTERFACE || desc_type == TUSB_DESC_INTERFACE_ASSOCIATION) {
+      break;
+    }
+
+    if (desc_type == TUSB_DESC_ENDPOINT) {
+      desc_ep = (tusb_desc_endpoint_t const*) p_desc;
+      TU_ASSERT(TUSB_XFER_BULK == desc_ep->bmAttributes.xfer, 0);
+      if (desc_ep->bEndpointAddress != p_msc->bot_ep_in && desc_ep->bEndpointAddress != p_msc->bot_ep_out) {
+        TU_ASSERT(usbd_edpt_open(p_msc->rhport, desc_ep), 0);
+      }
+    } else if (desc_type == MSC_UAS_DESC_PIPE_USAGE && desc_ep != NULL) {
+      uint8_t const ep_addr = desc_ep->bEndpointAddress;
+      switch (((msc_uas_desc_pipe_usage_t const*) p_desc)->bPipeID) {
+        case MSC_UAS_PIPE_COMMAND:  p_msc->ep_cmd     = ep_addr; break;
+        case MSC_UAS_PIPE_STATUS:   p_msc->ep_status  = ep_addr; break;
+        case MSC_UAS_PIPE_DATA_OUT: p_msc->uas_ep_out = ep_addr; break;
+        case MSC_UAS_PIPE_DATA_IN:
+          p_msc->uas_ep_in  = ep_addr;
+          p_msc->uas_in_mps = tu_edpt_packet_size(desc_ep);
+          break;
+        default: break;
+      }
+    } else {
+      // nothing to do
+    }
+
+    p_desc = tu_desc_next(p_desc);
+  }
+
+  TU_ASSERT(p_msc->ep_cmd && p_msc->ep_status && p_msc->uas_ep_in && p_msc->uas_ep_out && p_msc->uas_in_mps, 0);
+  return (uint16_t) (p_desc - desc_start);
+}
+
+// Select Bulk-Only (0) or UAS (1): all pipes are aborted and reset to DATA0, state of both protocols is reset
+static bool uas_set_alt(mscd_interface_t* p_msc, uint8_t alt) {
+  TU_VERIFY(alt <= 1);
+  uint8_t const rhport = p_msc->rhport;
+  TU_LOG_DRV("  MSC Set Interface %s\r\n", alt ? "UAS" : "BOT");
+
+  uint8_t const ep_list[] = {p_msc->bot_ep_in, p_msc->bot_ep_out, p_msc->uas_ep_in, p_msc->uas_ep_out,
+                             p_msc->ep_cmd, p_msc->ep_status};
+  for (uint8_t i = 0; i < TU_ARRAY_SIZE(ep_list); i++) {
+    usbd_edpt_stall(rhport, ep_list[i]);
+    usbd_edpt_clear_stall(rhport, ep_list[i]);
+  }
+
+  proc_bot_reset(p_msc);
+  p_msc->pending_io     = false;
+  p_msc->io_retry       = false;
+  p_msc->uas_data       = MSC_UAS_DATA_IDLE;
+  p_msc->status_pending = 0;
+  p_msc->status_busy    = false;
+  p_msc->cmd_armed      = false;
+  p_msc->cmd_rd         = 0;
+  p_msc->cmd_count      = 0;
+
+  p_msc->alt = alt;
+  if (alt) {
+    p_msc->ep_in  = p_msc->uas_ep_in;
+    p_msc->ep_out = p_msc->uas_ep_out;
+    return uas_cmd_arm(p_msc);
+  } else {
+    p_msc->ep_in  = p_msc->bot_ep_in;
+    p_msc->ep_out = p_msc->bot_ep_out;
+    return prepare_cbw(p_msc);
+  }
+}
+
+#endif
+
 //--------------------------------------------------------------------+
 // USBD Driver API
 //--------------------------------------------------------------------+
 void mscd_init(void) {
   TU_LOG_INT(CFG_TUD_MSC_LOG_LEVEL, sizeof(mscd_interface_t));
   tu_memclr(&_mscd_itf, sizeof(mscd_interface_t));
+#if CFG_TUD_MSC_CACHE
+  _mscd_cache.seq_lba = UINT32_MAX;
+#endif
 }
 
 bool mscd_deinit(void) {
@@ -345,16 +1141,28 @@ bool mscd_deinit(void) {
 }
 
 void mscd_reset(uint8_t rhport) {
-  (void) rhport;
   tu_memclr(&_mscd_itf, sizeof(mscd_interface_t));
+  _mscd_itf.rhport = rhport;
+
+#if CFG_TUD_MSC_CACHE
+  // lines remain valid since medium is unchanged, but write back dirty ones since host may be gone. Deferred so that
+  // bus reset is not held up by medium writes. SOF consumers are cleared by usbd
+  _mscd_cache.sof_en = false;
+  if (!_mscd_cache.flush_queued) {
+    _mscd_cache.flush_queued = true;
+    usbd_defer_func(cache_idle_flush, NULL, false);
+  }
+#else
+  (void) rhport;
+#endif
 }
 
 uint16_t mscd_open(uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint16_t max_len) {
-  // only support SCSI's BOT protocol
+  // only support SCSI's BOT protocol, optionally followed by UAS as alternate setting
   TU_VERIFY(TUSB_CLASS_MSC    == itf_desc->bInterfaceClass &&
             MSC_SUBCLASS_SCSI == itf_desc->bInterfaceSubClass &&
             MSC_PROTOCOL_BOT  == itf_desc->bInterfaceProtocol, 0);
-  uint16_t const drv_len = sizeof(tusb_desc_interface_t) + 2*sizeof(tusb_desc_endpoint_t);
+  uint16_t drv_len = sizeof(tusb_desc_interface_t) + 2*sizeof(tusb_desc_endpoint_t);
   TU_ASSERT(max_len >= drv_len, 0); // Max length must be at least 1 interface + 2 endpoints
 
   mscd_interface_t * p_msc = &_mscd_itf;
@@ -364,12 +1172,35 @@ uint16_t mscd_open(uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint1
   // Open endpoint pair
   TU_ASSERT(usbd_open_edpt_pair(rhport, tu_desc_next(itf_desc), 2, TUSB_XFER_BULK, &p_msc->ep_out, &p_msc->ep_in), 0);
 
+#if CFG_TUD_MSC_UAS
+  p_msc->bot_ep_in  = p_msc->ep_in;
+  p_msc->bot_ep_out = p_msc->ep_out;
+  drv_len += uas_open(p_msc, (uint8_t const*) itf_desc + drv_len, (uint16_t) (max_len - drv_len));
+#endif
+
   // Prepare for Command Block Wrapper
   TU_ASSERT(prepare_cbw(p_msc), drv_len);
 
   return drv_len;
 }
 
+void mscd_sof_isr(uint8_t rhport, uint32_t frame_count) {
+  (void) rhport;
+#if CFG_TUD_MSC_CACHE
+  if (!_mscd_cache.sof_en) {
+    return;
+  }
+
+  _mscd_cache.idle_ms += usbd_sof_elapsed_ms(&_mscd_cache.sof_tick, frame_count);
+  if (_mscd_cache.idle_ms >= CFG_TUD_MSC_CACHE_FLUSH_MS && !_mscd_cache.flush_queued) {
+    _mscd_cache.flush_queued = true;
+    usbd_defer_func(cache_idle_flush, NULL, true);
+  }
+#else
+  (void) frame_count;
+#endif
+}
+
 static void proc_bot_reset(mscd_interface_t* p_msc) {
   p_msc->stage       = MSC_STAGE_CMD;
   p_msc->total_len   = 0;
@@ -396,7 +1227,9 @@ bool mscd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t
        TUSB_REQ_FEATURE_EDPT_HALT == request->wValue ) {
     uint8_t const ep_addr = tu_u16_low(request->wIndex);
 
-    if (p_msc->stage == MSC_STAGE_NEED_RESET) {
+    if (is_uas(p_msc)) {
+      // UAS does not stall pipes for recovery
+    } else if (p_msc->stage == MSC_STAGE_NEED_RESET) {
       // reset recovery is required to recover from this stage
       // Clear Stall request cannot resolve this -> continue to stall endpoint
       usbd_edpt_stall(rhport, ep_addr);
@@ -422,6 +1255,23 @@ bool mscd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t
     return true;
   }
 
+#if CFG_TUD_MSC_UAS
+  // Alternate setting 0 is Bulk-Only and 1 is UAS, if UAS is included in descriptor
+  if (TUSB_REQ_TYPE_STANDARD  == request->bmRequestType_bit.type &&
+      TUSB_REQ_RCPT_INTERFACE == request->bmRequestType_bit.recipient && p_msc->ep_cmd != 0) {
+    switch (request->bRequest) {
+      case TUSB_REQ_GET_INTERFACE:
+        return tud_control_xfer(rhport, request, &p_msc->alt, 1);
+
+      case TUSB_REQ_SET_INTERFACE:
+        TU_VERIFY(uas_set_alt(p_msc, tu_u16_low(request->wValue)));
+        return tud_control_status(rhport, request);
+
+      default: return false;
+    }
+  }
+#endif
+
   // From this point only handle class request only
   TU_VERIFY(request->bmRequestType_bit.type == TUSB_REQ_TYPE_CLASS);
 
@@ -455,7 +1305,22 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
 
   mscd_interface_t* p_msc = &_mscd_itf;
   msc_cbw_t * p_cbw = &p_msc->cbw;
-  msc_csw_t * p_csw = &p_msc->csw;
+
+#if CFG_TUD_MSC_UAS
+  if (is_uas(p_msc)) {
+    if (ep_addr == p_msc->ep_cmd) {
+      uas_cmd_received(p_msc, xferred_bytes);
+      return true;
+    }
+    if (ep_addr == p_msc->ep_status) {
+      uas_status_sent(p_msc);
+      return true;
+    }
+    if (p_msc->stage != MSC_STAGE_DATA) {
+      return true; // data pipes are only used in Data stage
+    }
+  }
+#endif
 
   switch (p_msc->stage) {
     case MSC_STAGE_CMD: {
@@ -477,85 +1342,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
       }
 
       memcpy(p_cbw, _mscd_epbuf.buf, sizeof(msc_cbw_t));
-
-      TU_LOG_DRV("  SCSI Command [Lun%u]: %s\r\n", p_cbw->lun, tu_lookup_find(&_msc_scsi_cmd_table, p_cbw->command[0]));
-      // TU_LOG_MEM(CFG_TUD_MSC_LOG_LEVEL, p_cbw, xferred_bytes, 2);
-
-      p_csw->signature    = MSC_CSW_SIGNATURE;
-      p_csw->tag          = p_cbw->tag;
-      p_csw->data_residue = 0;
-      p_csw->status       = MSC_CSW_STATUS_PASSED;
-
-      /*------------- Parse command and prepare DATA -------------*/
-      p_msc->stage = MSC_STAGE_DATA;
-      p_msc->total_len = p_cbw->total_bytes;
-      p_msc->xferred_len = 0;
-
-      // Read10 or Write10
-      if ((SCSI_CMD_READ_10 == p_cbw->command[0]) || (SCSI_CMD_WRITE_10 == p_cbw->command[0])) {
-        uint8_t const status = rdwr10_validate_cmd(p_cbw);
-
-        if (status != MSC_CSW_STATUS_PASSED) {
-          fail_scsi_op(p_msc, status);
-        } else if (p_cbw->total_bytes > 0) {
-          if (SCSI_CMD_READ_10 == p_cbw->command[0]) {
-            proc_read10_cmd(p_msc);
-          } else {
-            proc_write10_cmd(p_msc);
-          }
-        } else {
-          // no data transfer, only exist in complaint test suite
-          p_msc->stage = MSC_STAGE_STATUS;
-        }
-      } else {
-        // For other SCSI commands
-        // 1. OUT : queue transfer (invoke app callback after done)
-        // 2. IN & Zero: Process if is built-in, else Invoke app callback. Skip DATA if zero length
-        if ((p_cbw->total_bytes > 0) && !is_data_in(p_cbw->dir)) {
-          if (p_cbw->total_bytes > CFG_TUD_MSC_EP_BUFSIZE) {
-            TU_LOG_DRV("  SCSI reject non READ10/WRITE10 with large data\r\n");
-            fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
-          } else {
-            // Didn't check for case 9 (Ho > Dn), which requires examining scsi command first
-            // but it is OK to just receive data then responded with failed status
-            TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_out, _mscd_epbuf.buf, (uint16_t) p_msc->total_len, false));
-          }
-        } else {
-          // First process if it is a built-in commands
-          int32_t resplen = proc_builtin_scsi(p_cbw->lun, p_cbw->command, _mscd_epbuf.buf, CFG_TUD_MSC_EP_BUFSIZE);
-
-          // Invoke user callback if not built-in
-          if ((resplen < 0) && (p_msc->sense_key == 0)) {
-            resplen = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_epbuf.buf,
-                                      (uint16_t) tu_min32(p_msc->total_len, CFG_TUD_MSC_EP_BUFSIZE));
-          }
-
-          if (resplen < 0) {
-            // unsupported command
-            TU_LOG_DRV("  SCSI unsupported or failed command\r\n");
-            fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
-          } else if (resplen == 0) {
-            if (p_cbw->total_bytes > 0) {
-              // 6.7 The 13 Cases: case 4 (Hi > Dn)
-              // TU_LOG_DRV("  SCSI case 4 (Hi > Dn): %lu\r\n", p_cbw->total_bytes);
-              fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
-            } else {
-              // case 1 Hn = Dn: all good
-              p_msc->stage = MSC_STAGE_STATUS;
-            }
-          } else {
-            if (p_cbw->total_bytes == 0) {
-              // 6.7 The 13 Cases: case 2 (Hn < Di)
-              // TU_LOG_DRV("  SCSI case 2 (Hn < Di): %lu\r\n", p_cbw->total_bytes);
-              fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
-            } else {
-              // cannot return more than host expect
-              p_msc->total_len = tu_min32((uint32_t)resplen, p_cbw->total_bytes);
-              TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_epbuf.buf, (uint16_t) p_msc->total_len, false));
-            }
-          }
-        }
-      }
+      proc_cbw(p_msc);
       break;
     }
 
@@ -564,15 +1351,15 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
       TU_ASSERT(xferred_bytes <= CFG_TUD_MSC_EP_BUFSIZE); // sanity check to avoid buffer overflow
       // TU_LOG_MEM(CFG_TUD_MSC_LOG_LEVEL, _mscd_epbuf.buf, xferred_bytes, 2);
 
-      if (SCSI_CMD_READ_10 == p_cbw->command[0]) {
-        p_msc->xferred_len += xferred_bytes;
+#if CFG_TUD_MSC_UAS
+      if (p_msc->uas_data == MSC_UAS_DATA_TERMINATE) {
+        uas_terminate_data(p_msc, ep_addr, xferred_bytes);
+        break;
+      }
+#endif
 
-        if ( p_msc->xferred_len >= p_msc->total_len ) {
-          // Data Stage is complete
-          p_msc->stage = MSC_STAGE_STATUS;
-        }else {
-          proc_read10_cmd(p_msc);
-        }
+      if (SCSI_CMD_READ_10 == p_cbw->command[0]) {
+        proc_read10_host_done(p_msc, xferred_bytes);
       } else if (SCSI_CMD_WRITE_10 == p_cbw->command[0]) {
         proc_write10_host_data(p_msc, xferred_bytes);
       } else {
@@ -608,25 +1395,13 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
     case MSC_STAGE_STATUS_SENT:
       // Status phase is complete
       if ((ep_addr == p_msc->ep_in) && (xferred_bytes == sizeof(msc_csw_t))) {
-        TU_LOG_DRV("  SCSI Status [Lun%u] = %u\r\n", p_cbw->lun, p_csw->status);
-        // TU_LOG_MEM(CFG_TUD_MSC_LOG_LEVEL, p_csw, xferred_bytes, 2);
+        TU_LOG_DRV("  SCSI Status [Lun%u] = %u\r\n", p_cbw->lun, p_msc->csw.status);
+        // TU_LOG_MEM(CFG_TUD_MSC_LOG_LEVEL, &p_msc->csw, xferred_bytes, 2);
 
         // Invoke complete callback if defined
         // Note: There is racing issue with samd51 + qspi flash testing with arduino
         // if complete_cb() is invoked after queuing the status.
-        switch (p_cbw->command[0]) {
-          case SCSI_CMD_READ_10:
-            tud_msc_read10_complete_cb(p_cbw->lun);
-            break;
-
-          case SCSI_CMD_WRITE_10:
-            tud_msc_write10_complete_cb(p_cbw->lun);
-            break;
-
-          default:
-            tud_msc_scsi_complete_cb(p_cbw->lun, p_cbw->command);
-            break;
-        }
+        proc_cmd_complete(p_cbw);
 
         if (!usbd_edpt_stalled(rhport, p_msc->ep_out)) {
           TU_ASSERT(prepare_cbw(p_msc));
@@ -653,6 +1428,99 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
 /* SCSI Command Process
  *------------------------------------------------------------------*/
 
+// Parse SCSI command and prepare Data stage. For UAS, CBW is made up from Command IU
+static void proc_cbw(mscd_interface_t* p_msc) {
+  msc_cbw_t const * p_cbw = &p_msc->cbw;
+  msc_csw_t       * p_csw = &p_msc->csw;
+
+  TU_LOG_DRV("  SCSI Command [Lun%u]: %s\r\n", p_cbw->lun, tu_lookup_find(&_msc_scsi_cmd_table, p_cbw->command[0]));
+  // TU_LOG_MEM(CFG_TUD_MSC_LOG_LEVEL, p_cbw, xferred_bytes, 2);
+
+  p_csw->signature    = MSC_CSW_SIGNATURE;
+  p_csw->tag          = p_cbw->tag;
+  p_csw->data_residue = 0;
+  p_csw->status       = MSC_CSW_STATUS_PASSED;
+
+  /*------------- Parse command and prepare DATA -------------*/
+  p_msc->stage = MSC_STAGE_DATA;
+  p_msc->total_len = p_cbw->total_bytes;
+  p_msc->xferred_len = 0;
+
+  p_msc->io_len = 0;
+  tu_memclr(p_msc->buf_len, sizeof(p_msc->buf_len));
+  p_msc->usb_idx   = 0;
+  p_msc->io_idx    = 0;
+  p_msc->usb_busy  = false;
+  p_msc->io_retry  = false;
+  p_msc->io_failed = false;
+
+  // Read10 or Write10
+  if ((SCSI_CMD_READ_10 == p_cbw->command[0]) || (SCSI_CMD_WRITE_10 == p_cbw->command[0])) {
+    uint8_t const status = rdwr10_validate_cmd(p_cbw);
+
+    if (status != MSC_CSW_STATUS_PASSED) {
+      fail_scsi_op(p_msc, status);
+    } else if (p_cbw->total_bytes > 0) {
+      if (SCSI_CMD_READ_10 == p_cbw->command[0]) {
+        proc_read10_cmd(p_msc);
+      } else {
+        proc_write10_cmd(p_msc);
+      }
+    } else {
+      // no data transfer, only exist in complaint test suite
+      p_msc->stage = MSC_STAGE_STATUS;
+    }
+  } else {
+    // For other SCSI commands
+    // 1. OUT : queue transfer (invoke app callback after done)
+    // 2. IN & Zero: Process if is built-in, else Invoke app callback. Skip DATA if zero length
+    if ((p_cbw->total_bytes > 0) && !is_data_in(p_cbw->dir)) {
+      if (p_cbw->total_bytes > CFG_TUD_MSC_EP_BUFSIZE) {
+        TU_LOG_DRV("  SCSI reject non READ10/WRITE10 with large data\r\n");
+        fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+      } else {
+        // Didn't check for case 9 (Ho > Dn), which requires examining scsi command first
+        // but it is OK to just receive data then responded with failed status
+        TU_ASSERT(data_xfer(p_msc, p_msc->ep_out, _mscd_epbuf.buf, (uint16_t) p_msc->total_len), );
+      }
+    } else {
+      // First process if it is a built-in commands
+      int32_t resplen = proc_builtin_scsi(p_cbw->lun, p_cbw->command, _mscd_epbuf.buf, CFG_TUD_MSC_EP_BUFSIZE);
+
+      // Invoke user callback if not built-in
+      if ((resplen < 0) && (p_msc->sense_key == 0)) {
+        resplen = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_epbuf.buf,
+                                  (uint16_t) tu_min32(p_msc->total_len, CFG_TUD_MSC_EP_BUFSIZE));
+      }
+
+      if (resplen < 0) {
+        // unsupported command
+        TU_LOG_DRV("  SCSI unsupported or failed command\r\n");
+        fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+      } else if (resplen == 0) {
+        if (p_cbw->total_bytes > 0 && !is_uas(p_msc)) {
+          // 6.7 The 13 Cases: case 4 (Hi > Dn), not applicable to UAS which has no data without Read Ready IU
+          // TU_LOG_DRV("  SCSI case 4 (Hi > Dn): %lu\r\n", p_cbw->total_bytes);
+          fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+        } else {
+          // case 1 Hn = Dn: all good
+          p_msc->stage = MSC_STAGE_STATUS;
+        }
+      } else {
+        if (p_cbw->total_bytes == 0) {
+          // 6.7 The 13 Cases: case 2 (Hn < Di)
+          // TU_LOG_DRV("  SCSI case 2 (Hn < Di): %lu\r\n", p_cbw->total_bytes);
+          fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+        } else {
+          // cannot return more than host expect
+          p_msc->total_len = tu_min32((uint32_t)resplen, p_cbw->total_bytes);
+          TU_ASSERT(data_xfer(p_msc, p_msc->ep_in, _mscd_epbuf.buf, (uint16_t) p_msc->total_len), );
+        }
+      }
+    }
+  }
+}
+
 // return response's length (copied to buffer). Negative if it is not an built-in command or indicate Failed status (CSW)
 // In case of a failed status, sense key must be set for reason of failure
 static int32_t proc_builtin_scsi(uint8_t lun, uint8_t const scsi_cmd[16], uint8_t* buffer, uint32_t bufsize) {
@@ -678,6 +1546,12 @@ static int32_t proc_builtin_scsi(uint8_t lun, uint8_t const scsi_cmd[16], uint8_
     case SCSI_CMD_START_STOP_UNIT: {
       resplen = 0;
       scsi_start_stop_unit_t const* start_stop = (scsi_start_stop_unit_t const*)scsi_cmd;
+      #if CFG_TUD_MSC_CACHE
+      if (!cache_flush_scsi(lun)) {
+        resplen = -1;
+        break;
+      }
+      #endif
       if (!tud_msc_start_stop_cb(lun, start_stop->power_condition, start_stop->start, start_stop->load_eject)) {
         // Failed status response
         resplen = -1;
@@ -690,6 +1564,12 @@ static int32_t proc_builtin_scsi(uint8_t lun, uint8_t const scsi_cmd[16], uint8_
       break;
     }
 
+    #if CFG_TUD_MSC_CACHE
+    case SCSI_CMD_SYNCHRONIZE_CACHE_10:
+      resplen = cache_flush_scsi(lun) ? 0 : -1;
+      break;
+    #endif
+
     case SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL: {
       resplen = 0;
       scsi_prevent_allow_medium_removal_t const* prevent_allow = (scsi_prevent_allow_medium_removal_t const*)scsi_cmd;
@@ -830,29 +1710,61 @@ static int32_t proc_builtin_scsi(uint8_t lun, uint8_t const scsi_cmd[16], uint8_
   return resplen;
 }
 
+//--------------------------------------------------------------------+
+// READ10/WRITE10
+// Data is moved in chunks of CFG_TUD_MSC_EP_BUFSIZE. With CFG_TUD_MSC_PINGPONG, there are 2 buffers: application
+// reads/writes one while the other is transferred over USB. Otherwise, the only buffer is used in turn.
+//--------------------------------------------------------------------+
+
+// read next chunk from application into free buffer
 static void proc_read10_cmd(mscd_interface_t* p_msc) {
   msc_cbw_t const* p_cbw = &p_msc->cbw;
+  if (p_msc->pending_io || p_msc->io_retry || p_msc->io_failed ||
+      p_msc->io_len >= p_cbw->total_bytes || p_msc->buf_len[p_msc->io_idx] != 0) {
+    return;
+  }
+
   uint16_t const block_sz = rdwr10_get_blocksize(p_cbw); // already verified non-zero
   TU_VERIFY(block_sz != 0, );
-  // Adjust lba & offset with transferred bytes
-  uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->xferred_len / block_sz);
-  uint32_t const offset = p_msc->xferred_len % block_sz;
+
+  // Adjust lba & offset with read bytes
+  uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->io_len / block_sz);
+  uint32_t const offset = p_msc->io_len % block_sz;
 
   // remaining bytes capped at class buffer
-  int32_t nbytes = (int32_t)tu_min32(CFG_TUD_MSC_EP_BUFSIZE, p_cbw->total_bytes - p_msc->xferred_len);
+  int32_t nbytes = (int32_t)tu_min32(CFG_TUD_MSC_EP_BUFSIZE, p_cbw->total_bytes - p_msc->io_len);
 
   p_msc->pending_io = true;
-  nbytes = tud_msc_read10_cb(p_cbw->lun, lba, offset, _mscd_epbuf.buf, (uint32_t)nbytes);
+#if CFG_TUD_MSC_CACHE
+  nbytes = cache_read(p_cbw->lun, lba, offset, rw_buf(p_msc->io_idx), (uint32_t)nbytes, block_sz);
+#else
+  nbytes = tud_msc_read10_cb(p_cbw->lun, lba, offset, rw_buf(p_msc->io_idx), (uint32_t)nbytes);
+#endif
+
   if (nbytes != TUD_MSC_RET_ASYNC) {
     p_msc->pending_io = false;
     proc_read_io_data(p_msc, nbytes);
   }
 }
 
+// send next buffered chunk to host
+static bool proc_read10_xfer(mscd_interface_t* p_msc) {
+  uint16_t const len = p_msc->buf_len[p_msc->usb_idx];
+  if (p_msc->usb_busy || len == 0) {
+    return true;
+  }
+  p_msc->usb_busy = true;
+  return data_xfer(p_msc, p_msc->ep_in, rw_buf(p_msc->usb_idx), len);
+}
+
 static void proc_read_io_data(mscd_interface_t* p_msc, int32_t nbytes) {
-  const uint8_t rhport = p_msc->rhport;
   if (nbytes > 0) {
-    TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_epbuf.buf, (uint16_t) nbytes, false),);
+    p_msc->buf_len[p_msc->io_idx] = (uint16_t) nbytes;
+    p_msc->io_len += (uint32_t) nbytes;
+    p_msc->io_idx = rw_buf_next(p_msc->io_idx);
+
+    TU_ASSERT(proc_read10_xfer(p_msc),);
+    proc_read10_cmd(p_msc); // read ahead while USB is transferring
   } else {
     // nbytes is status
     switch (nbytes) {
@@ -860,12 +1772,17 @@ static void proc_read_io_data(mscd_interface_t* p_msc, int32_t nbytes) {
         // error -> endpoint is stalled & status in CSW set to failed
         TU_LOG_DRV("  IO read() failed\r\n");
         set_sense_medium_not_present(p_msc->cbw.lun);
-        fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+        if (p_msc->usb_busy) {
+          p_msc->io_failed = true; // fail once previous chunk is sent
+        } else {
+          fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+        }
         break;
 
       case TUD_MSC_RET_BUSY:
-        // not ready yet -> fake a transfer complete so that this driver callback will fire again
-        dcd_event_xfer_complete(rhport, p_msc->ep_in, 0, XFER_RESULT_SUCCESS, false);
+        // not ready yet -> invoke callback again later
+        p_msc->io_retry = true;
+        usbd_defer_func(proc_io_retry, NULL, false);
         break;
 
       default: break; // nothing to do
@@ -873,6 +1790,40 @@ static void proc_read_io_data(mscd_interface_t* p_msc, int32_t nbytes) {
   }
 }
 
+// a chunk is sent to host
+static void proc_read10_host_done(mscd_interface_t* p_msc, uint32_t xferred_bytes) {
+  p_msc->xferred_len += xferred_bytes;
+  p_msc->buf_len[p_msc->usb_idx] = 0;
+  p_msc->usb_idx = rw_buf_next(p_msc->usb_idx);
+  p_msc->usb_busy = false;
+
+  if (p_msc->io_failed) {
+    fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+  } else if (p_msc->xferred_len >= p_msc->total_len) {
+    // Data Stage is complete
+    p_msc->stage = MSC_STAGE_STATUS;
+  } else {
+    TU_ASSERT(proc_read10_xfer(p_msc),);
+    proc_read10_cmd(p_msc);
+  }
+}
+
+// receive next chunk from host into free buffer
+static bool proc_write10_xfer(mscd_interface_t* p_msc) {
+  msc_cbw_t const* p_cbw = &p_msc->cbw;
+  if (p_msc->usb_busy || p_msc->io_failed ||
+      p_msc->io_len >= p_cbw->total_bytes || p_msc->buf_len[p_msc->usb_idx] != 0) {
+    return true;
+  }
+
+  // remaining bytes capped at class buffer
+  uint16_t const nbytes = (uint16_t)tu_min32(CFG_TUD_MSC_EP_BUFSIZE, p_cbw->total_bytes - p_msc->io_len);
+
+  // Write10 callback will be called later when usb transfer complete
+  p_msc->usb_busy = true;
+  return data_xfer(p_msc, p_msc->ep_out, rw_buf(p_msc->usb_idx), nbytes);
+}
+
 static void proc_write10_cmd(mscd_interface_t* p_msc) {
   msc_cbw_t const* p_cbw = &p_msc->cbw;
   const bool writable = tud_msc_is_writable_cb(p_cbw->lun);
@@ -885,31 +1836,55 @@ static void proc_write10_cmd(mscd_interface_t* p_msc) {
     return;
   }
 
-  // remaining bytes capped at class buffer
-  uint16_t nbytes = (uint16_t)tu_min32(CFG_TUD_MSC_EP_BUFSIZE, p_cbw->total_bytes - p_msc->xferred_len);
-  // Write10 callback will be called later when usb transfer complete
-  TU_ASSERT(usbd_edpt_xfer(p_msc->rhport, p_msc->ep_out, _mscd_epbuf.buf, nbytes, false),);
+  TU_ASSERT(proc_write10_xfer(p_msc),);
 }
 
-// process new data arrived from WRITE10
-static void proc_write10_host_data(mscd_interface_t* p_msc, uint32_t xferred_bytes) {
+// pass next buffered chunk to application
+static void proc_write10_io(mscd_interface_t* p_msc) {
   msc_cbw_t const* p_cbw = &p_msc->cbw;
+  uint16_t const len = p_msc->buf_len[p_msc->io_idx];
+  if (p_msc->pending_io || p_msc->io_retry || p_msc->io_failed || len == 0) {
+    return;
+  }
+
   uint16_t const block_sz = rdwr10_get_blocksize(p_cbw); // already verified non-zero
   TU_VERIFY(block_sz != 0, );
 
-  // Adjust lba & offset with transferred bytes
+  // Adjust lba & offset with written bytes
   uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->xferred_len / block_sz);
   uint32_t const offset = p_msc->xferred_len % block_sz;
 
   p_msc->pending_io = true;
-  int32_t nbytes =  tud_msc_write10_cb(p_cbw->lun, lba, offset, _mscd_epbuf.buf, xferred_bytes);
+#if CFG_TUD_MSC_CACHE
+  int32_t nbytes = cache_write(p_cbw->lun, lba, offset, rw_buf(p_msc->io_idx), len, block_sz,
+                               p_cbw->total_bytes - p_msc->xferred_len);
+#else
+  int32_t nbytes = tud_msc_write10_cb(p_cbw->lun, lba, offset, rw_buf(p_msc->io_idx), len);
+#endif
+
   if (nbytes != TUD_MSC_RET_ASYNC) {
     p_msc->pending_io = false;
-    proc_write_io_data(p_msc, xferred_bytes, nbytes);
+    proc_write_io_data(p_msc, nbytes);
   }
 }
 
-static void proc_write_io_data(mscd_interface_t* p_msc, uint32_t xferred_bytes, int32_t nbytes) {
+// process new data arrived from WRITE10
+static void proc_write10_host_data(mscd_interface_t* p_msc, uint32_t xferred_bytes) {
+  p_msc->buf_len[p_msc->usb_idx] = (uint16_t) xferred_bytes;
+  p_msc->io_len += xferred_bytes;
+  p_msc->usb_idx = rw_buf_next(p_msc->usb_idx);
+  p_msc->usb_busy = false;
+
+  if (p_msc->io_failed) {
+    fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+    return;
+  }
+
+  TU_ASSERT(proc_write10_xfer(p_msc),); // receive next chunk while application is writing
+  proc_write10_io(p_msc);
+}
+
+static void proc_write_io_data(mscd_interface_t* p_msc, int32_t nbytes) {
   if (nbytes < 0) {
     // nbytes is status
     switch (nbytes) {
@@ -917,31 +1892,42 @@ static void proc_write_io_data(mscd_interface_t* p_msc, uint32_t xferred_bytes,
         // IO error -> failed this scsi op
         TU_LOG_DRV("  IO write() failed\r\n");
         set_sense_medium_not_present(p_msc->cbw.lun);
-        fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+        if (p_msc->usb_busy) {
+          p_msc->io_failed = true; // fail once current chunk is received
+        } else {
+          fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+        }
         break;
 
       default: break; // nothing to do
     }
   } else {
-    if ((uint32_t)nbytes < xferred_bytes) {
-      // Application consume less than what we got including TUD_MSC_RET_BUSY (0)
-      const uint32_t left_over = xferred_bytes - (uint32_t)nbytes;
-      if (nbytes > 0) {
-        memmove(_mscd_epbuf.buf, _mscd_epbuf.buf + nbytes, left_over);
+    uint8_t* buf = rw_buf(p_msc->io_idx);
+    uint16_t const len = p_msc->buf_len[p_msc->io_idx];
+    uint16_t const consumed = (uint16_t) tu_min32((uint32_t) nbytes, len);
+    p_msc->xferred_len += consumed;
+
+    if (consumed < len) {
+      // Application consume less than what we got including TUD_MSC_RET_BUSY (0): invoke again with left over
+      const uint16_t left_over = len - consumed;
+      if (consumed > 0) {
+        memmove(buf, buf + consumed, left_over);
       }
-
-      // fake a transfer complete with adjusted parameters --> callback will be invoked with adjusted parameters
-      dcd_event_xfer_complete(p_msc->rhport, p_msc->ep_out, left_over, XFER_RESULT_SUCCESS, false);
+      p_msc->buf_len[p_msc->io_idx] = left_over;
+      p_msc->io_retry = true;
+      usbd_defer_func(proc_io_retry, NULL, false);
     } else {
-      // Application consume all bytes in our buffer
-      p_msc->xferred_len += xferred_bytes;
+      // Application consume all bytes in this buffer
+      p_msc->buf_len[p_msc->io_idx] = 0;
+      p_msc->io_idx = rw_buf_next(p_msc->io_idx);
 
       if (p_msc->xferred_len >= p_msc->total_len) {
         // Data Stage is complete
         p_msc->stage = MSC_STAGE_STATUS;
       } else {
         // prepare to receive more data from host
-        proc_write10_cmd(p_msc);
+        TU_ASSERT(proc_write10_xfer(p_msc),);
+        proc_write10_io(p_msc);
       }
     }
   }
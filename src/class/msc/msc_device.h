@@ -29,6 +29,42 @@
   #error CFG_TUD_MSC_EP_BUFSIZE must be defined, value of a block size should work well, the more the better
 #endif
 
+// Use 2 endpoint buffers for READ10/WRITE10: USB transfers one while application reads/writes the other, overlapping
+// disk latency with bus time. Doubles CFG_TUD_MSC_EP_BUFSIZE memory usage.
+#ifndef CFG_TUD_MSC_PINGPONG
+  #define CFG_TUD_MSC_PINGPONG 0
+#endif
+
+// Number of cache lines of block cache between SCSI commands and READ10/WRITE10 callbacks, 0 to disable. Each line
+// caches CFG_TUD_MSC_CACHE_LINE_SIZE bytes e.g an erase sector of NOR flash, so that small writes from host are merged
+// and written back as whole line. Lines are written back when evicted, on SYNCHRONIZE CACHE, START STOP UNIT, bus
+// reset, tud_msc_cache_flush() or after CFG_TUD_MSC_CACHE_FLUSH_MS without access. Read miss loads the whole line, and
+// the next line as well if host is reading sequentially. Cache requires synchronous READ10/WRITE10 callbacks (no ASYNC).
+// Note: SYNCHRONIZE CACHE (10) is handled by the cache and no longer passed to tud_msc_scsi_cb().
+#ifndef CFG_TUD_MSC_CACHE
+  #define CFG_TUD_MSC_CACHE 0
+#endif
+
+#ifndef CFG_TUD_MSC_CACHE_LINE_SIZE
+  #define CFG_TUD_MSC_CACHE_LINE_SIZE 4096
+#endif
+
+#ifndef CFG_TUD_MSC_CACHE_FLUSH_MS
+  #define CFG_TUD_MSC_CACHE_FLUSH_MS 1000
+#endif
+
+// Support USB Attached SCSI (UAS) as alternate setting 1 of the interface, see TUD_MSC_UAS_DESCRIPTOR(). Host can
+// queue up to CFG_TUD_MSC_UAS_CMD_QUEUE_SIZE tagged commands (besides the one being executed), which are executed in
+// the order received with the same SCSI handling and callbacks as Bulk-Only. Streams (SuperSpeed) are not supported,
+// data-out is only supported for WRITE10 and MODE SELECT(6).
+#ifndef CFG_TUD_MSC_UAS
+  #define CFG_TUD_MSC_UAS 0
+#endif
+
+#ifndef CFG_TUD_MSC_UAS_CMD_QUEUE_SIZE
+  #define CFG_TUD_MSC_UAS_CMD_QUEUE_SIZE 4
+#endif
+
 // Return value of callback functions
 enum {
   TUD_MSC_RET_BUSY = 0,   // Busy, e.g disk I/O is not ready
@@ -50,6 +86,14 @@ bool tud_msc_set_sense(uint8_t lun, uint8_t sense_key, uint8_t add_sense_code, u
 // TUD_MSC_RET_ERROR (-1) for error. Note TUD_MSC_RET_BUSY (0) will be treated as error as well.
 bool tud_msc_async_io_done(int32_t bytes_io, bool in_isr);
 
+// Write back all dirty cache lines, return false if any of them failed or is busy. Should be called in the same
+// context as tud_task() e.g before resetting or detaching the device. Always true if CFG_TUD_MSC_CACHE is 0.
+bool tud_msc_cache_flush(void);
+
+// Discard all cached lines of a LUN, dirty ones are dropped without writing back e.g medium is changed or removed.
+// Call tud_msc_cache_flush() first to keep pending writes.
+void tud_msc_cache_discard(uint8_t lun);
+
 //--------------------------------------------------------------------+
 // Application Callbacks (WEAK is optional)
 //--------------------------------------------------------------------+
@@ -60,6 +104,8 @@ bool tud_msc_async_io_done(int32_t bytes_io, bool in_isr);
     - offset is only needed if CFG_TUD_MSC_EP_BUFSIZE is smaller than BLOCK_SIZE.
   - Application fill the buffer (up to bufsize) with address contents and return number of bytes read or status.
     - 0 < ret < bufsize: These bytes are transferred first and callback will be invoked again for remaining data.
+    - With CFG_TUD_MSC_PINGPONG, READ10 callback is invoked for the next chunk while the previous one is still being
+      transferred, and WRITE10 callback while host is sending the next chunk.
     - TUD_MSC_RET_BUSY
         Application is buys e.g disk I/O not ready. Callback will be invoked again with the same parameters later on.
     - TUD_MSC_RET_ERROR
@@ -143,6 +189,7 @@ void     mscd_reset           (uint8_t rhport);
 uint16_t mscd_open            (uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint16_t max_len);
 bool     mscd_control_xfer_cb (uint8_t rhport, uint8_t stage, tusb_control_request_t const * p_request);
 bool     mscd_xfer_cb         (uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t xferred_bytes);
+void     mscd_sof_isr         (uint8_t rhport, uint32_t frame_count);
 
 #ifdef __cplusplus
  }
@@ -31,35 +31,94 @@ enum {
   MSC_STAGE_STATUS,
 };
 
+enum {
+  MSC_CMD_FREE = 0,
+  MSC_CMD_PENDING,
+  MSC_CMD_ACTIVE,
+};
+
+#define MSC_CMD_INVALID 0xFFu
+
+// Queued SCSI command
+typedef struct {
+  msc_cbw_t cbw;
+  uint8_t state;
+  uint8_t seq; // submission order, used to keep commands of the same LUN in order
+  void* buffer;
+  tuh_msc_complete_cb_t complete_cb;
+  uintptr_t complete_arg;
+
+  // split read/write: remaining blocks are sent as follow-up commands
+  uint32_t offset;    // data offset of current command within buffer
+  uint32_t remaining; // blocks left after current command
+  uint64_t next_lba;
+
+#if CFG_TUH_MSC_UAS
+  uint32_t actual;     // transferred data bytes
+  bool     data_ready; // device sent Read/Write Ready, waiting for data pipe
+#endif
+} msch_cmd_t;
+
 typedef struct {
   uint8_t itf_num;
-  uint8_t ep_in;
-  uint8_t ep_out;
+  uint8_t ep_in;  // BOT bulk in or UAS data-in pipe
+  uint8_t ep_out; // BOT bulk out or UAS data-out pipe
   uint8_t max_lun;
+  uint8_t protocol; // MSC_PROTOCOL_BOT or MSC_PROTOCOL_UAS
+
+#if CFG_TUH_MSC_UAS
+  uint8_t uas_alt;
+  uint8_t ep_cmd;
+  uint8_t ep_status;
+  uint8_t uas_data_idx[2]; // command on data-out/data-in pipe
+  bool uas_status_armed;
+#endif
 
   volatile bool configured; // Receive SET_CONFIGURE
   volatile bool mounted;    // Enumeration is complete
 
-  // SCSI command data
+  // SCSI command on the bus, UAS only uses stage CMD while sending Command IU
   uint8_t stage;
-  void* buffer;
-  tuh_msc_complete_cb_t complete_cb;
-  uintptr_t complete_arg;
+  uint8_t cmd_active; // index of command in stage CMD/DATA/STATUS
+  uint8_t cmd_seq;    // next submission sequence
+  uint8_t last_lun;   // LUN of the last started command
+  uint8_t enum_retry; // Test Unit Ready retries during enumeration
+
+  msch_cmd_t cmd[CFG_TUH_MSC_CMD_QUEUE_SIZE];
 
   struct {
     uint32_t block_size;
-    uint32_t block_count;
+    uint64_t block_count;
   } capacity[CFG_TUH_MSC_MAXLUN];
 } msch_interface_t;
 
 typedef struct {
-  TUH_EPBUF_TYPE_DEF(msc_cbw_t, cbw);
-  TUH_EPBUF_TYPE_DEF(msc_csw_t, csw);
+  union {
+    struct {
+      TUH_EPBUF_TYPE_DEF(msc_cbw_t, cbw);
+      TUH_EPBUF_TYPE_DEF(msc_csw_t, csw);
+    };
+
+  #if CFG_TUH_MSC_UAS
+    struct {
+      TUH_EPBUF_TYPE_DEF(msc_uas_command_iu_t, cmd_iu);
+      TUH_EPBUF_TYPE_DEF(msc_uas_sense_iu_t, status_iu); // any IU on status pipe
+    };
+  #endif
+  };
 } msch_epbuf_t;
 
 static msch_interface_t _msch_itf[CFG_TUH_DEVICE_MAX];
 CFG_TUH_MEM_SECTION static msch_epbuf_t _msch_epbuf[CFG_TUH_DEVICE_MAX];
 
+// Mutex for command queue, application may submit commands from other tasks
+#if OSAL_MUTEX_REQUIRED
+static osal_mutex_def_t _msch_mutexdef;
+static osal_mutex_t _msch_mutex;
+#else
+#define _msch_mutex   NULL
+#endif
+
 TU_ATTR_ALWAYS_INLINE static inline msch_interface_t* get_itf(uint8_t daddr) {
   return &_msch_itf[daddr - 1];
 }
@@ -88,6 +147,12 @@ uint8_t tuh_msc_get_maxlun(uint8_t dev_addr) {
 }
 
 uint32_t tuh_msc_get_block_count(uint8_t dev_addr, uint8_t lun) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  const uint64_t block_count = p_msc->capacity[lun].block_count;
+  return (block_count > UINT32_MAX) ? UINT32_MAX : (uint32_t) block_count;
+}
+
+uint64_t tuh_msc_get_block_count64(uint8_t dev_addr, uint8_t lun) {
   msch_interface_t* p_msc = get_itf(dev_addr);
   return p_msc->capacity[lun].block_count;
 }
@@ -105,9 +170,23 @@ bool tuh_msc_mounted(uint8_t dev_addr) {
 bool tuh_msc_ready(uint8_t dev_addr) {
   msch_interface_t* p_msc = get_itf(dev_addr);
   TU_VERIFY(p_msc->mounted);
-  const bool epin_busy = usbh_edpt_busy(dev_addr, p_msc->ep_in);
-  const bool epout_busy = usbh_edpt_busy(dev_addr, p_msc->ep_out);
-  return !epin_busy && !epout_busy;
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    if (p_msc->cmd[i].state == MSC_CMD_FREE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool tuh_msc_idle(uint8_t dev_addr) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  TU_VERIFY(p_msc->mounted);
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    if (p_msc->cmd[i].state != MSC_CMD_FREE) {
+      return false;
+    }
+  }
+  return true;
 }
 
 //--------------------------------------------------------------------+
@@ -120,29 +199,199 @@ static inline void cbw_init(msc_cbw_t* cbw, uint8_t lun) {
   cbw->lun       = lun;
 }
 
-bool tuh_msc_scsi_command(uint8_t daddr, msc_cbw_t const* cbw, void* data,
-                          tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+// READ/WRITE command for block_count (up to 16-bit) blocks, 16-byte CDB is only used when LBA exceeds 32-bit
+static void cbw_rw_init(msch_interface_t const* p_msc, msc_cbw_t* cbw, uint8_t lun, bool is_write, uint64_t lba,
+                        uint32_t block_count) {
+  cbw_init(cbw, lun);
+  cbw->total_bytes = block_count * p_msc->capacity[lun].block_size;
+  cbw->dir         = is_write ? TUSB_DIR_OUT : TUSB_DIR_IN_MASK;
+
+  if (lba + block_count > (1ull << 32)) {
+    scsi_read16_t const cmd_rw16 = {
+        .cmd_code    = is_write ? SCSI_CMD_WRITE_16 : SCSI_CMD_READ_16,
+        .lba         = tu_htonll(lba),
+        .block_count = tu_htonl(block_count)
+    };
+    cbw->cmd_len = sizeof(scsi_read16_t);
+    memcpy(cbw->command, &cmd_rw16, cbw->cmd_len); //-V1086
+  } else {
+    scsi_read10_t const cmd_rw10 = {
+        .cmd_code    = is_write ? SCSI_CMD_WRITE_10 : SCSI_CMD_READ_10,
+        .lba         = tu_htonl((uint32_t) lba),
+        .block_count = tu_htons((uint16_t) block_count)
+    };
+    cbw->cmd_len = sizeof(scsi_read10_t);
+    memcpy(cbw->command, &cmd_rw10, cbw->cmd_len); //-V1086
+  }
+}
+
+//--------------------------------------------------------------------+
+// Command Queue
+//--------------------------------------------------------------------+
+
+// Select next pending command: LUNs are served in turn, commands of the same LUN in submission order.
+// Must be called with _msch_mutex locked
+static uint8_t cmd_select(msch_interface_t const* p_msc) {
+  uint8_t idx = MSC_CMD_INVALID;
+  uint8_t best_lun_dist = 0;
+  uint8_t best_age = 0;
+
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    msch_cmd_t const* cmd = &p_msc->cmd[i];
+    if (cmd->state == MSC_CMD_PENDING) {
+      // distance from the last served LUN, the last LUN itself comes last
+      const uint8_t lun_dist = (uint8_t) ((cmd->cbw.lun - p_msc->last_lun - 1u) & 0x0Fu);
+      const uint8_t age = (uint8_t) (p_msc->cmd_seq - cmd->seq);
+      if (idx == MSC_CMD_INVALID || lun_dist < best_lun_dist || (lun_dist == best_lun_dist && age > best_age)) {
+        idx = i;
+        best_lun_dist = lun_dist;
+        best_age = age;
+      }
+    }
+  }
+
+  return idx;
+}
+
+// Invoke complete callback of a finished command and free its slot
+static void cmd_complete(uint8_t daddr, uint8_t idx, msc_csw_t const* csw) {
   msch_interface_t* p_msc = get_itf(daddr);
-  TU_VERIFY(p_msc->configured);
+  msch_cmd_t* cmd = &p_msc->cmd[idx];
+
+  // copy out since slot can be reused as soon as it is freed
+  const msc_cbw_t cbw = cmd->cbw;
+  const tuh_msc_complete_data_t cb_data = {
+      .cbw = &cbw,
+      .csw = csw,
+      .scsi_data = cmd->buffer,
+      .user_arg = cmd->complete_arg
+  };
+  const tuh_msc_complete_cb_t complete_cb = cmd->complete_cb;
+
+  (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  cmd->state = MSC_CMD_FREE;
+  (void) osal_mutex_unlock(_msch_mutex);
+
+  if (complete_cb != NULL) {
+    (void) complete_cb(daddr, &cb_data);
+  }
+}
+
+// Complete a command that could not make it to the device
+static void cmd_abort(uint8_t daddr, uint8_t idx) {
+  msch_interface_t* p_msc = get_itf(daddr);
+  const msc_csw_t csw = {
+      .signature = MSC_CSW_SIGNATURE,
+      .tag = p_msc->cmd[idx].cbw.tag,
+      .data_residue = p_msc->cmd[idx].cbw.total_bytes,
+      .status = MSC_CSW_STATUS_PHASE_ERROR
+  };
+  cmd_complete(daddr, idx, &csw);
+}
+
+// Prepare next part of a split read/write
+static void cmd_split_next(msch_interface_t* p_msc, msch_cmd_t* cmd) {
+  const uint8_t lun = cmd->cbw.lun;
+  const bool is_write = !(cmd->cbw.dir & TUSB_DIR_IN_MASK);
+  const uint32_t count = tu_min32(cmd->remaining, CFG_TUH_MSC_XFER_BLOCK_MAX);
 
-  // claim endpoint
-  TU_VERIFY(usbh_edpt_claim(daddr, p_msc->ep_out));
+  cmd->offset += cmd->cbw.total_bytes;
+  cbw_rw_init(p_msc, &cmd->cbw, lun, is_write, cmd->next_lba, count);
+  cmd->next_lba += count;
+  cmd->remaining -= count;
+
+  (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  cmd->state = MSC_CMD_PENDING;
+  (void) osal_mutex_unlock(_msch_mutex);
+}
+
+#if CFG_TUH_MSC_UAS
+static bool uas_send_command(uint8_t daddr, uint8_t idx);
+#endif
+
+// Send CBW (or Command IU) of the next pending command if no command is on the bus (or command pipe)
+static void cmd_dispatch(uint8_t daddr) {
+  msch_interface_t* p_msc = get_itf(daddr);
   msch_epbuf_t* epbuf = get_epbuf(daddr);
 
-  epbuf->cbw = *cbw;
-  p_msc->buffer = data;
-  p_msc->complete_cb = complete_cb;
-  p_msc->complete_arg = arg;
-  p_msc->stage = MSC_STAGE_CMD;
+  while (1) {
+    (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+    const uint8_t idx = (p_msc->stage == MSC_STAGE_IDLE) ? cmd_select(p_msc) : MSC_CMD_INVALID;
+    if (idx != MSC_CMD_INVALID) {
+      msch_cmd_t* cmd = &p_msc->cmd[idx];
+      cmd->state = MSC_CMD_ACTIVE;
+      p_msc->cmd_active = idx;
+      p_msc->last_lun = cmd->cbw.lun;
+      p_msc->stage = MSC_STAGE_CMD;
+    }
+    (void) osal_mutex_unlock(_msch_mutex);
 
-  if (!usbh_edpt_xfer(daddr, p_msc->ep_out, (uint8_t*) &epbuf->cbw, sizeof(msc_cbw_t))) {
-    (void) usbh_edpt_release(daddr, p_msc->ep_out);
-    return false;
+    if (idx == MSC_CMD_INVALID) {
+      return;
+    }
+
+  #if CFG_TUH_MSC_UAS
+    if (p_msc->protocol == MSC_PROTOCOL_UAS) {
+      if (uas_send_command(daddr, idx)) {
+        return;
+      }
+    } else
+  #endif
+    {
+      epbuf->cbw = p_msc->cmd[idx].cbw;
+      if (usbh_edpt_claim(daddr, p_msc->ep_out)) {
+        if (usbh_edpt_xfer(daddr, p_msc->ep_out, (uint8_t*) &epbuf->cbw, sizeof(msc_cbw_t))) {
+          return;
+        }
+        (void) usbh_edpt_release(daddr, p_msc->ep_out);
+      }
+    }
+
+    // failed to send command, complete it and try the next one
+    p_msc->stage = MSC_STAGE_IDLE;
+    p_msc->cmd_active = MSC_CMD_INVALID;
+    cmd_abort(daddr, idx);
   }
+}
 
+// Queue a command, remaining blocks (if any) starting at next_lba are sent as follow-up commands
+static bool cmd_submit(uint8_t daddr, msc_cbw_t const* cbw, void* data, tuh_msc_complete_cb_t complete_cb,
+                       uintptr_t arg, uint64_t next_lba, uint32_t remaining) {
+  msch_interface_t* p_msc = get_itf(daddr);
+
+  // queue command
+  bool queued = false;
+  (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    msch_cmd_t* cmd = &p_msc->cmd[i];
+    if (cmd->state == MSC_CMD_FREE) {
+      cmd->cbw = *cbw;
+      cmd->buffer = data;
+      cmd->complete_cb = complete_cb;
+      cmd->complete_arg = arg;
+      cmd->offset = 0;
+      cmd->remaining = remaining;
+      cmd->next_lba = next_lba;
+      cmd->seq = p_msc->cmd_seq++;
+      cmd->state = MSC_CMD_PENDING;
+      queued = true;
+      break;
+    }
+  }
+  (void) osal_mutex_unlock(_msch_mutex);
+  TU_VERIFY(queued);
+
+  cmd_dispatch(daddr);
   return true;
 }
 
+bool tuh_msc_scsi_command(uint8_t daddr, msc_cbw_t const* cbw, void* data,
+                          tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  msch_interface_t* p_msc = get_itf(daddr);
+  TU_VERIFY(p_msc->configured);
+  return cmd_submit(daddr, cbw, data, complete_cb, arg, 0, 0);
+}
+
 bool tuh_msc_read_capacity(uint8_t dev_addr, uint8_t lun, scsi_read_capacity10_resp_t* response,
                            tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
   msch_interface_t* p_msc = get_itf(dev_addr);
@@ -217,7 +466,7 @@ bool tuh_msc_request_sense(uint8_t dev_addr, uint8_t lun, void* response,
 bool tuh_msc_read10(uint8_t dev_addr, uint8_t lun, void* buffer, uint32_t lba, uint16_t block_count,
                     tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
   msch_interface_t* p_msc = get_itf(dev_addr);
-  TU_VERIFY(p_msc->mounted);
+  TU_VERIFY(p_msc->mounted && lun < CFG_TUH_MSC_MAXLUN);
 
   msc_cbw_t cbw;
   cbw_init(&cbw, lun);
@@ -239,7 +488,7 @@ bool tuh_msc_read10(uint8_t dev_addr, uint8_t lun, void* buffer, uint32_t lba, u
 bool tuh_msc_write10(uint8_t dev_addr, uint8_t lun, void const* buffer, uint32_t lba, uint16_t block_count,
                      tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
   msch_interface_t* p_msc = get_itf(dev_addr);
-  TU_VERIFY(p_msc->mounted);
+  TU_VERIFY(p_msc->mounted && lun < CFG_TUH_MSC_MAXLUN);
 
   msc_cbw_t cbw;
   cbw_init(&cbw, lun);
@@ -258,6 +507,95 @@ bool tuh_msc_write10(uint8_t dev_addr, uint8_t lun, void const* buffer, uint32_t
   return tuh_msc_scsi_command(dev_addr, &cbw, (void*) (uintptr_t) buffer, complete_cb, arg);
 }
 
+bool tuh_msc_read_capacity16(uint8_t dev_addr, uint8_t lun, scsi_read_capacity16_resp_t* response,
+                             tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  TU_VERIFY(p_msc->configured);
+
+  msc_cbw_t cbw;
+  cbw_init(&cbw, lun);
+
+  cbw.total_bytes = sizeof(scsi_read_capacity16_resp_t);
+  cbw.dir         = TUSB_DIR_IN_MASK;
+  cbw.cmd_len     = sizeof(scsi_read_capacity16_t);
+
+  scsi_read_capacity16_t const cmd_read_capacity16 = {
+      .cmd_code       = SCSI_CMD_SERVICE_ACTION_IN_16,
+      .service_action = SCSI_SERVICE_ACTION_READ_CAPACITY_16,
+      .alloc_length   = tu_htonl(sizeof(scsi_read_capacity16_resp_t))
+  };
+  memcpy(cbw.command, &cmd_read_capacity16, cbw.cmd_len); //-V1086
+
+  return tuh_msc_scsi_command(dev_addr, &cbw, response, complete_cb, arg);
+}
+
+bool tuh_msc_read16(uint8_t dev_addr, uint8_t lun, void* buffer, uint64_t lba, uint32_t block_count,
+                    tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  TU_VERIFY(p_msc->mounted && lun < CFG_TUH_MSC_MAXLUN);
+
+  msc_cbw_t cbw;
+  cbw_init(&cbw, lun);
+
+  cbw.total_bytes = block_count * p_msc->capacity[lun].block_size;
+  cbw.dir         = TUSB_DIR_IN_MASK;
+  cbw.cmd_len     = sizeof(scsi_read16_t);
+
+  scsi_read16_t const cmd_read16 = {
+      .cmd_code    = SCSI_CMD_READ_16,
+      .lba         = tu_htonll(lba),
+      .block_count = tu_htonl(block_count)
+  };
+  memcpy(cbw.command, &cmd_read16, cbw.cmd_len); //-V1086
+
+  return tuh_msc_scsi_command(dev_addr, &cbw, buffer, complete_cb, arg);
+}
+
+bool tuh_msc_write16(uint8_t dev_addr, uint8_t lun, void const* buffer, uint64_t lba, uint32_t block_count,
+                     tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  TU_VERIFY(p_msc->mounted && lun < CFG_TUH_MSC_MAXLUN);
+
+  msc_cbw_t cbw;
+  cbw_init(&cbw, lun);
+
+  cbw.total_bytes = block_count * p_msc->capacity[lun].block_size;
+  cbw.dir         = TUSB_DIR_OUT;
+  cbw.cmd_len     = sizeof(scsi_write16_t);
+
+  scsi_write16_t const cmd_write16 = {
+      .cmd_code    = SCSI_CMD_WRITE_16,
+      .lba         = tu_htonll(lba),
+      .block_count = tu_htonl(block_count)
+  };
+  memcpy(cbw.command, &cmd_write16, cbw.cmd_len); //-V1086
+
+  return tuh_msc_scsi_command(dev_addr, &cbw, (void*) (uintptr_t) buffer, complete_cb, arg);
+}
+
+// Read/Write any number of blocks: split into commands of up to CFG_TUH_MSC_XFER_BLOCK_MAX blocks
+static bool msc_read_write(uint8_t dev_addr, uint8_t lun, bool is_write, void* buffer, uint64_t lba,
+                           uint32_t block_count, tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  TU_VERIFY(p_msc->mounted && lun < CFG_TUH_MSC_MAXLUN && block_count > 0);
+
+  const uint32_t count = tu_min32(block_count, CFG_TUH_MSC_XFER_BLOCK_MAX);
+  msc_cbw_t cbw;
+  cbw_rw_init(p_msc, &cbw, lun, is_write, lba, count);
+
+  return cmd_submit(dev_addr, &cbw, buffer, complete_cb, arg, lba + count, block_count - count);
+}
+
+bool tuh_msc_read(uint8_t dev_addr, uint8_t lun, void* buffer, uint64_t lba, uint32_t block_count,
+                  tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  return msc_read_write(dev_addr, lun, false, buffer, lba, block_count, complete_cb, arg);
+}
+
+bool tuh_msc_write(uint8_t dev_addr, uint8_t lun, void const* buffer, uint64_t lba, uint32_t block_count,
+                   tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  return msc_read_write(dev_addr, lun, true, (void*) (uintptr_t) buffer, lba, block_count, complete_cb, arg);
+}
+
 #if 0
 // MSC interface Reset (not used now)
 bool tuh_msc_reset(uint8_t dev_addr) {
@@ -276,17 +614,207 @@ bool tuh_msc_reset(uint8_t dev_addr) {
 }
 #endif
 
+//--------------------------------------------------------------------+
+// UAS Transport
+// Without streams (high speed), each queued command is sent on command pipe with its slot index + 1 as tag. Device
+// requests data of a command with Read/Write Ready IU and completes it with Sense IU, all on the status pipe which
+// is kept armed. Commands can be completed in any order.
+//--------------------------------------------------------------------+
+#if CFG_TUH_MSC_UAS
+
+TU_VERIFY_STATIC(CFG_TUH_MSC_CMD_QUEUE_SIZE < 0xFFFF, "UAS tag is 16-bit");
+
+static bool uas_send_command(uint8_t daddr, uint8_t idx) {
+  msch_interface_t* p_msc = get_itf(daddr);
+  msch_epbuf_t* epbuf = get_epbuf(daddr);
+  msch_cmd_t* cmd = &p_msc->cmd[idx];
+  msc_uas_command_iu_t* iu = &epbuf->cmd_iu;
+
+  tu_memclr(iu, sizeof(msc_uas_command_iu_t));
+  iu->iu_id  = MSC_UAS_IU_COMMAND;
+  iu->tag    = tu_htons((uint16_t) (idx + 1u));
+  iu->lun[1] = cmd->cbw.lun;
+  memcpy(iu->cdb, cmd->cbw.command, tu_min8(cmd->cbw.cmd_len, sizeof(iu->cdb)));
+
+  cmd->actual = 0;
+  cmd->data_ready = false;
+
+  return usbh_edpt_xfer(daddr, p_msc->ep_cmd, (uint8_t*) iu, sizeof(msc_uas_command_iu_t));
+}
+
+// Arm status pipe if not already, it stays armed while the device reports IUs
+static bool uas_status_arm(uint8_t daddr) {
+  msch_interface_t* p_msc = get_itf(daddr);
+  msch_epbuf_t* epbuf = get_epbuf(daddr);
+  if (!p_msc->uas_status_armed) {
+    p_msc->uas_status_armed =
+      usbh_edpt_xfer(daddr, p_msc->ep_status, (uint8_t*) &epbuf->status_iu, sizeof(msc_uas_sense_iu_t));
+  }
+  return p_msc->uas_status_armed;
+}
+
+// Status pipe failed: fail commands waiting for their IU. The command on command pipe (if any) re-arms the pipe
+// once sent. Data transfer of a failed command is aborted if not started yet
+static void uas_status_fail(uint8_t daddr) {
+  msch_interface_t* p_msc = get_itf(daddr);
+
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    if (p_msc->cmd[i].state != MSC_CMD_ACTIVE || (p_msc->stage == MSC_STAGE_CMD && p_msc->cmd_active == i)) {
+      continue;
+    }
+
+    for (uint8_t dir = 0; dir < 2; dir++) {
+      if (p_msc->uas_data_idx[dir] == i) {
+        (void) tuh_edpt_abort_xfer(daddr, (dir == TUSB_DIR_IN) ? p_msc->ep_in : p_msc->ep_out);
+        p_msc->uas_data_idx[dir] = MSC_CMD_INVALID;
+      }
+    }
+    cmd_abort(daddr, i);
+  }
+}
+
+// Start data transfer of ready commands on idle data pipes
+static void uas_data_next(uint8_t daddr) {
+  msch_interface_t* p_msc = get_itf(daddr);
+
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    msch_cmd_t* cmd = &p_msc->cmd[i];
+    if (cmd->state == MSC_CMD_ACTIVE && cmd->data_ready) {
+      const uint8_t dir = (cmd->cbw.dir & TUSB_DIR_IN_MASK) ? TUSB_DIR_IN : TUSB_DIR_OUT;
+      if (p_msc->uas_data_idx[dir] == MSC_CMD_INVALID) {
+        const uint8_t ep_data = (dir == TUSB_DIR_IN) ? p_msc->ep_in : p_msc->ep_out;
+        cmd->data_ready = false;
+        p_msc->uas_data_idx[dir] = i;
+        if (!usbh_edpt_xfer(daddr, ep_data, (uint8_t*) cmd->buffer + cmd->offset, cmd->cbw.total_bytes)) {
+          // device will time out the command and report it with Sense IU
+          p_msc->uas_data_idx[dir] = MSC_CMD_INVALID;
+        }
+      }
+    }
+  }
+}
+
+// Command is completed by device
+static void uas_cmd_done(uint8_t daddr, uint8_t idx, uint8_t status) {
+  msch_interface_t* p_msc = get_itf(daddr);
+  msch_cmd_t* cmd = &p_msc->cmd[idx];
+
+  if (status == MSC_CSW_STATUS_PASSED && cmd->remaining > 0) {
+    cmd_split_next(p_msc, cmd);
+    cmd_dispatch(daddr);
+    return;
+  }
+
+  const msc_csw_t csw = {
+      .signature    = MSC_CSW_SIGNATURE,
+      .tag          = cmd->cbw.tag,
+      .data_residue = cmd->cbw.total_bytes - tu_min32(cmd->actual, cmd->cbw.total_bytes),
+      .status       = status
+  };
+  cmd_complete(daddr, idx, &csw);
+}
+
+static bool uas_xfer_cb(uint8_t daddr, uint8_t ep_addr, xfer_result_t event, uint32_t xferred_bytes) {
+  msch_interface_t* p_msc = get_itf(daddr);
+  msch_epbuf_t* epbuf = get_epbuf(daddr);
+
+  if (ep_addr == p_msc->ep_cmd) {
+    // Command IU sent, command now waits for device on status pipe
+    const uint8_t idx = p_msc->cmd_active;
+    p_msc->stage = MSC_STAGE_IDLE;
+    p_msc->cmd_active = MSC_CMD_INVALID;
+    if (idx < CFG_TUH_MSC_CMD_QUEUE_SIZE && (event != XFER_RESULT_SUCCESS || !uas_status_arm(daddr))) {
+      cmd_abort(daddr, idx);
+    }
+    cmd_dispatch(daddr);
+  } else if (ep_addr == p_msc->ep_status) {
+    p_msc->uas_status_armed = false;
+    if (event != XFER_RESULT_SUCCESS || xferred_bytes < sizeof(msc_uas_ready_iu_t)) {
+      TU_LOG_DRV("  UAS status pipe failed: result = %u, len = %" PRIu32 "\r\n", event, xferred_bytes);
+      uas_status_fail(daddr);
+      return true;
+    }
+
+    // copy IU then re-arm status pipe for the next one
+    const msc_uas_sense_iu_t iu = epbuf->status_iu;
+    if (!uas_status_arm(daddr)) {
+      uas_status_fail(daddr);
+      return true;
+    }
+
+    const uint16_t tag = tu_ntohs(iu.tag);
+    TU_VERIFY(tag > 0 && tag <= CFG_TUH_MSC_CMD_QUEUE_SIZE);
+    const uint8_t idx = (uint8_t) (tag - 1u);
+    TU_VERIFY(p_msc->cmd[idx].state == MSC_CMD_ACTIVE);
+
+    switch (iu.iu_id) {
+      case MSC_UAS_IU_READ_READY:
+      case MSC_UAS_IU_WRITE_READY:
+        p_msc->cmd[idx].data_ready = true;
+        uas_data_next(daddr);
+        break;
+
+      case MSC_UAS_IU_SENSE:
+        TU_LOG_DRV("  UAS Sense tag = %u, status = %u\r\n", tag, iu.status);
+        uas_cmd_done(daddr, idx, (iu.status == 0) ? MSC_CSW_STATUS_PASSED : MSC_CSW_STATUS_FAILED);
+        break;
+
+      default:
+        // Response IU: command is rejected
+        uas_cmd_done(daddr, idx, MSC_CSW_STATUS_PHASE_ERROR);
+        break;
+    }
+  } else {
+    // data pipe
+    const uint8_t dir = tu_edpt_dir(ep_addr);
+    const uint8_t idx = p_msc->uas_data_idx[dir];
+    p_msc->uas_data_idx[dir] = MSC_CMD_INVALID;
+    if (idx < CFG_TUH_MSC_CMD_QUEUE_SIZE && event == XFER_RESULT_SUCCESS) {
+      p_msc->cmd[idx].actual = xferred_bytes;
+    }
+    uas_data_next(daddr);
+  }
+
+  return true;
+}
+
+#endif
+
 //--------------------------------------------------------------------+
 // CLASS-USBH API
 //--------------------------------------------------------------------+
+static void itf_reset(msch_interface_t* p_msc) {
+  tu_memclr(p_msc, sizeof(msch_interface_t));
+  p_msc->cmd_active = MSC_CMD_INVALID;
+#if CFG_TUH_MSC_UAS
+  p_msc->uas_data_idx[0] = p_msc->uas_data_idx[1] = MSC_CMD_INVALID;
+#endif
+}
+
 bool msch_init(void) {
   TU_LOG_DRV("sizeof(msch_interface_t) = %u\r\n", sizeof(msch_interface_t));
   TU_LOG_DRV("sizeof(msch_epbuf_t) = %u\r\n", sizeof(msch_epbuf_t));
-  tu_memclr(_msch_itf, sizeof(_msch_itf));
+  for (uint8_t i = 0; i < CFG_TUH_DEVICE_MAX; i++) {
+    itf_reset(&_msch_itf[i]);
+  }
+
+#if OSAL_MUTEX_REQUIRED
+  if (_msch_mutex == NULL) {
+    _msch_mutex = osal_mutex_create(&_msch_mutexdef);
+    TU_ASSERT(_msch_mutex);
+  }
+#endif
+
   return true;
 }
 
 bool msch_deinit(void) {
+#if OSAL_MUTEX_REQUIRED
+  if (_msch_mutex) {
+    osal_mutex_delete(_msch_mutex);
+    _msch_mutex = NULL;
+  }
+#endif
   return true;
 }
 
@@ -302,24 +830,50 @@ void msch_close(uint8_t dev_addr) {
     tuh_msc_umount_cb(dev_addr);
   }
 
-  tu_memclr(p_msc, sizeof(msch_interface_t));
+  // fail queued commands, new command is rejected since interface is no longer configured
+  p_msc->configured = false;
+  p_msc->mounted = false;
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    if (p_msc->cmd[i].state != MSC_CMD_FREE) {
+      cmd_abort(dev_addr, i);
+    }
+  }
+
+  itf_reset(p_msc);
 }
 
 bool msch_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t event, uint32_t xferred_bytes) {
   msch_interface_t* p_msc = get_itf(dev_addr);
+#if CFG_TUH_MSC_UAS
+  if (p_msc->protocol == MSC_PROTOCOL_UAS) {
+    return uas_xfer_cb(dev_addr, ep_addr, event, xferred_bytes);
+  }
+#endif
+
   msch_epbuf_t* epbuf = get_epbuf(dev_addr);
   msc_cbw_t const * cbw = &epbuf->cbw;
   msc_csw_t       * csw = &epbuf->csw;
+  const uint8_t idx = p_msc->cmd_active;
+  TU_VERIFY(idx < CFG_TUH_MSC_CMD_QUEUE_SIZE);
+  msch_cmd_t* cmd = &p_msc->cmd[idx];
 
   switch (p_msc->stage) {
     case MSC_STAGE_CMD:
       // Must be Command Block
-      TU_ASSERT(ep_addr == p_msc->ep_out && event == XFER_RESULT_SUCCESS && xferred_bytes == sizeof(msc_cbw_t));
-      if (cbw->total_bytes && p_msc->buffer) {
+      TU_ASSERT(ep_addr == p_msc->ep_out);
+      if (event != XFER_RESULT_SUCCESS || xferred_bytes != sizeof(msc_cbw_t)) {
+        p_msc->stage = MSC_STAGE_IDLE;
+        p_msc->cmd_active = MSC_CMD_INVALID;
+        cmd_abort(dev_addr, idx);
+        cmd_dispatch(dev_addr);
+        break;
+      }
+
+      if (cbw->total_bytes && cmd->buffer) {
         // Data stage if any
         p_msc->stage = MSC_STAGE_DATA;
         uint8_t const ep_data = (cbw->dir & TUSB_DIR_IN_MASK) ? p_msc->ep_in : p_msc->ep_out;
-        TU_ASSERT(usbh_edpt_xfer(dev_addr, ep_data, p_msc->buffer, (uint16_t) cbw->total_bytes));
+        TU_ASSERT(usbh_edpt_xfer(dev_addr, ep_data, (uint8_t*) cmd->buffer + cmd->offset, cbw->total_bytes));
         break;
       }
       TU_ATTR_FALLTHROUGH; // fallthrough to data stage
@@ -330,19 +884,23 @@ bool msch_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t event, uint32
       TU_ASSERT(usbh_edpt_xfer(dev_addr, p_msc->ep_in, (uint8_t*) csw, (uint16_t) sizeof(msc_csw_t)));
       break;
 
-    case MSC_STAGE_STATUS:
-      // SCSI op is complete
+    case MSC_STAGE_STATUS: {
+      // SCSI op is complete: send next CBW right away, then notify application
+      const msc_csw_t csw_copy = *csw;
       p_msc->stage = MSC_STAGE_IDLE;
-      if (p_msc->complete_cb != NULL) {
-        tuh_msc_complete_data_t const cb_data = {
-            .cbw = cbw,
-            .csw = csw,
-            .scsi_data = p_msc->buffer,
-            .user_arg = p_msc->complete_arg
-        };
-        (void) p_msc->complete_cb(dev_addr, &cb_data);
+      p_msc->cmd_active = MSC_CMD_INVALID;
+
+      if (csw_copy.status == MSC_CSW_STATUS_PASSED && cmd->remaining > 0) {
+        // split read/write: re-queue this slot with the next part, keeping its place in LUN order
+        cmd_split_next(p_msc, cmd);
+        cmd_dispatch(dev_addr);
+        break;
       }
+
+      cmd_dispatch(dev_addr);
+      cmd_complete(dev_addr, idx, &csw_copy);
       break;
+    }
 
     default:
       // unknown state
@@ -356,20 +914,112 @@ bool msch_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t event, uint32
 // MSC Enumeration
 //--------------------------------------------------------------------+
 static void config_get_maxlun_complete(tuh_xfer_t* xfer);
+static void config_test_first_lun(uint8_t daddr);
+#if CFG_TUH_MSC_UAS
+static void config_set_uas_complete(tuh_xfer_t* xfer);
+static bool config_report_luns_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data);
+#endif
 static bool config_test_unit_ready_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data);
 static bool config_request_sense_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data);
 static bool config_read_capacity_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data);
+static bool config_read_capacity16_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data);
+
+// Length of interface including all of its alternate settings
+static uint16_t itf_total_len(tusb_desc_interface_t const* desc_itf, uint16_t max_len) {
+  uint8_t const* p_desc = tu_desc_next(desc_itf);
+  uint8_t const* desc_end = ((uint8_t const*) desc_itf) + max_len;
+
+  while (tu_desc_in_bounds(p_desc, desc_end)) {
+    const uint8_t desc_type = tu_desc_type(p_desc);
+    if (desc_type == TUSB_DESC_INTERFACE_ASSOCIATION ||
+        (desc_type == TUSB_DESC_INTERFACE &&
+         ((tusb_desc_interface_t const*) p_desc)->bInterfaceNumber != desc_itf->bInterfaceNumber)) {
+      break;
+    }
+    p_desc = tu_desc_next(p_desc);
+  }
+
+  return (uint16_t) (p_desc - (uint8_t const*) desc_itf);
+}
+
+#if CFG_TUH_MSC_UAS
+// Open UAS pipes if interface has an UAS alternate setting, return false otherwise
+static bool uas_open(uint8_t dev_addr, tusb_desc_interface_t const* desc_itf, uint16_t itf_len) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  uint8_t const* p_desc = (uint8_t const*) desc_itf;
+  uint8_t const* desc_end = p_desc + itf_len;
+
+  // UAS is usually alternate setting 1 with BOT as default
+  tusb_desc_interface_t const* uas_itf = NULL;
+  while (tu_desc_in_bounds(p_desc, desc_end)) {
+    if (tu_desc_type(p_desc) == TUSB_DESC_INTERFACE) {
+      tusb_desc_interface_t const* alt_itf = (tusb_desc_interface_t const*) p_desc;
+      if (alt_itf->bInterfaceSubClass == MSC_SUBCLASS_SCSI && alt_itf->bInterfaceProtocol == MSC_PROTOCOL_UAS) {
+        uas_itf = alt_itf;
+        break;
+      }
+    }
+    p_desc = tu_desc_next(p_desc);
+  }
+  TU_VERIFY(uas_itf != NULL);
+
+  // each endpoint is followed by a Pipe Usage descriptor
+  tusb_desc_endpoint_t const* ep_desc = NULL;
+  p_desc = tu_desc_next(uas_itf);
+  while (tu_desc_in_bounds(p_desc, desc_end) && tu_desc_type(p_desc) != TUSB_DESC_INTERFACE) {
+    if (tu_desc_type(p_desc) == TUSB_DESC_ENDPOINT) {
+      ep_desc = (tusb_desc_endpoint_t const*) p_desc;
+    } else if (tu_desc_type(p_desc) == MSC_UAS_DESC_PIPE_USAGE && ep_desc != NULL) {
+      TU_ASSERT(TUSB_XFER_BULK == ep_desc->bmAttributes.xfer);
+      TU_ASSERT(tuh_edpt_open(dev_addr, ep_desc));
+
+      const uint8_t ep_addr = ep_desc->bEndpointAddress;
+      switch (((msc_uas_desc_pipe_usage_t const*) p_desc)->bPipeID) {
+        case MSC_UAS_PIPE_COMMAND:  p_msc->ep_cmd = ep_addr;    break;
+        case MSC_UAS_PIPE_STATUS:   p_msc->ep_status = ep_addr; break;
+        case MSC_UAS_PIPE_DATA_IN:  p_msc->ep_in = ep_addr;     break;
+        case MSC_UAS_PIPE_DATA_OUT: p_msc->ep_out = ep_addr;    break;
+        default: break;
+      }
+      ep_desc = NULL;
+    } else {
+      // skip e.g SuperSpeed endpoint companion
+    }
+    p_desc = tu_desc_next(p_desc);
+  }
+  TU_ASSERT(p_msc->ep_cmd && p_msc->ep_status && p_msc->ep_in && p_msc->ep_out);
+
+  p_msc->protocol = MSC_PROTOCOL_UAS;
+  p_msc->uas_alt  = uas_itf->bAlternateSetting;
+
+  return true;
+}
+#endif
 
 uint16_t msch_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_interface_t *desc_itf, uint16_t max_len) {
   (void) rhport;
-  TU_VERIFY(MSC_SUBCLASS_SCSI == desc_itf->bInterfaceSubClass && MSC_PROTOCOL_BOT == desc_itf->bInterfaceProtocol, 0);
+  TU_VERIFY(MSC_SUBCLASS_SCSI == desc_itf->bInterfaceSubClass, 0);
+  TU_VERIFY(MSC_PROTOCOL_BOT == desc_itf->bInterfaceProtocol ||
+            (CFG_TUH_MSC_UAS && MSC_PROTOCOL_UAS == desc_itf->bInterfaceProtocol), 0);
+
+  // driver takes all alternate settings of the interface
+  const uint16_t drv_len = itf_total_len(desc_itf, max_len);
+  msch_interface_t *p_msc = get_itf(dev_addr);
+  p_msc->itf_num = desc_itf->bInterfaceNumber;
 
-  // msc driver length is fixed
-  const uint16_t drv_len =
+#if CFG_TUH_MSC_UAS
+  if (uas_open(dev_addr, desc_itf, drv_len)) {
+    TU_LOG_DRV("  MSC UAS alt = %u\r\n", p_msc->uas_alt);
+    return drv_len;
+  }
+#endif
+
+  // Bulk-Only Transport: default alternate setting
+  TU_VERIFY(MSC_PROTOCOL_BOT == desc_itf->bInterfaceProtocol, 0);
+  const uint16_t bot_len =
     (uint16_t)(sizeof(tusb_desc_interface_t) + desc_itf->bNumEndpoints * sizeof(tusb_desc_endpoint_t));
-  TU_ASSERT(drv_len <= max_len, 0);
+  TU_ASSERT(bot_len <= max_len, 0);
 
-  msch_interface_t           *p_msc   = get_itf(dev_addr);
   const tusb_desc_endpoint_t *ep_desc = (const tusb_desc_endpoint_t *)tu_desc_next(desc_itf);
 
   for (uint32_t i = 0; i < 2; i++) {
@@ -385,9 +1035,9 @@ uint16_t msch_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_interface_t
     ep_desc = (tusb_desc_endpoint_t const*) tu_desc_next(ep_desc);
   }
 
-  p_msc->itf_num = desc_itf->bInterfaceNumber;
+  p_msc->protocol = MSC_PROTOCOL_BOT;
 
-  return drv_len;
+  return tu_max16(drv_len, bot_len);
 }
 
 bool msch_set_config(uint8_t daddr, uint8_t itf_num) {
@@ -395,6 +1045,14 @@ bool msch_set_config(uint8_t daddr, uint8_t itf_num) {
   TU_ASSERT(p_msc->itf_num == itf_num);
   p_msc->configured = true;
 
+#if CFG_TUH_MSC_UAS
+  if (p_msc->protocol == MSC_PROTOCOL_UAS) {
+    TU_LOG_DRV("MSC Set Interface UAS\r\n");
+    TU_ASSERT(tuh_interface_set(daddr, itf_num, p_msc->uas_alt, config_set_uas_complete, 0));
+    return true;
+  }
+#endif
+
   //------------- Get Max Lun -------------//
   TU_LOG_DRV("MSC Get Max Lun\r\n");
   tusb_control_request_t const request = {
@@ -409,7 +1067,7 @@ bool msch_set_config(uint8_t daddr, uint8_t itf_num) {
       .wLength  = 1
   };
 
-  uint8_t* enum_buf = usbh_get_enum_buf();
+  uint8_t* enum_buf = usbh_get_enum_buf(daddr);
   tuh_xfer_t xfer = {
       .daddr       = daddr,
       .ep_addr     = 0,
@@ -429,42 +1087,119 @@ static void config_get_maxlun_complete(tuh_xfer_t* xfer) {
 
   // MAXLUN's response is minus 1 by specs, STALL means 1
   if (XFER_RESULT_SUCCESS == xfer->result) {
-    uint8_t* enum_buf = usbh_get_enum_buf();
+    uint8_t* enum_buf = usbh_get_enum_buf(daddr);
     p_msc->max_lun = enum_buf[0] + 1;
   } else {
     p_msc->max_lun = 1;
   }
 
   TU_LOG_DRV("  Max LUN = %u\r\n", p_msc->max_lun);
+  config_test_first_lun(daddr);
+}
+
+#if CFG_TUH_MSC_UAS
+static void config_set_uas_complete(tuh_xfer_t* xfer) {
+  uint8_t const daddr = xfer->daddr;
+  TU_ASSERT(XFER_RESULT_SUCCESS == xfer->result,);
+
+  // UAS has no Get Max LUN request, use REPORT LUNS instead. Status pipe is armed once Command IU is sent
+  TU_LOG_DRV("SCSI Report LUNs\r\n");
+  const uint32_t alloc_len = sizeof(scsi_report_luns_resp_t) + 8u * CFG_TUH_MSC_MAXLUN;
+  TU_VERIFY_STATIC(sizeof(scsi_report_luns_resp_t) + 8u * CFG_TUH_MSC_MAXLUN <= CFG_TUH_ENUMERATION_BUFSIZE,
+                   "enumeration buffer too small for REPORT LUNS");
+
+  msc_cbw_t cbw;
+  cbw_init(&cbw, 0);
+  cbw.total_bytes = alloc_len;
+  cbw.dir         = TUSB_DIR_IN_MASK;
+  cbw.cmd_len     = sizeof(scsi_report_luns_t);
+
+  scsi_report_luns_t const cmd_report_luns = {
+      .cmd_code     = SCSI_CMD_REPORT_LUNS,
+      .alloc_length = tu_htonl(alloc_len)
+  };
+  memcpy(cbw.command, &cmd_report_luns, cbw.cmd_len); //-V1086
+
+  TU_ASSERT(tuh_msc_scsi_command(daddr, &cbw, usbh_get_enum_buf(daddr), config_report_luns_complete, 0),);
+}
+
+// LUN identifiers are expected to be 0 to n-1 with single level addressing, same as Bulk-Only Get Max LUN
+static bool config_report_luns_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data) {
+  TU_VERIFY(get_itf(dev_addr)->configured); // aborted by msch_close()
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  msc_csw_t const* csw = cb_data->csw;
+
+  // command is optional for single LUN device, failure means 1
+  p_msc->max_lun = 1;
+  if (csw->status == MSC_CSW_STATUS_PASSED) {
+    scsi_report_luns_resp_t const* resp = (scsi_report_luns_resp_t const*) (uintptr_t) cb_data->scsi_data;
+    const uint32_t lun_count = tu_ntohl(resp->list_length) / 8u;
+    p_msc->max_lun = (uint8_t) tu_max32(1, tu_min32(lun_count, 16));
+  }
 
-  // TODO multiple LUN support
+  TU_LOG_DRV("  Max LUN = %u\r\n", p_msc->max_lun);
+  config_test_first_lun(dev_addr);
+  return true;
+}
+#endif
+
+static void config_test_first_lun(uint8_t daddr) {
+  msch_interface_t* p_msc = get_itf(daddr);
   TU_LOG_DRV("SCSI Test Unit Ready\r\n");
+  p_msc->enum_retry = 0;
   uint8_t const lun = 0;
   tuh_msc_test_unit_ready(daddr, lun, config_test_unit_ready_complete, 0);
 }
 
+// Move on to next LUN or complete enumeration
+static void config_next_lun(uint8_t dev_addr, uint8_t lun) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  lun++;
+
+  if (lun < TU_MIN(p_msc->max_lun, CFG_TUH_MSC_MAXLUN)) {
+    TU_LOG_DRV("SCSI Test Unit Ready LUN %u\r\n", lun);
+    p_msc->enum_retry = 0;
+    TU_ASSERT(tuh_msc_test_unit_ready(dev_addr, lun, config_test_unit_ready_complete, 0),);
+    return;
+  }
+
+  // Mark enumeration is complete
+  p_msc->mounted = true;
+  tuh_msc_mount_cb(dev_addr);
+
+  // notify usbh that driver enumeration is complete
+  usbh_driver_set_config_complete(dev_addr, p_msc->itf_num);
+}
+
 static bool config_test_unit_ready_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data) {
+  TU_VERIFY(get_itf(dev_addr)->configured); // aborted by msch_close()
   msc_cbw_t const* cbw = cb_data->cbw;
   msc_csw_t const* csw = cb_data->csw;
-  uint8_t* enum_buf = usbh_get_enum_buf();
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  uint8_t* enum_buf = usbh_get_enum_buf(dev_addr);
 
   if (csw->status == 0) {
     // Unit is ready, read its capacity
     TU_LOG_DRV("SCSI Read Capacity\r\n");
     tuh_msc_read_capacity(dev_addr, cbw->lun, (scsi_read_capacity10_resp_t*) (uintptr_t) enum_buf,
                           config_read_capacity_complete, 0);
-  } else {
+  } else if (cbw->lun == 0 || p_msc->enum_retry == 0) {
     // Note: During enumeration, some device fails Test Unit Ready and require a few retries
     // with Request Sense to start working !!
-    // TODO limit number of retries
+    // TODO limit number of retries for LUN 0
     TU_LOG_DRV("SCSI Request Sense\r\n");
+    p_msc->enum_retry++;
     TU_ASSERT(tuh_msc_request_sense(dev_addr, cbw->lun, enum_buf, config_request_sense_complete, 0));
+  } else {
+    // additional LUN is not ready e.g card reader without media: leave its capacity as zero
+    config_next_lun(dev_addr, cbw->lun);
   }
 
   return true;
 }
 
 static bool config_request_sense_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data) {
+  TU_VERIFY(get_itf(dev_addr)->configured); // aborted by msch_close()
   msc_cbw_t const* cbw = cb_data->cbw;
   msc_csw_t const* csw = cb_data->csw;
 
@@ -474,24 +1209,48 @@ static bool config_request_sense_complete(uint8_t dev_addr, tuh_msc_complete_dat
 }
 
 static bool config_read_capacity_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data) {
+  TU_VERIFY(get_itf(dev_addr)->configured); // aborted by msch_close()
   msc_cbw_t const* cbw = cb_data->cbw;
   msc_csw_t const* csw = cb_data->csw;
-  TU_ASSERT(csw->status == 0);
+  TU_ASSERT(cbw->lun > 0 || csw->status == 0);
   msch_interface_t* p_msc = get_itf(dev_addr);
-  uint8_t* enum_buf = usbh_get_enum_buf();
+  uint8_t* enum_buf = usbh_get_enum_buf(dev_addr);
 
-  // Capacity response field: Block size and Last LBA are both Big-Endian
-  scsi_read_capacity10_resp_t* resp = (scsi_read_capacity10_resp_t*) (uintptr_t) enum_buf;
-  p_msc->capacity[cbw->lun].block_count = (uint32_t) (tu_ntohl(resp->last_lba) + 1u);
-  p_msc->capacity[cbw->lun].block_size  = tu_ntohl(resp->block_size);
+  if (csw->status == 0) {
+    // Capacity response field: Block size and Last LBA are both Big-Endian
+    scsi_read_capacity10_resp_t* resp = (scsi_read_capacity10_resp_t*) (uintptr_t) enum_buf;
+    const uint32_t last_lba = tu_ntohl(resp->last_lba);
+    p_msc->capacity[cbw->lun].block_count = (uint64_t) last_lba + 1u;
+    p_msc->capacity[cbw->lun].block_size  = tu_ntohl(resp->block_size);
+
+    if (last_lba == UINT32_MAX) {
+      // capacity does not fit 32-bit LBA (more than 2 TiB with 512-byte block)
+      TU_LOG_DRV("SCSI Read Capacity 16\r\n");
+      TU_ASSERT(tuh_msc_read_capacity16(dev_addr, cbw->lun, (scsi_read_capacity16_resp_t*) (uintptr_t) enum_buf,
+                                        config_read_capacity16_complete, 0));
+      return true;
+    }
+  }
 
-  // Mark enumeration is complete
-  p_msc->mounted = true;
-  tuh_msc_mount_cb(dev_addr);
+  config_next_lun(dev_addr, cbw->lun);
+  return true;
+}
 
-  // notify usbh that driver enumeration is complete
-  usbh_driver_set_config_complete(dev_addr, p_msc->itf_num);
+static bool config_read_capacity16_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data) {
+  TU_VERIFY(get_itf(dev_addr)->configured); // aborted by msch_close()
+  msc_cbw_t const* cbw = cb_data->cbw;
+  msc_csw_t const* csw = cb_data->csw;
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  uint8_t* enum_buf = usbh_get_enum_buf(dev_addr);
+
+  // keep READ CAPACITY(10) result if device does not support the 16-byte variant
+  if (csw->status == 0) {
+    scsi_read_capacity16_resp_t* resp = (scsi_read_capacity16_resp_t*) (uintptr_t) enum_buf;
+    p_msc->capacity[cbw->lun].block_count = tu_ntohll(resp->last_lba) + 1u;
+    p_msc->capacity[cbw->lun].block_size  = tu_ntohl(resp->block_size);
+  }
 
+  config_next_lun(dev_addr, cbw->lun);
   return true;
 }
 
@@ -22,6 +22,26 @@ extern "C" {
   #define CFG_TUH_MSC_MAXLUN 4
 #endif
 
+// Enable USB Attached SCSI (UAS) transport, used instead of Bulk-Only for device with UAS alternate setting
+#ifndef CFG_TUH_MSC_UAS
+  #define CFG_TUH_MSC_UAS 0
+#endif
+
+// Number of SCSI commands that can be queued per device, also max outstanding commands (tags) with UAS
+
+#ifndef CFG_TUH_MSC_CMD_QUEUE_SIZE
+  #define CFG_TUH_MSC_CMD_QUEUE_SIZE 4
+#endif
+
+// Max blocks per READ/WRITE command issued by tuh_msc_read()/tuh_msc_write(), larger request is split.
+// Some devices misbehave with very large transfer, 2048 blocks (1 MiB with 512-byte block) is generally safe.
+#ifndef CFG_TUH_MSC_XFER_BLOCK_MAX
+  #define CFG_TUH_MSC_XFER_BLOCK_MAX 2048
+#endif
+
+TU_VERIFY_STATIC(CFG_TUH_MSC_XFER_BLOCK_MAX > 0 && CFG_TUH_MSC_XFER_BLOCK_MAX <= UINT16_MAX,
+                 "CFG_TUH_MSC_XFER_BLOCK_MAX must fit READ(10) transfer length");
+
 typedef struct {
   const msc_cbw_t *cbw;       // SCSI command
   const msc_csw_t *csw;       // SCSI status
@@ -39,21 +59,30 @@ typedef bool (*tuh_msc_complete_cb_t)(uint8_t dev_addr, const tuh_msc_complete_d
 // This function true after tuh_msc_mounted_cb() and false after tuh_msc_unmounted_cb()
 bool tuh_msc_mounted(uint8_t dev_addr);
 
-// Check if the interface is currently ready or busy transferring data
+// Check if the interface can accept a new SCSI command i.e command queue is not full.
+// Note: commands are queued, true does not mean previous commands are complete, use tuh_msc_idle() for that
 bool tuh_msc_ready(uint8_t dev_addr);
 
-// Get Max Lun
+// Check if all submitted SCSI commands are complete i.e command queue is empty
+bool tuh_msc_idle(uint8_t dev_addr);
+
+// Get number of LUNs: from Get Max LUN request with Bulk-Only, REPORT LUNS command with UAS.
+// LUNs are addressed as 0 to n-1, only the first CFG_TUH_MSC_MAXLUN are enumerated
 uint8_t tuh_msc_get_maxlun(uint8_t dev_addr);
 
-// Get number of block
+// Get number of block, saturated to UINT32_MAX for device larger than 32-bit LBA
 uint32_t tuh_msc_get_block_count(uint8_t dev_addr, uint8_t lun);
 
+// Get number of block (64-bit)
+uint64_t tuh_msc_get_block_count64(uint8_t dev_addr, uint8_t lun);
+
 // Get block size in bytes
 uint32_t tuh_msc_get_block_size(uint8_t dev_addr, uint8_t lun);
 
 // Perform a full SCSI command (cbw, data, csw) in non-blocking manner.
+// Command is queued and sent once previous commands are done, commands to different LUNs are interleaved.
 // Complete callback is invoked when SCSI op is complete.
-// return true if success, false if there is already pending operation.
+// return true if success, false if command queue is full.
 // NOTE: buffer must be accessible by USB/DMA controller, aligned correctly and multiple of cache line if enabled
 bool tuh_msc_scsi_command(uint8_t daddr, const msc_cbw_t *cbw, void *data, tuh_msc_complete_cb_t complete_cb,
                           uintptr_t arg);
@@ -86,6 +115,31 @@ bool tuh_msc_read10(uint8_t dev_addr, uint8_t lun, void *buffer, uint32_t lba, u
 bool tuh_msc_write10(uint8_t dev_addr, uint8_t lun, const void *buffer, uint32_t lba, uint16_t block_count,
                      tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
 
+// Perform SCSI Read 16 command. Read n blocks starting from 64-bit LBA to buffer
+// Complete callback is invoked when SCSI op is complete.
+// NOTE: buffer must be accessible by USB/DMA controller, aligned correctly and multiple of cache line if enabled
+bool tuh_msc_read16(uint8_t dev_addr, uint8_t lun, void *buffer, uint64_t lba, uint32_t block_count,
+                    tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
+
+// Perform SCSI Write 16 command. Write n blocks starting from 64-bit LBA to device
+// Complete callback is invoked when SCSI op is complete.
+// NOTE: buffer must be accessible by USB/DMA controller, aligned correctly and multiple of cache line if enabled
+bool tuh_msc_write16(uint8_t dev_addr, uint8_t lun, const void *buffer, uint64_t lba, uint32_t block_count,
+                     tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
+
+// Read n blocks starting from LBA to buffer. Request is split into READ commands of up to
+// CFG_TUH_MSC_XFER_BLOCK_MAX blocks, READ(16) is only used when LBA does not fit 32-bit.
+// Complete callback is invoked once when all blocks are read or a command fails, cbw/csw are of the last command.
+// NOTE: buffer must be accessible by USB/DMA controller, aligned correctly and multiple of cache line if enabled
+bool tuh_msc_read(uint8_t dev_addr, uint8_t lun, void *buffer, uint64_t lba, uint32_t block_count,
+                  tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
+
+// Write n blocks starting from LBA to device, split the same way as tuh_msc_read()
+// Complete callback is invoked once when all blocks are written or a command fails, cbw/csw are of the last command.
+// NOTE: buffer must be accessible by USB/DMA controller, aligned correctly and multiple of cache line if enabled
+bool tuh_msc_write(uint8_t dev_addr, uint8_t lun, const void *buffer, uint64_t lba, uint32_t block_count,
+                   tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
+
 // Perform SCSI Read Capacity 10 command
 // Complete callback is invoked when SCSI op is complete.
 // Note: during enumeration, host stack already carried out this request. Application can retrieve capacity by
@@ -93,6 +147,13 @@ bool tuh_msc_write10(uint8_t dev_addr, uint8_t lun, const void *buffer, uint32_t
 bool tuh_msc_read_capacity(uint8_t dev_addr, uint8_t lun, scsi_read_capacity10_resp_t *response,
                            tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
 
+// Perform SCSI Read Capacity 16 command
+// Complete callback is invoked when SCSI op is complete.
+// Note: during enumeration, host stack already carried out this request if Read Capacity 10 reports 0xFFFFFFFF
+// as last LBA. Application can retrieve capacity with tuh_msc_get_block_count64()
+bool tuh_msc_read_capacity16(uint8_t dev_addr, uint8_t lun, scsi_read_capacity16_resp_t *response,
+                             tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
+
 //------------- Application Callback -------------//
 
 // Invoked when a device with MassStorage interface is mounted
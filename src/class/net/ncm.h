@@ -31,6 +31,8 @@
 //    >2 - no performance gain
 // On High-Speed (STM32F7) :
 //    No performance gain
+// With CFG_TUD_EDPT_XFER_QUEUE > 1, up to that many free NTBs are queued for reception at once. NTBs holding
+// datagrams lent to the network stack (tud_network_recv_hold()) are not available for reception until released.
 #ifndef CFG_TUD_NCM_OUT_NTB_N
   #define CFG_TUD_NCM_OUT_NTB_N 1
 #endif
@@ -59,6 +61,18 @@
   #define CFG_TUD_NCM_OUT_MAX_DATAGRAMS_PER_NTB 6
 #endif
 
+// Send large datagrams of tud_network_xmit_sg() in place: only NTB header and the datagram head up to the next packet
+// boundary are copied, remaining payload is transferred from the segments directly. Segment memory must then be
+// accessible by the USB controller (DMA region, alignment, cache) until tud_network_xmit_done_cb() is invoked.
+#ifndef CFG_TUD_NCM_XMIT_ZEROCOPY
+  #define CFG_TUD_NCM_XMIT_ZEROCOPY 0
+#endif
+
+// Max number of segments of a datagram sent in place, datagrams with more segments are copied
+#ifndef CFG_TUD_NCM_XMIT_SEG_MAX
+  #define CFG_TUD_NCM_XMIT_SEG_MAX 4
+#endif
+
 // Table 6.2 Class-Specific Request Codes for Network Control Model subclass
 typedef enum
 {
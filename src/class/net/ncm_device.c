@@ -55,6 +55,23 @@
 //
 #define XMIT_NTB_N CFG_TUD_NCM_IN_NTB_N
 #define RECV_NTB_N CFG_TUD_NCM_OUT_NTB_N
+#define RECV_XFER_N TU_MIN(RECV_NTB_N, CFG_TUD_EDPT_XFER_QUEUE) // number of receptions queued at once
+
+// NTB header of a datagram sent in place: NTH, NDP with one datagram and terminator
+#define XMIT_INPLACE_HDR_LEN (sizeof(nth16_t) + sizeof(ndp16_t) + 2 * sizeof(ndp16_datagram_t))
+
+#if CFG_TUD_NCM_XMIT_ZEROCOPY
+// NTB transmitted in chunks: NTB header (+ copied data) from the NTB buffer, payload from the segments
+typedef struct {
+  void *ref;                                            // owner of the segments, see tud_network_xmit_done_cb()
+  uint8_t count;                                        // number of chunks, 0 -> NTB is sent from its buffer only
+  uint8_t ndx;                                          // next chunk to transmit
+  struct {
+    uint8_t const *buf;
+    uint16_t len;
+  } chunk[2 * CFG_TUD_NCM_XMIT_SEG_MAX + 1];
+} xmit_inplace_t;
+#endif
 
 typedef struct {
   // general
@@ -74,9 +91,13 @@ typedef struct {
   uint8_t recv_ready_tail;                              // tail index for recv_ready_ntb circular buffer
   uint8_t recv_ready_count;                             // number of elements in recv_ready_ntb circular buffer
   #endif
-  recv_ntb_t *recv_tinyusb_ntb;                         // buffer for the running transfer TinyUSB -> driver
+  recv_ntb_t *recv_tinyusb_ntb[RECV_XFER_N];            // buffers for the running transfers TinyUSB -> driver (circular buffer)
+  uint8_t recv_tinyusb_head;                            // head index for recv_tinyusb_ntb circular buffer
+  uint8_t recv_tinyusb_tail;                            // tail index for recv_tinyusb_ntb circular buffer
+  uint8_t recv_tinyusb_count;                           // number of receptions queued in TinyUSB
   recv_ntb_t *recv_glue_ntb;                            // buffer for the running transfer driver -> glue logic
   uint16_t recv_glue_ntb_datagram_ndx;                  // index into \a recv_glue_ntb_datagram
+  uint16_t recv_hold[RECV_NTB_N];                       // number of datagrams held by glue logic per NTB
 
   // xmit handling
   xmit_ntb_t *xmit_free_ntb[XMIT_NTB_N];                // free list of xmit NTBs
@@ -90,6 +111,9 @@ typedef struct {
   xmit_ntb_t *xmit_glue_ntb;                            // buffer for the running transfer glue logic -> driver
   uint16_t xmit_sequence;                               // NTB sequence counter
   uint16_t xmit_glue_ntb_datagram_ndx;                  // index into \a xmit_glue_ntb_datagram
+  #if CFG_TUD_NCM_XMIT_ZEROCOPY
+  xmit_inplace_t xmit_inplace[XMIT_NTB_N];              // chunks of NTBs with datagrams sent in place
+  #endif
 
   // notification handling
   enum {
@@ -133,6 +157,10 @@ TU_ATTR_WEAK void tud_network_set_packet_filter_cb(uint16_t packet_filter) {
   (void) packet_filter;
 }
 
+TU_ATTR_WEAK void tud_network_xmit_done_cb(void *ref) {
+  (void) ref;
+}
+
 TU_ATTR_WEAK bool tud_network_default_link_state_cb(void) {
   #ifdef CFG_TUD_NCM_DEFAULT_LINK_UP
   return CFG_TUD_NCM_DEFAULT_LINK_UP;
@@ -251,8 +279,23 @@ static void notification_xmit(uint8_t rhport, bool force_next) {
 // everything about packet transmission (driver -> TinyUSB)
 //
 
+#if CFG_TUD_NCM_XMIT_ZEROCOPY
+/**
+ * Get chunk information of an NTB
+ */
+static xmit_inplace_t *xmit_get_inplace(xmit_ntb_t const *ntb) {
+  for (int i = 0; i < XMIT_NTB_N; ++i) {
+    if (ntb == &ncm_epbuf.xmit[i].ntb) {
+      return &ncm_interface.xmit_inplace[i];
+    }
+  }
+  return NULL;
+} // xmit_get_inplace
+#endif
+
 /**
  * Put NTB into the transmitter free list.
+ * Segments of a datagram sent in place are given back to the glue logic.
  */
 static void xmit_put_ntb_into_free_list(xmit_ntb_t *free_ntb) {
   TU_LOG_DRV("xmit_put_ntb_into_free_list() - %p\n", ncm_interface.xmit_tinyusb_ntb);
@@ -264,6 +307,14 @@ static void xmit_put_ntb_into_free_list(xmit_ntb_t *free_ntb) {
   for (int i = 0; i < XMIT_NTB_N; ++i) {
     if (ncm_interface.xmit_free_ntb[i] == NULL) {
       ncm_interface.xmit_free_ntb[i] = free_ntb;
+
+      #if CFG_TUD_NCM_XMIT_ZEROCOPY
+      xmit_inplace_t *inplace = xmit_get_inplace(free_ntb);
+      if (inplace->count != 0) {
+        inplace->count = 0;
+        tud_network_xmit_done_cb(inplace->ref);
+      }
+      #endif
       return;
     }
   }
@@ -399,10 +450,47 @@ static void xmit_start_if_possible(uint8_t rhport) {
     TU_LOG_DRV(">> %d %d\n", ncm_interface.xmit_tinyusb_ntb->nth.wBlockLength, ncm_interface.xmit_glue_ntb_datagram_ndx);
   }
 
+  uint8_t const *buf = ncm_interface.xmit_tinyusb_ntb->data;
+  uint16_t len = ncm_interface.xmit_tinyusb_ntb->nth.wBlockLength;
+
+  #if CFG_TUD_NCM_XMIT_ZEROCOPY
+  xmit_inplace_t *inplace = xmit_get_inplace(ncm_interface.xmit_tinyusb_ntb);
+  if (inplace->count != 0) {
+    // NTB is sent in chunks, starting with the header
+    buf = inplace->chunk[0].buf;
+    len = inplace->chunk[0].len;
+    inplace->ndx = 1;
+  }
+  #endif
+
   // Kick off an endpoint transfer
-  usbd_edpt_xfer(0, ncm_interface.ep_in, ncm_interface.xmit_tinyusb_ntb->data, ncm_interface.xmit_tinyusb_ntb->nth.wBlockLength, false);
+  usbd_edpt_xfer(0, ncm_interface.ep_in, (uint8_t *) (uintptr_t) buf, len, false);
 } // xmit_start_if_possible
 
+#if CFG_TUD_NCM_XMIT_ZEROCOPY
+/**
+ * Continue transmission of an NTB sent in chunks.
+ * All chunks but the last one are a multiple of the endpoint size, so the host sees them as one transfer.
+ * \return true if the next chunk has been started
+ */
+static bool xmit_next_chunk(uint8_t rhport) {
+  if (ncm_interface.xmit_tinyusb_ntb == NULL) {
+    return false;
+  }
+
+  xmit_inplace_t *inplace = xmit_get_inplace(ncm_interface.xmit_tinyusb_ntb);
+  if (inplace->ndx >= inplace->count) {
+    return false;
+  }
+
+  uint8_t const ndx = inplace->ndx++;
+  TU_LOG_DRV("xmit_next_chunk(%d) - %d\n", ndx, inplace->chunk[ndx].len);
+  TU_ASSERT(usbd_edpt_xfer(rhport, ncm_interface.ep_in, (uint8_t *) (uintptr_t) inplace->chunk[ndx].buf,
+                           inplace->chunk[ndx].len, false), false);
+  return true;
+} // xmit_next_chunk
+#endif
+
 /**
  * check if a new datagram fits into the current NTB
  */
@@ -458,6 +546,138 @@ static bool xmit_setup_next_glue_ntb(void) {
   return true;
 } // xmit_setup_next_glue_ntb
 
+/**
+ * A datagram of \a size bytes has been copied to the end of the glue NTB:
+ * add it to the NDP and initiate transmission if possible.
+ */
+static void xmit_put_datagram_into_glue_ntb(uint16_t size) {
+  xmit_ntb_t *ntb = ncm_interface.xmit_glue_ntb;
+
+  // correct NTB internals
+  ntb->ndp_datagram[ncm_interface.xmit_glue_ntb_datagram_ndx].wDatagramIndex = ntb->nth.wBlockLength;
+  ntb->ndp_datagram[ncm_interface.xmit_glue_ntb_datagram_ndx].wDatagramLength = size;
+  ncm_interface.xmit_glue_ntb_datagram_ndx += 1;
+
+  ntb->nth.wBlockLength += (uint16_t) (size + XMIT_ALIGN_OFFSET(size));
+
+  if (ntb->nth.wBlockLength > CFG_TUD_NCM_IN_NTB_MAX_SIZE) {
+    TU_LOG_DRV("(EE) xmit_put_datagram_into_glue_ntb: buffer overflow\n"); // must not happen (really)
+    return;
+  }
+
+  xmit_start_if_possible(ncm_interface.rhport);
+} // xmit_put_datagram_into_glue_ntb
+
+#if CFG_TUD_NCM_XMIT_ZEROCOPY
+/**
+ * Put a datagram into an NTB of its own which references the segments instead of copying them.
+ * Payload is copied into the NTB buffer only up to the next packet boundary (and for segments shorter than a
+ * packet), the remaining chunks are transferred from the segments directly.
+ * Pending datagrams of the glue NTB are transmitted first to keep the order.
+ *
+ * \return false if there is no free NTB or the datagram cannot be split into chunks
+ */
+static bool xmit_setup_inplace_ntb(void *ref, tud_network_seg_t const *seg, uint8_t count, uint16_t size) {
+  TU_LOG_DRV("xmit_setup_inplace_ntb(%p, %d, %d)\n", ref, count, size);
+
+  TU_VERIFY(ncm_interface.itf_data_alt == 1 && count <= CFG_TUD_NCM_XMIT_SEG_MAX, false);
+  TU_VERIFY(XMIT_INPLACE_HDR_LEN + size <= ncm_interface.xmit_max_ntb_size, false);
+
+  // an empty glue NTB is taken over, this keeps the sequence numbers in order
+  bool const use_glue_ntb = (ncm_interface.xmit_glue_ntb != NULL && ncm_interface.xmit_glue_ntb_datagram_ndx == 0);
+  xmit_ntb_t *ntb = use_glue_ntb ? ncm_interface.xmit_glue_ntb : xmit_get_free_ntb();
+  if (ntb == NULL) {
+    return false;
+  }
+  xmit_inplace_t *inplace = xmit_get_inplace(ntb);
+
+  uint16_t const ep_size = ncm_interface.ep_size;
+  uint32_t ntb_pos = XMIT_INPLACE_HDR_LEN;   // position within the NTB
+  uint32_t buf_pos = XMIT_INPLACE_HDR_LEN;   // end of copied data in NTB buffer
+  uint32_t chunk_start = 0;                  // start of the not yet added chunk in NTB buffer
+  uint8_t nchunk = 0;
+
+  for (uint8_t i = 0; i < count; ++i) {
+    uint8_t const *src = (uint8_t const *) seg[i].buf;
+    uint16_t remain = seg[i].len;
+
+    while (remain > 0) {
+      uint16_t const to_boundary = (uint16_t) ((ep_size - ntb_pos % ep_size) % ep_size);
+      uint16_t const direct = (i == count - 1) ? remain : (uint16_t) (remain - remain % ep_size);
+
+      if (to_boundary != 0 || direct == 0) {
+        // copy up to the packet boundary or the rest of a segment shorter than a packet
+        uint16_t const n = (to_boundary != 0) ? tu_min16(to_boundary, remain) : remain;
+        if (buf_pos + n > CFG_TUD_NCM_IN_NTB_MAX_SIZE) {
+          // give NTB back, datagram pointers of the glue NTB have been overwritten
+          if (use_glue_ntb) {
+            memset(ntb->ndp_datagram, 0, sizeof(ntb->ndp_datagram));
+          } else {
+            xmit_put_ntb_into_free_list(ntb);
+          }
+          return false;
+        }
+        memcpy(ntb->data + buf_pos, src, n);
+        buf_pos += n;
+        ntb_pos += n;
+        src += n;
+        remain = (uint16_t) (remain - n);
+      } else {
+        // packet aligned: finish copied chunk and reference segment
+        if (buf_pos > chunk_start) {
+          inplace->chunk[nchunk].buf = ntb->data + chunk_start;
+          inplace->chunk[nchunk].len = (uint16_t) (buf_pos - chunk_start);
+          nchunk++;
+          buf_pos += XMIT_ALIGN_OFFSET(buf_pos);
+          chunk_start = buf_pos;
+        }
+        inplace->chunk[nchunk].buf = src;
+        inplace->chunk[nchunk].len = direct;
+        nchunk++;
+        ntb_pos += direct;
+        src += direct;
+        remain = (uint16_t) (remain - direct);
+      }
+    }
+  }
+  if (buf_pos > chunk_start) {
+    inplace->chunk[nchunk].buf = ntb->data + chunk_start;
+    inplace->chunk[nchunk].len = (uint16_t) (buf_pos - chunk_start);
+    nchunk++;
+  }
+
+  // Fill in NTB header, NDP16 with one datagram and terminator
+  if (!use_glue_ntb) {
+    ntb->nth.wSequence = ncm_interface.xmit_sequence++;
+  }
+  ntb->nth.dwSignature = NTH16_SIGNATURE;
+  ntb->nth.wHeaderLength = sizeof(ntb->nth);
+  ntb->nth.wBlockLength = (uint16_t) ntb_pos;
+  ntb->nth.wNdpIndex = sizeof(ntb->nth);
+
+  ntb->ndp.dwSignature = NDP16_SIGNATURE_NCM0;
+  ntb->ndp.wLength = sizeof(ntb->ndp) + 2 * sizeof(ndp16_datagram_t);
+  ntb->ndp.wNextNdpIndex = 0;
+  ntb->ndp_datagram[0].wDatagramIndex = XMIT_INPLACE_HDR_LEN;
+  ntb->ndp_datagram[0].wDatagramLength = size;
+  ntb->ndp_datagram[1].wDatagramIndex = 0;
+  ntb->ndp_datagram[1].wDatagramLength = 0;
+
+  inplace->ref = ref;
+  inplace->count = nchunk;
+  inplace->ndx = 0;
+
+  if (ncm_interface.xmit_glue_ntb != NULL && !use_glue_ntb) {
+    xmit_put_ntb_into_ready_list(ncm_interface.xmit_glue_ntb);
+  }
+  ncm_interface.xmit_glue_ntb = NULL;
+  xmit_put_ntb_into_ready_list(ntb);
+
+  xmit_start_if_possible(ncm_interface.rhport);
+  return true;
+} // xmit_setup_inplace_ntb
+#endif
+
 //-----------------------------------------------------------------------------
 //
 // all the recv_*() stuff (TinyUSB -> driver -> glue logic)
@@ -540,7 +760,9 @@ static void recv_put_ntb_into_ready_list(recv_ntb_t *ready_ntb) {
 } // recv_put_ntb_into_ready_list
 
 /**
- * If possible, start a new reception TinyUSB -> driver.
+ * If possible, start new receptions TinyUSB -> driver.
+ * Up to \a RECV_XFER_N transfers are queued, so that the host can send the next NTB while the
+ * previous one is processed.
  */
 static void recv_try_to_start_new_reception(uint8_t rhport) {
   TU_LOG_DRV("recv_try_to_start_new_reception(%d)\n", rhport);
@@ -548,26 +770,54 @@ static void recv_try_to_start_new_reception(uint8_t rhport) {
   if (ncm_interface.itf_data_alt != 1) {
     return;
   }
-  if (ncm_interface.recv_tinyusb_ntb != NULL) {
-    return;
-  }
-  if (usbd_edpt_busy(rhport, ncm_interface.ep_out)) {
-    return;
+
+  while (ncm_interface.recv_tinyusb_count < RECV_XFER_N) {
+    recv_ntb_t *ntb = recv_get_free_ntb();
+    if (ntb == NULL) {
+      return;
+    }
+
+    // initiate transfer, NTB is queued first since transfer may complete any time
+    TU_LOG_DRV("  start reception %p\n", ntb);
+    uint8_t const head = ncm_interface.recv_tinyusb_head;
+    ncm_interface.recv_tinyusb_ntb[head] = ntb;
+    ncm_interface.recv_tinyusb_head = (uint8_t) ((head + 1) % RECV_XFER_N);
+    ncm_interface.recv_tinyusb_count++;
+
+    if (!usbd_edpt_xfer(rhport, ncm_interface.ep_out, ntb->data, CFG_TUD_NCM_OUT_NTB_MAX_SIZE, false)) {
+      ncm_interface.recv_tinyusb_head = head;
+      ncm_interface.recv_tinyusb_count--;
+      recv_put_ntb_into_free_list(ntb);
+      return;
+    }
   }
+} // recv_try_to_start_new_reception
 
-  ncm_interface.recv_tinyusb_ntb = recv_get_free_ntb();
-  if (ncm_interface.recv_tinyusb_ntb == NULL) {
-    return;
+/**
+ * Get the NTB of the oldest running reception (and remove it from the list).
+ */
+static recv_ntb_t *recv_get_next_tinyusb_ntb(void) {
+  if (ncm_interface.recv_tinyusb_count == 0) {
+    return NULL;
   }
 
-  // initiate transfer
-  TU_LOG_DRV("  start reception\n");
-  bool r = usbd_edpt_xfer(rhport, ncm_interface.ep_out, ncm_interface.recv_tinyusb_ntb->data, CFG_TUD_NCM_OUT_NTB_MAX_SIZE, false);
-  if (!r) {
-    recv_put_ntb_into_free_list(ncm_interface.recv_tinyusb_ntb);
-    ncm_interface.recv_tinyusb_ntb = NULL;
+  recv_ntb_t *r = ncm_interface.recv_tinyusb_ntb[ncm_interface.recv_tinyusb_tail];
+  ncm_interface.recv_tinyusb_tail = (uint8_t) ((ncm_interface.recv_tinyusb_tail + 1) % RECV_XFER_N);
+  ncm_interface.recv_tinyusb_count--;
+  return r;
+} // recv_get_next_tinyusb_ntb
+
+/**
+ * Get index of a receive NTB.
+ */
+static uint8_t recv_ntb_index(recv_ntb_t const *ntb) {
+  for (uint8_t i = 0; i < RECV_NTB_N; ++i) {
+    if (ntb == &ncm_epbuf.recv[i].ntb) {
+      return i;
+    }
   }
-} // recv_try_to_start_new_reception
+  return 0; // not reached
+} // recv_ntb_index
 
 /**
  * Validate incoming datagram.
@@ -696,8 +946,10 @@ static void recv_transfer_datagram_to_glue_logic(void) {
           // -> next datagram
           ++ncm_interface.recv_glue_ntb_datagram_ndx;
         } else {
-          // end of datagrams reached
-          recv_put_ntb_into_free_list(ncm_interface.recv_glue_ntb);
+          // end of datagrams reached, NTB is kept until glue logic has released held datagrams
+          if (ncm_interface.recv_hold[recv_ntb_index(ncm_interface.recv_glue_ntb)] == 0) {
+            recv_put_ntb_into_free_list(ncm_interface.recv_glue_ntb);
+          }
           ncm_interface.recv_glue_ntb = NULL;
         }
       }
@@ -746,20 +998,45 @@ void tud_network_xmit(void *ref, uint16_t arg) {
   // copy new datagram to the end of the current NTB
   uint16_t size = tud_network_xmit_cb(ntb->data + ntb->nth.wBlockLength, ref, arg);
 
-  // correct NTB internals
-  ntb->ndp_datagram[ncm_interface.xmit_glue_ntb_datagram_ndx].wDatagramIndex = ntb->nth.wBlockLength;
-  ntb->ndp_datagram[ncm_interface.xmit_glue_ntb_datagram_ndx].wDatagramLength = size;
-  ncm_interface.xmit_glue_ntb_datagram_ndx += 1;
+  xmit_put_datagram_into_glue_ntb(size);
+} // tud_network_xmit
 
-  ntb->nth.wBlockLength += (uint16_t) (size + XMIT_ALIGN_OFFSET(size));
+/**
+ * Transmit a datagram given as list of segments.
+ * With \a CFG_TUD_NCM_XMIT_ZEROCOPY datagrams of at least two packets are sent in place, otherwise the segments
+ * are gathered into the current NTB (together with other datagrams) and released right away.
+ */
+bool tud_network_xmit_sg(void *ref, tud_network_seg_t const *seg, uint8_t count) {
+  TU_LOG_DRV("tud_network_xmit_sg(%p, %d)\n", ref, count);
 
-  if (ntb->nth.wBlockLength > CFG_TUD_NCM_IN_NTB_MAX_SIZE) {
-    TU_LOG_DRV("(EE) tud_network_xmit: buffer overflow\n"); // must not happen (really)
-    return;
+  uint32_t size = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    size += seg[i].len;
   }
+  TU_ASSERT(size <= ncm_interface.xmit_max_ntb_size - XMIT_INPLACE_HDR_LEN, false);
 
-  xmit_start_if_possible(ncm_interface.rhport);
-} // tud_network_xmit
+  #if CFG_TUD_NCM_XMIT_ZEROCOPY
+  if (size >= 2u * ncm_interface.ep_size && xmit_setup_inplace_ntb(ref, seg, count, (uint16_t) size)) {
+    return true;
+  }
+  #endif
+
+  if (!tud_network_can_xmit((uint16_t) size)) {
+    return false;
+  }
+
+  // gather segments at the end of the current NTB
+  xmit_ntb_t *ntb = ncm_interface.xmit_glue_ntb;
+  uint16_t pos = ntb->nth.wBlockLength;
+  for (uint8_t i = 0; i < count; ++i) {
+    memcpy(ntb->data + pos, seg[i].buf, seg[i].len);
+    pos = (uint16_t) (pos + seg[i].len);
+  }
+
+  xmit_put_datagram_into_glue_ntb((uint16_t) size);
+  tud_network_xmit_done_cb(ref);
+  return true;
+} // tud_network_xmit_sg
 
 /**
  * Keep the receive logic busy and transfer pending packets to the glue logic.
@@ -789,6 +1066,37 @@ void tud_network_recv_renew(void) {
   recv_try_to_start_new_reception(ncm_interface.rhport);
 } // tud_network_recv_renew
 
+/**
+ * Glue logic keeps the datagram currently passed to tud_network_recv_cb().
+ */
+void tud_network_recv_hold(void) {
+  TU_LOG_DRV("tud_network_recv_hold()\n");
+
+  TU_VERIFY(ncm_interface.recv_glue_ntb != NULL,);
+  ncm_interface.recv_hold[recv_ntb_index(ncm_interface.recv_glue_ntb)]++;
+} // tud_network_recv_hold
+
+/**
+ * Glue logic is done with a held datagram.
+ * The NTB is freed (and reception restarted) once all its datagrams are delivered and released.
+ */
+void tud_network_recv_release(const uint8_t *src) {
+  TU_LOG_DRV("tud_network_recv_release(%p)\n", src);
+
+  for (uint8_t i = 0; i < RECV_NTB_N; ++i) {
+    recv_ntb_t *ntb = &ncm_epbuf.recv[i].ntb;
+    if (src >= ntb->data && src < ntb->data + sizeof(ntb->data)) {
+      TU_VERIFY(ncm_interface.recv_hold[i] > 0,);
+      ncm_interface.recv_hold[i]--;
+      if (ncm_interface.recv_hold[i] == 0 && ntb != ncm_interface.recv_glue_ntb) {
+        recv_put_ntb_into_free_list(ntb);
+        recv_try_to_start_new_reception(ncm_interface.rhport);
+      }
+      return;
+    }
+  }
+} // tud_network_recv_release
+
 /**
  * Same as tud_network_recv_renew() but knows \a rhport
  */
@@ -884,12 +1192,32 @@ bool netd_deinit(void) {
 
 /**
  * Resets the port.
- * In this driver this is the same as netd_init()
+ * In this driver this is the same as netd_init(), except that datagrams owned
+ * by the glue logic are released (xmit) or kept (recv).
  */
 void netd_reset(uint8_t rhport) {
   (void) rhport;
 
+  #if CFG_TUD_NCM_XMIT_ZEROCOPY
+  for (int i = 0; i < XMIT_NTB_N; ++i) {
+    if (ncm_interface.xmit_inplace[i].count != 0) {
+      tud_network_xmit_done_cb(ncm_interface.xmit_inplace[i].ref);
+    }
+  }
+  #endif
+
+  uint16_t recv_hold[RECV_NTB_N];
+  memcpy(recv_hold, ncm_interface.recv_hold, sizeof(recv_hold));
+
   netd_init();
+
+  // held NTBs are put into free list on release
+  memcpy(ncm_interface.recv_hold, recv_hold, sizeof(recv_hold));
+  for (int i = 0; i < RECV_NTB_N; ++i) {
+    if (recv_hold[i] != 0) {
+      ncm_interface.recv_free_ntb[i] = NULL;
+    }
+  }
 } // netd_reset
 
 /**
@@ -957,23 +1285,31 @@ bool netd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_
   if (ep_addr == ncm_interface.ep_out) {
     // new NTB received
     // - make the NTB valid
-    // - if ready transfer datagrams to the glue logic for further processing
     // - if there is a free receive buffer, initiate reception
-    if (!recv_validate_datagram(ncm_interface.recv_tinyusb_ntb, xferred_bytes)) {
+    // - if ready transfer datagrams to the glue logic for further processing
+    recv_ntb_t *ntb = recv_get_next_tinyusb_ntb();
+    TU_VERIFY(ntb != NULL);
+    if (!recv_validate_datagram(ntb, xferred_bytes)) {
       // verification failed: ignore NTB and return it to free
       TU_LOG_DRV("Invalid datatagram. Ignoring NTB\n");
-      recv_put_ntb_into_free_list(ncm_interface.recv_tinyusb_ntb);
+      recv_put_ntb_into_free_list(ntb);
     } else {
       // packet ok -> put it into ready list
-      recv_put_ntb_into_ready_list(ncm_interface.recv_tinyusb_ntb);
+      recv_put_ntb_into_ready_list(ntb);
     }
-    ncm_interface.recv_tinyusb_ntb = NULL;
+    recv_try_to_start_new_reception(rhport);
     tud_network_recv_renew_r(rhport);
   } else if (ep_addr == ncm_interface.ep_in) {
-    // transmission of an NTB finished
+    // transmission of an NTB (chunk) finished
+    // - continue with the next chunk of an NTB sent in place
     // - free the transmitted NTB buffer
     // - insert ZLPs when necessary
     // - if there is another transmit NTB waiting, try to start transmission
+    #if CFG_TUD_NCM_XMIT_ZEROCOPY
+    if (xmit_next_chunk(rhport)) {
+      return true;
+    }
+    #endif
     xmit_put_ntb_into_free_list(ncm_interface.xmit_tinyusb_ntb);
     ncm_interface.xmit_tinyusb_ntb = NULL;
     if (!xmit_insert_required_zlp(rhport, xferred_bytes)) {
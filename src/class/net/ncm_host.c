@@ -0,0 +1,785 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if (CFG_TUH_ENABLED && CFG_TUH_NCM)
+
+#include "host/usbh.h"
+#include "host/usbh_pvt.h"
+
+#include "net_host.h"
+
+// Level where CFG_TUSB_DEBUG must be at least for this driver is logged
+#ifndef CFG_TUH_NCM_LOG_LEVEL
+  #define CFG_TUH_NCM_LOG_LEVEL   CFG_TUH_LOG_LEVEL
+#endif
+
+#define TU_LOG_DRV(...)   TU_LOG(CFG_TUH_NCM_LOG_LEVEL, __VA_ARGS__)
+
+TU_VERIFY_STATIC(CFG_TUH_NCM_IN_NTB_MAX_SIZE >= 2048 && CFG_TUH_NCM_IN_NTB_MAX_SIZE <= 0xffff, "NTB16 input size must be within 2048 and 65535");
+TU_VERIFY_STATIC(CFG_TUH_NCM_OUT_NTB_MAX_SIZE <= 0xffff, "NTB16 output size must not exceed 65535");
+TU_VERIFY_STATIC(CFG_TUH_NCM_IN_NTB_N > 0 && CFG_TUH_NCM_IN_NTB_N <= 8, "1 to 8 receive NTBs are supported");
+
+//--------------------------------------------------------------------+
+// Weak stubs: invoked if no strong implementation is available
+//--------------------------------------------------------------------+
+TU_ATTR_WEAK void tuh_network_mount_cb(uint8_t idx) { (void) idx; }
+TU_ATTR_WEAK void tuh_network_umount_cb(uint8_t idx) { (void) idx; }
+TU_ATTR_WEAK void tuh_network_link_state_cb(uint8_t idx, bool is_up) { (void) idx; (void) is_up; }
+
+//--------------------------------------------------------------------+
+// MACRO CONSTANT TYPEDEF
+//--------------------------------------------------------------------+
+
+// One NTB is on the bus while datagrams are aggregated into the other one
+#define OUT_NTB_N 2
+
+// NTH16 and NDP16 with room for max datagrams + terminating entry, datagrams follow
+#define OUT_NTB_HDR_LEN \
+  (sizeof(nth16_t) + sizeof(ndp16_t) + (CFG_TUH_NCM_OUT_MAX_DATAGRAMS_PER_NTB + 1) * sizeof(ndp16_datagram_t))
+
+// Ethernet packet filter bits, ECM 1.2 Table 8
+enum {
+  PACKET_TYPE_ALL_MULTICAST = TU_BIT(1),
+  PACKET_TYPE_DIRECTED      = TU_BIT(2),
+  PACKET_TYPE_BROADCAST     = TU_BIT(3),
+};
+
+// set config state, interface index is kept in the upper byte of user_data
+enum {
+  CONFIG_GET_NTB_PARAMETERS = 0,
+  CONFIG_SET_NTB_INPUT_SIZE,
+  CONFIG_GET_MAC_ADDRESS,
+  CONFIG_SET_PACKET_FILTER,
+  CONFIG_SET_DATA_INTERFACE,
+  CONFIG_COMPLETE
+};
+
+#define CONFIG_USER_DATA(_idx, _state) ((((uintptr_t) (_idx)) << 8) | (_state))
+
+typedef struct {
+  uint8_t daddr;
+  uint8_t itf_num;          // communication interface
+  uint8_t itf_data;         // data interface
+  uint8_t itf_data_alt;     // data interface alternate setting with bulk endpoints
+  uint8_t subclass;         // CDC_COMM_SUBCLASS_NETWORK_CONTROL_MODEL or CDC_COMM_SUBCLASS_ETHERNET_CONTROL_MODEL
+  uint8_t iInterface;
+  uint8_t iMACAddress;
+
+  uint8_t ep_notif;
+  uint8_t ep_in;
+  uint8_t ep_out;
+  uint16_t ep_out_size;
+
+  uint8_t mac[6];
+  bool mounted;
+  bool link_up;
+
+  // transmission (host -> device)
+  struct {
+    uint16_t max_size;        // negotiated NTB size
+    uint16_t max_datagrams;   // negotiated datagrams per NTB
+    uint16_t hdr_len;         // NTB length without datagrams, 0 for ECM
+    uint16_t divisor;         // datagram offset % divisor == remainder
+    uint16_t remainder;
+    uint16_t sequence;
+    uint16_t granted;         // datagram size accepted by tuh_network_can_xmit(), 0 if none
+    uint16_t len[OUT_NTB_N];  // used bytes of NTB
+    uint8_t count[OUT_NTB_N]; // datagrams in NTB
+    uint8_t fill;             // NTB aggregating datagrams
+    bool busy;                // other NTB is on the bus
+  } out;
+
+  // reception (device -> host)
+  struct {
+    uint16_t len[CFG_TUH_NCM_IN_NTB_N];  // received bytes of NTB
+    uint8_t ready[CFG_TUH_NCM_IN_NTB_N]; // received NTBs in order (circular buffer)
+    uint8_t ready_head;
+    uint8_t ready_count;
+    uint8_t used;                        // bitmap of NTBs on the bus or in ready list
+    uint8_t xfer;                        // NTB on the bus, TUSB_INDEX_INVALID_8 if none
+    uint16_t ndx;                        // next datagram of NTB at ready head
+    bool pending;                        // datagram passed to application is not renewed yet
+    bool delivering;                     // recv_deliver() is active (avoid recursive invocations)
+  } in;
+} ncmh_interface_t;
+
+typedef struct {
+  struct {
+    TUH_EPBUF_DEF(ntb, CFG_TUH_NCM_OUT_NTB_MAX_SIZE);
+  } out[OUT_NTB_N];
+  struct {
+    TUH_EPBUF_DEF(ntb, CFG_TUH_NCM_IN_NTB_MAX_SIZE);
+  } in[CFG_TUH_NCM_IN_NTB_N];
+  TUH_EPBUF_TYPE_DEF(ncm_notify_t, notif);
+} ncmh_epbuf_t;
+
+static ncmh_interface_t _ncmh_itf[CFG_TUH_NCM];
+CFG_TUH_MEM_SECTION static ncmh_epbuf_t _ncmh_epbuf[CFG_TUH_NCM];
+
+static void config_process_cb(tuh_xfer_t *xfer);
+static void recv_start(uint8_t idx);
+static void recv_deliver(uint8_t idx);
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+TU_ATTR_ALWAYS_INLINE static inline ncmh_interface_t *get_itf(uint8_t idx) {
+  TU_VERIFY(idx < CFG_TUH_NCM, NULL);
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+  return (p_ncm->daddr != 0) ? p_ncm : NULL;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t find_new_index(void) {
+  for (uint8_t idx = 0; idx < CFG_TUH_NCM; idx++) {
+    if (_ncmh_itf[idx].daddr == 0) {
+      return idx;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+static uint8_t get_idx_by_ep_addr(uint8_t daddr, uint8_t ep_addr) {
+  for (uint8_t idx = 0; idx < CFG_TUH_NCM; idx++) {
+    const ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+    if (p_ncm->daddr == daddr &&
+        (ep_addr == p_ncm->ep_notif || ep_addr == p_ncm->ep_in || ep_addr == p_ncm->ep_out)) {
+      return idx;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool is_ncm(const ncmh_interface_t *p_ncm) {
+  return p_ncm->subclass == CDC_COMM_SUBCLASS_NETWORK_CONTROL_MODEL;
+}
+
+// MAC address is a string of 12 hex digits, ECM 1.2 Table 3
+static bool parse_mac_string(uint8_t mac[6], const uint8_t *desc_str) {
+  TU_VERIFY(desc_str[0] >= 2 + 12 * 2 && desc_str[1] == TUSB_DESC_STRING);
+  uint8_t addr[6] = {0};
+  for (uint8_t i = 0; i < 12; i++) {
+    const uint8_t c = desc_str[2 + 2 * i];
+    uint8_t nibble;
+    if (c >= '0' && c <= '9') {
+      nibble = (uint8_t) (c - '0');
+    } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+      nibble = (uint8_t) ((c | 0x20) - 'a' + 10);
+    } else {
+      return false;
+    }
+    addr[i / 2] = (uint8_t) ((addr[i / 2] << 4) | nibble);
+  }
+  memcpy(mac, addr, 6);
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Transmission
+//--------------------------------------------------------------------+
+
+// offset of the next datagram in NTB currently filled
+static uint16_t xmit_datagram_offset(const ncmh_interface_t *p_ncm) {
+  const uint16_t len = p_ncm->out.len[p_ncm->out.fill];
+  const uint16_t div = p_ncm->out.divisor;
+  return (uint16_t) (len + (div + p_ncm->out.remainder - len % div) % div);
+}
+
+static bool xmit_datagram_fits(const ncmh_interface_t *p_ncm, uint16_t size) {
+  if (p_ncm->out.count[p_ncm->out.fill] >= p_ncm->out.max_datagrams) {
+    return false;
+  }
+  return (uint32_t) xmit_datagram_offset(p_ncm) + size <= p_ncm->out.max_size;
+}
+
+// Send NTB with aggregated datagrams if bus is idle
+static void xmit_start(uint8_t idx) {
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+  const uint8_t fill = p_ncm->out.fill;
+  const uint8_t count = p_ncm->out.count[fill];
+  if (p_ncm->out.busy || count == 0) {
+    return;
+  }
+
+  uint8_t *ntb = _ncmh_epbuf[idx].out[fill].ntb;
+  uint16_t len = p_ncm->out.len[fill];
+
+  if (is_ncm(p_ncm)) {
+    // NTB shorter than max size must end with a short packet, pad it rather than sending a ZLP
+    if ((len % p_ncm->ep_out_size) == 0 && len < p_ncm->out.max_size) {
+      ntb[len++] = 0;
+    }
+
+    nth16_t *nth = (nth16_t *) ntb;
+    nth->dwSignature   = NTH16_SIGNATURE;
+    nth->wHeaderLength = sizeof(nth16_t);
+    nth->wSequence     = p_ncm->out.sequence++;
+    nth->wBlockLength  = len;
+    nth->wNdpIndex     = sizeof(nth16_t);
+
+    ndp16_t *ndp = (ndp16_t *) (ntb + sizeof(nth16_t));
+    ndp->dwSignature   = NDP16_SIGNATURE_NCM0;
+    ndp->wLength       = (uint16_t) (sizeof(ndp16_t) + (count + 1) * sizeof(ndp16_datagram_t));
+    ndp->wNextNdpIndex = 0;
+
+    ndp16_datagram_t *datagram = (ndp16_datagram_t *) (ntb + sizeof(nth16_t) + sizeof(ndp16_t));
+    datagram[count].wDatagramIndex  = 0;
+    datagram[count].wDatagramLength = 0;
+  }
+
+  TU_LOG_DRV("  NCMh xmit %u datagrams, %u bytes\r\n", count, len);
+
+  // start aggregating into the other NTB
+  p_ncm->out.busy = true;
+  p_ncm->out.fill = (uint8_t) (fill ^ 1);
+  p_ncm->out.len[p_ncm->out.fill]   = p_ncm->out.hdr_len;
+  p_ncm->out.count[p_ncm->out.fill] = 0;
+
+  if (!usbh_edpt_xfer(p_ncm->daddr, p_ncm->ep_out, ntb, len)) {
+    p_ncm->out.busy = false;
+    TU_BREAKPOINT();
+  }
+}
+
+static void xmit_complete(uint8_t idx, uint32_t xferred_bytes) {
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+
+  // ECM frame of a multiple of packet size is terminated by a ZLP, NCM NTBs are padded instead
+  if (!is_ncm(p_ncm) && xferred_bytes > 0 && (xferred_bytes % p_ncm->ep_out_size) == 0) {
+    if (usbh_edpt_xfer(p_ncm->daddr, p_ncm->ep_out, NULL, 0)) {
+      return;
+    }
+  }
+
+  p_ncm->out.busy = false;
+  xmit_start(idx);
+}
+
+//--------------------------------------------------------------------+
+// Reception
+//--------------------------------------------------------------------+
+
+// Locate datagram ndx of a received NTB. Return false at the end of datagrams, or if NTB is malformed in which case
+// remaining datagrams are dropped. Only the first NDP is parsed, same as the device driver.
+static bool recv_get_datagram(const ncmh_interface_t *p_ncm, const uint8_t *ntb, uint16_t len, uint16_t ndx,
+                              uint16_t *offset, uint16_t *size) {
+  if (!is_ncm(p_ncm)) {
+    // ECM transfer is a single Ethernet frame
+    *offset = 0;
+    *size   = len;
+    return ndx == 0 && len > 0;
+  }
+
+  TU_VERIFY(len >= sizeof(nth16_t));
+  const nth16_t *nth = (const nth16_t *) ntb;
+  TU_VERIFY(nth->dwSignature == NTH16_SIGNATURE && nth->wHeaderLength == sizeof(nth16_t));
+  TU_VERIFY(nth->wBlockLength <= len);
+
+  const uint16_t block_len = nth->wBlockLength;
+  const uint16_t ndp_pos   = nth->wNdpIndex;
+  TU_VERIFY(ndp_pos >= sizeof(nth16_t) && (uint32_t) ndp_pos + sizeof(ndp16_t) <= block_len);
+
+  const ndp16_t *ndp = (const ndp16_t *) (ntb + ndp_pos);
+  TU_VERIFY(ndp->dwSignature == NDP16_SIGNATURE_NCM0 || ndp->dwSignature == NDP16_SIGNATURE_NCM1);
+  TU_VERIFY(ndp->wLength >= sizeof(ndp16_t) + 2 * sizeof(ndp16_datagram_t) &&
+            (uint32_t) ndp_pos + ndp->wLength <= block_len);
+  TU_VERIFY(ndx < (ndp->wLength - sizeof(ndp16_t)) / sizeof(ndp16_datagram_t));
+
+  const ndp16_datagram_t *datagram = (const ndp16_datagram_t *) (ntb + ndp_pos + sizeof(ndp16_t)) + ndx;
+  TU_VERIFY(datagram->wDatagramIndex != 0 && datagram->wDatagramLength != 0); // terminating entry
+  TU_VERIFY((uint32_t) datagram->wDatagramIndex + datagram->wDatagramLength <= block_len);
+
+  *offset = datagram->wDatagramIndex;
+  *size   = datagram->wDatagramLength;
+  return true;
+}
+
+// Queue a free NTB for reception if bus is idle
+static void recv_start(uint8_t idx) {
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+  if (!p_ncm->mounted || p_ncm->in.xfer != TUSB_INDEX_INVALID_8) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < CFG_TUH_NCM_IN_NTB_N; i++) {
+    if (0 == (p_ncm->in.used & TU_BIT(i))) {
+      p_ncm->in.used |= (uint8_t) TU_BIT(i);
+      p_ncm->in.xfer = i;
+      if (!usbh_edpt_xfer(p_ncm->daddr, p_ncm->ep_in, _ncmh_epbuf[idx].in[i].ntb, CFG_TUH_NCM_IN_NTB_MAX_SIZE)) {
+        p_ncm->in.used &= (uint8_t) ~TU_BIT(i);
+        p_ncm->in.xfer = TUSB_INDEX_INVALID_8;
+      }
+      return;
+    }
+  }
+}
+
+static void recv_complete(uint8_t idx, xfer_result_t result, uint32_t xferred_bytes) {
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+  const uint8_t i = p_ncm->in.xfer;
+  TU_VERIFY(i < CFG_TUH_NCM_IN_NTB_N,);
+  p_ncm->in.xfer = TUSB_INDEX_INVALID_8;
+
+  if (result == XFER_RESULT_SUCCESS && xferred_bytes > 0) {
+    p_ncm->in.len[i] = (uint16_t) xferred_bytes;
+    p_ncm->in.ready[(p_ncm->in.ready_head + p_ncm->in.ready_count) % CFG_TUH_NCM_IN_NTB_N] = i;
+    p_ncm->in.ready_count++;
+  } else {
+    p_ncm->in.used &= (uint8_t) ~TU_BIT(i);
+  }
+
+  recv_start(idx);
+  recv_deliver(idx);
+}
+
+// Pass datagrams to application in place until one is not renewed right away
+static void recv_deliver(uint8_t idx) {
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+  if (p_ncm->in.delivering) {
+    return; // tuh_network_recv_renew() within tuh_network_recv_cb(), loop below continues
+  }
+  p_ncm->in.delivering = true;
+
+  while (p_ncm->mounted && !p_ncm->in.pending && p_ncm->in.ready_count > 0) {
+    const uint8_t i = p_ncm->in.ready[p_ncm->in.ready_head];
+    const uint8_t *ntb = _ncmh_epbuf[idx].in[i].ntb;
+    uint16_t offset, size;
+
+    if (!recv_get_datagram(p_ncm, ntb, p_ncm->in.len[i], p_ncm->in.ndx, &offset, &size)) {
+      // all datagrams are renewed, NTB can be reused for reception
+      p_ncm->in.ready_head = (uint8_t) ((p_ncm->in.ready_head + 1) % CFG_TUH_NCM_IN_NTB_N);
+      p_ncm->in.ready_count--;
+      p_ncm->in.used &= (uint8_t) ~TU_BIT(i);
+      p_ncm->in.ndx = 0;
+      recv_start(idx);
+      continue;
+    }
+
+    p_ncm->in.pending = true;
+    if (!tuh_network_recv_cb(idx, ntb + offset, size)) {
+      // not accepted, try again with next tuh_network_recv_renew()
+      p_ncm->in.pending = false;
+      break;
+    }
+  }
+
+  p_ncm->in.delivering = false;
+}
+
+//--------------------------------------------------------------------+
+// Application API
+//--------------------------------------------------------------------+
+bool tuh_network_mounted(uint8_t idx) {
+  const ncmh_interface_t *p_ncm = get_itf(idx);
+  TU_VERIFY(p_ncm);
+  return p_ncm->mounted;
+}
+
+uint8_t tuh_network_itf_get_index(uint8_t daddr, uint8_t itf_num) {
+  for (uint8_t idx = 0; idx < CFG_TUH_NCM; idx++) {
+    const ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+    if (p_ncm->daddr == daddr && (p_ncm->itf_num == itf_num || p_ncm->itf_data == itf_num)) {
+      return idx;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+bool tuh_network_itf_get_info(uint8_t idx, tuh_itf_info_t *info) {
+  const ncmh_interface_t *p_ncm = get_itf(idx);
+  TU_VERIFY(p_ncm && info);
+
+  info->daddr = p_ncm->daddr;
+
+  // re-construct descriptor
+  tusb_desc_interface_t *desc = &info->desc;
+  desc->bLength            = sizeof(tusb_desc_interface_t);
+  desc->bDescriptorType    = TUSB_DESC_INTERFACE;
+  desc->bInterfaceNumber   = p_ncm->itf_num;
+  desc->bAlternateSetting  = 0;
+  desc->bNumEndpoints      = p_ncm->ep_notif ? 1 : 0;
+  desc->bInterfaceClass    = TUSB_CLASS_CDC;
+  desc->bInterfaceSubClass = p_ncm->subclass;
+  desc->bInterfaceProtocol = 0;
+  desc->iInterface         = p_ncm->iInterface;
+
+  return true;
+}
+
+bool tuh_network_get_mac_address(uint8_t idx, uint8_t mac[6]) {
+  const ncmh_interface_t *p_ncm = get_itf(idx);
+  TU_VERIFY(p_ncm && p_ncm->mounted);
+  memcpy(mac, p_ncm->mac, 6);
+  return true;
+}
+
+bool tuh_network_link_is_up(uint8_t idx) {
+  const ncmh_interface_t *p_ncm = get_itf(idx);
+  TU_VERIFY(p_ncm && p_ncm->mounted);
+  return p_ncm->link_up;
+}
+
+void tuh_network_recv_renew(uint8_t idx) {
+  ncmh_interface_t *p_ncm = get_itf(idx);
+  TU_VERIFY(p_ncm,);
+
+  if (p_ncm->in.pending) {
+    p_ncm->in.pending = false;
+    p_ncm->in.ndx++;
+  }
+  recv_deliver(idx);
+}
+
+bool tuh_network_can_xmit(uint8_t idx, uint16_t size) {
+  ncmh_interface_t *p_ncm = get_itf(idx);
+  TU_VERIFY(p_ncm && p_ncm->mounted);
+
+  if (!xmit_datagram_fits(p_ncm, size)) {
+    // NTB is full: hand it to the bus if idle and aggregate into the other one
+    xmit_start(idx);
+  }
+
+  // tuh_network_xmit() checks against this size before its callback writes into NTB
+  const bool fits = xmit_datagram_fits(p_ncm, size);
+  p_ncm->out.granted = fits ? size : 0;
+  return fits;
+}
+
+bool tuh_network_xmit(uint8_t idx, void *ref, uint16_t arg) {
+  ncmh_interface_t *p_ncm = get_itf(idx);
+  TU_VERIFY(p_ncm && p_ncm->mounted);
+
+  const uint8_t fill = p_ncm->out.fill;
+  uint8_t *ntb = _ncmh_epbuf[idx].out[fill].ntb;
+  const uint16_t offset = xmit_datagram_offset(p_ncm);
+  const uint16_t granted = p_ncm->out.granted;
+  p_ncm->out.granted = 0;
+
+  // callback may write up to the size accepted by tuh_network_can_xmit(), which must still fit
+  TU_ASSERT(granted > 0 && xmit_datagram_fits(p_ncm, granted));
+
+  const uint16_t size = tuh_network_xmit_cb(idx, ntb + offset, ref, arg);
+  TU_ASSERT(size <= granted);
+
+  if (is_ncm(p_ncm)) {
+    ndp16_datagram_t *datagram = (ndp16_datagram_t *) (ntb + sizeof(nth16_t) + sizeof(ndp16_t));
+    datagram[p_ncm->out.count[fill]].wDatagramIndex  = offset;
+    datagram[p_ncm->out.count[fill]].wDatagramLength = size;
+  }
+  p_ncm->out.count[fill]++;
+  p_ncm->out.len[fill] = (uint16_t) (offset + size);
+
+  xmit_start(idx);
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// USBH API
+//--------------------------------------------------------------------+
+bool ncmh_init(void) {
+  tu_memclr(_ncmh_itf, sizeof(_ncmh_itf));
+  return true;
+}
+
+bool ncmh_deinit(void) {
+  return true;
+}
+
+void ncmh_close(uint8_t daddr) {
+  for (uint8_t idx = 0; idx < CFG_TUH_NCM; idx++) {
+    ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+    if (p_ncm->daddr == daddr) {
+      TU_LOG_DRV("  NCMh close addr = %u index = %u\r\n", daddr, idx);
+      if (p_ncm->mounted) {
+        tuh_network_umount_cb(idx);
+      }
+      tu_memclr(p_ncm, sizeof(ncmh_interface_t));
+    }
+  }
+}
+
+bool ncmh_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+  const uint8_t idx = get_idx_by_ep_addr(dev_addr, ep_addr);
+  TU_VERIFY(idx < CFG_TUH_NCM);
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+
+  if (ep_addr == p_ncm->ep_in) {
+    recv_complete(idx, result, xferred_bytes);
+  } else if (ep_addr == p_ncm->ep_out) {
+    xmit_complete(idx, xferred_bytes);
+  } else if (ep_addr == p_ncm->ep_notif) {
+    const ncm_notify_t *notif = &_ncmh_epbuf[idx].notif;
+    if (result == XFER_RESULT_SUCCESS && xferred_bytes >= sizeof(tusb_control_request_t)) {
+      switch (notif->header.bRequest) {
+        case CDC_NOTIF_NETWORK_CONNECTION:
+          p_ncm->link_up = (notif->header.wValue != 0);
+          TU_LOG_DRV("  NCMh link %s\r\n", p_ncm->link_up ? "up" : "down");
+          tuh_network_link_state_cb(idx, p_ncm->link_up);
+          break;
+
+        case CDC_NOTIF_CONNECTION_SPEED_CHANGE:
+          TU_LOG_DRV("  NCMh speed down = %u up = %u\r\n", (unsigned) notif->downlink, (unsigned) notif->uplink);
+          break;
+
+        default: break;
+      }
+    }
+
+    if (p_ncm->mounted) {
+      usbh_edpt_xfer(dev_addr, p_ncm->ep_notif, (uint8_t *) &_ncmh_epbuf[idx].notif, sizeof(ncm_notify_t));
+    }
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Enumeration
+//--------------------------------------------------------------------+
+uint16_t ncmh_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_interface_t *desc_itf, uint16_t max_len) {
+  (void) rhport;
+  TU_VERIFY(TUSB_CLASS_CDC == desc_itf->bInterfaceClass &&
+              (CDC_COMM_SUBCLASS_NETWORK_CONTROL_MODEL == desc_itf->bInterfaceSubClass ||
+               CDC_COMM_SUBCLASS_ETHERNET_CONTROL_MODEL == desc_itf->bInterfaceSubClass),
+            0);
+
+  const uint8_t idx = find_new_index();
+  TU_VERIFY(idx < CFG_TUH_NCM, 0);
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+  tu_memclr(p_ncm, sizeof(ncmh_interface_t));
+
+  const uint8_t *desc_start = (const uint8_t *) desc_itf;
+  const uint8_t *desc_end   = desc_start + max_len;
+  const uint8_t *p_desc     = tu_desc_next(desc_start);
+
+  TU_LOG_DRV("NCMh opening Interface %u (addr = %u)\r\n", desc_itf->bInterfaceNumber, dev_addr);
+  p_ncm->subclass   = desc_itf->bInterfaceSubClass;
+  p_ncm->itf_num    = desc_itf->bInterfaceNumber;
+  p_ncm->itf_data   = (uint8_t) (desc_itf->bInterfaceNumber + 1);
+  p_ncm->iInterface = desc_itf->iInterface;
+
+  // Communication interface: functional descriptors and notification endpoint
+  while (tu_desc_in_bounds(p_desc, desc_end) && tu_desc_type(p_desc) != TUSB_DESC_INTERFACE) {
+    if (tu_desc_type(p_desc) == TUSB_DESC_CS_INTERFACE) {
+      switch (tu_desc_subtype(p_desc)) {
+        case CDC_FUNC_DESC_UNION:
+          TU_VERIFY(tu_desc_len(p_desc) >= 5, 0);
+          p_ncm->itf_data = p_desc[4];
+          break;
+
+        case CDC_FUNC_DESC_ETHERNET_NETWORKING:
+          TU_VERIFY(tu_desc_len(p_desc) >= 13, 0);
+          p_ncm->iMACAddress = p_desc[3];
+          break;
+
+        default: break;
+      }
+    } else if (tu_desc_type(p_desc) == TUSB_DESC_ENDPOINT) {
+      const tusb_desc_endpoint_t *desc_ep = (const tusb_desc_endpoint_t *) p_desc;
+      if (desc_ep->bmAttributes.xfer == TUSB_XFER_INTERRUPT && tu_edpt_dir(desc_ep->bEndpointAddress) == TUSB_DIR_IN) {
+        TU_ASSERT(tuh_edpt_open(dev_addr, desc_ep), 0);
+        p_ncm->ep_notif = desc_ep->bEndpointAddress;
+      }
+    }
+    p_desc = tu_desc_next(p_desc);
+  }
+
+  // Data interface: alternate setting 0 has no endpoints, the one with bulk endpoints is selected in set config
+  while (tu_desc_in_bounds(p_desc, desc_end) && tu_desc_type(p_desc) == TUSB_DESC_INTERFACE) {
+    const tusb_desc_interface_t *desc_data = (const tusb_desc_interface_t *) p_desc;
+    if (desc_data->bInterfaceNumber != p_ncm->itf_data || desc_data->bInterfaceClass != TUSB_CLASS_CDC_DATA) {
+      break;
+    }
+
+    p_desc = tu_desc_next(p_desc);
+    while (tu_desc_in_bounds(p_desc, desc_end) && tu_desc_type(p_desc) != TUSB_DESC_INTERFACE) {
+      const tusb_desc_endpoint_t *desc_ep = (const tusb_desc_endpoint_t *) p_desc;
+      if (tu_desc_type(p_desc) == TUSB_DESC_ENDPOINT && desc_ep->bmAttributes.xfer == TUSB_XFER_BULK) {
+        TU_ASSERT(tuh_edpt_open(dev_addr, desc_ep), 0);
+        p_ncm->itf_data_alt = desc_data->bAlternateSetting;
+        if (tu_edpt_dir(desc_ep->bEndpointAddress) == TUSB_DIR_IN) {
+          p_ncm->ep_in = desc_ep->bEndpointAddress;
+        } else {
+          p_ncm->ep_out      = desc_ep->bEndpointAddress;
+          p_ncm->ep_out_size = tu_edpt_packet_size(desc_ep);
+        }
+      }
+      p_desc = tu_desc_next(p_desc);
+    }
+  }
+
+  TU_VERIFY(p_ncm->ep_in != 0 && p_ncm->ep_out != 0 && p_ncm->ep_out_size != 0, 0);
+
+  p_ncm->daddr   = dev_addr;
+  p_ncm->in.xfer = TUSB_INDEX_INVALID_8;
+  return (uint16_t) (p_desc - desc_start);
+}
+
+static void set_config_complete(uint8_t idx, bool success) {
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+  const uint8_t daddr    = p_ncm->daddr;
+  const uint8_t itf_data = p_ncm->itf_data;
+
+  if (success) {
+    p_ncm->mounted = true;
+    tuh_network_mount_cb(idx);
+
+    recv_start(idx);
+    if (p_ncm->ep_notif != 0) {
+      usbh_edpt_xfer(daddr, p_ncm->ep_notif, (uint8_t *) &_ncmh_epbuf[idx].notif, sizeof(ncm_notify_t));
+    }
+  } else {
+    tu_memclr(p_ncm, sizeof(ncmh_interface_t));
+  }
+
+  // notify usbh that driver enumeration is complete, data interface is bound to this driver as well
+  usbh_driver_set_config_complete(daddr, itf_data);
+}
+
+static bool config_class_request(uint8_t idx, uint8_t direction, uint8_t bRequest, uint16_t wValue,
+                                 uint16_t wLength, uintptr_t next_state) {
+  const ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+  const tusb_control_request_t request = {
+    .bmRequestType_bit = {
+      .recipient = TUSB_REQ_RCPT_INTERFACE,
+      .type      = TUSB_REQ_TYPE_CLASS,
+      .direction = direction & 0x01u
+    },
+    .bRequest = bRequest,
+    .wValue   = wValue,
+    .wIndex   = p_ncm->itf_num,
+    .wLength  = wLength
+  };
+
+  tuh_xfer_t xfer = {
+    .daddr       = p_ncm->daddr,
+    .ep_addr     = 0,
+    .setup       = &request,
+    .buffer      = wLength ? usbh_get_enum_buf(p_ncm->daddr) : NULL,
+    .complete_cb = config_process_cb,
+    .user_data   = CONFIG_USER_DATA(idx, next_state)
+  };
+  return tuh_control_xfer(&xfer);
+}
+
+static bool config_process(uint8_t idx, tuh_xfer_t *xfer) {
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+  const uint8_t state = (uint8_t) (xfer->user_data & 0xff);
+  uint8_t *enum_buf = usbh_get_enum_buf(p_ncm->daddr);
+
+  switch (state) {
+    case CONFIG_GET_NTB_PARAMETERS:
+      TU_LOG_DRV("NCMh Get NTB Parameters\r\n");
+      TU_ASSERT(config_class_request(idx, TUSB_DIR_IN, NCM_GET_NTB_PARAMETERS, 0, sizeof(ntb_parameters_t),
+                                     CONFIG_SET_NTB_INPUT_SIZE));
+      break;
+
+    case CONFIG_SET_NTB_INPUT_SIZE: {
+      TU_ASSERT(xfer->result == XFER_RESULT_SUCCESS && xfer->actual_len >= sizeof(ntb_parameters_t));
+      ntb_parameters_t params;
+      memcpy(&params, enum_buf, sizeof(params));
+
+      p_ncm->out.max_size = (uint16_t) tu_min32(params.dwNtbOutMaxSize, CFG_TUH_NCM_OUT_NTB_MAX_SIZE);
+      p_ncm->out.max_datagrams = CFG_TUH_NCM_OUT_MAX_DATAGRAMS_PER_NTB;
+      if (params.wNtbOutMaxDatagrams != 0) {
+        p_ncm->out.max_datagrams = tu_min16(params.wNtbOutMaxDatagrams, CFG_TUH_NCM_OUT_MAX_DATAGRAMS_PER_NTB);
+      }
+      p_ncm->out.divisor   = params.wNdbOutDivisor ? params.wNdbOutDivisor : 1;
+      p_ncm->out.remainder = (uint16_t) (params.wNdbOutPayloadRemainder % p_ncm->out.divisor);
+      p_ncm->out.hdr_len   = OUT_NTB_HDR_LEN;
+      TU_ASSERT(p_ncm->out.max_size > OUT_NTB_HDR_LEN);
+      TU_LOG_DRV("  NTB out max size = %u, max datagrams = %u, in max size = %u\r\n", p_ncm->out.max_size,
+                 p_ncm->out.max_datagrams, (unsigned) params.dwNtbInMaxSize);
+
+      // limit NTBs sent by device to our buffer
+      if (params.dwNtbInMaxSize > CFG_TUH_NCM_IN_NTB_MAX_SIZE) {
+        TU_LOG_DRV("NCMh Set NTB Input Size\r\n");
+        tu_unaligned_write32(enum_buf, CFG_TUH_NCM_IN_NTB_MAX_SIZE);
+        TU_ASSERT(config_class_request(idx, TUSB_DIR_OUT, NCM_SET_NTB_INPUT_SIZE, 0, 4, CONFIG_GET_MAC_ADDRESS));
+        break;
+      }
+      TU_ATTR_FALLTHROUGH;
+    }
+
+    case CONFIG_GET_MAC_ADDRESS:
+      TU_ASSERT(xfer->result == XFER_RESULT_SUCCESS);
+      if (p_ncm->iMACAddress != 0) {
+        TU_LOG_DRV("NCMh Get MAC Address\r\n");
+        TU_ASSERT(tuh_descriptor_get_string(p_ncm->daddr, p_ncm->iMACAddress, 0x0409, enum_buf,
+                                            2 + 12 * 2, config_process_cb,
+                                            CONFIG_USER_DATA(idx, CONFIG_SET_PACKET_FILTER)));
+        break;
+      }
+      TU_ATTR_FALLTHROUGH;
+
+    case CONFIG_SET_PACKET_FILTER:
+      if (state == CONFIG_SET_PACKET_FILTER) {
+        if (xfer->result != XFER_RESULT_SUCCESS || !parse_mac_string(p_ncm->mac, enum_buf)) {
+          TU_LOG_DRV("  invalid MAC address string\r\n");
+        }
+      }
+      TU_LOG_DRV("NCMh Set Ethernet Packet Filter\r\n");
+      TU_ASSERT(config_class_request(idx, TUSB_DIR_OUT, NCM_SET_ETHERNET_PACKET_FILTER,
+                                     PACKET_TYPE_DIRECTED | PACKET_TYPE_BROADCAST | PACKET_TYPE_ALL_MULTICAST, 0,
+                                     CONFIG_SET_DATA_INTERFACE));
+      break;
+
+    case CONFIG_SET_DATA_INTERFACE:
+      // packet filter is optional for NCM, a STALL is not an error
+      TU_ASSERT(tuh_interface_set(p_ncm->daddr, p_ncm->itf_data, p_ncm->itf_data_alt, config_process_cb,
+                                  CONFIG_USER_DATA(idx, CONFIG_COMPLETE)));
+      break;
+
+    case CONFIG_COMPLETE:
+      TU_ASSERT(xfer->result == XFER_RESULT_SUCCESS);
+      p_ncm->out.len[0] = p_ncm->out.hdr_len;
+      p_ncm->out.len[1] = p_ncm->out.hdr_len;
+      set_config_complete(idx, true);
+      break;
+
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+static void config_process_cb(tuh_xfer_t *xfer) {
+  const uint8_t idx = (uint8_t) (xfer->user_data >> 8);
+  TU_VERIFY(idx < CFG_TUH_NCM && _ncmh_itf[idx].daddr == xfer->daddr,);
+
+  if (!config_process(idx, xfer)) {
+    set_config_complete(idx, false);
+  }
+}
+
+bool ncmh_set_config(uint8_t dev_addr, uint8_t itf_num) {
+  const uint8_t idx = tuh_network_itf_get_index(dev_addr, itf_num);
+  TU_ASSERT(idx < CFG_TUH_NCM);
+  ncmh_interface_t *p_ncm = &_ncmh_itf[idx];
+
+  // ECM sends each Ethernet frame as a transfer of its own
+  p_ncm->out.max_size      = CFG_TUH_NCM_OUT_NTB_MAX_SIZE;
+  p_ncm->out.max_datagrams = 1;
+  p_ncm->out.divisor       = 1;
+
+  // fake transfer to kick-off config_process()
+  tuh_xfer_t xfer;
+  tu_memclr(&xfer, sizeof(xfer));
+  xfer.daddr     = dev_addr;
+  xfer.result    = XFER_RESULT_SUCCESS;
+  xfer.user_data = CONFIG_USER_DATA(idx, is_ncm(p_ncm) ? CONFIG_GET_NTB_PARAMETERS : CONFIG_GET_MAC_ADDRESS);
+
+  if (!config_process(idx, &xfer)) {
+    set_config_complete(idx, false);
+  }
+
+  return true;
+}
+
+#endif
@@ -39,6 +39,12 @@ typedef enum {
   NCM_NETWORK_CAPS_NTB_INPUT_SIZE    = (1 << 5)
 } ncm_network_capabilities_t;
 
+// Segment of a datagram for tud_network_xmit_sg(), e.g. one pbuf of a chain
+typedef struct {
+  void const *buf;
+  uint16_t len;
+} tud_network_seg_t;
+
 #ifdef __cplusplus
  extern "C" {
 #endif
@@ -63,6 +69,18 @@ bool tud_network_can_xmit(uint16_t size);
 // if network_can_xmit() returns true, network_xmit() can be called once
 void tud_network_xmit(void *ref, uint16_t arg);
 
+// NCM only: transmit a datagram gathered from segments without tud_network_can_xmit()/tud_network_xmit_cb().
+// Segments must remain valid until tud_network_xmit_done_cb(ref), which may be invoked before this function returns.
+// Return false if no transmit buffer is available, ref is not released in this case.
+bool tud_network_xmit_sg(void *ref, tud_network_seg_t const *seg, uint8_t count);
+
+// NCM only: call from tud_network_recv_cb() to keep using the datagram after returning true. Its NTB is not reused
+// for reception until tud_network_recv_release() is called with the datagram pointer.
+void tud_network_recv_hold(void);
+
+// NCM only: release a datagram kept with tud_network_recv_hold()
+void tud_network_recv_release(const uint8_t *src);
+
 //--------------------------------------------------------------------+
 // Application Callbacks (WEAK is optional)
 //--------------------------------------------------------------------+
@@ -91,6 +109,9 @@ void tud_network_set_packet_filter_cb(uint16_t packet_filter);
 // Override to return the actual physical link state instead of the compile-time default.
 bool tud_network_default_link_state_cb(void);
 
+// Optional callback: datagram passed to tud_network_xmit_sg() is no longer used by driver
+void tud_network_xmit_done_cb(void *ref);
+
 // Set the network link state (up/down) and notify the host
 void tud_network_link_state(uint8_t rhport, bool is_up);
 
@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_NET_HOST_H_
+#define TUSB_NET_HOST_H_
+
+#include "class/cdc/cdc.h"
+#include "ncm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------------------------------------------+
+// Class Driver Configuration
+//--------------------------------------------------------------------+
+
+// CFG_TUH_NCM is the number of network interfaces, both CDC-NCM and CDC-ECM functions are supported
+
+// NTB buffer size for transmission (host -> device). Also the max Ethernet frame size for ECM.
+// Datagrams queued while the previous NTB is on the bus are aggregated into the next one.
+#ifndef CFG_TUH_NCM_OUT_NTB_MAX_SIZE
+  #define CFG_TUH_NCM_OUT_NTB_MAX_SIZE 2048
+#endif
+
+// NTB buffer size for reception (device -> host), CDC-NCM 1.0 Table 6-4 requires at least 2048.
+// Device is asked to limit its NTBs to this size with SET_NTB_INPUT_SIZE if it supports larger ones.
+#ifndef CFG_TUH_NCM_IN_NTB_MAX_SIZE
+  #define CFG_TUH_NCM_IN_NTB_MAX_SIZE 2048
+#endif
+
+// Number of NTB buffers for reception. One is on the bus while the others hold received datagrams
+// which are not yet renewed by the application.
+#ifndef CFG_TUH_NCM_IN_NTB_N
+  #define CFG_TUH_NCM_IN_NTB_N 2
+#endif
+
+// Max datagrams aggregated into one NTB for transmission, device's wNtbOutMaxDatagrams may limit it further
+#ifndef CFG_TUH_NCM_OUT_MAX_DATAGRAMS_PER_NTB
+  #define CFG_TUH_NCM_OUT_MAX_DATAGRAMS_PER_NTB 8
+#endif
+
+//--------------------------------------------------------------------+
+// Application API
+//--------------------------------------------------------------------+
+
+// Check if network interface is mounted
+bool tuh_network_mounted(uint8_t idx);
+
+// Get Interface index from device address + interface number
+// return TUSB_INDEX_INVALID_8 (0xFF) if not found
+uint8_t tuh_network_itf_get_index(uint8_t daddr, uint8_t itf_num);
+
+// Get Interface information
+// return true if index is correct and interface is currently mounted
+bool tuh_network_itf_get_info(uint8_t idx, tuh_itf_info_t *info);
+
+// Get the 48-bit MAC address reported by the device (iMACAddress string)
+bool tuh_network_get_mac_address(uint8_t idx, uint8_t mac[6]);
+
+// Get link state last reported by the device with NETWORK_CONNECTION notification
+bool tuh_network_link_is_up(uint8_t idx);
+
+// indicate to network driver that client has finished with the packet provided to tuh_network_recv_cb().
+// Datagram is passed in place from the receive NTB, which is reused only after all its datagrams are renewed.
+void tuh_network_recv_renew(uint8_t idx);
+
+// poll network driver for its ability to accept another packet to transmit
+bool tuh_network_can_xmit(uint8_t idx, uint16_t size);
+
+// if tuh_network_can_xmit() returns true, tuh_network_xmit() can be called once with a datagram up to that size.
+// It fails without a preceding successful tuh_network_can_xmit()
+bool tuh_network_xmit(uint8_t idx, void *ref, uint16_t arg);
+
+//--------------------------------------------------------------------+
+// Application Callbacks (WEAK is optional)
+//--------------------------------------------------------------------+
+
+// Invoked when a network interface is mounted, MAC address is available
+void tuh_network_mount_cb(uint8_t idx);
+
+// Invoked when a network interface is unmounted
+void tuh_network_umount_cb(uint8_t idx);
+
+// Invoked when device notifies a change of its link state
+void tuh_network_link_state_cb(uint8_t idx, bool is_up);
+
+// client must provide this: return false if the packet buffer was not accepted
+bool tuh_network_recv_cb(uint8_t idx, const uint8_t *src, uint16_t size);
+
+// client must provide this: copy from network stack packet pointer to dst
+uint16_t tuh_network_xmit_cb(uint8_t idx, uint8_t *dst, void *ref, uint16_t arg);
+
+//--------------------------------------------------------------------+
+// Internal Class Driver API
+//--------------------------------------------------------------------+
+bool     ncmh_init(void);
+bool     ncmh_deinit(void);
+uint16_t ncmh_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_interface_t *desc_itf, uint16_t max_len);
+bool     ncmh_set_config(uint8_t dev_addr, uint8_t itf_num);
+bool     ncmh_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+void     ncmh_close(uint8_t daddr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -476,6 +476,16 @@ typedef struct TU_ATTR_PACKED {
   };
 } tusb_video_payload_header_t;
 
+/* 2.4.3.3 header with PTS and SCR fields */
+typedef struct TU_ATTR_PACKED {
+  tusb_video_payload_header_t hdr;
+  uint32_t dwPresentationTime;
+  uint32_t dwSourceClockTime;  /* SCR: source time clock */
+  uint16_t wSofCounter;        /* SCR: 1 KHz SOF token counter (bit 10..0) */
+} tusb_video_payload_header_pts_scr_t;
+
+TU_VERIFY_STATIC( sizeof(tusb_video_payload_header_pts_scr_t) == 12, "size is not correct");
+
 /* 4.3.1.1 */
 typedef struct TU_ATTR_PACKED {
   union {
@@ -29,6 +29,29 @@
 #define VS_STATE_COMMITTED    1     /* Ready for streaming or Streaming via bulk endpoint */
 #define VS_STATE_STREAMING    2     /* Streaming via isochronous endpoint */
 
+#define VS_FRAME_N            CFG_TUD_VIDEO_STREAMING_FRAME_QUEUE
+TU_VERIFY_STATIC(VS_FRAME_N > 0 && VS_FRAME_N < 128, "frame queue size must be 1 to 127");
+
+/* Max transfers in flight per streaming interface. Only payload heads of zero-copy bulk transfers are staged in
+ * separate slots of the endpoint buffer, otherwise the whole endpoint buffer is used by one transfer. */
+#if CFG_TUD_VIDEO_STREAMING_ZEROCOPY
+  #define VS_XFER_N           CFG_TUD_EDPT_XFER_QUEUE
+#else
+  #define VS_XFER_N           1
+#endif
+
+#define VS_XFER_FLAG_STAGED   0x01u /* transfer uses a staging slot of the endpoint buffer */
+#define VS_XFER_FLAG_EOF      0x02u /* last transfer of a frame */
+
+#if CFG_TUD_VIDEO_STREAMING_TIMESTAMP
+  #define VS_PAYLOAD_HDR_LEN  sizeof(tusb_video_payload_header_pts_scr_t)
+#else
+  #define VS_PAYLOAD_HDR_LEN  sizeof(tusb_video_payload_header_t)
+#endif
+
+/* SOF is used to track bus time for timestamps and statistics */
+#define VS_SOF_ENABLED        (CFG_TUD_VIDEO_STREAMING_TIMESTAMP || CFG_TUD_VIDEO_STREAMING_STATS)
+
 typedef struct {
   tusb_desc_interface_t            std;
   tusb_desc_video_control_header_t ctl;
@@ -96,14 +119,35 @@ typedef struct TU_ATTR_PACKED {
     uint16_t cur;    /* Offset of the current settings */
     uint16_t ep[2];  /* Offset of endpoint descriptors. 0: streaming, 1: still capture */
   } desc;
-  uint8_t *buffer;   /* frame buffer. assume linear buffer. no support for stride access */
-  uint32_t bufsize;  /* frame buffer size */
-  uint32_t offset;   /* offset for the next payload transfer */
+  struct {
+    uint8_t *buffer;  /* frame buffer. assume linear buffer. no support for stride access */
+    uint32_t bufsize; /* frame buffer size */
+#if CFG_TUD_VIDEO_STREAMING_TIMESTAMP
+    uint32_t pts;     /* presentation time stamp */
+#endif
+#if CFG_TUD_VIDEO_STREAMING_STATS
+    uint32_t queued_ms; /* bus time when the frame is queued */
+#endif
+  } frame[VS_FRAME_N];
+  volatile uint8_t frame_wr; /* next frame to be queued by application, index wraps at 2 * VS_FRAME_N */
+  volatile uint8_t frame_rd; /* frame whose transfer is to be completed next */
+  uint8_t  frame_tx; /* frame whose payloads are being submitted */
+  uint32_t offset;   /* offset in frame_tx for the next payload transfer */
+  uint32_t body_len; /* payload data left for in place transfer from the frame buffer */
+  uint8_t  xfer_count; /* transfers in flight */
+  uint8_t  xfer_rd;    /* index of oldest transfer in flight */
+  uint8_t  xfer_flags[VS_XFER_N]; /* VS_XFER_FLAG_* of transfers in flight */
+  uint8_t  stage_wr;    /* next staging slot for a payload head */
+  uint8_t  stage_count; /* staging slots in flight */
+  tusb_video_payload_header_t payload_hdr; /* header template for the next payload */
   uint32_t max_payload_transfer_size;
   uint8_t  error_code;/* error code */
   uint8_t  state;    /* 0:probing 1:committed 2:streaming */
 
   video_probe_and_commit_control_t probe_commit_payload; /* Probe and Commit control */
+#if CFG_TUD_VIDEO_STREAMING_STATS
+  tud_video_stream_stats_t stats;
+#endif
 } videod_streaming_interface_t;
 
 typedef struct {
@@ -128,6 +172,15 @@ static videod_interface_t _videod_itf[CFG_TUD_VIDEO];
 static videod_streaming_interface_t _videod_streaming_itf[CFG_TUD_VIDEO_STREAMING];
 CFG_TUD_MEM_SECTION static videod_streaming_epbuf_t _videod_streaming_epbuf[CFG_TUD_VIDEO_STREAMING];
 
+#if VS_SOF_ENABLED
+/* Bus time counted from SOF while any stream is committed */
+static struct {
+  bool en;
+  usbd_sof_tick_t tick; /* tick.last_frame is 11-bit frame number of the last SOF */
+  volatile uint32_t ms; /* milliseconds elapsed */
+} _videod_sof;
+#endif
+
 static uint8_t const _cap_get     = 0x1u; /* support for GET */
 static uint8_t const _cap_get_set = 0x3u; /* support for GET and SET */
 
@@ -208,6 +261,20 @@ TU_ATTR_WEAK void tud_video_prepare_payload_cb(uint_fast8_t ctl_idx, uint_fast8_
   (void) request;
 }
 
+TU_ATTR_WEAK uint32_t tud_video_source_clock_cb(uint_fast8_t ctl_idx) {
+#if VS_SOF_ENABLED
+  videod_interface_t const *self = &_videod_itf[ctl_idx];
+  if (NULL == self->beg) {
+    return 0;
+  }
+  tusb_desc_vc_itf_t const *vc = (tusb_desc_vc_itf_t const *)(self->beg + self->cur);
+  return _videod_sof.ms * (vc->ctl.dwClockFrequency / 1000);
+#else
+  (void) ctl_idx;
+  return 0;
+#endif
+}
+
 //--------------------------------------------------------------------+
 //
 //--------------------------------------------------------------------+
@@ -260,6 +327,88 @@ static tusb_desc_vs_itf_t const* _get_desc_vs(videod_streaming_interface_t const
   return (tusb_desc_vs_itf_t const*)(desc + self->desc.cur);
 }
 
+/** Get the streaming endpoint descriptor of the current settings
+ *
+ * @return NULL if no endpoint is open */
+static tusb_desc_endpoint_t const* _get_desc_ep(videod_streaming_interface_t const *self) {
+  uint_fast16_t ofs_ep = self->desc.ep[0];
+  if (!ofs_ep) {
+    return NULL;
+  }
+  uint8_t const *desc = _videod_itf[self->index_vc].beg;
+  return (tusb_desc_endpoint_t const*)(desc + ofs_ep);
+}
+
+static inline bool _is_bulk(videod_streaming_interface_t const *self) {
+  tusb_desc_endpoint_t const *ep = _get_desc_ep(self);
+  return ep && (TUSB_XFER_BULK == ep->bmAttributes.xfer);
+}
+
+/** Get the max payload size which can be transferred
+ *
+ * Payloads are assembled in the endpoint buffer, except for zero-copy bulk transfers where only
+ * the head of a payload is staged. */
+static uint_fast32_t _max_payload_size(videod_streaming_interface_t const *self) {
+#if CFG_TUD_VIDEO_STREAMING_ZEROCOPY
+  if (_is_bulk(self)) {
+    return UINT32_MAX;
+  }
+#else
+  (void) self;
+#endif
+  return CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE;
+}
+
+static inline uint8_t _frame_next(uint8_t idx) {
+  return (uint8_t) ((idx + 1) % (2 * VS_FRAME_N));
+}
+
+static inline uint8_t _frame_count(uint8_t wr, uint8_t rd) {
+  return (uint8_t) ((wr + 2 * VS_FRAME_N - rd) % (2 * VS_FRAME_N));
+}
+
+/** Drop queued frames and clear transfer management information */
+static void _clear_frames(videod_streaming_interface_t *self) {
+#if CFG_TUD_VIDEO_STREAMING_STATS
+  self->stats.drop_count += _frame_count(self->frame_wr, self->frame_rd);
+#endif
+  self->frame_wr    = 0;
+  self->frame_rd    = 0;
+  self->frame_tx    = 0;
+  self->offset      = 0;
+  self->body_len    = 0;
+  self->xfer_count  = 0;
+  self->xfer_rd     = 0;
+  self->stage_wr    = 0;
+  self->stage_count = 0;
+}
+
+/** Enable SOF while any stream is committed, it is only needed for timestamps and statistics */
+static void _sof_update(uint8_t rhport) {
+#if VS_SOF_ENABLED
+  bool en = false;
+  for (uint_fast8_t i = 0; i < CFG_TUD_VIDEO_STREAMING; ++i) {
+    videod_streaming_interface_t const *stm = &_videod_streaming_itf[i];
+    en = en || (stm->desc.ep[0] && VS_STATE_PROBING != stm->state);
+  }
+  if (en != _videod_sof.en) {
+    _videod_sof.en     = en;
+    _videod_sof.tick.synced = false;
+    usbd_sof_enable(rhport, SOF_CONSUMER_VIDEO, en);
+  }
+#else
+  (void) rhport;
+#endif
+}
+
+static inline uint32_t _bus_time_ms(void) {
+#if VS_SOF_ENABLED
+  return _videod_sof.ms;
+#else
+  return 0;
+#endif
+}
+
 /** Find the first descriptor of a given type
  *
  * @param[in] beg        The head of descriptor byte array.
@@ -541,9 +690,9 @@ static bool _update_streaming_parameters(videod_streaming_interface_t const *stm
   }
   uint_fast32_t interval_ms = interval / 10000;
   TU_ASSERT(interval_ms != 0);
-  uint_fast32_t payload_size = (frame_size + interval_ms - 1) / interval_ms + 2;
-  if (CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE < payload_size) {
-    payload_size = CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE;
+  uint_fast32_t payload_size = (frame_size + interval_ms - 1) / interval_ms + VS_PAYLOAD_HDR_LEN;
+  if (_max_payload_size(stm) < payload_size) {
+    payload_size = _max_payload_size(stm);
   }
   param->dwMaxPayloadTransferSize = payload_size;
   return true;
@@ -700,12 +849,12 @@ static bool _negotiate_streaming_parameters(videod_streaming_interface_t const *
       uint_fast32_t frame_size = param->dwMaxVideoFrameSize;
       uint_fast32_t payload_size;
       if (0 == interval_ms) {
-        payload_size = frame_size + 2;
+        payload_size = frame_size + VS_PAYLOAD_HDR_LEN;
       } else {
-        payload_size = (frame_size + interval_ms - 1) / interval_ms + 2;
+        payload_size = (frame_size + interval_ms - 1) / interval_ms + VS_PAYLOAD_HDR_LEN;
       }
-      if (CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE < payload_size) {
-        payload_size = CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE;
+      if (_max_payload_size(stm) < payload_size) {
+        payload_size = _max_payload_size(stm);
       }
       param->dwMaxPayloadTransferSize = payload_size;
     }
@@ -820,9 +969,7 @@ static bool _open_vs_itf(uint8_t rhport, videod_streaming_interface_t *stm, uint
 #endif
 
   /* clear transfer management information */
-  stm->buffer  = NULL;
-  stm->bufsize = 0;
-  stm->offset  = 0;
+  _clear_frames(stm);
 
   /* Find a alternate interface */
   uint8_t const *beg = desc + stm->desc.beg;
@@ -860,37 +1007,131 @@ static bool _open_vs_itf(uint8_t rhport, videod_streaming_interface_t *stm, uint
   if (altnum != 0) {
     stm->state = VS_STATE_STREAMING;
   }
+  _sof_update(rhport);
   TU_LOG_DRV("    done\r\n");
   return true;
 }
 
-/** Prepare the next packet payload. */
-static uint_fast16_t _prepare_in_payload(videod_streaming_interface_t *stm, uint8_t* ep_buf) {
-  uint_fast16_t remaining = stm->bufsize - stm->offset;
-  uint_fast16_t hdr_len   = ep_buf[0];
-  uint_fast16_t pkt_len   = stm->max_payload_transfer_size;
-  if (hdr_len + remaining < pkt_len) {
-    pkt_len = hdr_len + remaining;
-  }
-  TU_ASSERT(pkt_len >= hdr_len);
-  uint_fast16_t data_len = pkt_len - hdr_len;
-  if (stm->buffer) {
-    memcpy(&ep_buf[hdr_len], stm->buffer + stm->offset, data_len);
+/** Prepare the next payload of the frame being submitted.
+ *
+ * Payload header and data are written to buf up to bufsize, payload data which does not fit is left
+ * in body_len for in place transfer from the frame buffer.
+ *
+ * @return number of bytes written to buf */
+static uint32_t _prepare_in_payload(videod_streaming_interface_t *stm, uint8_t* buf, uint32_t bufsize) {
+  uint8_t const *frame_buf = stm->frame[stm->frame_tx % VS_FRAME_N].buffer;
+  uint32_t remaining  = stm->frame[stm->frame_tx % VS_FRAME_N].bufsize - stm->offset;
+  uint_fast8_t  hdr_len    = stm->payload_hdr.bHeaderLength;
+  TU_ASSERT(stm->max_payload_transfer_size > hdr_len && bufsize > hdr_len, 0);
+
+  uint32_t data_len = tu_min32(stm->max_payload_transfer_size - hdr_len, remaining);
+  uint32_t copy_len = tu_min32(data_len, bufsize - hdr_len);
+
+#if CFG_TUD_VIDEO_STREAMING_TIMESTAMP
+  tusb_video_payload_header_pts_scr_t hdr = {
+    .hdr                = stm->payload_hdr,
+    .dwPresentationTime = stm->frame[stm->frame_tx % VS_FRAME_N].pts,
+    .dwSourceClockTime  = tud_video_source_clock_cb(stm->index_vc),
+    .wSofCounter        = _videod_sof.tick.last_frame
+  };
+  hdr.hdr.EndOfFrame = (data_len == remaining) ? 1 : 0;
+#else
+  tusb_video_payload_header_t hdr = stm->payload_hdr;
+  hdr.EndOfFrame = (data_len == remaining) ? 1 : 0;
+#endif
+  memcpy(buf, &hdr, sizeof(hdr));
+
+  if (frame_buf) {
+    memcpy(&buf[hdr_len], frame_buf + stm->offset, copy_len);
   } else {
     tud_video_payload_request_t rqst = {
-      .buf = &ep_buf[hdr_len],
-      .length = data_len,
+      .buf = &buf[hdr_len],
+      .length = copy_len,
       .offset = stm->offset
     };
     tud_video_prepare_payload_cb(stm->index_vc, stm->index_vs, &rqst);
   }
-  stm->offset += data_len;
-  remaining -= data_len;
-  if (!remaining) {
-    tusb_video_payload_header_t *hdr = (tusb_video_payload_header_t*) ep_buf;
-    hdr->EndOfFrame = 1;
+  stm->offset  += copy_len;
+  stm->body_len = data_len - copy_len;
+  return hdr_len + copy_len;
+}
+
+/** Submit transfers for queued frames as long as transfer slots and endpoint buffer are available.
+ *
+ * Bulk payloads are packed back-to-back into one transfer, all but the last one of a frame having the
+ * negotiated payload size so that the host can split them. With zero-copy, each payload is sent as its
+ * head staged in an endpoint buffer slot followed by the rest of its data in place from the frame buffer.
+ *
+ * @param[in] max_xfer   Max number of transfers to submit
+ * @return number of submitted transfers */
+static uint_fast8_t _submit_payloads(uint8_t rhport, videod_streaming_interface_t *stm, uint_fast8_t max_xfer) {
+  tusb_desc_endpoint_t const *ep = _get_desc_ep(stm);
+  TU_VERIFY(ep, 0);
+  uint8_t *ep_buf  = _videod_streaming_epbuf[stm - _videod_streaming_itf].buf;
+  bool const bulk  = (TUSB_XFER_BULK == ep->bmAttributes.xfer);
+  uint_fast8_t num = 0;
+
+  while (num < max_xfer && stm->xfer_count < VS_XFER_N && stm->frame_tx != stm->frame_wr) {
+    uint8_t *buf;
+    uint32_t len;
+    uint8_t flags = 0;
+
+    if (0 == stm->offset && 0 == stm->body_len) {
+      stm->payload_hdr.FrameID ^= 1; /* start of a new frame */
+    }
+
+#if CFG_TUD_VIDEO_STREAMING_ZEROCOPY
+    uint8_t *frame_buf = stm->frame[stm->frame_tx % VS_FRAME_N].buffer;
+    uint32_t const mps = tu_edpt_packet_size(ep);
+    if (stm->body_len) {
+      /* rest of the payload in place */
+      buf = frame_buf + stm->offset;
+      len = stm->body_len;
+      stm->offset  += len;
+      stm->body_len = 0;
+    } else if (bulk && frame_buf && mps <= CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE) {
+      /* payload head up to the first packet boundary */
+      uint_fast8_t const num_slots = (uint_fast8_t) tu_min32(CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE / mps, VS_XFER_N);
+      if (stm->stage_count >= num_slots) {
+        break;
+      }
+      buf = ep_buf + stm->stage_wr * mps;
+      len = _prepare_in_payload(stm, buf, mps);
+      stm->stage_wr = (uint8_t) ((stm->stage_wr + 1) % num_slots);
+      flags = VS_XFER_FLAG_STAGED;
+    } else
+#endif
+    {
+      if (stm->xfer_count) {
+        break; /* endpoint buffer is in use */
+      }
+      buf = ep_buf;
+      len = _prepare_in_payload(stm, buf, CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE);
+      uint32_t frame_size = stm->frame[stm->frame_tx % VS_FRAME_N].bufsize;
+      /* payloads can only be packed if each of them ends at a packet boundary */
+      bool const packable = bulk && (0 == stm->max_payload_transfer_size % tu_edpt_packet_size(ep));
+      while (packable && stm->offset < frame_size && CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE - len >= stm->max_payload_transfer_size) {
+        len += _prepare_in_payload(stm, buf + len, CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE - len);
+      }
+    }
+    TU_VERIFY(len, num);
+
+    if (stm->offset == stm->frame[stm->frame_tx % VS_FRAME_N].bufsize && 0 == stm->body_len) {
+      flags |= VS_XFER_FLAG_EOF;
+      stm->frame_tx = _frame_next(stm->frame_tx);
+      stm->offset   = 0;
+    }
+
+    /* Transfer is recorded first since it may complete any time */
+    stm->xfer_flags[(stm->xfer_rd + stm->xfer_count) % VS_XFER_N] = flags;
+    stm->xfer_count++;
+    if (flags & VS_XFER_FLAG_STAGED) {
+      stm->stage_count++;
+    }
+    TU_ASSERT(usbd_edpt_xfer(rhport, ep->bEndpointAddress, buf, len, false), num);
+    num++;
   }
-  return hdr_len + data_len;
+  return num;
 }
 
 /** Handle a standard request to the video control interface. */
@@ -1053,7 +1294,6 @@ static int handle_video_stm_cs_req(uint8_t rhport, uint8_t stage,
                                    uint_fast8_t stm_idx) {
   (void)rhport;
   videod_streaming_interface_t *stm = &_videod_streaming_itf[stm_idx];
-  videod_streaming_epbuf_t *stm_epbuf = &_videod_streaming_epbuf[stm_idx];
 
   uint8_t const ctrl_sel = TU_U16_HIGH(request->wValue);
   TU_LOG_DRV("%s_Control(%s)\r\n", tu_str_video_vs_control_selector[ctrl_sel], tu_lookup_find(&tu_table_video_request, request->bRequest));
@@ -1082,6 +1322,7 @@ static int handle_video_stm_cs_req(uint8_t rhport, uint8_t stage,
     case VIDEO_VS_CTL_PROBE:
       if (stm->state != VS_STATE_PROBING) {
         stm->state = VS_STATE_PROBING;
+        _sof_update(rhport);
       }
 
       switch (request->bRequest) {
@@ -1144,20 +1385,22 @@ static int handle_video_stm_cs_req(uint8_t rhport, uint8_t stage,
             video_probe_and_commit_control_t *param = &stm->probe_commit_payload;
             TU_VERIFY(_update_streaming_parameters(stm, param), VIDEO_ERROR_INVALID_VALUE_WITHIN_RANGE);
             /* Set the negotiated value */
-            if (CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE < param->dwMaxPayloadTransferSize) {
-              param->dwMaxPayloadTransferSize = CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE;
+            if (_max_payload_size(stm) < param->dwMaxPayloadTransferSize) {
+              param->dwMaxPayloadTransferSize = (uint32_t) _max_payload_size(stm);
             }
             stm->max_payload_transfer_size = param->dwMaxPayloadTransferSize;
             int ret = tud_video_commit_cb(stm->index_vc, stm->index_vs, param);
             if (VIDEO_ERROR_NONE == ret) {
-              stm->state   = VS_STATE_COMMITTED;
-              stm->buffer  = NULL;
-              stm->bufsize = 0;
-              stm->offset  = 0;
+              stm->state = VS_STATE_COMMITTED;
+              _clear_frames(stm);
               /* initialize payload header */
-              tusb_video_payload_header_t *hdr = (tusb_video_payload_header_t*)stm_epbuf->buf;
-              hdr->bHeaderLength = sizeof(*hdr);
-              hdr->bmHeaderInfo  = 0;
+              stm->payload_hdr.bHeaderLength = VS_PAYLOAD_HDR_LEN;
+              stm->payload_hdr.bmHeaderInfo  = 0;
+#if CFG_TUD_VIDEO_STREAMING_TIMESTAMP
+              stm->payload_hdr.PresentationTime     = 1;
+              stm->payload_hdr.SourceClockReference = 1;
+#endif
+              _sof_update(rhport);
             }
           } else {
             // nothing to do
@@ -1272,41 +1515,75 @@ bool tud_video_n_frame_xfer(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, void *bu
   }
 
   videod_streaming_interface_t *stm = _get_instance_streaming(ctl_idx, stm_idx);
-  videod_streaming_epbuf_t *stm_epbuf = &_videod_streaming_epbuf[ctl_idx];
-
-  if (NULL == stm || 0 == stm->desc.ep[0] || stm->bufsize) {
+  if (NULL == stm || 0 == stm->desc.ep[0]) {
     return false;
   }
   if (stm->state == VS_STATE_PROBING) {
     return false;
   }
+  if (_frame_count(stm->frame_wr, stm->frame_rd) >= VS_FRAME_N) {
+#if CFG_TUD_VIDEO_STREAMING_STATS
+    stm->stats.drop_count++;
+#endif
+    return false;
+  }
+#if CFG_TUD_VIDEO_STREAMING_ZEROCOPY
+  if (NULL == buffer && _is_bulk(stm)) {
+    return false; /* payload may exceed endpoint buffer */
+  }
+#endif
 
-  /* Find EP address */
-  uint8_t const *desc = _videod_itf[stm->index_vc].beg;
-  uint8_t ep_addr = 0;
-  for (uint_fast8_t i = 0; i < CFG_TUD_VIDEO_STREAMING; ++i) {
-    uint_fast16_t ofs_ep = stm->desc.ep[i];
-    if (0 == ofs_ep) {
-      continue;
+  stm->frame[stm->frame_wr % VS_FRAME_N].buffer  = (uint8_t*)buffer;
+  stm->frame[stm->frame_wr % VS_FRAME_N].bufsize = (uint32_t) bufsize;
+#if CFG_TUD_VIDEO_STREAMING_TIMESTAMP
+  stm->frame[stm->frame_wr % VS_FRAME_N].pts = tud_video_source_clock_cb(ctl_idx);
+#endif
+#if CFG_TUD_VIDEO_STREAMING_STATS
+  stm->frame[stm->frame_wr % VS_FRAME_N].queued_ms = _bus_time_ms();
+#endif
+  stm->frame_wr = _frame_next(stm->frame_wr);
+
+  /* Start transfer if endpoint is idle, otherwise frame is sent once the previous ones are done */
+  uint8_t const ep_addr = _get_desc_ep(stm)->bEndpointAddress;
+  if (usbd_edpt_claim(0, ep_addr)) {
+    if (0 == _submit_payloads(0, stm, VS_XFER_N)) {
+      usbd_edpt_release(0, ep_addr);
     }
-    ep_addr = _desc_ep_addr(desc + ofs_ep);
-    break;
-  }
-  if (0 == ep_addr) {
-    return false;
   }
+  return true;
+}
+
+uint8_t tud_video_n_frame_queue_count(uint_fast8_t ctl_idx, uint_fast8_t stm_idx) {
+  TU_ASSERT(ctl_idx < CFG_TUD_VIDEO, 0);
+  TU_ASSERT(stm_idx < CFG_TUD_VIDEO_STREAMING, 0);
+  videod_streaming_interface_t const *stm = _get_instance_streaming(ctl_idx, stm_idx);
+  TU_VERIFY(stm, 0);
+  return _frame_count(stm->frame_wr, stm->frame_rd);
+}
 
-  TU_VERIFY(usbd_edpt_claim(0, ep_addr));
-  /* update the packet header */
-  tusb_video_payload_header_t *hdr = (tusb_video_payload_header_t*)stm_epbuf->buf;
-  hdr->FrameID   ^= 1;
-  hdr->EndOfFrame = 0;
-  /* update the packet data */
-  stm->buffer     = (uint8_t*)buffer;
-  stm->bufsize    = bufsize;
-  uint_fast16_t pkt_len = _prepare_in_payload(stm, stm_epbuf->buf);
-  TU_ASSERT( usbd_edpt_xfer(0, ep_addr, stm_epbuf->buf, (uint16_t) pkt_len, false), 0);
+bool tud_video_n_stream_stats(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, tud_video_stream_stats_t *stats) {
+  TU_ASSERT(ctl_idx < CFG_TUD_VIDEO);
+  TU_ASSERT(stm_idx < CFG_TUD_VIDEO_STREAMING);
+#if CFG_TUD_VIDEO_STREAMING_STATS
+  videod_streaming_interface_t const *stm = _get_instance_streaming(ctl_idx, stm_idx);
+  TU_VERIFY(stm && stats);
+  *stats = stm->stats;
   return true;
+#else
+  (void) stats;
+  return false;
+#endif
+}
+
+void tud_video_n_stream_stats_clear(uint_fast8_t ctl_idx, uint_fast8_t stm_idx) {
+  TU_ASSERT(ctl_idx < CFG_TUD_VIDEO, );
+  TU_ASSERT(stm_idx < CFG_TUD_VIDEO_STREAMING, );
+#if CFG_TUD_VIDEO_STREAMING_STATS
+  videod_streaming_interface_t *stm = _get_instance_streaming(ctl_idx, stm_idx);
+  if (stm) {
+    tu_memclr(&stm->stats, sizeof(stm->stats));
+  }
+#endif
 }
 
 //--------------------------------------------------------------------+
@@ -1329,6 +1606,10 @@ bool videod_deinit(void) {
 
 void videod_reset(uint8_t rhport) {
   (void) rhport;
+#if VS_SOF_ENABLED
+  // SOF consumers are cleared by usbd
+  _videod_sof.en = false;
+#endif
   for (uint_fast8_t i = 0; i < CFG_TUD_VIDEO; ++i) {
     videod_interface_t* ctl = &_videod_itf[i];
     tu_memclr(ctl, sizeof(*ctl));
@@ -1492,20 +1773,54 @@ bool videod_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint3
     }
   }
   TU_ASSERT(itf < CFG_TUD_VIDEO_STREAMING);
-  videod_streaming_epbuf_t *stm_epbuf = &_videod_streaming_epbuf[itf];
 
-  if (stm->offset < stm->bufsize) {
-    /* Claim the endpoint */
-    TU_VERIFY(usbd_edpt_claim(rhport, ep_addr), 0);
-    uint_fast16_t pkt_len = _prepare_in_payload(stm, stm_epbuf->buf);
-    TU_ASSERT(usbd_edpt_xfer(rhport, ep_addr, stm_epbuf->buf, (uint16_t) pkt_len, false), 0);
-  } else {
-    stm->buffer  = NULL;
-    stm->bufsize = 0;
-    stm->offset  = 0;
-    tud_video_frame_xfer_complete_cb(stm->index_vc, stm->index_vs);
+  if (stm->xfer_count) {
+    uint8_t const flags = stm->xfer_flags[stm->xfer_rd];
+    stm->xfer_rd = (uint8_t) ((stm->xfer_rd + 1) % VS_XFER_N);
+    stm->xfer_count--;
+    if (flags & VS_XFER_FLAG_STAGED) {
+      stm->stage_count--;
+    }
+    if (flags & VS_XFER_FLAG_EOF) {
+#if CFG_TUD_VIDEO_STREAMING_STATS
+      uint32_t const latency_ms = _bus_time_ms() - stm->frame[stm->frame_rd % VS_FRAME_N].queued_ms;
+      stm->stats.frame_count++;
+      stm->stats.latency_ms_last   = latency_ms;
+      stm->stats.latency_ms_max    = tu_max32(stm->stats.latency_ms_max, latency_ms);
+      stm->stats.latency_ms_total += latency_ms;
+#endif
+      stm->frame_rd = _frame_next(stm->frame_rd);
+      tud_video_frame_xfer_complete_cb(stm->index_vc, stm->index_vs);
+    }
+  }
+
+  /* Endpoint stays busy while transfers are in flight, otherwise it has to be claimed again */
+  if (stm->xfer_count) {
+    _submit_payloads(rhport, stm, VS_XFER_N);
+  } else if (stm->frame_tx != stm->frame_wr && usbd_edpt_claim(rhport, ep_addr)) {
+    if (0 == _submit_payloads(rhport, stm, VS_XFER_N)) {
+      usbd_edpt_release(rhport, ep_addr);
+    }
   }
+#if CFG_TUD_VIDEO_STREAMING_STATS
+  if (0 == stm->xfer_count) {
+    stm->stats.underrun_count++; /* bus is idle until the next frame is queued */
+  }
+#endif
   return true;
 }
 
+void videod_sof_isr(uint8_t rhport, uint32_t frame_count) {
+  (void) rhport;
+#if VS_SOF_ENABLED
+  if (!_videod_sof.en) {
+    return;
+  }
+
+  _videod_sof.ms += usbd_sof_elapsed_ms(&_videod_sof.tick, frame_count);
+#else
+  (void) frame_count;
+#endif
+}
+
 #endif
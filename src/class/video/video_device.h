@@ -16,6 +16,38 @@
 extern "C" {
 #endif
 
+//--------------------------------------------------------------------+
+// Class Driver Configuration
+//--------------------------------------------------------------------+
+
+// Number of frames that can be queued with tud_video_n_frame_xfer() per streaming interface.
+// A queued frame is started as soon as the previous one is sent, without waiting for the application.
+#ifndef CFG_TUD_VIDEO_STREAMING_FRAME_QUEUE
+  #define CFG_TUD_VIDEO_STREAMING_FRAME_QUEUE 1
+#endif
+
+// Bulk endpoint: send payload data in place from the frame buffer instead of copying it into the endpoint buffer.
+// Only the payload header and the data head up to the first packet boundary are copied, the rest of the payload is
+// transferred from the frame buffer directly. Payload size is then no longer limited by
+// CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE, which has to hold at least one max packet. With CFG_TUD_EDPT_XFER_QUEUE > 1
+// several payloads are in flight at once. Frame buffer must be accessible by the USB controller (DMA region,
+// alignment, cache) until tud_video_frame_xfer_complete_cb() is invoked. Bufferless frames are not supported.
+#ifndef CFG_TUD_VIDEO_STREAMING_ZEROCOPY
+  #define CFG_TUD_VIDEO_STREAMING_ZEROCOPY 0
+#endif
+
+// Add Presentation Time Stamp (PTS) and Source Clock Reference (SCR) to payload headers (UVC 1.5 2.4.3.3).
+// PTS is the source clock when the frame is queued, SCR is the source clock and the SOF counter when the payload is
+// prepared. Source clock is read with tud_video_source_clock_cb(). SOF interrupt is enabled while streaming.
+#ifndef CFG_TUD_VIDEO_STREAMING_TIMESTAMP
+  #define CFG_TUD_VIDEO_STREAMING_TIMESTAMP 0
+#endif
+
+// Collect per-stream timing statistics, see tud_video_n_stream_stats(). SOF interrupt is enabled while streaming.
+#ifndef CFG_TUD_VIDEO_STREAMING_STATS
+  #define CFG_TUD_VIDEO_STREAMING_STATS 0
+#endif
+
 
 //--------------------------------------------------------------------+
 // Payload request
@@ -26,6 +58,18 @@ typedef struct TU_ATTR_PACKED {
     size_t offset;  /* Offset within the frame (in bytes) */
 } tud_video_payload_request_t;
 
+//--------------------------------------------------------------------+
+// Stream statistics
+//--------------------------------------------------------------------+
+typedef struct {
+  uint32_t frame_count;      /* Frames completely transferred */
+  uint32_t drop_count;       /* Frames not accepted since frame queue was full, or discarded when streaming stopped */
+  uint32_t underrun_count;   /* Times the endpoint ran out of payloads while streaming */
+  uint32_t latency_ms_last;  /* Latency of the last frame from being queued until completely transferred */
+  uint32_t latency_ms_max;   /* Max latency of a frame */
+  uint32_t latency_ms_total; /* Sum of latencies, average is latency_ms_total / frame_count */
+} tud_video_stream_stats_t;
+
 //--------------------------------------------------------------------+
 // Application API (Multiple Ports)
 // CFG_TUD_VIDEO > 1
@@ -39,14 +83,34 @@ bool tud_video_n_connected(uint_fast8_t ctl_idx);
  * @param[in] stm_idx    Destination streaming interface index */
 bool tud_video_n_streaming(uint_fast8_t ctl_idx, uint_fast8_t stm_idx);
 
-/** Transfer a frame
+/** Transfer a frame. Up to CFG_TUD_VIDEO_STREAMING_FRAME_QUEUE frames can be queued, they are sent in order.
  *
  * @param[in] ctl_idx    Destination control interface index
  * @param[in] stm_idx    Destination streaming interface index
  * @param[in] buffer     Frame buffer. The caller must not use this buffer until the operation is completed.
- * @param[in] bufsize    Byte size of the frame buffer */
+ * @param[in] bufsize    Byte size of the frame buffer
+ * @return false if not streaming or frame queue is full */
 bool tud_video_n_frame_xfer(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, void *buffer, size_t bufsize);
 
+/** Return number of frames queued with tud_video_n_frame_xfer() and not yet completed
+ *
+ * @param[in] ctl_idx    Destination control interface index
+ * @param[in] stm_idx    Destination streaming interface index */
+uint8_t tud_video_n_frame_queue_count(uint_fast8_t ctl_idx, uint_fast8_t stm_idx);
+
+/** Get timing statistics of a stream, requires CFG_TUD_VIDEO_STREAMING_STATS
+ *
+ * @param[in]  ctl_idx    Destination control interface index
+ * @param[in]  stm_idx    Destination streaming interface index
+ * @param[out] stats      Statistics since the last bus reset or tud_video_n_stream_stats_clear() */
+bool tud_video_n_stream_stats(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, tud_video_stream_stats_t *stats);
+
+/** Clear timing statistics of a stream
+ *
+ * @param[in] ctl_idx    Destination control interface index
+ * @param[in] stm_idx    Destination streaming interface index */
+void tud_video_n_stream_stats_clear(uint_fast8_t ctl_idx, uint_fast8_t stm_idx);
+
 /*------------- Optional callbacks -------------*/
 /** Invoked when compeletion of a frame transfer
  *
@@ -83,6 +147,14 @@ int tud_video_commit_cb(uint_fast8_t ctl_idx, uint_fast8_t stm_idx,
  * @param[in]   offset        Current byte offset relative to given bufsize from tud_video_n_frame_xfer (framesize)  */
 void tud_video_prepare_payload_cb(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, tud_video_payload_request_t* request);
 
+/** Invoked to read the source clock for PTS and SCR if CFG_TUD_VIDEO_STREAMING_TIMESTAMP is enabled.
+ * Default implementation counts milliseconds from SOF scaled to dwClockFrequency of the video control interface,
+ * application should provide a finer clock, e.g. a timer running at dwClockFrequency.
+ *
+ * @param[in]   ctl_idx       Destination control interface index
+ * @return source clock counter in units of dwClockFrequency */
+uint32_t tud_video_source_clock_cb(uint_fast8_t ctl_idx);
+
 //--------------------------------------------------------------------+
 // INTERNAL USBD-CLASS DRIVER API
 //--------------------------------------------------------------------+
@@ -92,6 +164,7 @@ void     videod_reset          (uint8_t rhport);
 uint16_t videod_open           (uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint16_t max_len);
 bool     videod_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request);
 bool     videod_xfer_cb        (uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+void     videod_sof_isr        (uint8_t rhport, uint32_t frame_count);
 
 #ifdef __cplusplus
  }
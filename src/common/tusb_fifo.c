@@ -129,10 +129,72 @@ TU_ATTR_ALWAYS_INLINE static inline void stride_write(volatile void *hwfifo, con
     #endif
 }
 
+// Aligned fast path: write n words from a naturally aligned buffer with native access instead of the unaligned access
+// emulation of stride_write() (byte-wise on strict-alignment MCUs), unrolled 4 words per iteration
+    #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE & 4
+TU_ATTR_ALWAYS_INLINE static inline void hwfifo_write32_aligned(volatile void *hwfifo, const uint32_t *src, uint16_t n) {
+  for (; n >= 4; n -= 4) {
+    *((volatile uint32_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+    *((volatile uint32_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+    *((volatile uint32_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+    *((volatile uint32_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+  }
+  for (; n > 0; n--) {
+    *((volatile uint32_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+  }
+}
+    #endif
+
+    #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE & 2
+TU_ATTR_ALWAYS_INLINE static inline void hwfifo_write16_aligned(volatile void *hwfifo, const uint16_t *src, uint16_t n) {
+  for (; n >= 4; n -= 4) {
+    *((volatile uint16_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+    *((volatile uint16_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+    *((volatile uint16_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+    *((volatile uint16_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+  }
+  for (; n > 0; n--) {
+    *((volatile uint16_t *)hwfifo) = *src++;
+    HWFIFO_ADDR_NEXT(hwfifo, );
+  }
+}
+    #endif
+
 // Copy from fifo to fixed address buffer (usually a tx register) with TU_FIFO_FIXED_ADDR_RW32 mode
 void tu_hwfifo_write(volatile void *hwfifo, const uint8_t *src, uint16_t len, const tu_hwfifo_access_t *access_mode) {
   // Write full available 16/32 bit words to dest
   const uint8_t data_stride = (access_mode != NULL) ? access_mode->data_stride : CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE;
+
+    #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE > 1
+  // Aligned source: move all full words with the fast path, leaving only odd bytes to the generic code below
+  if (len >= data_stride && (((uintptr_t)src) & (data_stride - 1u)) == 0) {
+    const uint16_t word_count = len / data_stride;
+    const uint16_t word_bytes = (uint16_t)(word_count * data_stride);
+      #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE & 4
+    if (data_stride == 4) {
+      hwfifo_write32_aligned(hwfifo, (const uint32_t *)(uintptr_t)src, word_count);
+    }
+      #endif
+      #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE & 2
+    if (data_stride == 2) {
+      hwfifo_write16_aligned(hwfifo, (const uint16_t *)(uintptr_t)src, word_count);
+    }
+      #endif
+    src += word_bytes;
+    len -= word_bytes;
+    HWFIFO_ADDR_NEXT_N(hwfifo, , word_bytes * HWFIFO_ADDR_DATA_RATIO);
+  }
+    #endif
+
   while (len >= data_stride) {
     stride_write(hwfifo, src, data_stride);
     src += data_stride;
@@ -200,9 +262,70 @@ TU_ATTR_ALWAYS_INLINE static inline void stride_read(const volatile void *hwfifo
     #endif
 }
 
+// Aligned fast path: read n words into a naturally aligned buffer with native access, see hwfifo_write32_aligned()
+    #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE & 4
+TU_ATTR_ALWAYS_INLINE static inline void hwfifo_read32_aligned(const volatile void *hwfifo, uint32_t *dest, uint16_t n) {
+  for (; n >= 4; n -= 4) {
+    *dest++ = *((const volatile uint32_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+    *dest++ = *((const volatile uint32_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+    *dest++ = *((const volatile uint32_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+    *dest++ = *((const volatile uint32_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+  }
+  for (; n > 0; n--) {
+    *dest++ = *((const volatile uint32_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+  }
+}
+    #endif
+
+    #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE & 2
+TU_ATTR_ALWAYS_INLINE static inline void hwfifo_read16_aligned(const volatile void *hwfifo, uint16_t *dest, uint16_t n) {
+  for (; n >= 4; n -= 4) {
+    *dest++ = *((const volatile uint16_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+    *dest++ = *((const volatile uint16_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+    *dest++ = *((const volatile uint16_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+    *dest++ = *((const volatile uint16_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+  }
+  for (; n > 0; n--) {
+    *dest++ = *((const volatile uint16_t *)hwfifo);
+    HWFIFO_ADDR_NEXT(hwfifo, const);
+  }
+}
+    #endif
+
 void tu_hwfifo_read(const volatile void *hwfifo, uint8_t *dest, uint16_t len, const tu_hwfifo_access_t *access_mode) {
   // Reading full available 16/32-bit hwfifo and write to fifo
   const uint8_t data_stride = (access_mode != NULL) ? access_mode->data_stride : CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE;
+
+    #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE > 1
+  // Aligned destination: move all full words with the fast path, leaving only odd bytes to the generic code below
+  if (len >= data_stride && (((uintptr_t)dest) & (data_stride - 1u)) == 0) {
+    const uint16_t word_count = len / data_stride;
+    const uint16_t word_bytes = (uint16_t)(word_count * data_stride);
+      #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE & 4
+    if (data_stride == 4) {
+      hwfifo_read32_aligned(hwfifo, (uint32_t *)(uintptr_t)dest, word_count);
+    }
+      #endif
+      #if CFG_TUSB_FIFO_HWFIFO_DATA_STRIDE & 2
+    if (data_stride == 2) {
+      hwfifo_read16_aligned(hwfifo, (uint16_t *)(uintptr_t)dest, word_count);
+    }
+      #endif
+    dest += word_bytes;
+    len -= word_bytes;
+    HWFIFO_ADDR_NEXT_N(hwfifo, const, word_bytes * HWFIFO_ADDR_DATA_RATIO);
+  }
+    #endif
+
   while (len >= data_stride) {
     stride_read(hwfifo, dest, data_stride);
     dest += data_stride;
@@ -813,3 +936,50 @@ void tu_fifo_get_write_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info) {
     info->wrapped.ptr = f->buffer;                 // Always start of buffer
   }
 }
+
+//--------------------------------------------------------------------+
+// Zero-copy API
+//--------------------------------------------------------------------+
+
+// Limit buffer info to n items, return total items
+static uint16_t ff_info_limit(tu_fifo_buffer_info_t *info, uint16_t n) {
+  if (info->linear.len >= n) {
+    info->linear.len  = n;
+    info->wrapped.len = 0;
+    info->wrapped.ptr = NULL;
+  } else {
+    info->wrapped.len = tu_min16(info->wrapped.len, (uint16_t) (n - info->linear.len));
+    if (info->wrapped.len == 0) {
+      info->wrapped.ptr = NULL;
+    }
+  }
+
+  if (info->linear.len == 0) {
+    info->linear.ptr = NULL;
+  }
+
+  return (uint16_t) (info->linear.len + info->wrapped.len);
+}
+
+uint16_t tu_fifo_write_reserve(tu_fifo_t *f, tu_fifo_buffer_info_t *info, uint16_t n) {
+  tu_fifo_get_write_info(f, info);
+  return ff_info_limit(info, n);
+}
+
+uint16_t tu_fifo_write_commit(tu_fifo_t *f, uint16_t n) {
+  ff_lock(f->mutex_wr);
+  n = tu_min16(n, tu_ff_remaining_local(f->depth, f->wr_idx, f->rd_idx)); // limit to free space
+  f->wr_idx = advance_index(f->depth, f->wr_idx, n);
+  ff_unlock(f->mutex_wr);
+
+  return n;
+}
+
+uint16_t tu_fifo_read_reserve(tu_fifo_t *f, tu_fifo_buffer_info_t *info, uint16_t n) {
+  tu_fifo_get_read_info(f, info);
+  return ff_info_limit(info, n);
+}
+
+uint16_t tu_fifo_read_commit(tu_fifo_t *f, uint16_t n) {
+  return tu_fifo_discard_n(f, n);
+}
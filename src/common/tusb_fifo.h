@@ -206,6 +206,17 @@ TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_fifo_write_n(tu_fifo_t *f, const
   return tu_fifo_write_n_access_mode(f, data, n, NULL);
 }
 
+//--------------------------------------------------------------------+
+// Zero-copy API
+// reserve() returns up to n items of FIFO memory as a linear and an optional wrapped span to produce into (write) or
+// consume from (read) in place, commit() then publishes the first n items with mutex. Write reserve only covers free
+// space even if FIFO is overwritable. Only one reservation per direction should be outstanding at a time.
+//--------------------------------------------------------------------+
+uint16_t tu_fifo_write_reserve(tu_fifo_t *f, tu_fifo_buffer_info_t *info, uint16_t n);
+uint16_t tu_fifo_write_commit(tu_fifo_t *f, uint16_t n);
+uint16_t tu_fifo_read_reserve(tu_fifo_t *f, tu_fifo_buffer_info_t *info, uint16_t n);
+uint16_t tu_fifo_read_commit(tu_fifo_t *f, uint16_t n);
+
 //--------------------------------------------------------------------+
 // Hardware FIFO API
 // Special hardware FIFO/Buffer to hold USB data, usually requires certain access method these can be configured with
@@ -741,6 +741,15 @@
   #endif
 #endif
 
+// Simulated controller for host builds
+#if defined(CFG_TUD_SIM) && CFG_TUD_SIM && !defined(TUP_DCD_ENDPOINT_MAX)
+  #define TUP_DCD_ENDPOINT_MAX 16
+#endif
+
+#if defined(CFG_TUD_SIM) && CFG_TUD_SIM && !defined(TUP_DCD_SOF_FRINDEX)
+  #define TUP_DCD_SOF_FRINDEX 1
+#endif
+
 
 //--------------------------------------------------------------------+
 // Default Values
@@ -764,6 +773,16 @@
   #define TUP_RHPORT_HIGHSPEED 0
 #endif
 
+// On highspeed, DCD reports SOF frame_count as microframe index (frame number << 3 | microframe) e.g FRINDEX
+// register, instead of 11-bit frame number
+#ifndef TUP_DCD_SOF_FRINDEX
+  #if defined(TUP_USBIP_DWC2) || defined(TUP_USBIP_CHIPIDEA_HS)
+    #define TUP_DCD_SOF_FRINDEX 1
+  #else
+    #define TUP_DCD_SOF_FRINDEX 0
+  #endif
+#endif
+
 // fast function, normally mean placing function in SRAM
 #ifndef TU_ATTR_FAST_FUNC
   #define TU_ATTR_FAST_FUNC
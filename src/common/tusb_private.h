@@ -36,10 +36,13 @@ typedef struct {
   uint8_t  hwid;    // device: rhport, host: daddr
   bool     is_host; // 1: host, 0: device
   uint8_t ep_addr;
-  // 1 byte padding
+  uint8_t latency_ms; // tx: flush partial packet after data is pending this long, 0 to disable
+  volatile uint8_t latency_elapsed; // tx: ms since pending data is not sent, counted by latency_tick()
 
   uint16_t mps;
   uint16_t xfer_len;
+  uint16_t spill_offset; // rx: received data in ep_buf not yet moved to FIFO (receive-ahead)
+  uint16_t spill_count;
   uint8_t  *ep_buf; // set to NULL to use xfer_fifo when CFG_TUD_EDPT_DEDICATED_HWFIFO = 1
   tu_fifo_t ff;
 
@@ -111,6 +114,7 @@ TU_ATTR_ALWAYS_INLINE static inline void tu_edpt_stream_close(tu_edpt_stream_t*
 
 TU_ATTR_ALWAYS_INLINE static inline void tu_edpt_stream_clear(tu_edpt_stream_t *s) {
   tu_fifo_clear(&s->ff);
+  s->spill_count = 0;
 }
 
 TU_ATTR_ALWAYS_INLINE static inline bool tu_edpt_stream_empty(tu_edpt_stream_t *s) {
@@ -134,6 +138,29 @@ bool tu_edpt_stream_write_zlp_if_needed(tu_edpt_stream_t *s, uint32_t last_xferr
 // Note: if no fifo, return endpoint size if not busy, 0 otherwise
 uint32_t tu_edpt_stream_write_available(tu_edpt_stream_t *s);
 
+// Set latency timer: pending data less than a packet is sent once it has waited latency_ms, 0 to disable.
+// Application writes are batched into full packets meanwhile, no need to flush after each write.
+TU_ATTR_ALWAYS_INLINE static inline void tu_edpt_stream_write_set_latency(tu_edpt_stream_t *s, uint8_t latency_ms) {
+  s->latency_ms      = latency_ms;
+  s->latency_elapsed = 0;
+}
+
+// Advance latency timer by elapsed ms, return true if pending data is due to be flushed by
+// tu_edpt_stream_write_latency_flush(). Can be called in ISR context e.g. SOF handler
+bool tu_edpt_stream_write_latency_tick(tu_edpt_stream_t *s, uint32_t elapsed_ms);
+
+// Flush pending data if latency timer is expired, return number of queued bytes
+uint32_t tu_edpt_stream_write_latency_flush(tu_edpt_stream_t *s);
+
+// Reserve up to bufsize bytes of free FIFO space to be filled in place, return number of reserved bytes
+TU_ATTR_ALWAYS_INLINE static inline
+uint32_t tu_edpt_stream_write_reserve(tu_edpt_stream_t *s, tu_fifo_buffer_info_t *info, uint32_t bufsize) {
+  return tu_fifo_write_reserve(&s->ff, info, (uint16_t) tu_min32(bufsize, 0xFFFFu));
+}
+
+// Publish count bytes previously filled via reserve(), flush the same way as write(). Return number of committed bytes
+uint32_t tu_edpt_stream_write_commit(tu_edpt_stream_t *s, uint32_t count);
+
 //--------------------------------------------------------------------+
 // Stream Read
 //--------------------------------------------------------------------+
@@ -141,21 +168,32 @@ uint32_t tu_edpt_stream_write_available(tu_edpt_stream_t *s);
 // Read from stream
 uint32_t tu_edpt_stream_read(tu_edpt_stream_t *s, void *buffer, uint32_t bufsize);
 
-// Start an usb transfer if endpoint is not busy
+// Start an usb transfer if endpoint is not busy.
+// With ep_buf, transfer is started even if FIFO is (nearly) full: received data that does not fit is kept in ep_buf
+// and moved to FIFO as application reads, so that endpoint is not NAKing while application drains the FIFO.
+// Without ep_buf (dedicated HWFIFO) there is no receive-ahead: transfer only starts when FIFO has a packet of space.
 uint32_t tu_edpt_stream_read_xfer(tu_edpt_stream_t *s);
 
-// Complete read transfer by writing EP -> FIFO. Must be called in the transfer complete callback
+// Reserve up to bufsize bytes of received data to be consumed in place, return number of reserved bytes
 TU_ATTR_ALWAYS_INLINE static inline
-void tu_edpt_stream_read_xfer_complete(tu_edpt_stream_t* s, uint32_t xferred_bytes) {
-  if (s->ep_buf != NULL) {
-    tu_fifo_write_n(&s->ff, s->ep_buf, (uint16_t)xferred_bytes);
-  }
+uint32_t tu_edpt_stream_read_reserve(tu_edpt_stream_t *s, tu_fifo_buffer_info_t *info, uint32_t bufsize) {
+  return tu_fifo_read_reserve(&s->ff, info, (uint16_t) tu_min32(bufsize, 0xFFFFu));
 }
 
-// Complete read transfer with provided buffer
+// Release count bytes previously consumed via reserve() and start a new transfer if possible
+uint32_t tu_edpt_stream_read_commit(tu_edpt_stream_t *s, uint32_t count);
+
+// Complete read transfer with provided buffer, part of ep_buf that does not fit into FIFO is kept for later.
+// Return number of bytes written to FIFO
+uint32_t tu_edpt_stream_read_xfer_complete_with_buf(tu_edpt_stream_t *s, const void *buf, uint32_t xferred_bytes);
+
+// Complete read transfer by writing EP -> FIFO. Must be called in the transfer complete callback
 TU_ATTR_ALWAYS_INLINE static inline
-void tu_edpt_stream_read_xfer_complete_with_buf(tu_edpt_stream_t *s, const void *buf, uint32_t xferred_bytes) {
-  tu_fifo_write_n(&s->ff, buf, (uint16_t)xferred_bytes);
+uint32_t tu_edpt_stream_read_xfer_complete(tu_edpt_stream_t* s, uint32_t xferred_bytes) {
+  if (s->ep_buf == NULL) {
+    return xferred_bytes; // received directly into FIFO
+  }
+  return tu_edpt_stream_read_xfer_complete_with_buf(s, s->ep_buf, xferred_bytes);
 }
 
 // Get the number of bytes available for reading
@@ -23,6 +23,12 @@
   #define CFG_TUD_TASK_QUEUE_SZ   16
 #endif
 
+// Transfer larger than what dcd_edpt_xfer() accepts is split into chunks of multiple of 4KB (i.e max packet size)
+#define USBD_XFER_CHUNK_ENABLED   (TUP_DCD_EDPT_XFER_MAX < 0xFFFFFFFFu)
+#define USBD_XFER_CHUNK_SIZE      (TUP_DCD_EDPT_XFER_MAX & ~0xFFFu)
+
+#define USBD_XFER_QUEUE_ENABLED   (CFG_TUD_EDPT_XFER_QUEUE > 1)
+
 //--------------------------------------------------------------------+
 // Weak stubs: invoked if no strong implementation is available
 //--------------------------------------------------------------------+
@@ -107,6 +113,27 @@ typedef struct {
   usbd_control_xfer_cb_t complete_cb;
 } usbd_control_xfer_t;
 
+// State of a transfer split into chunks
+typedef struct {
+  uint8_t* buffer;    // next chunk
+  uint32_t remaining; // bytes not queued yet
+  uint32_t xferred;   // bytes completed by previous chunks
+} usbd_xfer_chunk_t;
+
+#if USBD_XFER_QUEUE_ENABLED
+// Transfers submitted while endpoint is busy
+typedef struct {
+  struct {
+    uint8_t* buffer;
+    uint32_t len;
+  } req[CFG_TUD_EDPT_XFER_QUEUE - 1];
+  uint8_t rd_idx;
+  uint8_t pending;  // queued, not yet started in dcd
+  uint8_t inflight; // submitted, not yet completed to class driver (including pending)
+  bool    active;   // a transfer is running in dcd
+} usbd_xfer_queue_t;
+#endif
+
 typedef struct {
   usbd_control_xfer_t ctrl_xfer;
 
@@ -131,6 +158,14 @@ typedef struct {
   uint8_t ep2drv[CFG_TUD_ENDPPOINT_MAX][2]; // map endpoint to driver ( 0xff is invalid ), can use only 4-bit each
 
   volatile uint8_t ep_status[CFG_TUD_ENDPPOINT_MAX][2];
+
+#if USBD_XFER_CHUNK_ENABLED
+  usbd_xfer_chunk_t ep_chunk[CFG_TUD_ENDPPOINT_MAX][2];
+#endif
+
+#if USBD_XFER_QUEUE_ENABLED
+  usbd_xfer_queue_t ep_queue[CFG_TUD_ENDPPOINT_MAX][2];
+#endif
 } usbd_device_t;
 
 static usbd_device_t    _usbd_dev;
@@ -161,7 +196,7 @@ static const usbd_class_driver_t _usbd_driver[] = {
         .control_xfer_cb  = cdcd_control_xfer_cb,
         .xfer_cb          = cdcd_xfer_cb,
         .xfer_isr         = NULL,
-        .sof              = NULL
+        .sof              = cdcd_sof_isr
     },
     #endif
 
@@ -175,7 +210,7 @@ static const usbd_class_driver_t _usbd_driver[] = {
         .control_xfer_cb  = mscd_control_xfer_cb,
         .xfer_cb          = mscd_xfer_cb,
         .xfer_isr         = NULL,
-        .sof              = NULL
+        .sof              = mscd_sof_isr
     },
     #endif
 
@@ -217,7 +252,7 @@ static const usbd_class_driver_t _usbd_driver[] = {
         .control_xfer_cb  = videod_control_xfer_cb,
         .xfer_cb          = videod_xfer_cb,
         .xfer_isr         = NULL,
-        .sof              = NULL
+        .sof              = videod_sof_isr
     },
     #endif
 
@@ -259,7 +294,7 @@ static const usbd_class_driver_t _usbd_driver[] = {
         .control_xfer_cb  = vendord_control_xfer_cb,
         .xfer_cb          = vendord_xfer_cb,
         .xfer_isr         = NULL,
-        .sof              = NULL
+        .sof              = vendord_sof_isr
     },
     #endif
 
@@ -421,6 +456,7 @@ static bool process_setup_received(uint8_t rhport, tusb_control_request_t const
 static bool process_get_status(uint8_t rhport, tusb_control_request_t const * request, uint16_t status);
 static bool process_set_config(uint8_t rhport, uint8_t cfg_num);
 static bool process_get_descriptor(uint8_t rhport, tusb_control_request_t const * p_request);
+static void edpt_xfer_done(uint8_t epnum, uint8_t dir, bool in_isr);
 
 #if CFG_TUD_TEST_MODE
 static bool process_test_mode_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request) {
@@ -669,155 +705,186 @@ bool tud_task_event_ready(void) {
       }
     }
  */
-void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
-  (void) in_isr; // not implemented yet
-
-  // Skip if stack is not initialized
-  if (!tud_inited()) {
-    return;
+// Process one event from the queue
+static void usbd_event_process(dcd_event_t const* event) {
+#if CFG_TUSB_DEBUG >= CFG_TUD_LOG_LEVEL
+  if (event->event_id == DCD_EVENT_SETUP_RECEIVED) {
+    TU_LOG_USBD("\r\n"); // extra line for setup
   }
+  TU_LOG_USBD("USBD %s ", event->event_id < DCD_EVENT_COUNT ? _usbd_event_str[event->event_id] : "CORRUPTED");
+#endif
 
-  // Loop until there are no more events in the queue or CFG_TUD_TASK_EVENTS_PER_RUN is reached
-  for (unsigned epr = 0;; epr++) {
-#if CFG_TUD_TASK_EVENTS_PER_RUN > 0
-    if (epr >= CFG_TUD_TASK_EVENTS_PER_RUN) {
-      TU_LOG_USBD("USBD event limit (" TU_XSTRING(CFG_TUD_TASK_EVENTS_PER_RUN) ") reached\r\n");
+  switch (event->event_id) {
+    case DCD_EVENT_BUS_RESET_START:
+      TU_LOG_USBD("\r\n");
+      usbd_reset(event->rhport);
       break;
-    }
-#endif
-    dcd_event_t event;
-    if (!osal_queue_receive(_usbd_q, &event, timeout_ms)) {
-      return;
-    }
 
-#if CFG_TUSB_DEBUG >= CFG_TUD_LOG_LEVEL
-    if (event.event_id == DCD_EVENT_SETUP_RECEIVED) {
-      TU_LOG_USBD("\r\n"); // extra line for setup
-    }
-    TU_LOG_USBD("USBD %s ", event.event_id < DCD_EVENT_COUNT ? _usbd_event_str[event.event_id] : "CORRUPTED");
-#endif
+    case DCD_EVENT_BUS_RESET_END:
+      TU_LOG_USBD(": %s Speed\r\n", tu_str_speed[event->bus_reset.speed]);
+      // TODO a DCD that reports both edges pays for two teardowns: track a per-rhport
+      // "start seen" flag and skip this reset, keeping it for the single-event DCDs.
+      usbd_reset(event->rhport);
+      _usbd_dev.speed = event->bus_reset.speed;
+      break;
 
-    switch (event.event_id) {
-      case DCD_EVENT_BUS_RESET_START:
-        TU_LOG_USBD("\r\n");
-        usbd_reset(event.rhport);
-        break;
+    case DCD_EVENT_UNPLUGGED:
+      TU_LOG_USBD("\r\n");
+      usbd_reset(event->rhport);
+      tud_umount_cb();
+      break;
 
-      case DCD_EVENT_BUS_RESET_END:
-        TU_LOG_USBD(": %s Speed\r\n", tu_str_speed[event.bus_reset.speed]);
-        // TODO a DCD that reports both edges pays for two teardowns: track a per-rhport
-        // "start seen" flag and skip this reset, keeping it for the single-event DCDs.
-        usbd_reset(event.rhport);
-        _usbd_dev.speed = event.bus_reset.speed;
+    case DCD_EVENT_SETUP_RECEIVED:
+      if (_usbd_queued_setup == 0) {
         break;
-
-      case DCD_EVENT_UNPLUGGED:
-        TU_LOG_USBD("\r\n");
-        usbd_reset(event.rhport);
-        tud_umount_cb();
+      }
+      _usbd_queued_setup--;
+      TU_LOG_BUF(CFG_TUD_LOG_LEVEL, &event->setup_received, 8);
+      if (_usbd_queued_setup != 0) {
+        TU_LOG_USBD("  Skipped since there is other SETUP in queue\r\n");
         break;
+      }
 
-      case DCD_EVENT_SETUP_RECEIVED:
-        if (_usbd_queued_setup == 0) {
-          break;
-        }
-        _usbd_queued_setup--;
-        TU_LOG_BUF(CFG_TUD_LOG_LEVEL, &event.setup_received, 8);
-        if (_usbd_queued_setup != 0) {
-          TU_LOG_USBD("  Skipped since there is other SETUP in queue\r\n");
-          break;
-        }
+      // Mark as connected after receiving 1st setup packet.
+      // But it is easier to set it every time instead of wasting time to check then set
+      _usbd_dev.connected = 1;
 
-        // Mark as connected after receiving 1st setup packet.
-        // But it is easier to set it every time instead of wasting time to check then set
-        _usbd_dev.connected = 1;
+      // reset ep state
+      _usbd_dev.ep_status[0][TUSB_DIR_OUT] = 0;
+      _usbd_dev.ep_status[0][TUSB_DIR_IN] = 0;
 
-        // reset ep state
-        _usbd_dev.ep_status[0][TUSB_DIR_OUT] = 0;
-        _usbd_dev.ep_status[0][TUSB_DIR_IN] = 0;
+      // Process control request
+      if (!process_setup_received(event->rhport, &event->setup_received)) {
+        TU_LOG_USBD("  Stall EP0\r\n");
+        // Failed -> stall both control endpoint IN and OUT
+        dcd_edpt_stall(event->rhport, TU_EP0_OUT);
+        dcd_edpt_stall(event->rhport, TU_EP0_IN);
+      }
+      break;
 
-        // Process control request
-        if (!process_setup_received(event.rhport, &event.setup_received)) {
-          TU_LOG_USBD("  Stall EP0\r\n");
-          // Failed -> stall both control endpoint IN and OUT
-          dcd_edpt_stall(event.rhport, TU_EP0_OUT);
-          dcd_edpt_stall(event.rhport, TU_EP0_IN);
-        }
-        break;
+    case DCD_EVENT_XFER_COMPLETE: {
+      // Invoke the class callback associated with the endpoint address
+      uint8_t const ep_addr = event->xfer_complete.ep_addr;
+      uint8_t const epnum = tu_edpt_number(ep_addr);
+      uint8_t const ep_dir = tu_edpt_dir(ep_addr);
 
-      case DCD_EVENT_XFER_COMPLETE: {
-        // Invoke the class callback associated with the endpoint address
-        uint8_t const ep_addr = event.xfer_complete.ep_addr;
-        uint8_t const epnum = tu_edpt_number(ep_addr);
-        uint8_t const ep_dir = tu_edpt_dir(ep_addr);
-
-        TU_LOG_USBD("on EP %02X with %u bytes\r\n", ep_addr, (unsigned int) event.xfer_complete.len);
-
-        // Clear busy + claimed
-        _usbd_dev.ep_status[epnum][ep_dir] &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
-
-        if (0 == epnum) {
-          // Not stalled on failure: a DCD refuses an EP0 prime when a newer setup is already
-          // latched, and EP0 stalls are cleared by hardware when that setup arrives - so a stall
-          // issued here lands after the auto-clear and would stall the transfer that superseded
-          // this one. The pending setup re-drives EP0 by itself.
-          if (!usbd_control_xfer_cb(event.rhport, ep_addr, (xfer_result_t) event.xfer_complete.result,
-                                    event.xfer_complete.len)) {
-            TU_LOG_USBD("  Control stage not continued\r\n");
-          }
-        } else {
-          usbd_class_driver_t const* driver = get_driver(_usbd_dev.ep2drv[epnum][ep_dir]);
-          TU_ASSERT(driver,);
+      TU_LOG_USBD("on EP %02X with %u bytes\r\n", ep_addr, (unsigned int) event->xfer_complete.len);
+
+      // Clear busy + claimed
+      edpt_xfer_done(epnum, ep_dir, false);
 
-          TU_LOG_USBD("  %s xfer callback\r\n", driver->name);
-          driver->xfer_cb(event.rhport, ep_addr, (xfer_result_t) event.xfer_complete.result, event.xfer_complete.len);
+      if (0 == epnum) {
+        // Not stalled on failure: a DCD refuses an EP0 prime when a newer setup is already
+        // latched, and EP0 stalls are cleared by hardware when that setup arrives - so a stall
+        // issued here lands after the auto-clear and would stall the transfer that superseded
+        // this one. The pending setup re-drives EP0 by itself.
+        if (!usbd_control_xfer_cb(event->rhport, ep_addr, (xfer_result_t) event->xfer_complete.result,
+                                  event->xfer_complete.len)) {
+          TU_LOG_USBD("  Control stage not continued\r\n");
         }
-        break;
+      } else {
+        usbd_class_driver_t const* driver = get_driver(_usbd_dev.ep2drv[epnum][ep_dir]);
+        TU_ASSERT(driver,);
+
+        TU_LOG_USBD("  %s xfer callback\r\n", driver->name);
+        driver->xfer_cb(event->rhport, ep_addr, (xfer_result_t) event->xfer_complete.result, event->xfer_complete.len);
       }
+      break;
+    }
 
-      case DCD_EVENT_SUSPEND:
-        // NOTE: When plugging/unplugging device, the D+/D- state are unstable and
-        // can accidentally meet the SUSPEND condition ( Bus Idle for 3ms ), which result in a series of event
-        // e.g suspend -> resume -> unplug/plug. Skip suspend/resume if not connected
-        if (_usbd_dev.connected) {
-          TU_LOG_USBD(": Remote Wakeup = %u\r\n", _usbd_dev.remote_wakeup_en);
-          tud_suspend_cb(_usbd_dev.remote_wakeup_en);
-        } else {
-          TU_LOG_USBD(" Skipped\r\n");
-        }
-        break;
+    case DCD_EVENT_SUSPEND:
+      // NOTE: When plugging/unplugging device, the D+/D- state are unstable and
+      // can accidentally meet the SUSPEND condition ( Bus Idle for 3ms ), which result in a series of event
+      // e.g suspend -> resume -> unplug/plug. Skip suspend/resume if not connected
+      if (_usbd_dev.connected) {
+        TU_LOG_USBD(": Remote Wakeup = %u\r\n", _usbd_dev.remote_wakeup_en);
+        tud_suspend_cb(_usbd_dev.remote_wakeup_en);
+      } else {
+        TU_LOG_USBD(" Skipped\r\n");
+      }
+      break;
 
-      case DCD_EVENT_RESUME:
-        if (_usbd_dev.connected) {
-          TU_LOG_USBD("\r\n");
-          tud_resume_cb();
-        } else {
-          TU_LOG_USBD(" Skipped\r\n");
-        }
-        break;
+    case DCD_EVENT_RESUME:
+      if (_usbd_dev.connected) {
+        TU_LOG_USBD("\r\n");
+        tud_resume_cb();
+      } else {
+        TU_LOG_USBD(" Skipped\r\n");
+      }
+      break;
 
-      case USBD_EVENT_FUNC_CALL:
+    case USBD_EVENT_FUNC_CALL:
+      TU_LOG_USBD("\r\n");
+      if (event->func_call.func != NULL) {
+        event->func_call.func(event->func_call.param);
+      }
+      break;
+
+    case DCD_EVENT_SOF:
+      if (tu_bit_test(_usbd_dev.sof_consumer, SOF_CONSUMER_USER)) {
         TU_LOG_USBD("\r\n");
-        if (event.func_call.func != NULL) {
-          event.func_call.func(event.func_call.param);
-        }
-        break;
+        tud_sof_cb(event->sof.frame_count);
+      }
+    break;
 
-      case DCD_EVENT_SOF:
-        if (tu_bit_test(_usbd_dev.sof_consumer, SOF_CONSUMER_USER)) {
-          TU_LOG_USBD("\r\n");
-          tud_sof_cb(event.sof.frame_count);
-        }
+    default:
+      TU_BREAKPOINT();
       break;
+  }
+}
 
-      default:
-        TU_BREAKPOINT();
-        break;
+void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
+  (void) in_isr; // not implemented yet
+
+  // Skip if stack is not initialized
+  if (!tud_inited()) {
+    return;
+  }
+
+  // Dequeue events in batches (single queue lock per batch) until there are no more events in the queue or
+  // CFG_TUD_TASK_EVENTS_PER_RUN is reached
+  dcd_event_t events[CFG_TUD_TASK_EVENTS_PER_BATCH];
+
+  // Coalesce back-to-back SOFs: only the latest one is processed, right before the next non-SOF event
+  dcd_event_t sof_event;
+  bool sof_pending = false;
+
+  for (unsigned epr = 0;;) {
+    uint32_t batch = CFG_TUD_TASK_EVENTS_PER_BATCH;
+#if CFG_TUD_TASK_EVENTS_PER_RUN > 0
+    if (epr >= CFG_TUD_TASK_EVENTS_PER_RUN) {
+      TU_LOG_USBD("USBD event limit (" TU_XSTRING(CFG_TUD_TASK_EVENTS_PER_RUN) ") reached\r\n");
+      break;
+    }
+    batch = tu_min32(batch, CFG_TUD_TASK_EVENTS_PER_RUN - epr);
+#endif
+    const uint32_t count = osal_queue_receive_n(_usbd_q, events, batch, sizeof(dcd_event_t), timeout_ms);
+    if (count == 0) {
+      break;
+    }
+    epr += count;
+
+    for (uint32_t i = 0; i < count; i++) {
+      if (events[i].event_id == DCD_EVENT_SOF) {
+        sof_event = events[i];
+        sof_pending = true;
+        continue;
+      }
+
+      if (sof_pending) {
+        sof_pending = false;
+        usbd_event_process(&sof_event);
+      }
+      usbd_event_process(&events[i]);
     }
 
     // allow to exit tud_task() if there is no event in the next run
     timeout_ms = 0;
   }
+
+  if (sof_pending) {
+    usbd_event_process(&sof_event);
+  }
 }
 
 //--------------------------------------------------------------------+
@@ -1400,8 +1467,145 @@ static bool process_get_descriptor(uint8_t rhport, tusb_control_request_t const
 //--------------------------------------------------------------------+
 // DCD Event Handler
 //--------------------------------------------------------------------+
+#if USBD_XFER_CHUNK_ENABLED
+// Queue next chunk of a split transfer in ISR context. Return false if the whole transfer is complete: short packet,
+// error or no more remaining bytes.
+TU_ATTR_FAST_FUNC static bool xfer_chunk_next(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t len) {
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir = tu_edpt_dir(ep_addr);
+  usbd_xfer_chunk_t* chunk = &_usbd_dev.ep_chunk[epnum][dir];
+
+  if (result != XFER_RESULT_SUCCESS || len != USBD_XFER_CHUNK_SIZE || chunk->remaining == 0) {
+    chunk->remaining = 0;
+    return false;
+  }
+
+  uint32_t const xact_len = tu_min32(chunk->remaining, USBD_XFER_CHUNK_SIZE);
+  uint8_t* const buffer = chunk->buffer;
+  chunk->xferred += len;
+  chunk->buffer += xact_len;
+  chunk->remaining -= xact_len;
+
+  if (!dcd_edpt_xfer(rhport, ep_addr, buffer, xact_len, true)) {
+    // DCD refused, complete with what is transferred so far
+    chunk->remaining = 0;
+    return false;
+  }
+
+  return true;
+}
+#endif
+
+// Start a transfer in dcd, split into chunks if it is larger than what dcd accepts
+TU_ATTR_FAST_FUNC static bool edpt_xfer_start(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint32_t total_bytes,
+                                              bool is_isr) {
+#if USBD_XFER_CHUNK_ENABLED
+  usbd_xfer_chunk_t* chunk = &_usbd_dev.ep_chunk[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+  uint32_t const xact_len = (total_bytes > TUP_DCD_EDPT_XFER_MAX) ? USBD_XFER_CHUNK_SIZE : total_bytes;
+  chunk->buffer = buffer + xact_len;
+  chunk->remaining = total_bytes - xact_len;
+  chunk->xferred = 0;
+#else
+  uint32_t const xact_len = total_bytes;
+#endif
+
+  return dcd_edpt_xfer(rhport, ep_addr, buffer, xact_len, is_isr);
+}
+
+// Transfer is completed to class driver: release endpoint if there is no more transfer in flight
+TU_ATTR_FAST_FUNC static void edpt_xfer_done(uint8_t epnum, uint8_t dir, bool in_isr) {
+#if USBD_XFER_QUEUE_ENABLED
+  if (epnum > 0) {
+    usbd_xfer_queue_t* q = &_usbd_dev.ep_queue[epnum][dir];
+    usbd_spin_lock(in_isr);
+    if (q->inflight > 0) {
+      q->inflight--;
+    }
+    if (q->inflight == 0) {
+      _usbd_dev.ep_status[epnum][dir] &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
+    }
+    usbd_spin_unlock(in_isr);
+    return;
+  }
+#endif
+
+  (void) in_isr;
+  _usbd_dev.ep_status[epnum][dir] &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
+}
+
+#if USBD_XFER_QUEUE_ENABLED
+// Submit transfer to a non-control endpoint: start it if dcd is idle, otherwise queue it
+static bool xfer_queue_submit(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint32_t total_bytes, bool is_isr) {
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir = tu_edpt_dir(ep_addr);
+  usbd_xfer_queue_t* q = &_usbd_dev.ep_queue[epnum][dir];
+
+  usbd_spin_lock(is_isr);
+  if ((_usbd_dev.ep_status[epnum][dir] & TU_EDPT_STATE_STALLED) || q->inflight >= CFG_TUD_EDPT_XFER_QUEUE) {
+    usbd_spin_unlock(is_isr);
+    TU_LOG_USBD("FAILED: stalled or queue full\r\n");
+    return false;
+  }
+
+  // Set busy first since the actual transfer can be complete before dcd_edpt_xfer() could return
+  _usbd_dev.ep_status[epnum][dir] |= TU_EDPT_STATE_BUSY;
+  q->inflight++;
+
+  bool const start = !q->active;
+  if (start) {
+    q->active = true;
+  } else {
+    uint8_t const wr_idx = (uint8_t) ((q->rd_idx + q->pending) % (CFG_TUD_EDPT_XFER_QUEUE - 1));
+    q->req[wr_idx].buffer = buffer;
+    q->req[wr_idx].len = total_bytes;
+    q->pending++;
+  }
+  usbd_spin_unlock(is_isr);
+
+  if (start && !edpt_xfer_start(rhport, ep_addr, buffer, total_bytes, is_isr)) {
+    usbd_spin_lock(is_isr);
+    q->active = false;
+    usbd_spin_unlock(is_isr);
+    edpt_xfer_done(epnum, dir, is_isr);
+    TU_LOG_USBD("FAILED\r\n");
+    return false;
+  }
+
+  return true;
+}
+
+// Transfer in dcd is complete, start the next queued one in ISR context to keep endpoint busy.
+// Return false if dcd refused the next transfer, which is then removed from queue.
+TU_ATTR_FAST_FUNC static bool xfer_queue_next(uint8_t rhport, uint8_t ep_addr) {
+  usbd_xfer_queue_t* q = &_usbd_dev.ep_queue[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+
+  if (q->pending == 0) {
+    q->active = false;
+    return true;
+  }
+
+  uint8_t* const buffer = q->req[q->rd_idx].buffer;
+  uint32_t const len = q->req[q->rd_idx].len;
+  q->rd_idx = (uint8_t) ((q->rd_idx + 1) % (CFG_TUD_EDPT_XFER_QUEUE - 1));
+  q->pending--;
+
+  if (!edpt_xfer_start(rhport, ep_addr, buffer, len, true)) {
+    q->active = false;
+    return false;
+  }
+
+  return true;
+}
+#endif
+
 TU_ATTR_FAST_FUNC void dcd_event_handler(dcd_event_t const* event, bool in_isr) {
   bool send = false;
+#if USBD_XFER_QUEUE_ENABLED
+  bool queue_refused = false;
+#endif
+#if USBD_XFER_CHUNK_ENABLED
+  dcd_event_t event_chunk; // xfer complete with total length of chunked transfer, event points to it until return
+#endif
   switch (event->event_id) {
     case DCD_EVENT_UNPLUGGED:
       _usbd_dev.connected = 0;
@@ -1465,19 +1669,41 @@ TU_ATTR_FAST_FUNC void dcd_event_handler(dcd_event_t const* event, bool in_isr)
       uint8_t const epnum = tu_edpt_number(ep_addr);
       uint8_t const ep_dir = tu_edpt_dir(ep_addr);
 
+#if USBD_XFER_CHUNK_ENABLED
+      if (_usbd_dev.ep_chunk[epnum][ep_dir].remaining || _usbd_dev.ep_chunk[epnum][ep_dir].xferred) {
+        if (xfer_chunk_next(event->rhport, ep_addr, (xfer_result_t) event->xfer_complete.result, event->xfer_complete.len)) {
+          break; // next chunk is queued
+        }
+        // whole transfer is complete, report total length
+        event_chunk = *event;
+        event_chunk.xfer_complete.len += _usbd_dev.ep_chunk[epnum][ep_dir].xferred;
+        _usbd_dev.ep_chunk[epnum][ep_dir].xferred = 0;
+        event = &event_chunk;
+      }
+#endif
+
+#if USBD_XFER_QUEUE_ENABLED
+      if (epnum > 0) {
+        queue_refused = !xfer_queue_next(event->rhport, ep_addr);
+      }
+#endif
+
       send = true;
       if(epnum > 0) {
         usbd_class_driver_t const* driver = get_driver(_usbd_dev.ep2drv[epnum][ep_dir]);
 
         if (driver && driver->xfer_isr) {
           // Clear busy + claimed
-          _usbd_dev.ep_status[epnum][ep_dir] &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
+          edpt_xfer_done(epnum, ep_dir, in_isr);
 
           send = !driver->xfer_isr(event->rhport, ep_addr, (xfer_result_t) event->xfer_complete.result, event->xfer_complete.len);
 
           // xfer_isr() is deferred to xfer_cb(), revert busy/claimed status
           if (send) {
             // set busy + claimed
+            #if USBD_XFER_QUEUE_ENABLED
+            _usbd_dev.ep_queue[epnum][ep_dir].inflight++;
+            #endif
             _usbd_dev.ep_status[epnum][ep_dir] |= (TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
           }
         }
@@ -1500,9 +1726,16 @@ TU_ATTR_FAST_FUNC void dcd_event_handler(dcd_event_t const* event, bool in_isr)
       // clear busy + claimed, else the endpoint can never be claimed or re-armed again
       uint8_t const epnum = tu_edpt_number(event->xfer_complete.ep_addr);
       uint8_t const ep_dir = tu_edpt_dir(event->xfer_complete.ep_addr);
-      _usbd_dev.ep_status[epnum][ep_dir] &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
+      edpt_xfer_done(epnum, ep_dir, in_isr);
     }
   }
+
+#if USBD_XFER_QUEUE_ENABLED
+  if (queue_refused) {
+    // complete the refused transfer after the current one to keep submission order
+    dcd_event_xfer_complete(event->rhport, event->xfer_complete.ep_addr, 0, XFER_RESULT_FAILED, in_isr);
+  }
+#endif
 }
 
 //--------------------------------------------------------------------+
@@ -1589,7 +1822,7 @@ bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr) {
   return tu_edpt_release(&_usbd_dev.ep_status[epnum][dir], _usbd_mutex);
 }
 
-bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes, bool is_isr) {
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint32_t total_bytes, bool is_isr) {
   rhport = _usbd_rhport;
 
   uint8_t const epnum = tu_edpt_number(ep_addr);
@@ -1598,13 +1831,19 @@ bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t t
   // TODO skip ready() check for now since enumeration also use this API
   // TU_VERIFY(tud_ready());
 
-  TU_LOG_USBD("  Queue EP %02X with %u bytes ...\r\n", ep_addr, total_bytes);
+  TU_LOG_USBD("  Queue EP %02X with %lu bytes ...\r\n", ep_addr, (unsigned long) total_bytes);
 #if CFG_TUD_LOG_LEVEL >= 3
   if(dir == TUSB_DIR_IN) {
     TU_LOG_MEM(CFG_TUD_LOG_LEVEL, buffer, total_bytes, 2);
   }
 #endif
 
+#if USBD_XFER_QUEUE_ENABLED
+  if (epnum > 0) {
+    return xfer_queue_submit(rhport, ep_addr, buffer, total_bytes, is_isr);
+  }
+#endif
+
   // Attempt to transfer on a busy endpoint, sound like an race condition !
   TU_ASSERT((_usbd_dev.ep_status[epnum][dir] & TU_EDPT_STATE_BUSY) == 0);
 
@@ -1612,7 +1851,7 @@ bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t t
   // could return and USBD task can preempt and clear the busy
   _usbd_dev.ep_status[epnum][dir] |= TU_EDPT_STATE_BUSY;
 
-  if (dcd_edpt_xfer(rhport, ep_addr, buffer, total_bytes, is_isr)) {
+  if (edpt_xfer_start(rhport, ep_addr, buffer, total_bytes, is_isr)) {
     return true;
   } else {
     // Driver refused the transfer, mark endpoint as ready to allow next transfer. This is a
@@ -1625,6 +1864,21 @@ bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t t
   }
 }
 
+uint8_t usbd_edpt_xfer_count(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir = tu_edpt_dir(ep_addr);
+
+#if USBD_XFER_QUEUE_ENABLED
+  if (epnum > 0) {
+    return _usbd_dev.ep_queue[epnum][dir].inflight;
+  }
+#endif
+
+  return (_usbd_dev.ep_status[epnum][dir] & TU_EDPT_STATE_BUSY) ? 1 : 0;
+}
+
 // The number of bytes has to be given explicitly to allow more flexible control of how many
 // bytes should be written and second to keep the return value free to give back a boolean
 // success message. If total_bytes is too big, the FIFO will copy only what is available
@@ -1644,6 +1898,9 @@ bool usbd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t* ff, uint16_
   // Set busy first since the actual transfer can be complete before dcd_edpt_xfer() could return
   // and usbd task can preempt and clear the busy
   _usbd_dev.ep_status[epnum][dir] |= TU_EDPT_STATE_BUSY;
+  #if USBD_XFER_CHUNK_ENABLED
+  tu_varclr(&_usbd_dev.ep_chunk[epnum][dir]);
+  #endif
 
   if (dcd_edpt_xfer_fifo(rhport, ep_addr, ff, total_bytes, is_isr)) {
     TU_LOG_USBD("OK\r\n");
@@ -1707,6 +1964,13 @@ void usbd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) {
     clear_mask |= TU_EDPT_STATE_CLAIMED;
   }
   _usbd_dev.ep_status[epnum][dir] &= (uint8_t) ~clear_mask;
+
+#if USBD_XFER_QUEUE_ENABLED
+  // transfers in flight are dropped along with the busy bit
+  if (epnum > 0) {
+    tu_varclr(&_usbd_dev.ep_queue[epnum][dir]);
+  }
+#endif
 }
 
 bool usbd_edpt_stalled(uint8_t rhport, uint8_t ep_addr) {
@@ -1736,6 +2000,12 @@ void usbd_edpt_close(uint8_t rhport, uint8_t ep_addr) {
 
   dcd_edpt_close(rhport, ep_addr);
   _usbd_dev.ep_status[epnum][dir] = 0;
+  #if USBD_XFER_CHUNK_ENABLED
+  tu_varclr(&_usbd_dev.ep_chunk[epnum][dir]);
+  #endif
+  #if USBD_XFER_QUEUE_ENABLED
+  tu_varclr(&_usbd_dev.ep_queue[epnum][dir]);
+  #endif
 #endif
 
   return;
@@ -1758,6 +2028,24 @@ void usbd_sof_enable(uint8_t rhport, sof_consumer_t consumer, bool en) {
   }
 }
 
+TU_ATTR_FAST_FUNC uint16_t usbd_sof_frame_number(uint32_t frame_count) {
+#if TUP_DCD_SOF_FRINDEX
+  if (_usbd_dev.speed == TUSB_SPEED_HIGH) {
+    frame_count >>= 3; // drop microframe
+  }
+#endif
+  return (uint16_t) (frame_count & 0x7FFu);
+}
+
+TU_ATTR_FAST_FUNC uint16_t usbd_sof_elapsed_ms(usbd_sof_tick_t* tick, uint32_t frame_count) {
+  // frame number is in 1ms unit and 11-bit
+  const uint16_t frame = usbd_sof_frame_number(frame_count);
+  const uint16_t elapsed_ms = tick->synced ? (uint16_t) ((frame - tick->last_frame) & 0x7FFu) : 0;
+  tick->last_frame = frame;
+  tick->synced = true;
+  return elapsed_ms;
+}
+
 bool usbd_edpt_iso_alloc(uint8_t rhport, uint8_t ep_addr, uint16_t largest_packet_size) {
 #ifdef TUP_DCD_EDPT_ISO_ALLOC
   rhport = _usbd_rhport;
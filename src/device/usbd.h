@@ -177,7 +177,8 @@ void tud_resume_cb(void);
 // Invoked when there is a new usb event, which need to be processed by tud_task()/tud_task_ext()
 void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr);
 
-// Invoked when a new (micro) frame started
+// Invoked when a new (micro) frame started. SOFs queued back-to-back are coalesced into one call with the latest
+// frame count
 void tud_sof_cb(uint32_t frame_count);
 
 // Invoked when received control request with VENDOR TYPE
@@ -278,6 +279,29 @@ bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_requ
   /* Endpoint In */\
   7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0
 
+// Bulk-Only as alternate setting 0 and USB Attached SCSI (UAS) as alternate setting 1
+// Length of template descriptor: 76 bytes
+#define TUD_MSC_UAS_DESC_LEN    (TUD_MSC_DESC_LEN + 9 + 4*(7 + 4))
+
+// Interface number, string index, EP Out & EP In address (shared by both settings), EP Command & EP Status address,
+// EP size
+#define TUD_MSC_UAS_DESCRIPTOR(_itfnum, _stridx, _epout, _epin, _epcmd, _epstatus, _epsize) \
+  TUD_MSC_DESCRIPTOR(_itfnum, _stridx, _epout, _epin, _epsize),\
+  /* Interface: alternate setting 1 */\
+  9, TUSB_DESC_INTERFACE, _itfnum, 1, 4, TUSB_CLASS_MSC, MSC_SUBCLASS_SCSI, MSC_PROTOCOL_UAS, _stridx,\
+  /* Command pipe */\
+  7, TUSB_DESC_ENDPOINT, _epcmd, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0,\
+  4, MSC_UAS_DESC_PIPE_USAGE, MSC_UAS_PIPE_COMMAND, 0,\
+  /* Status pipe */\
+  7, TUSB_DESC_ENDPOINT, _epstatus, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0,\
+  4, MSC_UAS_DESC_PIPE_USAGE, MSC_UAS_PIPE_STATUS, 0,\
+  /* Data-in pipe */\
+  7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0,\
+  4, MSC_UAS_DESC_PIPE_USAGE, MSC_UAS_PIPE_DATA_IN, 0,\
+  /* Data-out pipe */\
+  7, TUSB_DESC_ENDPOINT, _epout, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0,\
+  4, MSC_UAS_DESC_PIPE_USAGE, MSC_UAS_PIPE_DATA_OUT, 0
+
 //--------------------------------------------------------------------+
 // Printer Descriptor Templates
 //--------------------------------------------------------------------+
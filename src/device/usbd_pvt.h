@@ -24,8 +24,18 @@
 typedef enum {
   SOF_CONSUMER_USER = 0,
   SOF_CONSUMER_AUDIO,
+  SOF_CONSUMER_MSC,
+  SOF_CONSUMER_CDC,
+  SOF_CONSUMER_VENDOR,
+  SOF_CONSUMER_VIDEO,
 } sof_consumer_t;
 
+// Millisecond tick counted from SOF by a consumer, clear synced when its SOF is enabled
+typedef struct {
+  bool     synced;
+  uint16_t last_frame; // 11-bit frame number of last SOF
+} usbd_sof_tick_t;
+
 //--------------------------------------------------------------------+
 // Class Driver API
 //--------------------------------------------------------------------+
@@ -66,8 +76,13 @@ bool usbd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const * desc_ep);
 // Close an endpoint
 void usbd_edpt_close(uint8_t rhport, uint8_t ep_addr);
 
-// Submit a usb transfer
-bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes, bool is_isr);
+// Submit a usb transfer. With CFG_TUD_EDPT_XFER_QUEUE > 1, transfer submitted to a busy (non-control) endpoint is
+// queued and xfer_cb() is invoked for each transfer in submission order. usbd_edpt_claim() still fails on a busy
+// endpoint, drivers that claim before each transfer (e.g. tu_edpt_stream) never queue.
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint32_t total_bytes, bool is_isr);
+
+// Number of transfers submitted and not yet completed to class driver
+uint8_t usbd_edpt_xfer_count(uint8_t rhport, uint8_t ep_addr);
 
 // Submit a usb ISO transfer by use of a FIFO (ring buffer) - all bytes in FIFO get transmitted
 bool usbd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t * ff, uint16_t total_bytes, bool is_isr);
@@ -108,6 +123,13 @@ bool usbd_edpt_ready(uint8_t rhport, uint8_t ep_addr) {
 // Enable SOF interrupt
 void usbd_sof_enable(uint8_t rhport, sof_consumer_t consumer, bool en);
 
+// Get 11-bit frame number from SOF frame_count according to bus speed
+uint16_t usbd_sof_frame_number(uint32_t frame_count);
+
+// Get milliseconds elapsed since previous SOF of the tick, 0 for first SOF after sync and for other microframes of
+// the same frame. Called by class driver's sof() in ISR context
+uint16_t usbd_sof_elapsed_ms(usbd_sof_tick_t* tick, uint32_t frame_count);
+
 bool usbd_open_edpt_pair(uint8_t rhport, uint8_t const* p_desc, uint8_t ep_count, uint8_t xfer_type, uint8_t* ep_out, uint8_t* ep_in);
 void usbd_defer_func(osal_task_func_t func, void *param, bool in_isr);
 
@@ -31,6 +31,7 @@ typedef struct {
   // uint16_t wHubCharacteristics;
   bool mtt;
   hub_port_status_response_t port_status;
+  tuh_xfer_cb_t port_status_cb; // user callback of pending port get status
 } hub_interface_t;
 
 typedef struct {
@@ -38,7 +39,6 @@ typedef struct {
   TUH_EPBUF_DEF(ctrl_buf, CFG_TUH_HUB_BUFSIZE);
 } hub_epbuf_t;
 
-static tuh_xfer_cb_t user_complete_cb = NULL;
 static hub_interface_t hub_itfs[CFG_TUH_HUB];
 CFG_TUH_MEM_SECTION static hub_epbuf_t hub_epbufs[CFG_TUH_HUB];
 
@@ -130,13 +130,14 @@ bool hub_port_set_feature(uint8_t hub_addr, uint8_t hub_port, uint8_t feature,
 }
 
 static void port_get_status_complete (tuh_xfer_t* xfer) {
+  hub_interface_t* p_hub = get_hub_itf(xfer->daddr);
   if (xfer->result == XFER_RESULT_SUCCESS) {
-    hub_interface_t* p_hub = get_hub_itf(xfer->daddr);
     p_hub->port_status = *((const hub_port_status_response_t *) (uintptr_t) xfer->buffer);
   }
 
-  xfer->complete_cb = user_complete_cb;
-  user_complete_cb = NULL;
+  // callback is kept per hub since several hubs can have control transfer in flight
+  xfer->complete_cb = p_hub->port_status_cb;
+  p_hub->port_status_cb = NULL;
   if (xfer->complete_cb) {
     xfer->complete_cb(xfer);
   }
@@ -170,9 +171,7 @@ bool hub_port_get_status(uint8_t hub_addr, uint8_t hub_port, void* resp,
     hub_epbuf_t* p_epbuf = get_hub_epbuf(hub_addr);
     xfer.complete_cb = port_get_status_complete;
     xfer.buffer = p_epbuf->ctrl_buf;
-    user_complete_cb = complete_cb;
-  } else {
-    user_complete_cb = NULL;
+    get_hub_itf(hub_addr)->port_status_cb = complete_cb;
   }
 
   TU_LOG_DRV("HUB Get Port Status: addr = %u port = %u\r\n", hub_addr, hub_port);
@@ -23,12 +23,17 @@
 
 #ifndef CFG_TUH_CONTROL_PENDING_QUEUE_SZ
   #if CFG_TUH_HUB
-    #define CFG_TUH_CONTROL_PENDING_QUEUE_SZ 4
+    #define CFG_TUH_CONTROL_PENDING_QUEUE_SZ (2 + CFG_TUH_ENUMERATION_MAX)
   #else
     #define CFG_TUH_CONTROL_PENDING_QUEUE_SZ 2
   #endif
 #endif
 
+// Max control transfers in flight at the same time, at most one per device address. Default to what hcd supports
+#ifndef CFG_TUH_CONTROL_XFER_MAX
+  #define CFG_TUH_CONTROL_XFER_MAX  TUP_HCD_CONTROL_XFER_MAX
+#endif
+
 #ifndef CFG_TUH_INTERFACE_MAX
   #define CFG_TUH_INTERFACE_MAX   8
 #endif
@@ -37,6 +42,10 @@ enum {
   USBH_CONTROL_RETRY_MAX = 3,
 };
 
+// Transfer larger than what hcd_edpt_xfer() accepts is split into chunks of multiple of 4KB (i.e max packet size)
+#define USBH_XFER_CHUNK_ENABLED   (TUP_HCD_EDPT_XFER_MAX < 0xFFFFFFFFu)
+#define USBH_XFER_CHUNK_SIZE      (TUP_HCD_EDPT_XFER_MAX & ~0xFFFu)
+
 //--------------------------------------------------------------------+
 // Weak stubs: invoked if no strong implementation is available
 //--------------------------------------------------------------------+
@@ -112,6 +121,13 @@ typedef struct TU_ATTR_PACKED {
 
 TU_VERIFY_STATIC( sizeof(desc_device_noheader_t) == 16u, "size is not correct");
 
+// State of a transfer split into chunks
+typedef struct {
+  uint8_t* buffer;    // next chunk
+  uint32_t remaining; // bytes not queued yet
+  uint32_t xferred;   // bytes completed by previous chunks
+} usbh_xfer_chunk_t;
+
 typedef struct {
   tuh_bus_info_t bus_info;
   desc_device_noheader_t desc_device;
@@ -125,6 +141,8 @@ typedef struct {
     // volatile uint8_t removing : 1; // Physically disconnected, waiting to be processed by usbh
   };
 
+  uint32_t enum_time_ms; // time taken to enumerate, from attach until all drivers are configured
+
   // Endpoint & Interface
   uint8_t itf2drv[CFG_TUH_INTERFACE_MAX];  // map interface number to driver (0xff is invalid)
   uint8_t ep2drv[CFG_TUH_ENDPOINT_MAX][2]; // map endpoint to driver ( 0xff is invalid ), can use only 4-bit each
@@ -139,6 +157,10 @@ typedef struct {
   }ep_callback[CFG_TUH_ENDPOINT_MAX][2];
 #endif
 
+#if USBH_XFER_CHUNK_ENABLED
+  usbh_xfer_chunk_t ep_chunk[CFG_TUH_ENDPOINT_MAX][2];
+#endif
+
 } usbh_device_t;
 
 // sum of end device + hub
@@ -149,6 +171,10 @@ typedef struct {
 // TODO: hub can has its own simpler struct to save memory
 static usbh_device_t _usbh_devices[TOTAL_DEVICES];
 
+// Number of control transfer slots: limited by hcd and number of device addresses (including address 0)
+#define USBH_CONTROL_XFER_MAX \
+  TU_MIN(TU_MIN(CFG_TUH_CONTROL_XFER_MAX, TUP_HCD_CONTROL_XFER_MAX), TOTAL_DEVICES + 1)
+
 // Mutex for claiming endpoint
 #if OSAL_MUTEX_REQUIRED
 static osal_mutex_def_t _usbh_mutexdef;
@@ -170,9 +196,9 @@ OSAL_QUEUE_DEF(usbh_int_set, _usbh_daqdef, CFG_TUH_HUB, hcd_event_t);
 static osal_queue_t _usbh_daq;
 #endif
 
-// Control transfers: since most controllers do not support multiple control transfers
-// on multiple devices concurrently and control transfers are not used much except for
-// enumeration, we will only execute control transfers one at a time.
+// Control transfers: each device has at most one control transfer in flight (EP0 is a single pipe). Controllers with
+// a control endpoint per device (EHCI, OHCI) can run transfers of different devices concurrently, one per slot.
+// Others only have 1 slot and execute control transfers one at a time.
 typedef struct {
   uint8_t* buffer;
   tuh_xfer_cb_t complete_cb;
@@ -199,14 +225,22 @@ typedef struct {
   uint8_t                daddr_gen;
 } usbh_pending_ctrl_t;
 
-// FIFO for pending async control transfers since we only execute 1 control transfer at a time
+// FIFO for pending async control transfers when their device is busy or no slot is available
 TU_FIFO_DEF(_usbh_pending_ctrl_q, CFG_TUH_CONTROL_PENDING_QUEUE_SZ * sizeof(usbh_pending_ctrl_t), false);
 
+// Enumeration in progress: from attach until all drivers are configured
+typedef struct {
+  uint8_t  daddr;    // TUSB_INDEX_INVALID_8 if not used, 0 in address 0 stage
+  uint32_t start_ms; // when attach is processed
+} usbh_enum_t;
+
 typedef struct {
-  uint8_t enumerating_daddr;  // device address of the device being enumerated
+  uint8_t enumerating_daddr;  // device in address 0 stage (reset to set address recovery), only one at a time
+  usbh_enum_t enumeration[CFG_TUH_ENUMERATION_MAX]; // devices being enumerated, past address 0 stage run concurrently
   uint8_t attach_debouncing_bm;  // bitmask for roothub port attach debouncing
   tuh_bus_info_t dev0_bus;    // bus info for dev0 in enumeration
-  usbh_ctrl_xfer_info_t ctrl_xfer_info; // control transfer
+  usbh_ctrl_xfer_info_t ctrl_xfer_info[USBH_CONTROL_XFER_MAX]; // control transfer slots
+  volatile bool ctrl_pending_scan; // pending FIFO need to be scanned: a slot is released or xfer queued while idle
   usbh_call_after_t call_after;
   // Per-daddr generation counter — bumped on usbh_device_close() to identify stale pending control transfer
   uint8_t daddr_gen[TOTAL_DEVICES + 1];
@@ -219,8 +253,12 @@ static uint8_t _usbh_controller_id = TUSB_INDEX_INVALID_8;
 static usbh_data_t _usbh_data;
 
 typedef struct {
-  TUH_EPBUF_TYPE_DEF(tusb_control_request_t, request);
-  TUH_EPBUF_DEF(ctrl, CFG_TUH_ENUMERATION_BUFSIZE);
+  struct {
+    TUH_EPBUF_TYPE_DEF(tusb_control_request_t, request);
+  } ctrl_request[USBH_CONTROL_XFER_MAX]; // setup packet of each control slot
+  struct {
+    TUH_EPBUF_DEF(buf, CFG_TUH_ENUMERATION_BUFSIZE);
+  } enum_buf[CFG_TUH_ENUMERATION_MAX]; // buffer of each enumeration
 } usbh_epbuf_t;
 CFG_TUH_MEM_SECTION static usbh_epbuf_t _usbh_epbuf;
 
@@ -246,6 +284,18 @@ static usbh_class_driver_t const usbh_class_drivers[] = {
   },
   #endif
 
+  #if CFG_TUH_NCM
+  {
+      .name       = DRIVER_NAME("NCM"),
+      .init       = ncmh_init,
+      .deinit     = ncmh_deinit,
+      .open       = ncmh_open,
+      .set_config = ncmh_set_config,
+      .xfer_cb    = ncmh_xfer_cb,
+      .close      = ncmh_close
+  },
+  #endif
+
   #if CFG_TUH_MSC
   {
       .name       = DRIVER_NAME("MSC"),
@@ -336,13 +386,15 @@ TU_ATTR_ALWAYS_INLINE static inline usbh_class_driver_t const *get_driver(uint8_
 //--------------------------------------------------------------------+
 static void enum_new_device(hcd_event_t* event);
 static void enum_delay_async(uintptr_t state);
+static usbh_enum_t* enum_get(uint8_t daddr);
+static void enum_release(uint8_t daddr);
 static void process_remove_event(hcd_event_t *event);
 static void remove_device_tree(uint8_t rhport, uint8_t hub_addr, uint8_t hub_port);
 
 static bool usbh_edpt_control_open(uint8_t dev_addr, uint8_t max_packet_size);
 static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
 static void control_xfer_dispatch_pending(void);
-static void control_xfer_complete(uint8_t daddr, xfer_result_t result);
+static void control_xfer_complete(usbh_ctrl_xfer_info_t* ctrl_info, xfer_result_t result);
 
 TU_ATTR_ALWAYS_INLINE static inline usbh_device_t* get_device(uint8_t dev_addr) {
   TU_VERIFY(dev_addr > 0 && dev_addr <= TOTAL_DEVICES, NULL);
@@ -359,10 +411,63 @@ TU_ATTR_ALWAYS_INLINE static inline bool queue_event(hcd_event_t const * event,
   return true;
 }
 
-TU_ATTR_ALWAYS_INLINE static inline void control_xfer_set_stage(uint8_t stage) {
-  if (_usbh_data.ctrl_xfer_info.stage != stage) {
+TU_ATTR_ALWAYS_INLINE static inline tusb_control_request_t* control_xfer_request(usbh_ctrl_xfer_info_t const* ctrl_info) {
+  return &_usbh_epbuf.ctrl_request[ctrl_info - _usbh_data.ctrl_xfer_info].request;
+}
+
+// Get the slot of device's in-flight control transfer, NULL if none
+static usbh_ctrl_xfer_info_t* control_xfer_get(uint8_t daddr) {
+  for (uint8_t i = 0; i < USBH_CONTROL_XFER_MAX; i++) {
+    usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info[i];
+    if (ctrl_info->stage != CONTROL_STAGE_IDLE && ctrl_info->daddr == daddr) {
+      return ctrl_info;
+    }
+  }
+  return NULL;
+}
+
+static bool control_xfer_has_idle_slot(void) {
+  for (uint8_t i = 0; i < USBH_CONTROL_XFER_MAX; i++) {
+    if (_usbh_data.ctrl_xfer_info[i].stage == CONTROL_STAGE_IDLE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Claim an idle slot for device's control transfer. Fail if device already has one in flight or all slots are busy.
+// Must be called with _usbh_mutex locked
+static usbh_ctrl_xfer_info_t* control_xfer_claim(uint8_t daddr, tusb_control_request_t const* setup, uint8_t* buffer,
+                                                 tuh_xfer_cb_t complete_cb, uintptr_t user_data) {
+  if (control_xfer_get(daddr) != NULL) {
+    return NULL;
+  }
+
+  for (uint8_t i = 0; i < USBH_CONTROL_XFER_MAX; i++) {
+    usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info[i];
+    if (ctrl_info->stage == CONTROL_STAGE_IDLE) {
+      ctrl_info->stage        = CONTROL_STAGE_SETUP;
+      ctrl_info->daddr        = daddr;
+      ctrl_info->actual_len   = 0;
+      ctrl_info->failed_count = 0;
+      ctrl_info->buffer       = buffer;
+      ctrl_info->complete_cb  = complete_cb;
+      ctrl_info->user_data    = user_data;
+      _usbh_epbuf.ctrl_request[i].request = *setup;
+      return ctrl_info;
+    }
+  }
+
+  return NULL;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void control_xfer_set_stage(usbh_ctrl_xfer_info_t* ctrl_info, uint8_t stage) {
+  if (ctrl_info->stage != stage) {
     (void) osal_mutex_lock(_usbh_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
-    _usbh_data.ctrl_xfer_info.stage = stage;
+    ctrl_info->stage = stage;
+    if (stage == CONTROL_STAGE_IDLE) {
+      _usbh_data.ctrl_pending_scan = true;
+    }
     (void) osal_mutex_unlock(_usbh_mutex);
   }
 }
@@ -387,9 +492,9 @@ TU_ATTR_ALWAYS_INLINE static inline void usbh_device_close(uint8_t rhport, uint8
   (void) osal_mutex_unlock(_usbh_mutex);
 
   // If this device has in-flight control xfer, complete as FAILED
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
-  if (daddr == ctrl_info->daddr && ctrl_info->stage != CONTROL_STAGE_IDLE) {
-    control_xfer_complete(daddr, XFER_RESULT_FAILED);
+  usbh_ctrl_xfer_info_t* ctrl_info = control_xfer_get(daddr);
+  if (ctrl_info != NULL) {
+    control_xfer_complete(ctrl_info, XFER_RESULT_FAILED);
   }
 
   // invalidate if enumerating
@@ -400,6 +505,12 @@ TU_ATTR_ALWAYS_INLINE static inline void usbh_device_close(uint8_t rhport, uint8
       _usbh_data.call_after.func = NULL;
     }
   }
+  enum_release(daddr);
+}
+
+// Attached device can start enumerating: no device in address 0 stage and an enumeration slot is free
+TU_ATTR_ALWAYS_INLINE static inline bool enum_is_ready(void) {
+  return _usbh_data.enumerating_daddr == TUSB_INDEX_INVALID_8 && enum_get(TUSB_INDEX_INVALID_8) != NULL;
 }
 
 //--------------------------------------------------------------------+
@@ -450,6 +561,14 @@ tusb_speed_t tuh_speed_get(uint8_t daddr) {
   return (tusb_speed_t)bus_info.speed;
 }
 
+bool tuh_enum_time_get(uint8_t daddr, uint32_t* time_ms) {
+  *time_ms = 0;
+  usbh_device_t const* dev = get_device(daddr);
+  TU_VERIFY(dev && dev->configured);
+  *time_ms = dev->enum_time_ms;
+  return true;
+}
+
 bool tuh_rhport_is_active(uint8_t rhport) {
   return _usbh_controller_id == rhport;
 }
@@ -543,6 +662,9 @@ bool tuh_rhport_init(uint8_t rhport, const tusb_rhport_init_t* rh_init) {
 
     _usbh_controller_id = TUSB_INDEX_INVALID_8;
     _usbh_data.enumerating_daddr = TUSB_INDEX_INVALID_8;
+    for (uint8_t i = 0; i < CFG_TUH_ENUMERATION_MAX; i++) {
+      _usbh_data.enumeration[i].daddr = TUSB_INDEX_INVALID_8;
+    }
 
     for (uint8_t i = 0; i < TOTAL_DEVICES; i++) {
       clear_device(&_usbh_devices[i]);
@@ -638,15 +760,13 @@ bool tuh_task_event_ready(void) {
   }
 
   #if CFG_TUH_HUB
-  if (_usbh_data.enumerating_daddr == TUSB_INDEX_INVALID_8 &&
-      !osal_queue_empty(_usbh_daq)) {
+  if (enum_is_ready() && !osal_queue_empty(_usbh_daq)) {
     return true;
   }
   #endif
 
-  // Pending control xfer waiting for an idle slot
-  if (_usbh_data.ctrl_xfer_info.stage == CONTROL_STAGE_IDLE &&
-      !tu_fifo_empty(&_usbh_pending_ctrl_q)) {
+  // Pending control xfer waiting for a released slot
+  if (_usbh_data.ctrl_pending_scan && !tu_fifo_empty(&_usbh_pending_ctrl_q)) {
     return true;
   }
 
@@ -725,20 +845,19 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
 
     // Drain pending async control xfers. Slot transitions and dispatch are
     // decoupled: completion / abort / device_close set stage = IDLE via
-    // control_xfer_set_stage() and the actual FIFO drain happens here in the
-    // event loop. The check is a fast non-mutex sanity gate; the dispatcher
-    // itself re-checks under the mutex.
-    if (_usbh_data.ctrl_xfer_info.stage == CONTROL_STAGE_IDLE &&
-        !tu_fifo_empty(&_usbh_pending_ctrl_q)) {
+    // control_xfer_set_stage() (which also sets ctrl_pending_scan) and the
+    // actual FIFO drain happens here in the event loop. The check is a fast
+    // non-mutex sanity gate; the dispatcher itself re-checks under the mutex.
+    if (_usbh_data.ctrl_pending_scan && !tu_fifo_empty(&_usbh_pending_ctrl_q)) {
       control_xfer_dispatch_pending();
     }
 
     hcd_event_t event;
 
   #if CFG_TUH_HUB
-    // Get deferred device attachments if none is enumerating
+    // Get deferred device attachments if a new enumeration can start
     bool has_deferred_attach = false;
-    if (_usbh_data.enumerating_daddr == TUSB_INDEX_INVALID_8) {
+    if (enum_is_ready()) {
       // zero wait to avoid blocking the main event queue
       has_deferred_attach = osal_queue_receive(_usbh_daq, &event, 0);
     }
@@ -758,16 +877,15 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
         // Force remove currently mounted with the same bus info (rhport, hub addr, hub port) if exists
         process_remove_event(&event);
 
-        // due to the shared control buffer, we must fully complete enumerating one device first.
-        if (_usbh_data.enumerating_daddr == TUSB_INDEX_INVALID_8) {
+        // only one device can be at address 0, it must be addressed before enumerating another one.
+        if (enum_is_ready()) {
           // New device attached and we are ready
           TU_LOG_USBH("[%u:] USBH Device Attach\r\n", event.rhport);
-          _usbh_data.enumerating_daddr = 0; // enumerate new device with address 0
           enum_new_device(&event);
         }
   #if CFG_TUH_HUB
         else {
-          TU_LOG_USBH("[%u:] USBH Defer Attach until current enumeration complete\r\n", event.rhport);
+          TU_LOG_USBH("[%u:] USBH Defer Attach until current address 0 stage complete\r\n", event.rhport);
           TU_ASSERT(osal_queue_send(_usbh_daq, &event, in_isr), );
         }
   #endif
@@ -874,7 +992,7 @@ static void control_xfer_sync_complete(tuh_xfer_t* xfer) {
 bool tuh_control_xfer (tuh_xfer_t* xfer) {
   const uint8_t daddr = xfer->daddr;
   TU_VERIFY(daddr <= TOTAL_DEVICES && xfer->ep_addr == 0 && xfer->setup); // EP0 with setup packet
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
+  usbh_ctrl_xfer_info_t* ctrl_info = NULL;
 
 #if CFG_TUSB_OS_HAS_SCHEDULER
   // Sync (complete_cb == NULL) from a host-stack callback is forbidden on
@@ -886,30 +1004,23 @@ bool tuh_control_xfer (tuh_xfer_t* xfer) {
               osal_task_get_current_handle() == _usbh_data.task_hdl));
 #endif
 
-  // Slot is single-threaded — when busy, sync callers block until it frees
-  // (blocking semantics require the result); async callers get queued in the
-  // pending FIFO and submitted by control_xfer_complete() when the slot
-  // drains. The test-and-{claim|enqueue} is one critical section so a slot
-  // that becomes IDLE between the check and the enqueue can't strand an async
+  // A slot is claimed when the device has no control xfer in flight and a slot
+  // is idle. Otherwise sync callers block until one frees (blocking semantics
+  // require the result); async callers get queued in the pending FIFO and
+  // submitted by control_xfer_dispatch_pending() when a slot is released.
+  // The test-and-{claim|enqueue} is one critical section so a slot that
+  // becomes IDLE between the check and the enqueue can't strand an async
   // request in a queue nothing else drains.
   const bool is_nonblocking = (xfer->complete_cb != NULL);
   while (true) {
     TU_VERIFY(tuh_connected(daddr));
-    bool claimed = false;
     bool is_queued = false;
     (void) osal_mutex_lock(_usbh_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
-    if (ctrl_info->stage == CONTROL_STAGE_IDLE) {
-      ctrl_info->stage        = CONTROL_STAGE_SETUP;
-      ctrl_info->daddr        = daddr;
-      ctrl_info->actual_len   = 0;
-      ctrl_info->failed_count = 0;
-
-      ctrl_info->buffer       = xfer->buffer;
-      ctrl_info->complete_cb  = xfer->complete_cb;
-      ctrl_info->user_data    = xfer->user_data;
-      _usbh_epbuf.request     = (*xfer->setup);
-      claimed = true;
-    } else if (is_nonblocking) {
+    // Don't overtake pending transfers, otherwise a callback chain (e.g enumeration) can starve other devices
+    if (tu_fifo_empty(&_usbh_pending_ctrl_q)) {
+      ctrl_info = control_xfer_claim(daddr, xfer->setup, xfer->buffer, xfer->complete_cb, xfer->user_data);
+    }
+    if (ctrl_info == NULL && is_nonblocking) {
       // Async + busy: queue the transfer.
       const usbh_pending_ctrl_t entry = {
         .setup       = *xfer->setup,
@@ -920,11 +1031,14 @@ bool tuh_control_xfer (tuh_xfer_t* xfer) {
         .daddr_gen   = _usbh_data.daddr_gen[daddr]
       };
       is_queued = tu_fifo_write_n(&_usbh_pending_ctrl_q, &entry, sizeof(entry)) == sizeof(entry);
+      if (is_queued && control_xfer_has_idle_slot()) {
+        _usbh_data.ctrl_pending_scan = true; // dispatch in next tuh_task()
+      }
     }
 
     (void) osal_mutex_unlock(_usbh_mutex);
 
-    if (claimed) {
+    if (ctrl_info != NULL) {
       break;
     }
 
@@ -956,14 +1070,14 @@ bool tuh_control_xfer (tuh_xfer_t* xfer) {
     ctrl_info->complete_cb = control_xfer_sync_complete;
   }
 
-  if (!hcd_setup_send(usbh_get_rhport(daddr), daddr, (uint8_t const *) &_usbh_epbuf.request)) {
-    control_xfer_set_stage(CONTROL_STAGE_IDLE);
+  if (!hcd_setup_send(usbh_get_rhport(daddr), daddr, (uint8_t const *) control_xfer_request(ctrl_info))) {
+    control_xfer_set_stage(ctrl_info, CONTROL_STAGE_IDLE);
     return false;
   }
 
   if (!is_nonblocking) {
     // No tuh_connected() escape needed: usbh_device_close() routes through
-    // control_xfer_complete(daddr, FAILED) on disconnect, which fires
+    // control_xfer_complete(FAILED) on disconnect, which fires
     // sync_complete and unblocks this poll.
     while (sync_state.result == XFER_RESULT_INVALID) {
 #if CFG_TUSB_OS_HAS_SCHEDULER
@@ -984,30 +1098,34 @@ bool tuh_control_xfer (tuh_xfer_t* xfer) {
   return true;
 }
 
-// Start control transfer from pending fifo
+// Start control transfers from pending fifo
 static void control_xfer_dispatch_pending(void) {
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
-
   while (true) {
     usbh_pending_ctrl_t xfer;
-    bool has_xfer = false;
+    usbh_ctrl_xfer_info_t* ctrl_info = NULL;
 
     (void) osal_mutex_lock(_usbh_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
-    if (ctrl_info->stage == CONTROL_STAGE_IDLE &&
-        tu_fifo_read_n(&_usbh_pending_ctrl_q, &xfer, sizeof(xfer)) == sizeof(xfer)) {
-      ctrl_info->stage        = CONTROL_STAGE_SETUP;
-      ctrl_info->daddr        = xfer.daddr;
-      ctrl_info->actual_len   = 0;
-      ctrl_info->failed_count = 0;
-      ctrl_info->buffer       = xfer.buffer;
-      ctrl_info->complete_cb  = xfer.complete_cb;
-      ctrl_info->user_data    = xfer.user_data;
-      _usbh_epbuf.request     = xfer.setup;
-      has_xfer = true;
+    _usbh_data.ctrl_pending_scan = false;
+    if (control_xfer_has_idle_slot()) {
+      // Rotate the FIFO once and claim the first entry whose device is not busy. Other entries are written back in
+      // the same order so transfers of a device are still submitted in order.
+      uint16_t count = tu_fifo_count(&_usbh_pending_ctrl_q) / sizeof(usbh_pending_ctrl_t);
+      for (; count > 0 && ctrl_info == NULL; count--) {
+        (void) tu_fifo_read_n(&_usbh_pending_ctrl_q, &xfer, sizeof(xfer));
+        ctrl_info = control_xfer_claim(xfer.daddr, &xfer.setup, xfer.buffer, xfer.complete_cb, xfer.user_data);
+        if (ctrl_info == NULL) {
+          (void) tu_fifo_write_n(&_usbh_pending_ctrl_q, &xfer, sizeof(xfer));
+        }
+      }
+      for (; count > 0; count--) {
+        usbh_pending_ctrl_t entry;
+        (void) tu_fifo_read_n(&_usbh_pending_ctrl_q, &entry, sizeof(entry));
+        (void) tu_fifo_write_n(&_usbh_pending_ctrl_q, &entry, sizeof(entry));
+      }
     }
     (void) osal_mutex_unlock(_usbh_mutex);
 
-    if (!has_xfer) {
+    if (ctrl_info == NULL) {
       return; // nothing to do
     }
 
@@ -1018,24 +1136,23 @@ static void control_xfer_dispatch_pending(void) {
                   (xfer.setup.bmRequestType_bit.type == TUSB_REQ_TYPE_STANDARD && xfer.setup.bRequest <= TUSB_REQ_SYNCH_FRAME) ?
                       tu_str_std_request[xfer.setup.bRequest] : "Class Request");
       TU_LOG_BUF_USBH(&xfer.setup, 8);
-      if (hcd_setup_send(usbh_get_rhport(xfer.daddr), xfer.daddr, (uint8_t const *) &_usbh_epbuf.request)) {
-        return; // transfer kicked-off, we are done
+      if (hcd_setup_send(usbh_get_rhport(xfer.daddr), xfer.daddr, (uint8_t const *) control_xfer_request(ctrl_info))) {
+        continue; // transfer kicked-off, dispatch next one if there is another idle slot
       }
     }
 
     // complete callback as FAILED and continue with next pending xfer
-    control_xfer_complete(xfer.daddr, XFER_RESULT_FAILED);
+    control_xfer_complete(ctrl_info, XFER_RESULT_FAILED);
   }
 }
 
-static void control_xfer_complete(uint8_t daddr, xfer_result_t result) {
+static void control_xfer_complete(usbh_ctrl_xfer_info_t* ctrl_info, xfer_result_t result) {
   TU_LOG_USBH("\r\n");
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
 
   // duplicate xfer since user can execute control transfer within callback
-  tusb_control_request_t const request = _usbh_epbuf.request;
+  tusb_control_request_t const request = *control_xfer_request(ctrl_info);
   tuh_xfer_t xfer_temp = {
-    .daddr       = daddr,
+    .daddr       = ctrl_info->daddr,
     .ep_addr     = 0,
     .result      = result,
     .setup       = &request,
@@ -1046,7 +1163,7 @@ static void control_xfer_complete(uint8_t daddr, xfer_result_t result) {
   };
 
   // set to IDLE before callback since cb can invoke another transfer
-  control_xfer_set_stage(CONTROL_STAGE_IDLE);
+  control_xfer_set_stage(ctrl_info, CONTROL_STAGE_IDLE);
 
   if (xfer_temp.complete_cb != NULL) {
     xfer_temp.complete_cb(&xfer_temp);
@@ -1057,20 +1174,19 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
   (void) ep_addr;
 
   const uint8_t rhport = usbh_get_rhport(daddr);
-  tusb_control_request_t const * request = &_usbh_epbuf.request;
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
+  usbh_ctrl_xfer_info_t* ctrl_info = control_xfer_get(daddr);
 
   // Drop stale completions: slot already released (abort/close fired its cb)
-  // or now owns a different device's xfer (a pending entry was dispatched).
-  if (ctrl_info->stage == CONTROL_STAGE_IDLE || ctrl_info->daddr != daddr) {
+  if (ctrl_info == NULL) {
     return true;
   }
+  tusb_control_request_t const * request = control_xfer_request(ctrl_info);
 
   switch (result) {
     case XFER_RESULT_STALLED:
       TU_LOG_USBH("[%u:%u] Control STALLED, xferred_bytes = %" PRIu32 "\r\n", rhport, daddr, xferred_bytes);
       TU_LOG_BUF_USBH(request, 8);
-      control_xfer_complete(daddr, result);
+      control_xfer_complete(ctrl_info, result);
     break;
 
     case XFER_RESULT_FAILED:
@@ -1083,13 +1199,13 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
         (void) osal_mutex_unlock(_usbh_mutex);
 
         if (!hcd_setup_send(rhport, daddr, (uint8_t const *) request)) {
-          control_xfer_complete(daddr, XFER_RESULT_FAILED);
+          control_xfer_complete(ctrl_info, XFER_RESULT_FAILED);
           return false;
         }
       } else {
         TU_LOG_USBH("[%u:%u] Control FAILED, xferred_bytes = %" PRIu32 "\r\n", rhport, daddr, xferred_bytes);
         TU_LOG_BUF_USBH(request, 8);
-        control_xfer_complete(daddr, result);
+        control_xfer_complete(ctrl_info, result);
       }
     break;
 
@@ -1098,7 +1214,7 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
         case CONTROL_STAGE_SETUP:
           if (request->wLength > 0) {
             // DATA stage: initial data toggle is always 1
-            control_xfer_set_stage(CONTROL_STAGE_DATA);
+            control_xfer_set_stage(ctrl_info, CONTROL_STAGE_DATA);
             const uint8_t ep_data = tu_edpt_addr(0, request->bmRequestType_bit.direction);
             TU_ASSERT(hcd_edpt_xfer(rhport, daddr, ep_data, ctrl_info->buffer, request->wLength));
             return true;
@@ -1113,7 +1229,7 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
             ctrl_info->actual_len = (uint16_t) xferred_bytes;
 
             // ACK stage: toggle is always 1
-            control_xfer_set_stage(CONTROL_STAGE_ACK);
+            control_xfer_set_stage(ctrl_info, CONTROL_STAGE_ACK);
             const uint8_t ep_status = tu_edpt_addr(0, 1 - request->bmRequestType_bit.direction);
             TU_ASSERT(hcd_edpt_xfer(rhport, daddr, ep_status, NULL, 0));
             break;
@@ -1130,7 +1246,7 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
             }
           }
 
-          control_xfer_complete(daddr, result);
+          control_xfer_complete(ctrl_info, result);
           break;
         }
 
@@ -1155,7 +1271,7 @@ bool tuh_edpt_xfer(tuh_xfer_t* xfer) {
   TU_VERIFY(daddr && ep_addr);
   TU_VERIFY(usbh_edpt_claim(daddr, ep_addr));
 
-  if (!usbh_edpt_xfer_with_callback(daddr, ep_addr, xfer->buffer, (uint16_t) xfer->buflen,
+  if (!usbh_edpt_xfer_with_callback(daddr, ep_addr, xfer->buffer, xfer->buflen,
                                     xfer->complete_cb, xfer->user_data)) {
     usbh_edpt_release(daddr, ep_addr);
     return false;
@@ -1173,11 +1289,11 @@ bool tuh_edpt_abort_xfer(uint8_t daddr, uint8_t ep_addr) {
     // Also include dev0 for aborting enumerating
     const uint8_t rhport = usbh_get_rhport(daddr);
 
-    // control transfer: only 1 control at a time, check if we are aborting the current one
-    const usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
-    TU_VERIFY(daddr == ctrl_info->daddr && ctrl_info->stage != CONTROL_STAGE_IDLE);
+    // control transfer: only 1 control per device at a time, check if it is in flight
+    usbh_ctrl_xfer_info_t* ctrl_info = control_xfer_get(daddr);
+    TU_VERIFY(ctrl_info != NULL);
     hcd_edpt_abort_xfer(rhport, daddr, ep_addr);
-    control_xfer_complete(daddr, XFER_RESULT_ABORTED);
+    control_xfer_complete(ctrl_info, XFER_RESULT_ABORTED);
   } else {
     usbh_device_t* dev = get_device(daddr);
     TU_VERIFY(dev);
@@ -1185,6 +1301,9 @@ bool tuh_edpt_abort_xfer(uint8_t daddr, uint8_t ep_addr) {
     TU_VERIFY(dev->ep_status[epnum][dir] & TU_EDPT_STATE_BUSY); // non-control skip if not busy
     // abort then mark as ready and release endpoint
     hcd_edpt_abort_xfer(dev->bus_info.rhport, daddr, ep_addr);
+  #if USBH_XFER_CHUNK_ENABLED
+    tu_varclr(&dev->ep_chunk[epnum][dir]);
+  #endif
     dev->ep_status[epnum][dir] &= (uint8_t) ~TU_EDPT_STATE_BUSY; // clear busy
     tu_edpt_release(&dev->ep_status[epnum][dir], _usbh_mutex);
   }
@@ -1202,8 +1321,10 @@ uint8_t usbh_get_rhport(uint8_t daddr) {
   return bus_info.rhport;
 }
 
-uint8_t *usbh_get_enum_buf(void) {
-  return _usbh_epbuf.ctrl;
+uint8_t *usbh_get_enum_buf(uint8_t daddr) {
+  const usbh_enum_t* enum_info = enum_get(daddr);
+  TU_VERIFY(enum_info != NULL, NULL);
+  return _usbh_epbuf.enum_buf[enum_info - _usbh_data.enumeration].buf;
 }
 
 void usbh_int_set(bool enabled) {
@@ -1266,7 +1387,7 @@ bool usbh_edpt_release(uint8_t dev_addr, uint8_t ep_addr) {
 }
 
 // Submit an transfer
-bool usbh_edpt_xfer_with_callback(uint8_t dev_addr, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes,
+bool usbh_edpt_xfer_with_callback(uint8_t dev_addr, uint8_t ep_addr, uint8_t* buffer, uint32_t total_bytes,
                                   tuh_xfer_cb_t complete_cb, uintptr_t user_data) {
   (void) complete_cb;
   (void) user_data;
@@ -1278,7 +1399,7 @@ bool usbh_edpt_xfer_with_callback(uint8_t dev_addr, uint8_t ep_addr, uint8_t* bu
   uint8_t const dir = tu_edpt_dir(ep_addr);
   volatile uint8_t* ep_state = &dev->ep_status[epnum][dir];
 
-  TU_LOG_USBH("  Queue EP %02X with %u bytes ... \r\n", ep_addr, total_bytes);
+  TU_LOG_USBH("  Queue EP %02X with %lu bytes ... \r\n", ep_addr, (unsigned long) total_bytes);
 
   // Attempt to transfer on a busy endpoint, sound like an race condition !
   TU_ASSERT((*ep_state & TU_EDPT_STATE_BUSY) == 0);
@@ -1292,7 +1413,16 @@ bool usbh_edpt_xfer_with_callback(uint8_t dev_addr, uint8_t ep_addr, uint8_t* bu
   dev->ep_callback[epnum][dir].user_data   = user_data;
 #endif
 
-  if (hcd_edpt_xfer(dev->bus_info.rhport, dev_addr, ep_addr, buffer, total_bytes)) {
+#if USBH_XFER_CHUNK_ENABLED
+  uint32_t const xact_len = (total_bytes > TUP_HCD_EDPT_XFER_MAX) ? USBH_XFER_CHUNK_SIZE : total_bytes;
+  dev->ep_chunk[epnum][dir].buffer = buffer + xact_len;
+  dev->ep_chunk[epnum][dir].remaining = total_bytes - xact_len;
+  dev->ep_chunk[epnum][dir].xferred = 0;
+#else
+  uint32_t const xact_len = total_bytes;
+#endif
+
+  if (hcd_edpt_xfer(dev->bus_info.rhport, dev_addr, ep_addr, buffer, xact_len)) {
     TU_LOG_USBH("OK\r\n");
     return true;
   } else {
@@ -1360,7 +1490,39 @@ bool tuh_bus_info_get(uint8_t daddr, tuh_bus_info_t* bus_info) {
   return true;
 }
 
+#if USBH_XFER_CHUNK_ENABLED
+// Queue next chunk of a split transfer in ISR context. Return false if the whole transfer is complete: short packet,
+// error or no more remaining bytes.
+TU_ATTR_FAST_FUNC static bool xfer_chunk_next(usbh_device_t* dev, uint8_t daddr, uint8_t ep_addr, xfer_result_t result,
+                                              uint32_t len) {
+  usbh_xfer_chunk_t* chunk = &dev->ep_chunk[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+
+  if (result != XFER_RESULT_SUCCESS || len != USBH_XFER_CHUNK_SIZE || chunk->remaining == 0) {
+    chunk->remaining = 0;
+    return false;
+  }
+
+  uint32_t const xact_len = tu_min32(chunk->remaining, USBH_XFER_CHUNK_SIZE);
+  uint8_t* const buffer = chunk->buffer;
+  chunk->xferred += len;
+  chunk->buffer += xact_len;
+  chunk->remaining -= xact_len;
+
+  if (!hcd_edpt_xfer(dev->bus_info.rhport, daddr, ep_addr, buffer, xact_len)) {
+    // HCD refused, complete with what is transferred so far
+    chunk->remaining = 0;
+    return false;
+  }
+
+  return true;
+}
+#endif
+
 TU_ATTR_FAST_FUNC void hcd_event_handler(hcd_event_t const* event, bool in_isr) {
+#if USBH_XFER_CHUNK_ENABLED
+  hcd_event_t event_chunk;
+#endif
+
   switch (event->event_id) {
     case HCD_EVENT_DEVICE_ATTACH:
     case HCD_EVENT_DEVICE_REMOVE:
@@ -1377,6 +1539,28 @@ TU_ATTR_FAST_FUNC void hcd_event_handler(hcd_event_t const* event, bool in_isr)
       }
       break;
 
+#if USBH_XFER_CHUNK_ENABLED
+    case HCD_EVENT_XFER_COMPLETE: {
+      uint8_t const ep_addr = event->xfer_complete.ep_addr;
+      usbh_device_t* dev = get_device(event->dev_addr);
+      if (dev != NULL && tu_edpt_number(ep_addr) != 0) {
+        usbh_xfer_chunk_t* chunk = &dev->ep_chunk[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+        if (chunk->remaining || chunk->xferred) {
+          if (xfer_chunk_next(dev, event->dev_addr, ep_addr, (xfer_result_t) event->xfer_complete.result,
+                              event->xfer_complete.len)) {
+            return; // next chunk is queued
+          }
+          // whole transfer is complete, report total length
+          event_chunk = *event;
+          event_chunk.xfer_complete.len += chunk->xferred;
+          chunk->xferred = 0;
+          event = &event_chunk;
+        }
+      }
+      break;
+    }
+#endif
+
     default:
       // nothing to do
       break;
@@ -1657,8 +1841,9 @@ static void remove_device_tree(uint8_t rhport, uint8_t hub_addr, uint8_t hub_por
 //--------------------------------------------------------------------+
 // Enumeration Process
 // is a lengthy process with a series of control transfer to configure newly attached device.
-// NOTE: due to the shared control buffer, we must complete enumerating
-// one device before enumerating another one.
+// NOTE: only one device can be in address 0 stage (debounce, reset, set address and its recovery) at a time.
+// Once addressed, the rest (descriptors, set configuration, drivers) runs concurrently with other devices, up to
+// CFG_TUH_ENUMERATION_MAX each with its own enumeration buffer.
 //--------------------------------------------------------------------+
 enum {                                      // USB 2.0 specs 7.1.7 for timing
   ENUM_DEBOUNCING_DELAY_MS           = 150, // T(ATTDB)  minimum 100 ms for stable connection
@@ -1695,7 +1880,7 @@ enum {
 
 static uint8_t enum_get_new_address(bool is_hub);
 static bool    enum_parse_configuration_desc(uint8_t dev_addr, const tusb_desc_configuration_t *desc_cfg);
-static void    enum_full_complete(bool success);
+static void    enum_full_complete(uint8_t daddr, bool success);
 static void    process_enumeration(tuh_xfer_t *xfer);
 
 enum {
@@ -1726,7 +1911,7 @@ static void enum_delay_async(uintptr_t state) {
         _usbh_data.attach_debouncing_bm &= (uint8_t)~TU_BIT(dev0_bus->rhport); // clear roothub debouncing delay
         if (!hcd_port_connect_status(dev0_bus->rhport)) {
           TU_LOG_USBH("Device unplugged while debouncing\r\n");
-          enum_full_complete(false);
+          enum_full_complete(0, false);
           return;
         }
         hcd_port_reset(dev0_bus->rhport); // reset port
@@ -1742,7 +1927,7 @@ static void enum_delay_async(uintptr_t state) {
     case ENUM_AFTER_RESET_ROOT_POST_DELAY:
       if (!hcd_port_connect_status(dev0_bus->rhport)) {
         // device unplugged while delaying
-        enum_full_complete(false);
+        enum_full_complete(0, false);
         return;
       }
 
@@ -1771,12 +1956,12 @@ static void enum_delay_async(uintptr_t state) {
       // TODO probably doesn't need to open/close each enumeration
       if (!usbh_edpt_control_open(0, 8)) {
         TU_LOG_USBH("Failed to open dev0's control endpoint\r\n");
-        enum_full_complete(false); // Stop enumeration gracefully
+        enum_full_complete(0, false); // Stop enumeration gracefully
         return;
       }
       // Get first 8 bytes of device descriptor for control endpoint size
       TU_LOG_USBH("Get 8 byte of Device Descriptor\r\n");
-      TU_ASSERT(tuh_descriptor_get_device(0, _usbh_epbuf.ctrl, 8, process_enumeration, ENUM_SET_ADDR), );
+      TU_ASSERT(tuh_descriptor_get_device(0, usbh_get_enum_buf(0), 8, process_enumeration, ENUM_SET_ADDR), );
       break;
 
     case ENUM_AFTER_SET_ADDRESS_RECOVERY_DELAY: {
@@ -1786,12 +1971,21 @@ static void enum_delay_async(uintptr_t state) {
       if (!usbh_edpt_control_open(new_addr, new_dev->desc_device.bMaxPacketSize0)) {
         TU_LOG_USBH("Failed to open new device's control endpoint\r\n");
         clear_device(new_dev);
-        enum_full_complete(false);
+        enum_full_complete(new_addr, false);
         return;
       }
       TU_LOG_USBH("Get Device Descriptor\r\n");
-      TU_ASSERT(tuh_descriptor_get_device(new_addr, _usbh_epbuf.ctrl, sizeof(tusb_desc_device_t), process_enumeration,
-                                          ENUM_GET_STRING_LANGUAGE_ID_LEN), );
+      TU_ASSERT(tuh_descriptor_get_device(new_addr, usbh_get_enum_buf(new_addr), sizeof(tusb_desc_device_t),
+                                          process_enumeration, ENUM_GET_STRING_LANGUAGE_ID_LEN), );
+
+      // Address 0 stage is complete, next attached device can start while this one continues
+      _usbh_data.enumerating_daddr = TUSB_INDEX_INVALID_8;
+  #if CFG_TUH_HUB
+      // get next hub status now since device can be unplugged before set_configure() is complete
+      if (new_dev->bus_info.hub_addr != 0) {
+        hub_edpt_status_xfer(new_dev->bus_info.hub_addr);
+      }
+  #endif
       break;
     }
 
@@ -1800,8 +1994,31 @@ static void enum_delay_async(uintptr_t state) {
   }
 }
 
+// Get enumeration of a device, TUSB_INDEX_INVALID_8 to get a free one
+static usbh_enum_t* enum_get(uint8_t daddr) {
+  for (uint8_t i = 0; i < CFG_TUH_ENUMERATION_MAX; i++) {
+    if (_usbh_data.enumeration[i].daddr == daddr) {
+      return &_usbh_data.enumeration[i];
+    }
+  }
+  return NULL;
+}
+
+static void enum_release(uint8_t daddr) {
+  usbh_enum_t* enum_info = enum_get(daddr);
+  if (enum_info != NULL) {
+    enum_info->daddr = TUSB_INDEX_INVALID_8;
+  }
+}
+
 // start a new enumeration process
 static void enum_new_device(hcd_event_t *event) {
+  usbh_enum_t* enum_info = enum_get(TUSB_INDEX_INVALID_8);
+  TU_ASSERT(enum_info != NULL, );
+  enum_info->daddr    = 0; // enumerate new device with address 0
+  enum_info->start_ms = tusb_time_millis_api();
+  _usbh_data.enumerating_daddr = 0;
+
   tuh_bus_info_t *dev0_bus = &_usbh_data.dev0_bus;
   dev0_bus->rhport         = event->rhport;
   dev0_bus->hub_addr       = event->connection.hub_addr;
@@ -1811,15 +2028,19 @@ static void enum_new_device(hcd_event_t *event) {
 
 // process device enumeration
 static void process_enumeration(tuh_xfer_t *xfer) {
+  const uint8_t   daddr = xfer->daddr;
+  const uintptr_t state = xfer->user_data;
+  // transfers in address 0 stage are sent to address 0 or its parent hub
+  const uint8_t enum_daddr = (state < ENUM_GET_STRING_LANGUAGE_ID_LEN) ? 0 : daddr;
   if (XFER_RESULT_FAILED == xfer->result) {
-    enum_full_complete(false); // failed to enum
+    enum_full_complete(enum_daddr, false); // failed to enum
     return;
   }
 
-  const uint8_t   daddr    = xfer->daddr;
-  const uintptr_t state    = xfer->user_data;
   usbh_device_t  *dev      = get_device(daddr);
   tuh_bus_info_t *dev0_bus = &_usbh_data.dev0_bus;
+  uint8_t        *enum_buf = usbh_get_enum_buf(enum_daddr);
+  TU_VERIFY(enum_buf != NULL,); // enumeration is aborted e.g device is unplugged
   if (daddr > 0) {
     TU_ASSERT(dev != NULL,);
   }
@@ -1888,7 +2109,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       break;
 
     case ENUM_SET_ADDR: {
-      const tusb_desc_device_t *desc_device = (const tusb_desc_device_t *) _usbh_epbuf.ctrl;
+      const tusb_desc_device_t *desc_device = (const tusb_desc_device_t *) enum_buf;
       if (!(desc_device->bDescriptorType == TUSB_DESC_DEVICE && desc_device->bMaxPacketSize0 >= 8)) {
         TU_LOG_USBH("Invalid Device descriptor\r\n");
         is_enum_failed = true;
@@ -1913,6 +2134,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       TU_ASSERT(new_dev, );
       new_dev->addressed           = 1;
       _usbh_data.enumerating_daddr = new_addr;
+      enum_get(0)->daddr           = new_addr; // enumeration and its buffer now belong to new address
 
       usbh_device_close(dev0_bus->rhport, 0); // close dev0
       usbh_defer_func_ms_async(ENUM_SET_ADDRESS_RECOVERY_DELAY_MS, enum_delay_async, ENUM_AFTER_SET_ADDRESS_RECOVERY_DELAY);
@@ -1923,30 +2145,30 @@ static void process_enumeration(tuh_xfer_t *xfer) {
     // to determine the length first. otherwise, some device may have buffer overflow.
     case ENUM_GET_STRING_LANGUAGE_ID_LEN: {
       // save the received device descriptor
-      tusb_desc_device_t const *desc_device = (tusb_desc_device_t const *) _usbh_epbuf.ctrl;
+      tusb_desc_device_t const *desc_device = (tusb_desc_device_t const *) enum_buf;
 
       memcpy(&dev->desc_device, (const uint8_t*) desc_device + offsetof(tusb_desc_device_t, bcdUSB), sizeof(desc_device_noheader_t));
 
       tuh_enum_descriptor_device_cb(daddr, desc_device); // callback
-      tuh_descriptor_get_string_langid(daddr, _usbh_epbuf.ctrl, 2,
+      tuh_descriptor_get_string_langid(daddr, enum_buf, 2,
                                        process_enumeration, ENUM_GET_STRING_LANGUAGE_ID);
       break;
     }
 
     case ENUM_GET_STRING_LANGUAGE_ID: {
       const uint8_t str_len = xfer->buffer[0];
-      tuh_descriptor_get_string_langid(daddr, _usbh_epbuf.ctrl, str_len,
+      tuh_descriptor_get_string_langid(daddr, enum_buf, str_len,
                                        process_enumeration, ENUM_GET_STRING_MANUFACTURER_LEN);
       break;
     }
 
     case ENUM_GET_STRING_MANUFACTURER_LEN: {
-      const tusb_desc_string_t* desc_langid = (const tusb_desc_string_t *) _usbh_epbuf.ctrl;
+      const tusb_desc_string_t* desc_langid = (const tusb_desc_string_t *) enum_buf;
       if (desc_langid->bLength >= 4) {
         langid = tu_le16toh(desc_langid->utf16le[0]); // previous request is langid
       }
       if (dev->desc_device.iManufacturer != 0) {
-        tuh_descriptor_get_string(daddr, dev->desc_device.iManufacturer, langid, _usbh_epbuf.ctrl, 2,
+        tuh_descriptor_get_string(daddr, dev->desc_device.iManufacturer, langid, enum_buf, 2,
                                   process_enumeration, ENUM_GET_STRING_MANUFACTURER);
         break;
       }
@@ -1957,7 +2179,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       if (dev->desc_device.iManufacturer != 0)  {
         langid = tu_le16toh(xfer->setup->wIndex); // langid from length's request
         const uint8_t str_len = xfer->buffer[0];
-        tuh_descriptor_get_string(daddr, dev->desc_device.iManufacturer, langid, _usbh_epbuf.ctrl, str_len,
+        tuh_descriptor_get_string(daddr, dev->desc_device.iManufacturer, langid, enum_buf, str_len,
                                   process_enumeration, ENUM_GET_STRING_PRODUCT_LEN);
         break;
       }
@@ -1970,7 +2192,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
           langid = tu_le16toh(xfer->setup->wIndex); // get langid from previous setup packet if not fall through
         }
         tuh_descriptor_get_string(
-            daddr, dev->desc_device.iProduct, langid, _usbh_epbuf.ctrl, 2, process_enumeration, ENUM_GET_STRING_PRODUCT);
+            daddr, dev->desc_device.iProduct, langid, enum_buf, 2, process_enumeration, ENUM_GET_STRING_PRODUCT);
         break;
       }
       TU_ATTR_FALLTHROUGH;
@@ -1980,7 +2202,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       if (dev->desc_device.iProduct != 0) {
         langid = tu_le16toh(xfer->setup->wIndex); // langid from length's request
         const uint8_t str_len = xfer->buffer[0];
-        tuh_descriptor_get_string(daddr, dev->desc_device.iProduct, langid, _usbh_epbuf.ctrl, str_len,
+        tuh_descriptor_get_string(daddr, dev->desc_device.iProduct, langid, enum_buf, str_len,
                             process_enumeration, ENUM_GET_STRING_SERIAL_LEN);
         break;
       }
@@ -1993,7 +2215,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
           langid = tu_le16toh(xfer->setup->wIndex); // get langid from previous setup packet if not fall through
         }
         tuh_descriptor_get_string(
-            daddr, dev->desc_device.iSerialNumber, langid, _usbh_epbuf.ctrl, 2, process_enumeration, ENUM_GET_STRING_SERIAL);
+            daddr, dev->desc_device.iSerialNumber, langid, enum_buf, 2, process_enumeration, ENUM_GET_STRING_SERIAL);
         break;
       }
       TU_ATTR_FALLTHROUGH;
@@ -2003,7 +2225,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       if (dev->desc_device.iSerialNumber != 0) {
         langid = tu_le16toh(xfer->setup->wIndex); // langid from length's request
         const uint8_t str_len = xfer->buffer[0];
-        tuh_descriptor_get_string(daddr, dev->desc_device.iSerialNumber, langid, _usbh_epbuf.ctrl, str_len,
+        tuh_descriptor_get_string(daddr, dev->desc_device.iSerialNumber, langid, enum_buf, str_len,
                                   process_enumeration, ENUM_GET_9BYTE_CONFIG_DESC);
         break;
       }
@@ -2014,13 +2236,13 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       // Get 9-byte for total length
       uint8_t const config_idx = 0;
       TU_LOG_USBH("Get Configuration[%u] Descriptor (9 bytes)\r\n", config_idx);
-      TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, _usbh_epbuf.ctrl, 9,
+      TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, enum_buf, 9,
                                                  process_enumeration, ENUM_GET_FULL_CONFIG_DESC),);
       break;
     }
 
     case ENUM_GET_FULL_CONFIG_DESC: {
-      uint8_t const* desc_config = _usbh_epbuf.ctrl;
+      uint8_t const* desc_config = enum_buf;
 
       // Use offsetof to avoid pointer to the odd/misaligned address
       uint16_t const total_len = tu_le16toh(tu_unaligned_read16(desc_config + offsetof(tusb_desc_configuration_t, wTotalLength)));
@@ -2031,20 +2253,20 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       // Get full configuration descriptor
       uint8_t const config_idx = (uint8_t) tu_le16toh(xfer->setup->wIndex);
       TU_LOG_USBH("Get Configuration[%u] Descriptor\r\n", config_idx);
-      TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, _usbh_epbuf.ctrl, total_len,
+      TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, enum_buf, total_len,
                                                  process_enumeration, ENUM_SET_CONFIG),);
       break;
     }
 
     case ENUM_SET_CONFIG: {
       uint8_t config_idx = (uint8_t) tu_le16toh(xfer->setup->wIndex);
-      if (tuh_enum_descriptor_configuration_cb(daddr, config_idx, (const tusb_desc_configuration_t*) _usbh_epbuf.ctrl)) {
+      if (tuh_enum_descriptor_configuration_cb(daddr, config_idx, (const tusb_desc_configuration_t*) enum_buf)) {
         TU_ASSERT(tuh_configuration_set(daddr, config_idx+1u, process_enumeration, ENUM_CONFIG_DRIVER),);
       } else {
         config_idx++;
         TU_ASSERT(config_idx < dev->desc_device.bNumConfigurations,);
         TU_LOG_USBH("Get Configuration[%u] Descriptor (9 bytes)\r\n", config_idx);
-        TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, _usbh_epbuf.ctrl, 9,
+        TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, enum_buf, 9,
                                                    process_enumeration, ENUM_GET_FULL_CONFIG_DESC),);
       }
       break;
@@ -2054,16 +2276,9 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       TU_LOG_USBH("Device configured\r\n");
       dev->configured = 1;
 
-  #if CFG_TUH_HUB
-      // get next hub status now since device can be unplugged before set_configure() is complete
-      if (_usbh_data.dev0_bus.hub_addr != 0) {
-        hub_edpt_status_xfer(_usbh_data.dev0_bus.hub_addr);
-      }
-  #endif
-
       // Parse configuration & set up drivers
       // driver_open() must not make any usb transfer
-      TU_ASSERT(enum_parse_configuration_desc(daddr, (tusb_desc_configuration_t*) _usbh_epbuf.ctrl),);
+      TU_ASSERT(enum_parse_configuration_desc(daddr, (tusb_desc_configuration_t*) enum_buf),);
 
       // Start the Set Configuration process for interfaces (itf = TUSB_INDEX_INVALID_8)
       // Since driver can perform control transfer within its set_config, this is done asynchronously.
@@ -2079,7 +2294,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
   }
 
   if (is_enum_failed) {
-    enum_full_complete(false);
+    enum_full_complete(enum_daddr, false);
   }
 }
 
@@ -2187,7 +2402,7 @@ void usbh_driver_set_config_complete(uint8_t dev_addr, uint8_t itf_num) {
 
   // all interfaces are configured
   if (itf_num == CFG_TUH_INTERFACE_MAX) {
-    enum_full_complete(true);
+    enum_full_complete(dev_addr, true);
 
     if (is_hub_addr(dev_addr)) {
       TU_LOG_USBH("HUB address = %u is mounted\r\n", dev_addr);
@@ -2198,19 +2413,28 @@ void usbh_driver_set_config_complete(uint8_t dev_addr, uint8_t itf_num) {
   }
 }
 
-static void enum_full_complete(bool success) {
-  (void)success;
-  TU_LOG_USBH("Enumeration complete: success = %u\r\n", success);
+static void enum_full_complete(uint8_t daddr, bool success) {
+  TU_LOG_USBH("[:%u] Enumeration complete: success = %u\r\n", daddr, success);
+
+  const usbh_enum_t* enum_info = enum_get(daddr);
+  if (success && enum_info != NULL) {
+    usbh_device_t* dev = get_device(daddr);
+    dev->enum_time_ms = tusb_time_millis_api() - enum_info->start_ms;
+  }
+  enum_release(daddr);
 
-  _usbh_data.enumerating_daddr = TUSB_INDEX_INVALID_8; // mark enumeration as complete
-  _usbh_data.call_after.func = NULL;
+  if (daddr == _usbh_data.enumerating_daddr) {
+    // failed in address 0 stage
+    _usbh_data.enumerating_daddr = TUSB_INDEX_INVALID_8;
+    _usbh_data.call_after.func = NULL;
 
   #if CFG_TUH_HUB
-  // Hub status is already requested in case of successful enumeration
-  if (!success && _usbh_data.dev0_bus.hub_addr != 0) {
-    hub_edpt_status_xfer(_usbh_data.dev0_bus.hub_addr);
-  }
+    // Hub status is already requested once address 0 stage is complete
+    if (_usbh_data.dev0_bus.hub_addr != 0) {
+      hub_edpt_status_xfer(_usbh_data.dev0_bus.hub_addr);
+    }
   #endif
+  }
 }
 
 #endif
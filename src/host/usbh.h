@@ -225,6 +225,10 @@ TU_ATTR_ALWAYS_INLINE static inline bool tuh_ready(uint8_t daddr) {
 // Get bus information of device
 bool tuh_bus_info_get(uint8_t daddr, tuh_bus_info_t* bus_info);
 
+// Get time (ms) taken to enumerate a mounted device: from its attach is processed (including debouncing and reset)
+// until all drivers are configured
+bool tuh_enum_time_get(uint8_t daddr, uint32_t* time_ms);
+
 //--------------------------------------------------------------------+
 // Transfer API
 // Each Function will make a USB transfer request to device. If
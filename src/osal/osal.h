@@ -54,6 +54,20 @@ typedef void (*osal_task_func_t)(void* param);
   #error OS is not supported yet
 #endif
 
+// Batch receive for ports without a native one: one item at a time, only the first waits up to msec
+#ifndef OSAL_QUEUE_RECEIVE_N_NATIVE
+TU_ATTR_ALWAYS_INLINE static inline uint32_t osal_queue_receive_n(osal_queue_t qhdl, void* data, uint32_t count,
+                                                                  uint16_t item_size, uint32_t msec) {
+  uint8_t* p_data = (uint8_t*) data;
+  uint32_t n = 0;
+  while (n < count && osal_queue_receive(qhdl, p_data, (n == 0) ? msec : 0)) {
+    p_data += item_size;
+    n++;
+  }
+  return n;
+}
+#endif
+
 /*--------------------------------------------------------------------
   OSAL Porting API
   Should be implemented as static inline function in osal_port.h header
@@ -81,6 +95,8 @@ typedef void (*osal_task_func_t)(void* param);
     osal_queue_t osal_queue_create(osal_queue_def_t* qdef);
     bool osal_queue_delete(osal_queue_t qhdl);
     bool osal_queue_receive(osal_queue_t qhdl, void* data, uint32_t msec);
+    uint32_t osal_queue_receive_n(osal_queue_t qhdl, void* data, uint32_t count, uint16_t item_size, uint32_t msec);
+      (optional, define OSAL_QUEUE_RECEIVE_N_NATIVE if implemented, otherwise it loops osal_queue_receive())
     bool osal_queue_send(osal_queue_t qhdl, void const * data, bool in_isr);
     bool osal_queue_empty(osal_queue_t qhdl);
 --------------------------------------------------------------------------*/
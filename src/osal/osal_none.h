@@ -156,6 +156,166 @@ TU_ATTR_ALWAYS_INLINE static inline bool osal_mutex_unlock(osal_mutex_t mutex_hd
 //--------------------------------------------------------------------+
 // QUEUE API
 //--------------------------------------------------------------------+
+#if CFG_TUSB_OSAL_QUEUE_SPSC
+
+#if !defined(__GNUC__)
+  #error CFG_TUSB_OSAL_QUEUE_SPSC requires GCC/Clang __atomic builtins
+#endif
+
+// Lock-free queue: one ring written from ISR (in_isr = true) and one from thread context (in_isr = false), each with
+// a single producer, and the task as the only consumer. Producer copies the item then publishes it with a release
+// store of the write index; consumer copies items out then frees their slots with a release store of the read index,
+// so neither side masks interrupts. Index range is [0, 2*depth) to tell full from empty.
+// Posting order across the rings is kept: each thread item is stamped with the number of ISR items sent before it,
+// consumer pops ISR items until it has received that many. Both counters are free running with a single writer.
+typedef struct {
+  uint8_t* buf;
+  uint16_t wr_idx; // written by producer only
+  uint16_t rd_idx; // written by consumer only
+} osal_queue_ring_t;
+
+typedef struct {
+  void (* interrupt_set)(bool enabled); // not used
+  uint16_t item_size;
+  uint16_t depth;
+  osal_queue_ring_t ring[2]; // [0] thread, [1] ISR
+  uint32_t* isr_stamp;       // [depth] ISR items sent before each thread item
+  uint32_t isr_sent;         // written by ISR producer only
+  uint32_t isr_received;     // written by consumer only
+} osal_queue_def_t;
+
+typedef osal_queue_def_t* osal_queue_t;
+
+#define OSAL_QUEUE_DEF(_int_set, _name, _depth, _type)                                   \
+  uint8_t          _name##_buf[2][_depth * sizeof(_type)];                               \
+  uint32_t         _name##_stamp[_depth];                                                \
+  osal_queue_def_t _name = {.interrupt_set = _int_set,                                   \
+                            .item_size     = sizeof(_type),                              \
+                            .depth         = _depth,                                     \
+                            .ring          = {{.buf = _name##_buf[0]}, {.buf = _name##_buf[1]}}, \
+                            .isr_stamp     = _name##_stamp}
+
+TU_ATTR_ALWAYS_INLINE static inline uint16_t osal_queue_ring_count(uint16_t depth, uint16_t wr_idx, uint16_t rd_idx) {
+  return (wr_idx >= rd_idx) ? (uint16_t) (wr_idx - rd_idx) : (uint16_t) (2 * depth - (rd_idx - wr_idx));
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint16_t osal_queue_ring_advance(uint16_t depth, uint16_t idx, uint16_t n) {
+  idx = (uint16_t) (idx + n);
+  return (idx >= 2 * depth) ? (uint16_t) (idx - 2 * depth) : idx;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint16_t osal_queue_ring_pos(osal_queue_t qhdl, uint16_t idx) {
+  return (idx >= qhdl->depth) ? (uint16_t) (idx - qhdl->depth) : idx;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t* osal_queue_ring_slot(osal_queue_t qhdl, osal_queue_ring_t* ring,
+                                                                  uint16_t idx) {
+  return ring->buf + (uint32_t) osal_queue_ring_pos(qhdl, idx) * qhdl->item_size;
+}
+
+// Pop up to count items from a ring, return number of popped items
+TU_ATTR_ALWAYS_INLINE static inline uint32_t osal_queue_ring_pop(osal_queue_t qhdl, osal_queue_ring_t* ring,
+                                                                 uint8_t* data, uint32_t count) {
+  const uint16_t rd_idx = ring->rd_idx;
+  const uint16_t wr_idx = __atomic_load_n(&ring->wr_idx, __ATOMIC_ACQUIRE);
+  const uint16_t n      = (uint16_t) tu_min32(count, osal_queue_ring_count(qhdl->depth, wr_idx, rd_idx));
+
+  for (uint16_t i = 0; i < n; i++) {
+    memcpy(data, osal_queue_ring_slot(qhdl, ring, osal_queue_ring_advance(qhdl->depth, rd_idx, i)), qhdl->item_size);
+    data += qhdl->item_size;
+  }
+
+  if (n > 0) {
+    __atomic_store_n(&ring->rd_idx, osal_queue_ring_advance(qhdl->depth, rd_idx, n), __ATOMIC_RELEASE);
+  }
+  return n;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline osal_queue_t osal_queue_create(osal_queue_def_t* qdef) {
+  for (uint8_t i = 0; i < 2; i++) {
+    qdef->ring[i].wr_idx = 0;
+    qdef->ring[i].rd_idx = 0;
+  }
+  qdef->isr_sent     = 0;
+  qdef->isr_received = 0;
+  return (osal_queue_t) qdef;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_delete(osal_queue_t qhdl) {
+  (void) qhdl;
+  return true; // nothing to do
+}
+
+#define OSAL_QUEUE_RECEIVE_N_NATIVE
+TU_ATTR_ALWAYS_INLINE static inline uint32_t osal_queue_receive_n(osal_queue_t qhdl, void* data, uint32_t count,
+                                                                  uint16_t item_size, uint32_t msec) {
+  (void) msec; // not used, always behave as msec = 0
+  (void) item_size; // same as qhdl->item_size
+
+  uint8_t* p_data = (uint8_t*) data;
+  osal_queue_ring_t* thread_ring = &qhdl->ring[0];
+  uint32_t n = 0;
+
+  while (n < count) {
+    // ISR items sent before the oldest thread item go first, all of them if there is no thread item
+    const uint16_t thread_rd = thread_ring->rd_idx;
+    const bool has_thread = (__atomic_load_n(&thread_ring->wr_idx, __ATOMIC_ACQUIRE) != thread_rd);
+    uint32_t isr_count = count - n;
+    if (has_thread) {
+      const int32_t before = (int32_t) (qhdl->isr_stamp[osal_queue_ring_pos(qhdl, thread_rd)] - qhdl->isr_received);
+      isr_count = tu_min32(isr_count, (before > 0) ? (uint32_t) before : 0);
+    }
+
+    const uint32_t isr_n = osal_queue_ring_pop(qhdl, &qhdl->ring[1], p_data + n * qhdl->item_size, isr_count);
+    qhdl->isr_received += isr_n;
+    n += isr_n;
+
+    if (!has_thread || n == count) {
+      break;
+    }
+    n += osal_queue_ring_pop(qhdl, thread_ring, p_data + n * qhdl->item_size, 1);
+  }
+
+  return n;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_receive(osal_queue_t qhdl, void* data, uint32_t msec) {
+  return osal_queue_receive_n(qhdl, data, 1, qhdl->item_size, msec) > 0;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_send(osal_queue_t qhdl, void const* data, bool in_isr) {
+  osal_queue_ring_t* ring = &qhdl->ring[in_isr ? 1 : 0];
+  const uint16_t wr_idx = ring->wr_idx;
+  const uint16_t rd_idx = __atomic_load_n(&ring->rd_idx, __ATOMIC_ACQUIRE);
+
+  if (osal_queue_ring_count(qhdl->depth, wr_idx, rd_idx) >= qhdl->depth) {
+    return false; // full
+  }
+
+  memcpy(osal_queue_ring_slot(qhdl, ring, wr_idx), data, qhdl->item_size);
+  if (!in_isr) {
+    qhdl->isr_stamp[osal_queue_ring_pos(qhdl, wr_idx)] = __atomic_load_n(&qhdl->isr_sent, __ATOMIC_ACQUIRE);
+  }
+  __atomic_store_n(&ring->wr_idx, osal_queue_ring_advance(qhdl->depth, wr_idx, 1), __ATOMIC_RELEASE);
+  if (in_isr) {
+    __atomic_store_n(&qhdl->isr_sent, qhdl->isr_sent + 1, __ATOMIC_RELEASE);
+  }
+
+  return true;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_empty(osal_queue_t qhdl) {
+  for (uint8_t i = 0; i < 2; i++) {
+    osal_queue_ring_t* ring = &qhdl->ring[i];
+    if (__atomic_load_n(&ring->wr_idx, __ATOMIC_RELAXED) != __atomic_load_n(&ring->rd_idx, __ATOMIC_RELAXED)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#else
+
 #include "common/tusb_fifo.h"
 
 typedef struct {
@@ -193,6 +353,22 @@ TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_receive(osal_queue_t qhdl, v
   return success;
 }
 
+// Drain up to count items with a single interrupt lock
+#define OSAL_QUEUE_RECEIVE_N_NATIVE
+TU_ATTR_ALWAYS_INLINE static inline uint32_t osal_queue_receive_n(osal_queue_t qhdl, void* data, uint32_t count,
+                                                                  uint16_t item_size, uint32_t msec) {
+  (void) msec; // not used, always behave as msec = 0
+  (void) item_size; // same as qhdl->item_size
+
+  const uint16_t max_bytes = (uint16_t) tu_min32(count * qhdl->item_size, tu_fifo_depth(&qhdl->ff));
+
+  qhdl->interrupt_set(false);
+  const uint16_t nbytes = tu_fifo_read_n(&qhdl->ff, data, max_bytes);
+  qhdl->interrupt_set(true);
+
+  return nbytes / qhdl->item_size;
+}
+
 TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_send(osal_queue_t qhdl, void const* data, bool in_isr) {
   if (!in_isr) {
     qhdl->interrupt_set(false);
@@ -213,6 +389,8 @@ TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_empty(osal_queue_t qhdl) {
   return tu_fifo_empty(&qhdl->ff);
 }
 
+#endif
+
 #ifdef __cplusplus
 }
 #endif
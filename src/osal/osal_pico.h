@@ -153,6 +153,22 @@ TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_receive(osal_queue_t qhdl, v
   return success;
 }
 
+// Drain up to count items with a single critical section
+#define OSAL_QUEUE_RECEIVE_N_NATIVE
+TU_ATTR_ALWAYS_INLINE static inline uint32_t osal_queue_receive_n(osal_queue_t qhdl, void *data, uint32_t count,
+                                                                  uint16_t item_size, uint32_t msec) {
+  (void)msec;      // not used, always behave as msec = 0
+  (void)item_size; // same as qhdl->item_size
+
+  const uint16_t max_bytes = (uint16_t)tu_min32(count * qhdl->item_size, tu_fifo_depth(&qhdl->ff));
+
+  critical_section_enter_blocking(&qhdl->critsec);
+  const uint16_t nbytes = tu_fifo_read_n(&qhdl->ff, data, max_bytes);
+  critical_section_exit(&qhdl->critsec);
+
+  return nbytes / qhdl->item_size;
+}
+
 TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_send(osal_queue_t qhdl, const void *data, bool in_isr) {
   (void)in_isr;
 
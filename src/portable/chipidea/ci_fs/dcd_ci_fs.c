@@ -372,7 +372,7 @@ void dcd_edpt_close_all(uint8_t rhport) {
   }
 }
 
-bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t total_bytes, bool is_isr)
+bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint32_t total_bytes, bool is_isr)
 {
   (void) is_isr;
   const unsigned epn      = tu_edpt_number(ep_addr);
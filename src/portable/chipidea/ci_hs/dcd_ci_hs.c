@@ -597,7 +597,7 @@ static bool qhd_start_xfer(uint8_t rhport, uint8_t epnum, uint8_t dir) {
   return true;
 }
 
-bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer, uint16_t total_bytes, bool is_isr) {
+bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer, uint32_t total_bytes, bool is_isr) {
   (void)is_isr;
   const uint8_t epnum = tu_edpt_number(ep_addr);
   const uint8_t dir   = tu_edpt_dir(ep_addr);
@@ -605,8 +605,11 @@ bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer, uint16_t to
   dcd_qhd_t *p_qhd = &_dcd_data.qhd[epnum][dir];
   dcd_qtd_t *p_qtd = &_dcd_data.qtd[epnum][dir];
 
+  // one dTD per transfer, usbd splits larger transfer into chunks of TUP_DCD_EDPT_XFER_MAX
+  TU_ASSERT(total_bytes <= TUP_DCD_EDPT_XFER_MAX);
+
   // Prepare qtd
-  qtd_init(p_qtd, buffer, total_bytes);
+  qtd_init(p_qtd, buffer, (uint16_t) total_bytes);
 
   // Start qhd transfer
   p_qhd->ff = NULL;
@@ -19,6 +19,7 @@
 #include "host/usbh_pvt.h"
 #include "ehci_api.h"
 #include "ehci.h"
+#include "ehci_iso.h"
 
 // NXP specific fixes
 #if TU_CHECK_MCU(OPT_MCU_MIMXRT1XXX, OPT_MCU_LPC55, OPT_MCU_MCXN9, OPT_MCU_RW61X)
@@ -38,8 +39,13 @@
 
 // Framelist size as small as possible to save SRAM
 #ifdef TUP_USBIP_CHIPIDEA_HS
+  #if CFG_TUH_EHCI_ISO_EDPT_MAX
+  // NXP Transdimension: 32 elements, isochronous transfer can span several frames ahead of current one
+  #define FRAMELIST_SIZE_BIT_VALUE      5u
+  #else
   // NXP Transdimension: 8 elements
   #define FRAMELIST_SIZE_BIT_VALUE      7u
+  #endif
   #define FRAMELIST_SIZE_USBCMD_VALUE   (((FRAMELIST_SIZE_BIT_VALUE &  3) << EHCI_USBCMD_FRAMELIST_SIZE_SHIFT) | \
                                          ((FRAMELIST_SIZE_BIT_VALUE >> 2) << EHCI_USBCMD_CHIPIDEA_FRAMELIST_SIZE_MSB_SHIFT))
 #else
@@ -50,14 +56,49 @@
 
 #define FRAMELIST_SIZE                  (1024 >> FRAMELIST_SIZE_BIT_VALUE)
 
+// Longest polling interval of periodic list heads, interrupt endpoint with larger interval is polled at this rate
+#define PERIOD_INTERVAL_MAX_MS          8u
+TU_VERIFY_STATIC(FRAMELIST_SIZE >= PERIOD_INTERVAL_MAX_MS, "framelist must cover all period heads");
+
 // Total queue head pool. TODO should be user configurable and more optimize memory usage in the future
 #define QHD_MAX      (CFG_TUH_DEVICE_MAX*CFG_TUH_ENDPOINT_MAX + CFG_TUH_HUB)
 #define QTD_MAX      QHD_MAX
 
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+// Isochronous transfer is scheduled this many frames ahead of current frame, more than Isochronous Scheduling
+// Threshold (at most 1 frame) of HC
+#define ISO_SCHEDULE_MARGIN 2u
+
+// Isochronous endpoint: iTDs (highspeed) or siTDs (full-speed) are linked to frame list in front of interrupt queue
+// heads while a transfer is scheduled, and unlinked once it is complete
+typedef struct {
+  union {
+    ehci_itd_t itd[CFG_TUH_EHCI_ISO_TD_COUNT];
+    ehci_sitd_t sitd[CFG_TUH_EHCI_ISO_TD_COUNT];
+  };
+
+  ehci_budget_rsv_t rsv; // reserved periodic bandwidth
+
+  uint32_t buffer;   // for dcache invalidate of IN transfer
+  uint32_t buflen;
+  uint32_t frame;    // frame of the first linked TD
+  uint16_t interval; // microframes for highspeed, frames for full-speed
+  uint16_t xact_max; // bytes per transaction: max packet size x mult
+
+  uint8_t dev_addr;
+  uint8_t ep_addr;
+  uint8_t used;
+  uint8_t is_split;  // full-speed endpoint behind TT, use siTD
+  uint8_t tt_idx;
+  uint8_t td_step;   // frames between linked TDs
+  volatile uint8_t td_linked; // number of TDs linked to frame list
+} ehci_iso_edpt_t;
+#endif
+
 typedef struct {
   ehci_link_t period_framelist[FRAMELIST_SIZE];
 
-  // TODO only implement 1 ms & 2 ms & 4 ms, 8 ms (framelist)
+  // TODO only implement 1 ms & 2 ms & 4 ms, 8 ms (framelist), larger interval is clamped to PERIOD_INTERVAL_MAX_MS
   // [0] : 1ms, [1] : 2ms, [2] : 4ms, [3] : 8 ms
   // TODO better implementation without dummy head to save SRAM
   ehci_qhd_t period_head_arr[4];
@@ -75,6 +116,12 @@ typedef struct {
   ehci_cap_registers_t* cap_regs; // capability register
 
   volatile uint32_t uframe_number;
+
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+  ehci_iso_edpt_t iso[CFG_TUH_EHCI_ISO_EDPT_MAX];
+  ehci_budget_t budget;
+  ehci_budget_tt_t tt_budget[CFG_TUH_HUB + 1]; // [0] is embedded TT of root port, [n] is TT of hub n
+#endif
 }ehci_data_t;
 
 // Periodic frame list must be 4K alignment
@@ -148,6 +195,15 @@ TU_ATTR_ALWAYS_INLINE static inline void list_insert (ehci_link_t *current, ehci
 TU_ATTR_ALWAYS_INLINE static inline void list_remove(ehci_link_t* head, ehci_link_t* prev, ehci_qhd_t* qhd);
 static void list_remove_qhd_by_addr(ehci_link_t *list_head, uint8_t dev_addr, uint8_t ep_addr);
 
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+static ehci_iso_edpt_t* iso_get_from_addr(uint8_t dev_addr, uint8_t ep_addr);
+static bool iso_open(uint8_t dev_addr, tusb_desc_endpoint_t const * ep_desc);
+static void iso_close(ehci_iso_edpt_t* iso);
+static bool iso_xfer(ehci_iso_edpt_t* iso, uint8_t * buffer, uint32_t buflen);
+static bool iso_abort(ehci_iso_edpt_t* iso);
+static void iso_xfer_complete_isr(ehci_iso_edpt_t* iso);
+#endif
+
 static void ehci_disable_schedule(ehci_registers_t* regs, bool is_period) {
   // maybe have a timeout for status
   if (is_period) {
@@ -284,6 +340,15 @@ void hcd_device_close(uint8_t rhport, uint8_t daddr) {
     list_remove_qhd_by_addr((ehci_link_t *) &ehci_data.period_head_arr[i], daddr, TUSB_INDEX_INVALID_8);
   }
 
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+  // Unlink scheduled TDs and release bandwidth of isochronous endpoints
+  for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_EDPT_MAX; i++) {
+    if (ehci_data.iso[i].used && ehci_data.iso[i].dev_addr == daddr) {
+      iso_close(&ehci_data.iso[i]);
+    }
+  }
+#endif
+
   // Async doorbell (EHCI 4.8.2 for operational details)
   ehci_data.regs->command_bm.async_adv_doorbell = 1;
 }
@@ -297,11 +362,10 @@ static void init_periodic_list(uint8_t rhport) {
     ehci_data.period_head_arr[i].qtd_overlay.halted = 1; // dummy node, always inactive
   }
 
-  // TODO EHCI_FRAMELIST_SIZE with other size than 8
   // all links --> period_head_arr[0] (1ms)
   // 0, 2, 4, 6 etc --> period_head_arr[1] (2ms)
-  // 1, 5 --> period_head_arr[2] (4ms)
-  // 3 --> period_head_arr[3] (8ms)
+  // 1, 5, 9, 13 etc --> period_head_arr[2] (4ms)
+  // 3, 11, 19 etc --> period_head_arr[3] (8ms)
 
   ehci_link_t * const framelist  = ehci_data.period_framelist;
   ehci_link_t * const head_1ms = (ehci_link_t *) &ehci_data.period_head_arr[0];
@@ -322,7 +386,9 @@ static void init_periodic_list(uint8_t rhport) {
     list_insert(framelist + i, head_4ms, EHCI_QTYPE_QHD);
   }
 
-  list_insert(framelist + 3, head_8ms, EHCI_QTYPE_QHD);
+  for (uint32_t i = 3; i < FRAMELIST_SIZE; i += 8) {
+    list_insert(framelist + i, head_8ms, EHCI_QTYPE_QHD);
+  }
 
   head_1ms->terminate = 1;
 }
@@ -414,8 +480,14 @@ bool ehci_deinit(uint8_t rhport) {
 //--------------------------------------------------------------------+
 
 bool hcd_edpt_open(uint8_t rhport, uint8_t dev_addr, tusb_desc_endpoint_t const * ep_desc) {
-  // TODO not support ISO yet
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+  if (ep_desc->bmAttributes.xfer == TUSB_XFER_ISOCHRONOUS) {
+    return iso_open(dev_addr, ep_desc);
+  }
+#else
+  // ISO requires CFG_TUH_EHCI_ISO_EDPT_MAX > 0
   TU_ASSERT (ep_desc->bmAttributes.xfer != TUSB_XFER_ISOCHRONOUS);
+#endif
 
   //------------- Prepare Queue Head -------------//
   ehci_qhd_t *p_qhd;
@@ -447,10 +519,6 @@ bool hcd_edpt_open(uint8_t rhport, uint8_t dev_addr, tusb_desc_endpoint_t const
       list_head = list_get_period_head(rhport, p_qhd->interval_ms);
       break;
 
-    case TUSB_XFER_ISOCHRONOUS:
-      // TODO iso is not supported
-      break;
-
     default:
       break;
   }
@@ -465,6 +533,14 @@ bool hcd_edpt_open(uint8_t rhport, uint8_t dev_addr, tusb_desc_endpoint_t const
 }
 
 bool hcd_edpt_close(uint8_t rhport, uint8_t daddr, uint8_t ep_addr) {
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+  ehci_iso_edpt_t* iso = iso_get_from_addr(daddr, ep_addr);
+  if (iso != NULL) {
+    iso_close(iso);
+    return true;
+  }
+#endif
+
   ehci_qhd_t* qhd = qhd_get_from_addr(daddr, ep_addr);
   TU_VERIFY(qhd != NULL);
 
@@ -502,12 +578,22 @@ bool hcd_setup_send(uint8_t rhport, uint8_t dev_addr, uint8_t const setup_packet
   return true;
 }
 
-bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t * buffer, uint16_t buflen) {
+bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t * buffer, uint32_t buflen) {
   (void) rhport;
 
   uint8_t const epnum = tu_edpt_number(ep_addr);
   uint8_t const dir   = tu_edpt_dir(ep_addr);
 
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+  ehci_iso_edpt_t* iso = iso_get_from_addr(dev_addr, ep_addr);
+  if (iso != NULL) {
+    return iso_xfer(iso, buffer, buflen);
+  }
+#endif
+
+  // one qTD per transfer, usbh splits larger transfer into chunks of TUP_HCD_EDPT_XFER_MAX
+  TU_ASSERT(buflen <= TUP_HCD_EDPT_XFER_MAX);
+
   ehci_qhd_t* qhd = qhd_get_from_addr(dev_addr, ep_addr);
   TU_VERIFY(qhd != NULL);
   ehci_qtd_t* qtd;
@@ -519,7 +605,7 @@ bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t *
     }
 
     qtd = qtd_control(dev_addr);
-    qtd_init(qtd, buffer, buflen);
+    qtd_init(qtd, buffer, (uint16_t) buflen);
 
     // first data toggle is always 1 (data & setup stage)
     qtd->data_toggle = 1;
@@ -531,7 +617,7 @@ bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t *
     qtd = qtd_find_free();
     TU_ASSERT(qtd);
 
-    qtd_init(qtd, buffer, buflen);
+    qtd_init(qtd, buffer, (uint16_t) buflen);
     qtd->pid = qhd->pid;
   }
 
@@ -551,7 +637,13 @@ bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t *
 bool hcd_edpt_abort_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr) {
   (void) rhport;
 
-  // TODO ISO not supported yet
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+  ehci_iso_edpt_t* iso = iso_get_from_addr(dev_addr, ep_addr);
+  if (iso != NULL) {
+    return iso_abort(iso);
+  }
+#endif
+
   ehci_qhd_t* qhd = qhd_get_from_addr(dev_addr, ep_addr);
   ehci_qtd_t * volatile qtd = qhd->attached_qtd;
   TU_VERIFY(qtd != NULL); // no queued transfer
@@ -702,7 +794,7 @@ void process_period_xfer_isr(uint8_t rhport, uint32_t interval_ms) {
       }
         break;
 
-      // TODO support hs/fs ISO
+      // iTD/siTD are linked in front of interval list heads, handled by iso_xfer_complete_isr()
       case EHCI_QTYPE_ITD:
       case EHCI_QTYPE_SITD:
       case EHCI_QTYPE_FSTN:
@@ -750,10 +842,16 @@ void hcd_int_handler(uint8_t rhport, bool in_isr) {
   if (usb_int) {
     proccess_async_xfer_isr(list_get_async_head(rhport));
 
-    for ( uint32_t i = 1; i <= FRAMELIST_SIZE; i *= 2 ) {
+    for ( uint32_t i = 1; i <= PERIOD_INTERVAL_MAX_MS; i *= 2 ) {
       process_period_xfer_isr(rhport, i);
     }
 
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+    for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_EDPT_MAX; i++) {
+      iso_xfer_complete_isr(&ehci_data.iso[i]);
+    }
+#endif
+
     regs->status = usb_int; // Acknowledge
   }
 
@@ -772,7 +870,7 @@ void hcd_int_handler(uint8_t rhport, bool in_isr) {
 // Get head of periodic list
 TU_ATTR_ALWAYS_INLINE static inline ehci_link_t* list_get_period_head(uint8_t rhport, uint32_t interval_ms) {
   (void) rhport;
-  return (ehci_link_t*) &ehci_data.period_head_arr[ tu_log2( tu_min32(FRAMELIST_SIZE, interval_ms) ) ];
+  return (ehci_link_t*) &ehci_data.period_head_arr[ tu_log2( tu_min32(PERIOD_INTERVAL_MAX_MS, interval_ms) ) ];
 }
 
 // Get head of async list
@@ -1018,4 +1116,229 @@ static void qtd_init(ehci_qtd_t* qtd, void const* buffer, uint16_t total_bytes)
   }
 }
 
+//--------------------------------------------------------------------+
+// Isochronous helper
+//--------------------------------------------------------------------+
+#if CFG_TUH_EHCI_ISO_EDPT_MAX
+
+static ehci_iso_edpt_t* iso_get_from_addr(uint8_t dev_addr, uint8_t ep_addr) {
+  for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_EDPT_MAX; i++) {
+    ehci_iso_edpt_t* iso = &ehci_data.iso[i];
+    if (iso->used && iso->dev_addr == dev_addr && iso->ep_addr == ep_addr) {
+      return iso;
+    }
+  }
+  return NULL;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline ehci_link_t* iso_td(ehci_iso_edpt_t* iso, uint8_t idx) {
+  return iso->is_split ? (ehci_link_t*) &iso->sitd[idx] : (ehci_link_t*) &iso->itd[idx];
+}
+
+TU_ATTR_ALWAYS_INLINE static inline ehci_budget_tt_t* iso_tt_budget(ehci_iso_edpt_t* iso) {
+  return iso->is_split ? &ehci_data.tt_budget[iso->tt_idx] : NULL;
+}
+
+static bool iso_open(uint8_t dev_addr, tusb_desc_endpoint_t const * ep_desc) {
+  uint8_t const ep_addr = ep_desc->bEndpointAddress;
+  if (NULL != iso_get_from_addr(dev_addr, ep_addr)) {
+    return true; // already opened
+  }
+
+  ehci_iso_edpt_t* iso = NULL;
+  for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_EDPT_MAX; i++) {
+    if (!ehci_data.iso[i].used) {
+      iso = &ehci_data.iso[i];
+      break;
+    }
+  }
+  TU_ASSERT(iso);
+
+  tuh_bus_info_t bus_info;
+  tuh_bus_info_get(dev_addr, &bus_info);
+  TU_ASSERT(bus_info.speed != TUSB_SPEED_LOW);
+  TU_ASSERT(ep_desc->bInterval >= 1 && ep_desc->bInterval <= 16);
+
+  tu_memclr(iso, sizeof(ehci_iso_edpt_t));
+  uint16_t const mps = tu_edpt_packet_size(ep_desc);
+  uint16_t const interval = (uint16_t) (1u << (ep_desc->bInterval - 1));
+  bool const is_in = (tu_edpt_dir(ep_addr) == TUSB_DIR_IN);
+
+  if (bus_info.speed == TUSB_SPEED_HIGH) {
+    // additional transactions per microframe in bit 12..11 of wMaxPacketSize
+    uint8_t const mult = (uint8_t) (1u + ((tu_le16toh(ep_desc->wMaxPacketSize) >> 11) & 0x03u));
+    TU_ASSERT(mult <= 3);
+    TU_ASSERT(ehci_budget_itd_reserve(&ehci_data.budget, &iso->rsv, mps, mult, interval));
+
+    iso->xact_max = (uint16_t) (mps * mult);
+    for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_TD_COUNT; i++) {
+      ehci_itd_init(&iso->itd[i], dev_addr, ep_addr, mps, mult);
+    }
+  } else {
+    // hub address starts from CFG_TUH_DEVICE_MAX+1, 0 is embedded TT of root port
+    iso->is_split = 1;
+    iso->tt_idx = (bus_info.hub_addr == 0) ? 0 : (uint8_t) (bus_info.hub_addr - CFG_TUH_DEVICE_MAX);
+    TU_ASSERT(iso->tt_idx <= CFG_TUH_HUB);
+    TU_ASSERT(ehci_budget_sitd_reserve(&ehci_data.budget, &ehci_data.tt_budget[iso->tt_idx], &iso->rsv, mps, is_in,
+                                       interval));
+
+    iso->xact_max = mps;
+    for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_TD_COUNT; i++) {
+      ehci_sitd_init(&iso->sitd[i], dev_addr, ep_addr, bus_info.hub_addr, bus_info.hub_port, iso->rsv.smask,
+                     iso->rsv.cmask);
+    }
+  }
+
+  iso->interval = interval;
+  iso->dev_addr = dev_addr;
+  iso->ep_addr  = ep_addr;
+  iso->used     = 1;
+
+  return true;
+}
+
+// Unlink iTD/siTD from frame list slot. They are always in front of queue heads
+static void iso_td_unlink(uint32_t slot, ehci_link_t const* td) {
+  ehci_link_t* prev = &ehci_data.period_framelist[slot];
+
+  while (!prev->terminate && prev->type != EHCI_QTYPE_QHD) {
+    ehci_link_t* next = list_next(prev);
+    if (next == td) {
+      prev->address = td->address;
+      hcd_dcache_clean(prev, sizeof(ehci_link_t));
+      return;
+    }
+    prev = next;
+  }
+}
+
+static void iso_unlink_all(ehci_iso_edpt_t* iso) {
+  for (uint8_t i = 0; i < iso->td_linked; i++) {
+    iso_td_unlink((iso->frame + i * iso->td_step) % FRAMELIST_SIZE, iso_td(iso, i));
+  }
+  iso->td_linked = 0;
+}
+
+static bool iso_xfer(ehci_iso_edpt_t* iso, uint8_t * buffer, uint32_t buflen) {
+  TU_VERIFY(iso->td_linked == 0); // previous transfer is still scheduled
+
+  ehci_budget_rsv_t const * rsv = &iso->rsv;
+  uint8_t td_count;
+  if (iso->is_split) {
+    iso->td_step = (uint8_t) tu_min16(iso->interval, FRAMELIST_SIZE);
+    td_count = ehci_sitd_build(iso->sitd, CFG_TUH_EHCI_ISO_TD_COUNT, (uint32_t) buffer, buflen, iso->xact_max);
+  } else {
+    // first transaction microframe of serviced frame
+    uint8_t uframe = 0;
+    while (!(rsv->smask & TU_BIT(uframe))) {
+      uframe++;
+    }
+    iso->td_step = (uint8_t) tu_min16(tu_max16(iso->interval / 8, 1), FRAMELIST_SIZE);
+    td_count = ehci_itd_build(iso->itd, CFG_TUH_EHCI_ISO_TD_COUNT, (uint32_t) buffer, buflen, iso->xact_max, uframe,
+                              iso->interval);
+  }
+  TU_ASSERT(td_count > 0); // transfer is too large for CFG_TUH_EHCI_ISO_TD_COUNT
+
+  // first serviced frame of reserved phase, after the scheduling margin
+  uint32_t const now = ehci_data.regs->frame_index >> 3;
+  uint32_t frame = now + ISO_SCHEDULE_MARGIN;
+  frame += (rsv->frame_phase + EHCI_BUDGET_FRAMES - (frame % rsv->frame_period)) % rsv->frame_period;
+
+  // TD is linked to its slot less than a frame list round ahead, otherwise HC executes it early
+  TU_ASSERT(frame + (uint32_t) (td_count - 1) * iso->td_step - now < FRAMELIST_SIZE);
+
+  // IN transfer: invalidate buffer, OUT transfer: clean buffer
+  if (tu_edpt_dir(iso->ep_addr)) {
+    hcd_dcache_invalidate(buffer, buflen);
+  } else {
+    hcd_dcache_clean(buffer, buflen);
+  }
+
+  iso->buffer = (uint32_t) buffer;
+  iso->buflen = buflen;
+  iso->frame  = frame;
+
+  // protect frame list since completed TDs of other endpoints are unlinked in isr
+  usbh_spin_lock(false);
+  for (uint8_t i = 0; i < td_count; i++) {
+    ehci_link_t* td = iso_td(iso, i);
+    uint32_t const slot = (frame + i * iso->td_step) % FRAMELIST_SIZE;
+
+    hcd_dcache_clean(td, iso->is_split ? sizeof(ehci_sitd_t) : sizeof(ehci_itd_t));
+    list_insert(&ehci_data.period_framelist[slot], td, iso->is_split ? EHCI_QTYPE_SITD : EHCI_QTYPE_ITD);
+    hcd_dcache_clean(&ehci_data.period_framelist[slot], sizeof(ehci_link_t));
+  }
+  iso->td_linked = td_count;
+  usbh_spin_unlock(false);
+
+  return true;
+}
+
+static bool iso_abort(ehci_iso_edpt_t* iso) {
+  usbh_spin_lock(false);
+  bool const scheduled = (iso->td_linked > 0);
+
+  // deactivate before unlinking
+  for (uint8_t i = 0; i < iso->td_linked; i++) {
+    if (iso->is_split) {
+      iso->sitd[i].active = 0;
+      hcd_dcache_clean(&iso->sitd[i], sizeof(ehci_sitd_t));
+    } else {
+      for (uint8_t u = 0; u < 8; u++) {
+        iso->itd[i].xact[u].active = 0;
+      }
+      hcd_dcache_clean(&iso->itd[i], sizeof(ehci_itd_t));
+    }
+  }
+  iso_unlink_all(iso);
+  usbh_spin_unlock(false);
+
+  return scheduled;
+}
+
+static void iso_close(ehci_iso_edpt_t* iso) {
+  iso_abort(iso);
+  ehci_budget_update(&ehci_data.budget, iso_tt_budget(iso), &iso->rsv, false);
+  iso->used = 0;
+}
+
+// Check if all scheduled TDs are executed, then unlink them and notify usbh
+static void iso_xfer_complete_isr(ehci_iso_edpt_t* iso) {
+  if (!iso->used || iso->td_linked == 0) {
+    return;
+  }
+
+  uint32_t xferred = 0;
+  bool success = true;
+
+  for (uint8_t i = 0; i < iso->td_linked; i++) {
+    if (iso->is_split) {
+      ehci_sitd_t const * sitd = &iso->sitd[i];
+      hcd_dcache_invalidate(sitd, sizeof(ehci_sitd_t));
+      if (sitd->active) {
+        return;
+      }
+      success = ehci_sitd_xferred(sitd, &xferred) && success;
+    } else {
+      ehci_itd_t const * itd = &iso->itd[i];
+      hcd_dcache_invalidate(itd, sizeof(ehci_itd_t));
+      if (ehci_itd_active(itd)) {
+        return;
+      }
+      success = ehci_itd_xferred(itd, &xferred) && success;
+    }
+  }
+
+  iso_unlink_all(iso);
+
+  if (tu_edpt_dir(iso->ep_addr) && xferred > 0) {
+    hcd_dcache_invalidate((void*) iso->buffer, iso->buflen);
+  }
+
+  hcd_event_xfer_complete(iso->dev_addr, iso->ep_addr, xferred, success ? XFER_RESULT_SUCCESS : XFER_RESULT_FAILED,
+                          true);
+}
+
+#endif
+
 #endif
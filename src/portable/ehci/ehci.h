@@ -141,8 +141,6 @@ typedef struct TU_ATTR_ALIGNED(32) {
   uint8_t pid;
   uint8_t interval_ms;// polling interval in frames (or millisecond)
 
-  uint8_t TU_RESERVED[4];
-
   // Attached TD management, note usbh will only queue 1 TD per QHD.
   // buffer for dcache invalidate since td's buffer is modified by HC and finding initial buffer address is not trivial
   uint32_t attached_buffer;
@@ -226,9 +224,8 @@ typedef struct TU_ATTR_ALIGNED(32) {
   ehci_link_t back;
 
   /// SITD is 32-byte aligned but occupies only 28 --> 4 bytes for storing extra data
-  uint8_t used;
-  uint8_t ihd_idx;
-  uint8_t reserved2[2];
+  uint16_t expected_bytes; ///< HCD: scheduled bytes, total_bytes is decreased by HC during transfer
+  uint8_t  TU_RESERVED[2];
 } ehci_sitd_t;
 
 TU_VERIFY_STATIC( sizeof(ehci_sitd_t) == 32, "size is not correct" );
@@ -0,0 +1,346 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_EHCI_ISO_H_
+#define TUSB_EHCI_ISO_H_
+
+#include "common/tusb_common.h"
+#include "ehci.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+// Isochronous transfer descriptors (iTD for highspeed, siTD for full-speed behind TT): periodic bandwidth budgeting,
+// construction before linking to frame list and parsing once transfer completes.
+// These only access memory and do not touch any register.
+
+//--------------------------------------------------------------------+
+// Periodic Bandwidth Budget
+//--------------------------------------------------------------------+
+
+// Periodic bandwidth is budgeted over a window of 8 frames (64 microframes). Endpoint with longer interval is
+// budgeted as if it is serviced every 8 frames.
+enum {
+  EHCI_BUDGET_FRAMES  = 8,
+  EHCI_BUDGET_UFRAMES = EHCI_BUDGET_FRAMES * 8,
+
+  EHCI_BUDGET_HS_UFRAME_MAX = 6000, // 80% of 7500 highspeed byte-times per microframe (USB 2.0 5.5.4)
+  EHCI_BUDGET_FS_FRAME_MAX  = 1157, // full-speed periodic bytes per frame through TT (USB 2.0 11.18.1)
+  EHCI_BUDGET_FS_UFRAME     = 188,  // full-speed bytes per microframe, best case budget (USB 2.0 11.18.1)
+};
+
+typedef struct {
+  uint16_t hs[EHCI_BUDGET_UFRAMES]; // highspeed bus time (byte-times) allocated in each microframe
+} ehci_budget_t;
+
+// Budget of a Transaction Translator
+typedef struct {
+  uint16_t fs[EHCI_BUDGET_FRAMES]; // full-speed bus time (byte-times) allocated in each frame
+} ehci_budget_tt_t;
+
+// Periodic bandwidth reserved by an endpoint
+typedef struct {
+  uint8_t  frame_phase;    // first serviced frame in budget window
+  uint8_t  frame_period;   // frames between serviced frames: 1, 2, 4 or 8
+  uint8_t  smask;          // microframes of transaction (iTD) or start-split (siTD) in serviced frame
+  uint8_t  cmask;          // microframes of complete-split in serviced frame, siTD IN only
+  uint16_t uframe_cost[8]; // highspeed bus time of each microframe in serviced frame
+  uint16_t tt_cost;        // full-speed bus time of serviced frame, 0 if not split
+} ehci_budget_rsv_t;
+
+// Highspeed bus time of a transaction in byte-times: protocol overhead and worst case bit stuffing (USB 2.0 5.11.3)
+TU_ATTR_ALWAYS_INLINE static inline uint16_t ehci_budget_hs_xact(uint16_t bytes, bool is_iso) {
+  return (uint16_t) ((is_iso ? 38u : 55u) + (7u * bytes) / 6u);
+}
+
+// Full-speed bus time of an isochronous transaction: 9 bytes protocol overhead (USB 2.0 Table 5-4)
+TU_ATTR_ALWAYS_INLINE static inline uint16_t ehci_budget_fs_iso_xact(uint16_t bytes) {
+  return (uint16_t) (bytes + 9u);
+}
+
+// Check if reservation fits into remaining budget. tt is NULL for highspeed endpoint
+static inline bool ehci_budget_fits(const ehci_budget_t* budget, const ehci_budget_tt_t* tt,
+                                    const ehci_budget_rsv_t* rsv) {
+  for (uint8_t f = rsv->frame_phase; f < EHCI_BUDGET_FRAMES; f += rsv->frame_period) {
+    if (tt != NULL && tt->fs[f] + rsv->tt_cost > EHCI_BUDGET_FS_FRAME_MAX) {
+      return false;
+    }
+    for (uint8_t u = 0; u < 8; u++) {
+      if (budget->hs[f * 8 + u] + rsv->uframe_cost[u] > EHCI_BUDGET_HS_UFRAME_MAX) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Allocate (reserve = true) or release reservation
+static inline void ehci_budget_update(ehci_budget_t* budget, ehci_budget_tt_t* tt, const ehci_budget_rsv_t* rsv,
+                                      bool reserve) {
+  for (uint8_t f = rsv->frame_phase; f < EHCI_BUDGET_FRAMES; f += rsv->frame_period) {
+    if (tt != NULL) {
+      tt->fs[f] = (uint16_t) (reserve ? tt->fs[f] + rsv->tt_cost : tt->fs[f] - rsv->tt_cost);
+    }
+    for (uint8_t u = 0; u < 8; u++) {
+      uint16_t* hs = &budget->hs[f * 8 + u];
+      *hs = (uint16_t) (reserve ? *hs + rsv->uframe_cost[u] : *hs - rsv->uframe_cost[u]);
+    }
+  }
+}
+
+// Reserve bandwidth for highspeed isochronous endpoint at the first microframe phase that fits.
+// interval is in microframes, each service has mult transactions of mps bytes
+static inline bool ehci_budget_itd_reserve(ehci_budget_t* budget, ehci_budget_rsv_t* rsv, uint16_t mps, uint8_t mult,
+                                           uint16_t interval) {
+  const uint16_t cost = (uint16_t) (mult * ehci_budget_hs_xact(mps, true));
+  const uint16_t period = tu_min16(interval, EHCI_BUDGET_UFRAMES);
+
+  for (uint16_t phase = 0; phase < period; phase++) {
+    tu_memclr(rsv, sizeof(ehci_budget_rsv_t));
+    if (period < 8) {
+      // several transactions in every frame
+      rsv->frame_period = 1;
+      for (uint8_t u = (uint8_t) phase; u < 8; u += period) {
+        rsv->smask |= TU_BIT(u);
+        rsv->uframe_cost[u] = cost;
+      }
+    } else {
+      // one transaction in every serviced frame
+      const uint8_t u = (uint8_t) (phase % 8);
+      rsv->frame_phase = (uint8_t) (phase / 8);
+      rsv->frame_period = (uint8_t) (period / 8);
+      rsv->smask = TU_BIT(u);
+      rsv->uframe_cost[u] = cost;
+    }
+
+    if (ehci_budget_fits(budget, NULL, rsv)) {
+      ehci_budget_update(budget, NULL, rsv, true);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Reserve bandwidth for full-speed isochronous endpoint behind a TT at the first frame phase that fits.
+// interval is in frames. Transaction is placed after what is already allocated in the TT's frame: OUT data is sent with
+// one start-split per microframe, IN data is collected with complete-splits starting 2 microframes after start-split
+// (EHCI 4.12.3). Split must end within the frame since siTD back pointer is not used.
+static inline bool ehci_budget_sitd_reserve(ehci_budget_t* budget, ehci_budget_tt_t* tt, ehci_budget_rsv_t* rsv,
+                                            uint16_t mps, bool is_in, uint16_t interval) {
+  const uint16_t period = tu_min16(interval, EHCI_BUDGET_FRAMES);
+  const uint8_t nsplit = (uint8_t) tu_max32(1, tu_div_ceil(mps, EHCI_BUDGET_FS_UFRAME));
+
+  for (uint16_t phase = 0; phase < period; phase++) {
+    uint16_t tt_load = 0;
+    for (uint16_t f = phase; f < EHCI_BUDGET_FRAMES; f += period) {
+      tt_load = tu_max16(tt_load, tt->fs[f]);
+    }
+    const uint8_t start = (uint8_t) (tt_load / EHCI_BUDGET_FS_UFRAME);
+
+    // data on full-speed bus occupies microframe start+1 to start+nsplit
+    if (start + nsplit + (is_in ? 1 : 0) > 7) {
+      continue;
+    }
+
+    tu_memclr(rsv, sizeof(ehci_budget_rsv_t));
+    rsv->frame_phase = (uint8_t) phase;
+    rsv->frame_period = (uint8_t) period;
+    rsv->tt_cost = ehci_budget_fs_iso_xact(mps);
+
+    uint16_t remain = mps;
+    if (is_in) {
+      // complete-split after each microframe of data, plus one more if it fits in the frame (USB 2.0 11.18.4)
+      const uint8_t last = tu_min8((uint8_t) (start + nsplit + 2), 7);
+      rsv->smask = TU_BIT(start);
+      rsv->uframe_cost[start] = ehci_budget_hs_xact(0, true);
+      for (uint8_t u = (uint8_t) (start + 2); u <= last; u++) {
+        const uint16_t bytes = tu_min16(remain, EHCI_BUDGET_FS_UFRAME);
+        rsv->cmask |= TU_BIT(u);
+        rsv->uframe_cost[u] = ehci_budget_hs_xact(bytes, true);
+        remain -= bytes;
+      }
+    } else {
+      for (uint8_t u = start; u < (uint8_t) (start + nsplit); u++) {
+        const uint16_t bytes = tu_min16(remain, EHCI_BUDGET_FS_UFRAME);
+        rsv->smask |= TU_BIT(u);
+        rsv->uframe_cost[u] = ehci_budget_hs_xact(bytes, true);
+        remain -= bytes;
+      }
+    }
+
+    if (ehci_budget_fits(budget, tt, rsv)) {
+      ehci_budget_update(budget, tt, rsv, true);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//--------------------------------------------------------------------+
+// Highspeed Isochronous Transfer Descriptor
+//--------------------------------------------------------------------+
+
+// Init iTD with endpoint info stored in lower bits of buffer pointers (EHCI 3.3.3), page addresses are updated per
+// transfer by ehci_itd_build()
+static inline void ehci_itd_init(ehci_itd_t* itd, uint8_t dev_addr, uint8_t ep_addr, uint16_t mps, uint8_t mult) {
+  tu_memclr(itd, sizeof(ehci_itd_t));
+  itd->next.terminate = 1;
+  itd->BufferPointer[0] = (uint32_t) dev_addr | ((uint32_t) tu_edpt_number(ep_addr) << 8);
+  itd->BufferPointer[1] = (uint32_t) mps | ((uint32_t) tu_edpt_dir(ep_addr) << 11);
+  itd->BufferPointer[2] = mult;
+}
+
+// Build iTDs for a transfer of consecutive transactions, each up to xact_max bytes. Transactions are at microframe
+// uframe, uframe + interval ... of each frame if interval < 8 (uframe < interval), otherwise one transaction per iTD.
+// IN transaction N is received at buf_addr + N * xact_max. Only the last transaction has IOC set.
+// Return number of iTDs used, 0 if itd_count is too small
+static inline uint8_t ehci_itd_build(ehci_itd_t* itd_list, uint8_t itd_count, uint32_t buf_addr, uint32_t len,
+                                     uint16_t xact_max, uint8_t uframe, uint16_t interval) {
+  const uint8_t step = (uint8_t) tu_min16(interval, 8);
+  const uint32_t xact_count = (len == 0) ? 1 : tu_div_ceil(len, xact_max);
+  const uint32_t xact_per_itd = tu_div_ceil(8u - uframe, step);
+  const uint32_t count = tu_div_ceil(xact_count, xact_per_itd);
+  TU_VERIFY(count <= itd_count, 0);
+
+  uint32_t offset = 0;
+  uint32_t xact_done = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    ehci_itd_t* itd = &itd_list[i];
+    const uint32_t page0 = tu_align4k(buf_addr + offset);
+
+    // up to 8 x 3072 bytes starting at any offset span 7 pages
+    for (uint8_t p = 0; p < 7; p++) {
+      itd->BufferPointer[p] = (itd->BufferPointer[p] & 0xFFFu) | (page0 + 4096u * p);
+    }
+    tu_memclr(itd->xact, sizeof(itd->xact));
+
+    for (uint8_t u = uframe; u < 8 && xact_done < xact_count; u += step) {
+      const uint32_t addr = buf_addr + offset;
+      const uint32_t bytes = tu_min32(len - offset, xact_max);
+
+      itd->xact[u].offset = addr & 0xFFFu;
+      itd->xact[u].page_select = (addr >> 12) - (page0 >> 12);
+      itd->xact[u].length = bytes;
+      itd->xact[u].int_on_complete = (xact_done == xact_count - 1) ? 1 : 0;
+      itd->xact[u].active = 1;
+
+      offset += bytes;
+      xact_done++;
+    }
+  }
+
+  return (uint8_t) count;
+}
+
+// Check if any transaction of iTD is still active
+TU_ATTR_ALWAYS_INLINE static inline bool ehci_itd_active(const ehci_itd_t* itd) {
+  for (uint8_t u = 0; u < 8; u++) {
+    if (itd->xact[u].active) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Add bytes of a completed iTD to xferred: received bytes for IN, scheduled bytes for OUT. Transaction with error
+// is not counted. Return false if any transaction has error
+static inline bool ehci_itd_xferred(const ehci_itd_t* itd, uint32_t* xferred) {
+  bool result = true;
+  for (uint8_t u = 0; u < 8; u++) {
+    if (itd->xact[u].error || itd->xact[u].babble_err || itd->xact[u].buffer_err) {
+      result = false;
+    } else {
+      *xferred += itd->xact[u].length;
+    }
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------+
+// Split (Full-Speed) Isochronous Transfer Descriptor
+//--------------------------------------------------------------------+
+
+// Transaction position of OUT start-split (EHCI 3.4.5)
+enum {
+  EHCI_SITD_TP_ALL   = 0,
+  EHCI_SITD_TP_BEGIN = 1,
+  EHCI_SITD_TP_MID   = 2,
+  EHCI_SITD_TP_END   = 3
+};
+
+// Init siTD with endpoint characteristics and microframe schedule, set once when endpoint is opened
+static inline void ehci_sitd_init(ehci_sitd_t* sitd, uint8_t dev_addr, uint8_t ep_addr, uint8_t hub_addr,
+                                  uint8_t hub_port, uint8_t smask, uint8_t cmask) {
+  tu_memclr(sitd, sizeof(ehci_sitd_t));
+  sitd->next.terminate = 1;
+  sitd->back.terminate = 1;
+
+  sitd->dev_addr     = dev_addr;
+  sitd->ep_number    = tu_edpt_number(ep_addr);
+  sitd->hub_addr     = hub_addr;
+  sitd->port_number  = hub_port;
+  sitd->direction    = tu_edpt_dir(ep_addr);
+  sitd->int_smask    = smask;
+  sitd->fl_int_cmask = cmask;
+}
+
+// Build siTDs for a transfer, one packet of up to mps bytes per siTD. Packet N is at buf_addr + N * mps.
+// Only the last siTD has IOC set. Return number of siTDs used, 0 if sitd_count is too small
+static inline uint8_t ehci_sitd_build(ehci_sitd_t* sitd_list, uint8_t sitd_count, uint32_t buf_addr, uint32_t len,
+                                      uint16_t mps) {
+  const uint32_t count = (len == 0) ? 1 : tu_div_ceil(len, mps);
+  TU_VERIFY(count <= sitd_count, 0);
+
+  for (uint32_t i = 0; i < count; i++) {
+    ehci_sitd_t* sitd = &sitd_list[i];
+    const uint32_t addr = buf_addr + i * mps;
+    const uint16_t bytes = (uint16_t) tu_min32(len - i * mps, mps);
+
+    sitd->split_state     = 0;
+    sitd->missed_uframe   = 0;
+    sitd->xact_err        = 0;
+    sitd->babble_err      = 0;
+    sitd->buffer_err      = 0;
+    sitd->error           = 0;
+    sitd->cmask_progress  = 0;
+    sitd->total_bytes     = bytes;
+    sitd->page_select     = 0;
+    sitd->int_on_complete = (i == count - 1) ? 1 : 0;
+    sitd->expected_bytes  = bytes;
+
+    sitd->buffer[0] = addr; // include current offset
+    sitd->buffer[1] = tu_align4k(addr) + 4096u;
+    if (sitd->direction == 0) {
+      // OUT: number of start-splits, each carries up to 188 bytes
+      const uint32_t tcount = tu_max32(1, tu_div_ceil(bytes, EHCI_BUDGET_FS_UFRAME));
+      const uint32_t tp = (tcount == 1) ? EHCI_SITD_TP_ALL : EHCI_SITD_TP_BEGIN;
+      sitd->buffer[1] |= (tp << 3) | tcount;
+    }
+
+    sitd->active = 1;
+  }
+
+  return (uint8_t) count;
+}
+
+// Add bytes of a completed siTD to xferred. Return false if transaction has error
+static inline bool ehci_sitd_xferred(const ehci_sitd_t* sitd, uint32_t* xferred) {
+  if (sitd->error || sitd->xact_err || sitd->babble_err || sitd->buffer_err || sitd->missed_uframe) {
+    return false;
+  }
+  *xferred += (uint32_t) (sitd->expected_bytes - sitd->total_bytes);
+  return true;
+}
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -497,7 +497,7 @@ static void dcd_transmit_packet(xfer_ctl_t *xfer, uint8_t ep_ix) {
 }
 
 // Submit a transfer, When complete dcd_event_xfer_complete() is invoked to notify the stack
-bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer, uint16_t total_bytes, bool is_isr) {
+bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer, uint32_t total_bytes, bool is_isr) {
   (void)is_isr;
   (void)rhport;
   const uint8_t epnum = tu_edpt_number(ep_addr);
@@ -359,7 +359,7 @@ bool dcd_edpt_iso_activate(uint8_t rhport, const tusb_desc_endpoint_t *desc_ep)
 }
   #endif
 
-bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t  *buffer, uint16_t total_bytes, bool is_isr) {
+bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t  *buffer, uint32_t total_bytes, bool is_isr) {
   (void) is_isr;
   (void)rhport;
   NVIC_DisableIRQ(USB_FS_IRQn);
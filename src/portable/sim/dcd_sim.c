@@ -0,0 +1,665 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if CFG_TUD_ENABLED && CFG_TUD_SIM
+
+#include "device/dcd.h"
+#include "dcd_sim.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// Largest packet the scripted host can move (highspeed iso)
+#define SIM_PACKET_SIZE_MAX 1024
+
+typedef struct {
+  uint8_t*   buffer;
+  tu_fifo_t* ff;
+  uint16_t   total_len;
+  uint16_t   actual_len;
+  uint16_t   mps;
+  uint8_t    xfer_type;
+  bool       opened;
+  bool       active;
+  bool       stalled;
+  dcd_sim_edpt_stats_t stats;
+} sim_edpt_t;
+
+enum {
+  SIM_CONTROL_IDLE = 0,
+  SIM_CONTROL_SETUP,
+  SIM_CONTROL_DATA,
+  SIM_CONTROL_STATUS,
+};
+
+typedef struct {
+  tusb_control_request_t request;
+  uint8_t*               buffer;
+  dcd_sim_control_cb_t   complete_cb;
+  uint16_t               xferred;
+  uint8_t                stage;
+} sim_control_t;
+
+typedef struct {
+  dcd_sim_stream_t const* cfg;
+  uint32_t                xferred;
+} sim_stream_t;
+
+typedef struct {
+  bool        connected; // pull-up enabled
+  bool        attached;  // host has reset the bus
+  bool        suspended;
+  bool        sof_enabled;
+  bool        int_enabled;
+  uint8_t     speed;
+  uint8_t     addr;
+  uint8_t     pending_addr; // applied after status stage of SET_ADDRESS
+  bool        addr_pending;
+  uint32_t    uframe_count;
+
+  sim_edpt_t edpt[TUP_DCD_ENDPOINT_MAX][2];
+
+  // scripted host
+  sim_control_t control;
+  sim_stream_t  stream[CFG_DCD_SIM_STREAM_MAX];
+} sim_dcd_t;
+
+static sim_dcd_t _sim;
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static sim_edpt_t* edpt_get(uint8_t ep_addr) {
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  if (epnum >= TUP_DCD_ENDPOINT_MAX) {
+    return NULL;
+  }
+  return &_sim.edpt[epnum][tu_edpt_dir(ep_addr)];
+}
+
+static void edpt_reset(sim_edpt_t* ep) {
+  ep->buffer     = NULL;
+  ep->ff         = NULL;
+  ep->total_len  = 0;
+  ep->actual_len = 0;
+  ep->opened     = false;
+  ep->active     = false;
+  ep->stalled    = false;
+}
+
+static void edpt0_open(void) {
+  for (uint8_t dir = 0; dir < 2; dir++) {
+    sim_edpt_t* ep = &_sim.edpt[0][dir];
+    edpt_reset(ep);
+    ep->mps       = CFG_TUD_ENDPOINT0_SIZE;
+    ep->xfer_type = TUSB_XFER_CONTROL;
+    ep->opened    = true;
+  }
+}
+
+static void edpt_complete(uint8_t rhport, uint8_t ep_addr, sim_edpt_t* ep) {
+  ep->active = false;
+  ep->stats.xfer_count++;
+
+  // SET_ADDRESS takes effect once its status stage is acknowledged
+  if (ep_addr == 0x80 && _sim.addr_pending) {
+    _sim.addr         = _sim.pending_addr;
+    _sim.addr_pending = false;
+  }
+
+  dcd_event_xfer_complete(rhport, ep_addr, ep->actual_len, XFER_RESULT_SUCCESS, true);
+}
+
+static bool edpt_xfer_init(uint8_t ep_addr, uint8_t* buffer, tu_fifo_t* ff, uint16_t total_bytes) {
+  sim_edpt_t* ep = edpt_get(ep_addr);
+  TU_ASSERT(ep != NULL && ep->opened);
+
+  ep->buffer     = buffer;
+  ep->ff         = ff;
+  ep->total_len  = total_bytes;
+  ep->actual_len = 0;
+  ep->active     = true;
+
+  return true;
+}
+
+static void control_reset(void) {
+  tu_memclr(&_sim.control, sizeof(_sim.control));
+}
+
+//--------------------------------------------------------------------+
+// Controller API
+//--------------------------------------------------------------------+
+
+bool dcd_init(uint8_t rhport, const tusb_rhport_init_t* rh_init) {
+  (void) rh_init;
+  tu_memclr(&_sim, sizeof(_sim));
+  edpt0_open();
+  dcd_connect(rhport);
+  return true;
+}
+
+bool dcd_deinit(uint8_t rhport) {
+  (void) rhport;
+  tu_memclr(&_sim, sizeof(_sim));
+  return true;
+}
+
+// Events are raised synchronously by the host API, there is no interrupt to service
+void dcd_int_handler(uint8_t rhport) {
+  (void) rhport;
+}
+
+void dcd_int_enable(uint8_t rhport) {
+  (void) rhport;
+  _sim.int_enabled = true;
+}
+
+void dcd_int_disable(uint8_t rhport) {
+  (void) rhport;
+  _sim.int_enabled = false;
+}
+
+// Receive Set Address request, mcu port must also include status IN response
+void dcd_set_address(uint8_t rhport, uint8_t dev_addr) {
+  _sim.pending_addr = dev_addr;
+  _sim.addr_pending = true;
+  dcd_edpt_xfer(rhport, 0x80, NULL, 0, false);
+}
+
+void dcd_remote_wakeup(uint8_t rhport) {
+  // host resumes the bus right away
+  if (_sim.suspended) {
+    dcd_sim_resume(rhport);
+  }
+}
+
+void dcd_connect(uint8_t rhport) {
+  (void) rhport;
+  _sim.connected = true;
+}
+
+void dcd_disconnect(uint8_t rhport) {
+  (void) rhport;
+  _sim.connected = false;
+  _sim.attached  = false;
+}
+
+void dcd_sof_enable(uint8_t rhport, bool en) {
+  (void) rhport;
+  _sim.sof_enabled = en;
+}
+
+//--------------------------------------------------------------------+
+// Endpoint API
+//--------------------------------------------------------------------+
+
+bool dcd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const* desc_ep) {
+  (void) rhport;
+  sim_edpt_t* ep = edpt_get(desc_ep->bEndpointAddress);
+  TU_ASSERT(ep != NULL);
+
+  edpt_reset(ep);
+  ep->mps       = tu_edpt_packet_size(desc_ep);
+  ep->xfer_type = desc_ep->bmAttributes.xfer;
+  ep->opened    = true;
+
+  return true;
+}
+
+void dcd_edpt_close_all(uint8_t rhport) {
+  (void) rhport;
+  for (uint8_t epnum = 1; epnum < TUP_DCD_ENDPOINT_MAX; epnum++) {
+    edpt_reset(&_sim.edpt[epnum][TUSB_DIR_OUT]);
+    edpt_reset(&_sim.edpt[epnum][TUSB_DIR_IN]);
+  }
+}
+
+#if defined(TUP_DCD_EDPT_ISO_ALLOC)
+bool dcd_edpt_iso_alloc(uint8_t rhport, uint8_t ep_addr, uint16_t largest_packet_size) {
+  (void) rhport;
+  sim_edpt_t* ep = edpt_get(ep_addr);
+  TU_ASSERT(ep != NULL && largest_packet_size <= SIM_PACKET_SIZE_MAX);
+
+  edpt_reset(ep);
+  ep->mps       = largest_packet_size;
+  ep->xfer_type = TUSB_XFER_ISOCHRONOUS;
+
+  return true;
+}
+
+bool dcd_edpt_iso_activate(uint8_t rhport, tusb_desc_endpoint_t const* desc_ep) {
+  (void) rhport;
+  sim_edpt_t* ep = edpt_get(desc_ep->bEndpointAddress);
+  TU_ASSERT(ep != NULL && tu_edpt_packet_size(desc_ep) <= SIM_PACKET_SIZE_MAX);
+
+  edpt_reset(ep);
+  ep->mps       = tu_edpt_packet_size(desc_ep);
+  ep->xfer_type = TUSB_XFER_ISOCHRONOUS;
+  ep->opened    = true;
+
+  return true;
+}
+#else
+void dcd_edpt_close(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  sim_edpt_t* ep = edpt_get(ep_addr);
+  if (ep != NULL) {
+    edpt_reset(ep);
+  }
+}
+#endif
+
+bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint32_t total_bytes, bool is_isr) {
+  (void) rhport;
+  (void) is_isr;
+  TU_ASSERT(total_bytes <= TUP_DCD_EDPT_XFER_MAX); // larger transfer is split by usbd
+  return edpt_xfer_init(ep_addr, buffer, NULL, (uint16_t) total_bytes);
+}
+
+bool dcd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t* ff, uint16_t total_bytes, bool is_isr) {
+  (void) rhport;
+  (void) is_isr;
+  return edpt_xfer_init(ep_addr, NULL, ff, total_bytes);
+}
+
+void dcd_edpt_stall(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  sim_edpt_t* ep = edpt_get(ep_addr);
+  if (ep != NULL) {
+    ep->stalled = true;
+    ep->active  = false;
+  }
+}
+
+void dcd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  sim_edpt_t* ep = edpt_get(ep_addr);
+  if (ep != NULL) {
+    ep->stalled = false;
+  }
+}
+
+//--------------------------------------------------------------------+
+// Bus API
+//--------------------------------------------------------------------+
+
+bool dcd_sim_bus_reset(uint8_t rhport, tusb_speed_t speed) {
+  TU_VERIFY(_sim.connected);
+
+  _sim.attached     = true;
+  _sim.suspended    = false;
+  _sim.speed        = (uint8_t) speed;
+  _sim.addr         = 0;
+  _sim.addr_pending = false;
+  _sim.uframe_count = 0;
+
+  dcd_edpt_close_all(rhport);
+  edpt0_open();
+  control_reset();
+  for (uint8_t i = 0; i < CFG_DCD_SIM_STREAM_MAX; i++) {
+    _sim.stream[i].cfg = NULL;
+  }
+
+  dcd_event_bus_reset(rhport, speed, true);
+  return true;
+}
+
+void dcd_sim_unplug(uint8_t rhport) {
+  _sim.attached = false;
+  control_reset();
+  dcd_event_bus_signal(rhport, DCD_EVENT_UNPLUGGED, true);
+}
+
+void dcd_sim_suspend(uint8_t rhport) {
+  if (_sim.attached && !_sim.suspended) {
+    _sim.suspended = true;
+    dcd_event_bus_signal(rhport, DCD_EVENT_SUSPEND, true);
+  }
+}
+
+void dcd_sim_resume(uint8_t rhport) {
+  if (_sim.attached && _sim.suspended) {
+    _sim.suspended = false;
+    dcd_event_bus_signal(rhport, DCD_EVENT_RESUME, true);
+  }
+}
+
+bool dcd_sim_connected(uint8_t rhport) {
+  (void) rhport;
+  return _sim.connected;
+}
+
+uint8_t dcd_sim_address(uint8_t rhport) {
+  (void) rhport;
+  return _sim.addr;
+}
+
+void dcd_sim_sof(uint8_t rhport) {
+  if (!_sim.attached || _sim.suspended) {
+    return;
+  }
+
+  _sim.uframe_count++;
+
+  if (_sim.sof_enabled) {
+    // highspeed reports 14-bit microframe index as FRINDEX of DWC2/ChipIdea, fullspeed reports 11-bit frame number
+    uint32_t const frame_mask = (_sim.speed == TUSB_SPEED_HIGH) ? 0x3FFFu : 0x7FFu;
+    dcd_event_sof(rhport, _sim.uframe_count & frame_mask, true);
+  }
+}
+
+//--------------------------------------------------------------------+
+// Packet API
+//--------------------------------------------------------------------+
+
+dcd_sim_handshake_t dcd_sim_setup(uint8_t rhport, tusb_control_request_t const* request) {
+  // SETUP cannot be NAKed or STALLed and aborts any pending control transfer
+  for (uint8_t dir = 0; dir < 2; dir++) {
+    _sim.edpt[0][dir].active  = false;
+    _sim.edpt[0][dir].stalled = false;
+  }
+  _sim.addr_pending = false;
+
+  dcd_event_setup_received(rhport, (uint8_t const*) request, true);
+  return DCD_SIM_ACK;
+}
+
+dcd_sim_handshake_t dcd_sim_out(uint8_t rhport, uint8_t ep_addr, uint8_t const* data, uint16_t len) {
+  uint8_t const out_addr = tu_edpt_addr(tu_edpt_number(ep_addr), TUSB_DIR_OUT);
+  sim_edpt_t* ep = edpt_get(out_addr);
+  if (ep == NULL || !ep->opened || !_sim.attached) {
+    return DCD_SIM_NAK;
+  }
+
+  if (ep->stalled) {
+    ep->stats.stall_count++;
+    return DCD_SIM_STALL;
+  }
+
+  if (!ep->active) {
+    ep->stats.nak_count++;
+    return DCD_SIM_NAK;
+  }
+
+  // excess data (babble) is dropped
+  uint16_t const count = tu_min16(len, ep->total_len - ep->actual_len);
+  if (count > 0) {
+    if (ep->ff != NULL) {
+      tu_fifo_write_n(ep->ff, data, count);
+    } else {
+      memcpy(ep->buffer + ep->actual_len, data, count);
+    }
+  }
+  ep->actual_len += count;
+  ep->stats.packet_count++;
+  ep->stats.byte_count += count;
+
+  if (len < ep->mps || ep->actual_len >= ep->total_len) {
+    edpt_complete(rhport, out_addr, ep);
+  }
+
+  return DCD_SIM_ACK;
+}
+
+dcd_sim_handshake_t dcd_sim_in(uint8_t rhport, uint8_t ep_addr, uint8_t* data, uint16_t* len) {
+  uint8_t const in_addr = tu_edpt_addr(tu_edpt_number(ep_addr), TUSB_DIR_IN);
+  sim_edpt_t* ep = edpt_get(in_addr);
+  uint16_t const bufsize = *len;
+  *len = 0;
+
+  if (ep == NULL || !ep->opened || !_sim.attached) {
+    return DCD_SIM_NAK;
+  }
+
+  if (ep->stalled) {
+    ep->stats.stall_count++;
+    return DCD_SIM_STALL;
+  }
+
+  if (!ep->active) {
+    ep->stats.nak_count++;
+    return DCD_SIM_NAK;
+  }
+
+  uint16_t const count = tu_min16(ep->mps, ep->total_len - ep->actual_len);
+  TU_ASSERT(count <= bufsize, DCD_SIM_NAK);
+
+  if (count > 0) {
+    if (ep->ff != NULL) {
+      tu_fifo_read_n(ep->ff, data, count);
+    } else {
+      memcpy(data, ep->buffer + ep->actual_len, count);
+    }
+  }
+  ep->actual_len += count;
+  ep->stats.packet_count++;
+  ep->stats.byte_count += count;
+  *len = count;
+
+  if (count < ep->mps || ep->actual_len >= ep->total_len) {
+    edpt_complete(rhport, in_addr, ep);
+  }
+
+  return DCD_SIM_ACK;
+}
+
+dcd_sim_edpt_stats_t const* dcd_sim_edpt_stats(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  sim_edpt_t* ep = edpt_get(ep_addr);
+  return (ep != NULL) ? &ep->stats : NULL;
+}
+
+void dcd_sim_edpt_stats_clear(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  sim_edpt_t* ep = edpt_get(ep_addr);
+  if (ep != NULL) {
+    tu_memclr(&ep->stats, sizeof(ep->stats));
+  }
+}
+
+//--------------------------------------------------------------------+
+// Scripted Host
+//--------------------------------------------------------------------+
+
+bool dcd_sim_control_xfer(uint8_t rhport, tusb_control_request_t const* request, void* buffer,
+                          dcd_sim_control_cb_t complete_cb) {
+  (void) rhport;
+  TU_VERIFY(_sim.control.stage == SIM_CONTROL_IDLE);
+  TU_ASSERT(request->wLength == 0 || buffer != NULL);
+
+  _sim.control.request     = *request;
+  _sim.control.buffer      = (uint8_t*) buffer;
+  _sim.control.complete_cb = complete_cb;
+  _sim.control.xferred     = 0;
+  _sim.control.stage       = SIM_CONTROL_SETUP;
+
+  return true;
+}
+
+bool dcd_sim_control_busy(uint8_t rhport) {
+  (void) rhport;
+  return _sim.control.stage != SIM_CONTROL_IDLE;
+}
+
+static void control_done(uint8_t rhport, xfer_result_t result) {
+  sim_control_t* ctrl = &_sim.control;
+  tusb_control_request_t const request = ctrl->request;
+  dcd_sim_control_cb_t const cb = ctrl->complete_cb;
+  uint16_t const xferred = ctrl->xferred;
+
+  control_reset();
+  if (cb != NULL) {
+    cb(rhport, &request, result, xferred);
+  }
+}
+
+// Run control stages until device NAKs, return false if no progress is possible in this frame
+static bool control_step(uint8_t rhport) {
+  sim_control_t* ctrl = &_sim.control;
+  uint16_t const wLength = tu_le16toh(ctrl->request.wLength);
+  bool const data_in = (ctrl->request.bmRequestType_bit.direction == TUSB_DIR_IN);
+  dcd_sim_handshake_t hs;
+
+  switch (ctrl->stage) {
+    case SIM_CONTROL_SETUP:
+      dcd_sim_setup(rhport, &ctrl->request);
+      ctrl->stage = wLength ? SIM_CONTROL_DATA : SIM_CONTROL_STATUS;
+      return true;
+
+    case SIM_CONTROL_DATA: {
+      uint16_t const mps = _sim.edpt[0][data_in ? TUSB_DIR_IN : TUSB_DIR_OUT].mps;
+      uint16_t count = tu_min16(mps, wLength - ctrl->xferred);
+
+      if (data_in) {
+        hs = dcd_sim_in(rhport, 0x80, ctrl->buffer + ctrl->xferred, &count);
+      } else {
+        hs = dcd_sim_out(rhport, 0x00, ctrl->buffer + ctrl->xferred, count);
+      }
+
+      if (hs == DCD_SIM_ACK) {
+        ctrl->xferred += count;
+        if (count < mps || ctrl->xferred >= wLength) {
+          ctrl->stage = SIM_CONTROL_STATUS;
+        }
+      }
+      break;
+    }
+
+    case SIM_CONTROL_STATUS:
+      if (data_in) {
+        hs = dcd_sim_out(rhport, 0x00, NULL, 0);
+      } else {
+        uint16_t count = 0;
+        hs = dcd_sim_in(rhport, 0x80, NULL, &count);
+      }
+
+      if (hs == DCD_SIM_ACK) {
+        control_done(rhport, XFER_RESULT_SUCCESS);
+        return false;
+      }
+      break;
+
+    default:
+      return false;
+  }
+
+  if (hs == DCD_SIM_STALL) {
+    control_done(rhport, XFER_RESULT_STALLED);
+    return false;
+  }
+
+  return hs == DCD_SIM_ACK;
+}
+
+static sim_stream_t* stream_find(uint8_t ep_addr) {
+  for (uint8_t i = 0; i < CFG_DCD_SIM_STREAM_MAX; i++) {
+    sim_stream_t* s = &_sim.stream[i];
+    if (s->cfg != NULL && s->cfg->ep_addr == ep_addr) {
+      return s;
+    }
+  }
+  return NULL;
+}
+
+bool dcd_sim_stream_start(uint8_t rhport, dcd_sim_stream_t const* stream) {
+  (void) rhport;
+  TU_ASSERT(stream->ep_addr != 0 && stream->packet_size <= SIM_PACKET_SIZE_MAX);
+  TU_VERIFY(stream_find(stream->ep_addr) == NULL);
+
+  sim_stream_t* s = NULL;
+  for (uint8_t i = 0; i < CFG_DCD_SIM_STREAM_MAX && s == NULL; i++) {
+    if (_sim.stream[i].cfg == NULL) {
+      s = &_sim.stream[i];
+    }
+  }
+  TU_ASSERT(s != NULL);
+
+  s->cfg     = stream;
+  s->xferred = 0;
+
+  return true;
+}
+
+void dcd_sim_stream_stop(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  sim_stream_t* s = stream_find(ep_addr);
+  if (s != NULL) {
+    s->cfg = NULL;
+  }
+}
+
+uint32_t dcd_sim_stream_bytes(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  sim_stream_t* s = stream_find(ep_addr);
+  return (s != NULL) ? s->xferred : 0;
+}
+
+static void stream_run(uint8_t rhport, sim_stream_t* s) {
+  static uint8_t pkt_buf[SIM_PACKET_SIZE_MAX];
+
+  dcd_sim_stream_t const* cfg = s->cfg;
+  sim_edpt_t* ep = edpt_get(cfg->ep_addr);
+  if (ep == NULL || !ep->opened) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < cfg->packets_per_frame; i++) {
+    uint16_t size = cfg->packet_size ? cfg->packet_size : ep->mps;
+    size = tu_min16(size, SIM_PACKET_SIZE_MAX);
+
+    if (cfg->total_bytes) {
+      if (s->xferred >= cfg->total_bytes) {
+        return;
+      }
+      size = (uint16_t) tu_min32(size, cfg->total_bytes - s->xferred);
+    }
+
+    dcd_sim_handshake_t hs;
+    if (tu_edpt_dir(cfg->ep_addr) == TUSB_DIR_OUT) {
+      if (cfg->out_source != NULL) {
+        size = cfg->out_source(rhport, cfg->ep_addr, pkt_buf, size);
+      } else {
+        tu_memclr(pkt_buf, size);
+      }
+      hs = dcd_sim_out(rhport, cfg->ep_addr, pkt_buf, size);
+    } else {
+      size = sizeof(pkt_buf);
+      hs = dcd_sim_in(rhport, cfg->ep_addr, pkt_buf, &size);
+      if (hs == DCD_SIM_ACK && cfg->in_sink != NULL) {
+        cfg->in_sink(rhport, cfg->ep_addr, pkt_buf, size);
+      }
+    }
+
+    // non-isochronous endpoints are retried next frame once NAKed
+    if (hs != DCD_SIM_ACK) {
+      return;
+    }
+    s->xferred += size;
+  }
+}
+
+void dcd_sim_frame(uint8_t rhport) {
+  dcd_sim_sof(rhport);
+  if (!_sim.attached || _sim.suspended) {
+    return;
+  }
+
+  while (control_step(rhport)) {}
+
+  for (uint8_t i = 0; i < CFG_DCD_SIM_STREAM_MAX; i++) {
+    if (_sim.stream[i].cfg != NULL) {
+      stream_run(rhport, &_sim.stream[i]);
+    }
+  }
+}
+
+#endif
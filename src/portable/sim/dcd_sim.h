@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_DCD_SIM_H_
+#define TUSB_DCD_SIM_H_
+
+#include "common/tusb_common.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+// Simulated device controller for host (PC) builds. Instead of hardware, the "bus" is driven by calling the
+// host-side API below: either packet by packet (setup/out/in) or with the scripted host model that replays
+// control requests and periodic streams one (micro)frame at a time. All events are delivered from the caller
+// context with in_isr = true, application is expected to run tud_task() between frames.
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+// Max number of concurrent streams the scripted host can run
+#ifndef CFG_DCD_SIM_STREAM_MAX
+  #define CFG_DCD_SIM_STREAM_MAX 4
+#endif
+
+//--------------------------------------------------------------------+
+// Types
+//--------------------------------------------------------------------+
+
+// Handshake returned to the host for a data/setup packet
+typedef enum {
+  DCD_SIM_ACK = 0,
+  DCD_SIM_NAK,
+  DCD_SIM_STALL,
+} dcd_sim_handshake_t;
+
+typedef struct {
+  uint32_t xfer_count;   // completed transfers
+  uint32_t packet_count; // ACKed data packets
+  uint32_t nak_count;
+  uint32_t stall_count;
+  uint64_t byte_count;
+} dcd_sim_edpt_stats_t;
+
+// Scripted control transfer complete: result is XFER_RESULT_SUCCESS or XFER_RESULT_STALLED
+typedef void (*dcd_sim_control_cb_t)(uint8_t rhport, tusb_control_request_t const* request, xfer_result_t result,
+                                     uint16_t xferred_bytes);
+
+// Stream source (OUT) fills data up to len and return number of bytes, sink (IN) consumes received data
+typedef uint16_t (*dcd_sim_stream_source_t)(uint8_t rhport, uint8_t ep_addr, uint8_t* data, uint16_t len);
+typedef void (*dcd_sim_stream_sink_t)(uint8_t rhport, uint8_t ep_addr, uint8_t const* data, uint16_t len);
+
+// Periodic bulk/interrupt/iso traffic generated by the scripted host
+typedef struct {
+  uint8_t  ep_addr;
+  uint8_t  packets_per_frame; // packets attempted per (micro)frame
+  uint16_t packet_size;       // 0 means endpoint max packet size
+  uint32_t total_bytes;       // stop after this many bytes, 0 for unlimited
+  dcd_sim_stream_source_t out_source; // OUT stream: NULL sends zero-filled packets
+  dcd_sim_stream_sink_t   in_sink;    // IN stream: NULL discards data
+} dcd_sim_stream_t;
+
+//--------------------------------------------------------------------+
+// Bus API
+//--------------------------------------------------------------------+
+
+// Bus reset at given speed, device must be connected (pull-up enabled)
+bool dcd_sim_bus_reset(uint8_t rhport, tusb_speed_t speed);
+
+// Device detached from host
+void dcd_sim_unplug(uint8_t rhport);
+
+void dcd_sim_suspend(uint8_t rhport);
+void dcd_sim_resume(uint8_t rhport);
+
+// Device pull-up is enabled
+bool dcd_sim_connected(uint8_t rhport);
+
+// Current device address
+uint8_t dcd_sim_address(uint8_t rhport);
+
+//--------------------------------------------------------------------+
+// Packet API
+//--------------------------------------------------------------------+
+
+// Send a SETUP packet to the device address, always ACKed
+dcd_sim_handshake_t dcd_sim_setup(uint8_t rhport, tusb_control_request_t const* request);
+
+// Send an OUT data packet
+dcd_sim_handshake_t dcd_sim_out(uint8_t rhport, uint8_t ep_addr, uint8_t const* data, uint16_t len);
+
+// Request an IN data packet, len is buffer size on input and received size on output
+dcd_sim_handshake_t dcd_sim_in(uint8_t rhport, uint8_t ep_addr, uint8_t* data, uint16_t* len);
+
+// Start of (micro)frame, SOF frame_count is microframe index (frame number << 3 | microframe) on highspeed
+void dcd_sim_sof(uint8_t rhport);
+
+// Statistics of an endpoint
+dcd_sim_edpt_stats_t const* dcd_sim_edpt_stats(uint8_t rhport, uint8_t ep_addr);
+void dcd_sim_edpt_stats_clear(uint8_t rhport, uint8_t ep_addr);
+
+//--------------------------------------------------------------------+
+// Scripted Host API
+//--------------------------------------------------------------------+
+
+// Queue a control transfer, buffer holds OUT data or receives IN data (wLength bytes). Only one at a time.
+bool dcd_sim_control_xfer(uint8_t rhport, tusb_control_request_t const* request, void* buffer,
+                          dcd_sim_control_cb_t complete_cb);
+
+// Scripted control transfer is in progress
+bool dcd_sim_control_busy(uint8_t rhport);
+
+// Start/stop periodic stream on an endpoint, stream struct must remain valid while running
+bool dcd_sim_stream_start(uint8_t rhport, dcd_sim_stream_t const* stream);
+void dcd_sim_stream_stop(uint8_t rhport, uint8_t ep_addr);
+
+// Bytes transferred by stream since started
+uint32_t dcd_sim_stream_bytes(uint8_t rhport, uint8_t ep_addr);
+
+// Advance one (micro)frame: SOF, then pending control transfer, then streams
+void dcd_sim_frame(uint8_t rhport);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,1200 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if CFG_TUH_ENABLED && CFG_TUH_SIM
+
+#include "host/hcd.h"
+#include "host/usbh.h"
+#include "host/hub.h"
+#include "hcd_sim.h"
+
+#if CFG_TUD_ENABLED && CFG_TUD_SIM
+  #include "dcd_sim.h"
+  #define SIM_DCD_BRIDGE 1
+#else
+  #define SIM_DCD_BRIDGE 0
+#endif
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+#define SIM_FRAME_BANDWIDTH 60000 // bus time per 1ms frame in highspeed byte-times (480 Mbps)
+#define SIM_PACKET_OVERHEAD 20    // token, handshake, CRC and inter-packet gap in byte-times
+#define SIM_PACKET_SIZE_MAX 1024
+#define SIM_CTRL_BUFSIZE    256
+
+enum {
+  SIM_NODE_NONE = 0,
+  SIM_NODE_HUB,
+  SIM_NODE_DEVICE,
+  SIM_NODE_DCD,
+};
+
+enum {
+  SIM_ACK = 0,
+  SIM_NAK,
+  SIM_STALL,
+};
+
+// control pipe stage of emulated node
+enum {
+  MODEL_CTRL_IDLE = 0,
+  MODEL_CTRL_DATA_IN,
+  MODEL_CTRL_DATA_OUT,
+  MODEL_CTRL_STATUS_IN,
+  MODEL_CTRL_STATUS_OUT,
+};
+
+typedef struct {
+  hub_port_status_response_t port_status;
+  uint8_t child;
+} sim_hub_port_t;
+
+typedef struct {
+  uint8_t type;
+  uint8_t parent;
+  uint8_t port;
+  uint8_t speed;
+  uint8_t addr;
+  uint8_t latency;
+  bool    enabled; // reset by upstream port
+
+  // emulated hub/device
+  uint8_t config_num;
+  struct {
+    tusb_control_request_t request;
+    uint16_t len;
+    uint16_t pos;
+    uint8_t  stage;
+    bool     stalled;
+  } ctrl;
+  uint8_t ctrl_buf[SIM_CTRL_BUFSIZE];
+
+  union {
+    struct {
+      tusb_desc_device_t const* desc_device;
+      uint8_t const* desc_config;
+    } dev;
+
+    struct {
+      uint8_t nports;
+      sim_hub_port_t port[CFG_HCD_SIM_HUB_PORT_MAX];
+    } hub;
+
+    struct {
+      uint8_t rhport;
+    } dcd;
+  };
+
+  hcd_sim_node_stats_t stats;
+} sim_node_t;
+
+typedef struct {
+  uint8_t  daddr;
+  uint8_t  ep_addr;
+  uint8_t  xfer_type;
+  uint8_t  interval;   // in frames, periodic endpoint only
+  uint16_t mps;
+  bool     opened;
+  bool     active;
+  bool     is_setup;
+  uint8_t* buffer;
+  uint16_t buflen;
+  uint16_t actual;
+  uint32_t next_frame; // pipe is not serviced before this frame (latency, interval)
+  uint8_t  setup[8];
+} sim_pipe_t;
+
+typedef struct {
+  bool     int_enabled;
+  uint32_t frame;
+  uint8_t  root_node;
+  uint8_t  rr_index;
+
+  sim_node_t node[CFG_HCD_SIM_NODE_MAX];
+  sim_pipe_t pipe[CFG_HCD_SIM_PIPE_MAX];
+} sim_hcd_t;
+
+static sim_hcd_t _hcd;
+
+//------------- Emulated hub descriptors -------------//
+enum {
+  HUB_CONFIG_TOTAL_LEN = 9 + 9 + 7
+};
+
+static tusb_desc_device_t const _hub_desc_device[2] = {
+  // fullspeed hub
+  {
+    .bLength            = sizeof(tusb_desc_device_t),
+    .bDescriptorType    = TUSB_DESC_DEVICE,
+    .bcdUSB             = 0x0110,
+    .bDeviceClass       = TUSB_CLASS_HUB,
+    .bDeviceSubClass    = 0,
+    .bDeviceProtocol    = HUB_PROTOCOL_FULL_SPEED,
+    .bMaxPacketSize0    = 64,
+    .idVendor           = 0xCafe,
+    .idProduct          = 0x4109,
+    .bcdDevice          = 0x0100,
+    .iManufacturer      = 0,
+    .iProduct           = 0,
+    .iSerialNumber      = 0,
+    .bNumConfigurations = 1
+  },
+
+  // highspeed hub with single TT
+  {
+    .bLength            = sizeof(tusb_desc_device_t),
+    .bDescriptorType    = TUSB_DESC_DEVICE,
+    .bcdUSB             = 0x0200,
+    .bDeviceClass       = TUSB_CLASS_HUB,
+    .bDeviceSubClass    = 0,
+    .bDeviceProtocol    = HUB_PROTOCOL_HIGH_SPEED_STT,
+    .bMaxPacketSize0    = 64,
+    .idVendor           = 0xCafe,
+    .idProduct          = 0x4209,
+    .bcdDevice          = 0x0100,
+    .iManufacturer      = 0,
+    .iProduct           = 0,
+    .iSerialNumber      = 0,
+    .bNumConfigurations = 1
+  },
+};
+
+// status change endpoint is polled every 1ms: bInterval = 1 frame (fullspeed), 2^(4-1) microframes (highspeed)
+#define HUB_DESC_CONFIG(_interval) \
+  9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(HUB_CONFIG_TOTAL_LEN), 1, 1, 0, TU_BIT(7) | TUSB_DESC_CONFIG_ATT_SELF_POWERED, 0, \
+  9, TUSB_DESC_INTERFACE, 0, 0, 1, TUSB_CLASS_HUB, 0, 0, 0, \
+  7, TUSB_DESC_ENDPOINT, 0x81, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(1), _interval
+
+static uint8_t const _hub_desc_config[2][HUB_CONFIG_TOTAL_LEN] = {
+  { HUB_DESC_CONFIG(1) },
+  { HUB_DESC_CONFIG(4) },
+};
+
+//--------------------------------------------------------------------+
+// Node Helper
+//--------------------------------------------------------------------+
+
+static sim_node_t* get_node(uint8_t id) {
+  if (id == 0 || id > CFG_HCD_SIM_NODE_MAX || _hcd.node[id - 1].type == SIM_NODE_NONE) {
+    return NULL;
+  }
+  return &_hcd.node[id - 1];
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t get_node_id(sim_node_t const* node) {
+  return (uint8_t) (node - _hcd.node + 1);
+}
+
+static uint8_t node_address(sim_node_t const* node) {
+#if SIM_DCD_BRIDGE
+  if (node->type == SIM_NODE_DCD) {
+    return dcd_sim_address(node->dcd.rhport);
+  }
+#endif
+  return node->addr;
+}
+
+// speed rank: low < full < high
+TU_ATTR_ALWAYS_INLINE static inline uint8_t speed_rank(uint8_t speed) {
+  return (speed == TUSB_SPEED_LOW) ? 0 : (speed == TUSB_SPEED_FULL) ? 1 : 2;
+}
+
+// bus time in highspeed byte-times of a packet with len bytes
+static uint32_t packet_cost(sim_node_t const* node, uint16_t len) {
+  uint32_t const factor = (node->speed == TUSB_SPEED_HIGH) ? 1 : (node->speed == TUSB_SPEED_FULL) ? 40 : 320;
+  return (len + SIM_PACKET_OVERHEAD) * factor;
+}
+
+// node can receive packets if it and all of its upstream ports are enabled
+static bool node_reachable(sim_node_t const* node) {
+  while (node != NULL) {
+    if (!node->enabled) {
+      return false;
+    }
+    if (node->parent == HCD_SIM_ROOT) {
+      return true;
+    }
+    sim_node_t const* hub = get_node(node->parent);
+    if (hub == NULL || !hub->hub.port[node->port - 1].port_status.status.port_enable) {
+      return false;
+    }
+    node = hub;
+  }
+  return false;
+}
+
+static sim_node_t* find_node(uint8_t daddr) {
+  for (uint8_t i = 0; i < CFG_HCD_SIM_NODE_MAX; i++) {
+    sim_node_t* node = &_hcd.node[i];
+    if (node->type != SIM_NODE_NONE && node_address(node) == daddr && node_reachable(node)) {
+      return node;
+    }
+  }
+  return NULL;
+}
+
+static uint32_t path_latency(sim_node_t const* node) {
+  uint32_t latency = 0;
+  while (node != NULL) {
+    latency += node->latency;
+    node = get_node(node->parent);
+  }
+  return latency;
+}
+
+// Bus reset from upstream port
+static void node_reset(sim_node_t* node) {
+  node->enabled    = true;
+  node->addr       = 0;
+  node->config_num = 0;
+  tu_memclr(&node->ctrl, sizeof(node->ctrl));
+
+  switch (node->type) {
+    case SIM_NODE_HUB:
+      // downstream ports are powered off
+      for (uint8_t i = 0; i < node->hub.nports; i++) {
+        node->hub.port[i].port_status.status.value = 0;
+        node->hub.port[i].port_status.change.value = 0;
+        sim_node_t* child = get_node(node->hub.port[i].child);
+        if (child != NULL) {
+          child->enabled = false;
+        }
+      }
+      break;
+
+#if SIM_DCD_BRIDGE
+    case SIM_NODE_DCD:
+      dcd_sim_bus_reset(node->dcd.rhport, (tusb_speed_t) node->speed);
+      break;
+#endif
+
+    default: break;
+  }
+}
+
+//--------------------------------------------------------------------+
+// Emulated Hub
+//--------------------------------------------------------------------+
+
+// report connection of downstream device if port is powered
+static void hub_port_connect(sim_node_t* hub, uint8_t port) {
+  sim_hub_port_t* hport = &hub->hub.port[port - 1];
+  sim_node_t const* child = get_node(hport->child);
+
+  if (child != NULL && hport->port_status.status.port_power) {
+    hport->port_status.status.connection = 1;
+    hport->port_status.status.low_speed  = (child->speed == TUSB_SPEED_LOW) ? 1 : 0;
+    hport->port_status.status.high_speed = (child->speed == TUSB_SPEED_HIGH) ? 1 : 0;
+    hport->port_status.change.connection = 1;
+  }
+}
+
+static void hub_port_disconnect(sim_node_t* hub, uint8_t port) {
+  sim_hub_port_t* hport = &hub->hub.port[port - 1];
+  hport->child = 0;
+
+  if (hport->port_status.status.connection) {
+    hport->port_status.status.connection  = 0;
+    hport->port_status.status.port_enable = 0;
+    hport->port_status.status.low_speed   = 0;
+    hport->port_status.status.high_speed  = 0;
+    hport->port_status.change.connection  = 1;
+  }
+}
+
+static int32_t hub_control(sim_node_t* hub, tusb_control_request_t const* request) {
+  uint16_t const wValue = tu_le16toh(request->wValue);
+  uint16_t const wIndex = tu_le16toh(request->wIndex);
+
+  if (request->bmRequestType_bit.recipient == TUSB_REQ_RCPT_DEVICE) {
+    switch (request->bRequest) {
+      case HUB_REQUEST_GET_DESCRIPTOR: {
+        hub_desc_cs_t const desc_hub = {
+          .bLength             = sizeof(hub_desc_cs_t),
+          .bDescriptorType     = 0x29,
+          .bNbrPorts           = hub->hub.nports,
+          .wHubCharacteristics = tu_htole16(HUB_CHARS_POWER_INDIVIDUAL_SWITCHING),
+          .bPwrOn2PwrGood      = 1,
+          .bHubContrCurrent    = 0,
+          .DeviceRemovable     = 0,
+          .PortPwrCtrlMask     = 0xff
+        };
+        memcpy(hub->ctrl_buf, &desc_hub, sizeof(desc_hub));
+        return sizeof(desc_hub);
+      }
+
+      case HUB_REQUEST_GET_STATUS:
+        tu_memclr(hub->ctrl_buf, 4);
+        return 4;
+
+      case HUB_REQUEST_SET_FEATURE:
+      case HUB_REQUEST_CLEAR_FEATURE:
+        return 0;
+
+      default: return -1;
+    }
+  }
+
+  TU_VERIFY(request->bmRequestType_bit.recipient == TUSB_REQ_RCPT_OTHER, -1);
+  TU_VERIFY(wIndex >= 1 && wIndex <= hub->hub.nports, -1);
+
+  uint8_t const port = (uint8_t) wIndex;
+  sim_hub_port_t* hport = &hub->hub.port[port - 1];
+
+  switch (request->bRequest) {
+    case HUB_REQUEST_GET_STATUS:
+      memcpy(hub->ctrl_buf, &hport->port_status, 4);
+      return 4;
+
+    case HUB_REQUEST_SET_FEATURE:
+      switch (wValue) {
+        case HUB_FEATURE_PORT_POWER:
+          hport->port_status.status.port_power = 1;
+          hub_port_connect(hub, port);
+          break;
+
+        case HUB_FEATURE_PORT_RESET: {
+          // reset completes right away
+          sim_node_t* child = get_node(hport->child);
+          if (child != NULL && hport->port_status.status.connection) {
+            node_reset(child);
+            hport->port_status.status.port_enable = 1;
+            hport->port_status.change.reset       = 1;
+          }
+          break;
+        }
+
+        case HUB_FEATURE_PORT_SUSPEND:
+          hport->port_status.status.suspend = 1;
+          break;
+
+        default: break;
+      }
+      return 0;
+
+    case HUB_REQUEST_CLEAR_FEATURE:
+      switch (wValue) {
+        case HUB_FEATURE_PORT_ENABLE:
+          hport->port_status.status.port_enable = 0;
+          break;
+
+        case HUB_FEATURE_PORT_SUSPEND:
+          if (hport->port_status.status.suspend) {
+            hport->port_status.status.suspend = 0;
+            hport->port_status.change.suspend = 1;
+          }
+          break;
+
+        case HUB_FEATURE_PORT_POWER:
+          hport->port_status.status.value = 0;
+          break;
+
+        case HUB_FEATURE_PORT_CONNECTION_CHANGE:
+        case HUB_FEATURE_PORT_ENABLE_CHANGE:
+        case HUB_FEATURE_PORT_SUSPEND_CHANGE:
+        case HUB_FEATURE_PORT_OVER_CURRENT_CHANGE:
+        case HUB_FEATURE_PORT_RESET_CHANGE:
+          hport->port_status.change.value &= (uint16_t) ~TU_BIT(wValue - HUB_FEATURE_PORT_CONNECTION_CHANGE);
+          break;
+
+        default: break;
+      }
+      return 0;
+
+    default: return -1;
+  }
+}
+
+// status change endpoint: bit n is set if port n has any change
+static uint8_t hub_status_in(sim_node_t* hub, uint8_t* data, uint16_t* len) {
+  uint8_t bitmap = 0;
+  for (uint8_t i = 0; i < hub->hub.nports; i++) {
+    if (hub->hub.port[i].port_status.change.value) {
+      bitmap |= (uint8_t) TU_BIT(i + 1);
+    }
+  }
+
+  if (bitmap == 0) {
+    return SIM_NAK;
+  }
+
+  data[0] = bitmap;
+  *len    = 1;
+  return SIM_ACK;
+}
+
+//--------------------------------------------------------------------+
+// Emulated Device (also used by hub for standard requests)
+//--------------------------------------------------------------------+
+
+TU_ATTR_ALWAYS_INLINE static inline tusb_desc_device_t const* model_desc_device(sim_node_t const* node) {
+  return (node->type == SIM_NODE_HUB) ? &_hub_desc_device[node->speed == TUSB_SPEED_HIGH ? 1 : 0]
+                                      : node->dev.desc_device;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t const* model_desc_config(sim_node_t const* node) {
+  return (node->type == SIM_NODE_HUB) ? _hub_desc_config[node->speed == TUSB_SPEED_HIGH ? 1 : 0]
+                                      : node->dev.desc_config;
+}
+
+static tusb_desc_endpoint_t const* model_find_edpt(sim_node_t const* node, uint8_t ep_addr) {
+  uint8_t const* desc_cfg = model_desc_config(node);
+  uint8_t const* p_desc   = desc_cfg;
+  uint8_t const* desc_end = desc_cfg + tu_le16toh(((tusb_desc_configuration_t const*) desc_cfg)->wTotalLength);
+
+  while (p_desc < desc_end) {
+    if (tu_desc_type(p_desc) == TUSB_DESC_ENDPOINT &&
+        ((tusb_desc_endpoint_t const*) p_desc)->bEndpointAddress == ep_addr) {
+      return (tusb_desc_endpoint_t const*) p_desc;
+    }
+    p_desc = tu_desc_next(p_desc);
+  }
+  return NULL;
+}
+
+// Process request, response (if any) is written to ctrl_buf. Return response length or -1 to stall
+static int32_t model_control(sim_node_t* node, tusb_control_request_t const* request) {
+  if (request->bmRequestType_bit.type == TUSB_REQ_TYPE_CLASS && node->type == SIM_NODE_HUB) {
+    return hub_control(node, request);
+  }
+  TU_VERIFY(request->bmRequestType_bit.type == TUSB_REQ_TYPE_STANDARD, -1);
+
+  uint16_t const wValue = tu_le16toh(request->wValue);
+
+  switch (request->bRequest) {
+    case TUSB_REQ_GET_DESCRIPTOR:
+      switch (tu_u16_high(wValue)) {
+        case TUSB_DESC_DEVICE:
+          memcpy(node->ctrl_buf, model_desc_device(node), sizeof(tusb_desc_device_t));
+          return sizeof(tusb_desc_device_t);
+
+        case TUSB_DESC_CONFIGURATION: {
+          uint8_t const* desc_cfg = model_desc_config(node);
+          uint16_t total_len = tu_le16toh(((tusb_desc_configuration_t const*) desc_cfg)->wTotalLength);
+          total_len = tu_min16(total_len, SIM_CTRL_BUFSIZE);
+          memcpy(node->ctrl_buf, desc_cfg, total_len);
+          return total_len;
+        }
+
+        case TUSB_DESC_STRING:
+          TU_VERIFY(tu_u16_low(wValue) == 0, -1);
+          node->ctrl_buf[0] = 4;
+          node->ctrl_buf[1] = TUSB_DESC_STRING;
+          node->ctrl_buf[2] = 0x09;
+          node->ctrl_buf[3] = 0x04;
+          return 4;
+
+        default: return -1;
+      }
+
+    case TUSB_REQ_SET_CONFIGURATION:
+      node->config_num = (uint8_t) wValue;
+      return 0;
+
+    case TUSB_REQ_GET_CONFIGURATION:
+      node->ctrl_buf[0] = node->config_num;
+      return 1;
+
+    case TUSB_REQ_GET_INTERFACE:
+      node->ctrl_buf[0] = 0;
+      return 1;
+
+    case TUSB_REQ_GET_STATUS:
+      tu_memclr(node->ctrl_buf, 2);
+      return 2;
+
+    case TUSB_REQ_SET_ADDRESS:      // take effect after status stage
+    case TUSB_REQ_SET_INTERFACE:
+    case TUSB_REQ_SET_FEATURE:
+    case TUSB_REQ_CLEAR_FEATURE:
+      return 0;
+
+    default: return -1;
+  }
+}
+
+static void model_setup(sim_node_t* node, tusb_control_request_t const* request) {
+  node->ctrl.request = *request;
+  node->ctrl.pos     = 0;
+  node->ctrl.stalled = false;
+
+  int32_t const len = model_control(node, request);
+  uint16_t const wLength = tu_le16toh(request->wLength);
+
+  if (len < 0) {
+    node->ctrl.stalled = true;
+    node->ctrl.stage   = MODEL_CTRL_IDLE;
+  } else if (wLength == 0) {
+    node->ctrl.stage = MODEL_CTRL_STATUS_IN;
+  } else if (request->bmRequestType_bit.direction == TUSB_DIR_IN) {
+    node->ctrl.len   = tu_min16((uint16_t) len, wLength);
+    node->ctrl.stage = MODEL_CTRL_DATA_IN;
+  } else {
+    // OUT data is accepted and discarded
+    node->ctrl.len   = wLength;
+    node->ctrl.stage = MODEL_CTRL_DATA_OUT;
+  }
+}
+
+static uint8_t model_out(sim_node_t* node, uint8_t ep_addr, uint16_t len) {
+  if (tu_edpt_number(ep_addr) != 0) {
+    if (node->config_num == 0) {
+      return SIM_NAK;
+    }
+    return (model_find_edpt(node, ep_addr) != NULL) ? SIM_ACK : SIM_STALL;
+  }
+
+  if (node->ctrl.stalled) {
+    return SIM_STALL;
+  }
+
+  uint16_t const mps0 = model_desc_device(node)->bMaxPacketSize0;
+  switch (node->ctrl.stage) {
+    case MODEL_CTRL_DATA_OUT:
+      node->ctrl.pos += len;
+      if (len < mps0 || node->ctrl.pos >= node->ctrl.len) {
+        node->ctrl.stage = MODEL_CTRL_STATUS_IN;
+      }
+      return SIM_ACK;
+
+    case MODEL_CTRL_DATA_IN: // host may end data stage early
+    case MODEL_CTRL_STATUS_OUT:
+      node->ctrl.stage = MODEL_CTRL_IDLE;
+      return SIM_ACK;
+
+    default: return SIM_NAK;
+  }
+}
+
+static uint8_t model_in(sim_node_t* node, uint8_t ep_addr, uint8_t* data, uint16_t* len) {
+  uint16_t const bufsize = *len;
+  *len = 0;
+
+  if (tu_edpt_number(ep_addr) != 0) {
+    if (node->config_num == 0) {
+      return SIM_NAK;
+    }
+
+    if (node->type == SIM_NODE_HUB) {
+      return hub_status_in(node, data, len);
+    }
+
+    tusb_desc_endpoint_t const* desc_ep = model_find_edpt(node, ep_addr);
+    if (desc_ep == NULL) {
+      return SIM_STALL;
+    }
+
+    // always return full packet
+    *len = tu_min16(tu_edpt_packet_size(desc_ep), bufsize);
+    tu_memclr(data, *len);
+    return SIM_ACK;
+  }
+
+  if (node->ctrl.stalled) {
+    return SIM_STALL;
+  }
+
+  uint16_t const mps0 = model_desc_device(node)->bMaxPacketSize0;
+  switch (node->ctrl.stage) {
+    case MODEL_CTRL_DATA_IN: {
+      uint16_t const count = tu_min16(tu_min16(mps0, bufsize), node->ctrl.len - node->ctrl.pos);
+      memcpy(data, node->ctrl_buf + node->ctrl.pos, count);
+      node->ctrl.pos += count;
+      *len = count;
+      if (count < mps0 || node->ctrl.pos >= node->ctrl.len) {
+        node->ctrl.stage = MODEL_CTRL_STATUS_OUT;
+      }
+      return SIM_ACK;
+    }
+
+    case MODEL_CTRL_STATUS_IN:
+      node->ctrl.stage = MODEL_CTRL_IDLE;
+      if (node->ctrl.request.bRequest == TUSB_REQ_SET_ADDRESS &&
+          node->ctrl.request.bmRequestType_bit.type == TUSB_REQ_TYPE_STANDARD) {
+        node->addr = (uint8_t) tu_le16toh(node->ctrl.request.wValue);
+      }
+      return SIM_ACK;
+
+    default: return SIM_NAK;
+  }
+}
+
+//--------------------------------------------------------------------+
+// Node packet dispatch
+//--------------------------------------------------------------------+
+
+#if SIM_DCD_BRIDGE
+TU_ATTR_ALWAYS_INLINE static inline uint8_t dcd_handshake(dcd_sim_handshake_t hs) {
+  return (hs == DCD_SIM_ACK) ? SIM_ACK : (hs == DCD_SIM_NAK) ? SIM_NAK : SIM_STALL;
+}
+#endif
+
+static void node_setup(sim_node_t* node, uint8_t const setup[8]) {
+  node->stats.setup_count++;
+
+#if SIM_DCD_BRIDGE
+  if (node->type == SIM_NODE_DCD) {
+    dcd_sim_setup(node->dcd.rhport, (tusb_control_request_t const*) (uintptr_t) setup);
+    return;
+  }
+#endif
+
+  tusb_control_request_t request;
+  memcpy(&request, setup, sizeof(request));
+  model_setup(node, &request);
+}
+
+static uint8_t node_out(sim_node_t* node, uint8_t ep_addr, uint8_t const* data, uint16_t len) {
+  uint8_t hs;
+#if SIM_DCD_BRIDGE
+  if (node->type == SIM_NODE_DCD) {
+    hs = dcd_handshake(dcd_sim_out(node->dcd.rhport, ep_addr, data, len));
+  } else
+#endif
+  {
+    (void) data;
+    hs = model_out(node, ep_addr, len);
+  }
+
+  if (hs == SIM_ACK) {
+    node->stats.packet_count++;
+    node->stats.byte_count += len;
+  } else if (hs == SIM_NAK) {
+    node->stats.nak_count++;
+  } else {
+    node->stats.stall_count++;
+  }
+  return hs;
+}
+
+static uint8_t node_in(sim_node_t* node, uint8_t ep_addr, uint8_t* data, uint16_t* len) {
+  uint8_t hs;
+#if SIM_DCD_BRIDGE
+  if (node->type == SIM_NODE_DCD) {
+    hs = dcd_handshake(dcd_sim_in(node->dcd.rhport, ep_addr, data, len));
+  } else
+#endif
+  {
+    hs = model_in(node, ep_addr, data, len);
+  }
+
+  if (hs == SIM_ACK) {
+    node->stats.packet_count++;
+    node->stats.byte_count += *len;
+  } else if (hs == SIM_NAK) {
+    node->stats.nak_count++;
+  } else {
+    node->stats.stall_count++;
+  }
+  return hs;
+}
+
+//--------------------------------------------------------------------+
+// Pipe
+//--------------------------------------------------------------------+
+
+static sim_pipe_t* find_pipe(uint8_t daddr, uint8_t ep_addr) {
+  for (uint8_t i = 0; i < CFG_HCD_SIM_PIPE_MAX; i++) {
+    sim_pipe_t* p = &_hcd.pipe[i];
+    if (p->opened && p->daddr == daddr && p->ep_addr == ep_addr) {
+      return p;
+    }
+  }
+  return NULL;
+}
+
+static sim_pipe_t* alloc_pipe(uint8_t daddr, uint8_t ep_addr) {
+  sim_pipe_t* p = find_pipe(daddr, ep_addr);
+  for (uint8_t i = 0; i < CFG_HCD_SIM_PIPE_MAX && p == NULL; i++) {
+    if (!_hcd.pipe[i].opened) {
+      p = &_hcd.pipe[i];
+    }
+  }
+  if (p != NULL) {
+    tu_memclr(p, sizeof(sim_pipe_t));
+    p->daddr   = daddr;
+    p->ep_addr = ep_addr;
+    p->opened  = true;
+  }
+  return p;
+}
+
+static void pipe_schedule(sim_pipe_t* p) {
+  sim_node_t const* node = find_node(p->daddr);
+  p->active     = true;
+  p->actual     = 0;
+  p->next_frame = _hcd.frame + 1 + (node ? path_latency(node) : 0);
+}
+
+static void pipe_complete(uint8_t rhport, sim_pipe_t* p, xfer_result_t result) {
+  p->active = false;
+
+  hcd_event_t event = {
+    .rhport   = rhport,
+    .event_id = HCD_EVENT_XFER_COMPLETE,
+    .dev_addr = p->daddr,
+  };
+  event.xfer_complete.ep_addr = p->is_setup ? 0 : p->ep_addr;
+  event.xfer_complete.result  = result;
+  event.xfer_complete.len     = p->is_setup ? 8 : p->actual;
+  p->is_setup = false;
+
+  hcd_event_handler(&event, true);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool pipe_is_periodic(sim_pipe_t const* p) {
+  return p->xfer_type == TUSB_XFER_INTERRUPT || p->xfer_type == TUSB_XFER_ISOCHRONOUS;
+}
+
+// Carry out one transaction. Return true if pipe can continue in this frame
+static bool pipe_transact(uint8_t rhport, sim_pipe_t* p, uint32_t* budget) {
+  static uint8_t pkt_buf[SIM_PACKET_SIZE_MAX];
+
+  sim_node_t* node = find_node(p->daddr);
+  if (node == NULL) {
+    // no response: device is gone or not enabled
+    pipe_complete(rhport, p, XFER_RESULT_FAILED);
+    return false;
+  }
+
+  bool const is_in = !p->is_setup && (tu_edpt_dir(p->ep_addr) == TUSB_DIR_IN);
+  uint16_t const len = p->is_setup ? 8 : is_in ? p->mps : tu_min16(p->mps, p->buflen - p->actual);
+
+  uint32_t const cost = packet_cost(node, len);
+  if (cost > *budget) {
+    return false;
+  }
+  *budget -= cost;
+
+  if (p->is_setup) {
+    node_setup(node, p->setup);
+    pipe_complete(rhport, p, XFER_RESULT_SUCCESS);
+    return false;
+  }
+
+  uint8_t hs;
+  uint16_t xferred;
+  if (is_in) {
+    xferred = sizeof(pkt_buf);
+    hs = node_in(node, p->ep_addr, pkt_buf, &xferred);
+  } else {
+    xferred = len;
+    hs = node_out(node, p->ep_addr, p->buffer ? p->buffer + p->actual : NULL, len); // buffer is NULL for ZLP
+  }
+
+  if (hs == SIM_NAK) {
+    return false;
+  }
+
+  if (hs == SIM_STALL) {
+    pipe_complete(rhport, p, XFER_RESULT_STALLED);
+    return false;
+  }
+
+  if (is_in) {
+    // babble is truncated
+    uint16_t const count = tu_min16(xferred, p->buflen - p->actual);
+    if (count) {
+      memcpy(p->buffer + p->actual, pkt_buf, count);
+      p->actual += count;
+    }
+  } else {
+    p->actual += len;
+  }
+
+  if (xferred < p->mps || p->actual >= p->buflen) {
+    pipe_complete(rhport, p, XFER_RESULT_SUCCESS);
+    return false;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Topology API
+//--------------------------------------------------------------------+
+
+static sim_node_t* node_attach(uint8_t rhport, uint8_t parent, uint8_t port, tusb_speed_t speed, uint8_t type) {
+  sim_node_t* hub = NULL;
+  if (parent == HCD_SIM_ROOT) {
+    TU_VERIFY(_hcd.root_node == 0, NULL);
+    if (!TUH_OPT_HIGH_SPEED && speed == TUSB_SPEED_HIGH) {
+      speed = TUSB_SPEED_FULL;
+    }
+  } else {
+    hub = get_node(parent);
+    TU_VERIFY(hub != NULL && hub->type == SIM_NODE_HUB, NULL);
+    TU_VERIFY(port >= 1 && port <= hub->hub.nports && hub->hub.port[port - 1].child == 0, NULL);
+    if (speed_rank(speed) > speed_rank(hub->speed)) {
+      speed = (tusb_speed_t) hub->speed;
+    }
+  }
+
+  sim_node_t* node = NULL;
+  for (uint8_t i = 0; i < CFG_HCD_SIM_NODE_MAX && node == NULL; i++) {
+    if (_hcd.node[i].type == SIM_NODE_NONE) {
+      node = &_hcd.node[i];
+    }
+  }
+  TU_ASSERT(node != NULL, NULL);
+
+  tu_memclr(node, sizeof(sim_node_t));
+  node->type   = type;
+  node->parent = parent;
+  node->port   = port;
+  node->speed  = (uint8_t) speed;
+
+  if (hub == NULL) {
+    _hcd.root_node = get_node_id(node);
+    hcd_event_device_attach(rhport, true);
+  } else {
+    hub->hub.port[port - 1].child = get_node_id(node);
+    hub_port_connect(hub, port);
+  }
+
+  return node;
+}
+
+uint8_t hcd_sim_attach_hub(uint8_t rhport, uint8_t parent, uint8_t port, tusb_speed_t speed, uint8_t nports) {
+  TU_ASSERT(nports >= 1 && nports <= CFG_HCD_SIM_HUB_PORT_MAX, 0);
+  TU_ASSERT(speed != TUSB_SPEED_LOW, 0);
+
+  sim_node_t* node = node_attach(rhport, parent, port, speed, SIM_NODE_HUB);
+  TU_VERIFY(node != NULL, 0);
+  node->hub.nports = nports;
+
+  return get_node_id(node);
+}
+
+uint8_t hcd_sim_attach_device(uint8_t rhport, uint8_t parent, uint8_t port, tusb_speed_t speed,
+                              tusb_desc_device_t const* desc_device, uint8_t const* desc_config) {
+  TU_ASSERT(desc_device != NULL && desc_config != NULL, 0);
+
+  sim_node_t* node = node_attach(rhport, parent, port, speed, SIM_NODE_DEVICE);
+  TU_VERIFY(node != NULL, 0);
+  node->dev.desc_device = desc_device;
+  node->dev.desc_config = desc_config;
+
+  return get_node_id(node);
+}
+
+#if SIM_DCD_BRIDGE
+uint8_t hcd_sim_attach_dcd(uint8_t rhport, uint8_t parent, uint8_t port, tusb_speed_t speed, uint8_t dcd_rhport) {
+  TU_VERIFY(dcd_sim_connected(dcd_rhport), 0);
+
+  sim_node_t* node = node_attach(rhport, parent, port, speed, SIM_NODE_DCD);
+  TU_VERIFY(node != NULL, 0);
+  node->dcd.rhport = dcd_rhport;
+
+  return get_node_id(node);
+}
+#endif
+
+// free node and its downstream without notifying upstream
+static void node_free(sim_node_t* node) {
+  if (node->type == SIM_NODE_HUB) {
+    for (uint8_t i = 0; i < node->hub.nports; i++) {
+      sim_node_t* child = get_node(node->hub.port[i].child);
+      if (child != NULL) {
+        node_free(child);
+      }
+    }
+  }
+
+#if SIM_DCD_BRIDGE
+  if (node->type == SIM_NODE_DCD) {
+    dcd_sim_unplug(node->dcd.rhport);
+  }
+#endif
+
+  tu_memclr(node, sizeof(sim_node_t));
+}
+
+void hcd_sim_detach(uint8_t rhport, uint8_t id) {
+  sim_node_t* node = get_node(id);
+  TU_VERIFY(node != NULL, );
+
+  uint8_t const parent = node->parent;
+  uint8_t const port   = node->port;
+  node_free(node);
+
+  if (parent == HCD_SIM_ROOT) {
+    _hcd.root_node = 0;
+    hcd_event_device_remove(rhport, true);
+  } else {
+    sim_node_t* hub = get_node(parent);
+    if (hub != NULL) {
+      hub_port_disconnect(hub, port);
+    }
+  }
+}
+
+void hcd_sim_set_latency(uint8_t rhport, uint8_t id, uint8_t frames) {
+  (void) rhport;
+  sim_node_t* node = get_node(id);
+  if (node != NULL) {
+    node->latency = frames;
+  }
+}
+
+uint8_t hcd_sim_node_address(uint8_t rhport, uint8_t id) {
+  (void) rhport;
+  sim_node_t const* node = get_node(id);
+  return (node != NULL && node->enabled) ? node_address(node) : 0;
+}
+
+tusb_speed_t hcd_sim_node_speed(uint8_t rhport, uint8_t id) {
+  (void) rhport;
+  sim_node_t const* node = get_node(id);
+  return (node != NULL) ? (tusb_speed_t) node->speed : TUSB_SPEED_INVALID;
+}
+
+hcd_sim_node_stats_t const* hcd_sim_node_stats(uint8_t rhport, uint8_t id) {
+  (void) rhport;
+  sim_node_t const* node = get_node(id);
+  return (node != NULL) ? &node->stats : NULL;
+}
+
+//--------------------------------------------------------------------+
+// Bus API
+//--------------------------------------------------------------------+
+
+void hcd_sim_frame(uint8_t rhport) {
+  _hcd.frame++;
+
+#if SIM_DCD_BRIDGE
+  // SOF (or 8 microframes) to bridged device stack
+  for (uint8_t i = 0; i < CFG_HCD_SIM_NODE_MAX; i++) {
+    sim_node_t const* node = &_hcd.node[i];
+    if (node->type == SIM_NODE_DCD && node_reachable(node)) {
+      uint8_t const count = (node->speed == TUSB_SPEED_HIGH) ? 8 : 1;
+      for (uint8_t n = 0; n < count; n++) {
+        dcd_sim_sof(node->dcd.rhport);
+      }
+    }
+  }
+#endif
+
+  uint32_t budget = SIM_FRAME_BANDWIDTH;
+
+  // periodic pipes first: one transaction per interval
+  for (uint8_t i = 0; i < CFG_HCD_SIM_PIPE_MAX; i++) {
+    sim_pipe_t* p = &_hcd.pipe[i];
+    if (p->active && pipe_is_periodic(p) && _hcd.frame >= p->next_frame) {
+      p->next_frame = _hcd.frame + p->interval;
+      (void) pipe_transact(rhport, p, &budget);
+    }
+  }
+
+  // control and bulk pipes share the remaining bandwidth round-robin, a pipe drops out of this frame once it is
+  // NAKed, completed or there is no bandwidth left for its next packet.
+  bool done[CFG_HCD_SIM_PIPE_MAX] = { false };
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (uint8_t i = 0; i < CFG_HCD_SIM_PIPE_MAX; i++) {
+      uint8_t const idx = (uint8_t) ((_hcd.rr_index + i) % CFG_HCD_SIM_PIPE_MAX);
+      sim_pipe_t* p = &_hcd.pipe[idx];
+      if (!p->active || done[idx] || pipe_is_periodic(p) || _hcd.frame < p->next_frame) {
+        continue;
+      }
+
+      if (pipe_transact(rhport, p, &budget)) {
+        progress = true;
+      } else {
+        done[idx] = true;
+      }
+    }
+  }
+
+  _hcd.rr_index = (uint8_t) ((_hcd.rr_index + 1) % CFG_HCD_SIM_PIPE_MAX);
+}
+
+//--------------------------------------------------------------------+
+// Controller API
+//--------------------------------------------------------------------+
+
+bool hcd_init(uint8_t rhport, const tusb_rhport_init_t* rh_init) {
+  (void) rhport;
+  (void) rh_init;
+  tu_memclr(&_hcd, sizeof(_hcd));
+  return true;
+}
+
+bool hcd_deinit(uint8_t rhport) {
+  (void) rhport;
+  tu_memclr(&_hcd, sizeof(_hcd));
+  return true;
+}
+
+// Events are raised synchronously by hcd_sim_frame(), there is no interrupt to service
+void hcd_int_handler(uint8_t rhport, bool in_isr) {
+  (void) rhport;
+  (void) in_isr;
+}
+
+void hcd_int_enable(uint8_t rhport) {
+  (void) rhport;
+  _hcd.int_enabled = true;
+}
+
+void hcd_int_disable(uint8_t rhport) {
+  (void) rhport;
+  _hcd.int_enabled = false;
+}
+
+uint32_t hcd_frame_number(uint8_t rhport) {
+  (void) rhport;
+  return _hcd.frame;
+}
+
+//--------------------------------------------------------------------+
+// Port API
+//--------------------------------------------------------------------+
+
+bool hcd_port_connect_status(uint8_t rhport) {
+  (void) rhport;
+  sim_node_t const* node = get_node(_hcd.root_node);
+#if SIM_DCD_BRIDGE
+  if (node != NULL && node->type == SIM_NODE_DCD) {
+    return dcd_sim_connected(node->dcd.rhport);
+  }
+#endif
+  return node != NULL;
+}
+
+void hcd_port_reset(uint8_t rhport) {
+  (void) rhport;
+  sim_node_t* node = get_node(_hcd.root_node);
+  if (node != NULL) {
+    node_reset(node);
+  }
+}
+
+void hcd_port_reset_end(uint8_t rhport) {
+  (void) rhport;
+}
+
+tusb_speed_t hcd_port_speed_get(uint8_t rhport) {
+  (void) rhport;
+  sim_node_t const* node = get_node(_hcd.root_node);
+  return (node != NULL) ? (tusb_speed_t) node->speed : TUSB_SPEED_INVALID;
+}
+
+void hcd_device_close(uint8_t rhport, uint8_t dev_addr) {
+  (void) rhport;
+  for (uint8_t i = 0; i < CFG_HCD_SIM_PIPE_MAX; i++) {
+    if (_hcd.pipe[i].opened && _hcd.pipe[i].daddr == dev_addr) {
+      tu_memclr(&_hcd.pipe[i], sizeof(sim_pipe_t));
+    }
+  }
+}
+
+//--------------------------------------------------------------------+
+// Endpoints API
+//--------------------------------------------------------------------+
+
+bool hcd_edpt_open(uint8_t rhport, uint8_t daddr, tusb_desc_endpoint_t const* ep_desc) {
+  (void) rhport;
+  uint8_t const ep_addr = ep_desc->bEndpointAddress;
+  uint8_t const xfer_type = ep_desc->bmAttributes.xfer;
+  uint16_t const mps = tu_edpt_packet_size(ep_desc);
+  TU_ASSERT(mps <= SIM_PACKET_SIZE_MAX);
+
+  // interval in frames for periodic endpoint
+  uint8_t interval = 1;
+  if (xfer_type == TUSB_XFER_INTERRUPT || xfer_type == TUSB_XFER_ISOCHRONOUS) {
+    sim_node_t const* node = find_node(daddr);
+    uint8_t const binterval = tu_max8(ep_desc->bInterval, 1);
+    if (node != NULL && node->speed == TUSB_SPEED_HIGH) {
+      interval = (uint8_t) tu_max32((1u << (tu_min8(binterval, 16) - 1)) / 8, 1);
+    } else if (xfer_type == TUSB_XFER_ISOCHRONOUS) {
+      interval = (uint8_t) (1u << (tu_min8(binterval, 8) - 1));
+    } else {
+      interval = binterval;
+    }
+  }
+
+  for (uint8_t dir = 0; dir < 2; dir++) {
+    // control endpoint is bidirectional
+    if (xfer_type != TUSB_XFER_CONTROL && dir != tu_edpt_dir(ep_addr)) {
+      continue;
+    }
+    uint8_t const addr = (xfer_type == TUSB_XFER_CONTROL) ? tu_edpt_addr(0, dir) : ep_addr;
+    sim_pipe_t* p = alloc_pipe(daddr, addr);
+    TU_ASSERT(p != NULL);
+    p->xfer_type = xfer_type;
+    p->mps       = mps;
+    p->interval  = interval;
+  }
+
+  return true;
+}
+
+bool hcd_edpt_close(uint8_t rhport, uint8_t daddr, uint8_t ep_addr) {
+  (void) rhport;
+  sim_pipe_t* p = find_pipe(daddr, ep_addr);
+  TU_VERIFY(p != NULL);
+  tu_memclr(p, sizeof(sim_pipe_t));
+  return true;
+}
+
+bool hcd_edpt_xfer(uint8_t rhport, uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, uint32_t buflen) {
+  (void) rhport;
+  sim_pipe_t* p = find_pipe(daddr, ep_addr);
+  TU_ASSERT(p != NULL && !p->active);
+  TU_ASSERT(buflen <= TUP_HCD_EDPT_XFER_MAX); // larger transfer is split by usbh
+
+  p->buffer   = buffer;
+  p->buflen   = (uint16_t) buflen;
+  p->is_setup = false;
+  pipe_schedule(p);
+
+  return true;
+}
+
+bool hcd_edpt_abort_xfer(uint8_t rhport, uint8_t daddr, uint8_t ep_addr) {
+  (void) rhport;
+  sim_pipe_t* p = find_pipe(daddr, ep_addr);
+  TU_VERIFY(p != NULL && p->active);
+  p->active   = false;
+  p->is_setup = false;
+  return true;
+}
+
+bool hcd_setup_send(uint8_t rhport, uint8_t daddr, uint8_t const setup_packet[8]) {
+  (void) rhport;
+  sim_pipe_t* p = find_pipe(daddr, 0x00);
+  TU_ASSERT(p != NULL);
+
+  // a new SETUP aborts any pending control transfer
+  sim_pipe_t* p_in = find_pipe(daddr, 0x80);
+  if (p_in != NULL) {
+    p_in->active = false;
+  }
+
+  memcpy(p->setup, setup_packet, 8);
+  p->buffer   = NULL;
+  p->buflen   = 0;
+  p->is_setup = true;
+  pipe_schedule(p);
+
+  return true;
+}
+
+bool hcd_edpt_clear_stall(uint8_t rhport, uint8_t daddr, uint8_t ep_addr) {
+  (void) rhport;
+  (void) daddr;
+  (void) ep_addr;
+  return true;
+}
+
+#endif
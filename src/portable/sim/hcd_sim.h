@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_HCD_SIM_H_
+#define TUSB_HCD_SIM_H_
+
+#include "common/tusb_common.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+// Simulated host controller for host (PC) builds. Devices are attached to a virtual bus made of nodes: hubs and
+// generic devices are emulated here, the in-process device stack is bridged through dcd_sim (requires CFG_TUD_SIM).
+// The bus is advanced one 1ms frame at a time by hcd_sim_frame(), events are delivered with in_isr = true and the
+// application is expected to run tuh_task() (and tud_task() for bridged device) between frames. hcd_frame_number()
+// is the simulated time and is typically returned by tusb_time_millis_api().
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+// Max number of nodes (hubs + devices) on the bus
+#ifndef CFG_HCD_SIM_NODE_MAX
+  #define CFG_HCD_SIM_NODE_MAX 16
+#endif
+
+// Max number of opened endpoints, control endpoint takes 2
+#ifndef CFG_HCD_SIM_PIPE_MAX
+  #define CFG_HCD_SIM_PIPE_MAX 64
+#endif
+
+// Max downstream ports of an emulated hub
+#ifndef CFG_HCD_SIM_HUB_PORT_MAX
+  #define CFG_HCD_SIM_HUB_PORT_MAX 7
+#endif
+
+//--------------------------------------------------------------------+
+// Types
+//--------------------------------------------------------------------+
+
+// parent value for node attached directly to root port
+#define HCD_SIM_ROOT 0
+
+typedef struct {
+  uint32_t setup_count;
+  uint32_t packet_count; // ACKed data packets
+  uint32_t nak_count;
+  uint32_t stall_count;
+  uint64_t byte_count;
+} hcd_sim_node_stats_t;
+
+//--------------------------------------------------------------------+
+// Topology API
+// Return node id (non-zero) or 0 if failed. parent is a hub node or HCD_SIM_ROOT, port is 1-based for hub.
+// Device speed is capped to parent hub speed.
+//--------------------------------------------------------------------+
+
+// Attach an emulated hub with nports downstream ports
+uint8_t hcd_sim_attach_hub(uint8_t rhport, uint8_t parent, uint8_t port, tusb_speed_t speed, uint8_t nports);
+
+// Attach an emulated device answering standard requests from its descriptors. Once configured, IN endpoints return
+// max-packet-size packets and OUT endpoints accept any data. Descriptors must remain valid while attached.
+uint8_t hcd_sim_attach_device(uint8_t rhport, uint8_t parent, uint8_t port, tusb_speed_t speed,
+                              tusb_desc_device_t const* desc_device, uint8_t const* desc_config);
+
+#if CFG_TUD_ENABLED && CFG_TUD_SIM
+// Attach the in-process device stack running on dcd_sim dcd_rhport
+uint8_t hcd_sim_attach_dcd(uint8_t rhport, uint8_t parent, uint8_t port, tusb_speed_t speed, uint8_t dcd_rhport);
+#endif
+
+// Detach node and all of its downstream nodes
+void hcd_sim_detach(uint8_t rhport, uint8_t node);
+
+// Inject latency: transfers to node (and its downstream) wait for this many frames before starting
+void hcd_sim_set_latency(uint8_t rhport, uint8_t node, uint8_t frames);
+
+// Current USB address of node, 0 if not addressed yet
+uint8_t hcd_sim_node_address(uint8_t rhport, uint8_t node);
+
+// Link speed of node
+tusb_speed_t hcd_sim_node_speed(uint8_t rhport, uint8_t node);
+
+// Statistics of traffic to node
+hcd_sim_node_stats_t const* hcd_sim_node_stats(uint8_t rhport, uint8_t node);
+
+//--------------------------------------------------------------------+
+// Bus API
+//--------------------------------------------------------------------+
+
+// Advance one 1ms frame: SOF then periodic, control and bulk transactions within frame bandwidth
+void hcd_sim_frame(uint8_t rhport);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -24,16 +24,28 @@
 #include "device/usbd_pvt.h"
 #include "dwc2_common.h"
 
+#if CFG_TUD_DWC2_DMA_DESC_ENABLE
+  #if !CFG_TUD_DWC2_DMA_ENABLE
+    #error CFG_TUD_DWC2_DMA_DESC_ENABLE requires CFG_TUD_DWC2_DMA_ENABLE
+  #endif
+  #include "dwc2_dma_desc.h"
+#endif
+
 //--------------------------------------------------------------------+
 // MACRO TYPEDEF CONSTANT ENUM
 //--------------------------------------------------------------------+
 typedef struct {
   uint8_t* buffer;
   tu_fifo_t* ff;
-  uint16_t total_len;
+  uint32_t total_len;  // reduced to actual length when transfer ends with short packet
+  uint32_t queued_len; // bytes scheduled to hardware so far
   uint16_t max_size;
   uint8_t interval;
   uint8_t iso_retry; // ISO retry counter
+#if CFG_TUD_DWC2_DMA_DESC_ENABLE
+  uint32_t seg_len;   // bytes of segment described by descriptor list
+  uint8_t desc_count; // number of descriptors used by segment
+#endif
 } xfer_ctl_t;
 
 // This variable is modified from ISR context, so it must be protected by critical section
@@ -45,6 +57,10 @@ typedef struct {
   uint16_t ep0_pending[2];  // Index determines direction as tusb_dir_t type
   uint16_t dfifo_top;      // top free location in DFIFO in words
 
+  // hardware transfer size and packet counter limits, larger transfer is split into multiple segments
+  uint32_t xfer_size_max;
+  uint16_t packet_count_max;
+
   // Number of IN endpoints active
   uint8_t allocated_epin_count;
 
@@ -54,8 +70,11 @@ typedef struct {
 
 static dcd_data_t _dcd_data;
 
-// DMA receives up to 3 back-to-back SETUP packets (3 x 8 bytes), Slave mode only needs 1 packet (8 bytes)
-#if CFG_TUD_DWC2_DMA_ENABLE
+// DMA receives up to 3 back-to-back SETUP packets (3 x 8 bytes), Slave mode only needs 1 packet (8 bytes).
+// Scatter/Gather DMA also receives EP0 status OUT into this buffer, which must be a whole packet
+#if CFG_TUD_DWC2_DMA_DESC_ENABLE
+  #define DWC2_SETUP_BUFFER_SIZE TU_MAX(24, CFG_TUD_ENDPOINT0_SIZE)
+#elif CFG_TUD_DWC2_DMA_ENABLE
   #define DWC2_SETUP_BUFFER_SIZE 24
 #else
   #define DWC2_SETUP_BUFFER_SIZE 8
@@ -65,6 +84,15 @@ CFG_TUD_MEM_SECTION static struct {
   TUD_EPBUF_DEF(setup_buffer, DWC2_SETUP_BUFFER_SIZE);
 } _dcd_usbbuf;
 
+#if CFG_TUD_DWC2_DMA_DESC_ENABLE
+// Descriptor list for each endpoint direction, also written by DMA
+typedef dwc2_dma_desc_t dcd_desc_list_t[DWC2_EP_MAX][2][CFG_TUD_DWC2_DMA_DESC_COUNT];
+
+CFG_TUD_MEM_SECTION static struct {
+  TUD_EPBUF_TYPE_DEF(dcd_desc_list_t, list);
+} _dcd_desc;
+#endif
+
 static tud_configure_dwc2_t _tud_cfg = CFG_TUD_CONFIGURE_DWC2_DEFAULT;
 
 TU_ATTR_ALWAYS_INLINE static inline uint8_t dwc2_ep_count(const dwc2_regs_t* dwc2) {
@@ -115,6 +143,17 @@ TU_ATTR_ALWAYS_INLINE static inline bool dma_device_enabled(const dwc2_regs_t* d
   return CFG_TUD_DWC2_DMA_ENABLE && ghwcfg2.arch == GHWCFG2_ARCH_INTERNAL_DMA;
 }
 
+// Scatter/Gather DMA: core must also be configured with descriptor DMA
+TU_ATTR_ALWAYS_INLINE static inline bool dma_desc_enabled(const dwc2_regs_t* dwc2) {
+  #if CFG_TUD_DWC2_DMA_DESC_ENABLE
+  const dwc2_ghwcfg4_t ghwcfg4 = {.value = dwc2->ghwcfg4};
+  return dma_device_enabled(dwc2) && ghwcfg4.dma_desc_enabled;
+  #else
+  (void) dwc2;
+  return false;
+  #endif
+}
+
 static void dma_setup_prepare(uint8_t rhport) {
   dwc2_regs_t* dwc2 = DWC2_REG(rhport);
 
@@ -124,6 +163,20 @@ static void dma_setup_prepare(uint8_t rhport) {
     }
   }
 
+  #if CFG_TUD_DWC2_DMA_DESC_ENABLE
+  if (dma_desc_enabled(dwc2)) {
+    // Receive back-to-back setup packets with a single descriptor
+    xfer_ctl_t* xfer = XFER_CTL_BASE(0, TUSB_DIR_OUT);
+    dwc2_dma_desc_t* desc = _dcd_desc.list[0][TUSB_DIR_OUT];
+    xfer->desc_count = dwc2_dma_desc_build(desc, 1, (uintptr_t) _dcd_usbbuf.setup_buffer, 24,
+                                           sizeof(tusb_control_request_t), 24, false);
+    dcd_dcache_clean(desc, sizeof(dwc2_dma_desc_t));
+    dwc2->epout[0].doepdma = (uintptr_t) desc;
+    dwc2->epout[0].doepctl |= DOEPCTL_EPENA | DOEPCTL_USBAEP;
+    return;
+  }
+  #endif
+
   // Receive back-to-back setup packets
   dwc2->epout[0].doeptsiz = (3 << DOEPTSIZ_STUPCNT_Pos);
   dwc2->epout[0].doepdma = (uintptr_t) _dcd_usbbuf.setup_buffer;
@@ -143,7 +196,7 @@ static void dma_setup_prepare(uint8_t rhport) {
     gdfifocfg.EPINFOBASE and gdfifocfg.GDFIFOCfg must be configured before gahbcfg.dmaen is set.
     The number of words needed per endpoint direction depends on the DMA mode used at runtime:
       - Buffer DMA mode: 1 word per endpoint direction
-      - Scatter/Gather DMA mode: 4 words per endpoint direction
+      - Scatter/Gather DMA mode: 4 words per endpoint direction (DxEPDMAn, current descriptor and its buffer)
   - TX FIFO: one fifo for each IN endpoint. Size is dynamic depending on packet size, starting from top with EP0 IN.
   - Shared RX FIFO: a shared fifo for all OUT endpoints. Typically, can hold up to 2 packets of the largest EP size.
 
@@ -236,10 +289,11 @@ static void dfifo_device_init(uint8_t rhport) {
   dwc2_regs_t* dwc2 = DWC2_REG(rhport);
   dwc2->grxfsiz = calc_device_grxfsiz(CFG_TUD_ENDPOINT0_SIZE, dwc2_controller->ep_count);
 
-  // Scatter/Gather DMA mode is not yet supported. Buffer DMA only need 1 words per endpoint direction
-  const bool is_dma = dma_device_enabled(dwc2);
+  // Reserve EPInfo for DMA: Buffer DMA needs 1 word, Scatter/Gather DMA needs 4 words per endpoint direction
   _dcd_data.dfifo_top = dwc2_controller->otg_dfifo_depth;
-  if (is_dma) {
+  if (dma_desc_enabled(dwc2)) {
+    _dcd_data.dfifo_top -= 2 * 4 * dwc2_controller->ep_count;
+  } else if (dma_device_enabled(dwc2)) {
     _dcd_data.dfifo_top -= 2 * dwc2_controller->ep_count;
   }
   dwc2->gdfifocfg = ((uint32_t) _dcd_data.dfifo_top << GDFIFOCFG_EPINFOBASE_SHIFT) | _dcd_data.dfifo_top;
@@ -341,6 +395,70 @@ static void edpt_disable(uint8_t rhport, uint8_t ep_addr, bool stall) {
   }
 }
 
+#if CFG_TUD_DWC2_DMA_DESC_ENABLE
+// Scatter/Gather DMA: describe next segment of transfer with descriptor list, then enable endpoint.
+// Must be called from critical section
+static void edpt_schedule_desc(uint8_t rhport, const uint8_t epnum, const uint8_t dir) {
+  dwc2_regs_t* dwc2 = DWC2_REG(rhport);
+  xfer_ctl_t* const xfer = XFER_CTL_BASE(epnum, dir);
+  dwc2_dep_t* dep = &dwc2->ep[dir == TUSB_DIR_IN ? 0 : 1][epnum];
+  dwc2_dma_desc_t* desc = _dcd_desc.list[epnum][dir];
+  const bool is_in = (dir == TUSB_DIR_IN);
+  dwc2_depctl_t depctl = {.value = dep->ctl};
+  uint8_t* buffer;
+
+  if (epnum == 0) {
+    // EP0 is limited to one packet per xfer, status OUT without buffer is received into setup buffer
+    xfer->seg_len = tu_min16(_dcd_data.ep0_pending[dir], CFG_TUD_ENDPOINT0_SIZE);
+    _dcd_data.ep0_pending[dir] -= (uint16_t) xfer->seg_len;
+    buffer = (xfer->buffer == NULL && !is_in) ? _dcd_usbbuf.setup_buffer : xfer->buffer;
+    xfer->desc_count = dwc2_dma_desc_build(desc, 1, (uintptr_t) buffer, xfer->seg_len, xfer->max_size,
+                                           xfer->max_size, is_in);
+  } else {
+    buffer = xfer->buffer + xfer->queued_len;
+    const uint32_t remaining = xfer->total_len - xfer->queued_len;
+    if (depctl.type == DEPCTL_EPTYPE_ISOCHRONOUS) {
+      // one packet per service interval, starting from next (micro)frame
+      const dwc2_dsts_t dsts = {.value = dwc2->dsts};
+      xfer->seg_len = tu_min32(remaining, CFG_TUD_DWC2_DMA_DESC_COUNT * xfer->max_size);
+      xfer->desc_count = dwc2_dma_desc_build_iso(desc, CFG_TUD_DWC2_DMA_DESC_COUNT, (uintptr_t) buffer, xfer->seg_len,
+                                                 xfer->max_size, (uint16_t) (dsts.frame_number + 1), xfer->interval,
+                                                 is_in);
+    } else {
+      const uint32_t desc_bytes_max = dwc2_dma_desc_bytes_max(xfer->max_size);
+      xfer->seg_len = tu_min32(remaining, CFG_TUD_DWC2_DMA_DESC_COUNT * desc_bytes_max);
+      xfer->desc_count = dwc2_dma_desc_build(desc, CFG_TUD_DWC2_DMA_DESC_COUNT, (uintptr_t) buffer, xfer->seg_len,
+                                             xfer->max_size, desc_bytes_max, is_in);
+    }
+    xfer->queued_len += xfer->seg_len;
+  }
+
+  if (is_in && xfer->seg_len != 0) {
+    dcd_dcache_clean(buffer, xfer->seg_len);
+  }
+  dcd_dcache_clean(desc, xfer->desc_count * sizeof(dwc2_dma_desc_t));
+
+  dep->diepdma = (uintptr_t) desc;
+  depctl.clear_nak = 1;
+  depctl.enable = 1;
+  dep->ctl = depctl.value;
+}
+
+// Bytes transferred by the segment described by descriptor list, sts is set to Tx/Rx status
+static uint32_t edpt_desc_xferred(uint8_t rhport, uint8_t epnum, uint8_t dir, uint8_t* sts) {
+  dwc2_regs_t* dwc2 = DWC2_REG(rhport);
+  const xfer_ctl_t* xfer = XFER_CTL_BASE(epnum, dir);
+  const dwc2_dma_desc_t* desc = _dcd_desc.list[epnum][dir];
+  const dwc2_depctl_t depctl = {.value = dwc2->ep[dir == TUSB_DIR_IN ? 0 : 1][epnum].ctl};
+
+  dcd_dcache_invalidate(desc, xfer->desc_count * sizeof(dwc2_dma_desc_t));
+  const uint32_t size = dwc2_dma_desc_xfer_size(xfer->seg_len, xfer->max_size, dir == TUSB_DIR_IN);
+  const uint32_t remain = dwc2_dma_desc_remaining(desc, xfer->desc_count,
+                                                  depctl.type == DEPCTL_EPTYPE_ISOCHRONOUS, sts);
+  return (remain < size) ? tu_min32(size - remain, xfer->seg_len) : 0;
+}
+#endif
+
 // Since this function returns void, it is not possible to return a boolean success message
 // We must make sure that this function is not called when the EP is disabled
 // Must be called from critical section
@@ -349,16 +467,30 @@ static void edpt_schedule_packets(uint8_t rhport, const uint8_t epnum, const uin
   xfer_ctl_t* const xfer = XFER_CTL_BASE(epnum, dir);
   dwc2_dep_t* dep = &dwc2->ep[dir == TUSB_DIR_IN ? 0 : 1][epnum];
 
+  #if CFG_TUD_DWC2_DMA_DESC_ENABLE
+  if (dma_desc_enabled(dwc2)) {
+    edpt_schedule_desc(rhport, epnum, dir);
+    return;
+  }
+  #endif
+
   uint16_t num_packets;
-  uint16_t total_bytes;
+  uint32_t total_bytes;
+  uint32_t offset = 0; // segment offset from start of buffer (DMA only)
 
   // EP0 is limited to one packet per xfer
   if (epnum == 0) {
     total_bytes = tu_min16(_dcd_data.ep0_pending[dir], CFG_TUD_ENDPOINT0_SIZE);
-    _dcd_data.ep0_pending[dir] -= total_bytes;
+    _dcd_data.ep0_pending[dir] -= (uint16_t) total_bytes;
     num_packets = 1;
   } else {
-    total_bytes = xfer->total_len;
+    // segment is a multiple of max packet size, the next one is scheduled when this one completes
+    uint32_t seg_max = tu_min32(_dcd_data.xfer_size_max, (uint32_t) _dcd_data.packet_count_max * xfer->max_size);
+    seg_max -= seg_max % xfer->max_size;
+
+    offset = xfer->queued_len;
+    total_bytes = tu_min32(xfer->total_len - offset, seg_max);
+    xfer->queued_len += total_bytes;
     num_packets = (uint16_t)tu_div_ceil(total_bytes, xfer->max_size);
     if (num_packets == 0) {
       num_packets = 1; // zero length packet still count as 1
@@ -389,14 +521,15 @@ static void edpt_schedule_packets(uint8_t rhport, const uint8_t epnum, const uin
   const bool is_dma = dma_device_enabled(dwc2);
   if(is_dma) {
     if (dir == TUSB_DIR_IN && total_bytes != 0) {
-      dcd_dcache_clean(xfer->buffer, total_bytes);
+      dcd_dcache_clean(xfer->buffer + offset, total_bytes);
     }
-    dep->diepdma = (uintptr_t) xfer->buffer;
+    dep->diepdma = (uintptr_t) (xfer->buffer + offset);
     dep->diepctl = depctl.value; // enable endpoint
   } else
   #endif
   {
   #if CFG_TUD_DWC2_SLAVE_ENABLE
+    (void) offset; // buffer is advanced per packet in slave mode
     dep->diepctl = depctl.value; // enable endpoint
 
     if (dir == TUSB_DIR_IN && total_bytes != 0) {
@@ -404,7 +537,7 @@ static void edpt_schedule_packets(uint8_t rhport, const uint8_t epnum, const uin
 
       // Enable TXFE interrupt if there are still data to be sent
       // EP0 only sends one packet at a time, so no need to check for EP0
-      if ((epnum != 0) && (xfer->total_len - xferred_bytes > 0)) {
+      if ((epnum != 0) && (total_bytes - xferred_bytes > 0)) {
          dwc2->diepempmsk |= (1u << epnum);
       }
     }
@@ -436,6 +569,10 @@ bool dcd_init(uint8_t rhport, const tusb_rhport_init_t* rh_init) {
   const bool is_dma = dma_device_enabled(dwc2);
   TU_ASSERT(dwc2_core_init(rhport, is_hs_phy, is_dma));
 
+  const dwc2_ghwcfg3_t ghwcfg3 = {.value = dwc2->ghwcfg3};
+  _dcd_data.xfer_size_max    = (1ul << (11 + ghwcfg3.xfer_size_width)) - 1;
+  _dcd_data.packet_count_max = (uint16_t) ((1u << (4 + ghwcfg3.packet_size_width)) - 1);
+
   //------------- 7.1 Device Initialization -------------//
   // Set device max speed
   uint32_t dcfg = dwc2->dcfg & ~DCFG_DSPD_Msk;
@@ -453,6 +590,9 @@ bool dcd_init(uint8_t rhport, const tusb_rhport_init_t* rh_init) {
   }
 
   dcfg |= DCFG_NZLSOHSK; // send STALL back and discard if host send non-zlp during control status
+  if (dma_desc_enabled(dwc2)) {
+    dcfg |= DCFG_DESCDMA;
+  }
   dwc2->dcfg = dcfg;
 
   dcd_disconnect(rhport);
@@ -629,7 +769,7 @@ bool dcd_edpt_iso_activate(uint8_t rhport,  tusb_desc_endpoint_t const * p_endpo
   return true;
 }
 
-bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes, bool is_isr) {
+bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint32_t total_bytes, bool is_isr) {
   (void) is_isr;
   uint8_t const epnum = tu_edpt_number(ep_addr);
   uint8_t const dir = tu_edpt_dir(ep_addr);
@@ -644,11 +784,13 @@ bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t to
     xfer->buffer = buffer;
     xfer->ff = NULL;
     xfer->total_len = total_bytes;
+    xfer->queued_len = 0;
     xfer->iso_retry = xfer->interval; // Reset ISO retry counter to interval value
 
     // EP0 can only handle one packet
     if (epnum == 0) {
-      _dcd_data.ep0_pending[dir] = total_bytes;
+      _dcd_data.ep0_pending[dir] = (uint16_t) total_bytes;
+      xfer->queued_len = total_bytes;
     }
 
     // Schedule packets to be sent within interrupt
@@ -680,6 +822,7 @@ bool dcd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t* ff, uint16_t
     xfer->buffer = NULL;
     xfer->ff = ff;
     xfer->total_len = total_bytes;
+    xfer->queued_len = 0;
     xfer->iso_retry = xfer->interval; // Reset ISO retry counter to interval value
 
     // Schedule packets to be sent within interrupt
@@ -779,6 +922,12 @@ static void handle_bus_reset(uint8_t rhport) {
   xfer_status[0][TUSB_DIR_OUT].max_size = CFG_TUD_ENDPOINT0_SIZE;
   xfer_status[0][TUSB_DIR_IN].max_size = CFG_TUD_ENDPOINT0_SIZE;
 
+  if (dma_desc_enabled(dwc2)) {
+    // descriptor list is not ready
+    dwc2->doepmsk |= DOEPMSK_BOIM;
+    dwc2->diepmsk |= DIEPMSK_BIM;
+  }
+
   uint32_t gintmsk = GINTMSK_OTGINT | GINTMSK_IEPINT | GINTMSK_IISOIXFRM;
   if(dma_device_enabled(dwc2)) {
     gintmsk |= GINTMSK_OEPINT;
@@ -931,7 +1080,7 @@ static void handle_rxflvl_irq(uint8_t rhport) {
       // short packet (including ZLP when byte_count == 0), minus remaining bytes (xfer_size)
       if (byte_count < xfer->max_size) {
         const dwc2_ep_tsize_t tsiz = {.value = epout->tsiz};
-        xfer->total_len -= tsiz.xfer_size;
+        xfer->total_len = xfer->queued_len - tsiz.xfer_size;
         if (epnum == 0) {
           _dcd_data.ep0_pending[TUSB_DIR_OUT] = 0;
         }
@@ -957,6 +1106,9 @@ static void handle_rxflvl_irq(uint8_t rhport) {
       if (epnum == 0 && _dcd_data.ep0_pending[TUSB_DIR_OUT] > 0) {
         // EP0 can only handle one packet, schedule another packet to be received.
         edpt_schedule_packets(rhport, 0, TUSB_DIR_OUT);
+      } else if (xfer->queued_len < xfer->total_len) {
+        // segment complete without short packet, schedule the next one
+        edpt_schedule_packets(rhport, epnum, TUSB_DIR_OUT);
       } else {
         dcd_event_xfer_complete(rhport, epnum, xfer->total_len, XFER_RESULT_SUCCESS, true);
       }
@@ -976,6 +1128,8 @@ static void handle_epin_slave(uint8_t rhport, uint8_t epnum, dwc2_diepint_t diep
     if ((epnum == 0) && (0 != _dcd_data.ep0_pending[TUSB_DIR_IN])) {
       // EP0 can only handle one packet. Schedule another packet to be transmitted.
       edpt_schedule_packets(rhport, epnum, TUSB_DIR_IN);
+    } else if (xfer->queued_len < xfer->total_len) {
+      edpt_schedule_packets(rhport, epnum, TUSB_DIR_IN);
     } else {
       dcd_event_xfer_complete(rhport, epnum | TUSB_DIR_IN_MASK, xfer->total_len, XFER_RESULT_SUCCESS, true);
     }
@@ -1045,15 +1199,20 @@ static void handle_epout_dma(uint8_t rhport, uint8_t epnum, dwc2_doepint_t doepi
 
         // determine actual received bytes
         const dwc2_ep_tsize_t tsiz = {.value = epout->tsiz};
-        const uint16_t remain = tsiz.xfer_size;
-        xfer->total_len -= remain;
+        const uint32_t remain = tsiz.xfer_size;
+        if (remain == 0 && xfer->queued_len < xfer->total_len) {
+          // segment complete without short packet, schedule the next one
+          edpt_schedule_packets(rhport, epnum, TUSB_DIR_OUT);
+          return;
+        }
+        xfer->total_len = xfer->queued_len - remain;
 
         // EP0 invalidates only this (final) chunk's DMA-written bytes: DOEPDMA "is incremented on
         // every AHB transaction" (databook 7.1.83), i.e. it points past the last word written.
         // Read it before dma_setup_prepare() re-targets it at the setup buffer
-        uint16_t inval_len = xfer->total_len;
+        uint32_t inval_len = xfer->total_len;
         if (epnum == 0) {
-          inval_len = (uint16_t)(epout->doepdma - (uintptr_t)xfer->buffer);
+          inval_len = (uint32_t)(epout->doepdma - (uintptr_t)xfer->buffer);
         }
 
         // prepare EP0 for next setup
@@ -1078,6 +1237,8 @@ static void handle_epin_dma(uint8_t rhport, uint8_t epnum, dwc2_diepint_t diepin
         xfer->buffer += CFG_TUD_ENDPOINT0_SIZE;
       }
       edpt_schedule_packets(rhport, epnum, TUSB_DIR_IN);
+    } else if (xfer->queued_len < xfer->total_len) {
+      edpt_schedule_packets(rhport, epnum, TUSB_DIR_IN);
     } else {
       dcd_event_xfer_complete(rhport, epnum | TUSB_DIR_IN_MASK, xfer->total_len, XFER_RESULT_SUCCESS, true);
     }
@@ -1085,6 +1246,111 @@ static void handle_epin_dma(uint8_t rhport, uint8_t epnum, dwc2_diepint_t diepin
 }
 #endif
 
+#if CFG_TUD_DWC2_DMA_DESC_ENABLE
+static void handle_epout_desc(uint8_t rhport, uint8_t epnum, dwc2_doepint_t doepint_bm) {
+  dwc2_regs_t* dwc2 = DWC2_REG(rhport);
+  xfer_ctl_t* xfer = XFER_CTL_BASE(epnum, TUSB_DIR_OUT);
+  const dwc2_dma_desc_t* desc = _dcd_desc.list[epnum][TUSB_DIR_OUT];
+
+  if (doepint_bm.setup_phase_done) {
+    // Cleanup previous pending EP0 IN transfer if any
+    if (edpt_is_enabled(&dwc2->epin[0])) {
+      edpt_disable(rhport, 0x80, false);
+    }
+    _dcd_data.ep0_pending[TUSB_DIR_OUT] = 0;
+    _dcd_data.ep0_pending[TUSB_DIR_IN] = 0;
+
+    // Remaining bytes of setup descriptor locate the latest of back-to-back SETUP packets
+    dcd_dcache_invalidate(desc, sizeof(dwc2_dma_desc_t));
+    dcd_dcache_invalidate(_dcd_usbbuf.setup_buffer, sizeof(_dcd_usbbuf.setup_buffer));
+    const dwc2_dma_desc_status_t status = {.value = desc->status};
+    const uint32_t received = (status.bytes < 24) ? 24 - status.bytes : 0;
+    const uint32_t offset = (received >= sizeof(tusb_control_request_t)) ? received - sizeof(tusb_control_request_t) : 0;
+    const tusb_control_request_t* setup_packet = (const tusb_control_request_t*) (uintptr_t) (_dcd_usbbuf.setup_buffer + offset);
+    dcd_event_setup_received(rhport, (const uint8_t*) setup_packet, true);
+
+    // Prepare EP0 for next setup if this setup has no data stage
+    if (setup_packet->wLength == 0) {
+      dma_setup_prepare(rhport);
+    }
+    return;
+  }
+
+  if (doepint_bm.xfer_complete || doepint_bm.bna) {
+    uint8_t sts;
+    const uint32_t xferred = edpt_desc_xferred(rhport, epnum, TUSB_DIR_OUT, &sts);
+    const bool failed = doepint_bm.bna || sts != DWC2_DMA_DESC_STS_SUCCESS;
+
+    if (epnum == 0) {
+      // SETUP descriptor completion is handled by setup phase done
+      if (desc->status_bm.setup_rx) {
+        return;
+      }
+
+      if (xfer->buffer != NULL) {
+        dcd_dcache_invalidate(xfer->buffer, xferred);
+        xfer->buffer += xferred;
+      }
+
+      if (!failed && _dcd_data.ep0_pending[TUSB_DIR_OUT] && xferred == xfer->seg_len) {
+        edpt_schedule_packets(rhport, 0, TUSB_DIR_OUT);
+        return;
+      }
+      xfer->total_len -= _dcd_data.ep0_pending[TUSB_DIR_OUT] + (xfer->seg_len - xferred);
+      _dcd_data.ep0_pending[TUSB_DIR_OUT] = 0;
+
+      dma_setup_prepare(rhport); // prepare EP0 for next setup
+    } else {
+      dcd_dcache_invalidate(xfer->buffer + xfer->queued_len - xfer->seg_len, xferred);
+
+      if (!failed && xferred == xfer->seg_len && xfer->queued_len < xfer->total_len) {
+        // segment complete without short packet, schedule the next one
+        edpt_schedule_packets(rhport, epnum, TUSB_DIR_OUT);
+        return;
+      }
+      xfer->total_len = xfer->queued_len - xfer->seg_len + xferred;
+    }
+
+    dcd_event_xfer_complete(rhport, epnum, xfer->total_len, failed ? XFER_RESULT_FAILED : XFER_RESULT_SUCCESS, true);
+  }
+}
+
+static void handle_epin_desc(uint8_t rhport, uint8_t epnum, dwc2_diepint_t diepint_bm) {
+  xfer_ctl_t* xfer = XFER_CTL_BASE(epnum, TUSB_DIR_IN);
+
+  if (diepint_bm.xfer_complete || diepint_bm.bna) {
+    uint8_t sts;
+    const uint32_t xferred = edpt_desc_xferred(rhport, epnum, TUSB_DIR_IN, &sts);
+    const bool failed = diepint_bm.bna || sts != DWC2_DMA_DESC_STS_SUCCESS;
+
+    if (!failed && xferred == xfer->seg_len) {
+      if ((epnum == 0) && _dcd_data.ep0_pending[TUSB_DIR_IN]) {
+        // EP0 can only handle one packet: advance past the sent bytes, then schedule the next.
+        if (xfer->buffer != NULL) {
+          xfer->buffer += xferred;
+        }
+        edpt_schedule_packets(rhport, epnum, TUSB_DIR_IN);
+        return;
+      }
+      if ((epnum != 0) && xfer->queued_len < xfer->total_len) {
+        edpt_schedule_packets(rhport, epnum, TUSB_DIR_IN);
+        return;
+      }
+    }
+
+    if (epnum == 0) {
+      xfer->total_len -= _dcd_data.ep0_pending[TUSB_DIR_IN] + (xfer->seg_len - xferred);
+      _dcd_data.ep0_pending[TUSB_DIR_IN] = 0;
+    } else {
+      xfer->total_len = xfer->queued_len - xfer->seg_len + xferred;
+    }
+
+    dcd_event_xfer_complete(rhport, epnum | TUSB_DIR_IN_MASK, xfer->total_len,
+                            failed ? XFER_RESULT_FAILED : XFER_RESULT_SUCCESS, true);
+  }
+}
+#endif
+
 static void handle_ep_irq(uint8_t rhport, uint8_t dir) {
   dwc2_regs_t* dwc2 = DWC2_REG(rhport);
   const bool is_dma = dma_device_enabled(dwc2);
@@ -1107,6 +1373,17 @@ static void handle_ep_irq(uint8_t rhport, uint8_t dir) {
       epout->intr = intr.value; // Clear interrupt //-V::2584::{otg_int}
 
       if (is_dma) {
+        #if CFG_TUD_DWC2_DMA_DESC_ENABLE
+        if (dma_desc_enabled(dwc2)) {
+          if (dir == TUSB_DIR_IN) {
+            handle_epin_desc(rhport, epnum, intr.diepint_bm);
+          } else {
+            handle_epout_desc(rhport, epnum, intr.doepint_bm);
+          }
+          continue;
+        }
+        #endif
+
         #if CFG_TUD_DWC2_DMA_ENABLE
         if (dir == TUSB_DIR_IN) {
           handle_epin_dma(rhport, epnum, intr.diepint_bm);
@@ -1143,6 +1420,17 @@ static void handle_incomplete_iso_in(uint8_t rhport) {
       xfer_ctl_t *xfer = XFER_CTL_BASE(epnum, TUSB_DIR_IN);
       if (xfer->iso_retry > 0) {
         xfer->iso_retry--;
+        #if CFG_TUD_DWC2_DMA_DESC_ENABLE
+        if (dma_desc_enabled(dwc2)) {
+          // Re-target descriptor list to the next frame
+          edpt_disable(rhport, epnum | TUSB_DIR_IN_MASK, false);
+          epin->diepctl |= DIEPCTL_USBAEP;
+          xfer->queued_len -= xfer->seg_len;
+          edpt_schedule_packets(rhport, epnum, TUSB_DIR_IN);
+          continue;
+        }
+        #endif
+
         // Restart ISO transfer: re-write DMA address, TSIZ, and CTL
         #if CFG_TUD_DWC2_DMA_ENABLE
         if (dma_device_enabled(dwc2)) {
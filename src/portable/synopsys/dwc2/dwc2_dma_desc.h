@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_DWC2_DMA_DESC_H_
+#define TUSB_DWC2_DMA_DESC_H_
+
+#include "common/tusb_common.h"
+#include "dwc2_type.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+// Device Scatter/Gather DMA descriptor list: construction before enabling endpoint and parsing once transfer completes.
+// These only access memory and do not touch any register.
+
+// Largest frame number in isochronous descriptor
+#define DWC2_DMA_DESC_FRAME_NUM_MASK 0x7FFu
+
+// Buffer size to program for a transfer: OUT buffer must be multiple of max packet size (at least one packet)
+TU_ATTR_ALWAYS_INLINE static inline uint32_t dwc2_dma_desc_xfer_size(uint32_t len, uint16_t mps, bool is_in) {
+  if (is_in) {
+    return len;
+  }
+  return (len == 0) ? mps : tu_round_up(len, mps);
+}
+
+// Largest number of bytes of a non-isochronous descriptor, multiple of max packet size
+TU_ATTR_ALWAYS_INLINE static inline uint32_t dwc2_dma_desc_bytes_max(uint16_t mps) {
+  return 0xFFFFu - (0xFFFFu % mps);
+}
+
+// Build descriptor list for control, bulk or interrupt transfer. Each descriptor holds up to desc_bytes_max (multiple
+// of mps), only the last one has L and IOC set. Return number of descriptors used, 0 if list_count is too small
+static inline uint8_t dwc2_dma_desc_build(dwc2_dma_desc_t* list, uint8_t list_count, uint32_t buf_addr, uint32_t len,
+                                          uint16_t mps, uint32_t desc_bytes_max, bool is_in) {
+  const uint32_t size = dwc2_dma_desc_xfer_size(len, mps, is_in);
+  const uint32_t count = (size == 0) ? 1 : tu_div_ceil(size, desc_bytes_max);
+  TU_VERIFY(count <= list_count, 0);
+
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const uint32_t bytes = tu_min32(size - offset, desc_bytes_max);
+
+    dwc2_dma_desc_status_t status = {.value = 0};
+    status.bytes = bytes;
+    status.bs = DWC2_DMA_DESC_BS_HOST_READY;
+    if (i == count - 1) {
+      status.last = 1;
+      status.ioc = 1;
+      if (is_in && (bytes % mps) != 0) {
+        status.short_packet = 1;
+      }
+    }
+
+    list[i].buf = buf_addr + offset;
+    list[i].status = status.value;
+    offset += bytes;
+  }
+
+  return (uint8_t) count;
+}
+
+// Build descriptor list for isochronous transfer: one packet per service interval, starting at (micro)frame frame_num.
+// Return number of descriptors used, 0 if list_count is too small
+static inline uint8_t dwc2_dma_desc_build_iso(dwc2_dma_desc_t* list, uint8_t list_count, uint32_t buf_addr,
+                                              uint32_t len, uint16_t mps, uint16_t frame_num, uint16_t interval,
+                                              bool is_in) {
+  const uint32_t count = (len == 0) ? 1 : tu_div_ceil(len, mps);
+  TU_VERIFY(count <= list_count, 0);
+
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const uint32_t bytes = tu_min32(len - offset, mps);
+
+    dwc2_dma_desc_iso_status_t status = {.value = 0};
+    status.bytes = is_in ? bytes : mps;
+    status.frame_num = (frame_num + i * interval) & DWC2_DMA_DESC_FRAME_NUM_MASK;
+    status.bs = DWC2_DMA_DESC_BS_HOST_READY;
+    if (is_in) {
+      status.pid = 1;
+      if (bytes < mps) {
+        status.short_packet = 1;
+      }
+    }
+    if (i == count - 1) {
+      status.last = 1;
+      status.ioc = 1;
+    }
+
+    list[i].buf = buf_addr + i * mps;
+    list[i].status = status.value;
+    offset += bytes;
+  }
+
+  return (uint8_t) count;
+}
+
+// Parse list of a completed transfer: return bytes not transferred i.e. sum of remaining bytes up to the last
+// descriptor. sts is set to non-success Tx/Rx status of any descriptor closed by DMA, if not NULL
+static inline uint32_t dwc2_dma_desc_remaining(const dwc2_dma_desc_t* list, uint8_t count, bool is_iso, uint8_t* sts) {
+  uint32_t remain = 0;
+  uint8_t result = DWC2_DMA_DESC_STS_SUCCESS;
+
+  for (uint8_t i = 0; i < count; i++) {
+    const dwc2_dma_desc_status_t status = {.value = list[i].status};
+    if (is_iso) {
+      const dwc2_dma_desc_iso_status_t iso_status = {.value = status.value};
+      remain += iso_status.bytes;
+    } else {
+      remain += status.bytes;
+    }
+
+    if (status.bs == DWC2_DMA_DESC_BS_DMA_DONE && status.sts != DWC2_DMA_DESC_STS_SUCCESS) {
+      result = status.sts;
+    }
+
+    if (status.last) {
+      break;
+    }
+  }
+
+  if (sts != NULL) {
+    *sts = result;
+  }
+  return remain;
+}
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -671,6 +671,65 @@ typedef struct {
 
 TU_VERIFY_STATIC(sizeof(dwc2_dep_t) == 0x20, "incorrect size");
 
+//--------------------------------------------------------------------
+// Device Scatter/Gather DMA Descriptor
+//--------------------------------------------------------------------
+enum {
+  DWC2_DMA_DESC_BS_HOST_READY = 0,
+  DWC2_DMA_DESC_BS_DMA_BUSY   = 1,
+  DWC2_DMA_DESC_BS_DMA_DONE   = 2,
+  DWC2_DMA_DESC_BS_HOST_BUSY  = 3,
+};
+
+enum {
+  DWC2_DMA_DESC_STS_SUCCESS  = 0,
+  DWC2_DMA_DESC_STS_BUFFLUSH = 1,
+  DWC2_DMA_DESC_STS_BUFERR   = 3,
+};
+
+// Status quadlet for control, bulk and interrupt endpoints
+typedef union {
+  uint32_t value;
+  struct TU_ATTR_PACKED {
+    uint32_t bytes        : 16; // 0..15 IN: bytes to send, OUT: buffer size. Updated with remaining bytes
+    uint32_t rsv16_22     :  7; // 16..22 Reserved
+    uint32_t mtrf         :  1; // 23 Multiple transfer (OUT only)
+    uint32_t setup_rx     :  1; // 24 Setup packet received (control OUT only)
+    uint32_t ioc          :  1; // 25 Interrupt on complete
+    uint32_t short_packet :  1; // 26 IN: end with short packet, OUT: short packet received
+    uint32_t last         :  1; // 27 Last descriptor of the list
+    uint32_t sts          :  2; // 28..29 Tx/Rx status
+    uint32_t bs           :  2; // 30..31 Buffer status
+  };
+} dwc2_dma_desc_status_t;
+TU_VERIFY_STATIC(sizeof(dwc2_dma_desc_status_t) == 4, "incorrect size");
+
+// Status quadlet for isochronous endpoints
+typedef union {
+  uint32_t value;
+  struct TU_ATTR_PACKED {
+    uint32_t bytes        : 12; // 0..11 IN: bytes to send, OUT (0..10): buffer size. Updated with remaining bytes
+    uint32_t frame_num    : 11; // 12..22 (Micro)frame number
+    uint32_t pid          :  2; // 23..24 IN: number of packets in (micro)frame, OUT: received data PID
+    uint32_t ioc          :  1; // 25 Interrupt on complete
+    uint32_t short_packet :  1; // 26 IN: end with short packet, OUT: short packet received
+    uint32_t last         :  1; // 27 Last descriptor of the list
+    uint32_t sts          :  2; // 28..29 Tx/Rx status
+    uint32_t bs           :  2; // 30..31 Buffer status
+  };
+} dwc2_dma_desc_iso_status_t;
+TU_VERIFY_STATIC(sizeof(dwc2_dma_desc_iso_status_t) == 4, "incorrect size");
+
+typedef struct {
+  union {
+    volatile uint32_t status;
+    dwc2_dma_desc_status_t status_bm;
+    dwc2_dma_desc_iso_status_t iso_status_bm;
+  };
+  volatile uint32_t buf; // 32-bit DMA address of data buffer
+} dwc2_dma_desc_t;
+TU_VERIFY_STATIC(sizeof(dwc2_dma_desc_t) == 8, "incorrect size");
+
 //--------------------------------------------------------------------
 // CSR Register Map
 //--------------------------------------------------------------------
@@ -926,6 +985,10 @@ TU_VERIFY_STATIC(offsetof(dwc2_regs_t, fifo   ) == 0x1000, "incorrect size");
 #define DCFG_XCVRDLY_Msk                 (0x1UL << DCFG_XCVRDLY_Pos)             // 0x00004000
 #define DCFG_XCVRDLY                     DCFG_XCVRDLY_Msk                        // Enables delay between xcvr_sel and txvalid during device chirp
 
+#define DCFG_DESCDMA_Pos                 (23U)
+#define DCFG_DESCDMA_Msk                 (0x1UL << DCFG_DESCDMA_Pos)              // 0x00800000
+#define DCFG_DESCDMA                     DCFG_DESCDMA_Msk                         // Enable scatter/gather DMA
+
 #define DCFG_PERSCHIVL_Pos               (24U)
 #define DCFG_PERSCHIVL_Msk               (0x3UL << DCFG_PERSCHIVL_Pos)            // 0x03000000
 #define DCFG_PERSCHIVL                   DCFG_PERSCHIVL_Msk                       // Periodic scheduling interval
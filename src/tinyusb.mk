@@ -26,3 +26,4 @@ TINYUSB_SRC_C += \
   src/class/midi/midi_host.c \
   src/class/midi/midi2_host.c \
   src/class/msc/msc_host.c \
+  src/class/net/ncm_host.c \
@@ -355,6 +355,19 @@ static bool stream_xfer(tu_edpt_stream_t *s, uint16_t count) {
   return false;
 }
 
+static bool stream_busy(const tu_edpt_stream_t *s) {
+  if (s->is_host) {
+    #if CFG_TUH_ENABLED
+    return usbh_edpt_busy(s->hwid, s->ep_addr);
+  #endif
+  } else {
+    #if CFG_TUD_ENABLED
+    return usbd_edpt_busy(s->hwid, s->ep_addr);
+  #endif
+  }
+  return false;
+}
+
 static bool stream_release(tu_edpt_stream_t *s) {
   if (s->is_host) {
     #if CFG_TUH_ENABLED
@@ -394,6 +407,7 @@ uint32_t tu_edpt_stream_write_xfer(tu_edpt_stream_t *s) {
 
   if (count > 0) {
     TU_ASSERT(stream_xfer(s, count), 0);
+    s->latency_elapsed = 0;
     return count;
   } else {
     // Release endpoint since we don't make any transfer
@@ -403,15 +417,25 @@ uint32_t tu_edpt_stream_write_xfer(tu_edpt_stream_t *s) {
   }
 }
 
+// flush if fifo has more than packet size or
+// in rare case: fifo depth is configured too small (which never reach packet size)
+static void stream_write_flush_if_needed(tu_edpt_stream_t *s) {
+  if ((tu_fifo_count(&s->ff) >= s->mps) || (tu_fifo_depth(&s->ff) < s->mps)) {
+    tu_edpt_stream_write_xfer(s);
+  }
+}
+
 uint32_t tu_edpt_stream_write(tu_edpt_stream_t *s, const void *buffer, uint32_t bufsize) {
   TU_VERIFY(bufsize > 0);
   const uint16_t ret = tu_fifo_write_n(&s->ff, buffer, (uint16_t) bufsize);
+  stream_write_flush_if_needed(s);
+  return ret;
+}
 
-  // flush if fifo has more than packet size or
-  // in rare case: fifo depth is configured too small (which never reach packet size)
-  if ((tu_fifo_count(&s->ff) >= s->mps) || (tu_fifo_depth(&s->ff) < s->mps)) {
-    tu_edpt_stream_write_xfer(s);
-  }
+uint32_t tu_edpt_stream_write_commit(tu_edpt_stream_t *s, uint32_t count) {
+  TU_VERIFY(count > 0);
+  const uint16_t ret = tu_fifo_write_commit(&s->ff, (uint16_t) tu_min32(count, 0xFFFFu));
+  stream_write_flush_if_needed(s);
   return ret;
 }
 
@@ -419,31 +443,82 @@ uint32_t tu_edpt_stream_write_available(tu_edpt_stream_t *s) {
   return (uint32_t)tu_fifo_remaining(&s->ff);
 }
 
+bool tu_edpt_stream_write_latency_tick(tu_edpt_stream_t *s, uint32_t elapsed_ms) {
+  // count only while data is waiting on an idle endpoint, otherwise it is sent on transfer complete
+  if (s->latency_ms == 0 || s->ep_addr == 0 || tu_fifo_empty(&s->ff) || stream_busy(s)) {
+    s->latency_elapsed = 0;
+    return false;
+  }
+
+  // report expiry only once
+  if (s->latency_elapsed >= s->latency_ms) {
+    return false;
+  }
+  s->latency_elapsed = (uint8_t) tu_min32(s->latency_elapsed + elapsed_ms, s->latency_ms);
+  return s->latency_elapsed >= s->latency_ms;
+}
+
+uint32_t tu_edpt_stream_write_latency_flush(tu_edpt_stream_t *s) {
+  TU_VERIFY(s->latency_ms > 0 && s->latency_elapsed >= s->latency_ms, 0);
+  const uint32_t count = tu_edpt_stream_write_xfer(s);
+  s->latency_elapsed = 0; // restart timer in case endpoint could not be claimed
+  return count;
+}
+
 //--------------------------------------------------------------------+
 // Stream Read
 //--------------------------------------------------------------------+
 uint32_t tu_edpt_stream_read_xfer(tu_edpt_stream_t *s) {
-  uint16_t available = tu_fifo_remaining(&s->ff);
+  if (s->ep_buf == NULL) {
+    // Receive directly into FIFO: only allow what we can store in the ring buffer.
+    // This pre-check reduces endpoint claiming
+    uint16_t available = tu_fifo_remaining(&s->ff);
+    TU_VERIFY(available >= s->mps);
+    TU_VERIFY(stream_claim(s), 0);
+    available = tu_fifo_remaining(&s->ff); // re-get available since fifo can be changed
+
+    if (available >= s->mps) {
+      // multiple of packet size limit by ep bufsize
+      uint16_t count = (uint16_t) (available & ~(s->mps - 1));
+      count = tu_min16(count, s->xfer_len);
+      TU_ASSERT(stream_xfer(s, count), 0);
+      return count;
+    } else {
+      // Release endpoint since we don't make any transfer
+      stream_release(s);
+      return 0;
+    }
+  }
 
-  // Prepare for incoming data but only allow what we can store in the ring buffer.
-  // TODO Actually we can still carry out the transfer, keeping count of received bytes
-  // and slowly move it to the FIFO when read().
-  // This pre-check reduces endpoint claiming
-  TU_VERIFY(available >= s->mps);
-  TU_VERIFY(stream_claim(s), 0);
-  available = tu_fifo_remaining(&s->ff); // re-get available since fifo can be changed
+  // Receive-ahead into ep_buf regardless of FIFO space, ep_buf is reused once its spilled data is moved to FIFO
+  TU_VERIFY(s->spill_count == 0 || !tu_fifo_full(&s->ff), 0);
+  TU_VERIFY(stream_claim(s), 0); // claim also protects spill from concurrent read_xfer()
+
+  if (s->spill_count > 0) {
+    const uint16_t count = tu_fifo_write_n(&s->ff, s->ep_buf + s->spill_offset, s->spill_count);
+    s->spill_offset += count;
+    s->spill_count -= count;
+    if (s->spill_count > 0) {
+      stream_release(s);
+      return 0;
+    }
+  }
 
-  if (available >= s->mps) {
-    // multiple of packet size limit by ep bufsize
-    uint16_t count = (uint16_t) (available & ~(s->mps - 1));
-    count = tu_min16(count, s->xfer_len);
-    TU_ASSERT(stream_xfer(s, count), 0);
-    return count;
-  } else {
-    // Release endpoint since we don't make any transfer
-    stream_release(s);
-    return 0;
+  TU_ASSERT(stream_xfer(s, s->xfer_len), 0);
+  return s->xfer_len;
+}
+
+uint32_t tu_edpt_stream_read_xfer_complete_with_buf(tu_edpt_stream_t *s, const void *buf, uint32_t xferred_bytes) {
+  const uint16_t count = tu_fifo_write_n(&s->ff, buf, (uint16_t) xferred_bytes);
+
+  // FIFO is full: keep the rest in ep_buf, next read_xfer() moves it to FIFO before receiving again
+  const uint8_t *remain = (const uint8_t *) buf + count;
+  if (count < xferred_bytes && s->ep_buf != NULL && remain >= s->ep_buf && remain < s->ep_buf + s->xfer_len) {
+    s->spill_offset = (uint16_t) (remain - s->ep_buf);
+    s->spill_count  = (uint16_t) (xferred_bytes - count);
   }
+
+  return count;
 }
 
 uint32_t tu_edpt_stream_read(tu_edpt_stream_t *s, void *buffer, uint32_t bufsize) {
@@ -452,6 +527,12 @@ uint32_t tu_edpt_stream_read(tu_edpt_stream_t *s, void *buffer, uint32_t bufsize
   return num_read;
 }
 
+uint32_t tu_edpt_stream_read_commit(tu_edpt_stream_t *s, uint32_t count) {
+  const uint32_t num_read = tu_fifo_read_commit(&s->ff, (uint16_t) tu_min32(count, 0xFFFFu));
+  tu_edpt_stream_read_xfer(s);
+  return num_read;
+}
+
 //--------------------------------------------------------------------+
 // Debug
 //--------------------------------------------------------------------+
@@ -44,6 +44,10 @@
     #include "class/midi/midi_host.h"
   #endif
 
+  #if CFG_TUH_NCM
+    #include "class/net/net_host.h"
+  #endif
+
   #if CFG_TUH_MIDI2
     #include "class/midi/midi2_host.h"
   #endif
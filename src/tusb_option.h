@@ -341,6 +341,17 @@
   #define CFG_TUD_DWC2_DMA_ENABLE CFG_TUD_DWC2_DMA_ENABLE_DEFAULT
 #endif
 
+// Scatter/Gather (descriptor) DMA mode for device, used if DMA is enabled and core is configured with it
+#ifndef CFG_TUD_DWC2_DMA_DESC_ENABLE
+  #define CFG_TUD_DWC2_DMA_DESC_ENABLE 0
+#endif
+
+// Number of DMA descriptors per endpoint direction in Scatter/Gather mode. Each non-isochronous descriptor holds up to
+// 64KB, isochronous descriptor holds one packet. Larger transfer is split into multiple lists
+#ifndef CFG_TUD_DWC2_DMA_DESC_COUNT
+  #define CFG_TUD_DWC2_DMA_DESC_COUNT 4
+#endif
+
 // Slave mode for device
 #ifndef CFG_TUD_DWC2_SLAVE_ENABLE
   #ifndef CFG_TUD_DWC2_SLAVE_ENABLE_DEFAULT
@@ -396,6 +407,18 @@
   #endif
 #endif
 
+//------------ EHCI -------------//
+// Number of isochronous endpoints for host: iTD for highspeed, siTD for full-speed behind TT. 0 to disable
+#ifndef CFG_TUH_EHCI_ISO_EDPT_MAX
+  #define CFG_TUH_EHCI_ISO_EDPT_MAX 0
+#endif
+
+// Number of iTD/siTD per isochronous endpoint. A transfer is limited to this many frames (highspeed) or packets
+// (full-speed)
+#ifndef CFG_TUH_EHCI_ISO_TD_COUNT
+  #define CFG_TUH_EHCI_ISO_TD_COUNT 8
+#endif
+
 //------------ MAX3421 -------------//
 // Enable MAX3421 USB host controller
 #ifndef CFG_TUH_MAX3421
@@ -458,6 +481,50 @@
   #define CFG_TUD_EDPT_DEDICATED_HWFIFO 1
 #endif
 
+//------------ Simulator --------------//
+// Enable simulated device controller (src/portable/sim) for host builds e.g unit test, fuzzing or benchmark
+#ifndef CFG_TUD_SIM
+  #define CFG_TUD_SIM 0
+#endif
+
+// Enable simulated host controller with emulated hubs/devices, can be paired with CFG_TUD_SIM
+#ifndef CFG_TUH_SIM
+  #define CFG_TUH_SIM 0
+#endif
+
+//------------ Transfer Length --------------//
+// Max bytes accepted by a single dcd_edpt_xfer() / hcd_edpt_xfer(). usbd/usbh split a larger transfer into chunks
+// (multiple of 4KB) and queue the next chunk in ISR when previous one completes.
+// ChipIdea HS and EHCI use a single dTD/qTD per transfer, a large transfer therefore takes one completion interrupt
+// per 16KB chunk. dTDs/qTDs are not chained since neither controller ends a chain on a short packet.
+#ifndef TUP_DCD_EDPT_XFER_MAX
+  #if defined(TUP_USBIP_DWC2)
+    #define TUP_DCD_EDPT_XFER_MAX 0xFFFFFFFFu // split into segments of hardware counter width by dcd_dwc2
+  #elif defined(TUP_USBIP_CHIPIDEA_HS)
+    #define TUP_DCD_EDPT_XFER_MAX (16*1024u)  // one dTD with 5 page pointers at any buffer offset
+  #else
+    #define TUP_DCD_EDPT_XFER_MAX 0xFFFFu
+  #endif
+#endif
+
+#ifndef TUP_HCD_EDPT_XFER_MAX
+  #if defined(TUP_USBIP_EHCI) && !CFG_TUH_MAX3421 && !CFG_TUH_RPI_PIO_USB
+    #define TUP_HCD_EDPT_XFER_MAX (16*1024u)  // one qTD with 5 page pointers at any buffer offset
+  #else
+    #define TUP_HCD_EDPT_XFER_MAX 0xFFFFu
+  #endif
+#endif
+
+// Max control transfers the hcd can run at the same time, each on a different device. EHCI/OHCI (and simulator) have a
+// dedicated control QHD/ED per device address, other controllers share a single control pipe for all devices.
+#ifndef TUP_HCD_CONTROL_XFER_MAX
+  #if ((defined(TUP_USBIP_EHCI) || defined(TUP_USBIP_OHCI)) && !CFG_TUH_MAX3421 && !CFG_TUH_RPI_PIO_USB) || CFG_TUH_SIM
+    #define TUP_HCD_CONTROL_XFER_MAX 0xFFu // one per device address
+  #else
+    #define TUP_HCD_CONTROL_XFER_MAX 1u
+  #endif
+#endif
+
 //--------------------------------------------------------------------
 // RootHub Mode detection
 //--------------------------------------------------------------------
@@ -589,6 +656,14 @@
   #endif
 #endif
 
+// OS NONE only: lock-free single-producer/single-consumer event queue using atomic indices, instead of masking the
+// USB interrupt around every send/receive. For multi-core MCUs where the controller ISR and tud_task()/tuh_task() run
+// on different cores. ISR (in_isr = true) and thread context senders get their own ring, each must be a single
+// context. Events are received in posting order across both rings. Requires GCC/Clang __atomic builtins
+#ifndef CFG_TUSB_OSAL_QUEUE_SPSC
+  #define CFG_TUSB_OSAL_QUEUE_SPSC 0
+#endif
+
 #ifndef CFG_TUSB_OS_INC_PATH
   #ifndef CFG_TUSB_OS_INC_PATH_DEFAULT
   #define CFG_TUSB_OS_INC_PATH_DEFAULT
@@ -640,6 +715,19 @@
   #define CFG_TUD_TASK_EVENTS_PER_RUN  16
 #endif
 
+// max events dequeued at once by tud_task_ext() with a single queue lock (on stack)
+#ifndef CFG_TUD_TASK_EVENTS_PER_BATCH
+  #define CFG_TUD_TASK_EVENTS_PER_BATCH  4
+#endif
+
+// max transfers in flight per non-control endpoint. More than 1 allows class driver to submit transfers while
+// endpoint is busy, they are queued and started in ISR as soon as previous one completes.
+// Only drivers calling usbd_edpt_xfer() directly on a busy endpoint benefit (NCM, video). Endpoint streams (CDC,
+// vendor, MIDI) claim the endpoint with tu_edpt_claim() which refuses a busy endpoint, so they keep one transfer.
+#ifndef CFG_TUD_EDPT_XFER_QUEUE
+  #define CFG_TUD_EDPT_XFER_QUEUE  1
+#endif
+
 // default to max hardware endpoint, but can be smaller to save RAM
 #ifndef CFG_TUD_ENDPPOINT_MAX
   #define CFG_TUD_ENDPPOINT_MAX   TUP_DCD_ENDPOINT_MAX
@@ -753,6 +841,16 @@
     #define CFG_TUH_ENUMERATION_BUFSIZE 256
   #endif
 
+  // Number of devices (behind hubs) that can be enumerated at the same time. Only address 0 stage (reset and set
+  // address) is serialized. Each enumeration has its own CFG_TUH_ENUMERATION_BUFSIZE buffer
+  #ifndef CFG_TUH_ENUMERATION_MAX
+    #if CFG_TUH_HUB
+      #define CFG_TUH_ENUMERATION_MAX 2
+    #else
+      #define CFG_TUH_ENUMERATION_MAX 1
+    #endif
+  #endif
+
 #endif // CFG_TUH_ENABLED
 
 // Attribute to place data in accessible RAM for host controller (default: CFG_TUSB_MEM_SECTION)
@@ -894,6 +992,11 @@
   #define CFG_TUH_MSC    0
 #endif
 
+// CDC-NCM and CDC-ECM network interfaces
+#ifndef CFG_TUH_NCM
+  #define CFG_TUH_NCM    0
+#endif
+
 
 #ifndef CFG_TUH_API_EDPT_XFER
   #define CFG_TUH_API_EDPT_XFER 0
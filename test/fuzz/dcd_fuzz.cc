@@ -168,7 +168,7 @@ void dcd_edpt_close(uint8_t rhport, uint8_t ep_addr) {
 // Submit a transfer, When complete dcd_event_xfer_complete() is invoked to
 // notify the stack
 bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer,
-                   uint16_t total_bytes, bool is_isr) {
+                   uint32_t total_bytes, bool is_isr) {
   UNUSED(rhport);
   UNUSED(buffer);
   UNUSED(total_bytes);
@@ -185,7 +185,7 @@ bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t *buffer,
   // complex fuzzed backend. But we need to make sure it's not
   // optimised out.
   volatile uint8_t *dont_optimise0 = buffer;
-  volatile uint16_t dont_optimise1 = total_bytes;
+  volatile uint32_t dont_optimise1 = total_bytes;
   UNUSED(dont_optimise0);
   UNUSED(dont_optimise1);
 
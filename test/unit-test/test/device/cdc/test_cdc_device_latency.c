@@ -0,0 +1,251 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "usbd.h"
+#include "portable/sim/dcd_sim.h"
+TEST_SOURCE_FILE("cdc_device.c")
+TEST_SOURCE_FILE("vendor_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+uint32_t tusb_time_millis_api(void) {
+  return 0;
+}
+
+enum {
+  EDPT_CDC_NOTIF  = 0x81,
+  EDPT_CDC_OUT    = 0x02,
+  EDPT_CDC_IN     = 0x82,
+  EDPT_VENDOR_OUT = 0x03,
+  EDPT_VENDOR_IN  = 0x83,
+  EDPT_SIZE       = 512,
+};
+
+enum {
+  ITF_NUM_CDC,
+  ITF_NUM_CDC_DATA,
+  ITF_NUM_VENDOR,
+  ITF_NUM_TOTAL
+};
+
+TU_VERIFY_STATIC(CFG_TUD_CDC_TX_LATENCY_MS == 4, "test expects 4 ms default latency");
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_VENDOR_DESC_LEN)
+
+static uint8_t const rhport = 0;
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = TUSB_CLASS_MISC,
+  .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+  .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4008,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, 0, EDPT_CDC_NOTIF, 8, EDPT_CDC_OUT, EDPT_CDC_IN, EDPT_SIZE),
+  TUD_VENDOR_DESCRIPTOR(ITF_NUM_VENDOR, 0, EDPT_VENDOR_OUT, EDPT_VENDOR_IN, EDPT_SIZE),
+};
+
+TU_VERIFY_STATIC(sizeof(desc_configuration) == CONFIG_TOTAL_LEN, "size is not correct");
+
+static xfer_result_t ctrl_result;
+
+//--------------------------------------------------------------------+
+// Application callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) index;
+  (void) langid;
+  return NULL;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void control_complete_cb(uint8_t port, tusb_control_request_t const* request, xfer_result_t result,
+                                uint16_t xferred_bytes) {
+  (void) port;
+  (void) request;
+  (void) xferred_bytes;
+  ctrl_result = result;
+}
+
+static void enumerate(void) {
+  static tusb_control_request_t const requests[] = {
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_ADDRESS,       .wValue = 5 },
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_CONFIGURATION, .wValue = 1 },
+  };
+
+  for (size_t i = 0; i < TU_ARRAY_SIZE(requests); i++) {
+    ctrl_result = XFER_RESULT_INVALID;
+    TEST_ASSERT_TRUE(dcd_sim_control_xfer(rhport, &requests[i], NULL, control_complete_cb));
+    for (uint32_t f = 0; f < 8; f++) {
+      dcd_sim_frame(rhport);
+      tud_task();
+    }
+    TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, ctrl_result);
+  }
+  TEST_ASSERT_TRUE(tud_mounted());
+}
+
+// advance bus time, high speed: 8 SOFs per 1ms frame
+static void run_ms(uint32_t ms) {
+  for (uint32_t i = 0; i < 8 * ms; i++) {
+    dcd_sim_sof(rhport);
+    tud_task();
+  }
+}
+
+// poll IN endpoint, return received length or -1 if NAKed
+static int32_t poll_in(uint8_t ep_addr, uint8_t* buf) {
+  uint16_t len = EDPT_SIZE;
+  if (DCD_SIM_ACK != dcd_sim_in(rhport, ep_addr, buf, &len)) {
+    return -1;
+  }
+  tud_task();
+  return len;
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tud_inited()) {
+    tusb_rhport_init_t dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(0, &dev_init);
+  }
+
+  TEST_ASSERT_TRUE(dcd_sim_connected(rhport));
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+  enumerate();
+
+  tud_cdc_set_tx_latency(CFG_TUD_CDC_TX_LATENCY_MS);
+  tud_vendor_set_tx_latency(0);
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_latency_disabled(void) {
+  uint8_t buf[EDPT_SIZE];
+  TEST_ASSERT_TRUE(tud_cdc_set_tx_latency(0));
+  TEST_ASSERT_EQUAL(0, tud_cdc_get_tx_latency());
+
+  // partial packet stays in fifo until flushed by application
+  TEST_ASSERT_EQUAL(10, tud_cdc_write("0123456789", 10));
+  run_ms(20);
+  TEST_ASSERT_EQUAL(-1, poll_in(EDPT_CDC_IN, buf));
+
+  TEST_ASSERT_EQUAL(10, tud_cdc_write_flush());
+  TEST_ASSERT_EQUAL(10, poll_in(EDPT_CDC_IN, buf));
+}
+
+void test_latency_flush(void) {
+  uint8_t buf[EDPT_SIZE];
+  TEST_ASSERT_EQUAL(CFG_TUD_CDC_TX_LATENCY_MS, tud_cdc_get_tx_latency());
+
+  TEST_ASSERT_EQUAL(10, tud_cdc_write("0123456789", 10));
+  run_ms(CFG_TUD_CDC_TX_LATENCY_MS - 1);
+  TEST_ASSERT_EQUAL(-1, poll_in(EDPT_CDC_IN, buf));
+
+  run_ms(2);
+  TEST_ASSERT_EQUAL(10, poll_in(EDPT_CDC_IN, buf));
+  TEST_ASSERT_EQUAL_MEMORY("0123456789", buf, 10);
+
+  // timer restarts for next data
+  TEST_ASSERT_EQUAL(3, tud_cdc_write("abc", 3));
+  run_ms(CFG_TUD_CDC_TX_LATENCY_MS - 1);
+  TEST_ASSERT_EQUAL(-1, poll_in(EDPT_CDC_IN, buf));
+  run_ms(2);
+  TEST_ASSERT_EQUAL(3, poll_in(EDPT_CDC_IN, buf));
+}
+
+void test_small_writes_batched(void) {
+  uint8_t buf[EDPT_SIZE];
+
+  // one byte per 1/8 ms: written bytes within latency window go in one packet
+  for (uint8_t i = 0; i < 24; i++) {
+    TEST_ASSERT_EQUAL(1, tud_cdc_write_char((char) ('a' + i)));
+    dcd_sim_sof(rhport);
+    tud_task();
+  }
+  TEST_ASSERT_EQUAL(-1, poll_in(EDPT_CDC_IN, buf));
+
+  run_ms(CFG_TUD_CDC_TX_LATENCY_MS);
+  TEST_ASSERT_EQUAL(24, poll_in(EDPT_CDC_IN, buf));
+  TEST_ASSERT_EQUAL_MEMORY("abcdefghijklmnopqrstuvwx", buf, 24);
+  TEST_ASSERT_EQUAL(-1, poll_in(EDPT_CDC_IN, buf));
+}
+
+void test_full_packet_not_delayed(void) {
+  static uint8_t data[EDPT_SIZE];
+  uint8_t buf[EDPT_SIZE];
+  for (uint16_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t) i;
+  }
+
+  // full packet is sent right away followed by ZLP, no latency
+  TEST_ASSERT_EQUAL(sizeof(data), tud_cdc_write(data, sizeof(data)));
+  TEST_ASSERT_EQUAL(EDPT_SIZE, poll_in(EDPT_CDC_IN, buf));
+  TEST_ASSERT_EQUAL_MEMORY(data, buf, EDPT_SIZE);
+  TEST_ASSERT_EQUAL(0, poll_in(EDPT_CDC_IN, buf));
+  TEST_ASSERT_EQUAL(-1, poll_in(EDPT_CDC_IN, buf));
+}
+
+void test_vendor_latency_flush(void) {
+  uint8_t buf[EDPT_SIZE];
+  TEST_ASSERT_TRUE(tud_vendor_set_tx_latency(2));
+  TEST_ASSERT_TRUE(tud_cdc_set_tx_latency(0));
+
+  TEST_ASSERT_EQUAL(5, tud_vendor_write("hello", 5));
+  run_ms(1);
+  TEST_ASSERT_EQUAL(-1, poll_in(EDPT_VENDOR_IN, buf));
+
+  run_ms(2);
+  TEST_ASSERT_EQUAL(5, poll_in(EDPT_VENDOR_IN, buf));
+  TEST_ASSERT_EQUAL_MEMORY("hello", buf, 5);
+}
@@ -0,0 +1,293 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <stdio.h>
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "usbd.h"
+#include "portable/sim/dcd_sim.h"
+TEST_SOURCE_FILE("cdc_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+uint32_t tusb_time_millis_api(void) {
+  return 0;
+}
+
+enum {
+  EDPT_CDC_NOTIF = 0x81,
+  EDPT_CDC_OUT   = 0x02,
+  EDPT_CDC_IN    = 0x82,
+  EDPT_SIZE      = 512,
+};
+
+enum {
+  ITF_NUM_CDC,
+  ITF_NUM_CDC_DATA,
+  ITF_NUM_TOTAL
+};
+
+// worst case for receiving directly into FIFO: FIFO holds only one packet
+TU_VERIFY_STATIC(CFG_TUD_CDC_RX_BUFSIZE == EDPT_SIZE, "test expects RX FIFO of one packet");
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN)
+
+static uint8_t const rhport = 0;
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = TUSB_CLASS_MISC,
+  .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+  .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4009,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, 0, EDPT_CDC_NOTIF, 8, EDPT_CDC_OUT, EDPT_CDC_IN, EDPT_SIZE),
+};
+
+TU_VERIFY_STATIC(sizeof(desc_configuration) == CONFIG_TOTAL_LEN, "size is not correct");
+
+static xfer_result_t ctrl_result;
+static uint8_t wanted_count;
+
+// byte sequence sent by host and checked by consumer
+static uint8_t host_seq;
+static uint8_t app_seq;
+
+//--------------------------------------------------------------------+
+// Application callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) index;
+  (void) langid;
+  return NULL;
+}
+
+void tud_cdc_rx_wanted_cb(uint8_t itf, char wanted_char) {
+  (void) itf;
+  (void) wanted_char;
+  wanted_count++;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void control_complete_cb(uint8_t port, tusb_control_request_t const* request, xfer_result_t result,
+                                uint16_t xferred_bytes) {
+  (void) port;
+  (void) request;
+  (void) xferred_bytes;
+  ctrl_result = result;
+}
+
+static void enumerate(void) {
+  static tusb_control_request_t const requests[] = {
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_ADDRESS,       .wValue = 5 },
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_CONFIGURATION, .wValue = 1 },
+  };
+
+  for (size_t i = 0; i < TU_ARRAY_SIZE(requests); i++) {
+    ctrl_result = XFER_RESULT_INVALID;
+    TEST_ASSERT_TRUE(dcd_sim_control_xfer(rhport, &requests[i], NULL, control_complete_cb));
+    for (uint32_t f = 0; f < 8; f++) {
+      dcd_sim_frame(rhport);
+      tud_task();
+    }
+    TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, ctrl_result);
+  }
+  TEST_ASSERT_TRUE(tud_mounted());
+}
+
+// host sends one packet of sequence data, sequence only advances if device ACKed
+static dcd_sim_handshake_t host_out(void) {
+  uint8_t pkt[EDPT_SIZE];
+  for (uint16_t i = 0; i < EDPT_SIZE; i++) {
+    pkt[i] = (uint8_t) (host_seq + i);
+  }
+
+  dcd_sim_handshake_t const hs = dcd_sim_out(rhport, EDPT_CDC_OUT, pkt, EDPT_SIZE);
+  if (hs == DCD_SIM_ACK) {
+    host_seq = (uint8_t) (host_seq + EDPT_SIZE);
+    tud_task();
+  }
+  return hs;
+}
+
+// application reads up to bufsize bytes and checks sequence, return number of read bytes
+static uint32_t app_read(uint32_t bufsize) {
+  uint8_t buf[EDPT_SIZE];
+  uint32_t const count = tud_cdc_read(buf, tu_min32(bufsize, sizeof(buf)));
+  for (uint32_t i = 0; i < count; i++) {
+    TEST_ASSERT_EQUAL_HEX8(app_seq, buf[i]);
+    app_seq++;
+  }
+  return count;
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tud_inited()) {
+    tusb_rhport_init_t dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(0, &dev_init);
+  }
+
+  TEST_ASSERT_TRUE(dcd_sim_connected(rhport));
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+  enumerate();
+
+  host_seq     = 0;
+  app_seq      = 0;
+  wanted_count = 0;
+  tud_cdc_set_wanted_char((char) -1);
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_receive_ahead_when_fifo_full(void) {
+#if CFG_TUD_EDPT_DEDICATED_HWFIFO
+  TEST_IGNORE_MESSAGE("receive-ahead requires ep_buf");
+#endif
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, host_out());
+  TEST_ASSERT_EQUAL(EDPT_SIZE, tud_cdc_available());
+
+  // fifo is full but endpoint is still armed, next packet is kept until application reads
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, host_out());
+  TEST_ASSERT_EQUAL(EDPT_SIZE, tud_cdc_available());
+  TEST_ASSERT_EQUAL(DCD_SIM_NAK, host_out());
+
+  // reading moves spilled data into fifo, endpoint is armed once all of it is moved
+  TEST_ASSERT_EQUAL(100, app_read(100));
+  TEST_ASSERT_EQUAL(EDPT_SIZE, tud_cdc_available());
+  TEST_ASSERT_EQUAL(DCD_SIM_NAK, host_out());
+
+  TEST_ASSERT_EQUAL(EDPT_SIZE, app_read(EDPT_SIZE));
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, host_out());
+  TEST_ASSERT_EQUAL(EDPT_SIZE, app_read(EDPT_SIZE));
+  TEST_ASSERT_EQUAL(EDPT_SIZE - 100, app_read(EDPT_SIZE));
+  TEST_ASSERT_EQUAL(0, tud_cdc_available());
+  TEST_ASSERT_EQUAL((uint8_t) host_seq, app_seq);
+}
+
+void test_read_flush_drops_spill(void) {
+#if CFG_TUD_EDPT_DEDICATED_HWFIFO
+  TEST_IGNORE_MESSAGE("receive-ahead requires ep_buf");
+#endif
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, host_out());
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, host_out());
+
+  tud_cdc_read_flush();
+  TEST_ASSERT_EQUAL(0, tud_cdc_available());
+
+  // only new data is received
+  app_seq = host_seq;
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, host_out());
+  TEST_ASSERT_EQUAL(EDPT_SIZE, app_read(EDPT_SIZE));
+  TEST_ASSERT_EQUAL(0, tud_cdc_available());
+}
+
+void test_wanted_char_in_spill(void) {
+#if CFG_TUD_EDPT_DEDICATED_HWFIFO
+  TEST_IGNORE_MESSAGE("receive-ahead requires ep_buf");
+#endif
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, host_out());
+
+  // second packet does not fit into fifo at all
+  tud_cdc_set_wanted_char((char) 0x10);
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, host_out());
+  TEST_ASSERT_EQUAL(1, wanted_count);
+}
+
+// Benchmark: host offers one packet per microframe, application wakes up every 1 to max_gap microframes and reads
+// 1 to CFG_TUD_CDC_RX_BUFSIZE bytes (random). With receive-ahead application should never find less data than it
+// wants: ep_buf holds the next packet while FIFO is being drained.
+void test_rx_throughput_vs_consumer_jitter(void) {
+  enum {
+    BENCH_UFRAMES = 8000, // 1 second
+  };
+  static uint8_t const max_gap[] = {1, 2, 4, 8, 16};
+
+  uint32_t rand_state = 1;
+
+  for (size_t j = 0; j < TU_ARRAY_SIZE(max_gap); j++) {
+    dcd_sim_edpt_stats_clear(rhport, EDPT_CDC_OUT);
+    uint32_t demand     = 0;
+    uint32_t consumed   = 0;
+    uint32_t short_read = 0;
+    uint32_t next_read  = 0;
+
+    for (uint32_t uframe = 0; uframe < BENCH_UFRAMES; uframe++) {
+      dcd_sim_sof(rhport);
+      host_out(); // NAKed if device is not ready
+
+      if (uframe == next_read) {
+        rand_state = rand_state * 1103515245u + 12345u;
+        uint32_t const want = 1 + (rand_state >> 16) % CFG_TUD_CDC_RX_BUFSIZE;
+        uint32_t const count = app_read(want);
+        demand += want;
+        consumed += count;
+        if (count < want) {
+          short_read++;
+        }
+
+        rand_state = rand_state * 1103515245u + 12345u;
+        next_read  = uframe + 1 + (rand_state >> 16) % max_gap[j];
+      }
+    }
+
+    dcd_sim_edpt_stats_t const* stats = dcd_sim_edpt_stats(rhport, EDPT_CDC_OUT);
+    printf("max gap %2u uframes: %7lu bytes/s (%3lu%% of demand), %4lu short reads, %5lu NAK\n", max_gap[j],
+           (unsigned long) consumed, (unsigned long) (100u * consumed / demand), (unsigned long) short_read,
+           (unsigned long) stats->nak_count);
+#if CFG_TUD_EDPT_DEDICATED_HWFIFO == 0
+    TEST_ASSERT_EQUAL(0, short_read);
+#endif
+
+    // drain so that next round starts with empty fifo
+    while (app_read(EDPT_SIZE) > 0) {}
+  }
+}
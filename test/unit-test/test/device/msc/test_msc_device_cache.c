@@ -0,0 +1,403 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "usbd.h"
+#include "portable/sim/dcd_sim.h"
+TEST_SOURCE_FILE("msc_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+uint32_t tusb_time_millis_api(void) {
+  return 0;
+}
+
+enum {
+  EDPT_MSC_OUT = 0x01,
+  EDPT_MSC_IN  = 0x81,
+};
+
+enum {
+  ITF_NUM_MSC,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  DISK_BLOCK_NUM  = 16,
+  DISK_BLOCK_SIZE = 512,
+  LINE_BLOCKS     = CFG_TUD_MSC_CACHE_LINE_SIZE / DISK_BLOCK_SIZE,
+};
+
+TU_VERIFY_STATIC(CFG_TUD_MSC_CACHE == 2 && LINE_BLOCKS == 4, "test expects 2 lines of 4 blocks");
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_MSC_DESC_LEN)
+
+static uint8_t const rhport = 0;
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = 0x00,
+  .bDeviceSubClass    = 0x00,
+  .bDeviceProtocol    = 0x00,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4003,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, 0, EDPT_MSC_OUT, EDPT_MSC_IN, 512),
+};
+
+static uint8_t msc_disk[DISK_BLOCK_NUM][DISK_BLOCK_SIZE];
+
+static xfer_result_t ctrl_result;
+
+// medium access by cache
+static uint8_t read_count;
+static uint8_t write_count;
+static uint32_t last_read_lba;
+static uint32_t last_write_lba;
+static uint32_t last_bufsize;
+
+//--------------------------------------------------------------------+
+// Application callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) index;
+  (void) langid;
+  return NULL;
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+  (void) lun;
+  return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
+  (void) lun;
+  *block_count = DISK_BLOCK_NUM;
+  *block_size  = DISK_BLOCK_SIZE;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  (void) lun;
+  read_count++;
+  last_read_lba = lba;
+  last_bufsize = bufsize;
+  memcpy(buffer, msc_disk[lba] + offset, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  (void) lun;
+  write_count++;
+  last_write_lba = lba;
+  last_bufsize = bufsize;
+  memcpy(msc_disk[lba] + offset, buffer, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, uint16_t bufsize) {
+  (void) lun;
+  (void) scsi_cmd;
+  (void) buffer;
+  (void) bufsize;
+  return -1;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void control_complete_cb(uint8_t port, tusb_control_request_t const* request, xfer_result_t result,
+                                uint16_t xferred_bytes) {
+  (void) port;
+  (void) request;
+  (void) xferred_bytes;
+  ctrl_result = result;
+}
+
+static void enumerate(void) {
+  static tusb_control_request_t const requests[] = {
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_ADDRESS,       .wValue = 5 },
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_CONFIGURATION, .wValue = 1 },
+  };
+
+  for (size_t i = 0; i < TU_ARRAY_SIZE(requests); i++) {
+    ctrl_result = XFER_RESULT_INVALID;
+    TEST_ASSERT_TRUE(dcd_sim_control_xfer(rhport, &requests[i], NULL, control_complete_cb));
+    for (uint32_t f = 0; f < 8; f++) {
+      dcd_sim_frame(rhport);
+      tud_task();
+    }
+    TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, ctrl_result);
+  }
+  TEST_ASSERT_TRUE(tud_mounted());
+}
+
+static void send_cbw(uint8_t const* cmd, uint8_t cmd_len, uint32_t total_bytes, bool dir_in) {
+  msc_cbw_t cbw;
+  tu_memclr(&cbw, sizeof(msc_cbw_t));
+  cbw.signature   = MSC_CBW_SIGNATURE;
+  cbw.tag         = 0xCAFECAFE;
+  cbw.total_bytes = total_bytes;
+  cbw.dir         = dir_in ? TUSB_DIR_IN_MASK : 0;
+  cbw.cmd_len     = cmd_len;
+  memcpy(cbw.command, cmd, cmd_len);
+
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_out(rhport, EDPT_MSC_OUT, (uint8_t const*) &cbw, sizeof(cbw)));
+  tud_task();
+}
+
+static void receive_csw(uint8_t status) {
+  uint8_t buf[64];
+  uint16_t len = sizeof(buf);
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_in(rhport, EDPT_MSC_IN, buf, &len));
+  TEST_ASSERT_EQUAL(sizeof(msc_csw_t), len);
+
+  msc_csw_t csw;
+  memcpy(&csw, buf, sizeof(csw));
+  TEST_ASSERT_EQUAL(MSC_CSW_SIGNATURE, csw.signature);
+  TEST_ASSERT_EQUAL(status, csw.status);
+  tud_task(); // prepare for next CBW
+}
+
+static void scsi_rw10(uint8_t cmd_code, uint32_t lba, uint16_t block_count, uint8_t* data) {
+  scsi_read10_t const cmd = {
+    .cmd_code    = cmd_code,
+    .lba         = tu_htonl(lba),
+    .block_count = tu_htons(block_count)
+  };
+  bool const is_read = (cmd_code == SCSI_CMD_READ_10);
+  send_cbw((uint8_t const*) &cmd, sizeof(cmd), (uint32_t) block_count * DISK_BLOCK_SIZE, is_read);
+
+  for (uint16_t i = 0; i < block_count; i++) {
+    uint8_t* block = data + i * DISK_BLOCK_SIZE;
+    if (is_read) {
+      uint16_t len = DISK_BLOCK_SIZE;
+      TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_in(rhport, EDPT_MSC_IN, block, &len));
+      TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, len);
+    } else {
+      TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_out(rhport, EDPT_MSC_OUT, block, DISK_BLOCK_SIZE));
+    }
+    tud_task();
+  }
+
+  receive_csw(MSC_CSW_STATUS_PASSED);
+}
+
+static void scsi_no_data(uint8_t cmd_code) {
+  uint8_t cmd[10] = { cmd_code };
+  if (cmd_code == SCSI_CMD_START_STOP_UNIT) {
+    cmd[4] = 0x01; // start
+  }
+  send_cbw(cmd, sizeof(cmd), 0, false);
+  receive_csw(MSC_CSW_STATUS_PASSED);
+}
+
+static void fill_block(uint8_t* block, uint8_t value) {
+  memset(block, value, DISK_BLOCK_SIZE);
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tud_inited()) {
+    tusb_rhport_init_t dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(0, &dev_init);
+  }
+
+  TEST_ASSERT_TRUE(dcd_sim_connected(rhport));
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+  tud_msc_cache_discard(0);
+
+  for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+    fill_block(msc_disk[i], i);
+  }
+  read_count  = 0;
+  write_count = 0;
+
+  enumerate();
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_write_merged_in_line(void) {
+  static uint8_t data[LINE_BLOCKS][DISK_BLOCK_SIZE];
+
+  // single block writes: line is loaded once, nothing is written yet
+  for (uint8_t i = 0; i < LINE_BLOCKS; i++) {
+    fill_block(data[i], 0xA0 | i);
+    scsi_rw10(SCSI_CMD_WRITE_10, i, 1, data[i]);
+  }
+  TEST_ASSERT_EQUAL(1, read_count);
+  TEST_ASSERT_EQUAL(0, write_count);
+  TEST_ASSERT_EQUAL(0, msc_disk[1][0] & 0xF0);
+
+  // read back from cache
+  static uint8_t rbuf[LINE_BLOCKS][DISK_BLOCK_SIZE];
+  scsi_rw10(SCSI_CMD_READ_10, 0, LINE_BLOCKS, (uint8_t*) rbuf);
+  TEST_ASSERT_EQUAL(1, read_count);
+  TEST_ASSERT_EQUAL_MEMORY(data, rbuf, sizeof(data));
+
+  // whole line is written back at once
+  scsi_no_data(SCSI_CMD_SYNCHRONIZE_CACHE_10);
+  TEST_ASSERT_EQUAL(1, write_count);
+  TEST_ASSERT_EQUAL(0, last_write_lba);
+  TEST_ASSERT_EQUAL(CFG_TUD_MSC_CACHE_LINE_SIZE, last_bufsize);
+  TEST_ASSERT_EQUAL_MEMORY(data, msc_disk[0], sizeof(data));
+
+  // nothing left to write
+  scsi_no_data(SCSI_CMD_SYNCHRONIZE_CACHE_10);
+  TEST_ASSERT_EQUAL(1, write_count);
+}
+
+void test_full_line_write_skips_load(void) {
+  static uint8_t data[LINE_BLOCKS][DISK_BLOCK_SIZE];
+  for (uint8_t i = 0; i < LINE_BLOCKS; i++) {
+    fill_block(data[i], 0xB0 | i);
+  }
+
+  scsi_rw10(SCSI_CMD_WRITE_10, LINE_BLOCKS, LINE_BLOCKS, (uint8_t*) data);
+  TEST_ASSERT_EQUAL(0, read_count);
+
+  scsi_no_data(SCSI_CMD_START_STOP_UNIT);
+  TEST_ASSERT_EQUAL(1, write_count);
+  TEST_ASSERT_EQUAL(LINE_BLOCKS, last_write_lba);
+  TEST_ASSERT_EQUAL_MEMORY(data, msc_disk[LINE_BLOCKS], sizeof(data));
+}
+
+void test_evict_lru(void) {
+  static uint8_t data[3][DISK_BLOCK_SIZE];
+
+  // third line evicts the least recently used one
+  for (uint8_t i = 0; i < 3; i++) {
+    fill_block(data[i], 0xC0 | i);
+    scsi_rw10(SCSI_CMD_WRITE_10, i * LINE_BLOCKS, 1, data[i]);
+  }
+  TEST_ASSERT_EQUAL(1, write_count);
+  TEST_ASSERT_EQUAL(0, last_write_lba);
+  TEST_ASSERT_EQUAL_MEMORY(data[0], msc_disk[0], DISK_BLOCK_SIZE);
+
+  TEST_ASSERT_TRUE(tud_msc_cache_flush());
+  TEST_ASSERT_EQUAL(3, write_count);
+  TEST_ASSERT_EQUAL_MEMORY(data[1], msc_disk[LINE_BLOCKS], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL_MEMORY(data[2], msc_disk[2 * LINE_BLOCKS], DISK_BLOCK_SIZE);
+}
+
+void test_sequential_read_ahead(void) {
+  static uint8_t rbuf[DISK_BLOCK_NUM][DISK_BLOCK_SIZE];
+
+  // first read is not sequential: only its line is loaded
+  scsi_rw10(SCSI_CMD_READ_10, 0, 2, (uint8_t*) rbuf[0]);
+  TEST_ASSERT_EQUAL(1, read_count);
+  TEST_ASSERT_EQUAL(CFG_TUD_MSC_CACHE_LINE_SIZE, last_bufsize);
+
+  scsi_rw10(SCSI_CMD_READ_10, 2, 2, (uint8_t*) rbuf[2]);
+  TEST_ASSERT_EQUAL(1, read_count);
+
+  // sequential read entering next line also loads the one after
+  scsi_rw10(SCSI_CMD_READ_10, 4, 2, (uint8_t*) rbuf[4]);
+  TEST_ASSERT_EQUAL(3, read_count);
+  TEST_ASSERT_EQUAL(2 * LINE_BLOCKS, last_read_lba);
+
+  scsi_rw10(SCSI_CMD_READ_10, 6, 6, (uint8_t*) rbuf[6]);
+  TEST_ASSERT_EQUAL(3, read_count);
+
+  for (uint8_t i = 0; i < 12; i++) {
+    TEST_ASSERT_EQUAL_MEMORY(msc_disk[i], rbuf[i], DISK_BLOCK_SIZE);
+  }
+}
+
+void test_idle_flush(void) {
+  static uint8_t data[DISK_BLOCK_SIZE];
+  fill_block(data, 0xD5);
+
+  scsi_rw10(SCSI_CMD_WRITE_10, 9, 1, data);
+  TEST_ASSERT_EQUAL(0, write_count);
+
+  // high speed: 8 SOFs per 1ms frame
+  for (uint32_t i = 0; i < 8 * (CFG_TUD_MSC_CACHE_FLUSH_MS - 1); i++) {
+    dcd_sim_sof(rhport);
+  }
+  tud_task();
+  TEST_ASSERT_EQUAL(0, write_count);
+
+  for (uint32_t i = 0; i < 8 * 2; i++) {
+    dcd_sim_sof(rhport);
+  }
+  tud_task();
+  TEST_ASSERT_EQUAL(1, write_count);
+  TEST_ASSERT_EQUAL_MEMORY(data, msc_disk[9], DISK_BLOCK_SIZE);
+}
+
+void test_bus_reset_flush(void) {
+  static uint8_t data[DISK_BLOCK_SIZE];
+  fill_block(data, 0xE7);
+
+  scsi_rw10(SCSI_CMD_WRITE_10, 5, 1, data);
+  TEST_ASSERT_EQUAL(0, write_count);
+
+  // written back by deferred call after bus reset is processed
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+  TEST_ASSERT_EQUAL(1, write_count);
+  TEST_ASSERT_EQUAL_MEMORY(data, msc_disk[5], DISK_BLOCK_SIZE);
+}
+
+void test_discard_drops_dirty_line(void) {
+  static uint8_t data[DISK_BLOCK_SIZE];
+  static uint8_t rbuf[DISK_BLOCK_SIZE];
+  fill_block(data, 0xF1);
+
+  scsi_rw10(SCSI_CMD_WRITE_10, 2, 1, data);
+  tud_msc_cache_discard(0);
+
+  // nothing is written back, next read loads from medium again
+  TEST_ASSERT_TRUE(tud_msc_cache_flush());
+  TEST_ASSERT_EQUAL(0, write_count);
+  scsi_rw10(SCSI_CMD_READ_10, 2, 1, rbuf);
+  TEST_ASSERT_EQUAL(2, read_count);
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[2], rbuf, DISK_BLOCK_SIZE);
+}
@@ -0,0 +1,325 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "usbd.h"
+#include "portable/sim/dcd_sim.h"
+TEST_SOURCE_FILE("msc_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+uint32_t tusb_time_millis_api(void) {
+  return 0;
+}
+
+enum {
+  EDPT_MSC_OUT = 0x01,
+  EDPT_MSC_IN  = 0x81,
+};
+
+enum {
+  ITF_NUM_MSC,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  DISK_BLOCK_NUM  = 16,
+  DISK_BLOCK_SIZE = 512
+};
+
+TU_VERIFY_STATIC(CFG_TUD_MSC_EP_BUFSIZE == DISK_BLOCK_SIZE, "test expects one block per buffer");
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_MSC_DESC_LEN)
+
+static uint8_t const rhport = 0;
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = 0x00,
+  .bDeviceSubClass    = 0x00,
+  .bDeviceProtocol    = 0x00,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4003,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, 0, EDPT_MSC_OUT, EDPT_MSC_IN, 512),
+};
+
+static uint8_t msc_disk[DISK_BLOCK_NUM][DISK_BLOCK_SIZE];
+
+static xfer_result_t ctrl_result;
+
+// read/write callback behavior
+static uint8_t read_count;
+static uint8_t write_count;
+static bool write_async;
+static uint16_t write_max; // max bytes consumed per write callback
+static struct {
+  uint32_t lba;
+  uint32_t offset;
+  uint8_t* buffer;
+  uint32_t bufsize;
+} pending_write;
+
+//--------------------------------------------------------------------+
+// Application callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) index;
+  (void) langid;
+  return NULL;
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+  (void) lun;
+  return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
+  (void) lun;
+  *block_count = DISK_BLOCK_NUM;
+  *block_size  = DISK_BLOCK_SIZE;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  (void) lun;
+  read_count++;
+  memcpy(buffer, msc_disk[lba] + offset, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  (void) lun;
+  write_count++;
+  if (write_async) {
+    pending_write.lba     = lba;
+    pending_write.offset  = offset;
+    pending_write.buffer  = buffer;
+    pending_write.bufsize = bufsize;
+    return TUD_MSC_RET_ASYNC;
+  }
+
+  bufsize = tu_min32(bufsize, write_max);
+  memcpy(msc_disk[lba] + offset, buffer, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, uint16_t bufsize) {
+  (void) lun;
+  (void) scsi_cmd;
+  (void) buffer;
+  (void) bufsize;
+  return -1;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void control_complete_cb(uint8_t port, tusb_control_request_t const* request, xfer_result_t result,
+                                uint16_t xferred_bytes) {
+  (void) port;
+  (void) request;
+  (void) xferred_bytes;
+  ctrl_result = result;
+}
+
+static void enumerate(void) {
+  static tusb_control_request_t const requests[] = {
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_ADDRESS,       .wValue = 5 },
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_CONFIGURATION, .wValue = 1 },
+  };
+
+  for (size_t i = 0; i < TU_ARRAY_SIZE(requests); i++) {
+    ctrl_result = XFER_RESULT_INVALID;
+    TEST_ASSERT_TRUE(dcd_sim_control_xfer(rhport, &requests[i], NULL, control_complete_cb));
+    for (uint32_t f = 0; f < 8; f++) {
+      dcd_sim_frame(rhport);
+      tud_task();
+    }
+    TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, ctrl_result);
+  }
+  TEST_ASSERT_TRUE(tud_mounted());
+}
+
+static void send_rw10_cbw(uint8_t cmd_code, uint32_t lba, uint16_t block_count) {
+  scsi_read10_t const cmd = {
+    .cmd_code    = cmd_code,
+    .lba         = tu_htonl(lba),
+    .block_count = tu_htons(block_count)
+  };
+
+  msc_cbw_t cbw;
+  tu_memclr(&cbw, sizeof(msc_cbw_t));
+  cbw.signature   = MSC_CBW_SIGNATURE;
+  cbw.tag         = 0xCAFECAFE;
+  cbw.total_bytes = (uint32_t) block_count * DISK_BLOCK_SIZE;
+  cbw.dir         = (cmd_code == SCSI_CMD_READ_10) ? TUSB_DIR_IN_MASK : 0;
+  cbw.cmd_len     = sizeof(scsi_read10_t);
+  memcpy(cbw.command, &cmd, sizeof(cmd));
+
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_out(rhport, EDPT_MSC_OUT, (uint8_t const*) &cbw, sizeof(cbw)));
+  tud_task();
+}
+
+static void receive_csw(uint8_t status) {
+  uint8_t buf[64];
+  uint16_t len = sizeof(buf);
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_in(rhport, EDPT_MSC_IN, buf, &len));
+  TEST_ASSERT_EQUAL(sizeof(msc_csw_t), len);
+
+  msc_csw_t csw;
+  memcpy(&csw, buf, sizeof(csw));
+  TEST_ASSERT_EQUAL(MSC_CSW_SIGNATURE, csw.signature);
+  TEST_ASSERT_EQUAL(0xCAFECAFE, csw.tag);
+  TEST_ASSERT_EQUAL(status, csw.status);
+  TEST_ASSERT_EQUAL(0, csw.data_residue);
+  tud_task(); // prepare for next CBW
+}
+
+static void write_async_done(void) {
+  memcpy(msc_disk[pending_write.lba] + pending_write.offset, pending_write.buffer, pending_write.bufsize);
+  TEST_ASSERT_TRUE(tud_msc_async_io_done((int32_t) pending_write.bufsize, false));
+  tud_task();
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tud_inited()) {
+    tusb_rhport_init_t dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(0, &dev_init);
+  }
+
+  TEST_ASSERT_TRUE(dcd_sim_connected(rhport));
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+
+  for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+    memset(msc_disk[i], i, DISK_BLOCK_SIZE);
+  }
+  read_count  = 0;
+  write_count = 0;
+  write_async = false;
+  write_max   = DISK_BLOCK_SIZE;
+
+  enumerate();
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_read10_read_ahead(void) {
+  send_rw10_cbw(SCSI_CMD_READ_10, 2, 4);
+
+  // second block is read while the first one is waiting for host
+  TEST_ASSERT_EQUAL(2, read_count);
+
+  for (uint8_t i = 0; i < 4; i++) {
+    uint8_t buf[DISK_BLOCK_SIZE];
+    uint16_t len = sizeof(buf);
+    TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_in(rhport, EDPT_MSC_IN, buf, &len));
+    TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, len);
+    TEST_ASSERT_EQUAL_MEMORY(msc_disk[2 + i], buf, DISK_BLOCK_SIZE);
+    tud_task();
+    TEST_ASSERT_EQUAL(tu_min8(4, i + 3), read_count);
+  }
+
+  receive_csw(MSC_CSW_STATUS_PASSED);
+}
+
+void test_write10_receive_ahead(void) {
+  static uint8_t data[3][DISK_BLOCK_SIZE];
+  for (uint8_t i = 0; i < 3; i++) {
+    memset(data[i], 0xA0 | i, DISK_BLOCK_SIZE);
+  }
+
+  write_async = true;
+  send_rw10_cbw(SCSI_CMD_WRITE_10, 5, 3);
+
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_out(rhport, EDPT_MSC_OUT, data[0], DISK_BLOCK_SIZE));
+  tud_task();
+  TEST_ASSERT_EQUAL(1, write_count);
+
+  // second block is received while the first one is being written
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_out(rhport, EDPT_MSC_OUT, data[1], DISK_BLOCK_SIZE));
+  tud_task();
+  TEST_ASSERT_EQUAL(1, write_count);
+
+  // both buffers are in use
+  TEST_ASSERT_EQUAL(DCD_SIM_NAK, dcd_sim_out(rhport, EDPT_MSC_OUT, data[2], DISK_BLOCK_SIZE));
+
+  write_async_done();
+  TEST_ASSERT_EQUAL(2, write_count);
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_out(rhport, EDPT_MSC_OUT, data[2], DISK_BLOCK_SIZE));
+  tud_task();
+
+  write_async_done();
+  TEST_ASSERT_EQUAL(3, write_count);
+  write_async_done();
+
+  receive_csw(MSC_CSW_STATUS_PASSED);
+  TEST_ASSERT_EQUAL_MEMORY(data, msc_disk[5], sizeof(data));
+}
+
+void test_write10_partial_consume(void) {
+  static uint8_t data[2][DISK_BLOCK_SIZE];
+  for (uint8_t i = 0; i < 2; i++) {
+    for (uint16_t j = 0; j < DISK_BLOCK_SIZE; j++) {
+      data[i][j] = (uint8_t) (i + j);
+    }
+  }
+
+  // application writes a quarter block per callback
+  write_max = DISK_BLOCK_SIZE / 4;
+  send_rw10_cbw(SCSI_CMD_WRITE_10, 7, 2);
+  for (uint8_t i = 0; i < 2; i++) {
+    TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_out(rhport, EDPT_MSC_OUT, data[i], DISK_BLOCK_SIZE));
+    tud_task();
+  }
+
+  receive_csw(MSC_CSW_STATUS_PASSED);
+  TEST_ASSERT_EQUAL(8, write_count);
+  TEST_ASSERT_EQUAL_MEMORY(data, msc_disk[7], sizeof(data));
+}
@@ -0,0 +1,387 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "host/hcd.h"
+#include "portable/sim/dcd_sim.h"
+#include "portable/sim/hcd_sim.h"
+TEST_SOURCE_FILE("usbh.c")
+TEST_SOURCE_FILE("hub.c")
+TEST_SOURCE_FILE("msc_host.c")
+TEST_SOURCE_FILE("msc_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+TEST_SOURCE_FILE("hcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+enum {
+  DEV_RHPORT  = 0,
+  HOST_RHPORT = 1,
+};
+
+enum {
+  EDPT_DATA_OUT = 0x01,
+  EDPT_DATA_IN  = 0x81,
+  EDPT_STATUS   = 0x82,
+  EDPT_CMD      = 0x03,
+};
+
+enum {
+  DISK_BLOCK_NUM  = 16,
+  DISK_BLOCK_SIZE = 512,
+  BAD_LBA         = 10, // read/write callbacks fail on this block
+};
+
+enum {
+  TIMEOUT_FRAMES = 2000,
+};
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_MSC_UAS_DESC_LEN)
+
+// simulated time
+uint32_t tusb_time_millis_api(void) {
+  return hcd_frame_number(HOST_RHPORT);
+}
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = 0x00,
+  .bDeviceSubClass    = 0x00,
+  .bDeviceProtocol    = 0x00,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4005,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, 1, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_MSC_UAS_DESCRIPTOR(0, 0, EDPT_DATA_OUT, EDPT_DATA_IN, EDPT_CMD, EDPT_STATUS, 512),
+};
+
+TU_VERIFY_STATIC(sizeof(desc_configuration) == CONFIG_TOTAL_LEN, "size is not correct");
+
+static uint8_t msc_disk[DISK_BLOCK_NUM][DISK_BLOCK_SIZE];
+static bool dev_busy;      // read callback returns BUSY
+static bool dev_protected; // write protected
+static bool dev_ready;
+static uint8_t dev_rw_count; // READ/WRITE commands completed by device
+
+static uint8_t msc_daddr;
+static uint8_t root_node;
+
+// host side command completion
+static uint8_t done_count;
+static uintptr_t done_order[8];
+static uint8_t done_status[8];
+
+//--------------------------------------------------------------------+
+// Device callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) langid;
+  static uint16_t const desc_langid[] = { (TUSB_DESC_STRING << 8) | 4, 0x0409 };
+  return (index == 0) ? desc_langid : NULL;
+}
+
+void tud_msc_inquiry_cb(uint8_t lun, uint8_t vendor_id[8], uint8_t product_id[16], uint8_t product_rev[4]) {
+  (void) lun;
+  memcpy(vendor_id, "TinyUSB ", 8);
+  memcpy(product_id, "UAS Disk        ", 16);
+  memcpy(product_rev, "1.0 ", 4);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+  (void) lun;
+  return dev_ready;
+}
+
+bool tud_msc_is_writable_cb(uint8_t lun) {
+  (void) lun;
+  return !dev_protected;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
+  (void) lun;
+  *block_count = DISK_BLOCK_NUM;
+  *block_size  = DISK_BLOCK_SIZE;
+}
+
+void tud_msc_read10_complete_cb(uint8_t lun) {
+  (void) lun;
+  dev_rw_count++;
+}
+
+void tud_msc_write10_complete_cb(uint8_t lun) {
+  (void) lun;
+  dev_rw_count++;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  (void) lun;
+  if (dev_busy) {
+    return TUD_MSC_RET_BUSY;
+  }
+  if (lba == BAD_LBA) {
+    return TUD_MSC_RET_ERROR;
+  }
+  memcpy(buffer, msc_disk[lba] + offset, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  (void) lun;
+  if (lba == BAD_LBA) {
+    return TUD_MSC_RET_ERROR;
+  }
+  memcpy(msc_disk[lba] + offset, buffer, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, uint16_t bufsize) {
+  (void) lun; (void) scsi_cmd; (void) buffer; (void) bufsize;
+  return -1;
+}
+
+//--------------------------------------------------------------------+
+// Host callbacks
+//--------------------------------------------------------------------+
+
+void tuh_msc_mount_cb(uint8_t daddr) {
+  msc_daddr = daddr;
+}
+
+void tuh_msc_umount_cb(uint8_t daddr) {
+  (void) daddr;
+  msc_daddr = 0;
+}
+
+static bool cmd_complete_cb(uint8_t daddr, tuh_msc_complete_data_t const* cb_data) {
+  (void) daddr;
+  TEST_ASSERT_TRUE(done_count < TU_ARRAY_SIZE(done_order));
+  done_status[done_count] = cb_data->csw->status;
+  done_order[done_count++] = cb_data->user_arg;
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void run_frames(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    hcd_sim_frame(HOST_RHPORT);
+    tud_task();
+    tuh_task();
+  }
+}
+
+static void run_until_done(uint8_t count) {
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && done_count < count; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(count, done_count);
+}
+
+static uint32_t cmd_pipe_count(void) {
+  return dcd_sim_edpt_stats(DEV_RHPORT, EDPT_CMD)->xfer_count;
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tusb_inited()) {
+    tusb_rhport_init_t const dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(DEV_RHPORT, &dev_init);
+
+    tusb_rhport_init_t const host_init = {
+      .role  = TUSB_ROLE_HOST,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(HOST_RHPORT, &host_init);
+  }
+
+  for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+    memset(msc_disk[i], i, DISK_BLOCK_SIZE);
+  }
+
+  dev_busy      = false;
+  dev_protected = false;
+  dev_ready     = true;
+  dev_rw_count  = 0;
+  done_count    = 0;
+  msc_daddr     = 0;
+  dcd_sim_edpt_stats_clear(DEV_RHPORT, EDPT_CMD);
+
+  root_node = hcd_sim_attach_dcd(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_HIGH, DEV_RHPORT);
+  TEST_ASSERT_NOT_EQUAL(0, root_node);
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && msc_daddr == 0; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_NOT_EQUAL(0, msc_daddr);
+}
+
+void tearDown(void) {
+  hcd_sim_detach(HOST_RHPORT, root_node);
+  run_frames(10);
+  TEST_ASSERT_EQUAL(0, msc_daddr);
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_mount(void) {
+  // host selected UAS, mount commands are sent on command pipe
+  TEST_ASSERT_TRUE(cmd_pipe_count() > 0);
+  TEST_ASSERT_TRUE(tuh_msc_ready(msc_daddr));
+  TEST_ASSERT_EQUAL(DISK_BLOCK_NUM, tuh_msc_get_block_count(msc_daddr, 0));
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, tuh_msc_get_block_size(msc_daddr, 0));
+
+  static scsi_inquiry_resp_t inquiry;
+  TEST_ASSERT_TRUE(tuh_msc_inquiry(msc_daddr, 0, &inquiry, cmd_complete_cb, 0));
+  run_until_done(1);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[0]);
+  TEST_ASSERT_EQUAL(1, inquiry.is_removable);
+  TEST_ASSERT_EQUAL_MEMORY("TinyUSB ", inquiry.vendor_id, 8);
+}
+
+void test_queued_commands(void) {
+  static uint8_t buf[CFG_TUH_MSC_CMD_QUEUE_SIZE][DISK_BLOCK_SIZE];
+  TEST_ASSERT_TRUE(CFG_TUH_MSC_CMD_QUEUE_SIZE <= CFG_TUD_MSC_UAS_CMD_QUEUE_SIZE + 1);
+
+  // first command is stuck in device while host sends the rest
+  dev_busy = true;
+  dcd_sim_edpt_stats_clear(DEV_RHPORT, EDPT_CMD);
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, buf[i], i + 1, 1, cmd_complete_cb, i));
+  }
+  run_frames(20);
+  TEST_ASSERT_EQUAL(0, done_count);
+  TEST_ASSERT_EQUAL(CFG_TUH_MSC_CMD_QUEUE_SIZE, cmd_pipe_count());
+
+  // executed in order received
+  dev_busy = false;
+  run_until_done(CFG_TUH_MSC_CMD_QUEUE_SIZE);
+  TEST_ASSERT_EQUAL(CFG_TUH_MSC_CMD_QUEUE_SIZE, dev_rw_count);
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    TEST_ASSERT_EQUAL(i, done_order[i]);
+    TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[i]);
+    TEST_ASSERT_EQUAL_MEMORY(msc_disk[i + 1], buf[i], DISK_BLOCK_SIZE);
+  }
+}
+
+void test_write_then_read(void) {
+  static uint8_t wbuf[3][DISK_BLOCK_SIZE];
+  static uint8_t rbuf[3][DISK_BLOCK_SIZE];
+  for (uint8_t i = 0; i < 3; i++) {
+    memset(wbuf[i], 0xA0 | i, DISK_BLOCK_SIZE);
+  }
+
+  // queued back to back
+  TEST_ASSERT_TRUE(tuh_msc_write10(msc_daddr, 0, wbuf, 5, 3, cmd_complete_cb, 0));
+  TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, rbuf, 5, 3, cmd_complete_cb, 1));
+  run_until_done(2);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[0]);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[1]);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, msc_disk[5], sizeof(wbuf));
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, rbuf, sizeof(rbuf));
+}
+
+void test_not_ready(void) {
+  dev_ready = false;
+  TEST_ASSERT_TRUE(tuh_msc_test_unit_ready(msc_daddr, 0, cmd_complete_cb, 0));
+  run_until_done(1);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_FAILED, done_status[0]);
+
+  // sense is reported in Sense IU and cleared
+  static scsi_sense_fixed_resp_t sense;
+  TEST_ASSERT_TRUE(tuh_msc_request_sense(msc_daddr, 0, &sense, cmd_complete_cb, 1));
+  run_until_done(2);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[1]);
+  TEST_ASSERT_EQUAL(SCSI_SENSE_NONE, sense.sense_key);
+}
+
+void test_read_error_mid_transfer(void) {
+  static uint8_t buf[3][DISK_BLOCK_SIZE];
+
+  // first block is sent before the failed one, data-in is ended early
+  TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, buf, BAD_LBA - 1, 3, cmd_complete_cb, 0));
+  TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, buf[2], 2, 1, cmd_complete_cb, 1));
+  run_until_done(2);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_FAILED, done_status[0]);
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[BAD_LBA - 1], buf[0], DISK_BLOCK_SIZE);
+
+  // pipes are not stalled, next command works
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[1]);
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[2], buf[2], DISK_BLOCK_SIZE);
+}
+
+void test_write_error_discard_data(void) {
+  static uint8_t wbuf[3][DISK_BLOCK_SIZE];
+  static uint8_t wbuf2[DISK_BLOCK_SIZE];
+  memset(wbuf, 0x55, sizeof(wbuf));
+  memset(wbuf2, 0x66, sizeof(wbuf2));
+
+  // rest of data-out is discarded after write callback failed on first block, data-out pipe is then usable again
+  TEST_ASSERT_TRUE(tuh_msc_write10(msc_daddr, 0, wbuf, BAD_LBA, 3, cmd_complete_cb, 0));
+  TEST_ASSERT_TRUE(tuh_msc_write10(msc_daddr, 0, wbuf2, 2, 1, cmd_complete_cb, 1));
+  run_until_done(2);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_FAILED, done_status[0]);
+  TEST_ASSERT_EACH_EQUAL_UINT8(BAD_LBA + 1, msc_disk[BAD_LBA + 1], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[1]);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf2, msc_disk[2], DISK_BLOCK_SIZE);
+}
+
+void test_write_protected(void) {
+  static uint8_t wbuf[DISK_BLOCK_SIZE];
+  memset(wbuf, 0x55, sizeof(wbuf));
+
+  // failed without data stage
+  dev_protected = true;
+  TEST_ASSERT_TRUE(tuh_msc_write10(msc_daddr, 0, wbuf, 3, 1, cmd_complete_cb, 0));
+  run_until_done(1);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_FAILED, done_status[0]);
+  TEST_ASSERT_EACH_EQUAL_UINT8(3, msc_disk[3], DISK_BLOCK_SIZE);
+
+  dev_protected = false;
+  TEST_ASSERT_TRUE(tuh_msc_write10(msc_daddr, 0, wbuf, 3, 1, cmd_complete_cb, 1));
+  run_until_done(2);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[1]);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, msc_disk[3], DISK_BLOCK_SIZE);
+}
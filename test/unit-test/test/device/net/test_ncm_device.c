@@ -0,0 +1,462 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "usbd.h"
+#include "usbd_pvt.h"
+#include "class/net/ncm.h"
+#include "portable/sim/dcd_sim.h"
+TEST_SOURCE_FILE("ncm_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+uint32_t tusb_time_millis_api(void) {
+  return 0;
+}
+
+enum {
+  EDPT_NOTIF = 0x81,
+  EDPT_OUT   = 0x02,
+  EDPT_IN    = 0x82,
+  EDPT_SIZE  = 512,
+};
+
+enum {
+  ITF_NUM_NCM,
+  ITF_NUM_NCM_DATA,
+  ITF_NUM_TOTAL
+};
+
+// NTB header with a single datagram as built by driver
+enum {
+  NTB_HDR_LEN = sizeof(nth16_t) + sizeof(ndp16_t) + 2 * sizeof(ndp16_datagram_t)
+};
+
+TU_VERIFY_STATIC(CFG_TUD_EDPT_XFER_QUEUE == 3 && CFG_TUD_NCM_OUT_NTB_N == 3, "test expects 3 receptions in flight");
+TU_VERIFY_STATIC(CFG_TUD_NCM_IN_NTB_N == 2, "test expects 2 transmit NTBs");
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_NCM_DESC_LEN)
+
+static uint8_t const rhport = 0;
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = TUSB_CLASS_MISC,
+  .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+  .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4006,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_CDC_NCM_DESCRIPTOR(ITF_NUM_NCM, 0, 0, EDPT_NOTIF, 64, EDPT_OUT, EDPT_IN, EDPT_SIZE, CFG_TUD_NET_MTU, 1, 0),
+};
+
+TU_VERIFY_STATIC(sizeof(desc_configuration) == CONFIG_TOTAL_LEN, "size is not correct");
+
+static xfer_result_t ctrl_result;
+
+// received datagrams
+static bool recv_accept;
+static bool recv_keep;
+static uint8_t recv_count;
+static struct {
+  uint8_t const* src;
+  uint16_t size;
+} recv_dg[16];
+
+// released transmit datagrams
+static uint8_t xmit_done_count;
+static void* xmit_done_ref;
+
+//--------------------------------------------------------------------+
+// Application callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) index;
+  (void) langid;
+  return NULL;
+}
+
+bool tud_network_recv_cb(const uint8_t* src, uint16_t size) {
+  if (!recv_accept) {
+    return false;
+  }
+  TEST_ASSERT_TRUE(recv_count < TU_ARRAY_SIZE(recv_dg));
+  recv_dg[recv_count].src  = src;
+  recv_dg[recv_count].size = size;
+  recv_count++;
+  if (recv_keep) {
+    tud_network_recv_hold();
+  }
+  tud_network_recv_renew();
+  return true;
+}
+
+uint16_t tud_network_xmit_cb(uint8_t* dst, void* ref, uint16_t arg) {
+  memcpy(dst, ref, arg);
+  return arg;
+}
+
+void tud_network_xmit_done_cb(void* ref) {
+  xmit_done_count++;
+  xmit_done_ref = ref;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void control_complete_cb(uint8_t port, tusb_control_request_t const* request, xfer_result_t result,
+                                uint16_t xferred_bytes) {
+  (void) port;
+  (void) request;
+  (void) xferred_bytes;
+  ctrl_result = result;
+}
+
+static void control_request(tusb_control_request_t const* request) {
+  ctrl_result = XFER_RESULT_INVALID;
+  TEST_ASSERT_TRUE(dcd_sim_control_xfer(rhport, request, NULL, control_complete_cb));
+  for (uint32_t f = 0; f < 8; f++) {
+    dcd_sim_frame(rhport);
+    tud_task();
+  }
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, ctrl_result);
+}
+
+static void enumerate(void) {
+  static tusb_control_request_t const requests[] = {
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_ADDRESS,       .wValue = 5 },
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_CONFIGURATION, .wValue = 1 },
+    { .bmRequestType = 0x01, .bRequest = TUSB_REQ_SET_INTERFACE,     .wValue = 1, .wIndex = ITF_NUM_NCM_DATA },
+  };
+
+  for (size_t i = 0; i < TU_ARRAY_SIZE(requests); i++) {
+    control_request(&requests[i]);
+  }
+  TEST_ASSERT_TRUE(tud_mounted());
+}
+
+static void fill_datagram(uint8_t* buf, uint16_t size, uint8_t seed) {
+  for (uint16_t i = 0; i < size; i++) {
+    buf[i] = (uint8_t) (seed + i);
+  }
+}
+
+// Build NTB with datagrams of given sizes, datagram i is filled with seed i
+static uint16_t build_ntb(uint8_t* ntb, uint16_t seq, uint8_t seed, uint16_t const* sizes, uint8_t count) {
+  uint16_t const ndp_len = (uint16_t) (sizeof(ndp16_t) + (count + 1) * sizeof(ndp16_datagram_t));
+  uint16_t pos = (uint16_t) (sizeof(nth16_t) + ndp_len);
+
+  ndp16_datagram_t dg[8];
+  TEST_ASSERT_TRUE(count < TU_ARRAY_SIZE(dg));
+  for (uint8_t i = 0; i < count; i++) {
+    pos = (uint16_t) ((pos + 3) & ~3u);
+    dg[i].wDatagramIndex  = pos;
+    dg[i].wDatagramLength = sizes[i];
+    fill_datagram(ntb + pos, sizes[i], (uint8_t) (seed + i));
+    pos = (uint16_t) (pos + sizes[i]);
+  }
+  dg[count].wDatagramIndex  = 0;
+  dg[count].wDatagramLength = 0;
+
+  nth16_t const nth = {
+    .dwSignature   = NTH16_SIGNATURE,
+    .wHeaderLength = sizeof(nth16_t),
+    .wSequence     = seq,
+    .wBlockLength  = pos,
+    .wNdpIndex     = sizeof(nth16_t)
+  };
+  ndp16_t const ndp = {
+    .dwSignature   = NDP16_SIGNATURE_NCM0,
+    .wLength       = ndp_len,
+    .wNextNdpIndex = 0
+  };
+  memcpy(ntb, &nth, sizeof(nth));
+  memcpy(ntb + sizeof(nth), &ndp, sizeof(ndp));
+  memcpy(ntb + sizeof(nth) + sizeof(ndp), dg, (count + 1) * sizeof(ndp16_datagram_t));
+
+  return pos;
+}
+
+// Host sends NTB packet by packet, return false if device NAKed
+static bool send_ntb(uint8_t const* ntb, uint16_t len) {
+  uint16_t pos = 0;
+  do {
+    uint16_t const n = tu_min16(EDPT_SIZE, (uint16_t) (len - pos));
+    if (dcd_sim_out(rhport, EDPT_OUT, ntb + pos, n) != DCD_SIM_ACK) {
+      TEST_ASSERT_EQUAL(0, pos); // NAK only before first packet
+      return false;
+    }
+    pos = (uint16_t) (pos + n);
+    if (n < EDPT_SIZE) {
+      break;
+    }
+  } while (pos < len || (len % EDPT_SIZE) == 0);
+  return true;
+}
+
+// Host reads one NTB (transfer ends with short packet), run device task while it NAKs
+static uint16_t receive_ntb(uint8_t* ntb, uint16_t bufsize) {
+  uint16_t pos = 0;
+  for (uint32_t retry = 0; retry < 16;) {
+    uint16_t len = EDPT_SIZE;
+    TEST_ASSERT_TRUE(pos + len <= bufsize);
+    dcd_sim_handshake_t const hs = dcd_sim_in(rhport, EDPT_IN, ntb + pos, &len);
+    if (hs == DCD_SIM_NAK) {
+      tud_task();
+      retry++;
+      continue;
+    }
+    TEST_ASSERT_EQUAL(DCD_SIM_ACK, hs);
+    pos = (uint16_t) (pos + len);
+    if (len < EDPT_SIZE) {
+      tud_task();
+      return pos;
+    }
+  }
+  TEST_FAIL_MESSAGE("NTB not complete");
+  return 0;
+}
+
+// Check NTB received by host and return the datagram at index
+static uint8_t const* ntb_datagram(uint8_t const* ntb, uint16_t len, uint8_t index, uint16_t* size) {
+  nth16_t nth;
+  memcpy(&nth, ntb, sizeof(nth));
+  TEST_ASSERT_EQUAL_HEX32(NTH16_SIGNATURE, nth.dwSignature);
+  TEST_ASSERT_EQUAL(len, nth.wBlockLength);
+
+  ndp16_datagram_t dg;
+  memcpy(&dg, ntb + nth.wNdpIndex + sizeof(ndp16_t) + index * sizeof(ndp16_datagram_t), sizeof(dg));
+  TEST_ASSERT_EQUAL(0, dg.wDatagramIndex % 4);
+  TEST_ASSERT_TRUE(dg.wDatagramIndex + dg.wDatagramLength <= len);
+  *size = dg.wDatagramLength;
+  return ntb + dg.wDatagramIndex;
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tud_inited()) {
+    tusb_rhport_init_t dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(0, &dev_init);
+  }
+
+  recv_accept     = true;
+  recv_keep       = false;
+  recv_count      = 0;
+  xmit_done_count = 0;
+  xmit_done_ref   = NULL;
+
+  TEST_ASSERT_TRUE(dcd_sim_connected(rhport));
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+
+  enumerate();
+  dcd_sim_edpt_stats_clear(rhport, EDPT_IN);
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_recv_queued(void) {
+  static uint8_t ntb[3][1024];
+  static uint16_t const sizes[] = { 60, 590, 100 };
+
+  // all receive NTBs are queued
+  TEST_ASSERT_EQUAL(3, usbd_edpt_xfer_count(rhport, EDPT_OUT));
+
+  // host sends 3 NTBs back to back while network stack is busy
+  recv_accept = false;
+  for (uint8_t i = 0; i < 3; i++) {
+    uint16_t const len = build_ntb(ntb[i], i, (uint8_t) (0x10 * i), &sizes[i], 1);
+    TEST_ASSERT_TRUE(send_ntb(ntb[i], len));
+  }
+  TEST_ASSERT_FALSE(send_ntb(ntb[0], 100));
+  tud_task();
+  TEST_ASSERT_EQUAL(0, recv_count);
+
+  // datagrams are delivered in order, then receptions are queued again
+  recv_accept = true;
+  tud_network_recv_renew();
+  TEST_ASSERT_EQUAL(3, recv_count);
+  for (uint8_t i = 0; i < 3; i++) {
+    uint8_t expected[1024];
+    fill_datagram(expected, sizes[i], (uint8_t) (0x10 * i));
+    TEST_ASSERT_EQUAL(sizes[i], recv_dg[i].size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, recv_dg[i].src, sizes[i]);
+  }
+  TEST_ASSERT_EQUAL(3, usbd_edpt_xfer_count(rhport, EDPT_OUT));
+}
+
+void test_recv_hold(void) {
+  static uint8_t ntb[1024];
+  static uint16_t const sizes[] = { 100, 200 };
+  uint8_t expected[2][200];
+
+  // stack keeps both datagrams of first NTB
+  recv_keep = true;
+  uint16_t len = build_ntb(ntb, 0, 0x40, sizes, 2);
+  TEST_ASSERT_TRUE(send_ntb(ntb, len));
+  tud_task();
+  TEST_ASSERT_EQUAL(2, recv_count);
+  TEST_ASSERT_EQUAL(2, usbd_edpt_xfer_count(rhport, EDPT_OUT));
+
+  // other NTBs are used for reception meanwhile
+  recv_keep = false;
+  for (uint8_t i = 0; i < 4; i++) {
+    len = build_ntb(ntb, (uint16_t) (i + 1), (uint8_t) (0x80 + i), &sizes[1], 1);
+    TEST_ASSERT_TRUE(send_ntb(ntb, len));
+    tud_task();
+  }
+  TEST_ASSERT_EQUAL(6, recv_count);
+  TEST_ASSERT_EQUAL(2, usbd_edpt_xfer_count(rhport, EDPT_OUT));
+
+  // held datagrams are untouched
+  fill_datagram(expected[0], sizes[0], 0x40);
+  fill_datagram(expected[1], sizes[1], 0x41);
+  TEST_ASSERT_EQUAL_MEMORY(expected[0], recv_dg[0].src, sizes[0]);
+  TEST_ASSERT_EQUAL_MEMORY(expected[1], recv_dg[1].src, sizes[1]);
+
+  // NTB is reused once all its datagrams are released
+  tud_network_recv_release(recv_dg[1].src);
+  TEST_ASSERT_EQUAL(2, usbd_edpt_xfer_count(rhport, EDPT_OUT));
+  tud_network_recv_release(recv_dg[0].src);
+  TEST_ASSERT_EQUAL(3, usbd_edpt_xfer_count(rhport, EDPT_OUT));
+}
+
+void test_xmit_sg_gather(void) {
+  static uint8_t ntb[1024];
+  uint8_t data[60];
+  fill_datagram(data, sizeof(data), 0x20);
+
+  // short datagram is copied into NTB, segments are released right away
+  tud_network_seg_t const seg[] = {
+    { .buf = data,      .len = 20 },
+    { .buf = data + 20, .len = 40 },
+  };
+  TEST_ASSERT_TRUE(tud_network_xmit_sg(data, seg, 2));
+  TEST_ASSERT_EQUAL(1, xmit_done_count);
+  TEST_ASSERT_EQUAL_PTR(data, xmit_done_ref);
+
+  uint16_t const len = receive_ntb(ntb, sizeof(ntb));
+  uint16_t size;
+  uint8_t const* dg = ntb_datagram(ntb, len, 0, &size);
+  TEST_ASSERT_EQUAL(sizeof(data), size);
+  TEST_ASSERT_EQUAL_MEMORY(data, dg, sizeof(data));
+}
+
+void test_xmit_sg_inplace(void) {
+  static uint8_t ntb[2][2048];
+  static uint8_t small[64];
+  static uint8_t data[1500];
+  fill_datagram(small, sizeof(small), 0x55);
+  fill_datagram(data, sizeof(data), 0x33);
+
+  // small datagram goes first, large one is queued and sent from the segments
+  tud_network_seg_t const seg_small = { .buf = small, .len = sizeof(small) };
+  TEST_ASSERT_TRUE(tud_network_xmit_sg(small, &seg_small, 1));
+
+  tud_network_seg_t const seg[] = {
+    { .buf = data,       .len = 100 },
+    { .buf = data + 100, .len = 900 },
+    { .buf = data + 1000, .len = 500 },
+  };
+  TEST_ASSERT_TRUE(tud_network_xmit_sg(data, seg, 3));
+  TEST_ASSERT_EQUAL(1, xmit_done_count);
+
+  // no transmit NTB left
+  TEST_ASSERT_FALSE(tud_network_xmit_sg(small, &seg_small, 1));
+
+  uint16_t len = receive_ntb(ntb[0], sizeof(ntb[0]));
+  uint16_t size;
+  uint8_t const* dg = ntb_datagram(ntb[0], len, 0, &size);
+  TEST_ASSERT_EQUAL(sizeof(small), size);
+  TEST_ASSERT_EQUAL_MEMORY(small, dg, sizeof(small));
+
+  dcd_sim_edpt_stats_clear(rhport, EDPT_IN);
+  len = receive_ntb(ntb[1], sizeof(ntb[1]));
+  TEST_ASSERT_EQUAL(NTB_HDR_LEN + sizeof(data), len);
+  dg = ntb_datagram(ntb[1], len, 0, &size);
+  TEST_ASSERT_EQUAL(sizeof(data), size);
+  TEST_ASSERT_EQUAL_MEMORY(data, dg, sizeof(data));
+
+  // NTB is split into several transfers, segments are released when sent
+  TEST_ASSERT_TRUE(dcd_sim_edpt_stats(rhport, EDPT_IN)->xfer_count > 1);
+  TEST_ASSERT_EQUAL(2, xmit_done_count);
+  TEST_ASSERT_EQUAL_PTR(data, xmit_done_ref);
+}
+
+void test_xmit_sg_inplace_zlp(void) {
+  static uint8_t ntb[2048];
+  static uint8_t data[3 * EDPT_SIZE - NTB_HDR_LEN];
+  fill_datagram(data, sizeof(data), 0x77);
+
+  // NTB is a multiple of packet size and terminated with ZLP
+  tud_network_seg_t const seg = { .buf = data, .len = sizeof(data) };
+  TEST_ASSERT_TRUE(tud_network_xmit_sg(data, &seg, 1));
+  TEST_ASSERT_EQUAL(0, xmit_done_count);
+
+  uint16_t const len = receive_ntb(ntb, sizeof(ntb));
+  TEST_ASSERT_EQUAL(3 * EDPT_SIZE, len);
+  uint16_t size;
+  uint8_t const* dg = ntb_datagram(ntb, len, 0, &size);
+  TEST_ASSERT_EQUAL(sizeof(data), size);
+  TEST_ASSERT_EQUAL_MEMORY(data, dg, sizeof(data));
+  TEST_ASSERT_EQUAL(1, xmit_done_count);
+}
+
+void test_xmit_sg_inplace_bus_reset(void) {
+  static uint8_t data[1500];
+
+  tud_network_seg_t const seg = { .buf = data, .len = sizeof(data) };
+  TEST_ASSERT_TRUE(tud_network_xmit_sg(data, &seg, 1));
+  TEST_ASSERT_EQUAL(0, xmit_done_count);
+
+  // pending segments are given back on bus reset
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+  TEST_ASSERT_EQUAL(1, xmit_done_count);
+  TEST_ASSERT_EQUAL_PTR(data, xmit_done_ref);
+}
@@ -0,0 +1,427 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "usbd.h"
+#include "portable/sim/dcd_sim.h"
+#include "device/usbd_pvt.h"
+TEST_SOURCE_FILE("msc_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+uint32_t tusb_time_millis_api(void) {
+  return 0;
+}
+
+enum {
+  EDPT_MSC_OUT = 0x01,
+  EDPT_MSC_IN  = 0x81,
+};
+
+enum {
+  ITF_NUM_MSC,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  DISK_BLOCK_NUM  = 16,
+  DISK_BLOCK_SIZE = 512
+};
+
+TU_VERIFY_STATIC(CFG_TUD_EDPT_XFER_QUEUE > 1, "test expects transfer queue");
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_MSC_DESC_LEN)
+
+static uint8_t const rhport = 0;
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = 0x00,
+  .bDeviceSubClass    = 0x00,
+  .bDeviceProtocol    = 0x00,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4003,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, 0, EDPT_MSC_OUT, EDPT_MSC_IN, 512),
+};
+
+static uint8_t msc_disk[DISK_BLOCK_NUM][DISK_BLOCK_SIZE];
+
+static xfer_result_t ctrl_result;
+static uint16_t ctrl_xferred;
+static uint32_t sof_count;
+static uint32_t sof_frame;
+
+//--------------------------------------------------------------------+
+// Application callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) index;
+  (void) langid;
+  return NULL;
+}
+
+void tud_sof_cb(uint32_t frame_count) {
+  sof_frame = frame_count;
+  sof_count++;
+}
+
+uint32_t tud_msc_inquiry2_cb(uint8_t lun, scsi_inquiry_resp_t* inquiry_resp, uint32_t bufsize) {
+  (void) lun;
+  (void) inquiry_resp;
+  (void) bufsize;
+  return sizeof(scsi_inquiry_resp_t);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+  (void) lun;
+  return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
+  (void) lun;
+  *block_count = DISK_BLOCK_NUM;
+  *block_size  = DISK_BLOCK_SIZE;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  (void) lun;
+  memcpy(buffer, msc_disk[lba] + offset, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  (void) lun;
+  memcpy(msc_disk[lba] + offset, buffer, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, uint16_t bufsize) {
+  (void) lun;
+  (void) scsi_cmd;
+  (void) buffer;
+  (void) bufsize;
+  return -1;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void control_complete_cb(uint8_t port, tusb_control_request_t const* request, xfer_result_t result,
+                                uint16_t xferred_bytes) {
+  (void) port;
+  (void) request;
+  ctrl_result  = result;
+  ctrl_xferred = xferred_bytes;
+}
+
+// run scripted host and device stack for a number of frames
+static void run_frames(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    dcd_sim_frame(rhport);
+    tud_task();
+  }
+}
+
+static bool control_xfer(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex,
+                         uint16_t wLength, void* buffer) {
+  tusb_control_request_t const request = {
+    .bmRequestType = bmRequestType,
+    .bRequest      = bRequest,
+    .wValue        = wValue,
+    .wIndex        = wIndex,
+    .wLength       = wLength
+  };
+
+  ctrl_result  = XFER_RESULT_INVALID;
+  ctrl_xferred = 0;
+  TEST_ASSERT_TRUE(dcd_sim_control_xfer(rhport, &request, buffer, control_complete_cb));
+  run_frames(8);
+  TEST_ASSERT_FALSE(dcd_sim_control_busy(rhport));
+
+  return ctrl_result == XFER_RESULT_SUCCESS;
+}
+
+static void enumerate(void) {
+  TEST_ASSERT_TRUE(control_xfer(0x00, TUSB_REQ_SET_ADDRESS, 5, 0, 0, NULL));
+  TEST_ASSERT_TRUE(control_xfer(0x00, TUSB_REQ_SET_CONFIGURATION, 1, 0, 0, NULL));
+  TEST_ASSERT_TRUE(tud_mounted());
+}
+
+static void make_read10_cbw(msc_cbw_t* cbw, uint32_t lba) {
+  scsi_read10_t const cmd = {
+    .cmd_code    = SCSI_CMD_READ_10,
+    .lba         = tu_htonl(lba),
+    .block_count = tu_htons(1)
+  };
+
+  tu_memclr(cbw, sizeof(msc_cbw_t));
+  cbw->signature   = MSC_CBW_SIGNATURE;
+  cbw->tag         = 0xCAFECAFE;
+  cbw->total_bytes = DISK_BLOCK_SIZE;
+  cbw->dir         = TUSB_DIR_IN_MASK;
+  cbw->cmd_len     = sizeof(scsi_read10_t);
+  memcpy(cbw->command, &cmd, sizeof(cmd));
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tud_inited()) {
+    tusb_rhport_init_t dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(0, &dev_init);
+  }
+
+  TEST_ASSERT_TRUE(dcd_sim_connected(rhport));
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+
+  for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+    memset(msc_disk[i], i, DISK_BLOCK_SIZE);
+  }
+  sof_count = 0;
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_get_device_descriptor(void) {
+  tusb_desc_device_t desc;
+  TEST_ASSERT_TRUE(control_xfer(0x80, TUSB_REQ_GET_DESCRIPTOR, TUSB_DESC_DEVICE << 8, 0, sizeof(desc), &desc));
+  TEST_ASSERT_EQUAL(sizeof(desc), ctrl_xferred);
+  TEST_ASSERT_EQUAL_MEMORY(&desc_device, &desc, sizeof(desc));
+}
+
+void test_set_address(void) {
+  TEST_ASSERT_EQUAL(0, dcd_sim_address(rhport));
+  TEST_ASSERT_TRUE(control_xfer(0x00, TUSB_REQ_SET_ADDRESS, 5, 0, 0, NULL));
+  TEST_ASSERT_EQUAL(5, dcd_sim_address(rhport));
+
+  // bus reset goes back to default address
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  TEST_ASSERT_EQUAL(0, dcd_sim_address(rhport));
+}
+
+void test_unsupported_request_stall(void) {
+  // no string descriptor
+  uint8_t buf[64];
+  TEST_ASSERT_FALSE(control_xfer(0x80, TUSB_REQ_GET_DESCRIPTOR, (TUSB_DESC_STRING << 8) | 1, 0, sizeof(buf), buf));
+  TEST_ASSERT_EQUAL(XFER_RESULT_STALLED, ctrl_result);
+
+  // control pipe recovers on next SETUP
+  tusb_desc_device_t desc;
+  TEST_ASSERT_TRUE(control_xfer(0x80, TUSB_REQ_GET_DESCRIPTOR, TUSB_DESC_DEVICE << 8, 0, sizeof(desc), &desc));
+}
+
+void test_msc_read10(void) {
+  enumerate();
+
+  // no transfer queued on IN endpoint yet
+  uint8_t buf[512];
+  uint16_t len = sizeof(buf);
+  TEST_ASSERT_EQUAL(DCD_SIM_NAK, dcd_sim_in(rhport, EDPT_MSC_IN, buf, &len));
+  TEST_ASSERT_EQUAL(1, dcd_sim_edpt_stats(rhport, EDPT_MSC_IN)->nak_count);
+
+  msc_cbw_t cbw;
+  make_read10_cbw(&cbw, 3);
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_out(rhport, EDPT_MSC_OUT, (uint8_t const*) &cbw, sizeof(cbw)));
+  tud_task();
+
+  len = sizeof(buf);
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_in(rhport, EDPT_MSC_IN, buf, &len));
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, len);
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[3], buf, DISK_BLOCK_SIZE);
+  tud_task();
+
+  msc_csw_t csw;
+  len = sizeof(buf);
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_in(rhport, EDPT_MSC_IN, buf, &len));
+  TEST_ASSERT_EQUAL(sizeof(msc_csw_t), len);
+  memcpy(&csw, buf, sizeof(csw));
+  TEST_ASSERT_EQUAL(MSC_CSW_SIGNATURE, csw.signature);
+  TEST_ASSERT_EQUAL(0xCAFECAFE, csw.tag);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, csw.status);
+  tud_task(); // prepare for next CBW
+
+  dcd_sim_edpt_stats_t const* stats = dcd_sim_edpt_stats(rhport, EDPT_MSC_IN);
+  TEST_ASSERT_EQUAL(2, stats->xfer_count);
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE + sizeof(msc_csw_t), stats->byte_count);
+}
+
+void test_msc_unsupported_stall(void) {
+  enumerate();
+
+  // unknown SCSI command with data IN: endpoint is stalled
+  msc_cbw_t cbw;
+  make_read10_cbw(&cbw, 0);
+  cbw.command[0] = 0xFF;
+  TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_out(rhport, EDPT_MSC_OUT, (uint8_t const*) &cbw, sizeof(cbw)));
+  tud_task();
+
+  uint8_t buf[512];
+  uint16_t len = sizeof(buf);
+  TEST_ASSERT_EQUAL(DCD_SIM_STALL, dcd_sim_in(rhport, EDPT_MSC_IN, buf, &len));
+  TEST_ASSERT_EQUAL(1, dcd_sim_edpt_stats(rhport, EDPT_MSC_IN)->stall_count);
+}
+
+static msc_cbw_t stream_cbw;
+static uint8_t stream_rx[DISK_BLOCK_SIZE + sizeof(msc_csw_t)];
+static uint16_t stream_rx_count;
+
+static uint16_t cbw_source(uint8_t port, uint8_t ep_addr, uint8_t* data, uint16_t len) {
+  (void) port;
+  (void) ep_addr;
+  uint16_t const count = tu_min16(len, sizeof(stream_cbw));
+  memcpy(data, &stream_cbw, count);
+  return count;
+}
+
+static void data_sink(uint8_t port, uint8_t ep_addr, uint8_t const* data, uint16_t len) {
+  (void) port;
+  (void) ep_addr;
+  TEST_ASSERT_TRUE(stream_rx_count + len <= sizeof(stream_rx));
+  memcpy(stream_rx + stream_rx_count, data, len);
+  stream_rx_count += len;
+}
+
+void test_stream(void) {
+  enumerate();
+  tud_sof_cb_enable(true);
+
+  make_read10_cbw(&stream_cbw, 7);
+  stream_rx_count = 0;
+
+  dcd_sim_stream_t const out_stream = {
+    .ep_addr           = EDPT_MSC_OUT,
+    .packets_per_frame = 1,
+    .packet_size       = sizeof(msc_cbw_t),
+    .total_bytes       = sizeof(msc_cbw_t),
+    .out_source        = cbw_source,
+  };
+
+  dcd_sim_stream_t const in_stream = {
+    .ep_addr           = EDPT_MSC_IN,
+    .packets_per_frame = 2,
+    .total_bytes       = sizeof(stream_rx),
+    .in_sink           = data_sink,
+  };
+
+  TEST_ASSERT_TRUE(dcd_sim_stream_start(rhport, &out_stream));
+  TEST_ASSERT_TRUE(dcd_sim_stream_start(rhport, &in_stream));
+  TEST_ASSERT_FALSE(dcd_sim_stream_start(rhport, &in_stream)); // already running
+
+  run_frames(16);
+
+  TEST_ASSERT_EQUAL(sizeof(msc_cbw_t), dcd_sim_stream_bytes(rhport, EDPT_MSC_OUT));
+  TEST_ASSERT_EQUAL(sizeof(stream_rx), dcd_sim_stream_bytes(rhport, EDPT_MSC_IN));
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[7], stream_rx, DISK_BLOCK_SIZE);
+
+  // SOF on every microframe
+  TEST_ASSERT_EQUAL(16, sof_count);
+
+  dcd_sim_stream_stop(rhport, EDPT_MSC_OUT);
+  dcd_sim_stream_stop(rhport, EDPT_MSC_IN);
+  TEST_ASSERT_EQUAL(0, dcd_sim_stream_bytes(rhport, EDPT_MSC_IN));
+  tud_sof_cb_enable(false);
+}
+
+void test_sof_coalesced(void) {
+  enumerate();
+  tud_sof_cb_enable(true);
+  sof_count = 0;
+
+  // SOFs queued back-to-back are reported once with the latest frame
+  for (uint32_t i = 0; i < 6; i++) {
+    dcd_sim_sof(rhport);
+  }
+  tud_task();
+  TEST_ASSERT_EQUAL(1, sof_count);
+  const uint32_t last_frame = sof_frame;
+
+  // one more frame (8 microframes on highspeed) spans several batches, still reported once with microframe index
+  for (uint32_t i = 0; i < 8; i++) {
+    dcd_sim_sof(rhport);
+  }
+  tud_task();
+  TEST_ASSERT_EQUAL(2, sof_count);
+  TEST_ASSERT_EQUAL(last_frame + 8, sof_frame);
+  TEST_ASSERT_EQUAL((last_frame >> 3) + 1, usbd_sof_frame_number(sof_frame));
+
+  tud_sof_cb_enable(false);
+}
+
+void test_edpt_xfer_queue(void) {
+  enumerate();
+
+  // MSC is waiting for CBW and ignores completion on IN endpoint
+  static uint8_t xfer_buf[CFG_TUD_EDPT_XFER_QUEUE][64];
+  for (uint8_t i = 0; i < CFG_TUD_EDPT_XFER_QUEUE; i++) {
+    memset(xfer_buf[i], 0xA0 + i, sizeof(xfer_buf[i]));
+    TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, EDPT_MSC_IN, xfer_buf[i], sizeof(xfer_buf[i]), false));
+  }
+  TEST_ASSERT_EQUAL(CFG_TUD_EDPT_XFER_QUEUE, usbd_edpt_xfer_count(rhport, EDPT_MSC_IN));
+
+  // queue is full
+  TEST_ASSERT_FALSE(usbd_edpt_xfer(rhport, EDPT_MSC_IN, xfer_buf[0], sizeof(xfer_buf[0]), false));
+
+  // queued transfers are started as soon as previous one completes, without running tud_task()
+  uint8_t buf[512];
+  for (uint8_t i = 0; i < CFG_TUD_EDPT_XFER_QUEUE; i++) {
+    uint16_t len = sizeof(buf);
+    TEST_ASSERT_EQUAL(DCD_SIM_ACK, dcd_sim_in(rhport, EDPT_MSC_IN, buf, &len));
+    TEST_ASSERT_EQUAL(sizeof(xfer_buf[i]), len);
+    TEST_ASSERT_EQUAL_MEMORY(xfer_buf[i], buf, len);
+  }
+
+  uint16_t len = sizeof(buf);
+  TEST_ASSERT_EQUAL(DCD_SIM_NAK, dcd_sim_in(rhport, EDPT_MSC_IN, buf, &len));
+
+  // endpoint is busy until all completions are processed by class driver
+  TEST_ASSERT_TRUE(usbd_edpt_busy(rhport, EDPT_MSC_IN));
+  tud_task();
+  TEST_ASSERT_EQUAL(0, usbd_edpt_xfer_count(rhport, EDPT_MSC_IN));
+  TEST_ASSERT_FALSE(usbd_edpt_busy(rhport, EDPT_MSC_IN));
+}
@@ -0,0 +1,452 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <stdio.h>
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "usbd.h"
+#include "portable/sim/dcd_sim.h"
+TEST_SOURCE_FILE("video_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+uint32_t tusb_time_millis_api(void) {
+  return 0;
+}
+
+enum {
+  EDPT_VIDEO_IN = 0x81,
+  EDPT_SIZE     = 512,
+};
+
+enum {
+  ITF_NUM_VIDEO_CONTROL,
+  ITF_NUM_VIDEO_STREAMING,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  UVC_ENTITY_CAP_INPUT_TERMINAL  = 0x01,
+  UVC_ENTITY_CAP_OUTPUT_TERMINAL = 0x02,
+};
+
+#define UVC_CLOCK_FREQUENCY 27000000
+
+// 1080p MJPEG @ 30 fps
+#define FRAME_WIDTH    1920
+#define FRAME_HEIGHT   1080
+#define FRAME_RATE     30
+#define FRAME_INTERVAL (10000000 / FRAME_RATE)
+
+// compressed frame size used by tests
+#define FRAME_SIZE     (300 * 1024)
+
+#define TUD_VIDEO_CAPTURE_DESC_MJPEG_BULK_LEN (\
+    TUD_VIDEO_DESC_IAD_LEN\
+    /* control */\
+    + TUD_VIDEO_DESC_STD_VC_LEN\
+    + (TUD_VIDEO_DESC_CS_VC_LEN + 1/*bInCollection*/)\
+    + TUD_VIDEO_DESC_CAMERA_TERM_LEN\
+    + TUD_VIDEO_DESC_OUTPUT_TERM_LEN\
+    /* Interface 1, Alternate 0 */\
+    + TUD_VIDEO_DESC_STD_VS_LEN\
+    + (TUD_VIDEO_DESC_CS_VS_IN_LEN + 1/*bNumFormats x bControlSize*/)\
+    + TUD_VIDEO_DESC_CS_VS_FMT_MJPEG_LEN\
+    + TUD_VIDEO_DESC_CS_VS_FRM_MJPEG_CONT_LEN\
+    + TUD_VIDEO_DESC_CS_VS_COLOR_MATCHING_LEN\
+    + 7/* Endpoint */\
+  )
+
+#define TUD_VIDEO_CAPTURE_DESCRIPTOR_MJPEG_BULK(_stridx, _epin, _width, _height, _fps, _epsize) \
+  TUD_VIDEO_DESC_IAD(ITF_NUM_VIDEO_CONTROL, /* 2 Interfaces */ 0x02, _stridx), \
+  /* Video control 0 */ \
+  TUD_VIDEO_DESC_STD_VC(ITF_NUM_VIDEO_CONTROL, 0, _stridx),                                     \
+    /* Header: UVC 1.5, length of followed descs, clock (deprecated), streaming interfaces */ \
+    TUD_VIDEO_DESC_CS_VC(0x0150, TUD_VIDEO_DESC_CAMERA_TERM_LEN + TUD_VIDEO_DESC_OUTPUT_TERM_LEN, UVC_CLOCK_FREQUENCY, ITF_NUM_VIDEO_STREAMING), \
+      /* Camera Terminal: ID, bAssocTerminal, iTerminal, focal min, max, length, bmControl */ \
+      TUD_VIDEO_DESC_CAMERA_TERM(UVC_ENTITY_CAP_INPUT_TERMINAL, 0, 0, 0, 0, 0, 0), \
+      TUD_VIDEO_DESC_OUTPUT_TERM(UVC_ENTITY_CAP_OUTPUT_TERMINAL, VIDEO_TT_STREAMING, 0, UVC_ENTITY_CAP_INPUT_TERMINAL, 0), \
+  /* Video stream alt. 0 */ \
+  TUD_VIDEO_DESC_STD_VS(ITF_NUM_VIDEO_STREAMING, 0, 1, _stridx), \
+    /* Video stream header for without still image capture */ \
+    TUD_VIDEO_DESC_CS_VS_INPUT( /*bNumFormats*/1, \
+        /*wTotalLength - bLength */ TUD_VIDEO_DESC_CS_VS_FMT_MJPEG_LEN + TUD_VIDEO_DESC_CS_VS_FRM_MJPEG_CONT_LEN + TUD_VIDEO_DESC_CS_VS_COLOR_MATCHING_LEN,\
+        _epin, /*bmInfo*/0, /*bTerminalLink*/UVC_ENTITY_CAP_OUTPUT_TERMINAL, \
+        /*bStillCaptureMethod*/0, /*bTriggerSupport*/0, /*bTriggerUsage*/0, \
+        /*bmaControls(1)*/0), \
+      /* Video stream format */ \
+      TUD_VIDEO_DESC_CS_VS_FMT_MJPEG(/*bFormatIndex*/1, /*bNumFrameDescriptors*/1, \
+        /*bmFlags*/0, /*bDefaultFrameIndex*/1, 0, 0, 0, /*bCopyProtect*/0), \
+        /* Video stream frame format */ \
+        TUD_VIDEO_DESC_CS_VS_FRM_MJPEG_CONT(/*bFrameIndex */1, 0, _width, _height, \
+            _width * _height * 16, _width * _height * 16 * _fps, \
+            _width * _height * 16 / 8, \
+            (10000000/_fps), (10000000/_fps), (10000000/_fps)*_fps, (10000000/_fps)), \
+        TUD_VIDEO_DESC_CS_VS_COLOR_MATCHING(VIDEO_COLOR_PRIMARIES_BT709, VIDEO_COLOR_XFER_CH_BT709, VIDEO_COLOR_COEF_SMPTE170M), \
+        /* EP */ \
+        TUD_VIDEO_DESC_EP_BULK(_epin, _epsize, 1)
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_VIDEO_CAPTURE_DESC_MJPEG_BULK_LEN)
+
+static uint8_t const rhport = 0;
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = TUSB_CLASS_MISC,
+  .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+  .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x400A,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 500),
+  TUD_VIDEO_CAPTURE_DESCRIPTOR_MJPEG_BULK(0, EDPT_VIDEO_IN, FRAME_WIDTH, FRAME_HEIGHT, FRAME_RATE, EDPT_SIZE),
+};
+
+TU_VERIFY_STATIC(sizeof(desc_configuration) == CONFIG_TOTAL_LEN, "size is not correct");
+
+static xfer_result_t ctrl_result;
+static uint32_t complete_count;
+static uint32_t payload_size; // negotiated dwMaxPayloadTransferSize
+
+static uint8_t frame_buf[2][FRAME_SIZE];
+static uint8_t rx_buf[FRAME_SIZE];
+
+//--------------------------------------------------------------------+
+// Application callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) index;
+  (void) langid;
+  return NULL;
+}
+
+void tud_video_frame_xfer_complete_cb(uint_fast8_t ctl_idx, uint_fast8_t stm_idx) {
+  (void) ctl_idx;
+  (void) stm_idx;
+  complete_count++;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void control_complete_cb(uint8_t port, tusb_control_request_t const* request, xfer_result_t result,
+                                uint16_t xferred_bytes) {
+  (void) port;
+  (void) request;
+  (void) xferred_bytes;
+  ctrl_result = result;
+}
+
+static void control_xfer(tusb_control_request_t const* request, void* buffer) {
+  ctrl_result = XFER_RESULT_INVALID;
+  TEST_ASSERT_TRUE(dcd_sim_control_xfer(rhport, request, buffer, control_complete_cb));
+  for (uint32_t f = 0; f < 8; f++) {
+    dcd_sim_frame(rhport);
+    tud_task();
+  }
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, ctrl_result);
+}
+
+static void enumerate(void) {
+  static tusb_control_request_t const requests[] = {
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_ADDRESS,       .wValue = 5 },
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_CONFIGURATION, .wValue = 1 },
+  };
+
+  for (size_t i = 0; i < TU_ARRAY_SIZE(requests); i++) {
+    control_xfer(&requests[i], NULL);
+  }
+  TEST_ASSERT_TRUE(tud_mounted());
+}
+
+// probe and commit streaming parameters, return negotiated payload size
+static uint32_t probe_commit(void) {
+  video_probe_and_commit_control_t param = {
+    .bFormatIndex    = 1,
+    .bFrameIndex     = 1,
+    .dwFrameInterval = FRAME_INTERVAL,
+  };
+
+  tusb_control_request_t request = {
+    .bmRequestType = 0x21,
+    .bRequest      = VIDEO_REQUEST_SET_CUR,
+    .wValue        = VIDEO_VS_CTL_PROBE << 8,
+    .wIndex        = ITF_NUM_VIDEO_STREAMING,
+    .wLength       = sizeof(param)
+  };
+  control_xfer(&request, &param);
+
+  request.bmRequestType = 0xA1;
+  request.bRequest      = VIDEO_REQUEST_GET_CUR;
+  control_xfer(&request, &param);
+
+  request.bmRequestType = 0x21;
+  request.bRequest      = VIDEO_REQUEST_SET_CUR;
+  request.wValue        = VIDEO_VS_CTL_COMMIT << 8;
+  control_xfer(&request, &param);
+
+  return param.dwMaxPayloadTransferSize;
+}
+
+// host reads one payload (up to a short packet or payload size), return its length or -1 if NAKed
+static int32_t host_read_payload(uint8_t* buf) {
+  uint32_t total = 0;
+  while (total < payload_size) {
+    uint16_t len = EDPT_SIZE;
+    if (DCD_SIM_ACK != dcd_sim_in(rhport, EDPT_VIDEO_IN, buf + total, &len)) {
+      TEST_ASSERT_EQUAL(0, total); // no NAK within a payload
+      return -1;
+    }
+    tud_task();
+    total += len;
+    if (len < EDPT_SIZE) {
+      break;
+    }
+  }
+  return (int32_t) total;
+}
+
+// host reads payloads of one frame into rx_buf, checks header and return frame size
+static uint32_t host_read_frame(uint8_t* fid) {
+  static uint8_t payload[FRAME_SIZE + 2];
+  uint32_t size = 0;
+  bool eof = false;
+
+  while (!eof) {
+    int32_t const len = host_read_payload(payload);
+    TEST_ASSERT_GREATER_THAN(0, len);
+
+    tusb_video_payload_header_t const* hdr = (tusb_video_payload_header_t const*) payload;
+    TEST_ASSERT_EQUAL(sizeof(*hdr), hdr->bHeaderLength);
+    if (size == 0) {
+      TEST_ASSERT_NOT_EQUAL(*fid, hdr->FrameID);
+      *fid = hdr->FrameID;
+    } else {
+      TEST_ASSERT_EQUAL(*fid, hdr->FrameID);
+    }
+    eof = hdr->EndOfFrame;
+    // only the last payload of a frame may be shorter than negotiated size
+    if (!eof) {
+      TEST_ASSERT_EQUAL(payload_size, len);
+    }
+
+    uint32_t const data_len = (uint32_t) len - hdr->bHeaderLength;
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(rx_buf) - size, data_len);
+    memcpy(rx_buf + size, payload + hdr->bHeaderLength, data_len);
+    size += data_len;
+  }
+  return size;
+}
+
+static void fill_frame(uint8_t* buf, uint32_t size, uint8_t seed) {
+  for (uint32_t i = 0; i < size; i++) {
+    buf[i] = (uint8_t) (seed + i + (i >> 8));
+  }
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tud_inited()) {
+    tusb_rhport_init_t dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(0, &dev_init);
+  }
+
+  TEST_ASSERT_TRUE(dcd_sim_connected(rhport));
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+  enumerate();
+
+  payload_size = probe_commit();
+  TEST_ASSERT_TRUE(tud_video_n_streaming(0, 0));
+  complete_count = 0;
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_payload_size_negotiated(void) {
+#if CFG_TUD_VIDEO_STREAMING_ZEROCOPY
+  // not limited by endpoint buffer: max frame size spread over frame interval (ms) + header
+  uint32_t const max_frame_size = FRAME_WIDTH * FRAME_HEIGHT * 16 / 8;
+  uint32_t const interval_ms    = FRAME_INTERVAL / 10000;
+  TEST_ASSERT_EQUAL((max_frame_size + interval_ms - 1) / interval_ms + 2, payload_size);
+#else
+  TEST_ASSERT_EQUAL(CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE, payload_size);
+#endif
+}
+
+void test_frame_queue(void) {
+  enum { SIZE = 3000 };
+  uint8_t fid = 0;
+  fill_frame(frame_buf[0], SIZE, 0x10);
+  fill_frame(frame_buf[1], SIZE, 0x80);
+
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf[0], SIZE));
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf[1], SIZE));
+  TEST_ASSERT_EQUAL(2, tud_video_n_frame_queue_count(0, 0));
+  TEST_ASSERT_FALSE(tud_video_n_frame_xfer(0, 0, frame_buf[0], SIZE));
+
+  // frames are sent in order with toggled frame id
+  TEST_ASSERT_EQUAL(SIZE, host_read_frame(&fid));
+  TEST_ASSERT_EQUAL_MEMORY(frame_buf[0], rx_buf, SIZE);
+  TEST_ASSERT_EQUAL(1, complete_count);
+  TEST_ASSERT_EQUAL(1, tud_video_n_frame_queue_count(0, 0));
+
+  // a slot is free again
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf[0], SIZE));
+
+  TEST_ASSERT_EQUAL(SIZE, host_read_frame(&fid));
+  TEST_ASSERT_EQUAL_MEMORY(frame_buf[1], rx_buf, SIZE);
+  TEST_ASSERT_EQUAL(SIZE, host_read_frame(&fid));
+  TEST_ASSERT_EQUAL_MEMORY(frame_buf[0], rx_buf, SIZE);
+  TEST_ASSERT_EQUAL(3, complete_count);
+  TEST_ASSERT_EQUAL(0, tud_video_n_frame_queue_count(0, 0));
+
+  TEST_ASSERT_EQUAL(-1, host_read_payload(rx_buf));
+}
+
+void test_large_frame_multi_payload(void) {
+  uint8_t fid = 0;
+  fill_frame(frame_buf[0], FRAME_SIZE, 0x33);
+  dcd_sim_edpt_stats_clear(rhport, EDPT_VIDEO_IN);
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf[0], FRAME_SIZE));
+
+  TEST_ASSERT_EQUAL(FRAME_SIZE, host_read_frame(&fid));
+  TEST_ASSERT_EQUAL_MEMORY(frame_buf[0], rx_buf, FRAME_SIZE);
+  TEST_ASSERT_EQUAL(1, complete_count);
+
+  // each payload is at most 2 transfers: header with data head, and the rest in place which usbd may split
+  // into chunks if it exceeds TUP_DCD_EDPT_XFER_MAX
+  uint32_t const payload_count = (FRAME_SIZE + payload_size - 3) / (payload_size - 2);
+  uint32_t const chunk_count   = FRAME_SIZE / (TUP_DCD_EDPT_XFER_MAX & ~0xFFFu);
+  dcd_sim_edpt_stats_t const* stats = dcd_sim_edpt_stats(rhport, EDPT_VIDEO_IN);
+  TEST_ASSERT_LESS_OR_EQUAL(2 * payload_count + chunk_count, stats->xfer_count);
+}
+
+void test_zerocopy_data_in_place(void) {
+#if !CFG_TUD_VIDEO_STREAMING_ZEROCOPY
+  TEST_IGNORE_MESSAGE("requires CFG_TUD_VIDEO_STREAMING_ZEROCOPY");
+#endif
+  enum { SIZE = 2000 };
+  uint8_t fid = 0;
+  fill_frame(frame_buf[0], SIZE, 0);
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf[0], SIZE));
+
+  // head is already copied into endpoint buffer, the rest is read from frame buffer while on the bus
+  frame_buf[0][10]   = 0xAA;
+  frame_buf[0][1500] = 0x55;
+  uint8_t const head_byte = (uint8_t) (0 + 10);
+
+  TEST_ASSERT_EQUAL(SIZE, host_read_frame(&fid));
+  TEST_ASSERT_EQUAL_HEX8(head_byte, rx_buf[10]);
+  TEST_ASSERT_EQUAL_HEX8(0x55, rx_buf[1500]);
+}
+
+void test_no_buffer_requires_copy(void) {
+#if CFG_TUD_VIDEO_STREAMING_ZEROCOPY
+  // payload may not fit into endpoint buffer
+  TEST_ASSERT_FALSE(tud_video_n_frame_xfer(0, 0, NULL, 1000));
+#else
+  TEST_IGNORE_MESSAGE("zero-copy only");
+#endif
+}
+
+// Benchmark: application keeps two 300 KiB frames queued, host polls up to 13 bulk packets per microframe
+// (high speed max) and device task runs once per microframe.
+void test_stream_throughput(void) {
+  enum {
+    BENCH_UFRAMES   = 8000, // 1 second
+    PKT_PER_UFRAME  = 13,
+  };
+  uint8_t pkt[EDPT_SIZE];
+  uint32_t queued = 0;
+  uint32_t mid_nak = 0;
+  bool in_payload  = false;
+  uint32_t pkt_in_payload = 0;
+
+  fill_frame(frame_buf[0], FRAME_SIZE, 1);
+  fill_frame(frame_buf[1], FRAME_SIZE, 2);
+  dcd_sim_edpt_stats_clear(rhport, EDPT_VIDEO_IN);
+
+  for (uint32_t uframe = 0; uframe < BENCH_UFRAMES; uframe++) {
+    dcd_sim_sof(rhport);
+    while (tud_video_n_frame_queue_count(0, 0) < 2 &&
+           tud_video_n_frame_xfer(0, 0, frame_buf[queued & 1], FRAME_SIZE)) {
+      queued++;
+    }
+
+    for (uint32_t p = 0; p < PKT_PER_UFRAME; p++) {
+      uint16_t len = EDPT_SIZE;
+      if (DCD_SIM_ACK != dcd_sim_in(rhport, EDPT_VIDEO_IN, pkt, &len)) {
+        if (in_payload) {
+          mid_nak++;
+        }
+        break;
+      }
+      pkt_in_payload += len;
+      in_payload = (len == EDPT_SIZE) && (pkt_in_payload < payload_size);
+      if (!in_payload) {
+        pkt_in_payload = 0;
+      }
+    }
+    tud_task();
+  }
+
+  dcd_sim_edpt_stats_t const* stats = dcd_sim_edpt_stats(rhport, EDPT_VIDEO_IN);
+  printf("zero-copy %d: %lu frames/s, %lu KB/s, %lu transfers/frame, %lu NAK (%lu within payload)\n",
+         CFG_TUD_VIDEO_STREAMING_ZEROCOPY, (unsigned long) complete_count, (unsigned long) (stats->byte_count / 1000),
+         (unsigned long) (stats->xfer_count / tu_max32(complete_count, 1)), (unsigned long) stats->nak_count,
+         (unsigned long) mid_nak);
+
+  TEST_ASSERT_GREATER_THAN(0, complete_count);
+#if CFG_TUD_VIDEO_STREAMING_ZEROCOPY
+  // 1080p MJPEG at 30 fps
+  TEST_ASSERT_GREATER_OR_EQUAL(FRAME_RATE, complete_count);
+  TEST_ASSERT_EQUAL(0, mid_nak);
+#endif
+
+  // drain what is left on the bus
+  while (host_read_payload(rx_buf) > 0) {}
+}
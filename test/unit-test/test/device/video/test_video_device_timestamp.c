@@ -0,0 +1,382 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <stdio.h>
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "usbd.h"
+#include "portable/sim/dcd_sim.h"
+TEST_SOURCE_FILE("video_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+uint32_t tusb_time_millis_api(void) {
+  return 0;
+}
+
+enum {
+  EDPT_VIDEO_IN = 0x81,
+  EDPT_SIZE     = 512,
+};
+
+enum {
+  ITF_NUM_VIDEO_CONTROL,
+  ITF_NUM_VIDEO_STREAMING,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  UVC_ENTITY_CAP_INPUT_TERMINAL  = 0x01,
+  UVC_ENTITY_CAP_OUTPUT_TERMINAL = 0x02,
+};
+
+#define UVC_CLOCK_FREQUENCY 27000000
+
+// 1080p MJPEG @ 30 fps
+#define FRAME_WIDTH    1920
+#define FRAME_HEIGHT   1080
+#define FRAME_RATE     30
+#define FRAME_INTERVAL (10000000 / FRAME_RATE)
+
+// compressed frame size used by tests
+#define FRAME_SIZE     3000
+
+#define TUD_VIDEO_CAPTURE_DESC_MJPEG_BULK_LEN (\
+    TUD_VIDEO_DESC_IAD_LEN\
+    /* control */\
+    + TUD_VIDEO_DESC_STD_VC_LEN\
+    + (TUD_VIDEO_DESC_CS_VC_LEN + 1/*bInCollection*/)\
+    + TUD_VIDEO_DESC_CAMERA_TERM_LEN\
+    + TUD_VIDEO_DESC_OUTPUT_TERM_LEN\
+    /* Interface 1, Alternate 0 */\
+    + TUD_VIDEO_DESC_STD_VS_LEN\
+    + (TUD_VIDEO_DESC_CS_VS_IN_LEN + 1/*bNumFormats x bControlSize*/)\
+    + TUD_VIDEO_DESC_CS_VS_FMT_MJPEG_LEN\
+    + TUD_VIDEO_DESC_CS_VS_FRM_MJPEG_CONT_LEN\
+    + TUD_VIDEO_DESC_CS_VS_COLOR_MATCHING_LEN\
+    + 7/* Endpoint */\
+  )
+
+#define TUD_VIDEO_CAPTURE_DESCRIPTOR_MJPEG_BULK(_stridx, _epin, _width, _height, _fps, _epsize) \
+  TUD_VIDEO_DESC_IAD(ITF_NUM_VIDEO_CONTROL, /* 2 Interfaces */ 0x02, _stridx), \
+  /* Video control 0 */ \
+  TUD_VIDEO_DESC_STD_VC(ITF_NUM_VIDEO_CONTROL, 0, _stridx),                                     \
+    /* Header: UVC 1.5, length of followed descs, clock (deprecated), streaming interfaces */ \
+    TUD_VIDEO_DESC_CS_VC(0x0150, TUD_VIDEO_DESC_CAMERA_TERM_LEN + TUD_VIDEO_DESC_OUTPUT_TERM_LEN, UVC_CLOCK_FREQUENCY, ITF_NUM_VIDEO_STREAMING), \
+      /* Camera Terminal: ID, bAssocTerminal, iTerminal, focal min, max, length, bmControl */ \
+      TUD_VIDEO_DESC_CAMERA_TERM(UVC_ENTITY_CAP_INPUT_TERMINAL, 0, 0, 0, 0, 0, 0), \
+      TUD_VIDEO_DESC_OUTPUT_TERM(UVC_ENTITY_CAP_OUTPUT_TERMINAL, VIDEO_TT_STREAMING, 0, UVC_ENTITY_CAP_INPUT_TERMINAL, 0), \
+  /* Video stream alt. 0 */ \
+  TUD_VIDEO_DESC_STD_VS(ITF_NUM_VIDEO_STREAMING, 0, 1, _stridx), \
+    /* Video stream header for without still image capture */ \
+    TUD_VIDEO_DESC_CS_VS_INPUT( /*bNumFormats*/1, \
+        /*wTotalLength - bLength */ TUD_VIDEO_DESC_CS_VS_FMT_MJPEG_LEN + TUD_VIDEO_DESC_CS_VS_FRM_MJPEG_CONT_LEN + TUD_VIDEO_DESC_CS_VS_COLOR_MATCHING_LEN,\
+        _epin, /*bmInfo*/0, /*bTerminalLink*/UVC_ENTITY_CAP_OUTPUT_TERMINAL, \
+        /*bStillCaptureMethod*/0, /*bTriggerSupport*/0, /*bTriggerUsage*/0, \
+        /*bmaControls(1)*/0), \
+      /* Video stream format */ \
+      TUD_VIDEO_DESC_CS_VS_FMT_MJPEG(/*bFormatIndex*/1, /*bNumFrameDescriptors*/1, \
+        /*bmFlags*/0, /*bDefaultFrameIndex*/1, 0, 0, 0, /*bCopyProtect*/0), \
+        /* Video stream frame format */ \
+        TUD_VIDEO_DESC_CS_VS_FRM_MJPEG_CONT(/*bFrameIndex */1, 0, _width, _height, \
+            _width * _height * 16, _width * _height * 16 * _fps, \
+            _width * _height * 16 / 8, \
+            (10000000/_fps), (10000000/_fps), (10000000/_fps)*_fps, (10000000/_fps)), \
+        TUD_VIDEO_DESC_CS_VS_COLOR_MATCHING(VIDEO_COLOR_PRIMARIES_BT709, VIDEO_COLOR_XFER_CH_BT709, VIDEO_COLOR_COEF_SMPTE170M), \
+        /* EP */ \
+        TUD_VIDEO_DESC_EP_BULK(_epin, _epsize, 1)
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_VIDEO_CAPTURE_DESC_MJPEG_BULK_LEN)
+
+static uint8_t const rhport = 0;
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = TUSB_CLASS_MISC,
+  .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+  .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x400B,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 500),
+  TUD_VIDEO_CAPTURE_DESCRIPTOR_MJPEG_BULK(0, EDPT_VIDEO_IN, FRAME_WIDTH, FRAME_HEIGHT, FRAME_RATE, EDPT_SIZE),
+};
+
+TU_VERIFY_STATIC(sizeof(desc_configuration) == CONFIG_TOTAL_LEN, "size is not correct");
+
+static xfer_result_t ctrl_result;
+static uint32_t payload_size; // negotiated dwMaxPayloadTransferSize
+static uint32_t source_clock; // returned by tud_video_source_clock_cb()
+
+static uint8_t frame_buf[FRAME_SIZE];
+
+//--------------------------------------------------------------------+
+// Application callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) index;
+  (void) langid;
+  return NULL;
+}
+
+uint32_t tud_video_source_clock_cb(uint_fast8_t ctl_idx) {
+  (void) ctl_idx;
+  return source_clock;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void control_complete_cb(uint8_t port, tusb_control_request_t const* request, xfer_result_t result,
+                                uint16_t xferred_bytes) {
+  (void) port;
+  (void) request;
+  (void) xferred_bytes;
+  ctrl_result = result;
+}
+
+static void control_xfer(tusb_control_request_t const* request, void* buffer) {
+  ctrl_result = XFER_RESULT_INVALID;
+  TEST_ASSERT_TRUE(dcd_sim_control_xfer(rhport, request, buffer, control_complete_cb));
+  for (uint32_t f = 0; f < 8; f++) {
+    dcd_sim_frame(rhport);
+    tud_task();
+  }
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, ctrl_result);
+}
+
+static void enumerate(void) {
+  static tusb_control_request_t const requests[] = {
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_ADDRESS,       .wValue = 5 },
+    { .bmRequestType = 0x00, .bRequest = TUSB_REQ_SET_CONFIGURATION, .wValue = 1 },
+  };
+
+  for (size_t i = 0; i < TU_ARRAY_SIZE(requests); i++) {
+    control_xfer(&requests[i], NULL);
+  }
+  TEST_ASSERT_TRUE(tud_mounted());
+}
+
+// probe and commit streaming parameters, return negotiated payload size
+static uint32_t probe_commit(void) {
+  video_probe_and_commit_control_t param = {
+    .bFormatIndex    = 1,
+    .bFrameIndex     = 1,
+    .dwFrameInterval = FRAME_INTERVAL,
+  };
+
+  tusb_control_request_t request = {
+    .bmRequestType = 0x21,
+    .bRequest      = VIDEO_REQUEST_SET_CUR,
+    .wValue        = VIDEO_VS_CTL_PROBE << 8,
+    .wIndex        = ITF_NUM_VIDEO_STREAMING,
+    .wLength       = sizeof(param)
+  };
+  control_xfer(&request, &param);
+
+  request.bmRequestType = 0xA1;
+  request.bRequest      = VIDEO_REQUEST_GET_CUR;
+  control_xfer(&request, &param);
+
+  request.bmRequestType = 0x21;
+  request.bRequest      = VIDEO_REQUEST_SET_CUR;
+  request.wValue        = VIDEO_VS_CTL_COMMIT << 8;
+  control_xfer(&request, &param);
+
+  return param.dwMaxPayloadTransferSize;
+}
+
+// advance bus time, high speed: 8 SOFs per 1ms frame
+static void run_ms(uint32_t ms) {
+  for (uint32_t i = 0; i < 8 * ms; i++) {
+    dcd_sim_sof(rhport);
+    tud_task();
+  }
+}
+
+// host reads one payload (up to a short packet or payload size), return its length or -1 if NAKed
+static int32_t host_read_payload(uint8_t* buf) {
+  uint32_t total = 0;
+  while (total < payload_size) {
+    uint16_t len = EDPT_SIZE;
+    if (DCD_SIM_ACK != dcd_sim_in(rhport, EDPT_VIDEO_IN, buf + total, &len)) {
+      TEST_ASSERT_EQUAL(0, total); // no NAK within a payload
+      return -1;
+    }
+    tud_task();
+    total += len;
+    if (len < EDPT_SIZE) {
+      break;
+    }
+  }
+  return (int32_t) total;
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tud_inited()) {
+    tusb_rhport_init_t dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(0, &dev_init);
+  }
+
+  TEST_ASSERT_TRUE(dcd_sim_connected(rhport));
+  TEST_ASSERT_TRUE(dcd_sim_bus_reset(rhport, TUSB_SPEED_HIGH));
+  tud_task();
+  enumerate();
+
+  source_clock = 0;
+  payload_size = probe_commit();
+  TEST_ASSERT_TRUE(tud_video_n_streaming(0, 0));
+  tud_video_n_stream_stats_clear(0, 0);
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_payload_header_pts_scr(void) {
+  uint8_t payload[CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE];
+  tusb_video_payload_header_pts_scr_t const* hdr = (tusb_video_payload_header_pts_scr_t const*) payload;
+
+  // PTS is taken when frame is queued, first payload is prepared right away
+  run_ms(1);
+  source_clock = 1000;
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf, FRAME_SIZE));
+  source_clock = 2000;
+
+  // in copy mode the next payload is prepared when the previous one is completed
+  uint32_t stc_expected = 1000;
+  uint16_t sof_prev     = 0;
+  for (uint32_t i = 0; ; i++) {
+    int32_t const len = host_read_payload(payload);
+    TEST_ASSERT_GREATER_THAN(0, len);
+    TEST_ASSERT_EQUAL(sizeof(*hdr), hdr->hdr.bHeaderLength);
+    TEST_ASSERT_EQUAL(1, hdr->hdr.PresentationTime);
+    TEST_ASSERT_EQUAL(1, hdr->hdr.SourceClockReference);
+    TEST_ASSERT_EQUAL(1000, hdr->dwPresentationTime);
+
+    // SCR is sampled when each payload is prepared
+    TEST_ASSERT_EQUAL(stc_expected, hdr->dwSourceClockTime);
+    TEST_ASSERT_EQUAL(0, hdr->wSofCounter & 0xF800u);
+    // second payload is prepared in the same frame as the first one is read
+    if (i > 1) {
+      TEST_ASSERT_EQUAL((sof_prev + 2) & 0x7FFu, hdr->wSofCounter);
+    }
+    sof_prev = hdr->wSofCounter;
+
+    if (hdr->hdr.EndOfFrame) {
+      break;
+    }
+    // host reads next payload 2 ms later, while source clock keeps running
+    stc_expected  = source_clock;
+    source_clock += 100;
+    run_ms(2);
+  }
+}
+
+void test_payload_size_includes_header(void) {
+  // header does not eat into negotiated payload: 3000 bytes need 3 payloads of 1024 with 12-byte header
+  uint8_t payload[CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE];
+  TEST_ASSERT_EQUAL(CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE, payload_size);
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf, FRAME_SIZE));
+  TEST_ASSERT_EQUAL(1024, host_read_payload(payload));
+  TEST_ASSERT_EQUAL(1024, host_read_payload(payload));
+  TEST_ASSERT_EQUAL(FRAME_SIZE - 2 * (1024 - 12) + 12, host_read_payload(payload));
+}
+
+void test_stats_latency_and_underrun(void) {
+  uint8_t payload[CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE];
+  tud_video_stream_stats_t stats;
+
+  run_ms(1);
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf, FRAME_SIZE));
+
+  // host is late by 5 ms
+  run_ms(5);
+  while (host_read_payload(payload) > 0) {}
+
+  TEST_ASSERT_TRUE(tud_video_n_stream_stats(0, 0, &stats));
+  TEST_ASSERT_EQUAL(1, stats.frame_count);
+  TEST_ASSERT_EQUAL(0, stats.drop_count);
+  TEST_ASSERT_EQUAL(5, stats.latency_ms_last);
+  TEST_ASSERT_EQUAL(5, stats.latency_ms_max);
+  TEST_ASSERT_EQUAL(5, stats.latency_ms_total);
+  // application did not queue the next frame in time
+  TEST_ASSERT_EQUAL(1, stats.underrun_count);
+
+  // second frame is read right away
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf, FRAME_SIZE));
+  run_ms(1);
+  while (host_read_payload(payload) > 0) {}
+
+  TEST_ASSERT_TRUE(tud_video_n_stream_stats(0, 0, &stats));
+  TEST_ASSERT_EQUAL(2, stats.frame_count);
+  TEST_ASSERT_EQUAL(1, stats.latency_ms_last);
+  TEST_ASSERT_EQUAL(5, stats.latency_ms_max);
+  TEST_ASSERT_EQUAL(6, stats.latency_ms_total);
+  TEST_ASSERT_EQUAL(2, stats.underrun_count);
+
+  tud_video_n_stream_stats_clear(0, 0);
+  TEST_ASSERT_TRUE(tud_video_n_stream_stats(0, 0, &stats));
+  TEST_ASSERT_EQUAL(0, stats.frame_count);
+  TEST_ASSERT_EQUAL(0, stats.latency_ms_max);
+}
+
+void test_stats_drop(void) {
+  tud_video_stream_stats_t stats;
+
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf, FRAME_SIZE));
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame_buf, FRAME_SIZE));
+  TEST_ASSERT_FALSE(tud_video_n_frame_xfer(0, 0, frame_buf, FRAME_SIZE));
+
+  TEST_ASSERT_TRUE(tud_video_n_stream_stats(0, 0, &stats));
+  TEST_ASSERT_EQUAL(1, stats.drop_count);
+
+  // host restarts streaming, queued frames are discarded
+  probe_commit();
+  TEST_ASSERT_TRUE(tud_video_n_stream_stats(0, 0, &stats));
+  TEST_ASSERT_EQUAL(3, stats.drop_count);
+  TEST_ASSERT_EQUAL(0, stats.frame_count);
+  TEST_ASSERT_EQUAL(0, tud_video_n_frame_queue_count(0, 0));
+}
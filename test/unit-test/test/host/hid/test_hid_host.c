@@ -0,0 +1,535 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "host/hcd.h"
+#include "portable/sim/dcd_sim.h"
+#include "portable/sim/hcd_sim.h"
+TEST_SOURCE_FILE("usbh.c")
+TEST_SOURCE_FILE("hub.c")
+TEST_SOURCE_FILE("hid_host.c")
+TEST_SOURCE_FILE("hid_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+TEST_SOURCE_FILE("hcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+enum {
+  DEV_RHPORT  = 0,
+  HOST_RHPORT = 1,
+};
+
+enum {
+  EDPT_HID_IN = 0x81,
+  EDPT_SIZE   = 16,
+};
+
+enum {
+  ITF_NUM_HID,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  REPORT_ID_KEYBOARD = 1,
+  REPORT_ID_MOUSE,
+};
+
+enum {
+  TIMEOUT_FRAMES = 2000,
+};
+
+// keyboard: modifier, LED, keycode array. mouse: buttons, X, Y, wheel, pan
+enum {
+  DESC_REPORT_FIELD_COUNT = 8,
+};
+
+TU_VERIFY_STATIC(CFG_TUH_HID_FIELD_MAX >= DESC_REPORT_FIELD_COUNT, "field table too small");
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN)
+
+// simulated time
+uint32_t tusb_time_millis_api(void) {
+  return hcd_frame_number(HOST_RHPORT);
+}
+
+static uint8_t const desc_hid_report[] = {
+  TUD_HID_REPORT_DESC_KEYBOARD(HID_REPORT_ID(REPORT_ID_KEYBOARD)),
+  TUD_HID_REPORT_DESC_MOUSE(HID_REPORT_ID(REPORT_ID_MOUSE))
+};
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = 0x00,
+  .bDeviceSubClass    = 0x00,
+  .bDeviceProtocol    = 0x00,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x400A,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report), EDPT_HID_IN, EDPT_SIZE, 1),
+};
+
+TU_VERIFY_STATIC(sizeof(desc_configuration) == CONFIG_TOTAL_LEN, "size is not correct");
+
+static uint8_t hid_daddr;
+static uint8_t hid_idx;
+static bool hid_mounted;
+
+static uint8_t report_buf[EDPT_SIZE];
+static uint16_t report_len;
+
+//--------------------------------------------------------------------+
+// Device callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) index;
+  (void) langid;
+  return NULL;
+}
+
+uint8_t const* tud_hid_descriptor_report_cb(uint8_t instance) {
+  (void) instance;
+  return desc_hid_report;
+}
+
+uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t* buffer,
+                               uint16_t reqlen) {
+  (void) instance;
+  (void) report_id;
+  (void) report_type;
+  (void) buffer;
+  (void) reqlen;
+  return 0;
+}
+
+void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t const* buffer,
+                           uint16_t bufsize) {
+  (void) instance;
+  (void) report_id;
+  (void) report_type;
+  (void) buffer;
+  (void) bufsize;
+}
+
+//--------------------------------------------------------------------+
+// Host callbacks
+//--------------------------------------------------------------------+
+
+void tuh_hid_mount_cb(uint8_t daddr, uint8_t idx, uint8_t const* report_desc, uint16_t desc_len) {
+  TEST_ASSERT_NOT_NULL(report_desc);
+  TEST_ASSERT_EQUAL(sizeof(desc_hid_report), desc_len);
+  hid_daddr   = daddr;
+  hid_idx     = idx;
+  hid_mounted = true;
+  TEST_ASSERT_TRUE(tuh_hid_receive_report(daddr, idx));
+}
+
+void tuh_hid_umount_cb(uint8_t daddr, uint8_t idx) {
+  TEST_ASSERT_EQUAL(hid_daddr, daddr);
+  TEST_ASSERT_EQUAL(hid_idx, idx);
+  hid_mounted = false;
+}
+
+void tuh_hid_report_received_cb(uint8_t daddr, uint8_t idx, uint8_t const* report, uint16_t len) {
+  TEST_ASSERT_TRUE(len <= sizeof(report_buf));
+  memcpy(report_buf, report, len);
+  report_len = len;
+  TEST_ASSERT_TRUE(tuh_hid_receive_report(daddr, idx));
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void run_frames(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    hcd_sim_frame(HOST_RHPORT);
+    tud_task();
+    tuh_task();
+  }
+}
+
+// wait for report sent by device to be received by host
+static void wait_report(void) {
+  report_len = 0;
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && report_len == 0; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_NOT_EQUAL(0, report_len);
+}
+
+// write value to report at bit offset, little endian
+static void put_bits(uint8_t* report, uint32_t bit_offset, uint8_t bit_size, uint32_t value) {
+  for (uint8_t i = 0; i < bit_size; i++) {
+    uint32_t const bit = bit_offset + i;
+    if (value & (1ul << i)) {
+      report[bit / 8] |= (uint8_t) (1u << (bit % 8));
+    }
+  }
+}
+
+static void check_field(tuh_hid_field_t const* f, uint8_t report_id, uint8_t report_type, uint16_t bit_offset,
+                        uint8_t bit_size, uint16_t count, uint16_t usage_page, uint16_t usage_min, uint16_t usage_max) {
+  TEST_ASSERT_EQUAL(report_id, f->report_id);
+  TEST_ASSERT_EQUAL(report_type, f->report_type);
+  TEST_ASSERT_EQUAL(bit_offset, f->bit_offset);
+  TEST_ASSERT_EQUAL(bit_size, f->bit_size);
+  TEST_ASSERT_EQUAL(count, f->count);
+  TEST_ASSERT_EQUAL_HEX16(usage_page, f->usage_page);
+  TEST_ASSERT_EQUAL_HEX16(usage_min, f->usage_min);
+  TEST_ASSERT_EQUAL_HEX16(usage_max, f->usage_max);
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+static uint8_t root_node;
+
+void setUp(void) {
+  if (!tusb_inited()) {
+    tusb_rhport_init_t const dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(DEV_RHPORT, &dev_init);
+
+    tusb_rhport_init_t const host_init = {
+      .role  = TUSB_ROLE_HOST,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(HOST_RHPORT, &host_init);
+  }
+
+  hid_mounted = false;
+  report_len  = 0;
+
+  root_node = hcd_sim_attach_dcd(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_FULL, DEV_RHPORT);
+  TEST_ASSERT_NOT_EQUAL(0, root_node);
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && !hid_mounted; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_TRUE(hid_mounted);
+}
+
+void tearDown(void) {
+  hcd_sim_detach(HOST_RHPORT, root_node);
+  run_frames(10);
+  TEST_ASSERT_FALSE(hid_mounted);
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_parse_keyboard_mouse(void) {
+  tuh_hid_field_t fields[16];
+  uint16_t const count = tuh_hid_parse_report_fields(fields, TU_ARRAY_SIZE(fields), desc_hid_report,
+                                                     sizeof(desc_hid_report));
+  TEST_ASSERT_EQUAL(DESC_REPORT_FIELD_COUNT, count);
+
+  // keyboard: reserved byte and LED padding are skipped, keycodes are an array of usage indexes
+  check_field(&fields[0], REPORT_ID_KEYBOARD, HID_REPORT_TYPE_INPUT, 0, 1, 8, HID_USAGE_PAGE_KEYBOARD, 0xE0, 0xE7);
+  check_field(&fields[1], REPORT_ID_KEYBOARD, HID_REPORT_TYPE_OUTPUT, 0, 1, 5, HID_USAGE_PAGE_LED, 1, 5);
+  check_field(&fields[2], REPORT_ID_KEYBOARD, HID_REPORT_TYPE_INPUT, 16, 8, 6, HID_USAGE_PAGE_KEYBOARD, 0, 255);
+  TEST_ASSERT_TRUE(fields[0].flags & HID_VARIABLE);
+  TEST_ASSERT_FALSE(fields[2].flags & HID_VARIABLE);
+  TEST_ASSERT_EQUAL(255, fields[2].logical_max);
+
+  // mouse: each explicit usage is a field, bit offset restarts for each report ID
+  check_field(&fields[3], REPORT_ID_MOUSE, HID_REPORT_TYPE_INPUT, 0, 1, 5, HID_USAGE_PAGE_BUTTON, 1, 5);
+  check_field(&fields[4], REPORT_ID_MOUSE, HID_REPORT_TYPE_INPUT, 8, 8, 1, HID_USAGE_PAGE_DESKTOP, HID_USAGE_DESKTOP_X,
+              HID_USAGE_DESKTOP_X);
+  check_field(&fields[5], REPORT_ID_MOUSE, HID_REPORT_TYPE_INPUT, 16, 8, 1, HID_USAGE_PAGE_DESKTOP, HID_USAGE_DESKTOP_Y,
+              HID_USAGE_DESKTOP_Y);
+  check_field(&fields[6], REPORT_ID_MOUSE, HID_REPORT_TYPE_INPUT, 24, 8, 1, HID_USAGE_PAGE_DESKTOP,
+              HID_USAGE_DESKTOP_WHEEL, HID_USAGE_DESKTOP_WHEEL);
+  check_field(&fields[7], REPORT_ID_MOUSE, HID_REPORT_TYPE_INPUT, 32, 8, 1, HID_USAGE_PAGE_CONSUMER,
+              HID_USAGE_CONSUMER_AC_PAN, HID_USAGE_CONSUMER_AC_PAN);
+  TEST_ASSERT_EQUAL(-127, fields[4].logical_min);
+  TEST_ASSERT_EQUAL(127, fields[4].logical_max);
+  TEST_ASSERT_TRUE(fields[4].flags & HID_RELATIVE);
+
+  TEST_ASSERT_EQUAL_PTR(&fields[5], tuh_hid_field_find(fields, count, HID_REPORT_TYPE_INPUT, HID_USAGE_PAGE_DESKTOP,
+                                                       HID_USAGE_DESKTOP_Y));
+  TEST_ASSERT_EQUAL_PTR(&fields[1], tuh_hid_field_find(fields, count, HID_REPORT_TYPE_OUTPUT, HID_USAGE_PAGE_LED, 2));
+  TEST_ASSERT_NULL(tuh_hid_field_find(fields, count, HID_REPORT_TYPE_INPUT, HID_USAGE_PAGE_LED, 2));
+
+  // stop when field array is full
+  TEST_ASSERT_EQUAL(4, tuh_hid_parse_report_fields(fields, 4, desc_hid_report, sizeof(desc_hid_report)));
+
+  // truncated item is not parsed
+  TEST_ASSERT_EQUAL(0, tuh_hid_parse_report_fields(fields, TU_ARRAY_SIZE(fields), desc_hid_report, 23));
+  TEST_ASSERT_EQUAL(1, tuh_hid_parse_report_fields(fields, TU_ARRAY_SIZE(fields), desc_hid_report, 24));
+}
+
+void test_parse_unaligned_push_pop(void) {
+  static uint8_t const desc[] = {
+    HID_USAGE_PAGE    ( HID_USAGE_PAGE_DESKTOP                 ),
+    HID_USAGE         ( HID_USAGE_DESKTOP_JOYSTICK             ),
+    HID_COLLECTION    ( HID_COLLECTION_APPLICATION             ),
+      // X, Y: 12-bit signed
+      HID_USAGE       ( HID_USAGE_DESKTOP_X                    ),
+      HID_USAGE       ( HID_USAGE_DESKTOP_Y                    ),
+      HID_LOGICAL_MIN_N ( 0xF800, 2                            ),
+      HID_LOGICAL_MAX_N ( 0x07FF, 2                            ),
+      HID_REPORT_SIZE ( 12                                     ),
+      HID_REPORT_COUNT( 2                                      ),
+      HID_INPUT       ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),
+      // 3 buttons, global items are restored by Pop
+      HID_PUSH,
+      HID_USAGE_PAGE  ( HID_USAGE_PAGE_BUTTON                  ),
+      HID_USAGE_MIN   ( 1                                      ),
+      HID_USAGE_MAX   ( 3                                      ),
+      HID_LOGICAL_MIN ( 0                                      ),
+      HID_LOGICAL_MAX ( 1                                      ),
+      HID_REPORT_SIZE ( 1                                      ),
+      HID_REPORT_COUNT( 3                                      ),
+      HID_INPUT       ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),
+      HID_POP,
+      // 4 bit padding, 32-bit element starts at bit 31
+      HID_REPORT_SIZE ( 4                                      ),
+      HID_REPORT_COUNT( 1                                      ),
+      HID_INPUT       ( HID_CONSTANT                           ),
+      HID_USAGE_N     ( (HID_USAGE_PAGE_CONSUMER << 16) | HID_USAGE_CONSUMER_VOLUME_INCREMENT, 3 ),
+      HID_REPORT_SIZE ( 32                                     ),
+      HID_INPUT       ( HID_DATA | HID_VARIABLE | HID_RELATIVE ),
+      // last usage applies to remaining elements
+      HID_USAGE_PAGE_N( HID_USAGE_PAGE_VENDOR, 2               ),
+      HID_USAGE       ( 0x01                                   ),
+      HID_LOGICAL_MIN ( 0                                      ),
+      HID_LOGICAL_MAX_N ( 0xFF, 2                              ),
+      HID_REPORT_SIZE ( 8                                      ),
+      HID_REPORT_COUNT( 3                                      ),
+      HID_INPUT       ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),
+    HID_COLLECTION_END
+  };
+
+  tuh_hid_field_t fields[8];
+  uint16_t const count = tuh_hid_parse_report_fields(fields, TU_ARRAY_SIZE(fields), desc, sizeof(desc));
+  TEST_ASSERT_EQUAL(5, count);
+
+  check_field(&fields[0], 0, HID_REPORT_TYPE_INPUT, 0, 12, 1, HID_USAGE_PAGE_DESKTOP, HID_USAGE_DESKTOP_X,
+              HID_USAGE_DESKTOP_X);
+  check_field(&fields[1], 0, HID_REPORT_TYPE_INPUT, 12, 12, 1, HID_USAGE_PAGE_DESKTOP, HID_USAGE_DESKTOP_Y,
+              HID_USAGE_DESKTOP_Y);
+  check_field(&fields[2], 0, HID_REPORT_TYPE_INPUT, 24, 1, 3, HID_USAGE_PAGE_BUTTON, 1, 3);
+  check_field(&fields[3], 0, HID_REPORT_TYPE_INPUT, 31, 32, 1, HID_USAGE_PAGE_CONSUMER,
+              HID_USAGE_CONSUMER_VOLUME_INCREMENT, HID_USAGE_CONSUMER_VOLUME_INCREMENT);
+  check_field(&fields[4], 0, HID_REPORT_TYPE_INPUT, 63, 8, 3, HID_USAGE_PAGE_VENDOR, 0x01, 0x01);
+  TEST_ASSERT_EQUAL(-2048, fields[0].logical_min);
+  TEST_ASSERT_EQUAL(2047, fields[0].logical_max);
+  TEST_ASSERT_EQUAL(0, fields[2].logical_min);
+  TEST_ASSERT_EQUAL(-2048, fields[3].logical_min); // restored by Pop
+  TEST_ASSERT_EQUAL(255, fields[4].logical_max);
+
+  // 87 bits
+  uint8_t report[11] = {0};
+  put_bits(report, 0, 12, (uint32_t) -1000);
+  put_bits(report, 12, 12, 2047);
+  put_bits(report, 24, 3, 0x05);
+  put_bits(report, 31, 32, (uint32_t) -123456789);
+  put_bits(report, 63, 8, 0x11);
+  put_bits(report, 71, 8, 0x22);
+  put_bits(report, 79, 8, 0xF3);
+
+  int32_t value;
+  TEST_ASSERT_TRUE(tuh_hid_field_get_value(&fields[0], 0, report, sizeof(report), &value));
+  TEST_ASSERT_EQUAL(-1000, value);
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(&fields[1], HID_USAGE_DESKTOP_Y, report, sizeof(report), &value));
+  TEST_ASSERT_EQUAL(2047, value);
+
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(&fields[2], 1, report, sizeof(report), &value));
+  TEST_ASSERT_EQUAL(1, value);
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(&fields[2], 2, report, sizeof(report), &value));
+  TEST_ASSERT_EQUAL(0, value);
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(&fields[2], 3, report, sizeof(report), &value));
+  TEST_ASSERT_EQUAL(1, value);
+  TEST_ASSERT_FALSE(tuh_hid_field_get_usage_value(&fields[2], 4, report, sizeof(report), &value));
+
+  TEST_ASSERT_TRUE(tuh_hid_field_get_value(&fields[3], 0, report, sizeof(report), &value));
+  TEST_ASSERT_EQUAL(-123456789, value);
+
+  TEST_ASSERT_TRUE(tuh_hid_field_get_value(&fields[4], 2, report, sizeof(report), &value));
+  TEST_ASSERT_EQUAL(0xF3, value);
+  TEST_ASSERT_FALSE(tuh_hid_field_get_value(&fields[4], 3, report, sizeof(report), &value));
+
+  // report is too short for last element
+  TEST_ASSERT_FALSE(tuh_hid_field_get_value(&fields[4], 2, report, sizeof(report) - 1, &value));
+}
+
+void test_parse_array_usage_list(void) {
+  static uint8_t const desc[] = {
+    HID_USAGE_PAGE  ( HID_USAGE_PAGE_CONSUMER                ),
+    HID_USAGE       ( HID_USAGE_CONSUMER_CONTROL             ),
+    HID_COLLECTION  ( HID_COLLECTION_APPLICATION             ),
+      // discrete usage list: index 2 is Mute, not Volume Decrement + 1
+      HID_USAGE     ( HID_USAGE_CONSUMER_VOLUME_INCREMENT    ),
+      HID_USAGE     ( HID_USAGE_CONSUMER_VOLUME_DECREMENT    ),
+      HID_USAGE     ( HID_USAGE_CONSUMER_MUTE                ),
+      HID_LOGICAL_MIN ( 0                                    ),
+      HID_LOGICAL_MAX ( 2                                    ),
+      HID_REPORT_SIZE ( 8                                    ),
+      HID_REPORT_COUNT( 1                                    ),
+      HID_INPUT     ( HID_DATA | HID_ARRAY | HID_ABSOLUTE    ),
+      // contiguous usage list is same as a usage range
+      HID_USAGE     ( HID_USAGE_CONSUMER_VOLUME_INCREMENT    ),
+      HID_USAGE     ( HID_USAGE_CONSUMER_VOLUME_DECREMENT    ),
+      HID_LOGICAL_MAX ( 1                                    ),
+      HID_INPUT     ( HID_DATA | HID_ARRAY | HID_ABSOLUTE    ),
+    HID_COLLECTION_END
+  };
+
+  tuh_hid_field_t fields[4];
+  uint16_t const count = tuh_hid_parse_report_fields(fields, TU_ARRAY_SIZE(fields), desc, sizeof(desc));
+  TEST_ASSERT_EQUAL(2, count);
+  TEST_ASSERT_TRUE(fields[0].usage_discrete);
+  TEST_ASSERT_FALSE(fields[1].usage_discrete);
+  check_field(&fields[1], 0, HID_REPORT_TYPE_INPUT, 8, 8, 1, HID_USAGE_PAGE_CONSUMER,
+              HID_USAGE_CONSUMER_VOLUME_INCREMENT, HID_USAGE_CONSUMER_VOLUME_DECREMENT);
+
+  // discrete list cannot be looked up by usage
+  TEST_ASSERT_NULL(tuh_hid_field_find(fields, count, HID_REPORT_TYPE_INPUT, HID_USAGE_PAGE_CONSUMER,
+                                      HID_USAGE_CONSUMER_MUTE));
+  TEST_ASSERT_EQUAL_PTR(&fields[1], tuh_hid_field_find(fields, count, HID_REPORT_TYPE_INPUT, HID_USAGE_PAGE_CONSUMER,
+                                                       HID_USAGE_CONSUMER_VOLUME_DECREMENT));
+
+  uint8_t const report[] = {2, 1};
+  int32_t value;
+  TEST_ASSERT_FALSE(tuh_hid_field_get_usage_value(&fields[0], HID_USAGE_CONSUMER_VOLUME_DECREMENT + 1, report,
+                                                  sizeof(report), &value));
+  TEST_ASSERT_TRUE(tuh_hid_field_get_value(&fields[0], 0, report, sizeof(report), &value));
+  TEST_ASSERT_EQUAL(2, value);
+
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(&fields[1], HID_USAGE_CONSUMER_VOLUME_DECREMENT, report,
+                                                 sizeof(report), &value));
+  TEST_ASSERT_EQUAL(1, value);
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(&fields[1], HID_USAGE_CONSUMER_VOLUME_INCREMENT, report,
+                                                 sizeof(report), &value));
+  TEST_ASSERT_EQUAL(0, value);
+}
+
+void test_parse_long_item(void) {
+  static uint8_t const desc_head[] = {
+    HID_USAGE_PAGE  ( HID_USAGE_PAGE_BUTTON                  ),
+    HID_USAGE_MIN   ( 1                                      ),
+    HID_USAGE_MAX   ( 8                                      ),
+    HID_LOGICAL_MIN ( 0                                      ),
+    HID_LOGICAL_MAX ( 1                                      ),
+    HID_REPORT_SIZE ( 1                                      ),
+    HID_REPORT_COUNT( 8                                      ),
+  };
+  static uint8_t const desc_tail[] = {
+    HID_INPUT       ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),
+  };
+
+  // long item with 254 data bytes: header, bDataSize, bLongItemTag + data is 257 bytes. Its data looks like Input
+  // items, which must be skipped rather than parsed
+  uint8_t desc[sizeof(desc_head) + 3 + 254 + sizeof(desc_tail)];
+  uint16_t len = 0;
+  memcpy(desc, desc_head, sizeof(desc_head));
+  len += sizeof(desc_head);
+  desc[len++] = 0xFE;
+  desc[len++] = 254;
+  desc[len++] = 0xF0;
+  for (uint16_t i = 0; i < 254; i += 2) {
+    memcpy(desc + len, desc_tail, 2);
+    len += 2;
+  }
+  memcpy(desc + len, desc_tail, sizeof(desc_tail));
+  len += sizeof(desc_tail);
+  TEST_ASSERT_EQUAL(sizeof(desc), len);
+
+  tuh_hid_field_t fields[8];
+  TEST_ASSERT_EQUAL(1, tuh_hid_parse_report_fields(fields, TU_ARRAY_SIZE(fields), desc, len));
+  check_field(&fields[0], 0, HID_REPORT_TYPE_INPUT, 0, 1, 8, HID_USAGE_PAGE_BUTTON, 1, 8);
+
+  // bDataSize 255 runs past the end of descriptor
+  desc[sizeof(desc_head) + 1] = 255;
+  TEST_ASSERT_EQUAL(0, tuh_hid_parse_report_fields(fields, TU_ARRAY_SIZE(fields), desc, len));
+}
+
+void test_mount_field_table(void) {
+  uint16_t count;
+  tuh_hid_field_t const* fields = tuh_hid_itf_get_fields(hid_daddr, hid_idx, &count);
+  TEST_ASSERT_NOT_NULL(fields);
+  TEST_ASSERT_EQUAL(DESC_REPORT_FIELD_COUNT, count);
+
+  tuh_hid_field_t const* f_modifier = tuh_hid_field_find(fields, count, HID_REPORT_TYPE_INPUT,
+                                                         HID_USAGE_PAGE_KEYBOARD, 0xE1);
+  tuh_hid_field_t const* f_keycode = tuh_hid_field_find(fields, count, HID_REPORT_TYPE_INPUT,
+                                                        HID_USAGE_PAGE_KEYBOARD, HID_KEY_A);
+  tuh_hid_field_t const* f_x = tuh_hid_field_find(fields, count, HID_REPORT_TYPE_INPUT, HID_USAGE_PAGE_DESKTOP,
+                                                  HID_USAGE_DESKTOP_X);
+  tuh_hid_field_t const* f_pan = tuh_hid_field_find(fields, count, HID_REPORT_TYPE_INPUT, HID_USAGE_PAGE_CONSUMER,
+                                                    HID_USAGE_CONSUMER_AC_PAN);
+  TEST_ASSERT_NOT_NULL(f_modifier);
+  TEST_ASSERT_NOT_NULL(f_keycode);
+  TEST_ASSERT_NOT_NULL(f_x);
+  TEST_ASSERT_NOT_NULL(f_pan);
+
+  int32_t value;
+
+  // keyboard report
+  uint8_t const keycode[6] = {HID_KEY_B, HID_KEY_A};
+  TEST_ASSERT_TRUE(tud_hid_keyboard_report(REPORT_ID_KEYBOARD, KEYBOARD_MODIFIER_LEFTSHIFT, keycode));
+  wait_report();
+  TEST_ASSERT_EQUAL(1 + sizeof(hid_keyboard_report_t), report_len);
+
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(f_modifier, 0xE1, report_buf, report_len, &value));
+  TEST_ASSERT_EQUAL(1, value);
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(f_modifier, 0xE0, report_buf, report_len, &value));
+  TEST_ASSERT_EQUAL(0, value);
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(f_keycode, HID_KEY_A, report_buf, report_len, &value));
+  TEST_ASSERT_EQUAL(1, value);
+  TEST_ASSERT_TRUE(tuh_hid_field_get_usage_value(f_keycode, HID_KEY_C, report_buf, report_len, &value));
+  TEST_ASSERT_EQUAL(0, value);
+  TEST_ASSERT_TRUE(tuh_hid_field_get_value(f_keycode, 0, report_buf, report_len, &value));
+  TEST_ASSERT_EQUAL(HID_KEY_B, value);
+
+  // mouse field does not match keyboard report ID
+  TEST_ASSERT_FALSE(tuh_hid_field_get_value(f_x, 0, report_buf, report_len, &value));
+
+  // mouse report
+  run_frames(2);
+  TEST_ASSERT_TRUE(tud_hid_mouse_report(REPORT_ID_MOUSE, MOUSE_BUTTON_RIGHT, -5, 10, 0, -127));
+  wait_report();
+  TEST_ASSERT_EQUAL(1 + sizeof(hid_mouse_report_t), report_len);
+
+  TEST_ASSERT_TRUE(tuh_hid_field_get_value(f_x, 0, report_buf, report_len, &value));
+  TEST_ASSERT_EQUAL(-5, value);
+  TEST_ASSERT_TRUE(tuh_hid_field_get_value(f_pan, 0, report_buf, report_len, &value));
+  TEST_ASSERT_EQUAL(-127, value);
+  TEST_ASSERT_FALSE(tuh_hid_field_get_value(f_keycode, 0, report_buf, report_len, &value));
+}
@@ -0,0 +1,419 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "host/hcd.h"
+#include "portable/sim/dcd_sim.h"
+#include "portable/sim/hcd_sim.h"
+TEST_SOURCE_FILE("usbh.c")
+TEST_SOURCE_FILE("hub.c")
+TEST_SOURCE_FILE("msc_host.c")
+TEST_SOURCE_FILE("msc_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+TEST_SOURCE_FILE("hcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+enum {
+  DEV_RHPORT  = 0,
+  HOST_RHPORT = 1,
+};
+
+enum {
+  EDPT_MSC_OUT = 0x01,
+  EDPT_MSC_IN  = 0x81,
+};
+
+enum {
+  ITF_NUM_MSC,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  LUN_COUNT       = 2,
+  DISK_BLOCK_NUM  = 16,
+  DISK_BLOCK_SIZE = 512
+};
+
+enum {
+  TIMEOUT_FRAMES = 2000,
+};
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_MSC_DESC_LEN)
+
+// simulated time
+uint32_t tusb_time_millis_api(void) {
+  return hcd_frame_number(HOST_RHPORT);
+}
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = 0x00,
+  .bDeviceSubClass    = 0x00,
+  .bDeviceProtocol    = 0x00,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4003,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, 0, EDPT_MSC_OUT, EDPT_MSC_IN, 512),
+};
+
+static uint8_t msc_disk[LUN_COUNT][DISK_BLOCK_NUM][DISK_BLOCK_SIZE];
+static uint8_t dev_rw_count; // READ/WRITE commands seen by device
+
+static uint8_t msc_daddr;
+static uint8_t root_node;
+
+// host side command completion
+static uint8_t done_count;
+static uintptr_t done_order[8];
+static uint8_t done_status[8];
+
+//--------------------------------------------------------------------+
+// Device callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) langid;
+  static uint16_t const desc_langid[] = { (TUSB_DESC_STRING << 8) | 4, 0x0409 };
+  return (index == 0) ? desc_langid : NULL;
+}
+
+uint8_t tud_msc_get_maxlun_cb(void) {
+  return LUN_COUNT;
+}
+
+uint32_t tud_msc_inquiry2_cb(uint8_t lun, scsi_inquiry_resp_t* inquiry_resp, uint32_t bufsize) {
+  (void) lun;
+  (void) inquiry_resp;
+  (void) bufsize;
+  return sizeof(scsi_inquiry_resp_t);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+  (void) lun;
+  return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
+  (void) lun;
+  *block_count = DISK_BLOCK_NUM;
+  *block_size  = DISK_BLOCK_SIZE;
+}
+
+void tud_msc_read10_complete_cb(uint8_t lun) {
+  (void) lun;
+  dev_rw_count++;
+}
+
+void tud_msc_write10_complete_cb(uint8_t lun) {
+  (void) lun;
+  dev_rw_count++;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  memcpy(buffer, msc_disk[lun][lba] + offset, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  memcpy(msc_disk[lun][lba] + offset, buffer, bufsize);
+  return (int32_t) bufsize;
+}
+
+// single block READ(16)/WRITE(16) and READ CAPACITY(16) reporting more than 32-bit LBA
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, uint16_t bufsize) {
+  switch (scsi_cmd[0]) {
+    case SCSI_CMD_READ_16:
+    case SCSI_CMD_WRITE_16: {
+      scsi_read16_t cmd;
+      memcpy(&cmd, scsi_cmd, sizeof(cmd));
+      const uint64_t lba = tu_ntohll(cmd.lba);
+      TEST_ASSERT_EQUAL(1, tu_ntohl(cmd.block_count));
+      TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, bufsize);
+      if (scsi_cmd[0] == SCSI_CMD_READ_16) {
+        memcpy(buffer, msc_disk[lun][lba % DISK_BLOCK_NUM], DISK_BLOCK_SIZE);
+      } else {
+        memcpy(msc_disk[lun][lba % DISK_BLOCK_NUM], buffer, DISK_BLOCK_SIZE);
+      }
+      return DISK_BLOCK_SIZE;
+    }
+
+    case SCSI_CMD_SERVICE_ACTION_IN_16: {
+      TEST_ASSERT_EQUAL(SCSI_SERVICE_ACTION_READ_CAPACITY_16, scsi_cmd[1]);
+      scsi_read_capacity16_resp_t resp = {
+        .last_lba   = tu_htonll(0x123456789ull),
+        .block_size = tu_htonl(4096)
+      };
+      memcpy(buffer, &resp, sizeof(resp));
+      return sizeof(resp);
+    }
+
+    default:
+      return -1;
+  }
+}
+
+//--------------------------------------------------------------------+
+// Host callbacks
+//--------------------------------------------------------------------+
+
+void tuh_msc_mount_cb(uint8_t daddr) {
+  msc_daddr = daddr;
+}
+
+void tuh_msc_umount_cb(uint8_t daddr) {
+  (void) daddr;
+  msc_daddr = 0;
+}
+
+static bool cmd_complete_cb(uint8_t daddr, tuh_msc_complete_data_t const* cb_data) {
+  (void) daddr;
+  TEST_ASSERT_TRUE(done_count < TU_ARRAY_SIZE(done_order));
+  done_status[done_count] = cb_data->csw->status;
+  done_order[done_count++] = cb_data->user_arg;
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void run_frames(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    hcd_sim_frame(HOST_RHPORT);
+    tud_task();
+    tuh_task();
+  }
+}
+
+static void run_until_done(uint8_t count) {
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && done_count < count; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(count, done_count);
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tusb_inited()) {
+    tusb_rhport_init_t const dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(DEV_RHPORT, &dev_init);
+
+    tusb_rhport_init_t const host_init = {
+      .role  = TUSB_ROLE_HOST,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(HOST_RHPORT, &host_init);
+  }
+
+  for (uint8_t lun = 0; lun < LUN_COUNT; lun++) {
+    for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+      memset(msc_disk[lun][i], (lun << 4) | i, DISK_BLOCK_SIZE);
+    }
+  }
+
+  done_count   = 0;
+  dev_rw_count = 0;
+  msc_daddr    = 0;
+
+  root_node = hcd_sim_attach_dcd(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_HIGH, DEV_RHPORT);
+  TEST_ASSERT_NOT_EQUAL(0, root_node);
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && msc_daddr == 0; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_NOT_EQUAL(0, msc_daddr);
+}
+
+void tearDown(void) {
+  hcd_sim_detach(HOST_RHPORT, root_node);
+  run_frames(10);
+  TEST_ASSERT_EQUAL(0, msc_daddr);
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_mount(void) {
+  TEST_ASSERT_TRUE(tuh_msc_mounted(msc_daddr));
+  TEST_ASSERT_TRUE(tuh_msc_ready(msc_daddr));
+  TEST_ASSERT_EQUAL(LUN_COUNT, tuh_msc_get_maxlun(msc_daddr));
+  for (uint8_t lun = 0; lun < LUN_COUNT; lun++) {
+    TEST_ASSERT_EQUAL(DISK_BLOCK_NUM, tuh_msc_get_block_count(msc_daddr, lun));
+    TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, tuh_msc_get_block_size(msc_daddr, lun));
+  }
+}
+
+void test_command_queue(void) {
+  static uint8_t buf[CFG_TUH_MSC_CMD_QUEUE_SIZE][DISK_BLOCK_SIZE];
+
+  // fill the queue while the first command is still in flight
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    TEST_ASSERT_TRUE(tuh_msc_ready(msc_daddr));
+    TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, buf[i], i + 1, 1, cmd_complete_cb, i));
+  }
+  TEST_ASSERT_FALSE(tuh_msc_ready(msc_daddr));
+  TEST_ASSERT_FALSE(tuh_msc_idle(msc_daddr));
+  TEST_ASSERT_FALSE(tuh_msc_read10(msc_daddr, 0, buf[0], 0, 1, cmd_complete_cb, 0xff));
+
+  // queue has space again once the first command completes, idle only after all of them
+  run_until_done(1);
+  TEST_ASSERT_TRUE(tuh_msc_ready(msc_daddr));
+  TEST_ASSERT_FALSE(tuh_msc_idle(msc_daddr));
+
+  run_until_done(CFG_TUH_MSC_CMD_QUEUE_SIZE);
+  TEST_ASSERT_TRUE(tuh_msc_ready(msc_daddr));
+  TEST_ASSERT_TRUE(tuh_msc_idle(msc_daddr));
+
+  // same LUN: submission order
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    TEST_ASSERT_EQUAL(i, done_order[i]);
+    TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[i]);
+    TEST_ASSERT_EQUAL_MEMORY(msc_disk[0][i + 1], buf[i], DISK_BLOCK_SIZE);
+  }
+}
+
+void test_unplug_fails_queued_commands(void) {
+  static uint8_t buf[CFG_TUH_MSC_CMD_QUEUE_SIZE][DISK_BLOCK_SIZE];
+
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, buf[i], i, 1, cmd_complete_cb, i));
+  }
+
+  // every command gets its complete callback, including the one in flight
+  hcd_sim_detach(HOST_RHPORT, root_node);
+  run_frames(10);
+  TEST_ASSERT_EQUAL(0, msc_daddr);
+  TEST_ASSERT_EQUAL(CFG_TUH_MSC_CMD_QUEUE_SIZE, done_count);
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PHASE_ERROR, done_status[i]);
+  }
+}
+
+void test_lun_interleave(void) {
+  static uint8_t buf[4][DISK_BLOCK_SIZE];
+  static uint8_t const lun[4] = {0, 0, 1, 1};
+
+  // lun 0 commands are queued first, but lun 1 gets its turn in between
+  for (uint8_t i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, lun[i], buf[i], i, 1, cmd_complete_cb, i));
+  }
+  run_until_done(4);
+
+  static uintptr_t const expected[4] = {0, 2, 1, 3};
+  for (uint8_t i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL(expected[i], done_order[i]);
+    TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[i]);
+    TEST_ASSERT_EQUAL_MEMORY(msc_disk[lun[i]][i], buf[i], DISK_BLOCK_SIZE);
+  }
+}
+
+void test_write_then_read(void) {
+  static uint8_t wbuf[2][DISK_BLOCK_SIZE];
+  static uint8_t rbuf[2][DISK_BLOCK_SIZE];
+  memset(wbuf[0], 0xA5, DISK_BLOCK_SIZE);
+  memset(wbuf[1], 0x5A, DISK_BLOCK_SIZE);
+
+  // queued write must land before the read of the same LUN
+  TEST_ASSERT_TRUE(tuh_msc_write10(msc_daddr, 0, wbuf[0], 3, 1, cmd_complete_cb, 0));
+  TEST_ASSERT_TRUE(tuh_msc_write10(msc_daddr, 1, wbuf[1], 3, 1, cmd_complete_cb, 1));
+  TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, rbuf[0], 3, 1, cmd_complete_cb, 2));
+  TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 1, rbuf[1], 3, 1, cmd_complete_cb, 3));
+  run_until_done(4);
+
+  TEST_ASSERT_EQUAL_MEMORY(wbuf[0], msc_disk[0][3], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf[1], msc_disk[1][3], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf[0], rbuf[0], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf[1], rbuf[1], DISK_BLOCK_SIZE);
+}
+
+void test_read_write_split(void) {
+  static uint8_t wbuf[10][DISK_BLOCK_SIZE];
+  static uint8_t rbuf[10][DISK_BLOCK_SIZE];
+  for (uint8_t i = 0; i < 10; i++) {
+    memset(wbuf[i], 0xC0 | i, DISK_BLOCK_SIZE);
+  }
+
+  // 10 blocks are split into commands of CFG_TUH_MSC_XFER_BLOCK_MAX (4 in this test), one callback each
+  TEST_ASSERT_TRUE(tuh_msc_write(msc_daddr, 1, wbuf, 3, 10, cmd_complete_cb, 0));
+  TEST_ASSERT_TRUE(tuh_msc_read(msc_daddr, 1, rbuf, 3, 10, cmd_complete_cb, 1));
+  run_until_done(2);
+  TEST_ASSERT_EQUAL(2 * TU_DIV_CEIL(10, CFG_TUH_MSC_XFER_BLOCK_MAX), dev_rw_count);
+
+  TEST_ASSERT_EQUAL(0, done_order[0]);
+  TEST_ASSERT_EQUAL(1, done_order[1]);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[0]);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[1]);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, msc_disk[1][3], sizeof(wbuf));
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, rbuf, sizeof(rbuf));
+}
+
+void test_read_write16(void) {
+  static uint8_t wbuf[DISK_BLOCK_SIZE];
+  static uint8_t rbuf[DISK_BLOCK_SIZE];
+  memset(wbuf, 0x3C, sizeof(wbuf));
+
+  const uint64_t lba = (1ull << 32) + 5;
+  TEST_ASSERT_TRUE(tuh_msc_write16(msc_daddr, 0, wbuf, lba, 1, cmd_complete_cb, 0));
+  TEST_ASSERT_TRUE(tuh_msc_read16(msc_daddr, 0, rbuf, lba, 1, cmd_complete_cb, 1));
+  run_until_done(2);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[0]);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[1]);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, msc_disk[0][lba % DISK_BLOCK_NUM], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, rbuf, DISK_BLOCK_SIZE);
+
+  // tuh_msc_read() switches to READ(16) above 32-bit LBA
+  memset(rbuf, 0, sizeof(rbuf));
+  TEST_ASSERT_TRUE(tuh_msc_read(msc_daddr, 0, rbuf, lba, 1, cmd_complete_cb, 2));
+  run_until_done(3);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[2]);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, rbuf, DISK_BLOCK_SIZE);
+}
+
+void test_read_capacity16(void) {
+  static scsi_read_capacity16_resp_t resp;
+  TEST_ASSERT_TRUE(tuh_msc_read_capacity16(msc_daddr, 0, &resp, cmd_complete_cb, 0));
+  run_until_done(1);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[0]);
+  TEST_ASSERT_EQUAL_UINT64(0x123456789ull, tu_ntohll(resp.last_lba));
+  TEST_ASSERT_EQUAL(4096, tu_ntohl(resp.block_size));
+}
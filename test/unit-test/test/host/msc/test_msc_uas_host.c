@@ -0,0 +1,534 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "host/hcd.h"
+#include "device/usbd_pvt.h"
+#include "portable/sim/dcd_sim.h"
+#include "portable/sim/hcd_sim.h"
+TEST_SOURCE_FILE("usbh.c")
+TEST_SOURCE_FILE("hub.c")
+TEST_SOURCE_FILE("msc_host.c")
+TEST_SOURCE_FILE("msc_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+TEST_SOURCE_FILE("hcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+enum {
+  DEV_RHPORT  = 0,
+  HOST_RHPORT = 1,
+};
+
+// UAS alternate setting shares data endpoints with Bulk-Only default setting
+enum {
+  EDPT_DATA_OUT = 0x01,
+  EDPT_DATA_IN  = 0x81,
+  EDPT_STATUS   = 0x82,
+  EDPT_CMD      = 0x03,
+};
+
+enum {
+  LUN_COUNT       = 2,
+  DISK_BLOCK_NUM  = 16,
+  DISK_BLOCK_SIZE = 512,
+  DEV_CMD_MAX     = 8,
+};
+
+enum {
+  TIMEOUT_FRAMES = 2000,
+};
+
+#define EP_DESC(_addr) \
+  7, TUSB_DESC_ENDPOINT, _addr, TUSB_XFER_BULK, U16_TO_U8S_LE(512), 0
+
+#define PIPE_USAGE_DESC(_id) \
+  4, MSC_UAS_DESC_PIPE_USAGE, _id, 0
+
+#define UAS_ITF_LEN      (9 + 4 * (7 + 4))
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_MSC_DESC_LEN + UAS_ITF_LEN)
+
+// simulated time
+uint32_t tusb_time_millis_api(void) {
+  return hcd_frame_number(HOST_RHPORT);
+}
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = 0x00,
+  .bDeviceSubClass    = 0x00,
+  .bDeviceProtocol    = 0x00,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4004,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, 1, 0, CONFIG_TOTAL_LEN, 0, 100),
+  // alt 0: Bulk-Only
+  TUD_MSC_DESCRIPTOR(0, 0, EDPT_DATA_OUT, EDPT_DATA_IN, 512),
+  // alt 1: UAS
+  9, TUSB_DESC_INTERFACE, 0, 1, 4, TUSB_CLASS_MSC, MSC_SUBCLASS_SCSI, MSC_PROTOCOL_UAS, 0,
+  EP_DESC(EDPT_CMD), PIPE_USAGE_DESC(MSC_UAS_PIPE_COMMAND),
+  EP_DESC(EDPT_STATUS), PIPE_USAGE_DESC(MSC_UAS_PIPE_STATUS),
+  EP_DESC(EDPT_DATA_IN), PIPE_USAGE_DESC(MSC_UAS_PIPE_DATA_IN),
+  EP_DESC(EDPT_DATA_OUT), PIPE_USAGE_DESC(MSC_UAS_PIPE_DATA_OUT),
+};
+
+TU_VERIFY_STATIC(sizeof(desc_configuration) == CONFIG_TOTAL_LEN, "size is not correct");
+
+static uint8_t msc_disk[DISK_BLOCK_NUM][DISK_BLOCK_SIZE];
+
+static uint8_t msc_daddr;
+static uint8_t root_node;
+
+// host side command completion
+static uint8_t done_count;
+static uintptr_t done_order[8];
+static uint8_t done_status[8];
+
+//--------------------------------------------------------------------+
+// Simulated UAS device: one command is processed at a time, newest received first so that commands complete out
+// of order. Processing is held off while dev_hold is set to let the host queue commands.
+//--------------------------------------------------------------------+
+
+typedef enum {
+  DEV_STATE_IDLE,
+  DEV_STATE_READY, // Read/Write Ready IU sent
+  DEV_STATE_DATA,
+  DEV_STATE_SENSE, // Sense IU sent
+} dev_state_t;
+
+static struct {
+  uint8_t alt;
+  bool hold;
+  dev_state_t state;
+
+  msc_uas_command_iu_t cmd_buf;
+  msc_uas_command_iu_t cmd[DEV_CMD_MAX];
+  uint8_t cmd_count;
+  uint8_t cmd_max_pending; // most commands queued at device at once
+
+  msc_uas_command_iu_t cur;
+  uint8_t* data;
+  uint32_t data_len;
+  bool data_in;
+  uint8_t status;
+
+  msc_uas_sense_iu_t status_iu;
+  uint8_t resp[36];
+} _dev;
+
+static bool dev_status_send(uint8_t iu_id) {
+  tu_memclr(&_dev.status_iu, sizeof(_dev.status_iu));
+  _dev.status_iu.iu_id = iu_id;
+  _dev.status_iu.tag   = _dev.cur.tag;
+  _dev.status_iu.status = _dev.status;
+  const uint16_t len = (iu_id == MSC_UAS_IU_SENSE) ? 16 : sizeof(msc_uas_ready_iu_t);
+  return usbd_edpt_xfer(DEV_RHPORT, EDPT_STATUS, (uint8_t*) &_dev.status_iu, len, false);
+}
+
+// decode command, data is transferred from/to RAM disk directly
+static void dev_decode(void) {
+  uint8_t const* cdb = _dev.cur.cdb;
+  _dev.data     = NULL;
+  _dev.data_len = 0;
+  _dev.data_in  = true;
+  _dev.status   = 0;
+
+  switch (cdb[0]) {
+    case SCSI_CMD_TEST_UNIT_READY:
+      break;
+
+    case SCSI_CMD_REPORT_LUNS: {
+      scsi_report_luns_resp_t const resp = {.list_length = tu_htonl(8 * LUN_COUNT)};
+      tu_memclr(_dev.resp, sizeof(_dev.resp));
+      memcpy(_dev.resp, &resp, sizeof(resp));
+      for (uint8_t i = 0; i < LUN_COUNT; i++) {
+        _dev.resp[sizeof(resp) + 8 * i + 1] = i;
+      }
+      _dev.data     = _dev.resp;
+      _dev.data_len = sizeof(resp) + 8 * LUN_COUNT;
+      break;
+    }
+
+    case SCSI_CMD_READ_CAPACITY_10: {
+      scsi_read_capacity10_resp_t const resp = {
+        .last_lba   = tu_htonl(DISK_BLOCK_NUM - 1),
+        .block_size = tu_htonl(DISK_BLOCK_SIZE)
+      };
+      memcpy(_dev.resp, &resp, sizeof(resp));
+      _dev.data     = _dev.resp;
+      _dev.data_len = sizeof(resp);
+      break;
+    }
+
+    case SCSI_CMD_READ_10:
+    case SCSI_CMD_WRITE_10: {
+      scsi_read10_t rw;
+      memcpy(&rw, cdb, sizeof(rw));
+      const uint32_t lba = tu_ntohl(rw.lba);
+      const uint16_t count = tu_ntohs(rw.block_count);
+      if (lba + count > DISK_BLOCK_NUM) {
+        _dev.status = 2; // check condition
+      } else {
+        _dev.data     = msc_disk[lba];
+        _dev.data_len = (uint32_t) count * DISK_BLOCK_SIZE;
+        _dev.data_in  = (cdb[0] == SCSI_CMD_READ_10);
+      }
+      break;
+    }
+
+    default:
+      _dev.status = 2;
+      break;
+  }
+}
+
+static void dev_process(void) {
+  if (_dev.hold || _dev.state != DEV_STATE_IDLE || _dev.cmd_count == 0) {
+    return;
+  }
+
+  _dev.cur = _dev.cmd[--_dev.cmd_count];
+  dev_decode();
+
+  if (_dev.data_len > 0) {
+    _dev.state = DEV_STATE_READY;
+    TEST_ASSERT_TRUE(dev_status_send(_dev.data_in ? MSC_UAS_IU_READ_READY : MSC_UAS_IU_WRITE_READY));
+  } else {
+    _dev.state = DEV_STATE_SENSE;
+    TEST_ASSERT_TRUE(dev_status_send(MSC_UAS_IU_SENSE));
+  }
+}
+
+static void uasd_init(void) {
+  tu_memclr(&_dev, sizeof(_dev));
+}
+
+static bool uasd_deinit(void) {
+  return true;
+}
+
+static void uasd_reset(uint8_t rhport) {
+  (void) rhport;
+  uasd_init();
+}
+
+// claim both alternate settings, endpoints are opened by Set Interface
+static uint16_t uasd_open(uint8_t rhport, tusb_desc_interface_t const* desc_itf, uint16_t max_len) {
+  (void) rhport;
+  TU_VERIFY(TUSB_CLASS_MSC == desc_itf->bInterfaceClass, 0);
+  TU_VERIFY(max_len >= TUD_MSC_DESC_LEN + UAS_ITF_LEN, 0);
+  return TUD_MSC_DESC_LEN + UAS_ITF_LEN;
+}
+
+static bool uasd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const* request) {
+  TU_VERIFY(request->bmRequestType_bit.type == TUSB_REQ_TYPE_STANDARD &&
+            request->bRequest == TUSB_REQ_SET_INTERFACE);
+  if (stage == CONTROL_STAGE_SETUP) {
+    TU_VERIFY(request->wValue == 1);
+    _dev.alt = 1;
+
+    uint8_t const* p_desc = desc_configuration + TUD_CONFIG_DESC_LEN + TUD_MSC_DESC_LEN + 9;
+    for (uint8_t i = 0; i < 4; i++) {
+      TEST_ASSERT_TRUE(usbd_edpt_open(rhport, (tusb_desc_endpoint_t const*) p_desc));
+      p_desc += 7 + 4;
+    }
+    TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, EDPT_CMD, (uint8_t*) &_dev.cmd_buf, sizeof(_dev.cmd_buf), false));
+    tud_control_status(rhport, request);
+  }
+  return true;
+}
+
+static bool uasd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, result);
+
+  if (ep_addr == EDPT_CMD) {
+    TEST_ASSERT_EQUAL(sizeof(msc_uas_command_iu_t), xferred_bytes);
+    TEST_ASSERT_EQUAL(MSC_UAS_IU_COMMAND, _dev.cmd_buf.iu_id);
+    TEST_ASSERT_TRUE(_dev.cmd_count < DEV_CMD_MAX);
+    _dev.cmd[_dev.cmd_count++] = _dev.cmd_buf;
+    _dev.cmd_max_pending = tu_max8(_dev.cmd_max_pending, _dev.cmd_count);
+    TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, EDPT_CMD, (uint8_t*) &_dev.cmd_buf, sizeof(_dev.cmd_buf), false));
+  } else if (ep_addr == EDPT_STATUS) {
+    if (_dev.state == DEV_STATE_READY) {
+      _dev.state = DEV_STATE_DATA;
+      TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, _dev.data_in ? EDPT_DATA_IN : EDPT_DATA_OUT, _dev.data,
+                                      (uint16_t) _dev.data_len, false));
+    } else {
+      _dev.state = DEV_STATE_IDLE;
+    }
+  } else {
+    TEST_ASSERT_EQUAL(_dev.data_len, xferred_bytes);
+    _dev.state = DEV_STATE_SENSE;
+    TEST_ASSERT_TRUE(dev_status_send(MSC_UAS_IU_SENSE));
+  }
+
+  dev_process();
+  return true;
+}
+
+static usbd_class_driver_t const _uasd_driver = {
+  .name            = "UAS",
+  .init            = uasd_init,
+  .deinit          = uasd_deinit,
+  .reset           = uasd_reset,
+  .open            = uasd_open,
+  .control_xfer_cb = uasd_control_xfer_cb,
+  .xfer_cb         = uasd_xfer_cb,
+  .xfer_isr        = NULL,
+  .sof             = NULL
+};
+
+usbd_class_driver_t const* usbd_app_driver_get_cb(uint8_t* driver_count) {
+  *driver_count = 1;
+  return &_uasd_driver;
+}
+
+//--------------------------------------------------------------------+
+// Device callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) langid;
+  static uint16_t const desc_langid[] = { (TUSB_DESC_STRING << 8) | 4, 0x0409 };
+  return (index == 0) ? desc_langid : NULL;
+}
+
+// built-in Bulk-Only driver is not used
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  (void) lun; (void) lba; (void) offset; (void) buffer; (void) bufsize;
+  return -1;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  (void) lun; (void) lba; (void) offset; (void) buffer; (void) bufsize;
+  return -1;
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+  (void) lun;
+  return false;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
+  (void) lun;
+  *block_count = 0;
+  *block_size  = 0;
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, uint16_t bufsize) {
+  (void) lun; (void) scsi_cmd; (void) buffer; (void) bufsize;
+  return -1;
+}
+
+//--------------------------------------------------------------------+
+// Host callbacks
+//--------------------------------------------------------------------+
+
+void tuh_msc_mount_cb(uint8_t daddr) {
+  msc_daddr = daddr;
+}
+
+void tuh_msc_umount_cb(uint8_t daddr) {
+  (void) daddr;
+  msc_daddr = 0;
+}
+
+static bool cmd_complete_cb(uint8_t daddr, tuh_msc_complete_data_t const* cb_data) {
+  (void) daddr;
+  TEST_ASSERT_TRUE(done_count < TU_ARRAY_SIZE(done_order));
+  done_status[done_count] = cb_data->csw->status;
+  done_order[done_count++] = cb_data->user_arg;
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void run_frames(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    hcd_sim_frame(HOST_RHPORT);
+    tud_task();
+    tuh_task();
+  }
+}
+
+static void run_until_done(uint8_t count) {
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && done_count < count; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(count, done_count);
+}
+
+static void dev_release(void) {
+  _dev.hold = false;
+  dev_process();
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tusb_inited()) {
+    tusb_rhport_init_t const dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(DEV_RHPORT, &dev_init);
+
+    tusb_rhport_init_t const host_init = {
+      .role  = TUSB_ROLE_HOST,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(HOST_RHPORT, &host_init);
+  }
+
+  for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+    memset(msc_disk[i], i, DISK_BLOCK_SIZE);
+  }
+
+  done_count = 0;
+  msc_daddr  = 0;
+
+  root_node = hcd_sim_attach_dcd(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_HIGH, DEV_RHPORT);
+  TEST_ASSERT_NOT_EQUAL(0, root_node);
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && msc_daddr == 0; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_NOT_EQUAL(0, msc_daddr);
+}
+
+void tearDown(void) {
+  hcd_sim_detach(HOST_RHPORT, root_node);
+  run_frames(10);
+  TEST_ASSERT_EQUAL(0, msc_daddr);
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_mount(void) {
+  TEST_ASSERT_EQUAL(1, _dev.alt);
+  TEST_ASSERT_TRUE(tuh_msc_mounted(msc_daddr));
+  TEST_ASSERT_TRUE(tuh_msc_ready(msc_daddr));
+  TEST_ASSERT_EQUAL(LUN_COUNT, tuh_msc_get_maxlun(msc_daddr));
+  for (uint8_t lun = 0; lun < LUN_COUNT; lun++) {
+    TEST_ASSERT_EQUAL(DISK_BLOCK_NUM, tuh_msc_get_block_count(msc_daddr, lun));
+    TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, tuh_msc_get_block_size(msc_daddr, lun));
+  }
+}
+
+void test_tagged_out_of_order(void) {
+  static uint8_t buf[CFG_TUH_MSC_CMD_QUEUE_SIZE][DISK_BLOCK_SIZE];
+
+  // all commands are sent to device before any of them completes
+  _dev.hold = true;
+  _dev.cmd_max_pending = 0;
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, buf[i], i + 1, 1, cmd_complete_cb, i));
+  }
+  TEST_ASSERT_FALSE(tuh_msc_ready(msc_daddr));
+  run_frames(20);
+  TEST_ASSERT_EQUAL(0, done_count);
+  TEST_ASSERT_EQUAL(CFG_TUH_MSC_CMD_QUEUE_SIZE, _dev.cmd_max_pending);
+
+  dev_release();
+  run_until_done(CFG_TUH_MSC_CMD_QUEUE_SIZE);
+  TEST_ASSERT_TRUE(tuh_msc_ready(msc_daddr));
+
+  // device completes newest command first
+  for (uint8_t i = 0; i < CFG_TUH_MSC_CMD_QUEUE_SIZE; i++) {
+    const uint8_t idx = (uint8_t) (CFG_TUH_MSC_CMD_QUEUE_SIZE - 1 - i);
+    TEST_ASSERT_EQUAL(idx, done_order[i]);
+    TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[i]);
+    TEST_ASSERT_EQUAL_MEMORY(msc_disk[idx + 1], buf[idx], DISK_BLOCK_SIZE);
+  }
+}
+
+void test_write_then_read(void) {
+  static uint8_t wbuf[3][DISK_BLOCK_SIZE];
+  static uint8_t rbuf[3][DISK_BLOCK_SIZE];
+  for (uint8_t i = 0; i < 3; i++) {
+    memset(wbuf[i], 0xA0 | i, DISK_BLOCK_SIZE);
+  }
+
+  TEST_ASSERT_TRUE(tuh_msc_write10(msc_daddr, 0, wbuf, 5, 3, cmd_complete_cb, 0));
+  run_until_done(1);
+  TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, rbuf, 5, 3, cmd_complete_cb, 1));
+  run_until_done(2);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[0]);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[1]);
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, msc_disk[5], sizeof(wbuf));
+  TEST_ASSERT_EQUAL_MEMORY(wbuf, rbuf, sizeof(rbuf));
+}
+
+void test_check_condition(void) {
+  static uint8_t buf[DISK_BLOCK_SIZE];
+
+  // out of range is failed with Sense IU, no data stage
+  TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, buf, DISK_BLOCK_NUM, 1, cmd_complete_cb, 0));
+  run_until_done(1);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_FAILED, done_status[0]);
+  TEST_ASSERT_TRUE(tuh_msc_ready(msc_daddr));
+}
+
+void test_status_pipe_stall(void) {
+  static uint8_t buf[2][DISK_BLOCK_SIZE];
+
+  // commands are waiting at device when status pipe fails
+  _dev.hold = true;
+  for (uint8_t i = 0; i < 2; i++) {
+    TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, buf[i], i, 1, cmd_complete_cb, i));
+  }
+  run_frames(20);
+  TEST_ASSERT_EQUAL(2, _dev.cmd_count);
+
+  usbd_edpt_stall(DEV_RHPORT, EDPT_STATUS);
+  run_until_done(2);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PHASE_ERROR, done_status[0]);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PHASE_ERROR, done_status[1]);
+  TEST_ASSERT_TRUE(tuh_msc_idle(msc_daddr));
+
+  // device recovers and drops the failed commands, next command re-arms status pipe
+  usbd_edpt_clear_stall(DEV_RHPORT, EDPT_STATUS);
+  _dev.cmd_count = 0;
+  dev_release();
+
+  TEST_ASSERT_TRUE(tuh_msc_read10(msc_daddr, 0, buf[0], 3, 1, cmd_complete_cb, 2));
+  run_until_done(3);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_status[2]);
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[3], buf[0], DISK_BLOCK_SIZE);
+}
@@ -0,0 +1,394 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "host/hcd.h"
+#include "portable/sim/dcd_sim.h"
+#include "portable/sim/hcd_sim.h"
+TEST_SOURCE_FILE("usbh.c")
+TEST_SOURCE_FILE("hub.c")
+TEST_SOURCE_FILE("ncm_host.c")
+TEST_SOURCE_FILE("ncm_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+TEST_SOURCE_FILE("hcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+enum {
+  DEV_RHPORT  = 0,
+  HOST_RHPORT = 1,
+};
+
+enum {
+  EDPT_NOTIF = 0x81,
+  EDPT_OUT   = 0x02,
+  EDPT_IN    = 0x82,
+  EDPT_SIZE  = 512,
+};
+
+enum {
+  ITF_NUM_NCM,
+  ITF_NUM_NCM_DATA,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  STRID_MAC = 4,
+};
+
+enum {
+  TIMEOUT_FRAMES = 2000,
+};
+
+// NTB header reserved by host driver for max datagrams
+enum {
+  HOST_NTB_HDR_LEN = sizeof(nth16_t) + sizeof(ndp16_t) + (CFG_TUH_NCM_OUT_MAX_DATAGRAMS_PER_NTB + 1) * sizeof(ndp16_datagram_t)
+};
+
+TU_VERIFY_STATIC(CFG_TUD_NCM_OUT_MAX_DATAGRAMS_PER_NTB < CFG_TUH_NCM_OUT_MAX_DATAGRAMS_PER_NTB, "device limits datagrams per NTB");
+TU_VERIFY_STATIC(CFG_TUD_NCM_IN_NTB_MAX_SIZE > CFG_TUH_NCM_IN_NTB_MAX_SIZE, "host limits device NTB size");
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_NCM_DESC_LEN)
+
+// simulated time
+uint32_t tusb_time_millis_api(void) {
+  return hcd_frame_number(HOST_RHPORT);
+}
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = TUSB_CLASS_MISC,
+  .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+  .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4007,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_CDC_NCM_DESCRIPTOR(ITF_NUM_NCM, 0, STRID_MAC, EDPT_NOTIF, 64, EDPT_OUT, EDPT_IN, EDPT_SIZE, CFG_TUD_NET_MTU, 1, 0),
+};
+
+TU_VERIFY_STATIC(sizeof(desc_configuration) == CONFIG_TOTAL_LEN, "size is not correct");
+
+static uint8_t const mac_address[6] = {0x02, 0x02, 0x84, 0x6A, 0x96, 0x00};
+
+static uint8_t net_idx;
+static bool net_mounted;
+static uint8_t link_up_count;
+
+// datagrams received by host
+static bool host_recv_renew;
+static uint8_t host_recv_count;
+static uint8_t host_recv_buf[8][CFG_TUD_NET_MTU];
+static uint16_t host_recv_size[8];
+
+// datagrams received by device
+static uint8_t dev_recv_count;
+static uint8_t dev_recv_buf[16][CFG_TUD_NET_MTU];
+static uint16_t dev_recv_size[16];
+
+//--------------------------------------------------------------------+
+// Device callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) langid;
+  static uint16_t desc_str[1 + 12];
+
+  if (index == 0) {
+    desc_str[0] = (TUSB_DESC_STRING << 8) | 4;
+    desc_str[1] = 0x0409;
+    return desc_str;
+  }
+
+  if (index == STRID_MAC) {
+    static char const hex[] = "0123456789ABCDEF";
+    desc_str[0] = (uint16_t) ((TUSB_DESC_STRING << 8) | (2 + 12 * 2));
+    for (uint8_t i = 0; i < 6; i++) {
+      desc_str[1 + 2 * i] = (uint16_t) hex[mac_address[i] >> 4];
+      desc_str[2 + 2 * i] = (uint16_t) hex[mac_address[i] & 0xf];
+    }
+    return desc_str;
+  }
+
+  return NULL;
+}
+
+bool tud_network_recv_cb(const uint8_t* src, uint16_t size) {
+  TEST_ASSERT_TRUE(dev_recv_count < TU_ARRAY_SIZE(dev_recv_buf));
+  memcpy(dev_recv_buf[dev_recv_count], src, size);
+  dev_recv_size[dev_recv_count] = size;
+  dev_recv_count++;
+  tud_network_recv_renew();
+  return true;
+}
+
+uint16_t tud_network_xmit_cb(uint8_t* dst, void* ref, uint16_t arg) {
+  memcpy(dst, ref, arg);
+  return arg;
+}
+
+//--------------------------------------------------------------------+
+// Host callbacks
+//--------------------------------------------------------------------+
+
+void tuh_network_mount_cb(uint8_t idx) {
+  net_idx     = idx;
+  net_mounted = true;
+}
+
+void tuh_network_umount_cb(uint8_t idx) {
+  TEST_ASSERT_EQUAL(net_idx, idx);
+  net_mounted = false;
+}
+
+void tuh_network_link_state_cb(uint8_t idx, bool is_up) {
+  TEST_ASSERT_EQUAL(net_idx, idx);
+  if (is_up) {
+    link_up_count++;
+  }
+}
+
+bool tuh_network_recv_cb(uint8_t idx, const uint8_t* src, uint16_t size) {
+  TEST_ASSERT_EQUAL(net_idx, idx);
+  TEST_ASSERT_TRUE(host_recv_count < TU_ARRAY_SIZE(host_recv_buf));
+  memcpy(host_recv_buf[host_recv_count], src, size);
+  host_recv_size[host_recv_count] = size;
+  host_recv_count++;
+  if (host_recv_renew) {
+    tuh_network_recv_renew(idx);
+  }
+  return true;
+}
+
+static uint32_t host_xmit_cb_count;
+
+uint16_t tuh_network_xmit_cb(uint8_t idx, uint8_t* dst, void* ref, uint16_t arg) {
+  (void) idx;
+  host_xmit_cb_count++;
+  memcpy(dst, ref, arg);
+  return arg;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void run_frames(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    hcd_sim_frame(HOST_RHPORT);
+    tud_task();
+    tuh_task();
+  }
+}
+
+static void fill_datagram(uint8_t* buf, uint16_t size, uint8_t seed) {
+  for (uint16_t i = 0; i < size; i++) {
+    buf[i] = (uint8_t) (seed + i);
+  }
+}
+
+static void host_xmit(uint8_t* buf, uint16_t size) {
+  TEST_ASSERT_TRUE(tuh_network_can_xmit(net_idx, size));
+  TEST_ASSERT_TRUE(tuh_network_xmit(net_idx, buf, size));
+}
+
+static void dev_xmit(uint8_t* buf, uint16_t size) {
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && !tud_network_can_xmit(size); i++) {
+    run_frames(1);
+  }
+  tud_network_xmit(buf, size);
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+static uint8_t root_node;
+
+void setUp(void) {
+  if (!tusb_inited()) {
+    tusb_rhport_init_t const dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(DEV_RHPORT, &dev_init);
+
+    tusb_rhport_init_t const host_init = {
+      .role  = TUSB_ROLE_HOST,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(HOST_RHPORT, &host_init);
+  }
+
+  net_mounted     = false;
+  link_up_count   = 0;
+  host_recv_renew = true;
+  host_recv_count = 0;
+  dev_recv_count  = 0;
+
+  root_node = hcd_sim_attach_dcd(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_HIGH, DEV_RHPORT);
+  TEST_ASSERT_NOT_EQUAL(0, root_node);
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && (!net_mounted || link_up_count == 0); i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_TRUE(net_mounted);
+}
+
+void tearDown(void) {
+  hcd_sim_detach(HOST_RHPORT, root_node);
+  run_frames(10);
+  TEST_ASSERT_FALSE(net_mounted);
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_mount(void) {
+  TEST_ASSERT_TRUE(tuh_network_mounted(net_idx));
+
+  uint8_t mac[6];
+  TEST_ASSERT_TRUE(tuh_network_get_mac_address(net_idx, mac));
+  TEST_ASSERT_EQUAL_MEMORY(mac_address, mac, 6);
+
+  // device reports link up once its data interface is activated
+  TEST_ASSERT_EQUAL(1, link_up_count);
+  TEST_ASSERT_TRUE(tuh_network_link_is_up(net_idx));
+
+  tuh_itf_info_t info;
+  TEST_ASSERT_TRUE(tuh_network_itf_get_info(net_idx, &info));
+  TEST_ASSERT_EQUAL(ITF_NUM_NCM, info.desc.bInterfaceNumber);
+  TEST_ASSERT_EQUAL(CDC_COMM_SUBCLASS_NETWORK_CONTROL_MODEL, info.desc.bInterfaceSubClass);
+  TEST_ASSERT_EQUAL(net_idx, tuh_network_itf_get_index(info.daddr, ITF_NUM_NCM_DATA));
+}
+
+void test_xmit_aggregate(void) {
+  static uint8_t dg[1 + CFG_TUD_NCM_OUT_MAX_DATAGRAMS_PER_NTB][100];
+
+  // first datagram goes out right away, following ones are aggregated into the next NTB
+  // up to the device's wNtbOutMaxDatagrams
+  host_xmit_cb_count = 0;
+  for (uint8_t i = 0; i < TU_ARRAY_SIZE(dg); i++) {
+    fill_datagram(dg[i], (uint16_t) (60 + i), i);
+    host_xmit(dg[i], (uint16_t) (60 + i));
+  }
+  TEST_ASSERT_FALSE(tuh_network_can_xmit(net_idx, 60));
+
+  // rejected before the callback writes into the full NTB
+  TEST_ASSERT_FALSE(tuh_network_xmit(net_idx, dg[0], 60));
+  TEST_ASSERT_EQUAL(TU_ARRAY_SIZE(dg), host_xmit_cb_count);
+
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && dev_recv_count < TU_ARRAY_SIZE(dg); i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(TU_ARRAY_SIZE(dg), dev_recv_count);
+  for (uint8_t i = 0; i < TU_ARRAY_SIZE(dg); i++) {
+    TEST_ASSERT_EQUAL(60 + i, dev_recv_size[i]);
+    TEST_ASSERT_EQUAL_MEMORY(dg[i], dev_recv_buf[i], 60 + i);
+  }
+  TEST_ASSERT_TRUE(tuh_network_can_xmit(net_idx, 60));
+}
+
+void test_xmit_packet_boundary(void) {
+  // NTB of exactly one packet is padded so that it ends with a short packet
+  static uint8_t dg[EDPT_SIZE - HOST_NTB_HDR_LEN];
+  fill_datagram(dg, sizeof(dg), 0x55);
+  host_xmit(dg, sizeof(dg));
+
+  static uint8_t dg2[64];
+  fill_datagram(dg2, sizeof(dg2), 0xAA);
+  host_xmit(dg2, sizeof(dg2));
+
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && dev_recv_count < 2; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(2, dev_recv_count);
+  TEST_ASSERT_EQUAL(sizeof(dg), dev_recv_size[0]);
+  TEST_ASSERT_EQUAL_MEMORY(dg, dev_recv_buf[0], sizeof(dg));
+  TEST_ASSERT_EQUAL(sizeof(dg2), dev_recv_size[1]);
+  TEST_ASSERT_EQUAL_MEMORY(dg2, dev_recv_buf[1], sizeof(dg2));
+}
+
+void test_recv(void) {
+  static uint8_t dg[5][CFG_TUD_NET_MTU];
+  static uint16_t const size[5] = {60, 700, 700, 700, CFG_TUD_NET_MTU};
+
+  // datagrams queued while the first one is on the bus are aggregated by device, up to the NTB input size
+  // set by host which is smaller than what device supports
+  for (uint8_t i = 0; i < 5; i++) {
+    fill_datagram(dg[i], size[i], (uint8_t) (0x10 * i));
+    dev_xmit(dg[i], size[i]);
+  }
+
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && host_recv_count < 5; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(5, host_recv_count);
+  for (uint8_t i = 0; i < 5; i++) {
+    TEST_ASSERT_EQUAL(size[i], host_recv_size[i]);
+    TEST_ASSERT_EQUAL_MEMORY(dg[i], host_recv_buf[i], size[i]);
+  }
+}
+
+void test_recv_in_place(void) {
+  static uint8_t dg[4][200];
+
+  // datagrams are lent to application, next one is passed only after renew
+  host_recv_renew = false;
+  for (uint8_t i = 0; i < 4; i++) {
+    fill_datagram(dg[i], sizeof(dg[i]), (uint8_t) (0x40 + i));
+    dev_xmit(dg[i], sizeof(dg[i]));
+  }
+  run_frames(50);
+  TEST_ASSERT_EQUAL(1, host_recv_count);
+
+  for (uint8_t i = 1; i < 4; i++) {
+    tuh_network_recv_renew(net_idx);
+    run_frames(20);
+    TEST_ASSERT_EQUAL(i + 1, host_recv_count);
+  }
+
+  for (uint8_t i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL(sizeof(dg[i]), host_recv_size[i]);
+    TEST_ASSERT_EQUAL_MEMORY(dg[i], host_recv_buf[i], sizeof(dg[i]));
+  }
+
+  // renewing the last one frees its NTB, reception continues
+  tuh_network_recv_renew(net_idx);
+  host_recv_renew = true;
+  dev_xmit(dg[0], sizeof(dg[0]));
+  for (uint32_t i = 0; i < TIMEOUT_FRAMES && host_recv_count < 5; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(5, host_recv_count);
+}
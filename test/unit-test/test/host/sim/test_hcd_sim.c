@@ -0,0 +1,543 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "tusb.h"
+#include "host/hcd.h"
+#include "portable/sim/dcd_sim.h"
+#include "portable/sim/hcd_sim.h"
+TEST_SOURCE_FILE("usbh.c")
+TEST_SOURCE_FILE("hub.c")
+TEST_SOURCE_FILE("msc_device.c")
+TEST_SOURCE_FILE("dcd_sim.c")
+TEST_SOURCE_FILE("hcd_sim.c")
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+enum {
+  DEV_RHPORT  = 0,
+  HOST_RHPORT = 1,
+};
+
+enum {
+  EDPT_MSC_OUT = 0x01,
+  EDPT_MSC_IN  = 0x81,
+};
+
+enum {
+  ITF_NUM_MSC,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  DISK_BLOCK_NUM  = 32,
+  DISK_BLOCK_SIZE = 512
+};
+
+enum {
+  ENUM_TIMEOUT_FRAMES = 2000,
+  ENUM_DEBOUNCE_MS    = 150
+};
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_MSC_DESC_LEN)
+
+// simulated time
+uint32_t tusb_time_millis_api(void) {
+  return hcd_frame_number(HOST_RHPORT);
+}
+
+//------------- in-process device: MSC -------------//
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = 0x00,
+  .bDeviceSubClass    = 0x00,
+  .bDeviceProtocol    = 0x00,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4003,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+  TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, 0, EDPT_MSC_OUT, EDPT_MSC_IN, 512),
+};
+
+//------------- emulated device: vendor bulk -------------//
+static tusb_desc_device_t const model_desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0110,
+  .bDeviceClass       = 0x00,
+  .bDeviceSubClass    = 0x00,
+  .bDeviceProtocol    = 0x00,
+  .bMaxPacketSize0    = 8,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4010,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0x00,
+  .iProduct           = 0x00,
+  .iSerialNumber      = 0x00,
+  .bNumConfigurations = 0x01
+};
+
+static uint8_t const model_desc_configuration[] = {
+  TUD_CONFIG_DESCRIPTOR(1, 1, 0, TUD_CONFIG_DESC_LEN + TUD_VENDOR_DESC_LEN, 0, 100),
+  TUD_VENDOR_DESCRIPTOR(0, 0, 0x02, 0x82, 64),
+};
+
+static uint8_t msc_disk[DISK_BLOCK_NUM][DISK_BLOCK_SIZE];
+
+static uint8_t mount_count;
+static uint8_t umount_count;
+static uint8_t mount_daddr[CFG_TUH_DEVICE_MAX + CFG_TUH_HUB];
+static uint32_t mount_frames[CFG_TUH_DEVICE_MAX + CFG_TUH_HUB];
+static uint32_t mount_frame;
+
+static uint8_t root_node;
+
+//--------------------------------------------------------------------+
+// Application callbacks
+//--------------------------------------------------------------------+
+
+uint8_t const* tud_descriptor_device_cb(void) {
+  return (uint8_t const*) &desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return desc_configuration;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) langid;
+  static uint16_t const desc_langid[] = { (TUSB_DESC_STRING << 8) | 4, 0x0409 };
+  return (index == 0) ? desc_langid : NULL;
+}
+
+uint32_t tud_msc_inquiry2_cb(uint8_t lun, scsi_inquiry_resp_t* inquiry_resp, uint32_t bufsize) {
+  (void) lun;
+  (void) inquiry_resp;
+  (void) bufsize;
+  return sizeof(scsi_inquiry_resp_t);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+  (void) lun;
+  return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
+  (void) lun;
+  *block_count = DISK_BLOCK_NUM;
+  *block_size  = DISK_BLOCK_SIZE;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  (void) lun;
+  memcpy(buffer, msc_disk[lba] + offset, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  (void) lun;
+  memcpy(msc_disk[lba] + offset, buffer, bufsize);
+  return (int32_t) bufsize;
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, uint16_t bufsize) {
+  (void) lun;
+  (void) scsi_cmd;
+  (void) buffer;
+  (void) bufsize;
+  return -1;
+}
+
+void tuh_mount_cb(uint8_t daddr) {
+  TEST_ASSERT_TRUE(mount_count < TU_ARRAY_SIZE(mount_daddr));
+  mount_frame = hcd_frame_number(HOST_RHPORT);
+  mount_frames[mount_count] = mount_frame;
+  mount_daddr[mount_count++] = daddr;
+}
+
+void tuh_umount_cb(uint8_t daddr) {
+  (void) daddr;
+  umount_count++;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+
+static void run_frames(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    hcd_sim_frame(HOST_RHPORT);
+    tud_task();
+    tuh_task();
+  }
+}
+
+// run until number of mounted devices is reached, return elapsed frames
+static uint32_t run_until_mounted(uint8_t count) {
+  uint32_t const start = hcd_frame_number(HOST_RHPORT);
+  for (uint32_t i = 0; i < ENUM_TIMEOUT_FRAMES && mount_count < count; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(count, mount_count);
+  return mount_frame - start;
+}
+
+static void make_read10_cbw(msc_cbw_t* cbw, uint32_t lba, uint16_t block_count) {
+  scsi_read10_t const cmd = {
+    .cmd_code    = SCSI_CMD_READ_10,
+    .lba         = tu_htonl(lba),
+    .block_count = tu_htons(block_count)
+  };
+
+  tu_memclr(cbw, sizeof(msc_cbw_t));
+  cbw->signature   = MSC_CBW_SIGNATURE;
+  cbw->tag         = 0xCAFECAFE;
+  cbw->total_bytes = (uint32_t) block_count * DISK_BLOCK_SIZE;
+  cbw->dir         = TUSB_DIR_IN_MASK;
+  cbw->cmd_len     = sizeof(scsi_read10_t);
+  memcpy(cbw->command, &cmd, sizeof(cmd));
+}
+
+static xfer_result_t xfer_result;
+static uint32_t xfer_len;
+
+static void xfer_complete_cb(tuh_xfer_t* xfer) {
+  xfer_result = xfer->result;
+  xfer_len    = xfer->actual_len;
+}
+
+// submit a transfer and run until it completes, return elapsed frames
+static uint32_t edpt_xfer(uint8_t daddr, uint8_t ep_addr, void* buffer, uint32_t len) {
+  tuh_xfer_t xfer = {
+    .daddr       = daddr,
+    .ep_addr     = ep_addr,
+    .buflen      = len,
+    .buffer      = (uint8_t*) buffer,
+    .complete_cb = xfer_complete_cb,
+  };
+
+  xfer_result = XFER_RESULT_INVALID;
+  uint32_t const start = hcd_frame_number(HOST_RHPORT);
+  TEST_ASSERT_TRUE(tuh_edpt_xfer(&xfer));
+  for (uint32_t i = 0; i < ENUM_TIMEOUT_FRAMES && xfer_result == XFER_RESULT_INVALID; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, xfer_result);
+  return hcd_frame_number(HOST_RHPORT) - start;
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  if (!tusb_inited()) {
+    tusb_rhport_init_t const dev_init = {
+      .role  = TUSB_ROLE_DEVICE,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(DEV_RHPORT, &dev_init);
+
+    tusb_rhport_init_t const host_init = {
+      .role  = TUSB_ROLE_HOST,
+      .speed = TUSB_SPEED_AUTO
+    };
+    tusb_init(HOST_RHPORT, &host_init);
+  }
+
+  for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+    memset(msc_disk[i], i, DISK_BLOCK_SIZE);
+  }
+
+  mount_count  = 0;
+  umount_count = 0;
+  root_node    = 0;
+}
+
+void tearDown(void) {
+  if (root_node) {
+    hcd_sim_detach(HOST_RHPORT, root_node);
+    run_frames(10);
+  }
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_enumerate_device_stack(void) {
+  root_node = hcd_sim_attach_dcd(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_HIGH, DEV_RHPORT);
+  TEST_ASSERT_NOT_EQUAL(0, root_node);
+
+  uint32_t const enum_frames = run_until_mounted(1);
+  TEST_ASSERT_TRUE(tud_mounted());
+
+  // debounce + root port reset delays are included
+  TEST_ASSERT_GREATER_THAN(ENUM_DEBOUNCE_MS + 50, enum_frames);
+
+  uint8_t const daddr = mount_daddr[0];
+  uint16_t vid, pid;
+  TEST_ASSERT_TRUE(tuh_vid_pid_get(daddr, &vid, &pid));
+  TEST_ASSERT_EQUAL_HEX16(0xCafe, vid);
+  TEST_ASSERT_EQUAL_HEX16(0x4003, pid);
+  TEST_ASSERT_EQUAL(TUSB_SPEED_HIGH, tuh_speed_get(daddr));
+  TEST_ASSERT_EQUAL(daddr, hcd_sim_node_address(HOST_RHPORT, root_node));
+
+  hcd_sim_detach(HOST_RHPORT, root_node);
+  root_node = 0;
+  run_frames(10);
+  TEST_ASSERT_EQUAL(1, umount_count);
+  TEST_ASSERT_FALSE(tuh_mounted(daddr));
+  TEST_ASSERT_FALSE(tud_mounted());
+}
+
+void test_enumerate_hub_tree(void) {
+  // root - HS hub -+- port 1: FS hub - port 2: FS vendor device
+  //                +- port 3: HS device stack
+  root_node = hcd_sim_attach_hub(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_HIGH, 4);
+  uint8_t const fs_hub = hcd_sim_attach_hub(HOST_RHPORT, root_node, 1, TUSB_SPEED_FULL, 2);
+  uint8_t const model = hcd_sim_attach_device(HOST_RHPORT, fs_hub, 2, TUSB_SPEED_HIGH, &model_desc_device,
+                                              model_desc_configuration);
+  uint8_t const dcd = hcd_sim_attach_dcd(HOST_RHPORT, root_node, 3, TUSB_SPEED_HIGH, DEV_RHPORT);
+  TEST_ASSERT_NOT_EQUAL(0, fs_hub);
+  TEST_ASSERT_NOT_EQUAL(0, model);
+  TEST_ASSERT_NOT_EQUAL(0, dcd);
+
+  // port already taken
+  TEST_ASSERT_EQUAL(0, hcd_sim_attach_hub(HOST_RHPORT, root_node, 3, TUSB_SPEED_HIGH, 2));
+
+  // tuh_mount_cb() is not invoked for hubs
+  run_until_mounted(2);
+  TEST_ASSERT_TRUE(tud_mounted());
+  TEST_ASSERT_NOT_EQUAL(0, hcd_sim_node_address(HOST_RHPORT, fs_hub));
+
+  // speed is capped by upstream hub
+  TEST_ASSERT_EQUAL(TUSB_SPEED_FULL, hcd_sim_node_speed(HOST_RHPORT, model));
+  TEST_ASSERT_EQUAL(TUSB_SPEED_HIGH, hcd_sim_node_speed(HOST_RHPORT, dcd));
+
+  uint8_t const model_addr = hcd_sim_node_address(HOST_RHPORT, model);
+  uint8_t const dcd_addr   = hcd_sim_node_address(HOST_RHPORT, dcd);
+  TEST_ASSERT_TRUE(tuh_mounted(model_addr));
+  TEST_ASSERT_TRUE(tuh_mounted(dcd_addr));
+  TEST_ASSERT_EQUAL(TUSB_SPEED_FULL, tuh_speed_get(model_addr));
+  TEST_ASSERT_EQUAL(TUSB_SPEED_HIGH, tuh_speed_get(dcd_addr));
+
+  tuh_bus_info_t bus_info;
+  TEST_ASSERT_TRUE(tuh_bus_info_get(model_addr, &bus_info));
+  TEST_ASSERT_EQUAL(hcd_sim_node_address(HOST_RHPORT, fs_hub), bus_info.hub_addr);
+  TEST_ASSERT_EQUAL(2, bus_info.hub_port);
+
+  // unplug FS hub: its device is removed, device stack is not affected
+  hcd_sim_detach(HOST_RHPORT, fs_hub);
+  run_frames(20);
+  TEST_ASSERT_EQUAL(1, umount_count);
+  TEST_ASSERT_FALSE(tuh_mounted(model_addr));
+  TEST_ASSERT_TRUE(tuh_mounted(dcd_addr));
+}
+
+void test_enumerate_hub_parallel(void) {
+  // root - hub - port 1..4: device with latency
+  enum { DEVICE_COUNT = 4 };
+  root_node = hcd_sim_attach_hub(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_HIGH, DEVICE_COUNT);
+  for (uint8_t port = 1; port <= DEVICE_COUNT; port++) {
+    uint8_t const node = hcd_sim_attach_device(HOST_RHPORT, root_node, port, TUSB_SPEED_FULL, &model_desc_device,
+                                               model_desc_configuration);
+    TEST_ASSERT_NOT_EQUAL(0, node);
+    hcd_sim_set_latency(HOST_RHPORT, node, 4);
+  }
+
+  run_until_mounted(DEVICE_COUNT);
+
+  uint32_t enum_start[DEVICE_COUNT];
+  for (uint8_t i = 0; i < DEVICE_COUNT; i++) {
+    uint32_t enum_ms;
+    TEST_ASSERT_TRUE(tuh_enum_time_get(mount_daddr[i], &enum_ms));
+    TEST_ASSERT_GREATER_THAN(ENUM_DEBOUNCE_MS, enum_ms);
+    enum_start[i] = mount_frames[i] - enum_ms;
+  }
+
+  // once previous device is addressed, next device starts enumerating before previous one is mounted
+  for (uint8_t i = 1; i < DEVICE_COUNT; i++) {
+    TEST_ASSERT_LESS_THAN(mount_frames[i - 1], enum_start[i]);
+  }
+
+  // not mounted
+  uint32_t enum_ms;
+  TEST_ASSERT_FALSE(tuh_enum_time_get(CFG_TUH_DEVICE_MAX, &enum_ms));
+}
+
+void test_latency(void) {
+  root_node = hcd_sim_attach_device(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_FULL, &model_desc_device,
+                                    model_desc_configuration);
+  uint32_t const enum_frames = run_until_mounted(1);
+  uint32_t const setup_count = hcd_sim_node_stats(HOST_RHPORT, root_node)->setup_count;
+
+  hcd_sim_detach(HOST_RHPORT, root_node);
+  run_frames(10);
+  mount_count = 0;
+
+  root_node = hcd_sim_attach_device(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_FULL, &model_desc_device,
+                                    model_desc_configuration);
+  hcd_sim_set_latency(HOST_RHPORT, root_node, 4);
+  uint32_t const latency_frames = run_until_mounted(1);
+
+  // each transfer (setup, data, status) is delayed
+  TEST_ASSERT_EQUAL(setup_count, hcd_sim_node_stats(HOST_RHPORT, root_node)->setup_count);
+  TEST_ASSERT_GREATER_OR_EQUAL(enum_frames + 4 * setup_count * 2, latency_frames);
+}
+
+static uint8_t ctrl_done_count;
+static uintptr_t ctrl_done_order[4];
+
+static void ctrl_complete_cb(tuh_xfer_t* xfer) {
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, xfer->result);
+  TEST_ASSERT_TRUE(ctrl_done_count < TU_ARRAY_SIZE(ctrl_done_order));
+  ctrl_done_order[ctrl_done_count++] = xfer->user_data;
+}
+
+// submit async control transfers (Get Device Descriptor) then run until all complete, return elapsed frames
+static uint32_t control_xfer_run(uint8_t const daddr[], uint8_t count) {
+  static tusb_desc_device_t desc[TU_ARRAY_SIZE(ctrl_done_order)];
+  ctrl_done_count = 0;
+
+  uint32_t const start = hcd_frame_number(HOST_RHPORT);
+  for (uint8_t i = 0; i < count; i++) {
+    TEST_ASSERT_TRUE(tuh_descriptor_get_device(daddr[i], &desc[i], sizeof(tusb_desc_device_t), ctrl_complete_cb, i));
+  }
+  for (uint32_t i = 0; i < ENUM_TIMEOUT_FRAMES && ctrl_done_count < count; i++) {
+    run_frames(1);
+  }
+  TEST_ASSERT_EQUAL(count, ctrl_done_count);
+
+  for (uint8_t i = 0; i < count; i++) {
+    TEST_ASSERT_EQUAL_HEX16(model_desc_device.idVendor, desc[i].idVendor);
+  }
+  return hcd_frame_number(HOST_RHPORT) - start;
+}
+
+void test_control_xfer_concurrent(void) {
+  // root - hub -+- port 1: device
+  //             +- port 2: device
+  root_node = hcd_sim_attach_hub(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_HIGH, 4);
+  uint8_t const node1 = hcd_sim_attach_device(HOST_RHPORT, root_node, 1, TUSB_SPEED_FULL, &model_desc_device,
+                                              model_desc_configuration);
+  uint8_t const node2 = hcd_sim_attach_device(HOST_RHPORT, root_node, 2, TUSB_SPEED_FULL, &model_desc_device,
+                                              model_desc_configuration);
+  run_until_mounted(2);
+  hcd_sim_set_latency(HOST_RHPORT, node1, 8);
+  hcd_sim_set_latency(HOST_RHPORT, node2, 8);
+
+  uint8_t const daddr[2] = {hcd_sim_node_address(HOST_RHPORT, node1), hcd_sim_node_address(HOST_RHPORT, node2)};
+  uint32_t const one_frames = control_xfer_run(daddr, 1);
+
+  // different devices: run concurrently
+  uint32_t const two_frames = control_xfer_run(daddr, 2);
+  TEST_ASSERT_LESS_THAN(2 * one_frames, two_frames);
+
+  // same device: queued and completed in submission order
+  uint8_t const same[3] = {daddr[0], daddr[0], daddr[0]};
+  uint32_t const same_frames = control_xfer_run(same, 3);
+  TEST_ASSERT_GREATER_OR_EQUAL(3 * one_frames - 2, same_frames);
+  for (uint8_t i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL(i, ctrl_done_order[i]);
+  }
+}
+
+void test_bulk_throughput(void) {
+  root_node = hcd_sim_attach_dcd(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_HIGH, DEV_RHPORT);
+  run_until_mounted(1);
+  uint8_t const daddr = mount_daddr[0];
+
+  // no class driver on host, open MSC endpoints directly
+  tusb_desc_endpoint_t ep_out = {
+    .bLength          = sizeof(tusb_desc_endpoint_t),
+    .bDescriptorType  = TUSB_DESC_ENDPOINT,
+    .bEndpointAddress = EDPT_MSC_OUT,
+    .bmAttributes     = { .xfer = TUSB_XFER_BULK },
+    .wMaxPacketSize   = 512,
+    .bInterval        = 0
+  };
+  tusb_desc_endpoint_t ep_in = ep_out;
+  ep_in.bEndpointAddress = EDPT_MSC_IN;
+  TEST_ASSERT_TRUE(tuh_edpt_open(daddr, &ep_out));
+  TEST_ASSERT_TRUE(tuh_edpt_open(daddr, &ep_in));
+
+  uint64_t const bytes_before = hcd_sim_node_stats(HOST_RHPORT, root_node)->byte_count;
+
+  static msc_cbw_t cbw;
+  static uint8_t data[DISK_BLOCK_NUM * DISK_BLOCK_SIZE];
+  static msc_csw_t csw;
+
+  make_read10_cbw(&cbw, 0, DISK_BLOCK_NUM);
+  uint32_t frames = edpt_xfer(daddr, EDPT_MSC_OUT, &cbw, sizeof(cbw));
+  frames += edpt_xfer(daddr, EDPT_MSC_IN, data, sizeof(data));
+  TEST_ASSERT_EQUAL(sizeof(data), xfer_len);
+  frames += edpt_xfer(daddr, EDPT_MSC_IN, &csw, sizeof(csw));
+
+  TEST_ASSERT_EQUAL(MSC_CSW_SIGNATURE, csw.signature);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, csw.status);
+  for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+    TEST_ASSERT_EACH_EQUAL_UINT8(i, data + i * DISK_BLOCK_SIZE, DISK_BLOCK_SIZE);
+  }
+
+  uint64_t const bytes = hcd_sim_node_stats(HOST_RHPORT, root_node)->byte_count - bytes_before;
+  TEST_ASSERT_EQUAL(sizeof(cbw) + sizeof(data) + sizeof(csw), bytes);
+
+  // device stack refills its 512-byte buffer on each tud_task(): one block per frame
+  TEST_ASSERT_LESS_OR_EQUAL(DISK_BLOCK_NUM + 4, frames);
+}
+
+void test_large_transfer(void) {
+  root_node = hcd_sim_attach_device(HOST_RHPORT, HCD_SIM_ROOT, 0, TUSB_SPEED_FULL, &model_desc_device,
+                                    model_desc_configuration);
+  run_until_mounted(1);
+  uint8_t const daddr = mount_daddr[0];
+
+  tusb_desc_endpoint_t ep_out = {
+    .bLength          = sizeof(tusb_desc_endpoint_t),
+    .bDescriptorType  = TUSB_DESC_ENDPOINT,
+    .bEndpointAddress = 0x02,
+    .bmAttributes     = { .xfer = TUSB_XFER_BULK },
+    .wMaxPacketSize   = 64,
+    .bInterval        = 0
+  };
+  tusb_desc_endpoint_t ep_in = ep_out;
+  ep_in.bEndpointAddress = 0x82;
+  TEST_ASSERT_TRUE(tuh_edpt_open(daddr, &ep_out));
+  TEST_ASSERT_TRUE(tuh_edpt_open(daddr, &ep_in));
+
+  // larger than what hcd_edpt_xfer() accepts: split into chunks by usbh, completed as one transfer
+  static uint8_t data[160 * 1024];
+  TEST_ASSERT_GREATER_THAN(TUP_HCD_EDPT_XFER_MAX, sizeof(data));
+
+  uint64_t bytes_before = hcd_sim_node_stats(HOST_RHPORT, root_node)->byte_count;
+  edpt_xfer(daddr, 0x82, data, sizeof(data));
+  TEST_ASSERT_EQUAL(sizeof(data), xfer_len);
+  TEST_ASSERT_EQUAL(sizeof(data), hcd_sim_node_stats(HOST_RHPORT, root_node)->byte_count - bytes_before);
+
+  bytes_before = hcd_sim_node_stats(HOST_RHPORT, root_node)->byte_count;
+  edpt_xfer(daddr, 0x02, data, sizeof(data));
+  TEST_ASSERT_EQUAL(sizeof(data), xfer_len);
+  TEST_ASSERT_EQUAL(sizeof(data), hcd_sim_node_stats(HOST_RHPORT, root_node)->byte_count - bytes_before);
+}
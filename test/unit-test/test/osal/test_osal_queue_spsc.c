@@ -0,0 +1,203 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include "unity.h"
+
+// Files to test
+#define CFG_TUSB_OSAL_QUEUE_SPSC 1
+#include "osal/osal.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+enum {
+  QUEUE_DEPTH  = 16,
+  BATCH_MAX    = 5,
+  STRESS_COUNT = 200000,
+};
+
+// same size as dcd_event_t
+typedef struct {
+  uint32_t seq;
+  uint32_t check;
+  uint8_t  ring;
+  uint8_t  pad[3];
+} item_t;
+
+OSAL_QUEUE_DEF(NULL, _qdef, QUEUE_DEPTH, item_t);
+static osal_queue_t _q;
+
+static uint32_t item_check(uint32_t seq) {
+  return seq * 2654435761u ^ 0x5A5A5A5Au;
+}
+
+static item_t item_make(uint32_t seq, bool in_isr) {
+  item_t const item = {.seq = seq, .check = item_check(seq), .ring = in_isr ? 1 : 0};
+  return item;
+}
+
+void setUp(void) {
+  _q = osal_queue_create(&_qdef);
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_send_receive(void) {
+  item_t item;
+
+  TEST_ASSERT_TRUE(osal_queue_empty(_q));
+  TEST_ASSERT_FALSE(osal_queue_receive(_q, &item, 0));
+
+  item_t const sent = item_make(7, true);
+  TEST_ASSERT_TRUE(osal_queue_send(_q, &sent, true));
+  TEST_ASSERT_FALSE(osal_queue_empty(_q));
+
+  TEST_ASSERT_TRUE(osal_queue_receive(_q, &item, 0));
+  TEST_ASSERT_EQUAL_MEMORY(&sent, &item, sizeof(item_t));
+  TEST_ASSERT_TRUE(osal_queue_empty(_q));
+}
+
+void test_full_and_wrap(void) {
+  item_t items[QUEUE_DEPTH];
+
+  // several rounds to wrap indices around [0, 2*depth)
+  for (uint32_t round = 0; round < 5; round++) {
+    for (uint32_t i = 0; i < QUEUE_DEPTH; i++) {
+      item_t const item = item_make(round * 100 + i, true);
+      TEST_ASSERT_TRUE(osal_queue_send(_q, &item, true));
+    }
+
+    item_t const extra = item_make(0, true);
+    TEST_ASSERT_FALSE(osal_queue_send(_q, &extra, true)); // full
+
+    TEST_ASSERT_EQUAL(QUEUE_DEPTH, osal_queue_receive_n(_q, items, QUEUE_DEPTH + 4, sizeof(item_t), 0));
+    for (uint32_t i = 0; i < QUEUE_DEPTH; i++) {
+      TEST_ASSERT_EQUAL(round * 100 + i, items[i].seq);
+    }
+    TEST_ASSERT_TRUE(osal_queue_empty(_q));
+
+    // partially fill to shift the start index for next round
+    for (uint32_t i = 0; i < 3; i++) {
+      item_t const item = item_make(i, true);
+      TEST_ASSERT_TRUE(osal_queue_send(_q, &item, true));
+    }
+    TEST_ASSERT_EQUAL(3, osal_queue_receive_n(_q, items, QUEUE_DEPTH, sizeof(item_t), 0));
+  }
+}
+
+void test_order_across_rings(void) {
+  item_t items[8];
+
+  // thread, ISR, ISR, thread, ISR
+  static const bool in_isr[] = {false, true, true, false, true};
+  for (uint32_t i = 0; i < TU_ARRAY_SIZE(in_isr); i++) {
+    item_t const item = item_make(i, in_isr[i]);
+    TEST_ASSERT_TRUE(osal_queue_send(_q, &item, in_isr[i]));
+  }
+
+  // receive one by one, then in batch
+  TEST_ASSERT_TRUE(osal_queue_receive(_q, &items[0], 0));
+  TEST_ASSERT_EQUAL(0, items[0].seq);
+  TEST_ASSERT_EQUAL(4, osal_queue_receive_n(_q, &items[1], 8, sizeof(item_t), 0));
+  for (uint32_t i = 0; i < TU_ARRAY_SIZE(in_isr); i++) {
+    TEST_ASSERT_EQUAL(i, items[i].seq);
+  }
+  TEST_ASSERT_TRUE(osal_queue_empty(_q));
+
+  // ISR items received before a thread item is sent are not counted again
+  item_t const isr_item    = item_make(10, true);
+  item_t const thread_item = item_make(11, false);
+  TEST_ASSERT_TRUE(osal_queue_send(_q, &isr_item, true));
+  TEST_ASSERT_TRUE(osal_queue_receive(_q, &items[0], 0));
+  TEST_ASSERT_TRUE(osal_queue_send(_q, &thread_item, false));
+  TEST_ASSERT_TRUE(osal_queue_send(_q, &isr_item, true));
+
+  TEST_ASSERT_EQUAL(2, osal_queue_receive_n(_q, items, 8, sizeof(item_t), 0));
+  TEST_ASSERT_EQUAL(11, items[0].seq);
+  TEST_ASSERT_EQUAL(10, items[1].seq);
+  TEST_ASSERT_TRUE(osal_queue_empty(_q));
+}
+
+//--------------------------------------------------------------------+
+// Stress: ISR producer on its own thread, task consumer also sending from thread context (e.g. deferred function)
+//--------------------------------------------------------------------+
+
+// ISR items sent before each thread item, lower bound of its stamp
+static uint32_t thread_isr_sent[STRESS_COUNT];
+
+static void* isr_producer(void* arg) {
+  (void) arg;
+  for (uint32_t seq = 0; seq < STRESS_COUNT; seq++) {
+    item_t const item = item_make(seq, true);
+    while (!osal_queue_send(_q, &item, true)) {
+      sched_yield(); // queue full: let the task catch up
+    }
+  }
+  return NULL;
+}
+
+void test_stress_multithread(void) {
+  pthread_t producer;
+  TEST_ASSERT_EQUAL(0, pthread_create(&producer, NULL, isr_producer, NULL));
+
+  uint32_t next_seq[2]  = {0, 0};
+  uint32_t thread_sent  = 0;
+  uint32_t batch_count  = 1;
+  uint32_t loop         = 0;
+  item_t   items[BATCH_MAX];
+
+  while (next_seq[1] < STRESS_COUNT) {
+    // thread context sender, same context as the consumer
+    if ((loop++ & 0x3u) == 0 && thread_sent < STRESS_COUNT) {
+      item_t const item = item_make(thread_sent, false);
+      thread_isr_sent[thread_sent] = __atomic_load_n(&_qdef.isr_sent, __ATOMIC_ACQUIRE);
+      if (osal_queue_send(_q, &item, false)) {
+        thread_sent++;
+      }
+    }
+
+    const uint32_t n = osal_queue_receive_n(_q, items, batch_count, sizeof(item_t), 0);
+    batch_count = (batch_count % BATCH_MAX) + 1;
+    if (n == 0) {
+      sched_yield(); // queue empty: let the producer run
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+      const uint8_t ring = items[i].ring;
+      TEST_ASSERT_TRUE(ring < 2);
+      TEST_ASSERT_EQUAL_UINT32(next_seq[ring], items[i].seq);
+      TEST_ASSERT_EQUAL_HEX32(item_check(items[i].seq), items[i].check);
+      if (ring == 0) {
+        // ISR items sent before this thread item are already received
+        TEST_ASSERT_GREATER_OR_EQUAL(thread_isr_sent[items[i].seq], next_seq[1]);
+      }
+      next_seq[ring]++;
+    }
+  }
+
+  TEST_ASSERT_EQUAL(0, pthread_join(producer, NULL));
+
+  // drain thread ring
+  item_t item;
+  while (osal_queue_receive(_q, &item, 0)) {
+    TEST_ASSERT_EQUAL(0, item.ring);
+    TEST_ASSERT_EQUAL_UINT32(next_seq[0], item.seq);
+    next_seq[0]++;
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(STRESS_COUNT, next_seq[1]);
+  TEST_ASSERT_EQUAL_UINT32(thread_sent, next_seq[0]);
+  TEST_ASSERT_TRUE(osal_queue_empty(_q));
+}
@@ -0,0 +1,232 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "tusb_common.h"
+#include "portable/synopsys/dwc2/dwc2_dma_desc.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+enum {
+  LIST_COUNT = 4,
+  BUF_ADDR   = 0x20000000
+};
+
+// descriptor list in memory, same as in dcd_dwc2
+static dwc2_dma_desc_t list[LIST_COUNT + 1];
+
+// Emulate DMA closing a descriptor after transferring xferred bytes
+static void dma_close(dwc2_dma_desc_t* desc, uint32_t xferred, bool short_packet, uint8_t sts) {
+  dwc2_dma_desc_status_t status = {.value = desc->status};
+  status.bytes -= xferred;
+  status.short_packet = short_packet;
+  status.sts = sts;
+  status.bs = DWC2_DMA_DESC_BS_DMA_DONE;
+  desc->status = status.value;
+}
+
+static void dma_close_iso(dwc2_dma_desc_t* desc, uint32_t xferred) {
+  dwc2_dma_desc_iso_status_t status = {.value = desc->status};
+  status.bytes -= xferred;
+  status.bs = DWC2_DMA_DESC_BS_DMA_DONE;
+  desc->status = status.value;
+}
+
+static void check_desc(uint8_t idx, uint32_t buf, uint16_t bytes, bool last, bool short_packet) {
+  const dwc2_dma_desc_status_t status = {.value = list[idx].status};
+  TEST_ASSERT_EQUAL_HEX32(buf, list[idx].buf);
+  TEST_ASSERT_EQUAL(bytes, status.bytes);
+  TEST_ASSERT_EQUAL(DWC2_DMA_DESC_BS_HOST_READY, status.bs);
+  TEST_ASSERT_EQUAL(last, status.last);
+  TEST_ASSERT_EQUAL(last, status.ioc);
+  TEST_ASSERT_EQUAL(short_packet, status.short_packet);
+  TEST_ASSERT_EQUAL(0, status.mtrf);
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  // poison memory so that stale descriptor is noticed
+  memset(list, 0xA5, sizeof(list));
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+
+void test_bytes_max(void) {
+  TEST_ASSERT_EQUAL(65472, dwc2_dma_desc_bytes_max(64));
+  TEST_ASSERT_EQUAL(65024, dwc2_dma_desc_bytes_max(512));
+  TEST_ASSERT_EQUAL(65535, dwc2_dma_desc_bytes_max(1));
+}
+
+void test_xfer_size(void) {
+  TEST_ASSERT_EQUAL(100, dwc2_dma_desc_xfer_size(100, 64, true));
+  TEST_ASSERT_EQUAL(0, dwc2_dma_desc_xfer_size(0, 64, true));
+
+  // OUT is rounded up to whole packets
+  TEST_ASSERT_EQUAL(128, dwc2_dma_desc_xfer_size(100, 64, false));
+  TEST_ASSERT_EQUAL(128, dwc2_dma_desc_xfer_size(128, 64, false));
+  TEST_ASSERT_EQUAL(64, dwc2_dma_desc_xfer_size(0, 64, false));
+}
+
+void test_build_in_single(void) {
+  TEST_ASSERT_EQUAL(1, dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 1000, 512, dwc2_dma_desc_bytes_max(512), true));
+  check_desc(0, BUF_ADDR, 1000, true, true);
+
+  // multiple of max packet size: no short packet
+  TEST_ASSERT_EQUAL(1, dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 1024, 512, dwc2_dma_desc_bytes_max(512), true));
+  check_desc(0, BUF_ADDR, 1024, true, false);
+}
+
+void test_build_in_zlp(void) {
+  TEST_ASSERT_EQUAL(1, dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 0, 64, 64, true));
+  check_desc(0, BUF_ADDR, 0, true, false);
+}
+
+void test_build_in_multiple(void) {
+  const uint32_t bytes_max = dwc2_dma_desc_bytes_max(512);
+  const uint32_t len = 3 * bytes_max + 4000;
+
+  TEST_ASSERT_EQUAL(4, dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, len, 512, bytes_max, true));
+  check_desc(0, BUF_ADDR, bytes_max, false, false);
+  check_desc(1, BUF_ADDR + bytes_max, bytes_max, false, false);
+  check_desc(2, BUF_ADDR + 2 * bytes_max, bytes_max, false, false);
+  check_desc(3, BUF_ADDR + 3 * bytes_max, 4000, true, true);
+
+  // descriptor after list is untouched
+  TEST_ASSERT_EQUAL_HEX32(0xA5A5A5A5, list[4].status);
+}
+
+void test_build_list_too_small(void) {
+  const uint32_t bytes_max = dwc2_dma_desc_bytes_max(512);
+  TEST_ASSERT_EQUAL(0, dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 4 * bytes_max + 1, 512, bytes_max, true));
+  TEST_ASSERT_EQUAL(4, dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 4 * bytes_max, 512, bytes_max, true));
+}
+
+void test_build_out(void) {
+  // buffer size is rounded up to whole packet, no short packet flag for OUT
+  TEST_ASSERT_EQUAL(1, dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 100, 64, 64 * 4, false));
+  check_desc(0, BUF_ADDR, 128, true, false);
+
+  // zero length OUT still receives one packet
+  TEST_ASSERT_EQUAL(1, dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 0, 64, 64, false));
+  check_desc(0, BUF_ADDR, 64, true, false);
+}
+
+void test_build_setup(void) {
+  // 3 back-to-back SETUP packets into one descriptor
+  TEST_ASSERT_EQUAL(1, dwc2_dma_desc_build(list, 1, BUF_ADDR, 24, 8, 24, false));
+  check_desc(0, BUF_ADDR, 24, true, false);
+}
+
+void test_remaining_in_complete(void) {
+  const uint32_t bytes_max = dwc2_dma_desc_bytes_max(512);
+  const uint32_t len = bytes_max + 100;
+  const uint8_t count = dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, len, 512, bytes_max, true);
+  TEST_ASSERT_EQUAL(2, count);
+
+  dma_close(&list[0], bytes_max, false, DWC2_DMA_DESC_STS_SUCCESS);
+  dma_close(&list[1], 100, true, DWC2_DMA_DESC_STS_SUCCESS);
+
+  uint8_t sts = 0xff;
+  TEST_ASSERT_EQUAL(0, dwc2_dma_desc_remaining(list, count, false, &sts));
+  TEST_ASSERT_EQUAL(DWC2_DMA_DESC_STS_SUCCESS, sts);
+}
+
+void test_remaining_out_short_packet(void) {
+  // 3 descriptors of 2 packets each
+  const uint8_t count = dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 384, 64, 128, false);
+  TEST_ASSERT_EQUAL(3, count);
+
+  // short packet in 2nd descriptor ends the transfer, 3rd descriptor is never fetched
+  dma_close(&list[0], 128, false, DWC2_DMA_DESC_STS_SUCCESS);
+  dma_close(&list[1], 64 + 6, true, DWC2_DMA_DESC_STS_SUCCESS);
+
+  uint8_t sts = 0xff;
+  const uint32_t remain = dwc2_dma_desc_remaining(list, count, false, &sts);
+  TEST_ASSERT_EQUAL(58 + 128, remain);
+  TEST_ASSERT_EQUAL(198, 384 - remain);
+  TEST_ASSERT_EQUAL(DWC2_DMA_DESC_STS_SUCCESS, sts);
+}
+
+void test_remaining_stop_at_last(void) {
+  const uint8_t count = dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 64, 64, 64, false);
+  TEST_ASSERT_EQUAL(1, count);
+  dma_close(&list[0], 64, false, DWC2_DMA_DESC_STS_SUCCESS);
+
+  // poisoned descriptor after the last one is not counted even if caller passes a larger count
+  TEST_ASSERT_EQUAL(0, dwc2_dma_desc_remaining(list, LIST_COUNT, false, NULL));
+}
+
+void test_remaining_buffer_error(void) {
+  const uint8_t count = dwc2_dma_desc_build(list, LIST_COUNT, BUF_ADDR, 256, 64, 128, false);
+  TEST_ASSERT_EQUAL(2, count);
+
+  dma_close(&list[0], 128, false, DWC2_DMA_DESC_STS_SUCCESS);
+  dma_close(&list[1], 0, false, DWC2_DMA_DESC_STS_BUFERR);
+
+  uint8_t sts = 0;
+  TEST_ASSERT_EQUAL(128, dwc2_dma_desc_remaining(list, count, false, &sts));
+  TEST_ASSERT_EQUAL(DWC2_DMA_DESC_STS_BUFERR, sts);
+}
+
+void test_build_iso_in(void) {
+  // 2 full packets and a short one, frame number wraps around
+  const uint8_t count = dwc2_dma_desc_build_iso(list, LIST_COUNT, BUF_ADDR, 400, 192, 0x7FE, 1, true);
+  TEST_ASSERT_EQUAL(3, count);
+
+  const uint16_t expected_bytes[] = {192, 192, 16};
+  const uint16_t expected_frame[] = {0x7FE, 0x7FF, 0x000};
+  for (uint8_t i = 0; i < count; i++) {
+    const dwc2_dma_desc_iso_status_t status = {.value = list[i].status};
+    TEST_ASSERT_EQUAL_HEX32(BUF_ADDR + i * 192, list[i].buf);
+    TEST_ASSERT_EQUAL(expected_bytes[i], status.bytes);
+    TEST_ASSERT_EQUAL(expected_frame[i], status.frame_num);
+    TEST_ASSERT_EQUAL(1, status.pid);
+    TEST_ASSERT_EQUAL(DWC2_DMA_DESC_BS_HOST_READY, status.bs);
+    TEST_ASSERT_EQUAL(i == count - 1, status.last);
+    TEST_ASSERT_EQUAL(i == count - 1, status.ioc);
+    TEST_ASSERT_EQUAL(i == count - 1, status.short_packet);
+  }
+
+  TEST_ASSERT_EQUAL(0, dwc2_dma_desc_build_iso(list, LIST_COUNT, BUF_ADDR, 5 * 192, 192, 0, 1, true));
+}
+
+void test_build_iso_interval(void) {
+  // highspeed bInterval = 4: every 8 microframes
+  const uint8_t count = dwc2_dma_desc_build_iso(list, LIST_COUNT, BUF_ADDR, 2048, 1024, 100, 8, true);
+  TEST_ASSERT_EQUAL(2, count);
+  TEST_ASSERT_EQUAL(100, list[0].iso_status_bm.frame_num);
+  TEST_ASSERT_EQUAL(108, list[1].iso_status_bm.frame_num);
+  TEST_ASSERT_EQUAL(0, list[1].iso_status_bm.short_packet);
+}
+
+void test_iso_out(void) {
+  // OUT buffer is always a whole packet
+  const uint8_t count = dwc2_dma_desc_build_iso(list, LIST_COUNT, BUF_ADDR, 300, 192, 10, 1, false);
+  TEST_ASSERT_EQUAL(2, count);
+  TEST_ASSERT_EQUAL(192, list[0].iso_status_bm.bytes);
+  TEST_ASSERT_EQUAL(192, list[1].iso_status_bm.bytes);
+  TEST_ASSERT_EQUAL(0, list[1].iso_status_bm.short_packet);
+
+  dma_close_iso(&list[0], 192);
+  dma_close_iso(&list[1], 92);
+
+  const uint32_t remain = dwc2_dma_desc_remaining(list, count, true, NULL);
+  TEST_ASSERT_EQUAL(100, remain);
+  TEST_ASSERT_EQUAL(284, 2 * 192 - remain);
+}
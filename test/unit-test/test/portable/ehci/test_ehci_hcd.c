@@ -0,0 +1,203 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <string.h>
+#include "unity.h"
+
+// Files to test
+#include "tusb.h"
+#include "host/hcd.h"
+#include "host/usbh_pvt.h"
+#include "portable/ehci/ehci.h"
+#include "portable/ehci/ehci_api.h"
+
+TEST_SOURCE_FILE("ehci.c")
+
+// ChipIdea with isochronous support uses a 32-entry framelist, larger than the longest (8 ms) period list head
+TU_VERIFY_STATIC(CFG_TUH_EHCI_ISO_EDPT_MAX > 0, "test expects 32-entry framelist");
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+enum {
+  RHPORT         = 0,
+  DEV_ADDR       = 1,
+  FRAMELIST_SIZE = 32,
+  EP_IN          = 0x81,
+  EP_SIZE        = 8,
+};
+
+// registers of simulated HC, ehci.c addresses everything with 32-bit pointers
+static ehci_cap_registers_t cap_regs;
+static ehci_registers_t op_regs;
+
+static uint8_t dev_speed;
+static uint8_t xfer_buf[EP_SIZE];
+
+static hcd_event_t last_event;
+static uint32_t xfer_complete_count;
+
+//--------------------------------------------------------------------+
+// Stubs
+//--------------------------------------------------------------------+
+void hcd_event_handler(hcd_event_t const* event, bool in_isr) {
+  (void) in_isr;
+  if (event->event_id == HCD_EVENT_XFER_COMPLETE) {
+    last_event = *event;
+    xfer_complete_count++;
+  }
+}
+
+bool tuh_bus_info_get(uint8_t daddr, tuh_bus_info_t* bus_info) {
+  (void) daddr;
+  tu_memclr(bus_info, sizeof(tuh_bus_info_t));
+  bus_info->rhport = RHPORT;
+  bus_info->speed = dev_speed;
+  return true;
+}
+
+void usbh_spin_lock(bool in_isr) {
+  (void) in_isr;
+}
+
+void usbh_spin_unlock(bool in_isr) {
+  (void) in_isr;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+static void* bus_ptr(uint32_t addr) {
+  return (void*) (uintptr_t) tu_align32(addr);
+}
+
+// find queue head of endpoint in a list, stop at terminate or when looping back to first entry
+static ehci_qhd_t* list_find_qhd(ehci_link_t const* first, uint8_t daddr, uint8_t epnum) {
+  ehci_link_t const* link = first;
+  for (uint32_t count = 0; count < 64 && !link->terminate; count++) {
+    if (link->type == EHCI_QTYPE_QHD) {
+      ehci_qhd_t* qhd = (ehci_qhd_t*) bus_ptr(link->address);
+      if (qhd->dev_addr == daddr && qhd->ep_number == epnum) {
+        return qhd;
+      }
+      if ((void const*) &qhd->next == (void const*) first) {
+        break;
+      }
+      link = &qhd->next;
+    } else {
+      break;
+    }
+  }
+  return NULL;
+}
+
+static ehci_qhd_t* period_find_qhd(uint32_t slot, uint8_t daddr, uint8_t epnum) {
+  ehci_link_t const* framelist = (ehci_link_t const*) bus_ptr(op_regs.periodic_list_base);
+  return list_find_qhd(&framelist[slot], daddr, epnum);
+}
+
+static ehci_qhd_t* async_find_qhd(uint8_t daddr, uint8_t epnum) {
+  ehci_qhd_t* head = (ehci_qhd_t*) bus_ptr(op_regs.async_list_addr);
+  return list_find_qhd(&head->next, daddr, epnum);
+}
+
+static void open_interrupt_in(uint8_t speed, uint8_t interval) {
+  dev_speed = speed;
+  tusb_desc_endpoint_t const desc = {
+    .bLength          = sizeof(tusb_desc_endpoint_t),
+    .bDescriptorType  = TUSB_DESC_ENDPOINT,
+    .bEndpointAddress = EP_IN,
+    .bmAttributes     = {.xfer = TUSB_XFER_INTERRUPT},
+    .wMaxPacketSize   = EP_SIZE,
+    .bInterval        = interval,
+  };
+  TEST_ASSERT_TRUE(hcd_edpt_open(RHPORT, DEV_ADDR, &desc));
+}
+
+// HC completes the attached qTD with given bytes, then raises USBINT
+static void complete_interrupt_in(ehci_qhd_t* qhd, uint16_t len) {
+  ehci_qtd_t* qtd = (ehci_qtd_t*) bus_ptr(qhd->qtd_overlay.next.address);
+  qtd->total_bytes -= len;
+  qtd->active = 0;
+  qhd->qtd_overlay.active = 0;
+
+  op_regs.status = EHCI_INT_MASK_USB;
+  hcd_int_handler(RHPORT, true);
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+void setUp(void) {
+  tu_memclr((void*) &cap_regs, sizeof(cap_regs));
+  tu_memclr((void*) &op_regs, sizeof(op_regs));
+  tu_memclr(&last_event, sizeof(last_event));
+  xfer_complete_count = 0;
+
+  TEST_ASSERT_TRUE(ehci_init(RHPORT, (uint32_t) (uintptr_t) &cap_regs, (uint32_t) (uintptr_t) &op_regs));
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+void test_period_list_heads(void) {
+  ehci_link_t const* framelist = (ehci_link_t const*) bus_ptr(op_regs.periodic_list_base);
+  ehci_qhd_t const* async_head = (ehci_qhd_t const*) bus_ptr(op_regs.async_list_addr);
+
+  // every slot ends at the 1 ms head, none of them leads into the async list
+  for (uint32_t i = 0; i < FRAMELIST_SIZE; i++) {
+    ehci_link_t const* link = &framelist[i];
+    uint32_t count = 0;
+    while (!link->terminate) {
+      TEST_ASSERT_LESS_THAN(5, count++);
+      TEST_ASSERT_TRUE(bus_ptr(link->address) != async_head);
+      link = (ehci_link_t const*) bus_ptr(link->address);
+    }
+  }
+}
+
+// full-speed interval 32 ms is longer than the 8 ms list head, endpoint is polled every 8 ms
+void test_interrupt_fullspeed_32ms(void) {
+  open_interrupt_in(TUSB_SPEED_FULL, 32);
+
+  TEST_ASSERT_NULL(async_find_qhd(DEV_ADDR, 1));
+  TEST_ASSERT_NULL(period_find_qhd(1, DEV_ADDR, 1));
+  ehci_qhd_t* qhd = period_find_qhd(3, DEV_ADDR, 1);
+  TEST_ASSERT_NOT_NULL(qhd);
+  TEST_ASSERT_EQUAL_PTR(qhd, period_find_qhd(11, DEV_ADDR, 1));
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(RHPORT, DEV_ADDR, EP_IN, xfer_buf, EP_SIZE));
+  complete_interrupt_in(qhd, 4);
+
+  TEST_ASSERT_EQUAL(1, xfer_complete_count);
+  TEST_ASSERT_EQUAL(DEV_ADDR, last_event.dev_addr);
+  TEST_ASSERT_EQUAL_HEX8(EP_IN, last_event.xfer_complete.ep_addr);
+  TEST_ASSERT_EQUAL(4, last_event.xfer_complete.len);
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, last_event.xfer_complete.result);
+}
+
+// highspeed bInterval 8 is 2^7 microframes = 16 ms
+void test_interrupt_highspeed_16ms(void) {
+  open_interrupt_in(TUSB_SPEED_HIGH, 8);
+
+  TEST_ASSERT_NULL(async_find_qhd(DEV_ADDR, 1));
+  ehci_qhd_t* qhd = period_find_qhd(3, DEV_ADDR, 1);
+  TEST_ASSERT_NOT_NULL(qhd);
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(RHPORT, DEV_ADDR, EP_IN, xfer_buf, EP_SIZE));
+  complete_interrupt_in(qhd, EP_SIZE);
+
+  TEST_ASSERT_EQUAL(1, xfer_complete_count);
+  TEST_ASSERT_EQUAL(EP_SIZE, last_event.xfer_complete.len);
+
+  // closing removes it from the 8 ms list
+  hcd_edpt_close(RHPORT, DEV_ADDR, EP_IN);
+  TEST_ASSERT_NULL(period_find_qhd(3, DEV_ADDR, 1));
+}
@@ -0,0 +1,570 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "tusb_common.h"
+#include "portable/ehci/ehci_iso.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+enum {
+  TD_COUNT       = 8,
+  FRAMELIST_SIZE = 32,
+  MEM_BASE       = 0x20000000, // bus address of mem[]
+  TD_BASE        = 0x30000000, // bus address of td pool, TD n is at TD_BASE + n * 64
+  BUF_OFFSET     = 0xF00,      // buffer starts close to page boundary
+  DEV_ADDR       = 3,
+  HUB_ADDR       = 5,
+  HUB_PORT       = 2,
+};
+
+static uint8_t mem[0x10000];
+static ehci_budget_t budget;
+static ehci_budget_tt_t tt;
+
+// descriptors in memory, same as in ehci.c
+static ehci_itd_t itd[TD_COUNT];
+static ehci_sitd_t sitd[TD_COUNT];
+
+// Periodic frame list of simulated HC, iTD/siTD are linked by bus address
+static ehci_link_t framelist[FRAMELIST_SIZE];
+
+// Endpoint data emulation: IN packets generated from a counter, OUT packets appended to a buffer
+static uint8_t dev_in_counter;
+static uint16_t dev_in_short; // if non-zero, device returns at most this many bytes per packet
+static uint8_t dev_out[0x8000];
+static uint32_t dev_out_len;
+
+//--------------------------------------------------------------------+
+// Simulated Host Controller
+//--------------------------------------------------------------------+
+
+static uint8_t* mem_ptr(uint32_t bus_addr) {
+  TEST_ASSERT_TRUE(bus_addr >= MEM_BASE && bus_addr < MEM_BASE + sizeof(mem));
+  return &mem[bus_addr - MEM_BASE];
+}
+
+static uint32_t td_bus_addr(void const* td) {
+  uintptr_t const p = (uintptr_t) td;
+  if (p >= (uintptr_t) itd && p < (uintptr_t) (itd + TD_COUNT)) {
+    return TD_BASE + (uint32_t) (p - (uintptr_t) itd);
+  }
+  return TD_BASE + 0x1000 + (uint32_t) (p - (uintptr_t) sitd);
+}
+
+static void* td_from_bus(uint32_t bus_addr) {
+  uint32_t const offset = tu_align32(bus_addr) - TD_BASE;
+  if (offset < 0x1000) {
+    return (uint8_t*) itd + offset;
+  }
+  return (uint8_t*) sitd + offset - 0x1000;
+}
+
+// link TD at front of frame list slot as done by ehci.c
+static void link_td(uint32_t frame, void* td, uint8_t type) {
+  ehci_link_t* slot = &framelist[frame % FRAMELIST_SIZE];
+  ((ehci_link_t*) td)->address = slot->address;
+  slot->address = td_bus_addr(td) | (uint32_t) (type << 1);
+}
+
+// Byte n of a transaction: continue into next page pointer when crossing page boundary (EHCI 4.7.1)
+static uint8_t* itd_byte(ehci_itd_t const* td, uint8_t u, uint32_t n) {
+  uint32_t const offset = td->xact[u].offset + n;
+  uint32_t const page = td->xact[u].page_select + offset / 4096;
+  TEST_ASSERT_LESS_THAN(7, page);
+  return mem_ptr(tu_align4k(td->BufferPointer[page]) + (offset % 4096));
+}
+
+static void hc_exec_itd(ehci_itd_t* td, uint8_t u) {
+  if (!td->xact[u].active) {
+    return;
+  }
+
+  uint32_t const len = td->xact[u].length;
+  if (td->BufferPointer[1] & TU_BIT(11)) {
+    // IN: write back actual length
+    uint32_t const actual = dev_in_short ? tu_min32(len, dev_in_short) : len;
+    for (uint32_t n = 0; n < actual; n++) {
+      *itd_byte(td, u, n) = dev_in_counter++;
+    }
+    td->xact[u].length = actual;
+  } else {
+    for (uint32_t n = 0; n < len; n++) {
+      dev_out[dev_out_len++] = *itd_byte(td, u, n);
+    }
+  }
+  td->xact[u].active = 0;
+}
+
+static void hc_exec_sitd(ehci_sitd_t* td) {
+  if (!td->active) {
+    return;
+  }
+
+  uint32_t const len = td->total_bytes;
+  uint32_t const addr = td->buffer[0];
+  if (td->direction) {
+    uint32_t const actual = dev_in_short ? tu_min32(len, dev_in_short) : len;
+    for (uint32_t n = 0; n < actual; n++) {
+      *mem_ptr(addr + n) = dev_in_counter++;
+    }
+    td->total_bytes = len - actual;
+  } else {
+    for (uint32_t n = 0; n < len; n++) {
+      dev_out[dev_out_len++] = *mem_ptr(addr + n);
+    }
+    td->total_bytes = 0;
+  }
+  td->active = 0;
+}
+
+// Walk frame list slot of a frame in each microframe, execute iTD/siTD until the first queue head
+static void hc_run_frame(uint32_t frame) {
+  for (uint8_t u = 0; u < 8; u++) {
+    ehci_link_t link = framelist[frame % FRAMELIST_SIZE];
+    while (!link.terminate && link.type != EHCI_QTYPE_QHD) {
+      void* td = td_from_bus(link.address);
+      if (link.type == EHCI_QTYPE_ITD) {
+        hc_exec_itd((ehci_itd_t*) td, u);
+      } else if (link.type == EHCI_QTYPE_SITD && u == 0) {
+        hc_exec_sitd((ehci_sitd_t*) td);
+      }
+      link = *(ehci_link_t*) td;
+    }
+  }
+}
+
+//--------------------------------------------------------------------+
+// Setup/Teardown
+//--------------------------------------------------------------------+
+
+void setUp(void) {
+  tu_memclr(&budget, sizeof(budget));
+  tu_memclr(&tt, sizeof(tt));
+  memset(itd, 0xA5, sizeof(itd));
+  memset(sitd, 0xA5, sizeof(sitd));
+  memset(mem, 0, sizeof(mem));
+
+  // empty frame list: all slots point to a dummy queue head
+  for (uint32_t i = 0; i < FRAMELIST_SIZE; i++) {
+    framelist[i].address = 0x40000000u | (EHCI_QTYPE_QHD << 1);
+  }
+
+  dev_in_counter = 0;
+  dev_in_short = 0;
+  dev_out_len = 0;
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Budget
+//--------------------------------------------------------------------+
+
+void test_budget_hs_every_uframe(void) {
+  ehci_budget_rsv_t rsv1, rsv2;
+  uint16_t const cost = 3 * ehci_budget_hs_xact(1024, true);
+
+  // high bandwidth endpoint: 3x1024 every microframe
+  TEST_ASSERT_TRUE(ehci_budget_itd_reserve(&budget, &rsv1, 1024, 3, 1));
+  TEST_ASSERT_EQUAL_HEX8(0xFF, rsv1.smask);
+  TEST_ASSERT_EQUAL(1, rsv1.frame_period);
+  for (uint8_t u = 0; u < EHCI_BUDGET_UFRAMES; u++) {
+    TEST_ASSERT_EQUAL(cost, budget.hs[u]);
+  }
+
+  // same endpoint again exceeds 80% of microframe
+  TEST_ASSERT_FALSE(ehci_budget_itd_reserve(&budget, &rsv2, 1024, 3, 1));
+
+  // released bandwidth can be reserved again
+  ehci_budget_update(&budget, NULL, &rsv1, false);
+  TEST_ASSERT_EQUAL(0, budget.hs[0]);
+  TEST_ASSERT_TRUE(ehci_budget_itd_reserve(&budget, &rsv2, 1024, 3, 1));
+}
+
+void test_budget_hs_phase(void) {
+  ehci_budget_rsv_t rsv[3];
+
+  // interval 2 microframes: even microframes, next endpoint uses odd microframes
+  TEST_ASSERT_TRUE(ehci_budget_itd_reserve(&budget, &rsv[0], 1024, 3, 2));
+  TEST_ASSERT_EQUAL_HEX8(0x55, rsv[0].smask);
+  TEST_ASSERT_TRUE(ehci_budget_itd_reserve(&budget, &rsv[1], 1024, 3, 2));
+  TEST_ASSERT_EQUAL_HEX8(0xAA, rsv[1].smask);
+  TEST_ASSERT_FALSE(ehci_budget_itd_reserve(&budget, &rsv[2], 1024, 3, 2));
+
+  // small endpoint still fits alongside
+  TEST_ASSERT_TRUE(ehci_budget_itd_reserve(&budget, &rsv[2], 192, 1, 8));
+  TEST_ASSERT_EQUAL_HEX8(0x01, rsv[2].smask);
+}
+
+void test_budget_hs_long_interval(void) {
+  ehci_budget_rsv_t rsv1, rsv2;
+
+  // interval 4 frames: microframe 0 of frame 0 and 4
+  TEST_ASSERT_TRUE(ehci_budget_itd_reserve(&budget, &rsv1, 1024, 3, 32));
+  TEST_ASSERT_EQUAL(0, rsv1.frame_phase);
+  TEST_ASSERT_EQUAL(4, rsv1.frame_period);
+  TEST_ASSERT_EQUAL_HEX8(0x01, rsv1.smask);
+  TEST_ASSERT_NOT_EQUAL(0, budget.hs[4 * 8]);
+  TEST_ASSERT_EQUAL(0, budget.hs[1 * 8]);
+
+  // interval longer than budget window is budgeted as every 8 frames, next microframe is used when full
+  budget.hs[0] = EHCI_BUDGET_HS_UFRAME_MAX;
+  TEST_ASSERT_TRUE(ehci_budget_itd_reserve(&budget, &rsv2, 512, 1, 1024));
+  TEST_ASSERT_EQUAL(0, rsv2.frame_phase);
+  TEST_ASSERT_EQUAL(8, rsv2.frame_period);
+  TEST_ASSERT_EQUAL_HEX8(0x02, rsv2.smask);
+}
+
+void test_budget_sitd_out(void) {
+  ehci_budget_rsv_t rsv1, rsv2;
+
+  // 192 bytes need 2 start-splits
+  TEST_ASSERT_TRUE(ehci_budget_sitd_reserve(&budget, &tt, &rsv1, 192, false, 1));
+  TEST_ASSERT_EQUAL_HEX8(0x03, rsv1.smask);
+  TEST_ASSERT_EQUAL_HEX8(0x00, rsv1.cmask);
+  TEST_ASSERT_EQUAL(192 + 9, rsv1.tt_cost);
+  TEST_ASSERT_EQUAL(ehci_budget_hs_xact(188, true), rsv1.uframe_cost[0]);
+  TEST_ASSERT_EQUAL(ehci_budget_hs_xact(4, true), rsv1.uframe_cost[1]);
+  TEST_ASSERT_EQUAL(192 + 9, tt.fs[7]);
+
+  // next endpoint starts after the first one on full-speed bus
+  TEST_ASSERT_TRUE(ehci_budget_sitd_reserve(&budget, &tt, &rsv2, 192, false, 1));
+  TEST_ASSERT_EQUAL_HEX8(0x06, rsv2.smask);
+  TEST_ASSERT_EQUAL(2 * (192 + 9), tt.fs[0]);
+}
+
+void test_budget_sitd_in(void) {
+  ehci_budget_rsv_t rsv1, rsv2;
+
+  // start-split at 0, data in microframe 1..2, complete-split at 2..4
+  TEST_ASSERT_TRUE(ehci_budget_sitd_reserve(&budget, &tt, &rsv1, 300, true, 1));
+  TEST_ASSERT_EQUAL_HEX8(0x01, rsv1.smask);
+  TEST_ASSERT_EQUAL_HEX8(0x1C, rsv1.cmask);
+
+  // largest packet fills the frame, extra complete-split does not fit
+  tu_memclr(&tt, sizeof(tt));
+  TEST_ASSERT_TRUE(ehci_budget_sitd_reserve(&budget, &tt, &rsv2, 1023, true, 1));
+  TEST_ASSERT_EQUAL_HEX8(0x01, rsv2.smask);
+  TEST_ASSERT_EQUAL_HEX8(0xFC, rsv2.cmask);
+}
+
+void test_budget_sitd_interval(void) {
+  ehci_budget_rsv_t rsv1, rsv2;
+
+  // interval 2 frames: even frames first, then odd frames when TT is busy
+  TEST_ASSERT_TRUE(ehci_budget_sitd_reserve(&budget, &tt, &rsv1, 1023, false, 2));
+  TEST_ASSERT_EQUAL(0, rsv1.frame_phase);
+  TEST_ASSERT_EQUAL(2, rsv1.frame_period);
+
+  TEST_ASSERT_TRUE(ehci_budget_sitd_reserve(&budget, &tt, &rsv2, 512, false, 2));
+  TEST_ASSERT_EQUAL(1, rsv2.frame_phase);
+  TEST_ASSERT_EQUAL_HEX8(0x07, rsv2.smask);
+
+  // TT is full in every frame
+  ehci_budget_rsv_t rsv3;
+  TEST_ASSERT_FALSE(ehci_budget_sitd_reserve(&budget, &tt, &rsv3, 1023, false, 1));
+
+  // release
+  ehci_budget_update(&budget, &tt, &rsv1, false);
+  ehci_budget_update(&budget, &tt, &rsv2, false);
+  for (uint8_t f = 0; f < EHCI_BUDGET_FRAMES; f++) {
+    TEST_ASSERT_EQUAL(0, tt.fs[f]);
+  }
+  for (uint8_t u = 0; u < EHCI_BUDGET_UFRAMES; u++) {
+    TEST_ASSERT_EQUAL(0, budget.hs[u]);
+  }
+}
+
+//--------------------------------------------------------------------+
+// iTD
+//--------------------------------------------------------------------+
+
+void test_itd_init(void) {
+  ehci_itd_init(&itd[0], DEV_ADDR, 0x81, 1024, 3);
+  TEST_ASSERT_TRUE(itd[0].next.terminate);
+  TEST_ASSERT_EQUAL_HEX32(DEV_ADDR | (1 << 8), itd[0].BufferPointer[0]);
+  TEST_ASSERT_EQUAL_HEX32(1024 | TU_BIT(11), itd[0].BufferPointer[1]);
+  TEST_ASSERT_EQUAL_HEX32(3, itd[0].BufferPointer[2]);
+  TEST_ASSERT_FALSE(ehci_itd_active(&itd[0]));
+}
+
+void test_itd_build_every_uframe(void) {
+  uint32_t const buf = MEM_BASE + BUF_OFFSET;
+  for (uint8_t i = 0; i < TD_COUNT; i++) {
+    ehci_itd_init(&itd[i], DEV_ADDR, 0x01, 512, 1);
+  }
+
+  // 10 transactions: 8 in first iTD, 2 in second
+  TEST_ASSERT_EQUAL(2, ehci_itd_build(itd, TD_COUNT, buf, 10 * 512 - 100, 512, 0, 1));
+
+  // endpoint info is kept
+  TEST_ASSERT_EQUAL_HEX32(DEV_ADDR | (1 << 8) | tu_align4k(buf), itd[0].BufferPointer[0]);
+  TEST_ASSERT_EQUAL_HEX32(512 | (tu_align4k(buf) + 4096), itd[0].BufferPointer[1]);
+
+  TEST_ASSERT_EQUAL_HEX32(BUF_OFFSET, itd[0].xact[0].offset);
+  TEST_ASSERT_EQUAL(0, itd[0].xact[0].page_select);
+  TEST_ASSERT_EQUAL_HEX32((BUF_OFFSET + 512) & 0xFFF, itd[0].xact[1].offset);
+  TEST_ASSERT_EQUAL(1, itd[0].xact[1].page_select);
+  for (uint8_t u = 0; u < 8; u++) {
+    TEST_ASSERT_EQUAL(512, itd[0].xact[u].length);
+    TEST_ASSERT_TRUE(itd[0].xact[u].active);
+    TEST_ASSERT_FALSE(itd[0].xact[u].int_on_complete);
+  }
+
+  // second iTD starts at its own page
+  uint32_t const addr8 = buf + 8 * 512;
+  TEST_ASSERT_EQUAL_HEX32(tu_align4k(addr8), tu_align4k(itd[1].BufferPointer[0]));
+  TEST_ASSERT_EQUAL_HEX32(addr8 & 0xFFF, itd[1].xact[0].offset);
+  TEST_ASSERT_EQUAL(512, itd[1].xact[0].length);
+  TEST_ASSERT_EQUAL(412, itd[1].xact[1].length);
+  TEST_ASSERT_TRUE(itd[1].xact[1].int_on_complete);
+  for (uint8_t u = 2; u < 8; u++) {
+    TEST_ASSERT_FALSE(itd[1].xact[u].active);
+  }
+}
+
+void test_itd_build_interval(void) {
+  for (uint8_t i = 0; i < TD_COUNT; i++) {
+    ehci_itd_init(&itd[i], DEV_ADDR, 0x01, 256, 1);
+  }
+
+  // interval 4 microframes at phase 1: microframe 1 and 5
+  TEST_ASSERT_EQUAL(2, ehci_itd_build(itd, TD_COUNT, MEM_BASE, 3 * 256, 256, 1, 4));
+  TEST_ASSERT_TRUE(itd[0].xact[1].active);
+  TEST_ASSERT_TRUE(itd[0].xact[5].active);
+  TEST_ASSERT_TRUE(itd[1].xact[1].active);
+  TEST_ASSERT_FALSE(itd[1].xact[5].active);
+  TEST_ASSERT_TRUE(itd[1].xact[1].int_on_complete);
+
+  // interval 2 frames: one transaction per iTD
+  TEST_ASSERT_EQUAL(3, ehci_itd_build(itd, TD_COUNT, MEM_BASE, 3 * 256, 256, 6, 16));
+  for (uint8_t i = 0; i < 3; i++) {
+    TEST_ASSERT_TRUE(itd[i].xact[6].active);
+    TEST_ASSERT_FALSE(itd[i].xact[7].active);
+  }
+
+  // too many frames
+  TEST_ASSERT_EQUAL(0, ehci_itd_build(itd, TD_COUNT, MEM_BASE, 9 * 256, 256, 0, 8));
+}
+
+void test_itd_schedule_in(void) {
+  uint32_t const buf = MEM_BASE + BUF_OFFSET;
+  uint32_t const len = 20 * 1024;
+  for (uint8_t i = 0; i < TD_COUNT; i++) {
+    ehci_itd_init(&itd[i], DEV_ADDR, 0x81, 1024, 2);
+  }
+
+  // 2x1024 every other microframe: 4 transactions per frame, 3 frames
+  uint8_t const count = ehci_itd_build(itd, TD_COUNT, buf, len, 2048, 1, 2);
+  TEST_ASSERT_EQUAL(3, count);
+  for (uint8_t i = 0; i < count; i++) {
+    link_td(10 + i, &itd[i], EHCI_QTYPE_ITD);
+  }
+
+  hc_run_frame(10);
+  hc_run_frame(11);
+  TEST_ASSERT_FALSE(ehci_itd_active(&itd[0]));
+  TEST_ASSERT_TRUE(ehci_itd_active(&itd[2]));
+  hc_run_frame(12);
+  TEST_ASSERT_FALSE(ehci_itd_active(&itd[2]));
+
+  // data is contiguous, including across pages
+  uint32_t xferred = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    TEST_ASSERT_TRUE(ehci_itd_xferred(&itd[i], &xferred));
+  }
+  TEST_ASSERT_EQUAL(len, xferred);
+  for (uint32_t n = 0; n < len; n++) {
+    TEST_ASSERT_EQUAL_HEX8((uint8_t) n, mem[BUF_OFFSET + n]);
+  }
+}
+
+void test_itd_schedule_out(void) {
+  uint32_t const buf = MEM_BASE + BUF_OFFSET;
+  uint32_t const len = 3 * 3072 + 10;
+  for (uint32_t n = 0; n < len; n++) {
+    mem[BUF_OFFSET + n] = (uint8_t) (n * 7);
+  }
+  for (uint8_t i = 0; i < TD_COUNT; i++) {
+    ehci_itd_init(&itd[i], DEV_ADDR, 0x02, 1024, 3);
+  }
+
+  // one transaction every frame at microframe 3
+  uint8_t const count = ehci_itd_build(itd, TD_COUNT, buf, len, 3072, 3, 8);
+  TEST_ASSERT_EQUAL(4, count);
+  for (uint8_t i = 0; i < count; i++) {
+    link_td(FRAMELIST_SIZE - 2 + i, &itd[i], EHCI_QTYPE_ITD); // wrap around frame list
+  }
+  for (uint32_t f = 0; f < 4; f++) {
+    hc_run_frame(FRAMELIST_SIZE - 2 + f);
+  }
+
+  uint32_t xferred = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    TEST_ASSERT_FALSE(ehci_itd_active(&itd[i]));
+    TEST_ASSERT_TRUE(ehci_itd_xferred(&itd[i], &xferred));
+  }
+  TEST_ASSERT_EQUAL(len, xferred);
+  TEST_ASSERT_EQUAL(len, dev_out_len);
+  TEST_ASSERT_EQUAL_MEMORY(&mem[BUF_OFFSET], dev_out, len);
+}
+
+void test_itd_short_and_error(void) {
+  for (uint8_t i = 0; i < TD_COUNT; i++) {
+    ehci_itd_init(&itd[i], DEV_ADDR, 0x81, 512, 1);
+  }
+
+  TEST_ASSERT_EQUAL(1, ehci_itd_build(itd, TD_COUNT, MEM_BASE, 4 * 512, 512, 0, 2));
+  link_td(0, &itd[0], EHCI_QTYPE_ITD);
+
+  // device sends short packets, one transaction has error
+  dev_in_short = 100;
+  hc_run_frame(0);
+  itd[0].xact[2].error = 1;
+
+  // short packet is at its transaction slot
+  TEST_ASSERT_EQUAL(100, itd[0].xact[2].length);
+  TEST_ASSERT_EQUAL_HEX8(100, mem[512]);
+
+  uint32_t xferred = 0;
+  TEST_ASSERT_FALSE(ehci_itd_xferred(&itd[0], &xferred));
+  TEST_ASSERT_EQUAL(300, xferred);
+}
+
+//--------------------------------------------------------------------+
+// siTD
+//--------------------------------------------------------------------+
+
+void test_sitd_init(void) {
+  ehci_sitd_init(&sitd[0], DEV_ADDR, 0x83, HUB_ADDR, HUB_PORT, 0x01, 0x1C);
+  TEST_ASSERT_TRUE(sitd[0].next.terminate);
+  TEST_ASSERT_TRUE(sitd[0].back.terminate);
+  TEST_ASSERT_EQUAL(DEV_ADDR, sitd[0].dev_addr);
+  TEST_ASSERT_EQUAL(3, sitd[0].ep_number);
+  TEST_ASSERT_EQUAL(HUB_ADDR, sitd[0].hub_addr);
+  TEST_ASSERT_EQUAL(HUB_PORT, sitd[0].port_number);
+  TEST_ASSERT_EQUAL(1, sitd[0].direction);
+  TEST_ASSERT_EQUAL_HEX8(0x01, sitd[0].int_smask);
+  TEST_ASSERT_EQUAL_HEX8(0x1C, sitd[0].fl_int_cmask);
+  TEST_ASSERT_FALSE(sitd[0].active);
+}
+
+void test_sitd_build_out(void) {
+  uint32_t const buf = MEM_BASE + BUF_OFFSET;
+  for (uint8_t i = 0; i < TD_COUNT; i++) {
+    ehci_sitd_init(&sitd[i], DEV_ADDR, 0x02, HUB_ADDR, HUB_PORT, 0x03, 0);
+  }
+
+  TEST_ASSERT_EQUAL(3, ehci_sitd_build(sitd, TD_COUNT, buf, 2 * 192 + 100, 192));
+
+  // packet crosses page: buffer[1] is next page with start-split position and count
+  TEST_ASSERT_EQUAL_HEX32(buf, sitd[0].buffer[0]);
+  TEST_ASSERT_EQUAL_HEX32(tu_align4k(buf) + 4096, tu_align4k(sitd[0].buffer[1]));
+  TEST_ASSERT_EQUAL(EHCI_SITD_TP_BEGIN, (sitd[0].buffer[1] >> 3) & 0x03);
+  TEST_ASSERT_EQUAL(2, sitd[0].buffer[1] & 0x07);
+  TEST_ASSERT_EQUAL(192, sitd[0].total_bytes);
+  TEST_ASSERT_FALSE(sitd[0].int_on_complete);
+  TEST_ASSERT_TRUE(sitd[0].active);
+
+  // last packet fits in one start-split
+  TEST_ASSERT_EQUAL_HEX32(buf + 2 * 192, sitd[2].buffer[0]);
+  TEST_ASSERT_EQUAL(EHCI_SITD_TP_ALL, (sitd[2].buffer[1] >> 3) & 0x03);
+  TEST_ASSERT_EQUAL(1, sitd[2].buffer[1] & 0x07);
+  TEST_ASSERT_EQUAL(100, sitd[2].total_bytes);
+  TEST_ASSERT_TRUE(sitd[2].int_on_complete);
+
+  TEST_ASSERT_EQUAL(0, ehci_sitd_build(sitd, TD_COUNT, buf, 9 * 192, 192));
+}
+
+void test_sitd_schedule_in(void) {
+  uint32_t const buf = MEM_BASE + BUF_OFFSET;
+  uint32_t const len = 5 * 192;
+  for (uint8_t i = 0; i < TD_COUNT; i++) {
+    ehci_sitd_init(&sitd[i], DEV_ADDR, 0x81, HUB_ADDR, HUB_PORT, 0x01, 0x1C);
+  }
+
+  // interval 2 frames
+  uint8_t const count = ehci_sitd_build(sitd, TD_COUNT, buf, len, 192);
+  TEST_ASSERT_EQUAL(5, count);
+  for (uint8_t i = 0; i < count; i++) {
+    link_td(4 + 2 * i, &sitd[i], EHCI_QTYPE_SITD);
+  }
+
+  for (uint32_t f = 4; f < 4 + 2u * count; f++) {
+    hc_run_frame(f);
+  }
+
+  uint32_t xferred = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    TEST_ASSERT_FALSE(sitd[i].active);
+    TEST_ASSERT_TRUE(ehci_sitd_xferred(&sitd[i], &xferred));
+  }
+  TEST_ASSERT_EQUAL(len, xferred);
+  for (uint32_t n = 0; n < len; n++) {
+    TEST_ASSERT_EQUAL_HEX8((uint8_t) n, mem[BUF_OFFSET + n]);
+  }
+}
+
+void test_sitd_short_and_error(void) {
+  for (uint8_t i = 0; i < TD_COUNT; i++) {
+    ehci_sitd_init(&sitd[i], DEV_ADDR, 0x81, 0, 0, 0x01, 0x1C); // embedded TT of root port
+  }
+
+  TEST_ASSERT_EQUAL(2, ehci_sitd_build(sitd, TD_COUNT, MEM_BASE, 2 * 192, 192));
+  link_td(0, &sitd[0], EHCI_QTYPE_SITD);
+  link_td(1, &sitd[1], EHCI_QTYPE_SITD);
+
+  dev_in_short = 50;
+  hc_run_frame(0);
+  hc_run_frame(1);
+  sitd[1].xact_err = 1;
+
+  uint32_t xferred = 0;
+  TEST_ASSERT_TRUE(ehci_sitd_xferred(&sitd[0], &xferred));
+  TEST_ASSERT_EQUAL(50, xferred);
+  TEST_ASSERT_FALSE(ehci_sitd_xferred(&sitd[1], &xferred));
+  TEST_ASSERT_EQUAL(50, xferred);
+
+  // rebuild resets status written by HC
+  TEST_ASSERT_EQUAL(1, ehci_sitd_build(sitd, TD_COUNT, MEM_BASE, 192, 192));
+  TEST_ASSERT_EQUAL(0, sitd[0].xact_err);
+  TEST_ASSERT_EQUAL(192, sitd[0].total_bytes);
+}
+
+void test_schedule_mixed_frame_list(void) {
+  // iTD and siTD share a frame list slot in front of queue head
+  for (uint8_t i = 0; i < TD_COUNT; i++) {
+    ehci_itd_init(&itd[i], DEV_ADDR, 0x01, 64, 1);
+    ehci_sitd_init(&sitd[i], DEV_ADDR + 1, 0x02, HUB_ADDR, HUB_PORT, 0x01, 0);
+  }
+  memset(mem, 0x11, 256);
+  memset(mem + 256, 0x22, 64);
+
+  TEST_ASSERT_EQUAL(1, ehci_itd_build(itd, TD_COUNT, MEM_BASE, 256, 64, 0, 2));
+  TEST_ASSERT_EQUAL(1, ehci_sitd_build(sitd, TD_COUNT, MEM_BASE + 256, 64, 64));
+  link_td(7, &itd[0], EHCI_QTYPE_ITD);
+  link_td(7, &sitd[0], EHCI_QTYPE_SITD);
+
+  hc_run_frame(7);
+  TEST_ASSERT_FALSE(ehci_itd_active(&itd[0]));
+  TEST_ASSERT_FALSE(sitd[0].active);
+  TEST_ASSERT_EQUAL(256 + 64, dev_out_len);
+  TEST_ASSERT_EQUAL_HEX8(0x22, dev_out[0]); // siTD is at front, executed first
+  TEST_ASSERT_EQUAL_HEX8(0x11, dev_out[64]);
+
+  // queue head is still at the end of the slot
+  ehci_link_t link = framelist[7];
+  link = *(ehci_link_t*) td_from_bus(link.address);
+  link = *(ehci_link_t*) td_from_bus(link.address);
+  TEST_ASSERT_EQUAL(EHCI_QTYPE_QHD, link.type);
+}
@@ -73,12 +73,17 @@
 // DEVICE CONFIGURATION
 //--------------------------------------------------------------------
 
+// use simulated controller for tests that link portable/sim/dcd_sim.c
+#define CFG_TUD_SIM              1
+
 #define CFG_TUD_TASK_QUEUE_SZ    100
 #define CFG_TUD_ENDPOINT0_SIZE    64
 
 //------------- CLASS -------------//
 //#define CFG_TUD_CDC              0
+#ifndef CFG_TUD_MSC
 #define CFG_TUD_MSC              1
+#endif
 //#define CFG_TUD_HID              0
 //#define CFG_TUD_MIDI             0
 //#define CFG_TUD_VENDOR           0
@@ -99,6 +104,20 @@
 // Should be sufficient to hold ID (if any) + Data
 #define CFG_TUD_HID_EP_BUFSIZE    64
 
+//--------------------------------------------------------------------
+// HOST CONFIGURATION
+//--------------------------------------------------------------------
+
+// host stack is only enabled for tests that link portable/sim/hcd_sim.c
+#if defined(CFG_TUH_SIM) && CFG_TUH_SIM
+#define CFG_TUSB_RHPORT1_MODE    (OPT_MODE_HOST | OPT_MODE_HIGH_SPEED)
+
+#define CFG_TUH_ENUMERATION_BUFSIZE 256
+#define CFG_TUH_HUB              2
+#define CFG_TUH_DEVICE_MAX       (4 + CFG_TUH_HUB)
+#define CFG_TUH_API_EDPT_XFER    1
+#endif
+
 #ifdef __cplusplus
  }
 #endif
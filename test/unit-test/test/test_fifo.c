@@ -567,6 +567,59 @@ void test_read_n_fixed_addr_rw16_wrapped(void) {
   }
 }
 
+// Longer transfers at every buffer alignment so both the aligned fast path and the unaligned path are exercised
+void test_hwfifo_read_write_aligned_rw32(void) {
+  TU_ATTR_ALIGNED(4) uint8_t buf[48];
+  volatile uint32_t          reg;
+
+  for (uint8_t offset = 0; offset < 4; offset++) {
+    reg = 0x44332211;
+    for (uint16_t len = 1; len <= 40; len++) {
+      memset(buf, 0, sizeof(buf));
+      tu_hwfifo_read(&reg, buf + offset, len, &hwfifo_access_32);
+      for (uint16_t i = 0; i < len; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0x11 * (1 + (i & 3)), buf[offset + i]);
+      }
+      TEST_ASSERT_EQUAL_HEX8(0, buf[offset + len]);
+    }
+
+    for (uint8_t i = 0; i < 40; i++) {
+      buf[offset + i] = i;
+    }
+    for (uint16_t len = 4; len <= 40; len += 4) {
+      reg = 0;
+      tu_hwfifo_write(&reg, buf + offset, len, &hwfifo_access_32);
+      TEST_ASSERT_EQUAL_HEX32(tu_unaligned_read32(buf + offset + len - 4), reg);
+    }
+  }
+}
+
+void test_hwfifo_read_write_aligned_rw16(void) {
+  TU_ATTR_ALIGNED(4) uint8_t buf[48];
+  volatile uint16_t          reg;
+
+  for (uint8_t offset = 0; offset < 2; offset++) {
+    reg = 0x2211;
+    for (uint16_t len = 1; len <= 40; len++) {
+      memset(buf, 0, sizeof(buf));
+      tu_hwfifo_read(&reg, buf + offset, len, &hwfifo_access_16);
+      for (uint16_t i = 0; i < len; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0x11 * (1 + (i & 1)), buf[offset + i]);
+      }
+      TEST_ASSERT_EQUAL_HEX8(0, buf[offset + len]);
+    }
+
+    for (uint8_t i = 0; i < 40; i++) {
+      buf[offset + i] = i;
+    }
+    for (uint16_t len = 2; len <= 40; len += 2) {
+      reg = 0;
+      tu_hwfifo_write(&reg, buf + offset, len, &hwfifo_access_16);
+      TEST_ASSERT_EQUAL_HEX16(tu_unaligned_read16(buf + offset + len - 2), reg);
+    }
+  }
+}
+
 void test_get_read_info_advanced_cases(void) {
   tu_fifo_clear(ff);
 
@@ -625,3 +678,83 @@ void test_correct_read_pointer_cases(void) {
   tu_fifo_correct_read_pointer(ff);
   TEST_ASSERT_EQUAL(FIFO_SIZE + 10, ff->rd_idx);
 }
+
+void test_write_reserve_commit_wrapped(void) {
+  tu_fifo_clear(ff);
+  ff->wr_idx = 60;
+  ff->rd_idx = 20;
+
+  // limited to requested size: linear part only
+  TEST_ASSERT_EQUAL(3, tu_fifo_write_reserve(ff, &info, 3));
+  TEST_ASSERT_EQUAL(3, info.linear.len);
+  TEST_ASSERT_EQUAL(0, info.wrapped.len);
+  TEST_ASSERT_NULL(info.wrapped.ptr);
+
+  // spans the wrap
+  TEST_ASSERT_EQUAL(10, tu_fifo_write_reserve(ff, &info, 10));
+  TEST_ASSERT_EQUAL(4, info.linear.len);
+  TEST_ASSERT_EQUAL(6, info.wrapped.len);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer + 60, info.linear.ptr);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer, info.wrapped.ptr);
+
+  for (uint16_t i = 0; i < info.linear.len; i++) {
+    info.linear.ptr[i] = (uint8_t) i;
+  }
+  for (uint16_t i = 0; i < info.wrapped.len; i++) {
+    info.wrapped.ptr[i] = (uint8_t) (info.linear.len + i);
+  }
+
+  TEST_ASSERT_EQUAL(40, tu_fifo_count(ff));
+  TEST_ASSERT_EQUAL(10, tu_fifo_write_commit(ff, 10));
+  TEST_ASSERT_EQUAL(50, tu_fifo_count(ff));
+  TEST_ASSERT_EQUAL(70, ff->wr_idx);
+  TEST_ASSERT_EQUAL_UINT8(9, ff->buffer[5]);
+}
+
+void test_write_reserve_commit_limit(void) {
+  uint8_t ch = 1;
+  for (uint8_t i = 0; i < FIFO_SIZE - 4; i++) {
+    tu_fifo_write(ff, &ch);
+  }
+
+  // reserve and commit are limited to free space
+  TEST_ASSERT_EQUAL(4, tu_fifo_write_reserve(ff, &info, 100));
+  TEST_ASSERT_EQUAL(4, tu_fifo_write_commit(ff, 100));
+  TEST_ASSERT_TRUE(tu_fifo_full(ff));
+
+  TEST_ASSERT_EQUAL(0, tu_fifo_write_reserve(ff, &info, 10));
+  TEST_ASSERT_NULL(info.linear.ptr);
+  TEST_ASSERT_EQUAL(0, tu_fifo_write_commit(ff, 10));
+}
+
+void test_read_reserve_commit_wrapped(void) {
+  // fill, read 6, write 2 -> 58 items wrapped with 2 at start of buffer
+  for (uint8_t i = 0; i < FIFO_SIZE; i++) {
+    tu_fifo_write(ff, &i);
+  }
+  tu_fifo_read_n(ff, rd_buf, 6);
+  uint8_t data[2] = {0xAA, 0xBB};
+  tu_fifo_write_n(ff, data, 2);
+
+  TEST_ASSERT_EQUAL(FIFO_SIZE - 4, tu_fifo_read_reserve(ff, &info, FIFO_SIZE));
+  TEST_ASSERT_EQUAL(FIFO_SIZE - 6, info.linear.len);
+  TEST_ASSERT_EQUAL(2, info.wrapped.len);
+  TEST_ASSERT_EQUAL_UINT8(6, info.linear.ptr[0]);
+  TEST_ASSERT_EQUAL_UINT8(0xAA, info.wrapped.ptr[0]);
+
+  // reserve does not consume
+  TEST_ASSERT_EQUAL(FIFO_SIZE - 4, tu_fifo_count(ff));
+
+  TEST_ASSERT_EQUAL(8, tu_fifo_read_reserve(ff, &info, 8));
+  TEST_ASSERT_EQUAL(8, info.linear.len);
+  TEST_ASSERT_EQUAL(0, info.wrapped.len);
+
+  TEST_ASSERT_EQUAL(FIFO_SIZE - 5, tu_fifo_read_commit(ff, FIFO_SIZE - 5));
+  TEST_ASSERT_EQUAL(1, tu_fifo_count(ff));
+  TEST_ASSERT_EQUAL(1, tu_fifo_read_reserve(ff, &info, 8));
+  TEST_ASSERT_EQUAL_UINT8(0xBB, info.linear.ptr[0]);
+
+  // commit is limited to available count
+  TEST_ASSERT_EQUAL(1, tu_fifo_read_commit(ff, 8));
+  TEST_ASSERT_TRUE(tu_fifo_empty(ff));
+}